@@ -0,0 +1,106 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how fast URLRequestApplicationJob serves app:// resources to a
+// running application, as seen by fetch() in the application's page.
+
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/path_service.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/stringprintf.h"
+#include "content/public/test/browser_test_utils.h"
+#include "xwalk/application/browser/application.h"
+#include "xwalk/application/browser/application_service.h"
+#include "xwalk/application/browser/application_system.h"
+#include "xwalk/application/common/application_file_util.h"
+#include "xwalk/runtime/browser/runtime.h"
+#include "xwalk/runtime/browser/xwalk_runner.h"
+#include "xwalk/test/base/in_process_browser_test.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+
+using xwalk::application::Application;
+using xwalk::application::Manifest;
+using xwalk::application::GetManifestPath;
+
+namespace {
+
+const int kWarmupRequests = 20;
+const int kRequests = 500;
+
+}  // namespace
+
+class ApplicationProtocolsPerfTest : public InProcessBrowserTest {
+ protected:
+  Application* LaunchApplication() {
+    base::FilePath data_dir;
+    PathService::Get(base::DIR_SOURCE_ROOT, &data_dir);
+    data_dir = data_dir.Append(FILE_PATH_LITERAL("xwalk"))
+                   .Append(FILE_PATH_LITERAL("application"))
+                   .Append(FILE_PATH_LITERAL("test"))
+                   .Append(FILE_PATH_LITERAL("data"))
+                   .Append(FILE_PATH_LITERAL("protocol_perf"));
+    Application* app = xwalk::XWalkRunner::GetInstance()
+                           ->app_system()
+                           ->application_service()
+                           ->LaunchFromManifestPath(
+                               GetManifestPath(data_dir,
+                                               Manifest::TYPE_MANIFEST),
+                               Manifest::TYPE_MANIFEST);
+    if (app && !app->runtimes().empty())
+      content::WaitForLoadStop(app->runtimes()[0]->web_contents());
+    return app;
+  }
+
+  // Fetches |path| |count| times and returns the time each took in us.
+  std::vector<double> Fetch(Application* app,
+                            const std::string& path,
+                            int count) {
+    std::string result;
+    EXPECT_TRUE(content::ExecuteScriptAndExtractString(
+        app->runtimes()[0]->web_contents(),
+        base::StringPrintf("fetchSequentially('%s', %d);", path.c_str(),
+                           count),
+        &result));
+
+    std::vector<double> samples_us;
+    for (const std::string& sample : base::SplitString(
+             result, ",", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+      double ms;
+      if (!base::StringToDouble(sample, &ms)) {
+        ADD_FAILURE() << "Unexpected result: " << result;
+        return std::vector<double>();
+      }
+      samples_us.push_back(ms * 1000);
+    }
+    EXPECT_EQ(static_cast<size_t>(count), samples_us.size());
+    return samples_us;
+  }
+
+  void RunBenchmark(const std::string& path, const std::string& story) {
+    Application* app = LaunchApplication();
+    ASSERT_TRUE(app);
+    ASSERT_FALSE(app->runtimes().empty());
+
+    Fetch(app, path, kWarmupRequests);
+    XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+        "app_protocol_fetch", story, Fetch(app, path, kRequests)));
+  }
+};
+
+IN_PROC_BROWSER_TEST_F(ApplicationProtocolsPerfTest, FetchPage) {
+  RunBenchmark("main.html", "_html");
+}
+
+IN_PROC_BROWSER_TEST_F(ApplicationProtocolsPerfTest, FetchStylesheet) {
+  RunBenchmark("style.css", "_16KB_css");
+}
+
+IN_PROC_BROWSER_TEST_F(ApplicationProtocolsPerfTest, FetchMissing) {
+  // 404s still go through the resource lookup on the blocking pool.
+  RunBenchmark("missing.txt", "_404");
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures loading an application from disk, manifest parsing and the
+// manifest handlers included, for both manifest formats.
+
+#include <string>
+
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/path_service.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "xwalk/application/common/application_data.h"
+#include "xwalk/application/common/application_file_util.h"
+#include "xwalk/application/common/id_util.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+
+namespace xwalk {
+namespace application {
+
+namespace {
+
+base::FilePath GetTestDataDir(const std::string& name) {
+  base::FilePath path;
+  PathService::Get(base::DIR_SOURCE_ROOT, &path);
+  return path.AppendASCII("xwalk")
+      .AppendASCII("application")
+      .AppendASCII("test")
+      .AppendASCII("data")
+      .AppendASCII(name);
+}
+
+void Load(const base::FilePath& app_root, Manifest::Type type) {
+  std::string error;
+  scoped_refptr<ApplicationData> application(
+      LoadApplication(app_root, GenerateIdForPath(app_root),
+                      ApplicationData::LOCAL_DIRECTORY, type, &error));
+  ASSERT_TRUE(application.get()) << error;
+}
+
+void RunLoadBenchmark(const base::FilePath& app_root,
+                      Manifest::Type type,
+                      const std::string& story) {
+  XWalkBenchmark::Options options;
+  options.samples = 500;
+  XWalkBenchmark::Report(XWalkBenchmark::Run(
+      "application_load", story, options,
+      base::BindRepeating(&Load, app_root, type)));
+}
+
+}  // namespace
+
+TEST(ApplicationFileUtilPerfTest, LoadManifestJson) {
+  RunLoadBenchmark(GetTestDataDir("dummy_app1"), Manifest::TYPE_MANIFEST,
+                   "_manifest_json");
+}
+
+TEST(ApplicationFileUtilPerfTest, LoadWidgetConfigXml) {
+  RunLoadBenchmark(GetTestDataDir("widget_preferences"), Manifest::TYPE_WIDGET,
+                   "_config_xml");
+}
+
+}  // namespace application
+}  // namespace xwalk
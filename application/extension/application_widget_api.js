@@ -39,14 +39,91 @@ function defineReadOnlyProperty(object, key, value) {
   });
 }
 
+// Reads are served from a snapshot of the preferences. Writes still go to
+// the extension, which answers with the version they produced; changes made
+// by other frames arrive in "StorageEvents" batches. Whenever the versions
+// do not line up the snapshot is fetched again.
+var snapshot = { items: {}, version: -1 };
+
+function refreshSnapshot() {
+  var result = extension.internal.sendSyncMessage(
+      { cmd: 'GetPreferencesSnapshot' });
+  snapshot.items = result.items;
+  snapshot.version = result.version;
+}
+
+function applyChange(key, newValue) {
+  if (newValue === null)
+    delete snapshot.items[key];
+  else
+    snapshot.items[key] = newValue;
+}
+
+// Applies a change this frame made, |version| is what the extension reported
+// for it.
+function applyOwnChange(version, changes) {
+  if (version == snapshot.version)
+    return;
+  if (version != snapshot.version + 1) {
+    refreshSnapshot();
+    return;
+  }
+  changes();
+  snapshot.version = version;
+}
+
+function dispatchStorageEvent(change) {
+  if (!window.eventListenerList)
+    return;
+  var event = {
+    key: change.key,
+    oldValue: change.oldValue,
+    newValue: change.newValue,
+    url: window.location.href,
+    storageArea: exports.preferences
+  };
+  for (var key in event) {
+    Object.defineProperty(event, key, {
+      value: event[key],
+      writable: false
+    });
+  }
+  for (var i = 0; i < window.eventListenerList.length; i++)
+    window.eventListenerList[i](event);
+}
+
+extension.setMessageListener(function(msg) {
+  if (msg.cmd != 'StorageEvents')
+    return;
+
+  if (msg.version > snapshot.version) {
+    if (msg.baseVersion == snapshot.version) {
+      for (var i = 0; i < msg.events.length; i++)
+        applyChange(msg.events[i].key, msg.events[i].newValue);
+      snapshot.version = msg.version;
+    } else {
+      refreshSnapshot();
+    }
+  }
+
+  // The snapshot is up to date before any listener runs.
+  for (var i = 0; i < msg.events.length; i++)
+    dispatchStorageEvent(msg.events[i]);
+});
+
 var WidgetStorage = function() {
   var _SetItem = function(itemKey, itemValue) {
+    itemKey = String(itemKey);
+    itemValue = String(itemValue);
     var result = extension.internal.sendSyncMessage({
         cmd: 'SetPreferencesItem',
-        preferencesItemKey: String(itemKey),
-        preferencesItemValue: String(itemValue) });
+        preferencesItemKey: itemKey,
+        preferencesItemValue: itemValue });
 
-    if (result) {
+    if (result.success) {
+      applyOwnChange(result.version, function() {
+        applyChange(itemKey, itemValue);
+      });
       return itemValue;
     } else {
       throw new common.CustomDOMException(
@@ -55,6 +132,12 @@ var WidgetStorage = function() {
     }
   }
 
+  var _GetItem = function(itemKey) {
+    var items = snapshot.items;
+    itemKey = String(itemKey);
+    return items.hasOwnProperty(itemKey) ? items[itemKey] : null;
+  }
+
   var _GetSetter = function(itemKey) {
     var _itemKey = itemKey;
     return function(itemValue) {
@@ -65,36 +148,28 @@ var WidgetStorage = function() {
   var _GetGetter = function(itemKey) {
     var _itemKey = itemKey;
     return function() {
-      var result = extension.internal.sendSyncMessage(
-          { cmd: 'GetItemValueByKey',
-            preferencesItemKey: String(itemKey) });
-      return result == empty ? null : result;
+      return _GetItem(_itemKey);
     }
   }
 
   this.init = function() {
-    var result = extension.internal.sendSyncMessage({cmd: 'GetAllItems'});
-    for (var itemKey in result) {
+    refreshSnapshot();
+    for (var itemKey in snapshot.items) {
       this.__defineSetter__(String(itemKey), _GetSetter(itemKey));
       this.__defineGetter__(String(itemKey), _GetGetter(itemKey));
     }
   }
 
   this.__defineGetter__('length', function() {
-    var result = extension.internal.sendSyncMessage({cmd: 'GetAllItems'});
-    return Object.keys(result).length;
+    return Object.keys(snapshot.items).length;
   });
 
   this.key = function(index) {
-    var result = extension.internal.sendSyncMessage({ cmd: 'GetAllItems'});
-    return Object.keys(result)[index];
+    return Object.keys(snapshot.items)[index];
   }
 
   this.getItem = function(itemKey) {
-    var result = extension.internal.sendSyncMessage({
-        cmd: 'GetItemValueByKey',
-        preferencesItemKey: String(itemKey)});
-    return result == empty ? null : result;
+    return _GetItem(itemKey);
   }
 
   this.setItem = function(itemKey, itemValue) {
@@ -102,19 +177,26 @@ var WidgetStorage = function() {
   }
 
   this.removeItem = function(itemKey) {
+    itemKey = String(itemKey);
     var result = extension.internal.sendSyncMessage({
         cmd: 'RemovePreferencesItem',
-        preferencesItemKey: String(itemKey)});
+        preferencesItemKey: itemKey});
 
-    if (!result) {
+    if (!result.success) {
       throw new common.CustomDOMException(
           common.CustomDOMException.NO_MODIFICATION_ALLOWED_ERR,
           'The object can not be modified.');
     }
+    applyOwnChange(result.version, function() {
+      applyChange(itemKey, null);
+    });
   }
 
   this.clear = function() {
-    extension.internal.sendSyncMessage({cmd: 'ClearAllItems'});
+    var result = extension.internal.sendSyncMessage({cmd: 'ClearAllItems'});
+    // Read-only items survive, only the extension knows which they are.
+    if (result.success && result.version != snapshot.version)
+      refreshSnapshot();
   }
 
   this.init();
@@ -4,18 +4,16 @@
 
 #include "xwalk/application/extension/application_widget_extension.h"
 
+#include <utility>
 #include <vector>
 
 #include "base/bind.h"
 #include "base/path_service.h"
-#include "base/strings/stringprintf.h"
-#include "base/strings/string_util.h"
-#include "base/strings/utf_string_conversions.h"
+#include "base/threading/thread_restrictions.h"
+#include "base/threading/thread_task_runner_handle.h"
 #include "content/public/browser/browser_thread.h"
-#include "content/public/browser/render_frame_host.h"
 #include "content/public/browser/render_process_host.h"
 #include "content/public/browser/storage_partition.h"
-#include "content/public/browser/web_contents.h"
 #include "ipc/ipc_message.h"
 #include "xwalk/application/grit/xwalk_application_resources.h"
 #include "ui/base/resource/resource_bundle.h"
@@ -24,7 +22,6 @@
 #include "xwalk/application/common/application_manifest_constants.h"
 #include "xwalk/application/common/manifest_handlers/widget_handler.h"
 #include "xwalk/application/extension/application_widget_storage.h"
-#include "xwalk/runtime/browser/runtime.h"
 #include "xwalk/runtime/browser/xwalk_browser_context.h"
 #include "xwalk/runtime/browser/xwalk_runner.h"
 #include "xwalk/runtime/common/xwalk_paths.h"
@@ -38,41 +35,29 @@ const char kWidgetAttributeKey[] = "widgetKey";
 const char kPreferencesItemKey[] = "preferencesItemKey";
 const char kPreferencesItemValue[] = "preferencesItemValue";
 
-void DispatchStorageEvent(
-    base::DictionaryValue* msg,
-    content::WebContents* web_contents,
-    content::RenderFrameHost* frame) {
-  if (frame == web_contents->GetFocusedFrame())
-    return;
+std::unique_ptr<base::Value> MakeWriteResult(bool success, int version) {
+  std::unique_ptr<base::DictionaryValue> result(new base::DictionaryValue());
+  result->SetBoolean("success", success);
+  result->SetInteger("version", version);
+  return std::move(result);
+}
 
-  std::string key, oldValue, newValue;
-  msg->GetString("key", &key);
-  msg->GetString("oldValue", &oldValue);
-  msg->GetString("newValue", &newValue);
-
-  std::string code = base::StringPrintf(
-      "(function() {"
-      "  var old_value = '%s' == '' ? null : '%s';"
-      "  var new_value = '%s' == '' ? null : '%s';"
-      "  var event = {"
-      "    key: '%s',"
-      "    oldValue: old_value,"
-      "    newValue: new_value,"
-      "    url: window.location.href,"
-      "    storageArea: widget.preferences"
-      "  };"
-      "  for (var key in event) {"
-      "    Object.defineProperty(event, key, {"
-      "      value: event[key],"
-      "      writable: false"
-      "    });"
-      "  }"
-      "  for (var i = 0; i < window.eventListenerList.length; i++)"
-      "    window.eventListenerList[i](event);"
-      "})();", oldValue.c_str(), oldValue.c_str(),
-      newValue.c_str(), newValue.c_str(), key.c_str());
-
-  frame->ExecuteJavaScript(base::UTF8ToUTF16(code));
+// A missing |old_value| or |new_value| is passed as null.
+std::unique_ptr<base::DictionaryValue> MakeStorageEvent(
+    const std::string& key,
+    const std::string* old_value,
+    const std::string* new_value) {
+  std::unique_ptr<base::DictionaryValue> event(new base::DictionaryValue());
+  event->SetString("key", key);
+  if (old_value)
+    event->SetString("oldValue", *old_value);
+  else
+    event->Set("oldValue", std::make_unique<base::Value>());
+  if (new_value)
+    event->SetString("newValue", *new_value);
+  else
+    event->Set("newValue", std::make_unique<base::Value>());
+  return event;
 }
 
 }  // namespace
@@ -84,7 +69,10 @@ namespace widget_keys = xwalk::application_widget_keys;
 
 ApplicationWidgetExtension::ApplicationWidgetExtension(
     Application* application)
-  : application_(application) {
+  : application_(application),
+    preferences_version_(0),
+    pending_base_version_(0),
+    weak_factory_(this) {
   set_name("widget");
 
   std::vector<std::string> entries;
@@ -95,14 +83,71 @@ ApplicationWidgetExtension::ApplicationWidgetExtension(
       IDR_XWALK_APPLICATION_WIDGET_API).as_string());
 }
 
+ApplicationWidgetExtension::~ApplicationWidgetExtension() {}
+
 XWalkExtensionInstance* ApplicationWidgetExtension::CreateInstance() {
-  return new AppWidgetExtensionInstance(application_);
+  return new AppWidgetExtensionInstance(application_, this);
+}
+
+void ApplicationWidgetExtension::AddInstance(
+    AppWidgetExtensionInstance* instance) {
+  instances_.insert(instance);
+}
+
+void ApplicationWidgetExtension::RemoveInstance(
+    AppWidgetExtensionInstance* instance) {
+  instances_.erase(instance);
+  // Its events still have to reach the others, it just can't be told apart
+  // from them anymore.
+  for (auto& pending : pending_events_) {
+    if (pending.first == instance)
+      pending.first = nullptr;
+  }
+}
+
+int ApplicationWidgetExtension::OnPreferencesChanged(
+    AppWidgetExtensionInstance* source,
+    std::vector<std::unique_ptr<base::DictionaryValue>> events) {
+  if (pending_events_.empty()) {
+    pending_base_version_ = preferences_version_;
+    base::ThreadTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE,
+        base::BindOnce(&ApplicationWidgetExtension::FlushStorageEvents,
+                       weak_factory_.GetWeakPtr()));
+  }
+  for (auto& event : events)
+    pending_events_.push_back(std::make_pair(source, std::move(event)));
+  return ++preferences_version_;
+}
+
+void ApplicationWidgetExtension::FlushStorageEvents() {
+  for (AppWidgetExtensionInstance* instance : instances_) {
+    // Storage events are not fired in the frame that made the change.
+    std::unique_ptr<base::ListValue> events(new base::ListValue());
+    for (const auto& pending : pending_events_) {
+      if (pending.first != instance)
+        events->Append(pending.second->CreateDeepCopy());
+    }
+    if (events->empty())
+      continue;
+
+    std::unique_ptr<base::DictionaryValue> msg(new base::DictionaryValue());
+    msg->SetString(kCommandKey, "StorageEvents");
+    msg->SetInteger("baseVersion", pending_base_version_);
+    msg->SetInteger("version", preferences_version_);
+    msg->Set("events", std::move(events));
+    instance->PostMessageToJS(std::move(msg));
+  }
+  pending_events_.clear();
 }
 
 AppWidgetExtensionInstance::AppWidgetExtensionInstance(
-    Application* application)
-  : application_(application) {
+    Application* application,
+    ApplicationWidgetExtension* extension)
+  : application_(application),
+    extension_(extension) {
   DCHECK(application_);
+  extension_->AddInstance(this);
   base::ThreadRestrictions::SetIOAllowed(true);
 
   content::RenderProcessHost* rph =
@@ -115,7 +160,9 @@ AppWidgetExtensionInstance::AppWidgetExtensionInstance(
   widget_storage_.reset(new AppWidgetStorage(application_, path));
 }
 
-AppWidgetExtensionInstance::~AppWidgetExtensionInstance() {}
+AppWidgetExtensionInstance::~AppWidgetExtensionInstance() {
+  extension_->RemoveInstance(this);
+}
 
 void AppWidgetExtensionInstance::HandleMessage(std::unique_ptr<base::Value> msg) {
 }
@@ -143,6 +190,8 @@ void AppWidgetExtensionInstance::HandleSyncMessage(
     result = ClearAllItems(std::move(msg));
   } else if (command == "GetAllItems") {
     result = GetAllItems(std::move(msg));
+  } else if (command == "GetPreferencesSnapshot") {
+    result = GetPreferencesSnapshot(std::move(msg));
   } else if (command == "GetItemValueByKey") {
     result = GetItemValueByKey(std::move(msg));
   } else if (command == "KeyExists") {
@@ -178,8 +227,6 @@ std::unique_ptr<base::Value> AppWidgetExtensionInstance::GetWidgetInfo(
 
 std::unique_ptr<base::Value>
 AppWidgetExtensionInstance::SetPreferencesItem(std::unique_ptr<base::Value> msg) {
-  std::unique_ptr<base::Value> result(
-      new base::Value(false));
   std::string key;
   std::string value;
   base::DictionaryValue* dict;
@@ -188,93 +235,77 @@ AppWidgetExtensionInstance::SetPreferencesItem(std::unique_ptr<base::Value> msg)
       !dict->GetString(kPreferencesItemKey, &key) ||
       !dict->GetString(kPreferencesItemValue, &value)) {
     LOG(ERROR) << "Fail to set preferences item.";
-    return result;
+    return MakeWriteResult(false, extension_->preferences_version());
   }
 
   std::string old_value;
-  if (!widget_storage_->GetValueByKey(key, &old_value)) {
-    old_value = "";
-  }
-  if (old_value == value) {
+  bool existed = widget_storage_->GetValueByKey(key, &old_value);
+  if (existed && old_value == value) {
     LOG(WARNING) << "You are trying to set the same value."
                  << " Nothing will be done.";
-    result.reset(new base::Value(true));
-    return result;
+    return MakeWriteResult(true, extension_->preferences_version());
   }
-  if (widget_storage_->AddEntry(key, value, false)) {
-    result.reset(new base::Value(true));
-
-    std::unique_ptr<base::DictionaryValue> event(new base::DictionaryValue());
-    event->SetString("key", key);
-    event->SetString("oldValue", old_value);
-    event->SetString("newValue", value);
-    PostMessageToOtherFrames(std::move(event));
-  }
-
-  return result;
+  if (!widget_storage_->AddEntry(key, value, false))
+    return MakeWriteResult(false, extension_->preferences_version());
+
+  std::vector<std::unique_ptr<base::DictionaryValue>> events;
+  events.push_back(
+      MakeStorageEvent(key, existed ? &old_value : nullptr, &value));
+  return MakeWriteResult(
+      true, extension_->OnPreferencesChanged(this, std::move(events)));
 }
 
 std::unique_ptr<base::Value>
 AppWidgetExtensionInstance::RemovePreferencesItem(std::unique_ptr<base::Value> msg) {
-  std::unique_ptr<base::Value> result(
-      new base::Value(false));
   std::string key;
   base::DictionaryValue* dict;
 
   if (!msg->GetAsDictionary(&dict) ||
       !dict->GetString(kPreferencesItemKey, &key)) {
     LOG(ERROR) << "Fail to remove preferences item.";
-    return result;
+    return MakeWriteResult(false, extension_->preferences_version());
   }
 
   std::string old_value;
   if (!widget_storage_->GetValueByKey(key, &old_value)) {
     LOG(WARNING) << "You are trying to remove an entry which doesn't exist."
                  << " Nothing will be done.";
-    result.reset(new base::Value(true));
-    return result;
+    return MakeWriteResult(true, extension_->preferences_version());
   }
 
-  if (widget_storage_->RemoveEntry(key)) {
-    result.reset(new base::Value(true));
-
-    std::unique_ptr<base::DictionaryValue> event(new base::DictionaryValue());
-    event->SetString("key", key);
-    event->SetString("oldValue", old_value);
-    event->SetString("newValue", "");
-    PostMessageToOtherFrames(std::move(event));
-  }
+  if (!widget_storage_->RemoveEntry(key))
+    return MakeWriteResult(false, extension_->preferences_version());
 
-  return result;
+  std::vector<std::unique_ptr<base::DictionaryValue>> events;
+  events.push_back(MakeStorageEvent(key, &old_value, nullptr));
+  return MakeWriteResult(
+      true, extension_->OnPreferencesChanged(this, std::move(events)));
 }
 
 std::unique_ptr<base::Value> AppWidgetExtensionInstance::ClearAllItems(
     std::unique_ptr<base::Value> msg) {
-  std::unique_ptr<base::Value> result(
-      new base::Value(false));
-
   std::unique_ptr<base::DictionaryValue> entries(new base::DictionaryValue());
   widget_storage_->GetAllEntries(entries.get());
 
   if (!widget_storage_->Clear())
-    return result;
+    return MakeWriteResult(false, extension_->preferences_version());
 
+  // Read-only entries survive a clear.
+  std::vector<std::unique_ptr<base::DictionaryValue>> events;
   for (base::DictionaryValue::Iterator it(*(entries.get()));
       !it.IsAtEnd(); it.Advance()) {
     std::string key = it.key();
     if (!widget_storage_->EntryExists(key)) {
       std::string old_value;
       it.value().GetAsString(&old_value);
-      std::unique_ptr<base::DictionaryValue> event(new base::DictionaryValue());
-      event->SetString("key", key);
-      event->SetString("oldValue", old_value);
-      event->SetString("newValue", "");
-      PostMessageToOtherFrames(std::move(event));
+      events.push_back(MakeStorageEvent(key, &old_value, nullptr));
     }
   }
 
-  result.reset(new base::Value(true));
-  return result;
+  int version = extension_->preferences_version();
+  if (!events.empty())
+    version = extension_->OnPreferencesChanged(this, std::move(events));
+  return MakeWriteResult(true, version);
 }
 
 std::unique_ptr<base::DictionaryValue> AppWidgetExtensionInstance::GetAllItems(
@@ -285,6 +316,18 @@ std::unique_ptr<base::DictionaryValue> AppWidgetExtensionInstance::GetAllItems(
   return result;
 }
 
+std::unique_ptr<base::DictionaryValue>
+AppWidgetExtensionInstance::GetPreferencesSnapshot(
+    std::unique_ptr<base::Value> msg) {
+  std::unique_ptr<base::DictionaryValue> items(new base::DictionaryValue());
+  widget_storage_->GetAllEntries(items.get());
+
+  std::unique_ptr<base::DictionaryValue> result(new base::DictionaryValue());
+  result->Set("items", std::move(items));
+  result->SetInteger("version", extension_->preferences_version());
+  return result;
+}
+
 std::unique_ptr<base::Value> AppWidgetExtensionInstance::GetItemValueByKey(
     std::unique_ptr<base::Value> msg) {
   base::DictionaryValue* dict;
@@ -318,17 +361,5 @@ std::unique_ptr<base::Value> AppWidgetExtensionInstance::KeyExists(
   return result;
 }
 
-void AppWidgetExtensionInstance::PostMessageToOtherFrames(
-    std::unique_ptr<base::DictionaryValue> msg) {
-  const std::vector<Runtime*>& runtime_set = application_->runtimes();
-  std::vector<Runtime*>::const_iterator it;
-  for (it = runtime_set.begin(); it != runtime_set.end(); ++it) {
-    content::WebContents* web_contents = (*it)->web_contents();
-    web_contents->ForEachFrame(base::Bind(&DispatchStorageEvent,
-                                          msg.get(),
-                                          web_contents));
-  }
-}
-
 }  // namespace application
 }  // namespace xwalk
@@ -5,31 +5,68 @@
 #ifndef XWALK_APPLICATION_EXTENSION_APPLICATION_WIDGET_EXTENSION_H_
 #define XWALK_APPLICATION_EXTENSION_APPLICATION_WIDGET_EXTENSION_H_
 
+#include <memory>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "base/memory/weak_ptr.h"
+#include "base/values.h"
 #include "xwalk/extensions/common/xwalk_extension.h"
 
 namespace xwalk {
 namespace application {
 class Application;
+class AppWidgetExtensionInstance;
 
 using extensions::XWalkExtension;
 using extensions::XWalkExtensionInstance;
 
+// Every frame of the widget keeps a snapshot of widget.preferences and serves
+// reads from it. The extension numbers each change of the preferences with a
+// version and tells the other frames about it, in batches: all changes made
+// while handling one task are sent as a single "StorageEvents" message. A
+// frame that finds a gap between its version and the one a batch starts from
+// fetches a new snapshot.
 class ApplicationWidgetExtension : public XWalkExtension {
  public:
   explicit ApplicationWidgetExtension(Application* application);
+  ~ApplicationWidgetExtension() override;
 
   // XWalkExtension implementation.
   XWalkExtensionInstance* CreateInstance() override;
 
+  void AddInstance(AppWidgetExtensionInstance* instance);
+  void RemoveInstance(AppWidgetExtensionInstance* instance);
+
+  int preferences_version() const { return preferences_version_; }
+
+  // Bumps the version for a change made by |source| and queues |events| for
+  // the other instances. Returns the new version.
+  int OnPreferencesChanged(
+      AppWidgetExtensionInstance* source,
+      std::vector<std::unique_ptr<base::DictionaryValue>> events);
+
  private:
+  void FlushStorageEvents();
+
   Application* application_;
+  std::set<AppWidgetExtensionInstance*> instances_;
+
+  int preferences_version_;
+  // Version the pending batch starts from.
+  int pending_base_version_;
+  std::vector<std::pair<AppWidgetExtensionInstance*,
+                        std::unique_ptr<base::DictionaryValue>>>
+      pending_events_;
+  base::WeakPtrFactory<ApplicationWidgetExtension> weak_factory_;
 };
 
 class AppWidgetExtensionInstance : public XWalkExtensionInstance {
  public:
-  explicit AppWidgetExtensionInstance(Application* application);
+  AppWidgetExtensionInstance(Application* application,
+                             ApplicationWidgetExtension* extension);
   ~AppWidgetExtensionInstance() override;
 
   void HandleMessage(std::unique_ptr<base::Value> msg) override;
@@ -43,12 +80,13 @@ class AppWidgetExtensionInstance : public XWalkExtensionInstance {
       std::unique_ptr<base::Value> mgs);
   std::unique_ptr<base::Value> ClearAllItems(std::unique_ptr<base::Value> mgs);
   std::unique_ptr<base::DictionaryValue> GetAllItems(std::unique_ptr<base::Value> mgs);
+  std::unique_ptr<base::DictionaryValue> GetPreferencesSnapshot(
+      std::unique_ptr<base::Value> mgs);
   std::unique_ptr<base::Value> GetItemValueByKey(std::unique_ptr<base::Value> mgs);
   std::unique_ptr<base::Value> KeyExists(
       std::unique_ptr<base::Value> mgs) const;
-  void PostMessageToOtherFrames(std::unique_ptr<base::DictionaryValue> msg);
-
   Application* application_;
+  ApplicationWidgetExtension* extension_;
   std::unique_ptr<class AppWidgetStorage> widget_storage_;
 };
 
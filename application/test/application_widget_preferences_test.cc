@@ -0,0 +1,72 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/json/json_reader.h"
+#include "base/values.h"
+#include "content/public/test/browser_test_utils.h"
+#include "xwalk/application/common/application_file_util.h"
+#include "xwalk/application/test/application_browsertest.h"
+#include "xwalk/application/test/application_testapi.h"
+#include "xwalk/runtime/browser/runtime.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+
+using xwalk::application::Application;
+using xwalk::application::Manifest;
+using xwalk::application::GetManifestPath;
+
+namespace {
+
+std::vector<double> GetSamples(const base::Value& results, const char* key) {
+  std::vector<double> samples;
+  const base::Value* list = results.FindKeyOfType(key, base::Value::Type::LIST);
+  if (!list)
+    return samples;
+  for (const base::Value& sample : list->GetList()) {
+    if (sample.is_double() || sample.is_int())
+      samples.push_back(sample.GetDouble());
+  }
+  return samples;
+}
+
+}  // namespace
+
+class ApplicationWidgetPreferencesTest : public ApplicationBrowserTest {
+};
+
+// The page does 10k widget.preferences reads and 1k writes, timed in small
+// batches, and hands back the time per operation of every batch. It only
+// uses the public API, so running it against an older tree gives the numbers
+// to compare with.
+IN_PROC_BROWSER_TEST_F(ApplicationWidgetPreferencesTest, ReadWriteLatency) {
+  base::FilePath manifest_path = GetManifestPath(
+      test_data_dir_.Append(FILE_PATH_LITERAL("widget_preferences")),
+      Manifest::TYPE_WIDGET);
+  Application* app = application_sevice()->LaunchFromManifestPath(
+      manifest_path, Manifest::TYPE_WIDGET);
+  ASSERT_TRUE(app);
+  test_runner_->WaitForTestNotification();
+  ASSERT_EQ(test_runner_->GetTestsResult(), ApiTestRunner::PASS);
+
+  ASSERT_FALSE(app->runtimes().empty());
+  std::string json;
+  ASSERT_TRUE(content::ExecuteScriptAndExtractString(
+      app->runtimes()[0]->web_contents(),
+      "window.domAutomationController.send(JSON.stringify(results));", &json));
+  std::unique_ptr<base::Value> results = base::JSONReader::ReadDeprecated(json);
+  ASSERT_TRUE(results && results->is_dict());
+
+  std::vector<double> read_us = GetSamples(*results, "read");
+  std::vector<double> write_us = GetSamples(*results, "write");
+  ASSERT_EQ(100u, read_us.size());
+  ASSERT_EQ(100u, write_us.size());
+  XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+      "widget_preferences_read", "", std::move(read_us)));
+  XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+      "widget_preferences_write", "", std::move(write_us)));
+}
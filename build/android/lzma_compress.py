@@ -6,9 +6,13 @@
 # pylint: disable=F0401
 
 import argparse
+import multiprocessing
 import os
 import shutil
+import struct
+import subprocess
 import sys
+import zlib
 
 GYP_ANDROID_DIR = os.path.join(os.path.dirname(__file__),
                                os.pardir, os.pardir, os.pardir,
@@ -19,6 +23,53 @@ sys.path.append(GYP_ANDROID_DIR)
 
 from util import build_utils
 
+# Chunked container read by xwalk/tools/chunked_lzma/chunked_lzma_reader.h,
+# see there for the layout.
+CHUNKED_MAGIC = b'XWLZCHK1'
+CHUNKED_HEADER = struct.Struct('<8sIIQ')
+CHUNKED_INDEX_ENTRY = struct.Struct('<QII')
+# Size of the properties and the 64-bit size field of an .lzma file.
+LZMA_PROPS_SIZE = 5
+LZMA_ALONE_HEADER_SIZE = LZMA_PROPS_SIZE + 8
+
+
+def _CompressAlone(data):
+  try:
+    import lzma
+    return lzma.compress(data, format=lzma.FORMAT_ALONE)
+  except ImportError:
+    process = subprocess.Popen(['lzma', '-z', '-c'], stdin=subprocess.PIPE,
+                               stdout=subprocess.PIPE)
+    output, _ = process.communicate(data)
+    if process.returncode:
+      raise Exception('lzma failed with exit code %d' % process.returncode)
+    return output
+
+
+def _CompressBlock(data):
+  compressed = _CompressAlone(data)
+  # Each block keeps its own properties but drops the size field, the
+  # uncompressed size of a block is implied by the header.
+  return (compressed[:LZMA_PROPS_SIZE] + compressed[LZMA_ALONE_HEADER_SIZE:],
+          zlib.crc32(data) & 0xffffffff)
+
+
+def CompressChunked(source, dest, block_size, pool):
+  with open(source, 'rb') as f:
+    data = f.read()
+  blocks = [data[i:i + block_size] for i in range(0, len(data), block_size)]
+  compressed = pool.map(_CompressBlock, blocks)
+
+  offset = CHUNKED_HEADER.size + CHUNKED_INDEX_ENTRY.size * len(blocks)
+  with open(dest, 'wb') as f:
+    f.write(CHUNKED_HEADER.pack(CHUNKED_MAGIC, block_size, len(blocks),
+                                len(data)))
+    for block, crc in compressed:
+      f.write(CHUNKED_INDEX_ENTRY.pack(offset, len(block), crc))
+      offset += len(block)
+    for block, _ in compressed:
+      f.write(block)
+
 
 def main():
   parser = argparse.ArgumentParser()
@@ -26,16 +77,33 @@ def main():
                       help='Destination directory for compressed files.')
   parser.add_argument('--sources', required=True,
                       help='The list of files to be compressed.')
+  parser.add_argument('--chunked', action='store_true',
+                      help='Write seekable .clzma files made of independently '
+                      'compressed blocks instead of plain .lzma files.')
+  parser.add_argument('--block-size', type=int, default=1024 * 1024,
+                      help='Uncompressed block size for --chunked.')
 
   options = parser.parse_args()
   options.sources = build_utils.ParseGypList(options.sources)
 
   with build_utils.TempDir() as temp_dir:
-    for source in options.sources:
-      shutil.copy2(source, temp_dir)
-      file_to_compress = os.path.join(temp_dir, os.path.basename(source))
-      build_utils.CheckOutput(['lzma', '-f', file_to_compress],
-                              print_stderr=True)
+    if options.chunked:
+      pool = multiprocessing.Pool()
+      try:
+        for source in options.sources:
+          CompressChunked(source,
+                          os.path.join(temp_dir,
+                                       os.path.basename(source) + '.clzma'),
+                          options.block_size, pool)
+      finally:
+        pool.close()
+        pool.join()
+    else:
+      for source in options.sources:
+        shutil.copy2(source, temp_dir)
+        file_to_compress = os.path.join(temp_dir, os.path.basename(source))
+        build_utils.CheckOutput(['lzma', '-f', file_to_compress],
+                                print_stderr=True)
     build_utils.DeleteDirectory(options.dest_path)
     shutil.copytree(temp_dir, options.dest_path)
 
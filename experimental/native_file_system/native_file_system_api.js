@@ -34,6 +34,38 @@ class NativeFileSystem {
           success(isolated_fs.getIsolatedFileSystem(filesystem_id));
       });
   }
+
+  // Lists |path| ("<virtual root>/<relative path>") in chunks.
+  // |onEntries(entries, done)| is called once per chunk with an array of
+  // {name, isDirectory, size, lastModified} objects, |done| is true on the
+  // last call. |chunkSize| is optional.
+  readDirectory(path, onEntries, error, chunkSize) {
+    if (typeof path !== "string" || !(onEntries instanceof Function)) {
+      throw new TypeError("Wrong parameters passed to readDirectory.");
+    }
+    error = error || (_ => {});
+
+    internal.postMessage(
+      "readDirectory", [path, chunkSize || 0],
+      (chunk, done, error_message) => {
+        if (error_message) {
+          error(new Error(error_message));
+          return false;
+        }
+        let entries = new Array(chunk.names.length);
+        for (let i = 0; i < entries.length; i++) {
+          entries[i] = {
+            name: chunk.names[i],
+            isDirectory: chunk.isDirectory[i],
+            size: chunk.size[i],
+            lastModified: new Date(chunk.lastModified[i])
+          };
+        }
+        onEntries(entries, done);
+        // Keep the callback registered until the last chunk.
+        return !done;
+      });
+  }
 }
 
 exports = new NativeFileSystem();
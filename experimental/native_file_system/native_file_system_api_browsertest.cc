@@ -2,14 +2,21 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/json/json_reader.h"
 #include "base/path_service.h"
+#include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/threading/thread_restrictions.h"
+#include "base/values.h"
 #include "content/public/test/browser_test_utils.h"
 #include "content/public/test/test_utils.h"
 #include "net/base/filename_util.h"
 #include "xwalk/experimental/native_file_system/virtual_root_provider.h"
 #include "xwalk/runtime/browser/runtime.h"
 #include "xwalk/test/base/in_process_browser_test.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
 #include "xwalk/test/base/xwalk_test_utils.h"
 
 IN_PROC_BROWSER_TEST_F(InProcessBrowserTest, NativeFileSystem) {
@@ -37,3 +44,70 @@ IN_PROC_BROWSER_TEST_F(InProcessBrowserTest, NativeFileSystem) {
   xwalk_test_utils::NavigateToURL(runtime, net::FilePathToFileURL(test_file));
   EXPECT_EQ(passString, title_watcher.WaitAndGetTitle());
 }
+
+#if defined(OS_LINUX)
+// Lists a directory of 50k files through readDirectory() and reports how
+// long the first chunk and the whole listing took.
+IN_PROC_BROWSER_TEST_F(InProcessBrowserTest, NativeFileSystemReadDirectory) {
+  const int kFileCount = 50000;
+  const base::string16 passString = base::ASCIIToUTF16("Pass");
+  const base::string16 failString = base::ASCIIToUTF16("Fail");
+
+  VirtualRootProvider::SetTesting(true);
+  const base::FilePath documents = base::FilePath::FromUTF8Unsafe(
+      VirtualRootProvider::GetInstance()->GetRealPath("documents"));
+  ASSERT_FALSE(documents.empty());
+
+  base::ScopedAllowBlockingForTesting allow_blocking;
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDirUnderPath(documents));
+  for (int i = 0; i < kFileCount; ++i) {
+    ASSERT_EQ(1, base::WriteFile(temp_dir.GetPath().AppendASCII(
+                                     base::StringPrintf("file%05d.txt", i)),
+                                 "x", 1));
+  }
+
+  xwalk::Runtime* runtime = CreateRuntime();
+  content::TitleWatcher title_watcher(runtime->web_contents(), passString);
+  title_watcher.AlsoWaitForTitle(failString);
+
+  base::FilePath test_file;
+  base::PathService::Get(base::DIR_SOURCE_ROOT, &test_file);
+  test_file = test_file
+      .Append(FILE_PATH_LITERAL("xwalk"))
+      .Append(FILE_PATH_LITERAL("experimental"))
+      .Append(FILE_PATH_LITERAL("native_file_system"))
+      .Append(FILE_PATH_LITERAL(
+          "native_file_system_read_directory_browsertest.html"));
+  GURL url = net::FilePathToFileURL(test_file);
+  GURL::Replacements replacements;
+  const std::string query = "dir=" + temp_dir.GetPath().BaseName().value();
+  replacements.SetQueryStr(query);
+
+  xwalk_test_utils::NavigateToURL(runtime, url.ReplaceComponents(replacements));
+  ASSERT_EQ(passString, title_watcher.WaitAndGetTitle());
+
+  std::string json;
+  ASSERT_TRUE(content::ExecuteScriptAndExtractString(
+      runtime->web_contents(),
+      "window.domAutomationController.send(JSON.stringify(result));", &json));
+  base::Optional<base::Value> result = base::JSONReader::Read(json);
+  ASSERT_TRUE(result && result->is_dict());
+
+  EXPECT_EQ(kFileCount, result->FindIntKey("count").value_or(0));
+  const int chunks = result->FindIntKey("chunks").value_or(0);
+  // Far fewer round trips than entries.
+  EXPECT_LT(chunks, kFileCount / 100);
+
+  base::Optional<double> first_entry_ms = result->FindDoubleKey("firstEntryMs");
+  base::Optional<double> total_ms = result->FindDoubleKey("totalMs");
+  ASSERT_TRUE(first_entry_ms && total_ms);
+  XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+      "native_file_system_read_directory_first_entry", "_50k",
+      {*first_entry_ms * 1000}));
+  XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+      "native_file_system_read_directory_total", "_50k", {*total_ms * 1000}));
+  XWalkBenchmark::ReportValue("native_file_system_read_directory_chunks",
+                              "_50k", "count", chunks);
+}
+#endif  // defined(OS_LINUX)
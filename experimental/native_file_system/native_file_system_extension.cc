@@ -4,11 +4,15 @@
 
 #include "xwalk/experimental/native_file_system/native_file_system_extension.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 
 #include "base/callback.h"
+#include "base/files/file_enumerator.h"
+#include "base/files/file_util.h"
 #include "base/memory/ptr_util.h"
+#include "base/task/post_task.h"
 #include "base/values.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/child_process_security_policy.h"
@@ -23,6 +27,12 @@ using namespace xwalk::jsapi::native_file_system;
 
 namespace {
 
+// The first chunk is kept small so the page can start rendering a listing
+// right away, later chunks double up to the size the caller asked for.
+const int kFirstChunkSize = 64;
+const int kDefaultChunkSize = 1000;
+const int kMaxChunkSize = 10000;
+
 std::unique_ptr<base::Value> GetRealPath(std::unique_ptr<base::Value> msg) {
   base::DictionaryValue* dict;
   std::string virtual_root;
@@ -59,6 +69,43 @@ void RegisterFileSystemAndSendResponse(
       RequestNativeFileSystem::Results::Create(filesystem_id, std::string()));
 }
 
+// Runs on a blocking pool thread. PostResult() may be called from any thread,
+// each chunk is delivered to the same JS callback.
+void ReadDirectoryAndPostChunks(
+    const base::FilePath& path,
+    int max_chunk_size,
+    std::unique_ptr<xwalk::experimental::XWalkExtensionFunctionInfo> info) {
+  if (!base::DirectoryExists(path)) {
+    info->PostResult(
+        ReadDirectory::Results::Create(DirectoryChunk(), true,
+                                       "Not a directory."));
+    return;
+  }
+
+  size_t chunk_size = std::min(kFirstChunkSize, max_chunk_size);
+  DirectoryChunk chunk;
+  base::FileEnumerator enumerator(
+      path, false,
+      base::FileEnumerator::FILES | base::FileEnumerator::DIRECTORIES);
+  for (base::FilePath name = enumerator.Next(); !name.empty();
+       name = enumerator.Next()) {
+    // The enumerator already stat()ed the entry, GetInfo() costs nothing.
+    base::FileEnumerator::FileInfo file_info = enumerator.GetInfo();
+    chunk.names.push_back(file_info.GetName().AsUTF8Unsafe());
+    chunk.is_directory.push_back(file_info.IsDirectory());
+    chunk.size.push_back(static_cast<double>(file_info.GetSize()));
+    chunk.last_modified.push_back(file_info.GetLastModifiedTime().ToJsTime());
+
+    if (chunk.names.size() >= chunk_size) {
+      info->PostResult(
+          ReadDirectory::Results::Create(chunk, false, std::string()));
+      chunk = DirectoryChunk();
+      chunk_size = std::min<size_t>(chunk_size * 2, max_chunk_size);
+    }
+  }
+  info->PostResult(ReadDirectory::Results::Create(chunk, true, std::string()));
+}
+
 }  // namespace
 
 namespace xwalk {
@@ -87,6 +134,10 @@ NativeFileSystemInstance::NativeFileSystemInstance(
       "requestNativeFileSystem",
       base::Bind(&NativeFileSystemInstance::OnRequestNativeFileSystem,
                  base::Unretained(this)));
+  handler_.Register(
+      "readDirectory",
+      base::Bind(&NativeFileSystemInstance::OnReadDirectory,
+                 base::Unretained(this)));
 }
 
 void NativeFileSystemInstance::HandleMessage(std::unique_ptr<base::Value> msg) {
@@ -116,6 +167,34 @@ void NativeFileSystemInstance::OnRequestNativeFileSystem(
   }
 }
 
+void NativeFileSystemInstance::OnReadDirectory(
+    std::unique_ptr<XWalkExtensionFunctionInfo> info) {
+  std::unique_ptr<ReadDirectory::Params> params(
+      ReadDirectory::Params::Create(*info->arguments()));
+  if (!params) {
+    LOG(ERROR) << "Malformed parameters passed to " << info->name();
+    return;
+  }
+
+  const base::FilePath path =
+      VirtualRootProvider::GetInstance()->ResolvePath(params->path);
+  if (path.empty()) {
+    info->PostResult(ReadDirectory::Results::Create(
+        DirectoryChunk(), true, "Invalid virtual path."));
+    return;
+  }
+
+  int chunk_size = params->chunk_size > 0
+                       ? std::min(params->chunk_size, kMaxChunkSize)
+                       : kDefaultChunkSize;
+  base::PostTaskWithTraits(
+      FROM_HERE,
+      {base::MayBlock(), base::TaskPriority::USER_VISIBLE,
+       base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN},
+      base::BindOnce(&ReadDirectoryAndPostChunks, path, chunk_size,
+                     std::move(info)));
+}
+
 void NativeFileSystemInstance::HandleSyncMessage(std::unique_ptr<base::Value> msg) {
   base::DictionaryValue* dict;
   std::string command;
@@ -42,6 +42,9 @@ class NativeFileSystemInstance : public XWalkExtensionInstance {
 
  private:
   void OnRequestNativeFileSystem(std::unique_ptr<XWalkExtensionFunctionInfo> info);
+  // Streams the entries of a directory below a virtual root in chunks, with
+  // their stat metadata, instead of one round trip per entry.
+  void OnReadDirectory(std::unique_ptr<XWalkExtensionFunctionInfo> info);
 
   XWalkExtensionFunctionHandler handler_;
   content::RenderProcessHost* host_;
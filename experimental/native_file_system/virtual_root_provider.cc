@@ -4,12 +4,11 @@
 
 #include "xwalk/experimental/native_file_system/virtual_root_provider.h"
 
-#include <algorithm>
-#include <cctype>
 #include <string>
 
 #include "base/lazy_instance.h"
 #include "base/macros.h"
+#include "base/strings/string_util.h"
 
 namespace {
 
@@ -22,10 +21,30 @@ VirtualRootProvider* VirtualRootProvider::GetInstance() {
 }
 
 std::string VirtualRootProvider::GetRealPath(const std::string& virtual_root) {
-  std::string uppercase_virtual_root = virtual_root;
-  std::transform(virtual_root.begin(), virtual_root.end(),
-                 uppercase_virtual_root.begin(), ::toupper);
-  return virtual_root_map_[uppercase_virtual_root].AsUTF8Unsafe();
+  const std::string key = base::ToUpperASCII(virtual_root);
+  base::AutoLock lock(lock_);
+  auto it = virtual_root_map_.find(key);
+  if (it == virtual_root_map_.end())
+    return std::string();
+  return it->second.AsUTF8Unsafe();
+}
+
+base::FilePath VirtualRootProvider::ResolvePath(
+    const std::string& virtual_path) {
+  const size_t separator = virtual_path.find('/');
+  const std::string root = GetRealPath(virtual_path.substr(0, separator));
+  if (root.empty())
+    return base::FilePath();
+
+  base::FilePath path = base::FilePath::FromUTF8Unsafe(root);
+  if (separator == std::string::npos)
+    return path;
+
+  base::FilePath relative =
+      base::FilePath::FromUTF8Unsafe(virtual_path.substr(separator + 1));
+  if (relative.IsAbsolute() || relative.ReferencesParent())
+    return base::FilePath();
+  return relative.empty() ? path : path.Append(relative);
 }
 
 VirtualRootProvider::~VirtualRootProvider() {}
@@ -6,36 +6,92 @@
 #define XWALK_EXPERIMENTAL_NATIVE_FILE_SYSTEM_VIRTUAL_ROOT_PROVIDER_H_
 
 #include <map>
+#include <memory>
 #include <string>
 
 #include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/synchronization/lock.h"
+#include "build/build_config.h"
+
+#if defined(OS_LINUX)
+#include "base/memory/ref_counted.h"
+#include "base/sequenced_task_runner.h"
+#endif
 
 namespace base {
 
 template <typename Type>
 struct LazyInstanceTraitsBase;
 
+#if defined(OS_LINUX)
+class FilePathWatcher;
+#endif
+
 }  // namespace base
 
+// Maps virtual root names such as "documents" to real directories. The table
+// is built once, lookups only take a lock and do a map search. On Linux it
+// follows the XDG user dirs configuration and is rebuilt when that file
+// changes. Safe to use from any thread.
 class VirtualRootProvider {
  public:
+  typedef std::map<std::string, base::FilePath> VirtualRootMap;
+
   static VirtualRootProvider* GetInstance();
+
+  // Returns the directory |virtual_root| (case insensitive) maps to, or an
+  // empty string if there is none.
   std::string GetRealPath(const std::string& virtual_root);
+
+  // Resolves "<virtual root>/<relative path>" to a real path. Returns an empty
+  // path for unknown roots and for relative paths that are absolute or
+  // reference a parent, so callers cannot escape the root.
+  base::FilePath ResolvePath(const std::string& virtual_path);
+
 #if defined(OS_LINUX) || defined(OS_WIN)
   static void SetTesting(bool test);
 #endif
 
+#if defined(OS_LINUX)
+  // Builds the table from the contents of an XDG user-dirs.dirs file. Roots
+  // the file does not mention keep their default below |home|.
+  static VirtualRootMap ParseUserDirs(const std::string& contents,
+                                      const base::FilePath& home);
+#endif
+
  private:
   friend struct base::LazyInstanceTraitsBase<VirtualRootProvider>;
   VirtualRootProvider();
   ~VirtualRootProvider();
 
+#if defined(OS_LINUX)
+  // Reloads the table from |user_dirs_path_|. Runs on |watcher_task_runner_|
+  // when the file changes.
+  void ReloadUserDirs();
+  void StartWatching();
+  void OnUserDirsChanged(const base::FilePath& path, bool error);
+#endif
+
   base::FilePath home_path_;
-  std::map<std::string, base::FilePath> virtual_root_map_;
+
+  // Guards |virtual_root_map_|, which is replaced when the XDG configuration
+  // changes.
+  base::Lock lock_;
+  VirtualRootMap virtual_root_map_;
+
 #if defined(OS_LINUX) || defined(OS_WIN)
   static bool testing_enabled_;
 #endif
 
+#if defined(OS_LINUX)
+  base::FilePath user_dirs_path_;
+  scoped_refptr<base::SequencedTaskRunner> watcher_task_runner_;
+  // Lives and dies on |watcher_task_runner_|. The provider is leaked, so in
+  // practice it is never destroyed.
+  std::unique_ptr<base::FilePathWatcher> user_dirs_watcher_;
+#endif
+
   DISALLOW_COPY_AND_ASSIGN(VirtualRootProvider);
 };
 
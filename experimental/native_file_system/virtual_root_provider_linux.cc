@@ -5,10 +5,41 @@
 #include "xwalk/experimental/native_file_system/virtual_root_provider.h"
 
 #include <map>
+#include <memory>
 #include <string>
 
+#include "base/bind.h"
+#include "base/environment.h"
 #include "base/files/file_path.h"
+#include "base/files/file_path_watcher.h"
 #include "base/files/file_util.h"
+#include "base/nix/xdg_util.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "base/task/post_task.h"
+
+namespace {
+
+struct XdgUserDir {
+  const char* key;
+  const char* virtual_root;
+  const char* default_name;
+};
+
+// The XDG keys we expose and where they point when user-dirs.dirs does not
+// say otherwise.
+const XdgUserDir kUserDirs[] = {
+    {"XDG_DESKTOP_DIR", "DESKTOP", "Desktop"},
+    {"XDG_DOWNLOAD_DIR", "DOWNLOADS", "Downloads"},
+    {"XDG_DOCUMENTS_DIR", "DOCUMENTS", "Documents"},
+    {"XDG_MUSIC_DIR", "MUSIC", "Music"},
+    {"XDG_PICTURES_DIR", "PICTURES", "Pictures"},
+    {"XDG_VIDEOS_DIR", "VIDEOS", "Videos"},
+};
+
+const char kUserDirsFileName[] = "user-dirs.dirs";
+
+}  // namespace
 
 bool VirtualRootProvider::testing_enabled_ = false;
 
@@ -25,17 +56,102 @@ VirtualRootProvider::VirtualRootProvider() {
 
   home_path_ = base::GetHomeDir();
 
-  // TODO(shawngao5): Hard code virtual root mapping for linux here.
-  // In future, it should be removed by parsing xdg configure file for
-  // user direcory.
-  virtual_root_map_["DESKTOP"] = home_path_.Append("Desktop");
-  virtual_root_map_["DOWNLOADS"] = home_path_.Append("Downloads");
-  virtual_root_map_["DOCUMENTS"] = home_path_.Append("Documents");
-  virtual_root_map_["MUSIC"] = home_path_.Append("Music");
-  virtual_root_map_["PICTURES"] = home_path_.Append("Pictures");
-  virtual_root_map_["VIDEOS"] = home_path_.Append("Videos");
+  std::unique_ptr<base::Environment> env(base::Environment::Create());
+  user_dirs_path_ =
+      base::nix::GetXDGDirectory(env.get(), base::nix::kXdgConfigHomeEnvVar,
+                                 base::nix::kDotConfigDir)
+          .Append(kUserDirsFileName);
+
+  // The file is tiny, read it right away so the first lookup is correct.
+  ReloadUserDirs();
+
+  watcher_task_runner_ = base::CreateSequencedTaskRunnerWithTraits(
+      {base::MayBlock(), base::TaskPriority::BEST_EFFORT,
+       base::TaskShutdownBehavior::CONTINUE_ON_SHUTDOWN});
+  watcher_task_runner_->PostTask(
+      FROM_HERE, base::BindOnce(&VirtualRootProvider::StartWatching,
+                                base::Unretained(this)));
 }
 
 void VirtualRootProvider::SetTesting(bool testing_enabled) {
   testing_enabled_ = testing_enabled;
 }
+
+// static
+VirtualRootProvider::VirtualRootMap VirtualRootProvider::ParseUserDirs(
+    const std::string& contents,
+    const base::FilePath& home) {
+  std::map<std::string, std::string> values;
+  for (const base::StringPiece& line : base::SplitStringPiece(
+           contents, "\n", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    if (line.starts_with("#"))
+      continue;
+    const size_t equals = line.find('=');
+    if (equals == base::StringPiece::npos)
+      continue;
+    base::StringPiece value = line.substr(equals + 1);
+    // Values are always double quoted, see xdg-user-dirs-update(1).
+    if (value.size() < 2 || !value.starts_with("\"") || !value.ends_with("\""))
+      continue;
+    values[line.substr(0, equals).as_string()] =
+        value.substr(1, value.size() - 2).as_string();
+  }
+
+  VirtualRootMap map;
+  for (const XdgUserDir& dir : kUserDirs) {
+    auto it = values.find(dir.key);
+    if (it == values.end()) {
+      map[dir.virtual_root] = home.Append(dir.default_name);
+      continue;
+    }
+
+    // Only "$HOME/..." and absolute paths are allowed. A directory set to
+    // the home directory itself is disabled.
+    base::FilePath path;
+    const std::string& value = it->second;
+    if (base::StartsWith(value, "$HOME", base::CompareCase::SENSITIVE)) {
+      std::string relative;
+      base::TrimString(value.substr(5), "/", &relative);
+      if (relative.empty())
+        continue;
+      path = home.Append(relative);
+    } else if (!value.empty() && value[0] == '/') {
+      path = base::FilePath(value);
+    } else {
+      map[dir.virtual_root] = home.Append(dir.default_name);
+      continue;
+    }
+    if (path.StripTrailingSeparators() != home)
+      map[dir.virtual_root] = path;
+  }
+  return map;
+}
+
+void VirtualRootProvider::ReloadUserDirs() {
+  // A missing file is not an error, it just means every root keeps its
+  // default.
+  std::string contents;
+  base::ReadFileToString(user_dirs_path_, &contents);
+  VirtualRootMap map = ParseUserDirs(contents, home_path_);
+
+  base::AutoLock lock(lock_);
+  virtual_root_map_.swap(map);
+}
+
+void VirtualRootProvider::StartWatching() {
+  user_dirs_watcher_.reset(new base::FilePathWatcher);
+  if (!user_dirs_watcher_->Watch(
+          user_dirs_path_, false,
+          base::BindRepeating(&VirtualRootProvider::OnUserDirsChanged,
+                              base::Unretained(this)))) {
+    LOG(WARNING) << "Cannot watch " << user_dirs_path_.value()
+                 << ", virtual roots will not follow changes to it.";
+    user_dirs_watcher_.reset();
+  }
+}
+
+void VirtualRootProvider::OnUserDirsChanged(const base::FilePath& path,
+                                            bool error) {
+  if (!error)
+    ReloadUserDirs();
+}
@@ -5,10 +5,13 @@
 #include "xwalk/extensions/browser/xwalk_extension_process_host.h"
 
 #include <string>
+#include <utility>
 
+#include "base/bind.h"
 #include "base/command_line.h"
 #include "base/logging.h"
 #include "base/files/file_path.h"
+#include "base/memory/ptr_util.h"
 #include "content/public/browser/browser_child_process_host.h"
 #include "content/public/browser/browser_thread.h"
 #include "content/public/browser/render_process_host.h"
@@ -21,9 +24,11 @@
 #include "ipc/ipc_message.h"
 #include "ipc/message_filter.h"
 #include "services/service_manager/sandbox/sandbox_type.h"
+#include "xwalk/extensions/common/xwalk_extension_ipc_names.h"
 #include "xwalk/extensions/common/xwalk_extension_messages.h"
 #include "xwalk/extensions/common/xwalk_extension_switches.h"
 #include "xwalk/runtime/browser/xwalk_runner.h"
+#include "xwalk/runtime/common/xwalk_ipc_accounting.h"
 #include "xwalk/runtime/common/xwalk_switches.h"
 
 // TODO(iotto) for implementation details see components/nacl/browser/nacl_process_host.cc
@@ -42,15 +47,16 @@ namespace extensions {
 class XWalkExtensionProcessHost::RenderProcessMessageFilter
     : public IPC::MessageFilter {
  public:
-  explicit RenderProcessMessageFilter(XWalkExtensionProcessHost* eph)
-      : eph_(eph) {}
+  RenderProcessMessageFilter(XWalkExtensionProcessHost* eph,
+                             content::RenderProcessHost* render_process_host)
+      : eph_(eph), render_process_host_(render_process_host) {}
 
   // This exists to fulfill the requirement for delayed reply handling, since it
   // needs to send a message back if the parameters couldn't be correctly read
   // from the original message received. See DispatchDealyReplyWithSendParams().
   bool Send(IPC::Message* message) {
     if (eph_)
-      return eph_->render_process_host_->Send(message);
+      return render_process_host_->Send(message);
     delete message;
     return false;
   }
@@ -81,6 +87,7 @@ class XWalkExtensionProcessHost::RenderProcessMessageFilter
   ~RenderProcessMessageFilter() override {}
 
   XWalkExtensionProcessHost* eph_;
+  content::RenderProcessHost* render_process_host_;
 };
 
 class ExtensionSandboxedProcessLauncherDelegate
@@ -129,18 +136,26 @@ bool XWalkExtensionProcessHost::Delegate::OnRegisterPermissions(
 
 XWalkExtensionProcessHost::XWalkExtensionProcessHost(
     content::RenderProcessHost* render_process_host,
+    const base::FilePath& external_extensions_path,
+    XWalkExtensionProcessHost::Delegate* delegate,
+    std::unique_ptr<base::DictionaryValue::DictStorage> runtime_variables)
+    : XWalkExtensionProcessHost(external_extensions_path, delegate,
+                                std::move(runtime_variables)) {
+  AttachToRenderProcess(render_process_host);
+}
+
+XWalkExtensionProcessHost::XWalkExtensionProcessHost(
     const base::FilePath& external_extensions_path,
     XWalkExtensionProcessHost::Delegate* delegate,
     std::unique_ptr<base::DictionaryValue::DictStorage> runtime_variables)
     : ep_rp_channel_handle_(),
-      render_process_host_(render_process_host),
-      render_process_message_filter_(new RenderProcessMessageFilter(this)),
+      render_process_host_(nullptr),
+      render_process_id_(content::ChildProcessHost::kInvalidUniqueID),
       external_extensions_path_(external_extensions_path),
       is_extension_process_channel_ready_(false),
       delegate_(delegate),
       runtime_variables_(std::move(runtime_variables)) {
-  render_process_host_->GetChannel()->AddFilter(
-      render_process_message_filter_.get());
+  RegisterExtensionIPCNames();
   BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
       base::Bind(&XWalkExtensionProcessHost::StartProcess,
       base::Unretained(this)));
@@ -148,10 +163,46 @@ XWalkExtensionProcessHost::XWalkExtensionProcessHost(
 
 XWalkExtensionProcessHost::~XWalkExtensionProcessHost() {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::IO));
-  render_process_message_filter_->Invalidate();
+  if (render_process_message_filter_)
+    render_process_message_filter_->Invalidate();
   StopProcess();
 }
 
+void XWalkExtensionProcessHost::AttachToRenderProcess(
+    content::RenderProcessHost* render_process_host) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  DCHECK(!render_process_message_filter_);
+  {
+    base::AutoLock lock(render_process_id_lock_);
+    render_process_id_ = render_process_host->GetID();
+  }
+  // The filter is added on the IO thread before the task below runs, so the
+  // channel request can arrive first and is answered once attached.
+  render_process_message_filter_ =
+      new RenderProcessMessageFilter(this, render_process_host);
+  render_process_host->GetChannel()->AddFilter(
+      render_process_message_filter_.get());
+  BrowserThread::PostTask(BrowserThread::IO, FROM_HERE,
+      base::Bind(&XWalkExtensionProcessHost::OnAttachedToRenderProcess,
+      base::Unretained(this), render_process_host));
+}
+
+int XWalkExtensionProcessHost::GetRenderProcessID() const {
+  base::AutoLock lock(render_process_id_lock_);
+  return render_process_id_;
+}
+
+void XWalkExtensionProcessHost::OnAttachedToRenderProcess(
+    content::RenderProcessHost* render_process_host) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  render_process_host_ = render_process_host;
+  ReplyChannelHandleToRenderProcess();
+  std::vector<base::OnceClosure> requests;
+  requests.swap(pending_permission_requests_);
+  for (base::OnceClosure& request : requests)
+    std::move(request).Run();
+}
+
 namespace {
 
 void ToListValue(base::DictionaryValue::DictStorage* vm, base::ListValue* lv) {
@@ -202,6 +253,9 @@ void XWalkExtensionProcessHost::StartProcess() {
   std::unique_ptr<base::CommandLine> cmd_line(new base::CommandLine(exe_path));
   cmd_line->AppendSwitchASCII(switches::kProcessType,
                                 switches::kXWalkExtensionProcess);
+  if (base::CommandLine::ForCurrentProcess()->HasSwitch(
+          switches::kEnableIPCLatency))
+    cmd_line->AppendSwitch(switches::kEnableIPCLatency);
 //  cmd_line->AppendSwitchASCII(switches::kProcessChannelID, channel_id);
   if (!extension_cmd_prefix.empty())
     cmd_line->PrependWrapper(extension_cmd_prefix);
@@ -231,6 +285,9 @@ void XWalkExtensionProcessHost::OnGetExtensionProcessChannel(
 }
 
 bool XWalkExtensionProcessHost::OnMessageReceived(const IPC::Message& message) {
+  if (IPC_MESSAGE_CLASS(message) == XWalkExtensionMsgStart)
+    XWalkIPCAccounting::GetInstance()->DidDispatch(message);
+
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP(XWalkExtensionProcessHost, message)
     IPC_MESSAGE_HANDLER(
@@ -239,7 +296,7 @@ bool XWalkExtensionProcessHost::OnMessageReceived(const IPC::Message& message) {
     IPC_MESSAGE_HANDLER_DELAY_REPLY(
         XWalkExtensionProcessHostMsg_CheckAPIAccessControl,
         OnCheckAPIAccessControl)
-    IPC_MESSAGE_HANDLER(
+    IPC_MESSAGE_HANDLER_DELAY_REPLY(
         XWalkExtensionProcessHostMsg_RegisterPermissions,
         OnRegisterPermissions)
     IPC_MESSAGE_UNHANDLED(handled = false)
@@ -258,7 +315,7 @@ void XWalkExtensionProcessHost::OnChannelError() {
 
   VLOG(1) << "\n\nExtensionProcess crashed";
   if (delegate_)
-    delegate_->OnExtensionProcessDied(this, render_process_host_->GetID());
+    delegate_->OnExtensionProcessDied(this, GetRenderProcessID());
 }
 
 void XWalkExtensionProcessHost::OnProcessLaunched() {
@@ -271,18 +328,20 @@ void XWalkExtensionProcessHost::OnRenderChannelCreated(
   ep_rp_channel_handle_ = handle;
   ReplyChannelHandleToRenderProcess();
   if (delegate_)
-    delegate_->OnRenderChannelCreated(render_process_host_->GetID());
+    delegate_->OnRenderChannelCreated(GetRenderProcessID());
 }
 
 void XWalkExtensionProcessHost::ReplyChannelHandleToRenderProcess() {
-  // Replying the channel handle to RP depends on two events:
+  // Replying the channel handle to RP depends on three events:
   // - EP already notified EPH that new channel was created (for RP<->EP).
   // - RP already asked for the channel handle.
+  // - EPH was attached to RP, which for a spare EP happens last.
   //
   // The order for this events is not determined, so we call this function from
-  // both, and the second execution will send the reply.
+  // all of them, and the last execution will send the reply.
   if (!is_extension_process_channel_ready_
-      || !pending_reply_for_render_process_)
+      || !pending_reply_for_render_process_
+      || !render_process_host_)
     return;
 
   XWalkExtensionProcessHostMsg_GetExtensionProcessChannel::WriteReplyParams(
@@ -303,7 +362,7 @@ void XWalkExtensionProcessHost::OnCheckAPIAccessControl(
     const std::string& extension_name,
     const std::string& api_name, IPC::Message* reply_msg) {
   CHECK(delegate_);
-  delegate_->OnCheckAPIAccessControl(render_process_host_->GetID(),
+  delegate_->OnCheckAPIAccessControl(GetRenderProcessID(),
                                      extension_name, api_name,
       base::Bind(&XWalkExtensionProcessHost::ReplyAccessControlToExtension,
                  base::Unretained(this),
@@ -312,13 +371,34 @@ void XWalkExtensionProcessHost::OnCheckAPIAccessControl(
 
 void XWalkExtensionProcessHost::OnRegisterPermissions(
     const std::string& extension_name,
-    const std::string& perm_table, bool* result) {
+    const std::string& perm_table, IPC::Message* reply_msg) {
+  RegisterPermissionsForRenderProcess(extension_name, perm_table,
+                                      base::WrapUnique(reply_msg));
+}
+
+void XWalkExtensionProcessHost::RegisterPermissionsForRenderProcess(
+    const std::string& extension_name,
+    const std::string& perm_table,
+    std::unique_ptr<IPC::Message> reply_msg) {
   CHECK(delegate_);
-  *result = delegate_->OnRegisterPermissions(
-      render_process_host_->GetID(), extension_name, perm_table);
+  // Permissions are registered per render process. A spare registers its
+  // extensions before it has one, so the reply waits for the attach.
+  if (!render_process_host_) {
+    pending_permission_requests_.push_back(base::BindOnce(
+        &XWalkExtensionProcessHost::RegisterPermissionsForRenderProcess,
+        base::Unretained(this), extension_name, perm_table,
+        std::move(reply_msg)));
+    return;
+  }
+  bool result = delegate_->OnRegisterPermissions(
+      GetRenderProcessID(), extension_name, perm_table);
+  XWalkExtensionProcessHostMsg_RegisterPermissions::WriteReplyParams(
+      reply_msg.get(), result);
+  Send(reply_msg.release());
 }
 
 bool XWalkExtensionProcessHost::Send(IPC::Message* msg) {
+  XWalkIPCAccounting::GetInstance()->WillSend(msg);
   if (process_)
     return process_->GetHost()->Send(msg);
   if (channel_)
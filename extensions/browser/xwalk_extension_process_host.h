@@ -7,9 +7,12 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "base/callback.h"
 #include "base/files/file_path.h"
 #include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
 #include "base/values.h"
 #include "content/public/browser/browser_child_process_host_delegate.h"
 #include "ipc/ipc_channel_handle.h"
@@ -45,6 +48,8 @@ class XWalkExtensionProcessHost
     virtual bool OnRegisterPermissions(int render_process_id,
                                        const std::string& extension_name,
                                        const std::string& perm_table);
+    // |render_process_id| is ChildProcessHost::kInvalidUniqueID for a host
+    // that is not attached to a render process yet.
     virtual void OnRenderChannelCreated(int render_process_id) {}
 
    protected:
@@ -55,8 +60,26 @@ class XWalkExtensionProcessHost
                             const base::FilePath& external_extensions_path,
                             XWalkExtensionProcessHost::Delegate* delegate,
                             std::unique_ptr<base::DictionaryValue::DictStorage> runtime_variables);
+  // Launches the extension process before there is a render process to
+  // serve, see XWalkExtensionSpareProcessManager. It registers the
+  // extensions and creates the render process channel right away, so the
+  // render process that is attached later does not wait for either. An
+  // extension registering permissions waits for the attach there.
+  XWalkExtensionProcessHost(
+      const base::FilePath& external_extensions_path,
+      XWalkExtensionProcessHost::Delegate* delegate,
+      std::unique_ptr<base::DictionaryValue::DictStorage> runtime_variables);
   ~XWalkExtensionProcessHost() override;
 
+  // Hands the extension process to |render_process_host|. Called once, on the
+  // UI thread. Permissions the extensions registered before are registered
+  // for |render_process_host| then.
+  void AttachToRenderProcess(content::RenderProcessHost* render_process_host);
+
+  // ChildProcessHost::kInvalidUniqueID until attached. Can be called from any
+  // thread.
+  int GetRenderProcessID() const;
+
   // IPC::Sender implementation
   bool Send(IPC::Message* msg) override;
 
@@ -65,6 +88,8 @@ class XWalkExtensionProcessHost
 
   void StartProcess();
   void StopProcess();
+  void OnAttachedToRenderProcess(
+      content::RenderProcessHost* render_process_host);
 
   // Handler for message from Render Process host, it is a synchronous message,
   // that will be replied only when the extension process channel is created.
@@ -85,12 +110,22 @@ class XWalkExtensionProcessHost
   void ReplyAccessControlToExtension(IPC::Message* reply_msg,
       RuntimePermission perm);
   void OnRegisterPermissions(const std::string& extension_name,
-      const std::string& perm_table, bool* result);
+      const std::string& perm_table, IPC::Message* reply_msg);
+  void RegisterPermissionsForRenderProcess(
+      const std::string& extension_name,
+      const std::string& perm_table,
+      std::unique_ptr<IPC::Message> reply_msg);
 
   std::unique_ptr<content::BrowserChildProcessHost> process_;
   IPC::ChannelHandle ep_rp_channel_handle_;
+  // Set on the IO thread once attached.
   content::RenderProcessHost* render_process_host_;
+  // Set on the UI thread once attached, read from the IO thread.
+  mutable base::Lock render_process_id_lock_;
+  int render_process_id_;
   std::unique_ptr<IPC::Message> pending_reply_for_render_process_;
+  // RegisterPermissions requests received before the attach, IO thread only.
+  std::vector<base::OnceClosure> pending_permission_requests_;
 
   // We use this filter to know when RP asked for the extension process channel.
   // We keep the reference to invalidate the filter once we don't need it
@@ -8,6 +8,7 @@
 #include <vector>
 #include "base/callback.h"
 #include "base/command_line.h"
+#include "base/macros.h"
 #include "base/memory/ptr_util.h"
 #include "base/pickle.h"
 #include "base/scoped_native_library.h"
@@ -16,12 +17,15 @@
 #include "content/public/browser/notification_types.h"
 #include "content/public/browser/notification_service.h"
 #include "content/public/browser/render_process_host.h"
+#include "content/public/common/child_process_host.h"
 #include "ipc/ipc_message_macros.h"
 #include "xwalk/extensions/browser/xwalk_extension_data.h"
 #include "xwalk/extensions/browser/xwalk_extension_process_host.h"
+#include "xwalk/extensions/browser/xwalk_extension_spare_process_manager.h"
 #include "xwalk/extensions/common/xwalk_extension.h"
 #include "xwalk/extensions/common/xwalk_extension_server.h"
 #include "xwalk/extensions/common/xwalk_extension_switches.h"
+#include "xwalk/runtime/common/xwalk_ipc_accounting.h"
 
 using content::BrowserThread;
 
@@ -170,6 +174,11 @@ bool ExtensionServerMessageFilter::OnMessageReceived(const IPC::Message& message
   if (!extension_thread_server_ || !ui_thread_server_)
     return false;
 
+  // Messages routed to a server are accounted for when it dispatches them.
+  if (message.type() == XWalkExtensionServerMsg_CreateInstance::ID ||
+      message.type() == XWalkExtensionServerMsg_GetExtensions::ID)
+    XWalkIPCAccounting::GetInstance()->DidDispatch(message);
+
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP(ExtensionServerMessageFilter, message)
     IPC_MESSAGE_HANDLER(XWalkExtensionServerMsg_CreateInstance,
@@ -203,9 +212,17 @@ XWalkExtensionService::XWalkExtensionService(Delegate* delegate)
   // IO main loop is needed by extensions watching file descriptors events.
   base::Thread::Options options(base::MessageLoop::TYPE_IO, 0);
   extension_thread_.StartWithOptions(options);
+
+  base::CommandLine* cmd_line = base::CommandLine::ForCurrentProcess();
+  if (!cmd_line->HasSwitch(switches::kXWalkDisableExtensionProcess) &&
+      !cmd_line->HasSwitch(switches::kXWalkDisableSpareExtensionProcess)) {
+    spare_process_manager_ = new XWalkExtensionSpareProcessManager(this);
+  }
 }
 
 XWalkExtensionService::~XWalkExtensionService() {
+  if (spare_process_manager_)
+    spare_process_manager_->Shutdown();
   // This object should have been released and asked to be deleted in the
   // extension thread.
   if (!extension_data_map_.empty())
@@ -228,6 +245,10 @@ void XWalkExtensionService::OnRenderProcessHostCreatedInternal(
   CreateInProcessExtensionServers(host, data, ui_thread_extensions,
                                   extension_thread_extensions);
 
+  // In the map before the extension process host, which may report its
+  // death as soon as it is created.
+  extension_data_map_[host->GetID()] = data;
+
   base::CommandLine* cmd_line = base::CommandLine::ForCurrentProcess();
   if (!cmd_line->HasSwitch(switches::kXWalkDisableExtensionProcess)) {
     CreateExtensionProcessHost(host, data, std::move(runtime_variables));
@@ -237,8 +258,6 @@ void XWalkExtensionService::OnRenderProcessHostCreatedInternal(
         data->in_process_ui_thread_server(),
         external_extensions_path_, base::Passed(std::move(runtime_variables))));
   }
-
-  extension_data_map_[host->GetID()] = data;
 }
 
 void XWalkExtensionService::OnRenderProcessWillLaunch(
@@ -375,9 +394,23 @@ void XWalkExtensionService::CreateInProcessExtensionServers(
 void XWalkExtensionService::CreateExtensionProcessHost(
     content::RenderProcessHost* host, XWalkExtensionData* data,
     std::unique_ptr<base::DictionaryValue::DictStorage> runtime_variables) {
-  data->set_extension_process_host(base::WrapUnique(
-      new XWalkExtensionProcessHost(host, external_extensions_path_, this,
-                                    std::move(runtime_variables))));
+  if (spare_process_manager_) {
+    std::unique_ptr<XWalkExtensionProcessHost> spare =
+        spare_process_manager_->TakeSpare(host, external_extensions_path_,
+                                          *runtime_variables);
+    if (spare) {
+      XWalkExtensionProcessHost* eph = spare.get();
+      data->set_extension_process_host(std::move(spare));
+      if (spare_process_manager_->DidStoreSpare(eph))
+        return;
+      // Its process died in between, which deleted it.
+      ignore_result(data->extension_process_host().release());
+    }
+  }
+  data->set_extension_process_host(
+      std::make_unique<XWalkExtensionProcessHost>(
+          host, external_extensions_path_, this,
+          std::move(runtime_variables)));
 }
 
 void XWalkExtensionService::OnExtensionProcessDied(
@@ -387,6 +420,13 @@ void XWalkExtensionService::OnExtensionProcessDied(
   // segfault when trying to delete it within
   // XWalkExtensionService::OnRenderProcessHostClosed();
 
+  // A spare is not in the map, nor is one taken but not stored yet. One
+  // that was handed out while it died may not have known its render process
+  // when reporting, so ask again.
+  if (spare_process_manager_ && spare_process_manager_->OnProcessDied(eph))
+    return;
+  render_process_id = eph->GetRenderProcessID();
+
   RenderProcessToExtensionDataMap::iterator it =
       extension_data_map_.find(render_process_id);
 
@@ -441,6 +481,13 @@ void XWalkExtensionService::OnCheckAPIAccessControl(
                                    api_name, callback);
 }
 
+void XWalkExtensionService::OnRenderChannelCreated(int render_process_id) {
+  if (render_process_id == content::ChildProcessHost::kInvalidUniqueID &&
+      spare_process_manager_) {
+    spare_process_manager_->OnSpareProcessReady();
+  }
+}
+
 bool XWalkExtensionService::OnRegisterPermissions(
     int render_process_id,
     const std::string& extension_name,
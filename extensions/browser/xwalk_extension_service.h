@@ -13,6 +13,7 @@
 
 #include "base/callback_forward.h"
 #include "base/files/file_path.h"
+#include "base/memory/ref_counted.h"
 #include "base/threading/thread.h"
 #include "base/values.h"
 #include "content/public/browser/notification_observer.h"
@@ -33,6 +34,7 @@ namespace extensions {
 class XWalkExtension;
 class XWalkExtensionData;
 class XWalkExtensionServer;
+class XWalkExtensionSpareProcessManager;
 
 // This is the entry point for Crosswalk extensions. Its responsible for keeping
 // track of the extensions, and enable them on WebContents once they are
@@ -115,6 +117,7 @@ class XWalkExtensionService : public content::NotificationObserver,
   bool OnRegisterPermissions(int render_process_id,
                              const std::string& extension_name,
                              const std::string& perm_table) override;
+  void OnRenderChannelCreated(int render_process_id) override;
 
   // NotificationObserver implementation.
   void Observe(int type, const content::NotificationSource& source,
@@ -144,6 +147,9 @@ class XWalkExtensionService : public content::NotificationObserver,
   typedef std::map<int, XWalkExtensionData*> RenderProcessToExtensionDataMap;
   RenderProcessToExtensionDataMap extension_data_map_;
 
+  // Null when the extension process or the spare one is disabled.
+  scoped_refptr<XWalkExtensionSpareProcessManager> spare_process_manager_;
+
   DISALLOW_COPY_AND_ASSIGN(XWalkExtensionService);
 };
 
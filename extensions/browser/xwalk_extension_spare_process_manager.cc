@@ -0,0 +1,210 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/extensions/browser/xwalk_extension_spare_process_manager.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/task/post_task.h"
+#include "content/public/browser/browser_task_traits.h"
+#include "content/public/browser/render_process_host.h"
+
+using content::BrowserThread;
+
+namespace xwalk {
+namespace extensions {
+
+namespace {
+
+// Lets the render process that was just launched get ahead of the spare that
+// replaces the one it took.
+const int kWarmUpDelayMs = 500;
+
+// No spare is warmed for this long after memory pressure was signaled.
+const int kMemoryPressureBackoffSeconds = 60;
+
+XWalkExtensionSpareProcessManager::Observer* g_observer_for_testing = nullptr;
+
+std::unique_ptr<base::DictionaryValue::DictStorage> CopyVariables(
+    const base::DictionaryValue::DictStorage& variables) {
+  std::unique_ptr<base::DictionaryValue::DictStorage> copy(
+      new base::DictionaryValue::DictStorage);
+  for (const auto& variable : variables)
+    (*copy)[variable.first] = variable.second->CreateDeepCopy();
+  return copy;
+}
+
+bool SameVariables(const base::DictionaryValue::DictStorage& a,
+                   const base::DictionaryValue::DictStorage& b) {
+  if (a.size() != b.size())
+    return false;
+  for (auto it_a = a.begin(), it_b = b.begin(); it_a != a.end();
+       ++it_a, ++it_b) {
+    if (it_a->first != it_b->first || *it_a->second != *it_b->second)
+      return false;
+  }
+  return true;
+}
+
+void NotifyObserver(
+    void (XWalkExtensionSpareProcessManager::Observer::*method)()) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  if (g_observer_for_testing)
+    (g_observer_for_testing->*method)();
+}
+
+}  // namespace
+
+XWalkExtensionSpareProcessManager::XWalkExtensionSpareProcessManager(
+    XWalkExtensionProcessHost::Delegate* delegate)
+    : delegate_(delegate),
+      memory_pressure_listener_(base::BindRepeating(
+          &XWalkExtensionSpareProcessManager::OnMemoryPressure,
+          base::Unretained(this))),
+      shut_down_(false),
+      warm_up_pending_(false) {}
+
+XWalkExtensionSpareProcessManager::~XWalkExtensionSpareProcessManager() {
+  DCHECK(!spare_);
+}
+
+std::unique_ptr<XWalkExtensionProcessHost>
+XWalkExtensionSpareProcessManager::TakeSpare(
+    content::RenderProcessHost* host,
+    const base::FilePath& path,
+    const base::DictionaryValue::DictStorage& runtime_variables) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  std::unique_ptr<XWalkExtensionProcessHost> eph;
+  bool stale = false;
+  {
+    base::AutoLock lock(lock_);
+    if (spare_ && spare_path_ == path &&
+        SameVariables(*spare_variables_, runtime_variables)) {
+      eph = std::move(spare_);
+      eph->AttachToRenderProcess(host);
+      // A death it reports is ours until the caller stored it.
+      taken_.insert(eph.get());
+    } else {
+      stale = !!spare_;
+    }
+  }
+  if (eph)
+    NotifyObserver(&Observer::OnSpareProcessTaken);
+  if (stale)
+    Discard();
+
+  next_path_ = path;
+  next_variables_ = CopyVariables(runtime_variables);
+  if (!shut_down_ && !warm_up_pending_) {
+    warm_up_pending_ = true;
+    base::PostDelayedTaskWithTraits(
+        FROM_HERE, {BrowserThread::UI},
+        base::BindOnce(&XWalkExtensionSpareProcessManager::WarmUp, this),
+        base::TimeDelta::FromMilliseconds(kWarmUpDelayMs));
+  }
+  return eph;
+}
+
+bool XWalkExtensionSpareProcessManager::DidStoreSpare(
+    XWalkExtensionProcessHost* eph) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  base::AutoLock lock(lock_);
+  return taken_.erase(eph) > 0;
+}
+
+void XWalkExtensionSpareProcessManager::Shutdown() {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  shut_down_ = true;
+  Discard();
+}
+
+bool XWalkExtensionSpareProcessManager::OnProcessDied(
+    XWalkExtensionProcessHost* eph) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  base::AutoLock lock(lock_);
+  if (spare_.get() == eph) {
+    // Not replaced until the next render process, a crashing extension
+    // would keep us relaunching it otherwise.
+    ignore_result(spare_.release());
+    spare_variables_.reset();
+    return true;
+  }
+  return discarded_.erase(eph) > 0 || taken_.erase(eph) > 0;
+}
+
+void XWalkExtensionSpareProcessManager::OnSpareProcessReady() {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  base::PostTaskWithTraits(
+      FROM_HERE, {BrowserThread::UI},
+      base::BindOnce(&NotifyObserver, &Observer::OnSpareProcessReady));
+}
+
+// static
+void XWalkExtensionSpareProcessManager::SetObserverForTesting(
+    Observer* observer) {
+  g_observer_for_testing = observer;
+}
+
+void XWalkExtensionSpareProcessManager::WarmUp() {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  warm_up_pending_ = false;
+  if (shut_down_ || !next_variables_)
+    return;
+  if (!last_memory_pressure_.is_null() &&
+      base::TimeTicks::Now() - last_memory_pressure_ <
+          base::TimeDelta::FromSeconds(kMemoryPressureBackoffSeconds)) {
+    return;
+  }
+
+  base::AutoLock lock(lock_);
+  if (spare_)
+    return;
+  spare_path_ = next_path_;
+  spare_variables_ = CopyVariables(*next_variables_);
+  spare_.reset(new XWalkExtensionProcessHost(
+      next_path_, delegate_, CopyVariables(*next_variables_)));
+}
+
+void XWalkExtensionSpareProcessManager::Discard() {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  XWalkExtensionProcessHost* eph;
+  {
+    base::AutoLock lock(lock_);
+    if (!spare_)
+      return;
+    eph = spare_.release();
+    spare_variables_.reset();
+    discarded_.insert(eph);
+  }
+  base::PostTaskWithTraits(
+      FROM_HERE, {BrowserThread::IO},
+      base::BindOnce(&XWalkExtensionSpareProcessManager::DeleteDiscarded,
+                     this, eph));
+  NotifyObserver(&Observer::OnSpareProcessDiscarded);
+}
+
+void XWalkExtensionSpareProcessManager::DeleteDiscarded(
+    XWalkExtensionProcessHost* eph) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  {
+    base::AutoLock lock(lock_);
+    if (!discarded_.erase(eph))
+      return;
+  }
+  delete eph;
+}
+
+void XWalkExtensionSpareProcessManager::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel level) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  if (level == base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE)
+    return;
+  last_memory_pressure_ = base::TimeTicks::Now();
+  Discard();
+}
+
+}  // namespace extensions
+}  // namespace xwalk
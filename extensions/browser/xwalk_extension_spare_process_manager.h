@@ -0,0 +1,125 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_EXTENSIONS_BROWSER_XWALK_EXTENSION_SPARE_PROCESS_MANAGER_H_
+#define XWALK_EXTENSIONS_BROWSER_XWALK_EXTENSION_SPARE_PROCESS_MANAGER_H_
+
+#include <memory>
+#include <set>
+
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "content/public/browser/browser_thread.h"
+#include "xwalk/extensions/browser/xwalk_extension_process_host.h"
+
+namespace content {
+class RenderProcessHost;
+}
+
+namespace xwalk {
+namespace extensions {
+
+// Keeps one extension process launched, with its extensions registered and
+// its render process channel created, so the next render process does not
+// block on all of that in its first GetExtensionProcessChannel call.
+//
+// Runtime variables are sent to the extension process when it starts, so a
+// spare can only serve a render process that gets the same ones; the
+// replacement is warmed with the variables of the last render process.
+// The spare is discarded under memory pressure and not replaced for a while.
+//
+// Lives on the UI thread. The spare itself lives on the IO thread, where its
+// process may die at any time, so handing it out is guarded by a lock.
+class XWalkExtensionSpareProcessManager
+    : public base::RefCountedThreadSafe<
+          XWalkExtensionSpareProcessManager,
+          content::BrowserThread::DeleteOnUIThread> {
+ public:
+  class Observer {
+   public:
+    virtual void OnSpareProcessReady() {}
+    virtual void OnSpareProcessTaken() {}
+    virtual void OnSpareProcessDiscarded() {}
+
+   protected:
+    virtual ~Observer() {}
+  };
+
+  // |delegate| is given to the spare process hosts, it must outlive them.
+  explicit XWalkExtensionSpareProcessManager(
+      XWalkExtensionProcessHost::Delegate* delegate);
+
+  // Returns the spare attached to |host| if it was warmed for |path| and
+  // |runtime_variables|, null otherwise. Either way a new spare is warmed
+  // for them shortly after. The caller stores the spare where its death is
+  // looked for, then calls DidStoreSpare().
+  std::unique_ptr<XWalkExtensionProcessHost> TakeSpare(
+      content::RenderProcessHost* host,
+      const base::FilePath& path,
+      const base::DictionaryValue::DictStorage& runtime_variables);
+  // Returns false if the process of |eph|, returned by TakeSpare(), died
+  // before this call. |eph| is deleted then and the caller must drop it.
+  bool DidStoreSpare(XWalkExtensionProcessHost* eph);
+
+  // Drops the spare, if any, and stops warming new ones.
+  void Shutdown();
+
+  // Called on the IO thread by the delegate. Returns true if |eph| is a
+  // spare, which is forgotten; its child process host deletes it.
+  bool OnProcessDied(XWalkExtensionProcessHost* eph);
+  // Called on the IO thread by the delegate when a host that is not attached
+  // created its render process channel.
+  void OnSpareProcessReady();
+
+  // Notified on the UI thread.
+  static void SetObserverForTesting(Observer* observer);
+
+ private:
+  friend struct content::BrowserThread::DeleteOnThread<
+      content::BrowserThread::UI>;
+  friend class base::DeleteHelper<XWalkExtensionSpareProcessManager>;
+
+  ~XWalkExtensionSpareProcessManager();
+
+  void WarmUp();
+  void Discard();
+  void DeleteDiscarded(XWalkExtensionProcessHost* eph);
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel level);
+
+  XWalkExtensionProcessHost::Delegate* delegate_;
+  base::MemoryPressureListener memory_pressure_listener_;
+
+  // UI thread only.
+  bool shut_down_;
+  bool warm_up_pending_;
+  base::TimeTicks last_memory_pressure_;
+
+  // What the next spare is warmed for, UI thread only.
+  base::FilePath next_path_;
+  std::unique_ptr<base::DictionaryValue::DictStorage> next_variables_;
+
+  // Guards the spare and what it was warmed for.
+  base::Lock lock_;
+  std::unique_ptr<XWalkExtensionProcessHost> spare_;
+  base::FilePath spare_path_;
+  std::unique_ptr<base::DictionaryValue::DictStorage> spare_variables_;
+  // Discarded spares waiting to be deleted on the IO thread, unless their
+  // process dies first.
+  std::set<XWalkExtensionProcessHost*> discarded_;
+  // Spares taken but not stored by the caller yet.
+  std::set<XWalkExtensionProcessHost*> taken_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkExtensionSpareProcessManager);
+};
+
+}  // namespace extensions
+}  // namespace xwalk
+
+#endif  // XWALK_EXTENSIONS_BROWSER_XWALK_EXTENSION_SPARE_PROCESS_MANAGER_H_
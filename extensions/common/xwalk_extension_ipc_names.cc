@@ -0,0 +1,31 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/extensions/common/xwalk_extension_ipc_names.h"
+
+#include "xwalk/extensions/common/xwalk_extension_messages.h"
+#include "xwalk/runtime/common/xwalk_ipc_accounting.h"
+
+namespace xwalk {
+namespace extensions {
+
+void RegisterExtensionIPCNames() {
+  XWalkIPCAccounting::GetInstance()->RegisterNames<
+      XWalkExtensionProcessMsg_RegisterExtensions,
+      XWalkExtensionProcessHostMsg_RenderProcessChannelCreated,
+      XWalkExtensionProcessHostMsg_GetExtensionProcessChannel,
+      XWalkExtensionProcessHostMsg_CheckAPIAccessControl,
+      XWalkExtensionProcessHostMsg_RegisterPermissions,
+      XWalkExtensionServerMsg_CreateInstance,
+      XWalkExtensionServerMsg_PostMessageToNative,
+      XWalkExtensionClientMsg_PostMessageToJS,
+      XWalkExtensionClientMsg_PostOutOfLineMessageToJS,
+      XWalkExtensionServerMsg_SendSyncMessageToNative,
+      XWalkExtensionServerMsg_GetExtensions,
+      XWalkExtensionServerMsg_DestroyInstance,
+      XWalkExtensionClientMsg_InstanceDestroyed>();
+}
+
+}  // namespace extensions
+}  // namespace xwalk
@@ -0,0 +1,18 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_EXTENSIONS_COMMON_XWALK_EXTENSION_IPC_NAMES_H_
+#define XWALK_EXTENSIONS_COMMON_XWALK_EXTENSION_IPC_NAMES_H_
+
+namespace xwalk {
+namespace extensions {
+
+// Names the messages of xwalk_extension_messages.h in XWalkIPCAccounting
+// reports. Cheap, and safe to call more than once.
+void RegisterExtensionIPCNames();
+
+}  // namespace extensions
+}  // namespace xwalk
+
+#endif  // XWALK_EXTENSIONS_COMMON_XWALK_EXTENSION_IPC_NAMES_H_
@@ -11,11 +11,16 @@
 #include "base/strings/string16.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/stl_util.h"
+#include "base/values.h"
 #include "content/public/browser/render_process_host.h"
 #include "ipc/ipc_message.h"
 #include "ipc/ipc_sender.h"
+#include "xwalk/extensions/common/xwalk_extension_ipc_names.h"
 #include "xwalk/extensions/common/xwalk_extension_messages.h"
 #include "xwalk/extensions/common/xwalk_external_extension.h"
+#include "xwalk/extensions/common/xwalk_external_extension_index.h"
+#include "xwalk/runtime/common/xwalk_ipc_accounting.h"
+#include "xwalk/runtime/common/xwalk_runtime_internals.h"
 
 namespace xwalk {
 namespace extensions {
@@ -23,15 +28,58 @@ namespace extensions {
 // Threshold to determine using shared memory or message
 const size_t kInlineMessageMaxSize = 256 * 1024;
 
+namespace {
+
+void ReportMessage(const IPC::Message& message, bool sent) {
+  XWalkRuntimeInternals* internals = XWalkRuntimeInternals::GetInstance();
+  internals->Count(sent ? XWalkRuntimeInternals::kExtensionMessagesSent
+                        : XWalkRuntimeInternals::kExtensionMessagesReceived,
+                   1);
+  internals->Count(XWalkRuntimeInternals::kExtensionMessageBytes,
+                   message.size());
+
+  base::DictionaryValue params;
+  params.SetString("name",
+                   XWalkIPCAccounting::GetInstance()->GetName(message.type()));
+  params.SetString("direction", sent ? "sent" : "received");
+  params.SetInteger("bytes", static_cast<int>(message.size()));
+  params.SetBoolean("sync", message.is_sync());
+  internals->Emit("Crosswalk.extensionMessage", params);
+}
+
+void ReportInstance(const std::string& name, bool created) {
+  XWalkRuntimeInternals* internals = XWalkRuntimeInternals::GetInstance();
+  // A gauge, kept even when no one is listening.
+  internals->Count(XWalkRuntimeInternals::kExtensionInstances,
+                   created ? 1 : -1);
+  if (!XWalkRuntimeInternals::IsEnabled())
+    return;
+
+  base::DictionaryValue params;
+  params.SetString("extension", name);
+  params.SetBoolean("created", created);
+  internals->Emit("Crosswalk.extensionInstance", params);
+}
+
+}  // namespace
+
 XWalkExtensionServer::XWalkExtensionServer()
     : channel_proxy_(NULL),
-      permissions_delegate_(NULL) {}
+      permissions_delegate_(NULL) {
+  RegisterExtensionIPCNames();
+}
 
 XWalkExtensionServer::~XWalkExtensionServer() {
   DeleteInstanceMap();
 }
 
 bool XWalkExtensionServer::OnMessageReceived(const IPC::Message& message) {
+  if (IPC_MESSAGE_CLASS(message) == XWalkExtensionClientServerMsgStart) {
+    XWalkIPCAccounting::GetInstance()->DidDispatch(message);
+    if (XWalkRuntimeInternals::IsEnabled())
+      ReportMessage(message, false);
+  }
+
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP(XWalkExtensionServer, message)
     IPC_MESSAGE_HANDLER(XWalkExtensionServerMsg_CreateInstance,
@@ -87,8 +135,10 @@ void XWalkExtensionServer::OnCreateInstance(int64_t instance_id,
   InstanceExecutionData data;
   data.instance = instance;
   data.pending_reply = NULL;
+  data.name = name;
 
   instances_[instance_id] = data;
+  ReportInstance(name, true);
 }
 
 void XWalkExtensionServer::OnPostMessageToNative(int64_t instance_id,
@@ -123,8 +173,14 @@ void XWalkExtensionServer::Initialize(IPC::ChannelProxy* channelProxy) {
 
 bool XWalkExtensionServer::Send(IPC::Message* msg) {
   base::AutoLock l(channel_proxy_lock_);
-  if (!channel_proxy_)
+  if (!channel_proxy_) {
+    // Like any IPC::Sender, the message is ours even if it can't be sent.
+    delete msg;
     return false;
+  }
+  if (XWalkRuntimeInternals::IsEnabled())
+    ReportMessage(*msg, true);
+  XWalkIPCAccounting::GetInstance()->WillSend(msg);
   return channel_proxy_->Send(msg);
 }
 
@@ -281,6 +337,7 @@ void XWalkExtensionServer::DeleteInstanceMap() {
 
   for (; it != instances_.end(); ++it) {
     delete it->second.instance;
+    ReportInstance(it->second.name, false);
     if (it->second.pending_reply) {
       pending_replies_left++;
       delete it->second.pending_reply;
@@ -363,6 +420,7 @@ void XWalkExtensionServer::OnDestroyInstance(int64_t instance_id) {
   InstanceExecutionData& data = it->second;
 
   delete data.instance;
+  ReportInstance(data.name, false);
   instances_.erase(it);
 
   Send(new XWalkExtensionClientMsg_InstanceDestroyed(instance_id));
@@ -406,6 +464,15 @@ base::FilePath::StringType GetNativeLibraryPattern() {
 std::vector<std::string> RegisterExternalExtensionsInDirectory(
     XWalkExtensionServer* server, const base::FilePath& dir,
     std::unique_ptr<base::DictionaryValue::DictStorage> runtime_variables) {
+  return RegisterExternalExtensionsInDirectory(
+      server, dir, std::move(runtime_variables),
+      XWalkExternalExtensionIndex::GetDefaultPath());
+}
+
+std::vector<std::string> RegisterExternalExtensionsInDirectory(
+    XWalkExtensionServer* server, const base::FilePath& dir,
+    std::unique_ptr<base::DictionaryValue::DictStorage> runtime_variables,
+    const base::FilePath& index_path) {
   CHECK(server);
 
   std::vector<std::string> registered_extensions;
@@ -418,6 +485,9 @@ std::vector<std::string> RegisterExternalExtensionsInDirectory(
     return registered_extensions;
   }
 
+  XWalkExternalExtensionIndex index(index_path);
+  index.Load();
+
   base::FileEnumerator libraries(
       dir, false, base::FileEnumerator::FILES, GetNativeLibraryPattern());
 
@@ -428,24 +498,43 @@ std::vector<std::string> RegisterExternalExtensionsInDirectory(
 
     // Let the extension know about its own path, so it can be used
     // as an identifier in case you have symlinks to extensions to force it
-    // load multiple times.
+    // load multiple times. Each extension gets its own copy, the library
+    // may ask for them long after this returns.
     (*runtime_variables)["extension_path"] = base::WrapUnique(
         new base::Value(extension_path.AsUTF8Unsafe()));
+    base::DictionaryValue::DictStorage extension_variables;
+    for (const auto& variable : *runtime_variables)
+      extension_variables[variable.first] = variable.second->CreateDeepCopy();
 
-    extension->set_runtime_variables(runtime_variables.get());
+    extension->set_runtime_variables(&extension_variables);
     if (server->permissions_delegate())
       extension->set_permissions_delegate(server->permissions_delegate());
-    if (extension->Initialize()) {
-      registered_extensions.push_back(extension->name());
-      server->RegisterExtension(std::move(extension));
+
+    // Libraries that did not change since they were indexed are only
+    // loaded once a page uses them.
+    const base::FileEnumerator::FileInfo info = libraries.GetInfo();
+    XWalkExternalExtension::Descriptor descriptor;
+    if (index.Lookup(extension_path, info.GetSize(),
+                     info.GetLastModifiedTime(), &descriptor)) {
+      extension->InitializeLazily(descriptor);
+    } else if (extension->Initialize()) {
+      index.Update(extension_path, info.GetSize(), info.GetLastModifiedTime(),
+                   extension->GetDescriptor());
     } else {
 #if TENTA_LOG_ENABLE == 1
       LOG(WARNING) << "Failed to initialize extension: "
                    << extension_path.AsUTF8Unsafe();
 #endif
+      continue;
     }
+
+    const std::string name = extension->name();
+    if (server->RegisterExtension(std::move(extension)))
+      registered_extensions.push_back(name);
   }
 
+  index.Save(dir);
+
   return registered_extensions;
 }
 
@@ -85,6 +85,8 @@ class XWalkExtensionServer : public IPC::Listener,
   struct InstanceExecutionData {
     XWalkExtensionInstance* instance;
     IPC::Message* pending_reply;
+    // The extension's, for the instance events of XWalkRuntimeInternals.
+    std::string name;
   };
 
   // Message Handlers
@@ -121,9 +123,18 @@ class XWalkExtensionServer : public IPC::Listener,
   XWalkExtension::PermissionsDelegate* permissions_delegate_;
 };
 
+// Registers the external extensions found in |dir| with |server|. Those
+// described by a current entry of the index at |index_path| are registered
+// without loading their library until a page creates an instance; the others
+// are loaded right away and indexed. The first overload uses the default
+// index, an empty |index_path| disables it.
 std::vector<std::string> RegisterExternalExtensionsInDirectory(
     XWalkExtensionServer* server, const base::FilePath& dir,
     std::unique_ptr<base::DictionaryValue::DictStorage> runtime_variables);
+std::vector<std::string> RegisterExternalExtensionsInDirectory(
+    XWalkExtensionServer* server, const base::FilePath& dir,
+    std::unique_ptr<base::DictionaryValue::DictStorage> runtime_variables,
+    const base::FilePath& index_path);
 
 bool ValidateExtensionNameForTesting(const std::string& extension_name);
 
@@ -26,4 +26,8 @@ const char kXWalkExtensionCmdPrefix[] = "xwalk-extension-cmd-prefix";
 // Disable XWalkExtensionSystem and all extensions
 const char kXWalkDisableExtensions[] = "disable-xwalk-extensions";
 
+// Do not keep an extension process launched ahead of the next render process.
+const char kXWalkDisableSpareExtensionProcess[] =
+    "disable-spare-extension-process";
+
 }  // namespace switches
@@ -13,6 +13,7 @@ extern const char kXWalkExtensionProcess[];
 extern const char kXWalkExternalExtensionsPath[];
 extern const char kXWalkExtensionCmdPrefix[];
 extern const char kXWalkDisableExtensions[];
+extern const char kXWalkDisableSpareExtensionProcess[];
 
 }  // namespace switches
 
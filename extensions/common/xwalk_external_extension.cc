@@ -16,6 +16,13 @@
 namespace xwalk {
 namespace extensions {
 
+XWalkExternalExtension::Descriptor::Descriptor() {}
+
+XWalkExternalExtension::Descriptor::Descriptor(const Descriptor& other) =
+    default;
+
+XWalkExternalExtension::Descriptor::~Descriptor() {}
+
 XWalkExternalExtension::XWalkExternalExtension(const base::FilePath& path)
     : library_path_(path),
       xw_extension_(0),
@@ -25,7 +32,8 @@ XWalkExternalExtension::XWalkExternalExtension(const base::FilePath& path)
       handle_msg_callback_(NULL),
       handle_sync_msg_callback_(NULL),
       handle_binary_msg_callback_(NULL),
-      initialized_(false) {
+      initialized_(false),
+      described_(false) {
 }
 
 XWalkExternalExtension::~XWalkExternalExtension() {
@@ -82,7 +90,26 @@ bool XWalkExternalExtension::Initialize() {
   return true;
 }
 
+void XWalkExternalExtension::InitializeLazily(const Descriptor& descriptor) {
+  DCHECK(!initialized_);
+  set_name(descriptor.name);
+  set_javascript_api(descriptor.javascript_api);
+  set_entry_points(descriptor.entry_points);
+  described_ = true;
+}
+
+XWalkExternalExtension::Descriptor
+XWalkExternalExtension::GetDescriptor() const {
+  Descriptor descriptor;
+  descriptor.name = name();
+  descriptor.javascript_api = javascript_api();
+  descriptor.entry_points = entry_points();
+  return descriptor;
+}
+
 XWalkExtensionInstance* XWalkExternalExtension::CreateInstance() {
+  if (!initialized_ && !Initialize())
+    return nullptr;
   XW_Instance xw_instance =
       XWalkExternalAdapter::GetInstance()->GetNextXWInstance();
   return new XWalkExternalInstance(this, xw_instance);
@@ -96,13 +123,27 @@ XWalkExtensionInstance* XWalkExternalExtension::CreateInstance() {
     return;                                                      \
   }
 
+// A lazily loaded extension was registered with what it told the last time
+// it was loaded, and that cannot change anymore.
+#define RETURN_IF_DESCRIBED(FUNCTION, CHANGED)                   \
+  if (described_) {                                              \
+    if (CHANGED) {                                               \
+      LOG(WARNING) << "Error: extension '" << this->name()       \
+                   << "' changed what it sets with " FUNCTION    \
+                   << " since it was indexed.";                  \
+    }                                                            \
+    return;                                                      \
+  }
+
 void XWalkExternalExtension::CoreSetExtensionName(const char* name) {
   RETURN_IF_INITIALIZED("SetExtensionName from CoreInterface");
+  RETURN_IF_DESCRIBED("SetExtensionName", this->name() != name);
   set_name(name);
 }
 
 void XWalkExternalExtension::CoreSetJavaScriptAPI(const char* js_api) {
   RETURN_IF_INITIALIZED("SetJavaScriptAPI from CoreInterface");
+  RETURN_IF_DESCRIBED("SetJavaScriptAPI", javascript_api() != js_api);
   set_javascript_api(std::string(js_api));
 }
 
@@ -148,6 +189,7 @@ void XWalkExternalExtension::EntryPointsSetExtraJSEntryPoints(
   for (int i = 0; entry_points[i]; ++i)
     entries.push_back(std::string(entry_points[i]));
 
+  RETURN_IF_DESCRIBED("SetExtraJSEntryPoints", this->entry_points() != entries);
   set_entry_points(entries);
 }
 
@@ -6,6 +6,7 @@
 #define XWALK_EXTENSIONS_COMMON_XWALK_EXTERNAL_EXTENSION_H_
 
 #include <string>
+#include <vector>
 #include "base/files/file_path.h"
 #include "base/values.h"
 #include "base/scoped_native_library.h"
@@ -34,12 +35,31 @@ class XWalkExternalInstance;
 // library.
 class XWalkExternalExtension : public XWalkExtension {
  public:
+  // What registering the extension takes, known once it was loaded.
+  struct Descriptor {
+    Descriptor();
+    Descriptor(const Descriptor& other);
+    ~Descriptor();
+
+    std::string name;
+    std::string javascript_api;
+    std::vector<std::string> entry_points;
+  };
+
   explicit XWalkExternalExtension(const base::FilePath& path);
 
   ~XWalkExternalExtension() override;
 
+  // Loads the library and runs its XW_Initialize.
   bool Initialize();
 
+  // Takes name, JavaScript API and entry points from |descriptor| instead,
+  // the library is only loaded when the first instance is created.
+  void InitializeLazily(const Descriptor& descriptor);
+
+  Descriptor GetDescriptor() const;
+  bool is_loaded() const { return initialized_; }
+
   void set_runtime_variables(base::DictionaryValue::DictStorage* runtime_variables) {
       runtime_variables_.swap(*runtime_variables);
   }
@@ -90,6 +110,8 @@ class XWalkExternalExtension : public XWalkExtension {
   XW_HandleBinaryMessageCallback handle_binary_msg_callback_;
 
   bool initialized_;
+  // Set up from a Descriptor, what XW_Initialize sets is already known.
+  bool described_;
 
   DISALLOW_COPY_AND_ASSIGN(XWalkExternalExtension);
 };
@@ -0,0 +1,183 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/extensions/common/xwalk_external_extension_index.h"
+
+#include <memory>
+#include <utility>
+
+#include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/logging.h"
+#include "base/path_service.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/values.h"
+
+namespace xwalk {
+namespace extensions {
+
+namespace {
+
+const char kVersionKey[] = "version";
+const char kExtensionsKey[] = "extensions";
+const char kSizeKey[] = "size";
+const char kLastModifiedKey[] = "last_modified";
+const char kNameKey[] = "name";
+const char kJavaScriptAPIKey[] = "javascript_api";
+const char kEntryPointsKey[] = "entry_points";
+
+// 64 bit integers do not fit in a base::Value, they are kept as strings.
+std::string Int64ToString(int64_t value) {
+  return base::NumberToString(value);
+}
+
+bool StringToInt64(const std::string* value, int64_t* out) {
+  return value && base::StringToInt64(*value, out);
+}
+
+int64_t TimeToInt64(base::Time time) {
+  return time.ToDeltaSinceWindowsEpoch().InMicroseconds();
+}
+
+}  // namespace
+
+const int XWalkExternalExtensionIndex::kVersion = 1;
+
+// static
+base::FilePath XWalkExternalExtensionIndex::GetDefaultPath() {
+  base::FilePath cache_dir;
+  if (!base::PathService::Get(base::DIR_CACHE, &cache_dir))
+    return base::FilePath();
+  return cache_dir.Append(FILE_PATH_LITERAL("xwalk"))
+      .Append(FILE_PATH_LITERAL("Extension Index"));
+}
+
+XWalkExternalExtensionIndex::XWalkExternalExtensionIndex(
+    const base::FilePath& path)
+    : path_(path), dirty_(false) {}
+
+XWalkExternalExtensionIndex::~XWalkExternalExtensionIndex() {}
+
+void XWalkExternalExtensionIndex::Load() {
+  entries_.clear();
+  std::string json;
+  if (path_.empty() || !base::ReadFileToString(path_, &json))
+    return;
+
+  std::unique_ptr<base::Value> root = base::JSONReader::ReadDeprecated(json);
+  if (!root || !root->is_dict() ||
+      root->FindIntKey(kVersionKey) != kVersion) {
+    return;
+  }
+  const base::Value* extensions =
+      root->FindKeyOfType(kExtensionsKey, base::Value::Type::DICTIONARY);
+  if (!extensions)
+    return;
+
+  for (const auto& item : extensions->DictItems()) {
+    const base::Value& value = item.second;
+    if (!value.is_dict())
+      continue;
+    Entry entry;
+    int64_t last_modified = 0;
+    const std::string* name = value.FindStringKey(kNameKey);
+    const std::string* javascript_api = value.FindStringKey(kJavaScriptAPIKey);
+    const base::Value* entry_points =
+        value.FindKeyOfType(kEntryPointsKey, base::Value::Type::LIST);
+    if (!StringToInt64(value.FindStringKey(kSizeKey), &entry.size) ||
+        !StringToInt64(value.FindStringKey(kLastModifiedKey),
+                       &last_modified) ||
+        !name || !javascript_api || !entry_points) {
+      continue;
+    }
+    entry.last_modified = base::Time::FromDeltaSinceWindowsEpoch(
+        base::TimeDelta::FromMicroseconds(last_modified));
+    entry.descriptor.name = *name;
+    entry.descriptor.javascript_api = *javascript_api;
+    for (const base::Value& entry_point : entry_points->GetList()) {
+      if (entry_point.is_string())
+        entry.descriptor.entry_points.push_back(entry_point.GetString());
+    }
+    entries_.emplace(base::FilePath::FromUTF8Unsafe(item.first),
+                     std::move(entry));
+  }
+}
+
+bool XWalkExternalExtensionIndex::Lookup(
+    const base::FilePath& library,
+    int64_t size,
+    base::Time last_modified,
+    XWalkExternalExtension::Descriptor* descriptor) {
+  seen_.insert(library);
+  auto it = entries_.find(library);
+  // Compared at the precision they are stored with.
+  if (it == entries_.end() || it->second.size != size ||
+      TimeToInt64(it->second.last_modified) != TimeToInt64(last_modified)) {
+    return false;
+  }
+  *descriptor = it->second.descriptor;
+  return true;
+}
+
+void XWalkExternalExtensionIndex::Update(
+    const base::FilePath& library,
+    int64_t size,
+    base::Time last_modified,
+    const XWalkExternalExtension::Descriptor& descriptor) {
+  seen_.insert(library);
+  Entry& entry = entries_[library];
+  entry.size = size;
+  entry.last_modified = last_modified;
+  entry.descriptor = descriptor;
+  dirty_ = true;
+}
+
+bool XWalkExternalExtensionIndex::Save(const base::FilePath& dir) {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (dir.IsParent(it->first) && !seen_.count(it->first)) {
+      it = entries_.erase(it);
+      dirty_ = true;
+    } else {
+      ++it;
+    }
+  }
+  if (!dirty_ || path_.empty())
+    return true;
+
+  base::Value extensions(base::Value::Type::DICTIONARY);
+  for (const auto& it : entries_) {
+    const Entry& entry = it.second;
+    base::Value value(base::Value::Type::DICTIONARY);
+    value.SetStringKey(kSizeKey, Int64ToString(entry.size));
+    value.SetStringKey(kLastModifiedKey,
+                       Int64ToString(TimeToInt64(entry.last_modified)));
+    value.SetStringKey(kNameKey, entry.descriptor.name);
+    value.SetStringKey(kJavaScriptAPIKey, entry.descriptor.javascript_api);
+    base::Value entry_points(base::Value::Type::LIST);
+    for (const std::string& entry_point : entry.descriptor.entry_points)
+      entry_points.GetList().emplace_back(entry_point);
+    value.SetKey(kEntryPointsKey, std::move(entry_points));
+    extensions.SetKey(it.first.AsUTF8Unsafe(), std::move(value));
+  }
+  base::Value root(base::Value::Type::DICTIONARY);
+  root.SetIntKey(kVersionKey, kVersion);
+  root.SetKey(kExtensionsKey, std::move(extensions));
+
+  std::string json;
+  if (!base::JSONWriter::Write(root, &json) ||
+      !base::CreateDirectory(path_.DirName()) ||
+      !base::ImportantFileWriter::WriteFileAtomically(path_, json)) {
+#if TENTA_LOG_ENABLE == 1
+    LOG(WARNING) << "Couldn't write extension index " << path_.AsUTF8Unsafe();
+#endif
+    return false;
+  }
+  dirty_ = false;
+  return true;
+}
+
+}  // namespace extensions
+}  // namespace xwalk
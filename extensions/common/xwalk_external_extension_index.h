@@ -0,0 +1,76 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_EXTENSIONS_COMMON_XWALK_EXTERNAL_EXTENSION_INDEX_H_
+#define XWALK_EXTENSIONS_COMMON_XWALK_EXTERNAL_EXTENSION_INDEX_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "xwalk/extensions/common/xwalk_external_extension.h"
+
+namespace xwalk {
+namespace extensions {
+
+// Remembers what external extensions told about themselves when they were
+// loaded, so they can be registered without loading their library again.
+//
+// Entries are keyed by library path and are only used while the library
+// keeps the size and modification time it had when it was loaded. The index
+// is a JSON file, read once and written back only when it changed.
+class XWalkExternalExtensionIndex {
+ public:
+  static const int kVersion;
+
+  // Where the index lives by default, empty if there is no cache directory.
+  static base::FilePath GetDefaultPath();
+
+  explicit XWalkExternalExtensionIndex(const base::FilePath& path);
+  ~XWalkExternalExtensionIndex();
+
+  // Reads the index, an unreadable or outdated one is ignored.
+  void Load();
+
+  // Returns true and fills |descriptor| if |library| is indexed and did not
+  // change since.
+  bool Lookup(const base::FilePath& library,
+              int64_t size,
+              base::Time last_modified,
+              XWalkExternalExtension::Descriptor* descriptor);
+
+  void Update(const base::FilePath& library,
+              int64_t size,
+              base::Time last_modified,
+              const XWalkExternalExtension::Descriptor& descriptor);
+
+  // Writes the index back if it changed. Libraries in |dir| that were
+  // neither looked up nor updated are gone, and so are their entries.
+  bool Save(const base::FilePath& dir);
+
+ private:
+  struct Entry {
+    int64_t size;
+    base::Time last_modified;
+    XWalkExternalExtension::Descriptor descriptor;
+  };
+
+  const base::FilePath path_;
+  // By library path.
+  std::map<base::FilePath, Entry> entries_;
+  std::set<base::FilePath> seen_;
+  bool dirty_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkExternalExtensionIndex);
+};
+
+}  // namespace extensions
+}  // namespace xwalk
+
+#endif  // XWALK_EXTENSIONS_COMMON_XWALK_EXTERNAL_EXTENSION_INDEX_H_
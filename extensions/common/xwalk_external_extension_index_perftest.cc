@@ -0,0 +1,181 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how long the extension process takes to register a directory of
+// external extensions, with and without a current descriptor index, and
+// what the first instance of a lazily registered extension costs.
+
+#include "xwalk/extensions/common/xwalk_external_extension_index.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/native_library.h"
+#include "base/path_service.h"
+#include "base/strings/string_split.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "xwalk/extensions/common/xwalk_extension_server.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+
+using xwalk::extensions::RegisterExternalExtensionsInDirectory;
+using xwalk::extensions::XWalkExtensionServer;
+using xwalk::extensions::XWalkExternalExtension;
+using xwalk::extensions::XWalkExternalExtensionIndex;
+
+namespace {
+
+const int kExtensionCount = 50;
+const int kSamples = 5;
+
+class XWalkExternalExtensionIndexPerfTest : public testing::Test {
+ protected:
+  // Makes kExtensionCount copies of the synthetic extension, each one a
+  // library of its own with its own name.
+  void SetUp() override {
+    base::FilePath library;
+    ASSERT_TRUE(base::PathService::Get(base::DIR_EXE, &library));
+    library =
+        library.AppendASCII("tests")
+            .AppendASCII("extension")
+            .AppendASCII("synthetic_extension")
+            .AppendASCII(base::GetNativeLibraryName("synthetic_extension"));
+    ASSERT_TRUE(base::PathExists(library)) << library.value();
+
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    extensions_dir_ = temp_dir_.GetPath().AppendASCII("extensions");
+    ASSERT_TRUE(base::CreateDirectory(extensions_dir_));
+    for (int i = 0; i < kExtensionCount; ++i) {
+      ASSERT_TRUE(base::CopyFile(
+          library, extensions_dir_.AppendASCII(base::GetNativeLibraryName(
+                       base::StringPrintf("synthetic_%d", i)))));
+    }
+    index_path_ = temp_dir_.GetPath().AppendASCII("Extension Index");
+    init_log_ = temp_dir_.GetPath().AppendASCII("init.log");
+  }
+
+  // What the extension process does when the browser hands it the
+  // extensions directory.
+  std::vector<std::string> Register(XWalkExtensionServer* server) {
+    auto runtime_variables =
+        std::make_unique<base::DictionaryValue::DictStorage>();
+    (*runtime_variables)["init_log"] =
+        std::make_unique<base::Value>(init_log_.AsUTF8Unsafe());
+    return RegisterExternalExtensionsInDirectory(
+        server, extensions_dir_, std::move(runtime_variables), index_path_);
+  }
+
+  // Names of the extensions whose XW_Initialize ran since the last call.
+  std::vector<std::string> TakeInitialized() {
+    std::string log;
+    base::ReadFileToString(init_log_, &log);
+    base::DeleteFile(init_log_, false);
+    return base::SplitString(log, "\n", base::TRIM_WHITESPACE,
+                             base::SPLIT_WANT_NONEMPTY);
+  }
+
+  base::ScopedTempDir temp_dir_;
+  base::FilePath extensions_dir_;
+  base::FilePath index_path_;
+  base::FilePath init_log_;
+};
+
+}  // namespace
+
+TEST_F(XWalkExternalExtensionIndexPerfTest, RegisterDirectory) {
+  std::vector<double> cold_us;
+  std::vector<double> warm_us;
+  std::vector<double> first_instance_us;
+
+  for (int i = 0; i < kSamples; ++i) {
+    // Without an index every library is loaded and initialized.
+    ASSERT_TRUE(base::DeleteFile(index_path_, false));
+    {
+      XWalkExtensionServer server;
+      const base::TimeTicks start = base::TimeTicks::Now();
+      std::vector<std::string> registered = Register(&server);
+      cold_us.push_back((base::TimeTicks::Now() - start).InMicrosecondsF());
+      ASSERT_EQ(static_cast<size_t>(kExtensionCount), registered.size());
+      EXPECT_EQ(static_cast<size_t>(kExtensionCount),
+                TakeInitialized().size());
+    }
+    ASSERT_TRUE(base::PathExists(index_path_));
+
+    // With it none is, until a page asks for an instance.
+    {
+      XWalkExtensionServer server;
+      const base::TimeTicks start = base::TimeTicks::Now();
+      std::vector<std::string> registered = Register(&server);
+      warm_us.push_back((base::TimeTicks::Now() - start).InMicrosecondsF());
+      ASSERT_EQ(static_cast<size_t>(kExtensionCount), registered.size());
+      EXPECT_TRUE(server.ContainsExtension("synthetic7"));
+      EXPECT_TRUE(TakeInitialized().empty());
+
+      const base::TimeTicks create = base::TimeTicks::Now();
+      server.OnCreateInstance(1, "synthetic7");
+      first_instance_us.push_back(
+          (base::TimeTicks::Now() - create).InMicrosecondsF());
+      EXPECT_EQ(std::vector<std::string>{"synthetic7"}, TakeInitialized());
+    }
+  }
+
+  XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+      "external_extensions_register", "_50_no_index", cold_us));
+  XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+      "external_extensions_register", "_50_indexed", warm_us));
+  XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+      "external_extensions_first_instance", "_indexed", first_instance_us));
+}
+
+TEST_F(XWalkExternalExtensionIndexPerfTest, IndexMatchesLoadedExtensions) {
+  {
+    XWalkExtensionServer server;
+    Register(&server);
+  }
+  TakeInitialized();
+
+  XWalkExternalExtensionIndex index(index_path_);
+  index.Load();
+  const base::FilePath library = extensions_dir_.AppendASCII(
+      base::GetNativeLibraryName("synthetic_3"));
+  base::File::Info info;
+  ASSERT_TRUE(base::GetFileInfo(library, &info));
+  XWalkExternalExtension::Descriptor descriptor;
+  ASSERT_TRUE(index.Lookup(library, info.size, info.last_modified,
+                           &descriptor));
+  EXPECT_EQ("synthetic3", descriptor.name);
+  EXPECT_EQ(std::vector<std::string>{"Synthetic3"}, descriptor.entry_points);
+  EXPECT_NE(std::string::npos,
+            descriptor.javascript_api.find("window.Synthetic3"));
+
+  // A library that changed is loaded again and reindexed.
+  ASSERT_TRUE(base::TouchFile(library, info.last_accessed,
+                              info.last_modified +
+                                  base::TimeDelta::FromSeconds(10)));
+  {
+    XWalkExtensionServer server;
+    Register(&server);
+  }
+  EXPECT_EQ(std::vector<std::string>{"synthetic3"}, TakeInitialized());
+
+  // A library that is gone leaves the index.
+  ASSERT_TRUE(base::DeleteFile(library, false));
+  {
+    XWalkExtensionServer server;
+    EXPECT_EQ(static_cast<size_t>(kExtensionCount - 1),
+              Register(&server).size());
+  }
+  XWalkExternalExtensionIndex pruned(index_path_);
+  pruned.Load();
+  EXPECT_FALSE(pruned.Lookup(library, info.size, info.last_modified,
+                             &descriptor));
+}
@@ -15,7 +15,9 @@
 #include "mojo/edk/embedder/embedder.h"
 #include "mojo/edk/embedder/incoming_broker_client_invitation.h"
 #include "services/service_manager/public/cpp/service_context.h"
+#include "xwalk/extensions/common/xwalk_extension_ipc_names.h"
 #include "xwalk/extensions/common/xwalk_extension_messages.h"
+#include "xwalk/runtime/common/xwalk_ipc_accounting.h"
 
 
 namespace xwalk {
@@ -29,6 +31,7 @@ XWalkExtensionProcess::XWalkExtensionProcess(
   io_thread_.StartWithOptions(
       base::Thread::Options(base::MessageLoop::TYPE_IO, 0));
 
+  RegisterExtensionIPCNames();
   extensions_server_.set_permissions_delegate(this);
   CreateBrowserProcessChannel(channel_handle);
 }
@@ -43,6 +46,9 @@ XWalkExtensionProcess::~XWalkExtensionProcess() {
 }
 
 bool XWalkExtensionProcess::OnMessageReceived(const IPC::Message& message) {
+  if (IPC_MESSAGE_CLASS(message) == XWalkExtensionMsgStart)
+    XWalkIPCAccounting::GetInstance()->DidDispatch(message);
+
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP(XWalkExtensionProcess, message)
     IPC_MESSAGE_HANDLER(XWalkExtensionProcessMsg_RegisterExtensions,
@@ -188,11 +194,16 @@ void XWalkExtensionProcess::CreateRenderProcessChannel() {
 */
   extensions_server_.Initialize(render_process_channel_.get());
 
-  browser_process_channel_->Send(
+  SendToBrowser(
       new XWalkExtensionProcessHostMsg_RenderProcessChannelCreated(
           pipe.handle1.release()));
 }
 
+bool XWalkExtensionProcess::SendToBrowser(IPC::Message* message) {
+  XWalkIPCAccounting::GetInstance()->WillSend(message);
+  return browser_process_channel_->Send(message);
+}
+
 bool XWalkExtensionProcess::CheckAPIAccessControl(
     const std::string& extension_name,
     const std::string& api_name) {
@@ -202,7 +213,7 @@ bool XWalkExtensionProcess::CheckAPIAccessControl(
     return iter->second != ALLOW_ONCE;
 
   RuntimePermission result = UNDEFINED_RUNTIME_PERM;
-  browser_process_channel_->Send(
+  SendToBrowser(
       new XWalkExtensionProcessHostMsg_CheckAPIAccessControl(
           extension_name, api_name, &result));
   DLOG(INFO) << extension_name << "." << api_name << "() --> " << result;
@@ -222,7 +233,7 @@ bool XWalkExtensionProcess::RegisterPermissions(
     const std::string& extension_name,
     const std::string& perm_table) {
   bool result = false;
-  browser_process_channel_->Send(
+  SendToBrowser(
       new XWalkExtensionProcessHostMsg_RegisterPermissions(
           extension_name, perm_table, &result));
   return result;
@@ -62,6 +62,9 @@ class XWalkExtensionProcess : public IPC::Listener,
 
   void CreateRenderProcessChannel();
 
+  // Sends |message| over |browser_process_channel_|.
+  bool SendToBrowser(IPC::Message* message);
+
   base::WaitableEvent shutdown_event_;
   base::Thread io_thread_;
   std::unique_ptr<IPC::SyncChannel> browser_process_channel_;
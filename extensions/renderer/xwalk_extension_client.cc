@@ -9,14 +9,18 @@
 #include "base/stl_util.h"
 #include "base/memory/ptr_util.h"
 #include "ipc/ipc_sender.h"
+#include "xwalk/extensions/common/xwalk_extension_ipc_names.h"
 #include "xwalk/extensions/common/xwalk_extension_messages.h"
+#include "xwalk/runtime/common/xwalk_ipc_accounting.h"
 
 namespace xwalk {
 namespace extensions {
 
 XWalkExtensionClient::XWalkExtensionClient()
     : sender_(0),
-      next_instance_id_(1) {  // Zero is never used for a valid instance.
+      next_instance_id_(1),  // Zero is never used for a valid instance.
+      observer_(nullptr) {
+  RegisterExtensionIPCNames();
 }
 
 XWalkExtensionClient::~XWalkExtensionClient() {
@@ -25,6 +29,7 @@ XWalkExtensionClient::~XWalkExtensionClient() {
 bool XWalkExtensionClient::Send(IPC::Message* msg) {
   DCHECK(sender_);
 
+  XWalkIPCAccounting::GetInstance()->WillSend(msg);
   return sender_->Send(msg);
 }
 
@@ -37,10 +42,15 @@ int64_t XWalkExtensionClient::CreateInstance(
     return 0;
   }
   handlers_[next_instance_id_] = handler;
+  if (observer_)
+    observer_->OnInstanceCreated(next_instance_id_, extension_name);
   return next_instance_id_++;
 }
 
 bool XWalkExtensionClient::OnMessageReceived(const IPC::Message& message) {
+  if (IPC_MESSAGE_CLASS(message) == XWalkExtensionClientServerMsgStart)
+    XWalkIPCAccounting::GetInstance()->DidDispatch(message);
+
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP(XWalkExtensionClient, message)
     IPC_MESSAGE_HANDLER(XWalkExtensionClientMsg_PostMessageToJS,
@@ -77,6 +87,8 @@ void XWalkExtensionClient::OnPostMessageToJS(int64_t instance_id,
   const base::Value* value;
   if (!msg.Get(0, &value))
     return;
+  if (observer_)
+    observer_->OnPostMessageToJS(instance_id, *value);
   it->second->HandleMessageFromNative(*value);
 }
 
@@ -143,6 +155,8 @@ std::unique_ptr<base::ListValue> WrapValueInList(std::unique_ptr<base::Value> va
 
 void XWalkExtensionClient::PostMessageToNative(int64_t instance_id,
     std::unique_ptr<base::Value> msg) {
+  if (observer_)
+    observer_->OnPostMessageToNative(instance_id, *msg);
   std::unique_ptr<base::ListValue> list_msg = WrapValueInList(std::move(msg));
   Send(new XWalkExtensionServerMsg_PostMessageToNative(instance_id, *list_msg));
 }
@@ -151,8 +165,14 @@ std::unique_ptr<base::Value> XWalkExtensionClient::SendSyncMessageToNative(
     int64_t instance_id, std::unique_ptr<base::Value> msg) {
   std::unique_ptr<base::ListValue> wrapped_msg = WrapValueInList(std::move(msg));
   base::ListValue* wrapped_reply = new base::ListValue;
+  base::TimeTicks start;
+  if (observer_)
+    start = base::TimeTicks::Now();
   Send(new XWalkExtensionServerMsg_SendSyncMessageToNative(instance_id,
       *wrapped_msg, wrapped_reply));
+  if (observer_)
+    observer_->OnSyncMessageToNative(instance_id,
+                                     base::TimeTicks::Now() - start);
 
   std::unique_ptr<base::Value> reply;
   wrapped_reply->Remove(0, &reply);
@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "base/memory/shared_memory.h"
+#include "base/time/time.h"
 #include "base/values.h"
 #include "ipc/ipc_listener.h"
 
@@ -41,6 +42,23 @@ class XWalkExtensionClient : public IPC::Listener {
     virtual ~InstanceHandler() {}
   };
 
+  // Sees the traffic between this client and its instances. Used by tools
+  // that measure round trips, e.g. xesh --benchmark.
+  class Observer {
+   public:
+    virtual void OnInstanceCreated(int64_t instance_id,
+                                   const std::string& extension_name) = 0;
+    virtual void OnPostMessageToNative(int64_t instance_id,
+                                       const base::Value& msg) = 0;
+    virtual void OnSyncMessageToNative(int64_t instance_id,
+                                       base::TimeDelta round_trip) = 0;
+    virtual void OnPostMessageToJS(int64_t instance_id,
+                                   const base::Value& msg) = 0;
+
+   protected:
+    virtual ~Observer() {}
+  };
+
   XWalkExtensionClient();
   ~XWalkExtensionClient() override;
 
@@ -54,6 +72,8 @@ class XWalkExtensionClient : public IPC::Listener {
 
   void Initialize(IPC::Sender* sender);
 
+  void set_observer(Observer* observer) { observer_ = observer; }
+
   // IPC::Listener Implementation.
   bool OnMessageReceived(const IPC::Message& message) override;
 
@@ -84,6 +104,8 @@ class XWalkExtensionClient : public IPC::Listener {
   HandlerMap handlers_;
 
   int64_t next_instance_id_;
+
+  Observer* observer_;
 };
 
 }  // namespace extensions
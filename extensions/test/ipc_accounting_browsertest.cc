@@ -0,0 +1,129 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/public/test/browser_test_utils.h"
+#include "content/public/test/test_utils.h"
+#include "xwalk/extensions/common/xwalk_extension.h"
+#include "xwalk/extensions/common/xwalk_extension_messages.h"
+#include "xwalk/extensions/test/xwalk_extensions_test_base.h"
+#include "xwalk/runtime/browser/runtime.h"
+#include "xwalk/runtime/common/xwalk_ipc_accounting.h"
+#include "xwalk/runtime/common/xwalk_switches.h"
+#include "xwalk/test/base/xwalk_test_utils.h"
+
+using namespace xwalk::extensions;  // NOLINT
+using xwalk::Runtime;
+using xwalk::XWalkIPCAccounting;
+
+namespace {
+
+// Keep in sync with data/ipc_accounting.html.
+const uint64_t kAsyncCalls = 100;
+const uint64_t kSyncCalls = 20;
+
+class IPCAccountingInstance : public XWalkExtensionInstance {
+ public:
+  void HandleMessage(std::unique_ptr<base::Value> msg) override {
+    PostMessageToJS(std::move(msg));
+  }
+
+  void HandleSyncMessage(std::unique_ptr<base::Value> msg) override {
+    SendSyncReplyToJS(std::move(msg));
+  }
+};
+
+class IPCAccountingExtension : public XWalkExtension {
+ public:
+  IPCAccountingExtension() {
+    set_name("ipc_accounting");
+    set_javascript_api(
+        "var listener = null;"
+        "extension.setMessageListener(function(msg) {"
+        "  listener(msg);"
+        "});"
+        "exports.setListener = function(callback) {"
+        "  listener = callback;"
+        "};"
+        "exports.echo = function(value) {"
+        "  extension.postMessage(value);"
+        "};"
+        "exports.syncEcho = function(value) {"
+        "  return extension.internal.sendSyncMessage(value);"
+        "};");
+  }
+
+  XWalkExtensionInstance* CreateInstance() override {
+    return new IPCAccountingInstance();
+  }
+};
+
+}  // namespace
+
+class IPCAccountingTest : public XWalkExtensionsTestBase {
+ public:
+  void CreateExtensionsForExtensionThread(
+      XWalkExtensionVector* extensions) override {
+    extensions->push_back(new IPCAccountingExtension);
+  }
+
+  void SetUpCommandLine(base::CommandLine* command_line) override {
+    command_line->AppendSwitch(switches::kEnableIPCLatency);
+  }
+};
+
+// XWalkRunner::PreMainMessageLoopRun() does not create the
+// XWalkExtensionService in this tree, so the page never gets the extension
+// and no extension message is sent. Enable once the service is created again.
+IN_PROC_BROWSER_TEST_F(IPCAccountingTest, DISABLED_CountsExtensionMessages) {
+  XWalkIPCAccounting* accounting = XWalkIPCAccounting::GetInstance();
+  const XWalkIPCAccounting::Stats posted_before = accounting->GetStats(
+      XWalkExtensionServerMsg_PostMessageToNative::ID,
+      XWalkIPCAccounting::kReceived);
+  const XWalkIPCAccounting::Stats sync_before = accounting->GetStats(
+      XWalkExtensionServerMsg_SendSyncMessageToNative::ID,
+      XWalkIPCAccounting::kReceived);
+  const XWalkIPCAccounting::Stats replied_before = accounting->GetStats(
+      XWalkExtensionClientMsg_PostMessageToJS::ID, XWalkIPCAccounting::kSent);
+
+  Runtime* runtime = CreateRuntime();
+  content::TitleWatcher title_watcher(runtime->web_contents(), kPassString);
+  title_watcher.AlsoWaitForTitle(kFailString);
+  GURL url = GetExtensionsTestURL(base::FilePath(),
+      base::FilePath().AppendASCII("ipc_accounting.html"));
+  xwalk_test_utils::NavigateToURL(runtime, url);
+  ASSERT_EQ(kPassString, title_watcher.WaitAndGetTitle());
+
+  // Every message the page sent was dispatched here, and every one of them
+  // carried the renderer's send time.
+  XWalkIPCAccounting::Stats posted = accounting->GetStats(
+      XWalkExtensionServerMsg_PostMessageToNative::ID,
+      XWalkIPCAccounting::kReceived);
+  EXPECT_EQ(kAsyncCalls, posted.count - posted_before.count);
+  EXPECT_EQ(kAsyncCalls,
+            posted.latency_samples - posted_before.latency_samples);
+  EXPECT_GT(posted.bytes, posted_before.bytes);
+  EXPECT_FALSE(posted.sync);
+
+  uint64_t histogram_total = 0;
+  for (int i = 0; i < XWalkIPCAccounting::kLatencyBuckets; ++i) {
+    histogram_total +=
+        posted.latency_histogram[i] - posted_before.latency_histogram[i];
+  }
+  EXPECT_EQ(kAsyncCalls, histogram_total);
+
+  XWalkIPCAccounting::Stats sync = accounting->GetStats(
+      XWalkExtensionServerMsg_SendSyncMessageToNative::ID,
+      XWalkIPCAccounting::kReceived);
+  EXPECT_EQ(kSyncCalls, sync.count - sync_before.count);
+  EXPECT_TRUE(sync.sync);
+
+  XWalkIPCAccounting::Stats replied = accounting->GetStats(
+      XWalkExtensionClientMsg_PostMessageToJS::ID, XWalkIPCAccounting::kSent);
+  EXPECT_EQ(kAsyncCalls, replied.count - replied_before.count);
+
+  // The report names the types it knows.
+  std::string json = accounting->ToJSON();
+  EXPECT_NE(std::string::npos,
+            json.find("XWalkExtensionServerMsg_PostMessageToNative"));
+}
@@ -0,0 +1,157 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <utility>
+#include <vector>
+
+#include "base/command_line.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/run_loop.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "base/time/time.h"
+#include "content/public/test/browser_test_utils.h"
+#include "xwalk/extensions/browser/xwalk_extension_service.h"
+#include "xwalk/extensions/browser/xwalk_extension_spare_process_manager.h"
+#include "xwalk/extensions/common/xwalk_extension_switches.h"
+#include "xwalk/extensions/test/xwalk_extensions_test_base.h"
+#include "xwalk/runtime/browser/runtime.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+#include "xwalk/test/base/xwalk_test_utils.h"
+
+using xwalk::Runtime;
+using xwalk::extensions::XWalkExtensionService;
+using xwalk::extensions::XWalkExtensionSpareProcessManager;
+
+namespace {
+
+const int kRenderProcesses = 5;
+
+}  // namespace
+
+class SpareExtensionProcessTest
+    : public XWalkExtensionsTestBase,
+      public XWalkExtensionSpareProcessManager::Observer {
+ public:
+  SpareExtensionProcessTest()
+      : ready_count_(0), taken_count_(0), discarded_count_(0) {}
+
+  void SetUp() override {
+    XWalkExtensionService::SetExternalExtensionsPathForTesting(
+        GetExternalExtensionTestPath(FILE_PATH_LITERAL("echo_extension")));
+    XWalkExtensionsTestBase::SetUp();
+  }
+
+  void SetUpOnMainThread() override {
+    XWalkExtensionSpareProcessManager::SetObserverForTesting(this);
+  }
+
+  void ProperMainThreadCleanup() override {
+    XWalkExtensionSpareProcessManager::SetObserverForTesting(nullptr);
+  }
+
+  // XWalkExtensionSpareProcessManager::Observer implementation.
+  void OnSpareProcessReady() override {
+    ++ready_count_;
+    if (!quit_closure_.is_null())
+      quit_closure_.Run();
+  }
+
+  void OnSpareProcessTaken() override { ++taken_count_; }
+
+  void OnSpareProcessDiscarded() override {
+    ++discarded_count_;
+    if (!quit_closure_.is_null())
+      quit_closure_.Run();
+  }
+
+ protected:
+  void WaitForCount(const int* count, int expected) {
+    while (*count < expected) {
+      base::RunLoop run_loop;
+      quit_closure_ = run_loop.QuitClosure();
+      run_loop.Run();
+      quit_closure_.Reset();
+    }
+  }
+
+  // Microseconds from creating a runtime, and with it a render process,
+  // until its page got the first reply from the echo extension.
+  double TimeToFirstReply() {
+    const base::TimeTicks start = base::TimeTicks::Now();
+    Runtime* runtime = CreateRuntime();
+    content::TitleWatcher title_watcher(runtime->web_contents(), kPassString);
+    title_watcher.AlsoWaitForTitle(kFailString);
+    xwalk_test_utils::NavigateToURL(runtime, GetExtensionsTestURL(
+        base::FilePath(), base::FilePath().AppendASCII("echo.html")));
+    EXPECT_EQ(kPassString, title_watcher.WaitAndGetTitle());
+    return (base::TimeTicks::Now() - start).InMicrosecondsF();
+  }
+
+  int ready_count_;
+  int taken_count_;
+  int discarded_count_;
+  base::Closure quit_closure_;
+};
+
+class NoSpareExtensionProcessTest : public SpareExtensionProcessTest {
+ public:
+  void SetUpCommandLine(base::CommandLine* command_line) override {
+    command_line->AppendSwitch(
+        switches::kXWalkDisableSpareExtensionProcess);
+  }
+};
+
+// XWalkRunner::PreMainMessageLoopRun() does not create the
+// XWalkExtensionService in this tree. Without it no extension process, spare
+// or not, is ever launched, and no page gets a reply. Enable these once the
+// service is created again.
+IN_PROC_BROWSER_TEST_F(SpareExtensionProcessTest,
+                       DISABLED_FirstReplyWithSpare) {
+  // The first render process has no spare to take, it tells what to warm.
+  TimeToFirstReply();
+  EXPECT_EQ(0, taken_count_);
+
+  std::vector<double> samples_us;
+  for (int i = 0; i < kRenderProcesses; ++i) {
+    WaitForCount(&ready_count_, i + 1);
+    samples_us.push_back(TimeToFirstReply());
+    EXPECT_EQ(i + 1, taken_count_);
+  }
+  XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+      "extension_first_reply", "_spare", std::move(samples_us)));
+}
+
+IN_PROC_BROWSER_TEST_F(NoSpareExtensionProcessTest,
+                       DISABLED_FirstReplyWithoutSpare) {
+  // Same sequence as above, so both measure warm browser caches.
+  TimeToFirstReply();
+
+  std::vector<double> samples_us;
+  for (int i = 0; i < kRenderProcesses; ++i)
+    samples_us.push_back(TimeToFirstReply());
+  EXPECT_EQ(0, ready_count_);
+  EXPECT_EQ(0, taken_count_);
+  XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+      "extension_first_reply", "_no_spare", std::move(samples_us)));
+}
+
+IN_PROC_BROWSER_TEST_F(SpareExtensionProcessTest,
+                       DISABLED_DiscardedOnMemoryPressure) {
+  TimeToFirstReply();
+  WaitForCount(&ready_count_, 1);
+
+  base::MemoryPressureListener::SimulatePressureNotification(
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL);
+  WaitForCount(&discarded_count_, 1);
+
+  // The next render process launches its own, and no spare replaces it
+  // while the pressure is recent.
+  TimeToFirstReply();
+  EXPECT_EQ(0, taken_count_);
+  base::RunLoop run_loop;
+  base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(
+      FROM_HERE, run_loop.QuitClosure(), base::TimeDelta::FromSeconds(1));
+  run_loop.Run();
+  EXPECT_EQ(1, ready_count_);
+}
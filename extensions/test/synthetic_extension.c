@@ -0,0 +1,102 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#if defined(__cplusplus)
+#error "This file is written in C to make sure the C API works as intended."
+#endif
+
+// Copied around under different names to get many extensions out of one
+// library: "libsynthetic_7.so" calls itself "synthetic7", with entry point
+// "Synthetic7". Every XW_Initialize is logged to the file named by the
+// "init_log" runtime variable, so tests can tell which copies were loaded.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "xwalk/extensions/public/XW_Extension.h"
+#include "xwalk/extensions/public/XW_Extension_EntryPoints.h"
+#include "xwalk/extensions/public/XW_Extension_Runtime.h"
+
+static XW_Extension g_extension;
+static const XW_CoreInterface* g_core;
+static const XW_MessagingInterface* g_messaging;
+static const XW_Internal_EntryPointsInterface* g_entry_points;
+static const XW_Internal_RuntimeInterface* g_runtime;
+
+static char g_name[64];
+static char g_entry_point[64];
+static char g_api[4096];
+
+static void handle_message(XW_Instance instance, const char* message) {
+  g_messaging->PostMessage(instance, message);
+}
+
+// Runtime variables come JSON encoded, strings keep their quotes.
+static void get_string_variable(const char* key, char* value, size_t size) {
+  size_t length;
+  g_runtime->GetRuntimeVariableString(g_extension, key, value, size);
+  value[size - 1] = '\0';
+  length = strlen(value);
+  if (length >= 2 && value[0] == '"' && value[length - 1] == '"') {
+    memmove(value, value + 1, length - 2);
+    value[length - 2] = '\0';
+  }
+}
+
+static void log_initialize(void) {
+  char path[4096];
+  FILE* log;
+  get_string_variable("init_log", path, sizeof(path));
+  if (!path[0])
+    return;
+  log = fopen(path, "a");
+  if (!log)
+    return;
+  fprintf(log, "%s\n", g_name);
+  fclose(log);
+}
+
+int32_t XW_Initialize(XW_Extension extension, XW_GetInterface get_interface) {
+  char path[4096];
+  const char* number;
+  const char* entry_points[] = { g_entry_point, NULL };
+  size_t api_length;
+  int index;
+
+  g_extension = extension;
+  g_core = get_interface(XW_CORE_INTERFACE);
+  g_messaging = get_interface(XW_MESSAGING_INTERFACE);
+  g_entry_points = get_interface(XW_INTERNAL_ENTRY_POINTS_INTERFACE);
+  g_runtime = get_interface(XW_INTERNAL_RUNTIME_INTERFACE);
+  if (!g_core || !g_messaging || !g_entry_points || !g_runtime)
+    return XW_ERROR;
+
+  get_string_variable("extension_path", path, sizeof(path));
+  number = strrchr(path, '_');
+  if (!number)
+    return XW_ERROR;
+  index = atoi(number + 1);
+  snprintf(g_name, sizeof(g_name), "synthetic%d", index);
+  snprintf(g_entry_point, sizeof(g_entry_point), "Synthetic%d", index);
+
+  // About the size of a real extension's API.
+  api_length = (size_t)snprintf(
+      g_api, sizeof(g_api),
+      "exports.echo = function(msg) { extension.postMessage(msg); };"
+      "window.%s = exports;",
+      g_entry_point);
+  while (api_length + 32 < sizeof(g_api)) {
+    api_length += (size_t)snprintf(g_api + api_length,
+                                   sizeof(g_api) - api_length,
+                                   "/* padding padding padding */");
+  }
+
+  g_core->SetExtensionName(extension, g_name);
+  g_core->SetJavaScriptAPI(extension, g_api);
+  g_entry_points->SetExtraJSEntryPoints(extension, entry_points);
+  g_messaging->Register(extension, handle_message);
+
+  log_initialize();
+  return XW_OK;
+}
@@ -0,0 +1,272 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/extensions/xesh/xesh_benchmark.h"
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "xwalk/extensions/xesh/xesh_v8_runner.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+
+namespace {
+
+// Reads the "id" of a message that is a JSON object, or a string holding
+// one as the XW_Extension messaging API passes them.
+bool GetMessageId(const base::Value& msg, int* id) {
+  if (msg.is_dict()) {
+    const base::Value* value =
+        msg.FindKeyOfType("id", base::Value::Type::INTEGER);
+    if (!value)
+      return false;
+    *id = value->GetInt();
+    return true;
+  }
+  if (!msg.is_string() || msg.GetString().empty() || msg.GetString()[0] != '{')
+    return false;
+  std::unique_ptr<base::Value> parsed =
+      base::JSONReader::ReadDeprecated(msg.GetString());
+  return parsed && parsed->is_dict() && GetMessageId(*parsed, id);
+}
+
+// The distribution of |samples| as computed for xwalk_perftests, in the
+// report's own units.
+std::unique_ptr<base::DictionaryValue> Summarize(std::vector<double> samples) {
+  XWalkBenchmark::Result result =
+      XWalkBenchmark::FromSamples(std::string(), std::string(),
+                                  std::move(samples));
+  std::unique_ptr<base::DictionaryValue> summary(new base::DictionaryValue);
+  summary->SetInteger("count", static_cast<int>(result.count));
+  if (!result.count)
+    return summary;
+
+  summary->SetDouble("mean", result.mean);
+  summary->SetDouble("min", result.min);
+  summary->SetDouble("p50", result.p50);
+  summary->SetDouble("p90", result.p90);
+  summary->SetDouble("p99", result.p99);
+  summary->SetDouble("p999", result.p999);
+  summary->SetDouble("max", result.max);
+  return summary;
+}
+
+}  // namespace
+
+XEShBenchmark::Options::Options()
+    : iterations(10),
+      warmup(2),
+      timeout(base::TimeDelta::FromSeconds(10)) {}
+
+XEShBenchmark::Samples::Samples() = default;
+
+XEShBenchmark::Samples::~Samples() = default;
+
+XEShBenchmark::XEShBenchmark(const Options& options,
+                             XEShV8Runner* runner,
+                             base::OnceCallback<void(int)> done)
+    : options_(options),
+      runner_(runner),
+      done_(std::move(done)),
+      weak_factory_(this) {}
+
+XEShBenchmark::~XEShBenchmark() {}
+
+void XEShBenchmark::Start() {
+  std::string source;
+  if (!base::ReadFileToString(options_.workload, &source)) {
+    fprintf(stderr, "Cannot read workload %s\n",
+            options_.workload.value().c_str());
+    Finish(1);
+    return;
+  }
+
+  std::string error;
+  if (!runner_->CompileWorkload(source, options_.workload.BaseName().value(),
+                                &error)) {
+    fprintf(stderr, "%s", error.c_str());
+    Finish(1);
+    return;
+  }
+
+  fprintf(stderr, "Running %s: %d warmup + %d measured iterations\n",
+          options_.workload.value().c_str(), options_.warmup,
+          options_.iterations);
+  RunIteration();
+}
+
+void XEShBenchmark::RunIteration() {
+  iteration_start_ = base::TimeTicks::Now();
+
+  std::string error;
+  if (!runner_->RunWorkload(&error)) {
+    fprintf(stderr, "Iteration %d failed:\n%s", iteration_, error.c_str());
+    Finish(1);
+    return;
+  }
+
+  if (pending_count_ == 0) {
+    OnIterationDone(false);
+    return;
+  }
+
+  waiting_ = true;
+  base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(
+      FROM_HERE,
+      base::BindOnce(&XEShBenchmark::OnTimeout, weak_factory_.GetWeakPtr(),
+                     iteration_),
+      options_.timeout);
+}
+
+void XEShBenchmark::OnTimeout(int iteration) {
+  if (!waiting_ || iteration != iteration_)
+    return;
+  fprintf(stderr, "Iteration %d timed out with %zu unanswered posts\n",
+          iteration_, pending_count_);
+  OnIterationDone(true);
+}
+
+void XEShBenchmark::OnIterationDone(bool timed_out) {
+  waiting_ = false;
+
+  if (timed_out) {
+    // The posts stay queued, so that their replies, if they still come, are
+    // told apart from those of the next iteration.
+    for (const auto& pending : pending_posts_) {
+      for (const PendingPost& post : pending.second) {
+        if (post.iteration == iteration_ && recording())
+          SamplesFor(pending.first)->unanswered++;
+      }
+    }
+    pending_count_ = 0;
+    ++timeouts_;
+  }
+
+  if (recording()) {
+    iteration_ms_.push_back(
+        (base::TimeTicks::Now() - iteration_start_).InMillisecondsF());
+  }
+
+  if (++iteration_ == options_.warmup + options_.iterations) {
+    Finish(0);
+    return;
+  }
+
+  // Post rather than loop so that anything the extensions send in between
+  // is dispatched before the next iteration starts.
+  base::ThreadTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, base::BindOnce(&XEShBenchmark::RunIteration,
+                                weak_factory_.GetWeakPtr()));
+}
+
+void XEShBenchmark::Finish(int exit_code) {
+  if (exit_code == 0) {
+    std::string json;
+    base::JSONWriter::WriteWithOptions(
+        *BuildReport(), base::JSONWriter::OPTIONS_PRETTY_PRINT, &json);
+    if (options_.report.empty()) {
+      printf("%s", json.c_str());
+      fflush(stdout);
+    } else if (base::WriteFile(options_.report, json.data(), json.size()) !=
+               static_cast<int>(json.size())) {
+      fprintf(stderr, "Cannot write report to %s\n",
+              options_.report.value().c_str());
+      exit_code = 1;
+    }
+  }
+  std::move(done_).Run(exit_code);
+}
+
+XEShBenchmark::Samples* XEShBenchmark::SamplesFor(int64_t instance_id) {
+  auto it = instance_names_.find(instance_id);
+  return &samples_[it != instance_names_.end() ? it->second : "(unknown)"];
+}
+
+void XEShBenchmark::OnInstanceCreated(int64_t instance_id,
+                                      const std::string& extension_name) {
+  instance_names_[instance_id] = extension_name;
+}
+
+void XEShBenchmark::OnPostMessageToNative(int64_t instance_id,
+                                          const base::Value& msg) {
+  PendingPost post;
+  post.id = 0;
+  post.tagged = GetMessageId(msg, &post.id);
+  post.iteration = iteration_;
+  post.sent = base::TimeTicks::Now();
+  pending_posts_[instance_id].push_back(post);
+  ++pending_count_;
+}
+
+void XEShBenchmark::OnSyncMessageToNative(int64_t instance_id,
+                                          base::TimeDelta round_trip) {
+  if (recording())
+    SamplesFor(instance_id)->sync_us.push_back(round_trip.InMicrosecondsF());
+}
+
+void XEShBenchmark::OnPostMessageToJS(int64_t instance_id,
+                                      const base::Value& msg) {
+  base::TimeTicks now = base::TimeTicks::Now();
+  int id = 0;
+  bool tagged = GetMessageId(msg, &id);
+
+  std::deque<PendingPost>* pending = &pending_posts_[instance_id];
+  auto post_it = std::find_if(
+      pending->begin(), pending->end(), [tagged, id](const PendingPost& post) {
+        return post.tagged == tagged && (!tagged || post.id == id);
+      });
+  if (post_it == pending->end()) {
+    if (recording())
+      SamplesFor(instance_id)->unsolicited++;
+    return;
+  }
+
+  PendingPost post = *post_it;
+  pending->erase(post_it);
+  if (post.iteration != iteration_) {
+    // Its iteration timed out and counted it as unanswered already.
+    if (post.iteration >= options_.warmup)
+      SamplesFor(instance_id)->late++;
+    fprintf(stderr, "Discarding late reply to a post of iteration %d\n",
+            post.iteration);
+    return;
+  }
+
+  --pending_count_;
+  if (recording()) {
+    SamplesFor(instance_id)->post_us.push_back(
+        (now - post.sent).InMicrosecondsF());
+  }
+
+  if (waiting_ && pending_count_ == 0)
+    OnIterationDone(false);
+}
+
+std::unique_ptr<base::DictionaryValue> XEShBenchmark::BuildReport() const {
+  std::unique_ptr<base::DictionaryValue> report(new base::DictionaryValue);
+  report->SetString("workload", options_.workload.value());
+  report->SetInteger("iterations", options_.iterations);
+  report->SetInteger("warmup", options_.warmup);
+  report->SetInteger("timeouts", timeouts_);
+  report->Set("iteration_ms", Summarize(iteration_ms_));
+
+  std::unique_ptr<base::DictionaryValue> extensions(new base::DictionaryValue);
+  for (const auto& entry : samples_) {
+    std::unique_ptr<base::DictionaryValue> extension(new base::DictionaryValue);
+    extension->Set("postMessage_us", Summarize(entry.second.post_us));
+    extension->Set("sendSyncMessage_us", Summarize(entry.second.sync_us));
+    extension->SetInteger("unanswered", entry.second.unanswered);
+    extension->SetInteger("late", entry.second.late);
+    extension->SetInteger("unsolicited", entry.second.unsolicited);
+    extensions->SetWithoutPathExpansion(entry.first, std::move(extension));
+  }
+  report->Set("extensions", std::move(extensions));
+  return report;
+}
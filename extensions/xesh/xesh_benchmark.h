@@ -0,0 +1,133 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_EXTENSIONS_XESH_XESH_BENCHMARK_H_
+#define XWALK_EXTENSIONS_XESH_XESH_BENCHMARK_H_
+
+#include <stdint.h>
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "xwalk/extensions/renderer/xwalk_extension_client.h"
+
+class XEShV8Runner;
+
+// Runs a JS workload file against the loaded extensions a fixed number of
+// times and reports per-call round trip latencies as JSON. Lives on the v8
+// thread, next to the XEShV8Runner it drives.
+//
+// Sync calls (extension.internal.sendSyncMessage) are timed around the
+// blocking IPC. Async calls (extension.postMessage) are timed from the post
+// until its reply, so the workload is expected to talk to request/response
+// style extensions such as echo. A post whose message is a JSON object with
+// an integer "id" is answered by the reply carrying the same id, which the
+// workload should keep unique over the whole run; other posts are answered
+// by the instance's next reply without an id, in order. Replies nobody asked
+// for are only counted.
+//
+// Each iteration runs the whole workload script and then waits for every
+// outstanding post to be answered, or for the timeout, before starting the
+// next one. The first |warmup| iterations are run but not recorded. Posts
+// left unanswered by a timeout stay queued with the iteration they were
+// made in, so that their late replies are discarded rather than credited to
+// the posts of the next iteration.
+class XEShBenchmark : public xwalk::extensions::XWalkExtensionClient::Observer {
+ public:
+  struct Options {
+    Options();
+
+    base::FilePath workload;
+    int iterations;
+    int warmup;
+    base::TimeDelta timeout;
+    // Where the JSON report goes, stdout when empty.
+    base::FilePath report;
+  };
+
+  // |done| is called with the process exit code once the report is written.
+  XEShBenchmark(const Options& options,
+                XEShV8Runner* runner,
+                base::OnceCallback<void(int)> done);
+  ~XEShBenchmark() override;
+
+  // Loads and compiles the workload and starts the first iteration. Must be
+  // called on the v8 thread after the runner was initialized.
+  void Start();
+
+  // xwalk::extensions::XWalkExtensionClient::Observer implementation.
+  void OnInstanceCreated(int64_t instance_id,
+                         const std::string& extension_name) override;
+  void OnPostMessageToNative(int64_t instance_id,
+                             const base::Value& msg) override;
+  void OnSyncMessageToNative(int64_t instance_id,
+                             base::TimeDelta round_trip) override;
+  void OnPostMessageToJS(int64_t instance_id,
+                         const base::Value& msg) override;
+
+ private:
+  struct Samples {
+    Samples();
+    ~Samples();
+
+    std::vector<double> post_us;
+    std::vector<double> sync_us;
+    int unanswered = 0;
+    // Replies to unanswered posts that came after their iteration ended.
+    int late = 0;
+    int unsolicited = 0;
+  };
+
+  struct PendingPost {
+    // The "id" of the message, if it has one.
+    bool tagged;
+    int id;
+    int iteration;
+    base::TimeTicks sent;
+  };
+
+  void RunIteration();
+  void OnIterationDone(bool timed_out);
+  void OnTimeout(int iteration);
+  void Finish(int exit_code);
+
+  Samples* SamplesFor(int64_t instance_id);
+  bool recording() const { return iteration_ >= options_.warmup; }
+
+  std::unique_ptr<base::DictionaryValue> BuildReport() const;
+
+  Options options_;
+  XEShV8Runner* runner_;
+  base::OnceCallback<void(int)> done_;
+
+  std::map<int64_t, std::string> instance_names_;
+  // Per instance, in the order the replies are expected.
+  std::map<int64_t, std::deque<PendingPost>> pending_posts_;
+  // Posts of the current iteration still waiting for their reply.
+  size_t pending_count_ = 0;
+
+  // Keyed by extension name.
+  std::map<std::string, Samples> samples_;
+  std::vector<double> iteration_ms_;
+
+  int iteration_ = 0;
+  int timeouts_ = 0;
+  bool waiting_ = false;
+  base::TimeTicks iteration_start_;
+
+  base::WeakPtrFactory<XEShBenchmark> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(XEShBenchmark);
+};
+
+#endif  // XWALK_EXTENSIONS_XESH_XESH_BENCHMARK_H_
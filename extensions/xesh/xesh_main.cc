@@ -9,25 +9,37 @@
 // It is a single process application which runs with three threads (main, IO
 // and v8).
 // The overall implementation started upon v8/samples/shell.cc .
+//
+// With --benchmark=FILE it does not read stdin, it runs FILE repeatedly
+// instead and prints a JSON latency report, see XEShBenchmark:
+//
+//   xesh --external-extensions-path=DIR --benchmark=workload.js
+//        [--iterations=10] [--warmup=2] [--timeout-ms=10000]
+//        [--report=report.json]
 
 #include <unistd.h>
 
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "base/at_exit.h"
+#include "base/bind.h"
 #include "base/command_line.h"
 #include "base/files/file_util.h"
 #include "base/files/file_path.h"
 #include "base/message_loop/message_loop.h"
 #include "base/message_loop/message_pump_libevent.h"
 #include "base/run_loop.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/task_runner_util.h"
 #include "base/threading/thread.h"
+#include "base/threading/thread_task_runner_handle.h"
 #include "ipc/ipc_sync_channel.h"
 #include "xwalk/extensions/common/xwalk_extension_server.h"
 #include "xwalk/extensions/common/xwalk_extension_switches.h"
+#include "xwalk/extensions/xesh/xesh_benchmark.h"
 #include "xwalk/extensions/xesh/xesh_v8_runner.h"
 
 
@@ -36,6 +48,14 @@ using xwalk::extensions::XWalkExtensionServer;
 // Specifies which file XESh will use as input.
 const char kInputFilePath[] = "input-file";
 
+// Runs the given workload file non-interactively and reports latencies.
+const char kBenchmark[] = "benchmark";
+const char kIterations[] = "iterations";
+const char kWarmup[] = "warmup";
+const char kTimeoutMs[] = "timeout-ms";
+// File the benchmark report is written to instead of stdout.
+const char kReport[] = "report";
+
 namespace {
 
 inline void PrintInitialInfo() {
@@ -188,6 +208,45 @@ class ExtensionManager {
   XWalkExtensionServer server_;
   std::unique_ptr<IPC::SyncChannel> server_channel_;
 };
+
+int IntSwitch(const base::CommandLine& cmd_line,
+              const char* name,
+              int default_value) {
+  int value;
+  if (cmd_line.HasSwitch(name) &&
+      base::StringToInt(cmd_line.GetSwitchValueASCII(name), &value) &&
+      value >= 0) {
+    return value;
+  }
+  return default_value;
+}
+
+XEShBenchmark::Options GetBenchmarkOptions(const base::CommandLine& cmd_line) {
+  XEShBenchmark::Options options;
+  options.workload = cmd_line.GetSwitchValuePath(kBenchmark);
+  options.iterations = IntSwitch(cmd_line, kIterations, options.iterations);
+  options.warmup = IntSwitch(cmd_line, kWarmup, options.warmup);
+  options.timeout = base::TimeDelta::FromMilliseconds(IntSwitch(
+      cmd_line, kTimeoutMs, options.timeout.InMilliseconds()));
+  options.report = cmd_line.GetSwitchValuePath(kReport);
+  return options;
+}
+
+void SetExitCodeAndQuit(int* exit_code, base::OnceClosure quit, int result) {
+  *exit_code = result;
+  std::move(quit).Run();
+}
+
+// Called on the v8 thread, hands the result back to the main thread.
+void OnBenchmarkDone(scoped_refptr<base::SingleThreadTaskRunner> main_runner,
+                     int* exit_code,
+                     base::OnceClosure quit,
+                     int result) {
+  main_runner->PostTask(FROM_HERE, base::BindOnce(&SetExitCodeAndQuit,
+                                                  exit_code, std::move(quit),
+                                                  result));
+}
+
 }  // namespace
 
 int main(int argc, char* argv[]) {
@@ -211,7 +270,20 @@ int main(int argc, char* argv[]) {
   extension_manager.LoadExtensions();
   extension_manager.Initialize(io_thread.task_runner());
 
+  base::CommandLine* cmd_line = base::CommandLine::ForCurrentProcess();
+  int exit_code = 0;
+  base::RunLoop run_loop;
+
   XEShV8Runner v8_runner;
+  std::unique_ptr<XEShBenchmark> benchmark;
+  if (cmd_line->HasSwitch(kBenchmark)) {
+    benchmark.reset(new XEShBenchmark(
+        GetBenchmarkOptions(*cmd_line), &v8_runner,
+        base::BindOnce(&OnBenchmarkDone, base::ThreadTaskRunnerHandle::Get(),
+                       &exit_code, run_loop.QuitClosure())));
+    v8_runner.set_client_observer(benchmark.get());
+  }
+
   static_cast<base::MessageLoopForIO*>(v8_thread.message_loop())
       ->PostTask(FROM_HERE, base::Bind(&XEShV8Runner::Initialize,
                                        base::Unretained(&v8_runner), argc, argv,
@@ -220,19 +292,29 @@ int main(int argc, char* argv[]) {
 
   InputWatcher input_watcher(&v8_runner, v8_thread.message_loop());
 
-  static_cast<base::MessageLoopForIO*>(io_thread.message_loop())->PostTask(
-      FROM_HERE, base::Bind(&InputWatcher::StartWatching,
-      base::Unretained(&input_watcher)));
+  if (benchmark) {
+    v8_thread.task_runner()->PostTask(
+        FROM_HERE, base::BindOnce(&XEShBenchmark::Start,
+                                  base::Unretained(benchmark.get())));
+  } else {
+    static_cast<base::MessageLoopForIO*>(io_thread.message_loop())->PostTask(
+        FROM_HERE, base::Bind(&InputWatcher::StartWatching,
+        base::Unretained(&input_watcher)));
+    PrintPromptLine();
+  }
 
-  PrintPromptLine();
-  base::RunLoop run_loop;
   run_loop.Run();
 
+  if (benchmark) {
+    // The benchmark hands out weak pointers on the v8 thread.
+    v8_thread.task_runner()->DeleteSoon(FROM_HERE, benchmark.release());
+  }
+
   static_cast<base::MessageLoopForIO*>(v8_thread.message_loop())->PostTask(
       FROM_HERE, base::Bind(&XEShV8Runner::Shutdown,
       base::Unretained(&v8_runner)));
 
   io_thread.Stop();
   v8_thread.Stop();
-  return 0;
+  return exit_code;
 }
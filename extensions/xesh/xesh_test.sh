@@ -27,7 +27,29 @@ rm temp_test.js
 rm test_stdout
 rm test_stderr
 
-if [ "$RESULT" = "$EXPECTED" ]; then
+if [ "$RESULT" != "$EXPECTED" ]; then
+   echo -e "XESh Test: FAIL."
+   exit 1
+fi
+
+# Benchmark mode: a workload mixing sync and async calls must produce a
+# report with one sample per call. The posts carry ids, unique over the run.
+echo "var nextId = nextId || 0;" > temp_workload.js
+echo "for (var i = 0; i < 10; i++) {" >> temp_workload.js
+echo "  echo.syncEcho(\"\" + i);" >> temp_workload.js
+echo "  echo.echo(JSON.stringify({id: ++nextId}), function() {});" >> temp_workload.js
+echo "}" >> temp_workload.js
+
+$BUILD_DIR/xesh --external-extensions-path=$BUILD_DIR/tests/extension/echo_extension --benchmark=temp_workload.js --iterations=3 --warmup=1 --report=temp_report.json 1> /dev/null 2> test_stderr
+STATUS=$?
+
+COUNTS=`grep -c '"count": 30' temp_report.json`
+
+rm temp_workload.js
+rm -f temp_report.json
+rm test_stderr
+
+if [ $STATUS -eq 0 ] && [ "$COUNTS" = "2" ]; then
    echo -e "XESh Test: PASS."
    exit 0
 else
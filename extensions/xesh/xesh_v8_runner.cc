@@ -40,6 +40,7 @@ void XEShV8Runner::Shutdown() {
   v8::Local<v8::Context> context = GetV8Context();
 
   context->Exit();
+  workload_.Reset();
   v8_context_.Reset();
   v8::V8::Dispose();
 }
@@ -104,6 +105,38 @@ std::string XEShV8Runner::ExecuteString(std::string statement) {
   return std::string();
 }
 
+bool XEShV8Runner::CompileWorkload(const std::string& source,
+                                   const std::string& name,
+                                   std::string* error) {
+  v8::Isolate* isolate = v8::Isolate::GetCurrent();
+  v8::HandleScope handle_scope(isolate);
+
+  v8::TryCatch try_catch;
+  v8::Handle<v8::Script> script = v8::Script::Compile(
+      v8::String::NewFromUtf8(isolate, source.c_str()),
+      v8::String::NewFromUtf8(isolate, name.c_str()));
+  if (script.IsEmpty()) {
+    *error = ReportException(&try_catch);
+    return false;
+  }
+  workload_.Reset(isolate, script);
+  return true;
+}
+
+bool XEShV8Runner::RunWorkload(std::string* error) {
+  v8::Isolate* isolate = v8::Isolate::GetCurrent();
+  v8::HandleScope handle_scope(isolate);
+  DCHECK(!workload_.IsEmpty());
+
+  v8::TryCatch try_catch;
+  v8::Local<v8::Script> script = v8::Local<v8::Script>::New(isolate, workload_);
+  if (script->Run().IsEmpty()) {
+    *error = ReportException(&try_catch);
+    return false;
+  }
+  return true;
+}
+
 std::string XEShV8Runner::ReportException(v8::TryCatch* try_catch) {
   v8::HandleScope handle_scope(v8::Isolate::GetCurrent());
   v8::String::Utf8Value exception(try_catch->Exception());
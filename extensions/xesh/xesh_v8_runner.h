@@ -45,6 +45,18 @@ class XEShV8Runner {
   // Executes a string within the current v8 context.
   std::string ExecuteString(std::string statement);
 
+  // Compiles |source| once so RunWorkload() can run it repeatedly without
+  // paying for parsing. On failure |error| holds the reported exception.
+  bool CompileWorkload(const std::string& source,
+                       const std::string& name,
+                       std::string* error);
+  bool RunWorkload(std::string* error);
+
+  // Must be set before Initialize() to see the instances it creates.
+  void set_client_observer(XWalkExtensionClient::Observer* observer) {
+    client_.set_observer(observer);
+  }
+
   static const char* GetV8Version() {
     return v8::V8::GetVersion();
   }
@@ -68,6 +80,7 @@ class XEShV8Runner {
   base::WaitableEvent shutdown_event_;
 
   v8::Persistent<v8::Context> v8_context_;
+  v8::Persistent<v8::Script> workload_;
 };
 
 #endif  // XWALK_EXTENSIONS_XESH_XESH_V8_RUNNER_H_
@@ -54,6 +54,8 @@ import org.chromium.content_public.browser.WebContents;
 import org.chromium.content_public.browser.WebContentsInternals;
 import org.chromium.content_public.browser.navigation_controller.UserAgentOverrideOption;
 import org.chromium.content_public.common.UseZoomForDSFPolicy;
+import org.chromium.mojo.system.MessagePipeHandle;
+import org.chromium.mojo.system.impl.CoreImpl;
 import org.chromium.ui.base.ActivityWindowAndroid;
 import org.chromium.ui.base.PageTransition;
 import org.chromium.ui.base.ViewAndroidDelegate;
@@ -109,6 +111,7 @@ class XWalkContent implements XWalkPreferences.KeyValueChangeListener {
     private boolean mAnimated;
     private XWalkAutofillClientAndroid mXWalkAutofillClient;
     private XWalkGetBitmapCallback mXWalkGetBitmapCallback;
+    private XWalkJsMessageListener mJsMessageListener;
     private final HitTestData mPossiblyStaleHitTestData = new HitTestData();
     // Controls overscroll pull-to-refresh behavior.
     private SwipeRefreshHandler mSwipeRefreshHandler;
@@ -1492,6 +1495,23 @@ class XWalkContent implements XWalkPreferences.KeyValueChangeListener {
                 new XWalkGeolocationCallback());
     }
 
+    @CalledByNative
+    private String[] getGeolocationPermissionOrigins() {
+        return mGeolocationPermissions.getOriginsSync().toArray(new String[0]);
+    }
+
+    // A null |origins| clears the retained decisions of all origins.
+    @CalledByNative
+    private void clearGeolocationPermissions(String[] origins) {
+        if (origins == null) {
+            mGeolocationPermissions.clearAll();
+            return;
+        }
+        for (String origin : origins) {
+            mGeolocationPermissions.clear(origin);
+        }
+    }
+
     @CalledByNative
     public void onGeolocationPermissionsHidePrompt() {
         mContentsClientBridge.onGeolocationPermissionsHidePrompt();
@@ -1724,6 +1744,37 @@ class XWalkContent implements XWalkPreferences.KeyValueChangeListener {
                 isDoneCounting);
     }
 
+    /**
+     * Injects |jsObjectName| into the frames whose origin matches |allowedOriginRules| and
+     * sends the messages they post to |listener|. Returns an error message for an invalid
+     * rule, otherwise null.
+     */
+    public String setJsApiService(boolean needToInjectJsObject, String jsObjectName,
+                                  String[] allowedOriginRules, XWalkJsMessageListener listener) {
+        if (mNativeContent == 0)
+            return null;
+        mJsMessageListener = listener;
+        return nativeSetJsApiService(mNativeContent, needToInjectJsObject, jsObjectName,
+                allowedOriginRules);
+    }
+
+    @CalledByNative
+    private void onPostMessage(String message, byte[] arrayBuffer, String sourceOrigin,
+                               boolean isMainFrame, int[] ports) {
+        MessagePipeHandle[] handles = new MessagePipeHandle[ports.length];
+        for (int i = 0; i < ports.length; ++i) {
+            handles[i] = CoreImpl.getInstance().acquireNativeHandle(ports[i])
+                    .toMessagePipeHandle();
+        }
+        if (mJsMessageListener == null) {
+            for (MessagePipeHandle handle : handles)
+                handle.close();
+            return;
+        }
+        mJsMessageListener.onPostMessage(message, arrayBuffer, sourceOrigin, isMainFrame,
+                handles);
+    }
+
     @CalledByNative
     public void onOpenDnsSettings(final String failedUrl) {
         mContentsClientBridge.onOpenDnsSettings(failedUrl);
@@ -1793,6 +1844,10 @@ class XWalkContent implements XWalkPreferences.KeyValueChangeListener {
 
     private native void nativeSetJsOnlineProperty(long nativeXWalkContent, boolean networkUp);
 
+    private native String nativeSetJsApiService(long nativeXWalkContent,
+                                                boolean needToInjectJsObject, String jsObjectName,
+                                                String[] allowedOriginRules);
+
     private native boolean nativeSetManifest(long nativeXWalkContent, String path, String manifest);
 
     private native int nativeGetRoutingID(long nativeXWalkContent);
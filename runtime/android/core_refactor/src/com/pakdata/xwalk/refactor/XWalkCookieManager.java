@@ -186,6 +186,11 @@ public class XWalkCookieManager {
   }
   
   
+  public void deleteZone(final String zone) {
+      nativeDeleteZone(zone);
+  }
+  
+  
   public int nukeDomain(final String domain) {
       return nativeNukeDomain(domain);
   }
@@ -228,6 +233,7 @@ public class XWalkCookieManager {
   private native void nativeSetDbKey(String dbKey);
   private native int nativeRekeyDb(final String oldKey, final String newKey);
   private native void nativeSetZone(final String zone);
+  private native void nativeDeleteZone(final String zone);
   private native int nativeNukeDomain(final String domain);
   private native void nativePageLoadStarted(final String url);
   private native void nativeReset();
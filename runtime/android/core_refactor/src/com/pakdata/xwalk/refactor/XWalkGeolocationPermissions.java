@@ -115,12 +115,7 @@ public final class XWalkGeolocationPermissions {
      * Async method to get the domains currently allowed or denied.
      */
     public void getOrigins(final ValueCallback<Set<String>> callback) {
-        final Set<String> origins = new HashSet<String>();
-        for (String name : mSharedPreferences.getAll().keySet()) {
-            if (name.startsWith(PREF_PREFIX)) {
-                origins.add(name.substring(PREF_PREFIX.length()));
-            }
-        }
+        final Set<String> origins = getOriginsSync();
         ThreadUtils.postOnUiThread(new Runnable() {
             @Override
             public void run() {
@@ -129,6 +124,19 @@ public final class XWalkGeolocationPermissions {
         });
     }
 
+    /**
+     * Synchronous method to get the domains currently allowed or denied.
+     */
+    public Set<String> getOriginsSync() {
+        Set<String> origins = new HashSet<String>();
+        for (String name : mSharedPreferences.getAll().keySet()) {
+            if (name.startsWith(PREF_PREFIX)) {
+                origins.add(name.substring(PREF_PREFIX.length()));
+            }
+        }
+        return origins;
+    }
+
     /**
      * Get the domain of an URL using the GURL library.
      */
@@ -0,0 +1,26 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+package com.pakdata.xwalk.refactor;
+
+import org.chromium.mojo.system.MessagePipeHandle;
+
+/**
+  * Interface to receive the messages pages post through the JavaScript object
+  * injected by {@link XWalkView#setJsApiService}.
+*/
+public abstract class XWalkJsMessageListener {
+    /**
+     * Notifies the listener about a message posted by a frame whose origin is allowed.
+     *
+     * @param message the message, when a string was posted, otherwise null
+     * @param arrayBuffer the bytes, when an ArrayBuffer or a view of one was posted,
+     *                    otherwise null
+     * @param sourceOrigin the origin of the frame that posted the message
+     * @param isMainFrame whether that frame is the main frame
+     * @param ports the message ports passed along, owned by the listener
+     */
+    public abstract void onPostMessage(String message, byte[] arrayBuffer, String sourceOrigin,
+            boolean isMainFrame, MessagePipeHandle[] ports);
+}
@@ -2013,6 +2013,26 @@ public class XWalkView extends android.widget.FrameLayout {
         return mContent.getCertificateChain();
     }
 
+    /**
+     * Injects a JavaScript object named jsObjectName into the frames whose origin matches
+     * one of allowedOriginRules. Messages those frames post through its postMessage(), strings
+     * or ArrayBuffers, are passed to listener.
+     *
+     * @param needToInjectJsObject whether to inject the object at all
+     * @param jsObjectName the name of the object on the window
+     * @param allowedOriginRules rules in the format of proxy bypass rules
+     * @param listener receives the messages
+     * @return an error message for the first invalid rule, or null
+     */
+    public String setJsApiService(boolean needToInjectJsObject, String jsObjectName,
+            String[] allowedOriginRules, XWalkJsMessageListener listener) {
+        if (mContent == null)
+            return null;
+        checkThreadSafety();
+        return mContent.setJsApiService(needToInjectJsObject, jsObjectName, allowedOriginRules,
+                listener);
+    }
+
     /**
      * Registers the listener to be notified as find-on-page operations progress.
      *
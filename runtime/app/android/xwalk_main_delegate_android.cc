@@ -23,6 +23,7 @@
 #include "content/public/browser/browser_main_runner.h"
 #include "content/public/common/content_switches.h"
 #include "components/autofill/core/common/autofill_features.h"
+#include "components/download/public/common/download_features.h"
 #include "gpu/config/gpu_switches.h"
 #include "ui/base/resource/resource_bundle.h"
 #include "ui/base/resource/resource_bundle_android.h"
@@ -188,6 +189,10 @@ bool XWalkMainDelegateAndroid::BasicStartupComplete(int* exit_code) {
 //
       features.EnableIfNotSet(
           autofill::features::kAutofillSkipComparingInferredLabels);
+
+      // Large downloads from servers that take range requests are fetched
+      // over several connections.
+      features.EnableIfNotSet(download::features::kParallelDownloading);
 ////
 ////      if (cl->HasSwitch(switches::kWebViewLogJsConsoleMessages)) {
 ////        features.EnableIfNotSet(::features::kLogJsConsoleMessages);
@@ -4,10 +4,12 @@
 
 #include "xwalk/runtime/app/xwalk_main_delegate.h"
 
+#include "android_webview/browser/scoped_add_feature_flags.h"
 #include "base/command_line.h"
 #include "base/files/file_path.h"
 #include "base/logging.h"
 #include "base/path_service.h"
+#include "components/download/public/common/download_features.h"
 #include "components/nacl/common/buildflags.h"
 #include "content/public/browser/browser_main_runner.h"
 #include "content/public/common/content_switches.h"
@@ -66,6 +68,14 @@ bool XWalkMainDelegate::BasicStartupComplete(int* exit_code) {
 
   RegisterPathProvider();
 
+  {
+    android_webview::ScopedAddFeatureFlags features(
+        base::CommandLine::ForCurrentProcess());
+    // Large downloads from servers that take range requests are fetched over
+    // several connections.
+    features.EnableIfNotSet(download::features::kParallelDownloading);
+  }
+
   // initlogging
 
   return false;
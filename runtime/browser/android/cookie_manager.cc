@@ -4,6 +4,8 @@
 
 #include "xwalk/runtime/browser/android/cookie_manager.h"
 
+#include <atomic>
+#include <set>
 #include <string>
 
 #include "base/android/jni_string.h"
@@ -26,6 +28,7 @@
 #include "base/task/post_task.h"
 #include "base/threading/thread.h"
 #include "base/threading/thread_restrictions.h"
+#include "base/values.h"
 #include "content/public/browser/browser_context.h"
 #include "content/public/browser/browser_task_traits.h"
 #include "content/public/browser/browser_thread.h"
@@ -38,10 +41,18 @@
 #include "net/cookies/cookie_store.h"
 #include "net/cookies/cookie_util.h"
 #include "ui/base/resource/resource_bundle.h"
+#include "url/gurl.h"
+#include "url/origin.h"
 #include "xwalk/runtime/android/core_refactor/xwalk_refactor_native_jni/XWalkCookieManager_jni.h"
+#include "xwalk/runtime/browser/android/net/init_native_callback.h"
 #include "xwalk/runtime/browser/android/scoped_allow_wait_for_legacy_web_view_api.h"
 #include "xwalk/runtime/browser/android/xwalk_cookie_access_policy.h"
+#include "xwalk/runtime/browser/runtime_request_timeline.h"
+#include "xwalk/runtime/browser/xwalk_browser_context.h"
 #include "xwalk/runtime/browser/xwalk_browser_main_parts_android.h"
+#include "xwalk/runtime/browser/xwalk_browsing_data_remover.h"
+#include "xwalk/runtime/browser/xwalk_code_cache.h"
+#include "xwalk/runtime/common/xwalk_runtime_internals.h"
 #include "xwalk/runtime/common/xwalk_switches.h"
 
 
@@ -69,6 +80,62 @@ namespace {
 
 // Are cookies allowed for file:// URLs by default?
 const bool kDefaultFileSchemeAllowed = false;
+
+std::atomic<uint64_t> g_cookie_store_change_count{0};
+
+// Any CookieManager task may write to the store.
+void RunCookieTask(const base::Callback<void(base::WaitableEvent*)>& task,
+                   base::WaitableEvent* completion) {
+  MarkCookieStoreChanged();
+  task.Run(completion);
+}
+
+// The JNI calls come from any thread, the remover runs on the UI thread.
+void RemoveBrowsingDataOnUI(int remove_mask,
+                            const std::set<url::Origin>& origins) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  XWalkBrowserContext* browser_context = XWalkBrowserContext::GetDefault();
+  if (!browser_context)
+    return;
+  browser_context->GetXWalkBrowsingDataRemover()->Remove(
+      base::Time(), base::Time::Max(), remove_mask, origins,
+      base::DoNothing());
+}
+
+void RemoveBrowsingData(int remove_mask, std::set<url::Origin> origins) {
+  base::PostTaskWithTraits(
+      FROM_HERE, {BrowserThread::UI},
+      base::BindOnce(&RemoveBrowsingDataOnUI, remove_mask,
+                     std::move(origins)));
+}
+
+#ifdef TENTA_CHROMIUM_BUILD
+// Called once the store serves |zone|, |num_deleted| being the cookies of the
+// previous zone dropped from memory.
+void ReportZoneSwitched(const std::string& zone, uint32_t num_deleted) {
+  if (!XWalkRuntimeInternals::IsEnabled())
+    return;
+  XWalkRuntimeInternals* internals = XWalkRuntimeInternals::GetInstance();
+  internals->Count(XWalkRuntimeInternals::kCookieZoneSwitches, 1);
+  base::DictionaryValue params;
+  params.SetString("zone", zone);
+  params.SetInteger("deletedCookies", static_cast<int>(num_deleted));
+  internals->Emit("Crosswalk.cookieZoneSwitched", params);
+}
+
+// Neither :visited styles, certificate exceptions nor the DevTools request
+// timeline may show where the previous zone has been.
+void ClearZoneStateOnUI() {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  xwalk::RuntimeRequestTimeline::ClearAll(base::DoNothing::Once());
+  XWalkBrowserContext* browser_context = XWalkBrowserContext::GetDefault();
+  if (!browser_context)
+    return;
+  browser_context->ClearVisitedLinks();
+  browser_context->GetSSLHostStateDelegate()->Clear(
+      base::Callback<bool(const std::string&)>());
+}
+#endif
 //const char kPreKitkatDataDirectory[] = "app_database";
 //const char kKitkatDataDirectory[] = "app_webview";
 
@@ -201,6 +268,7 @@ class CookieManager {
   void SetDbKey(const std::string& dbKey);
   int RekeyDb(const std::string& oldKey, const std::string& newKey);
   void SetZone(const std::string& zone);
+  void DeleteZone(const std::string& zone);
   int NukeDomain(const std::string& domain);
   void PageLoadStarted(const std::string& loadingUrl);
 
@@ -302,8 +370,9 @@ CookieManager::~CookieManager() {
 void CookieManager::ExecCookieTask(const CookieTask& task, const bool wait_for_completion) {
   base::WaitableEvent completion(base::WaitableEvent::ResetPolicy::AUTOMATIC,
                                  base::WaitableEvent::InitialState::NOT_SIGNALED);
+  MarkCookieStoreChanged();
   bool executed = cookie_store_task_runner_->PostTask(FROM_HERE,
-  base::Bind(task, wait_for_completion ? &completion : nullptr));
+  base::Bind(&RunCookieTask, task, wait_for_completion ? &completion : nullptr));
 
 //  TENTA_LOG_COOKIE(INFO) << __func__ << " executed=" << executed;
 
@@ -728,6 +797,8 @@ void CookieManager::RekeyDbAsyncHelper(const std::string& oldKey, const std::str
 void CookieManager::SetZone(const std::string& zone) {
 #ifdef TENTA_CHROMIUM_BUILD
   TENTA_LOG_COOKIE(INFO) << __func__ << " zone=" << zone;
+  // Compiled scripts must not cross zones either.
+  xwalk::XWalkCodeCache::OnZoneChanged(zone);
   ExecCookieTask(base::Bind(&CookieManager::SetZoneAsyncHelper, base::Unretained(this), zone),
       false /*wait 'till finish*/);
 #endif
@@ -744,10 +815,13 @@ void CookieManager::SetZoneAsyncHelper(const std::string& zone, base::WaitableEv
     _tenta_store->ZoneSwitching(true);  // zone switch started
     _tenta_store->ZoneChanged(zone);
     _tenta_store->ZoneSwitching(false);  // done switching zone
+    ReportZoneSwitched(zone, 0);
   } else if (current_zone.compare(zone) != 0) {
     TENTA_LOG_COOKIE(INFO) << __func__ << " different_zone newZone=" << zone;
     _tenta_store->ZoneSwitching(true);  // zone switch started
     _tenta_store->ZoneChanged(zone);
+    base::PostTaskWithTraits(FROM_HERE, {BrowserThread::UI},
+                             base::BindOnce(&ClearZoneStateOnUI));
 
     GetCookieStore()->DeleteAllAsync(
         base::BindOnce(&CookieManager::SetZoneDoneDelete, base::Unretained(this), zone));
@@ -759,14 +833,33 @@ void CookieManager::SetZoneAsyncHelper(const std::string& zone, base::WaitableEv
 void CookieManager::SetZoneDoneDelete(const std::string& zone, uint32_t num_deleted) {
   TENTA_LOG_COOKIE(INFO) << __func__ << " zone=" << zone << " num_deleted=" << num_deleted;
 
+  // The new zone's cookies are loaded without change notifications.
+  MarkCookieStoreChanged();
+
   GetCookieStore()->TriggerCookieFetch();
   _tenta_store->ZoneSwitching(false);  // done switching zone
+  ReportZoneSwitched(zone, num_deleted);
 }
 
 #endif // TENTA_CHROMIUM_BUILD
 
+void CookieManager::DeleteZone(const std::string& zone) {
+#ifdef TENTA_CHROMIUM_BUILD
+  TENTA_LOG_COOKIE(INFO) << __func__ << " zone=" << zone;
+  xwalk::XWalkCodeCache::OnZoneDeleted(zone);
+#endif
+}
+
 int CookieManager::NukeDomain(const std::string& domain) {
 #ifdef TENTA_CHROMIUM_BUILD
+  // The store below also drops the zone's records of |domain|.
+  RemoveBrowsingData(
+      XWalkBrowsingDataRemover::DATA_TYPE_COOKIES |
+          XWalkBrowsingDataRemover::DATA_TYPE_HTTP_CACHE |
+          XWalkBrowsingDataRemover::DATA_TYPE_CODE_CACHE |
+          XWalkBrowsingDataRemover::DATA_TYPE_STORAGE,
+      {url::Origin::Create(GURL("http://" + domain)),
+       url::Origin::Create(GURL("https://" + domain))});
   ExecCookieTask(base::Bind(&CookieManager::NukeDomainAsyncHelper, base::Unretained(this), domain),
       true /*wait 'till finish*/);
   return 0;
@@ -858,7 +951,8 @@ static void JNI_XWalkCookieManager_RemoveSessionCookie(JNIEnv* env, const JavaPa
 }
 
 static void JNI_XWalkCookieManager_RemoveAllCookie(JNIEnv* env, const JavaParamRef<jobject>& obj) {
-  CookieManager::GetInstance()->RemoveAllCookie();
+  RemoveBrowsingData(XWalkBrowsingDataRemover::DATA_TYPE_COOKIES,
+                     std::set<url::Origin>());
 }
 
 static void JNI_XWalkCookieManager_RemoveExpiredCookie(JNIEnv* env, const JavaParamRef<jobject>& obj) {
@@ -905,6 +999,13 @@ static void JNI_XWalkCookieManager_SetZone(JNIEnv* env, const JavaParamRef<jobje
   CookieManager::GetInstance()->SetZone(zone_str);
 }
 
+static void JNI_XWalkCookieManager_DeleteZone(JNIEnv* env, const JavaParamRef<jobject>& obj,
+                                                      const JavaParamRef<jstring>& zone) {
+  std::string zone_str(ConvertJavaStringToUTF8(env, zone));
+
+  CookieManager::GetInstance()->DeleteZone(zone_str);
+}
+
 static jint JNI_XWalkCookieManager_NukeDomain(JNIEnv* env, const JavaParamRef<jobject>& obj,
                                                       const JavaParamRef<jstring>& domain) {
   std::string domain_str(ConvertJavaStringToUTF8(env, domain));
@@ -935,4 +1036,12 @@ net::CookieStore* GetCookieStore() {
   return CookieManager::GetInstance()->GetCookieStore();
 }
 
+void MarkCookieStoreChanged() {
+  g_cookie_store_change_count.fetch_add(1, std::memory_order_acq_rel);
+}
+
+uint64_t GetCookieStoreChangeCount() {
+  return g_cookie_store_change_count.load(std::memory_order_acquire);
+}
+
 }  // namespace xwalk
@@ -4,16 +4,26 @@
 
 #include "xwalk/runtime/browser/android/js_java_interaction/js_api_handler.h"
 
-//#include "android_webview/browser/aw_contents.h"
-#include "base/android/jni_android.h"
-#include "base/android/jni_array.h"
-#include "base/android/jni_string.h"
-#include "content/public/browser/render_process_host.h"
+#include <utility>
+
+#include "content/public/browser/render_frame_host.h"
 #include "content/public/browser/web_contents.h"
+#include "xwalk/runtime/browser/android/js_java_interaction/js_java_configurator_host.h"
 #include "xwalk/runtime/browser/android/xwalk_content.h"
 
 namespace xwalk {
 
+namespace {
+
+JsApiHandler::Delegate* g_delegate_for_testing = nullptr;
+
+}  // namespace
+
+// static
+void JsApiHandler::SetDelegateForTesting(Delegate* delegate) {
+  g_delegate_for_testing = delegate;
+}
+
 JsApiHandler::JsApiHandler(content::RenderFrameHost* render_frame_host)
     : render_frame_host_(render_frame_host) {}
 
@@ -25,36 +35,42 @@ void JsApiHandler::BindPendingReceiver(
 }
 
 void JsApiHandler::PostMessage(
-    const std::string& message,
+    mojom::JsMessagePayloadPtr message,
     std::vector<mojo::ScopedMessagePipeHandle> ports) {
   DCHECK(render_frame_host_);
 
   content::WebContents* web_contents =
       content::WebContents::FromRenderFrameHost(render_frame_host_);
-  XWalkContent* xwalk_contents = XWalkContent::FromWebContents(web_contents);
+  Delegate* delegate = g_delegate_for_testing;
+  if (!delegate)
+    delegate = XWalkContent::FromWebContents(web_contents);
 
-  if (!xwalk_contents)
+  if (!delegate)
     return;
-//
-//  // |source_origin| has no race with this PostMessage call, because of
-//  // associated mojo channel, the committed origin message and PostMessage are
-//  // in sequence.
-//  url::Origin source_origin = render_frame_host_->GetLastCommittedOrigin();
-//
-//  if (!xwalk_contents->IsOriginAllowedForOnPostMessage(source_origin))
-//    return;
-//
-//  std::vector<int> int_ports(ports.size(), MOJO_HANDLE_INVALID /* 0 */);
-//  for (size_t i = 0; i < ports.size(); ++i) {
-//    int_ports[i] = ports[i].release().value();
-//  }
-//
-//  JNIEnv* env = base::android::AttachCurrentThread();
-//  xwalk_contents->OnPostMessage(
-//      env, base::android::ConvertUTF8ToJavaString(env, message),
-//      base::android::ConvertUTF8ToJavaString(env, source_origin.Serialize()),
-//      web_contents->GetMainFrame() == render_frame_host_,
-//      base::android::ToJavaIntArray(env, int_ports.data(), int_ports.size()));
+
+  // |source_origin| has no race with this PostMessage call, because of
+  // associated mojo channel, the committed origin message and PostMessage are
+  // in sequence.
+  url::Origin source_origin = render_frame_host_->GetLastCommittedOrigin();
+
+  if (!IsOriginAllowed(delegate, source_origin))
+    return;
+
+  delegate->OnPostMessage(std::move(message), source_origin,
+                          web_contents->GetMainFrame() == render_frame_host_,
+                          std::move(ports));
+}
+
+bool JsApiHandler::IsOriginAllowed(Delegate* delegate,
+                                   const url::Origin& origin) {
+  JsJavaConfiguratorHost* host = delegate->GetJsJavaConfiguratorHost();
+  int rules_version = host->allowed_origin_rules_version();
+  if (rules_version != cached_rules_version_ || origin != cached_origin_) {
+    cached_origin_ = origin;
+    cached_rules_version_ = rules_version;
+    cached_origin_allowed_ = host->IsOriginAllowedForOnPostMessage(origin);
+  }
+  return cached_origin_allowed_;
 }
 
 }  // namespace xwalk
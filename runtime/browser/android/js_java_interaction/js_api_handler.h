@@ -12,6 +12,7 @@
 #include "mojo/public/cpp/bindings/associated_remote.h"
 #include "mojo/public/cpp/bindings/pending_associated_receiver.h"
 #include "mojo/public/cpp/system/message_pipe.h"
+#include "url/origin.h"
 #include "xwalk/runtime/common/js_java_interaction/interfaces.mojom.h"
 
 namespace content {
@@ -20,10 +21,28 @@ class RenderFrameHost;
 
 namespace xwalk {
 
+class JsJavaConfiguratorHost;
+
 // Implementation of mojo::JsApiHandler interface. Receives PostMessage() call
 // from renderer JsBinding.
 class JsApiHandler : public mojom::JsApiHandler {
  public:
+  // Receives the messages of a WebContents that pass the origin check.
+  // Implemented by XWalkContent, which hands them to Java.
+  class Delegate {
+   public:
+    virtual JsJavaConfiguratorHost* GetJsJavaConfiguratorHost() = 0;
+    virtual void OnPostMessage(mojom::JsMessagePayloadPtr message, const url::Origin& source_origin,
+                               bool is_main_frame, std::vector<mojo::ScopedMessagePipeHandle> ports) = 0;
+
+   protected:
+    virtual ~Delegate() {}
+  };
+
+  // Makes every handler deliver to |delegate| instead of the XWalkContent of
+  // its WebContents. Pass nullptr to restore.
+  static void SetDelegateForTesting(Delegate* delegate);
+
   explicit JsApiHandler(content::RenderFrameHost* rfh);
   ~JsApiHandler() override;
 
@@ -31,10 +50,20 @@ class JsApiHandler : public mojom::JsApiHandler {
   void BindPendingReceiver(mojo::PendingAssociatedReceiver<mojom::JsApiHandler> pending_receiver);
 
   // mojom::JsApiHandler implementation.
-  void PostMessage(const std::string& message, std::vector<mojo::ScopedMessagePipeHandle> ports) override;
+  void PostMessage(mojom::JsMessagePayloadPtr message, std::vector<mojo::ScopedMessagePipeHandle> ports) override;
 
  private:
+  // Matching |origin| against the ProxyBypassRules is comparatively expensive,
+  // and a frame keeps posting from the same committed origin, so the answer is
+  // cached until either the origin or the configured rules change.
+  bool IsOriginAllowed(Delegate* delegate, const url::Origin& origin);
+
   content::RenderFrameHost* render_frame_host_;
+
+  url::Origin cached_origin_;
+  int cached_rules_version_ = -1;
+  bool cached_origin_allowed_ = false;
+
   mojo::AssociatedReceiver<mojom::JsApiHandler> receiver_ { this };
 
   DISALLOW_COPY_AND_ASSIGN(JsApiHandler)
@@ -0,0 +1,167 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures postMessage() from a frame to the embedder through JsApiHandler,
+// for string and ArrayBuffer payloads between 1 KB and 16 MB: the mojo
+// transport, the origin check against the rules of JsJavaConfiguratorHost,
+// and the hand-off to the JsApiHandler::Delegate. XWalkContent's delegate
+// then converts to Java, which needs a Java VM and is not covered.
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "content/public/test/test_renderer_host.h"
+#include "mojo/public/cpp/base/big_buffer.h"
+#include "mojo/public/cpp/bindings/associated_remote.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+#include "xwalk/runtime/browser/android/js_java_interaction/js_api_handler.h"
+#include "xwalk/runtime/browser/android/js_java_interaction/js_java_configurator_host.h"
+#include "xwalk/runtime/common/js_java_interaction/interfaces.mojom.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+
+namespace xwalk {
+
+namespace {
+
+const char kPageUrl[] = "https://example.com/index.html";
+const char kAllowedOrigin[] = "https://example.com";
+
+// Every size moves roughly this many bytes, so small and large payloads are
+// measured over a comparable amount of work.
+const size_t kBytesPerRun = 64 * 1024 * 1024;
+const size_t kMinSamples = 8;
+const size_t kPayloadSizes[] = {
+    1024, 16 * 1024, 256 * 1024, 1024 * 1024, 4 * 1024 * 1024,
+    16 * 1024 * 1024,
+};
+
+class CountingDelegate : public JsApiHandler::Delegate {
+ public:
+  explicit CountingDelegate(JsJavaConfiguratorHost* host) : host_(host) {}
+  ~CountingDelegate() override {}
+
+  void ExpectOne(base::OnceClosure done) { done_ = std::move(done); }
+
+  size_t received_bytes() const { return received_bytes_; }
+
+  // JsApiHandler::Delegate implementation.
+  JsJavaConfiguratorHost* GetJsJavaConfiguratorHost() override {
+    return host_;
+  }
+  void OnPostMessage(mojom::JsMessagePayloadPtr message,
+                     const url::Origin& source_origin,
+                     bool is_main_frame,
+                     std::vector<mojo::ScopedMessagePipeHandle> ports) override {
+    EXPECT_TRUE(is_main_frame);
+    if (message->is_string_value())
+      received_bytes_ += message->get_string_value().size();
+    else
+      received_bytes_ += message->get_array_buffer_value().size();
+    std::move(done_).Run();
+  }
+
+ private:
+  JsJavaConfiguratorHost* host_;
+  size_t received_bytes_ = 0;
+  base::OnceClosure done_;
+
+  DISALLOW_COPY_AND_ASSIGN(CountingDelegate);
+};
+
+class JsApiHandlerPerfTest : public content::RenderViewHostTestHarness {
+ protected:
+  void SetUp() override {
+    content::RenderViewHostTestHarness::SetUp();
+    NavigateAndCommit(GURL(kPageUrl));
+
+    host_ = std::make_unique<JsJavaConfiguratorHost>(web_contents());
+    ASSERT_EQ("", host_->SetJsApiService(true, "jsApi", {kAllowedOrigin}));
+    delegate_ = std::make_unique<CountingDelegate>(host_.get());
+    JsApiHandler::SetDelegateForTesting(delegate_.get());
+
+    handler_ = std::make_unique<JsApiHandler>(main_rfh());
+    handler_->BindPendingReceiver(
+        remote_.BindNewEndpointAndPassDedicatedReceiverForTesting());
+  }
+
+  void TearDown() override {
+    remote_.reset();
+    handler_.reset();
+    JsApiHandler::SetDelegateForTesting(nullptr);
+    delegate_.reset();
+    host_.reset();
+    content::RenderViewHostTestHarness::TearDown();
+  }
+
+  // Posts payloads of |payload_size| made by |make_payload| one at a time,
+  // each timed until the delegate has it.
+  void RunLatency(
+      const std::string& name,
+      size_t payload_size,
+      const base::RepeatingCallback<mojom::JsMessagePayloadPtr()>& make_payload) {
+    size_t count = std::max(kBytesPerRun / payload_size, kMinSamples);
+    size_t bytes_before = delegate_->received_bytes();
+
+    std::vector<double> samples_us;
+    for (size_t i = 0; i < count; ++i) {
+      mojom::JsMessagePayloadPtr payload = make_payload.Run();
+      base::RunLoop run_loop;
+      delegate_->ExpectOne(run_loop.QuitClosure());
+      base::TimeTicks start = base::TimeTicks::Now();
+      remote_->PostMessage(std::move(payload), {});
+      run_loop.Run();
+      samples_us.push_back(
+          (base::TimeTicks::Now() - start).InMicrosecondsF());
+    }
+
+    EXPECT_EQ(count * payload_size,
+              delegate_->received_bytes() - bytes_before);
+    XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+        name, base::StringPrintf("_%zuKB", payload_size / 1024),
+        std::move(samples_us)));
+  }
+
+  std::unique_ptr<JsJavaConfiguratorHost> host_;
+  std::unique_ptr<CountingDelegate> delegate_;
+  std::unique_ptr<JsApiHandler> handler_;
+  mojo::AssociatedRemote<mojom::JsApiHandler> remote_;
+};
+
+mojom::JsMessagePayloadPtr MakeStringPayload(const std::string* data) {
+  return mojom::JsMessagePayload::NewStringValue(*data);
+}
+
+mojom::JsMessagePayloadPtr MakeBufferPayload(const std::vector<uint8_t>* data) {
+  return mojom::JsMessagePayload::NewArrayBufferValue(
+      mojo_base::BigBuffer(*data));
+}
+
+}  // namespace
+
+// Baseline: what apps did before, shipping binary data as (base64) strings.
+TEST_F(JsApiHandlerPerfTest, StringPostMessage) {
+  for (size_t size : kPayloadSizes) {
+    std::string data(size, 'x');
+    RunLatency("js_api_post_message_string", size,
+               base::BindRepeating(&MakeStringPayload, &data));
+  }
+}
+
+TEST_F(JsApiHandlerPerfTest, ArrayBufferPostMessage) {
+  for (size_t size : kPayloadSizes) {
+    std::vector<uint8_t> data(size, 0x5a);
+    RunLatency("js_api_post_message_array_buffer", size,
+               base::BindRepeating(&MakeBufferPayload, &data));
+  }
+}
+
+}  // namespace xwalk
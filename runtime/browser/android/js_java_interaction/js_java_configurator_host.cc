@@ -31,17 +31,27 @@ base::android::ScopedJavaLocalRef<jstring> JsJavaConfiguratorHost::SetJsApiServi
   std::vector<std::string> native_allowed_origin_rules;
   AppendJavaStringArrayToStringVector(env, allowed_origin_rules, &native_allowed_origin_rules);
 
+  std::string error =
+      SetJsApiService(need_to_inject_js_object, native_js_object_name, native_allowed_origin_rules);
+  if (!error.empty())
+    return base::android::ConvertUTF8ToJavaString(env, error);
+  return nullptr;
+}
+
+std::string JsJavaConfiguratorHost::SetJsApiService(bool need_to_inject_js_object, const std::string& js_object_name,
+                                                    const std::vector<std::string>& allowed_origin_rules) {
   need_to_inject_js_object_ = need_to_inject_js_object;
-  js_object_name_ = native_js_object_name;
+  js_object_name_ = js_object_name;
   allowed_origin_rules_ = net::ProxyBypassRules();
-  for (auto& rule : native_allowed_origin_rules) {
+  ++allowed_origin_rules_version_;
+  for (auto& rule : allowed_origin_rules) {
     if (!allowed_origin_rules_.AddRuleFromString(rule)) {
-      return base::android::ConvertUTF8ToJavaString(env, "allowedOriginRules " + rule + " is invalid");
+      return "allowedOriginRules " + rule + " is invalid";
     }
   }
 
   web_contents()->ForEachFrame(base::BindRepeating(&JsJavaConfiguratorHost::NotifyFrame, base::Unretained(this)));
-  return nullptr;
+  return std::string();
 }
 
 bool JsJavaConfiguratorHost::IsOriginAllowedForOnPostMessage(const url::Origin& origin) {
@@ -35,8 +35,18 @@ class JsJavaConfiguratorHost : public content::WebContentsObserver {
       JNIEnv* env, bool need_to_inject_js_object, const base::android::JavaParamRef<jstring>& js_object_name,
       const base::android::JavaParamRef<jobjectArray>& allowed_origin_rules);
 
+  // Native side of the above. Returns an error message for the first invalid
+  // rule, or an empty string.
+  std::string SetJsApiService(bool need_to_inject_js_object, const std::string& js_object_name,
+                              const std::vector<std::string>& allowed_origin_rules);
+
   bool IsOriginAllowedForOnPostMessage(const url::Origin& origin);
 
+  // Incremented every time the allowed origin rules are replaced, so callers
+  // caching the result of IsOriginAllowedForOnPostMessage() can tell when the
+  // cached answer went stale.
+  int allowed_origin_rules_version() const { return allowed_origin_rules_version_; }
+
   // content::WebContentsObserver implementations
   void RenderFrameCreated(content::RenderFrameHost* render_frame_host) override;
 
@@ -48,6 +58,7 @@ class JsJavaConfiguratorHost : public content::WebContentsObserver {
   // We use ProxyBypassRules because it has the functionality that suitable
   // here, but it is not for proxy bypass.
   net::ProxyBypassRules allowed_origin_rules_;
+  int allowed_origin_rules_version_ = 0;
 
   DISALLOW_COPY_AND_ASSIGN(JsJavaConfiguratorHost)
   ;
@@ -5,6 +5,8 @@
 #ifndef XWALK_RUNTIME_BROWSER_ANDROID_NET_INIT_NATIVE_CALLBACK_H_
 #define XWALK_RUNTIME_BROWSER_ANDROID_NET_INIT_NATIVE_CALLBACK_H_
 
+#include <stdint.h>
+
 #include <memory>
 
 #include "base/memory/ref_counted.h"
@@ -27,6 +29,14 @@ scoped_refptr<base::SingleThreadTaskRunner> GetCookieStoreTaskRunner();
 // CookieStore's TaskRunner.
 net::CookieStore* GetCookieStore();
 
+// Counts writes to the CookieStore. Every write bumps it on the thread that
+// issues it, before it is posted anywhere, and again on the CookieStore's
+// thread right before it runs. A cached read tagged with an older count may
+// be stale. Unlike the store's change notifications, which arrive in a later
+// task, this is never behind a write. May be called on any thread.
+void MarkCookieStoreChanged();
+uint64_t GetCookieStoreChangeCount();
+
 }  // namespace xwalk
 
 #endif  // XWALK_RUNTIME_BROWSER_ANDROID_NET_INIT_NATIVE_CALLBACK_H_
@@ -4,11 +4,14 @@
 
 #include "xwalk/runtime/browser/android/net/xwalk_cookie_store_wrapper.h"
 
+#include <algorithm>
+#include <atomic>
 #include <string>
+#include <tuple>
+#include <utility>
 
 #include "base/bind.h"
 #include "base/memory/ref_counted_delete_on_sequence.h"
-#include "base/synchronization/waitable_event.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "url/gurl.h"
 #include "xwalk/runtime/browser/android/net/init_native_callback.h"
@@ -17,82 +20,223 @@ namespace xwalk {
 
 namespace {
 
-// Posts |task| to the thread that the global CookieStore lives on.
-void PostTaskToCookieStoreTaskRunner(base::OnceClosure task) {
-  GetCookieStoreTaskRunner()->PostTask(FROM_HERE, std::move(task));
-}
+// Cached cookie lists are dropped wholesale past this many URLs.
+const size_t kMaxReadCacheEntries = 64;
 
 void SetCookieWithOptionsAsyncOnCookieThread(
     const GURL& url,
     const std::string& cookie_line,
     const net::CookieOptions& options,
-    net::CookieStore::SetCookiesCallback callback) {
-  DLOG(INFO) << "Setting cookie Async in cookie_store_wrapper";
-  GetCookieStore()->SetCookieWithOptionsAsync(url, cookie_line, options,
-                                              std::move(callback));
+    net::CookieStore::SetCookiesCallback callback,
+    net::CookieStore* cookie_store) {
+  cookie_store->SetCookieWithOptionsAsync(url, cookie_line, options,
+                                          std::move(callback));
 }
 
 void SetCanonicalCookieAsyncOnCookieThread(std::unique_ptr<net::CanonicalCookie> cookie, std::string source_scheme,
-                                           const net::CookieOptions& options, net::CookieStore::SetCookiesCallback callback) {
-
-  GetCookieStore()->SetCanonicalCookieAsync(std::move(cookie), source_scheme, options, std::move(callback));
-}
-
-void GetCookieListWithOptionsAsyncOnCookieThread(
-    const GURL& url,
-    const net::CookieOptions& options,
-    net::CookieStore::GetCookieListCallback callback) {
-  GetCookieStore()->GetCookieListWithOptionsAsync(url, options, std::move(callback));
+                                           const net::CookieOptions& options, net::CookieStore::SetCookiesCallback callback,
+                                           net::CookieStore* cookie_store) {
+  cookie_store->SetCanonicalCookieAsync(std::move(cookie), source_scheme, options, std::move(callback));
 }
 
 void GetAllCookiesAsyncOnCookieThread(
-    net::CookieStore::GetCookieListCallback callback) {
-  GetCookieStore()->GetAllCookiesAsync(std::move(callback));
+    net::CookieStore::GetCookieListCallback callback,
+    net::CookieStore* cookie_store) {
+  cookie_store->GetAllCookiesAsync(std::move(callback));
 }
 
 void DeleteCanonicalCookieAsyncOnCookieThread(
     const net::CanonicalCookie& cookie,
-    net::CookieStore::DeleteCallback callback) {
-  GetCookieStore()->DeleteCanonicalCookieAsync(cookie, std::move(callback));
+    net::CookieStore::DeleteCallback callback,
+    net::CookieStore* cookie_store) {
+  cookie_store->DeleteCanonicalCookieAsync(cookie, std::move(callback));
 }
 
 void DeleteAllCreatedInTimeRangeAsyncOnCookieThread(
     const net::CookieDeletionInfo::TimeRange& creation_range,
-    net::CookieStore::DeleteCallback callback) {
-  GetCookieStore()->DeleteAllCreatedInTimeRangeAsync(creation_range,
+    net::CookieStore::DeleteCallback callback,
+    net::CookieStore* cookie_store) {
+  cookie_store->DeleteAllCreatedInTimeRangeAsync(creation_range,
                                                  std::move(callback));
 }
 
-void DeleteAllMatchingInfoAsyncOnCookieThread(net::CookieDeletionInfo delete_info, net::CookieStore::DeleteCallback callback) {
-  GetCookieStore()->DeleteAllMatchingInfoAsync(delete_info, std::move(callback));
+void DeleteAllMatchingInfoAsyncOnCookieThread(net::CookieDeletionInfo delete_info,
+                                              net::CookieStore::DeleteCallback callback,
+                                              net::CookieStore* cookie_store) {
+  cookie_store->DeleteAllMatchingInfoAsync(std::move(delete_info), std::move(callback));
 }
 
 void DeleteSessionCookiesAsyncOnCookieThread(
-    net::CookieStore::DeleteCallback callback) {
-  GetCookieStore()->DeleteSessionCookiesAsync(std::move(callback));
+    net::CookieStore::DeleteCallback callback,
+    net::CookieStore* cookie_store) {
+  cookie_store->DeleteSessionCookiesAsync(std::move(callback));
 }
 
 void SetCookieableSchemesOnCookieThread(const std::vector<std::string>& schemes,
-                                        net::CookieStore::SetCookieableSchemesCallback callback) {
-  GetCookieStore()->SetCookieableSchemes(schemes, std::move(callback));
+                                        net::CookieStore::SetCookieableSchemesCallback callback,
+                                        net::CookieStore* cookie_store) {
+  cookie_store->SetCookieableSchemes(schemes, std::move(callback));
 }
 
-void FlushStoreOnCookieThread(base::OnceClosure callback) {
-  GetCookieStore()->FlushStore(std::move(callback));
+void FlushStoreOnCookieThread(base::OnceClosure callback,
+                              net::CookieStore* cookie_store) {
+  cookie_store->FlushStore(std::move(callback));
 }
 
-void SetForceKeepSessionStateOnCookieThread() {
-  GetCookieStore()->SetForceKeepSessionState();
+void SetForceKeepSessionStateOnCookieThread(net::CookieStore* cookie_store) {
+  cookie_store->SetForceKeepSessionState();
 }
 
-void TriggerCookieFetchOnCookieThread() {
-  GetCookieStore()->TriggerCookieFetch();
+void TriggerCookieFetchOnCookieThread(net::CookieStore* cookie_store) {
+  cookie_store->TriggerCookieFetch();
+}
+
+void RunMutationOnCookieThread(
+    base::OnceCallback<void(net::CookieStore*)> mutation,
+    net::CookieStore* cookie_store) {
+  MarkCookieStoreChanged();
+  std::move(mutation).Run(cookie_store);
 }
 
 }  // namespace
 
+// Replies are slotted in on the client thread while the batch is filled, then
+// only touched on the cookie thread, where the CookieStore runs its callbacks.
+class XWalkCookieStoreWrapper::Batch
+    : public base::RefCountedThreadSafe<Batch> {
+ public:
+  Batch(uint64_t id,
+        scoped_refptr<base::SingleThreadTaskRunner> client_task_runner,
+        base::WeakPtr<XWalkCookieStoreWrapper> weak_cookie_store)
+      : id_(id),
+        client_task_runner_(std::move(client_task_runner)),
+        weak_cookie_store_(std::move(weak_cookie_store)) {}
+
+  template <class... Args>
+  static void OnReply(scoped_refptr<Batch> batch,
+                      size_t slot,
+                      base::OnceCallback<void(Args...)> callback,
+                      Args... args) {
+    batch->SetReply(slot, base::BindOnce(std::move(callback), args...));
+  }
+
+  size_t AddSlot() {
+    replies_.emplace_back();
+    ++pending_replies_;
+    return replies_.size() - 1;
+  }
+
+  void Run(net::CookieStore* cookie_store, std::vector<Operation> operations) {
+    for (Operation& operation : operations)
+      std::move(operation).Run(cookie_store);
+    dispatched_ = true;
+    MaybeDeliver();
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<Batch>;
+
+  ~Batch() {}
+
+  void SetReply(size_t slot, base::OnceClosure reply) {
+    DCHECK(!replies_[slot]);
+    replies_[slot] = std::move(reply);
+    --pending_replies_;
+    MaybeDeliver();
+  }
+
+  // Operations may complete asynchronously (e.g. while the store is still
+  // loading), the replies go back once all of them have.
+  void MaybeDeliver() {
+    if (!dispatched_ || pending_replies_ > 0)
+      return;
+    client_task_runner_->PostTask(
+        FROM_HERE,
+        base::BindOnce(&XWalkCookieStoreWrapper::RunReplies,
+                       weak_cookie_store_, id_, std::move(replies_)));
+  }
+
+  const uint64_t id_;
+  scoped_refptr<base::SingleThreadTaskRunner> client_task_runner_;
+  base::WeakPtr<XWalkCookieStoreWrapper> weak_cookie_store_;
+  std::vector<base::OnceClosure> replies_;
+  size_t pending_replies_ = 0;
+  bool dispatched_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(Batch);
+};
+
+// Subscribes to all changes of the underlying store on the cookie thread. The
+// notifications arrive in a task posted after the change, so they only catch
+// writers that do not call MarkCookieStoreChanged() themselves.
+class XWalkCookieStoreWrapper::StoreChangeCounter
+    : public base::RefCountedDeleteOnSequence<StoreChangeCounter> {
+ public:
+  explicit StoreChangeCounter(
+      scoped_refptr<base::SequencedTaskRunner> cookie_task_runner)
+      : base::RefCountedDeleteOnSequence<StoreChangeCounter>(
+            std::move(cookie_task_runner)) {}
+
+  // False until the subscription is in place, or if the store does not
+  // support it. Nothing may be cached then.
+  bool tracking() const { return tracking_.load(std::memory_order_acquire); }
+
+  void EnsureSubscribed(net::CookieStore* cookie_store) {
+    if (subscription_)
+      return;
+    subscription_ = cookie_store->GetChangeDispatcher().AddCallbackForAllChanges(
+        base::BindRepeating(&StoreChangeCounter::OnChanged,
+                            base::Unretained(this)));
+    tracking_.store(!!subscription_, std::memory_order_release);
+  }
+
+ private:
+  friend class base::RefCountedDeleteOnSequence<StoreChangeCounter>;
+  friend class base::DeleteHelper<StoreChangeCounter>;
+
+  ~StoreChangeCounter() {}
+
+  void OnChanged(const net::CanonicalCookie& cookie,
+                 net::CookieChangeCause cause) {
+    MarkCookieStoreChanged();
+  }
+
+  std::atomic<bool> tracking_{false};
+  std::unique_ptr<net::CookieChangeSubscription> subscription_;
+
+  DISALLOW_COPY_AND_ASSIGN(StoreChangeCounter);
+};
+
+bool XWalkCookieStoreWrapper::ReadCacheKey::operator<(
+    const ReadCacheKey& other) const {
+  return std::tie(url, exclude_httponly, same_site_cookie_context,
+                  return_excluded_cookies) <
+         std::tie(other.url, other.exclude_httponly,
+                  other.same_site_cookie_context,
+                  other.return_excluded_cookies);
+}
+
+XWalkCookieStoreWrapper::ReadCacheEntry::ReadCacheEntry() = default;
+
+XWalkCookieStoreWrapper::ReadCacheEntry::ReadCacheEntry(
+    const ReadCacheEntry& other) = default;
+
+XWalkCookieStoreWrapper::ReadCacheEntry::~ReadCacheEntry() = default;
+
 XWalkCookieStoreWrapper::XWalkCookieStoreWrapper()
-    : client_task_runner_(base::ThreadTaskRunnerHandle::Get()),
+    : XWalkCookieStoreWrapper(base::ThreadTaskRunnerHandle::Get(), nullptr,
+                              nullptr) {}
+
+XWalkCookieStoreWrapper::XWalkCookieStoreWrapper(
+    scoped_refptr<base::SingleThreadTaskRunner> client_task_runner,
+    scoped_refptr<base::SingleThreadTaskRunner> cookie_task_runner,
+    net::CookieStore* cookie_store)
+    : client_task_runner_(std::move(client_task_runner)),
+      cookie_task_runner_(std::move(cookie_task_runner)),
+      cookie_store_(cookie_store),
+      batches_sent_(0),
+      batches_replied_(0),
+      mutation_count_(0),
       weak_factory_(this) {}
 
 XWalkCookieStoreWrapper::~XWalkCookieStoreWrapper() {}
@@ -103,9 +247,9 @@ void XWalkCookieStoreWrapper::SetCookieWithOptionsAsync(
     const net::CookieOptions& options,
     net::CookieStore::SetCookiesCallback callback) {
   DCHECK(client_task_runner_->BelongsToCurrentThread());
-  PostTaskToCookieStoreTaskRunner(
+  EnqueueMutation(
       base::BindOnce(&SetCookieWithOptionsAsyncOnCookieThread, url, cookie_line, options,
-                     CreateWrappedCallback<net::CanonicalCookie::CookieInclusionStatus>(std::move(callback))));
+                     WrapForBatch(std::move(callback))));
 }
 
 /**
@@ -114,68 +258,84 @@ void XWalkCookieStoreWrapper::SetCookieWithOptionsAsync(
 void XWalkCookieStoreWrapper::SetCanonicalCookieAsync(std::unique_ptr<net::CanonicalCookie> cookie, std::string source_scheme,
                                                       const net::CookieOptions& options, SetCookiesCallback callback) {
   DCHECK(client_task_runner_->BelongsToCurrentThread());
-  PostTaskToCookieStoreTaskRunner(
+  EnqueueMutation(
       base::BindOnce(&SetCanonicalCookieAsyncOnCookieThread, std::move(cookie), source_scheme, options,
-                     CreateWrappedCallback<net::CanonicalCookie::CookieInclusionStatus>(std::move(callback))));
+                     WrapForBatch(std::move(callback))));
 }
 
 void XWalkCookieStoreWrapper::GetCookieListWithOptionsAsync(const GURL& url, const net::CookieOptions& options,
                                                             GetCookieListCallback callback) {
   DCHECK(client_task_runner_->BelongsToCurrentThread());
-  PostTaskToCookieStoreTaskRunner(
-      base::BindOnce(&GetCookieListWithOptionsAsyncOnCookieThread, url, options,
-                     CreateWrappedGetCookieListCallback(std::move(callback))));
+  ReadCacheKey key = {url.spec(), options.exclude_httponly(),
+                      static_cast<int>(options.same_site_cookie_context()),
+                      options.return_excluded_cookies()};
+
+  if (const ReadCacheEntry* entry = FindCachedCookieList(key)) {
+    if (!callback.is_null()) {
+      ReplyInOrder(base::BindOnce(std::move(callback), entry->cookies,
+                                  entry->excluded_cookies));
+    }
+    return;
+  }
+
+  CookieListWithGenerationCallback reply;
+  if (!callback.is_null()) {
+    reply = base::BindOnce(&XWalkCookieStoreWrapper::OnCookieListReply,
+                           weak_factory_.GetWeakPtr(), key, mutation_count_,
+                           std::move(callback));
+  }
+  Enqueue(base::BindOnce(&XWalkCookieStoreWrapper::GetCookieListOnCookieThread,
+                         url, options, WrapForBatch(std::move(reply))));
 }
 
 void XWalkCookieStoreWrapper::GetAllCookiesAsync(
     GetCookieListCallback callback) {
   DCHECK(client_task_runner_->BelongsToCurrentThread());
-  PostTaskToCookieStoreTaskRunner(
-      base::BindOnce(&GetAllCookiesAsyncOnCookieThread, CreateWrappedGetCookieListCallback(std::move(callback))));
+  Enqueue(base::BindOnce(&GetAllCookiesAsyncOnCookieThread,
+                         WrapForBatch(std::move(callback))));
 }
 
 void XWalkCookieStoreWrapper::DeleteCanonicalCookieAsync(
     const net::CanonicalCookie& cookie,
     DeleteCallback callback) {
   DCHECK(client_task_runner_->BelongsToCurrentThread());
-  PostTaskToCookieStoreTaskRunner(
+  EnqueueMutation(
       base::BindOnce(&DeleteCanonicalCookieAsyncOnCookieThread, cookie,
-                     CreateWrappedCallback<uint32_t>(std::move(callback))));
+                     WrapForBatch(std::move(callback))));
 }
 
 void XWalkCookieStoreWrapper::DeleteAllCreatedInTimeRangeAsync(const net::CookieDeletionInfo::TimeRange& creation_range,
                                                                net::CookieStore::DeleteCallback callback) {
 
   DCHECK(client_task_runner_->BelongsToCurrentThread());
-  PostTaskToCookieStoreTaskRunner(
+  EnqueueMutation(
       base::BindOnce(&DeleteAllCreatedInTimeRangeAsyncOnCookieThread, creation_range,
-                     CreateWrappedCallback<uint32_t>(std::move(callback))));
+                     WrapForBatch(std::move(callback))));
 }
 
 void XWalkCookieStoreWrapper::DeleteAllMatchingInfoAsync(net::CookieDeletionInfo delete_info, DeleteCallback callback) {
   DCHECK(client_task_runner_->BelongsToCurrentThread());
-  PostTaskToCookieStoreTaskRunner(
+  EnqueueMutation(
       base::BindOnce(&DeleteAllMatchingInfoAsyncOnCookieThread, std::move(delete_info),
-                     CreateWrappedCallback<uint32_t>(std::move(callback))));
+                     WrapForBatch(std::move(callback))));
 }
 
 void XWalkCookieStoreWrapper::DeleteSessionCookiesAsync(
     DeleteCallback callback) {
   DCHECK(client_task_runner_->BelongsToCurrentThread());
-  PostTaskToCookieStoreTaskRunner(
-      base::BindOnce(&DeleteSessionCookiesAsyncOnCookieThread, CreateWrappedCallback<uint32_t>(std::move(callback))));
+  EnqueueMutation(
+      base::BindOnce(&DeleteSessionCookiesAsyncOnCookieThread, WrapForBatch(std::move(callback))));
 }
 
 void XWalkCookieStoreWrapper::FlushStore(base::OnceClosure callback) {
   DCHECK(client_task_runner_->BelongsToCurrentThread());
-  PostTaskToCookieStoreTaskRunner(
-      base::BindOnce(&FlushStoreOnCookieThread, CreateWrappedClosureCallback(std::move(callback))));
+  Enqueue(
+      base::BindOnce(&FlushStoreOnCookieThread, WrapForBatch(std::move(callback))));
 }
 
 void XWalkCookieStoreWrapper::SetForceKeepSessionState() {
   DCHECK(client_task_runner_->BelongsToCurrentThread());
-  PostTaskToCookieStoreTaskRunner(
-      base::BindOnce(&SetForceKeepSessionStateOnCookieThread));
+  Enqueue(base::BindOnce(&SetForceKeepSessionStateOnCookieThread));
 }
 
 net::CookieChangeDispatcher& XWalkCookieStoreWrapper::GetChangeDispatcher() {
@@ -185,25 +345,189 @@ net::CookieChangeDispatcher& XWalkCookieStoreWrapper::GetChangeDispatcher() {
 void XWalkCookieStoreWrapper::SetCookieableSchemes(const std::vector<std::string>& schemes,
                                                    SetCookieableSchemesCallback callback) {
   DCHECK(client_task_runner_->RunsTasksInCurrentSequence());
-  PostTaskToCookieStoreTaskRunner(
-      base::BindOnce(&SetCookieableSchemesOnCookieThread, schemes, CreateWrappedCallback<bool>(std::move(callback))));
+  EnqueueMutation(
+      base::BindOnce(&SetCookieableSchemesOnCookieThread, schemes, WrapForBatch(std::move(callback))));
 }
 
 void XWalkCookieStoreWrapper::TriggerCookieFetch() {
-  PostTaskToCookieStoreTaskRunner(base::Bind(&TriggerCookieFetchOnCookieThread));
+  Enqueue(base::BindOnce(&TriggerCookieFetchOnCookieThread));
 }
 
-base::OnceClosure XWalkCookieStoreWrapper::CreateWrappedClosureCallback(base::OnceClosure callback) {
+void XWalkCookieStoreWrapper::Enqueue(Operation operation) {
+  if (pending_operations_.empty()) {
+    client_task_runner_->PostTask(
+        FROM_HERE, base::BindOnce(&XWalkCookieStoreWrapper::SendBatch,
+                                  weak_factory_.GetWeakPtr()));
+  }
+  pending_operations_.push_back(std::move(operation));
+}
+
+void XWalkCookieStoreWrapper::EnqueueMutation(Operation operation) {
+  ++mutation_count_;
+  read_cache_.clear();
+  // Other wrappers on the same store must not serve a cached read issued
+  // after this one, whether or not the batch has been sent yet.
+  MarkCookieStoreChanged();
+  Enqueue(base::BindOnce(&RunMutationOnCookieThread, std::move(operation)));
+}
+
+template <class... Args>
+base::OnceCallback<void(Args...)> XWalkCookieStoreWrapper::WrapForBatch(
+    base::OnceCallback<void(Args...)> callback) {
   if (callback.is_null())
     return callback;
-  return base::BindOnce(base::IgnoreResult(&base::TaskRunner::PostTask), client_task_runner_, FROM_HERE,
-  base::BindOnce(&XWalkCookieStoreWrapper::RunClosureCallback,
-      weak_factory_.GetWeakPtr(), std::move(callback)));
+  if (!pending_batch_) {
+    pending_batch_ = base::MakeRefCounted<Batch>(
+        batches_sent_ + 1, client_task_runner_, weak_factory_.GetWeakPtr());
+  }
+  size_t slot = pending_batch_->AddSlot();
+  return base::BindOnce(&Batch::OnReply<Args...>, pending_batch_, slot,
+                        std::move(callback));
 }
 
-void XWalkCookieStoreWrapper::RunClosureCallback(base::OnceClosure callback) {
+void XWalkCookieStoreWrapper::SendBatch() {
   DCHECK(client_task_runner_->BelongsToCurrentThread());
-  std::move(callback).Run();
+  if (pending_operations_.empty())
+    return;
+  scoped_refptr<Batch> batch = std::move(pending_batch_);
+  if (!batch) {
+    // Nothing in this batch has a callback, the batch still reports back so
+    // that it is released on the client thread like the others.
+    batch = base::MakeRefCounted<Batch>(
+        batches_sent_ + 1, client_task_runner_, weak_factory_.GetWeakPtr());
+  }
+  ++batches_sent_;
+  GetCookieTaskRunner()->PostTask(
+      FROM_HERE,
+      base::BindOnce(&XWalkCookieStoreWrapper::RunBatchOnCookieThread,
+                     std::move(batch), base::WrapRefCounted(GetChangeCounter()),
+                     cookie_store_, std::move(pending_operations_)));
+  pending_operations_.clear();
+}
+
+// static
+void XWalkCookieStoreWrapper::RunBatchOnCookieThread(
+    scoped_refptr<Batch> batch,
+    scoped_refptr<StoreChangeCounter> change_counter,
+    net::CookieStore* cookie_store,
+    std::vector<Operation> operations) {
+  if (!cookie_store)
+    cookie_store = GetCookieStore();
+  change_counter->EnsureSubscribed(cookie_store);
+  batch->Run(cookie_store, std::move(operations));
+}
+
+// static
+void XWalkCookieStoreWrapper::GetCookieListOnCookieThread(
+    const GURL& url,
+    const net::CookieOptions& options,
+    CookieListWithGenerationCallback callback,
+    net::CookieStore* cookie_store) {
+  // Sampled before the read: a change landing while it runs makes the result
+  // look older than it is, never newer.
+  uint64_t generation = GetCookieStoreChangeCount();
+  cookie_store->GetCookieListWithOptionsAsync(
+      url, options,
+      callback.is_null() ? net::CookieStore::GetCookieListCallback()
+                         : base::BindOnce(std::move(callback), generation));
+}
+
+// static
+void XWalkCookieStoreWrapper::RunReplies(
+    base::WeakPtr<XWalkCookieStoreWrapper> weak_cookie_store,
+    uint64_t batch_id,
+    std::vector<base::OnceClosure> replies) {
+  for (base::OnceClosure& reply : replies) {
+    if (!weak_cookie_store)
+      return;
+    std::move(reply).Run();
+  }
+  if (weak_cookie_store && batch_id)
+    weak_cookie_store->OnBatchReplied(batch_id);
+}
+
+void XWalkCookieStoreWrapper::OnBatchReplied(uint64_t batch_id) {
+  // Operations may complete out of order across batches, e.g. reads of a key
+  // the store loads first.
+  early_replied_batches_.insert(batch_id);
+  while (early_replied_batches_.erase(batches_replied_ + 1))
+    ++batches_replied_;
+
+  std::vector<base::OnceClosure> ready;
+  while (!deferred_replies_.empty() &&
+         deferred_replies_.front().first <= batches_replied_) {
+    ready.push_back(std::move(deferred_replies_.front().second));
+    deferred_replies_.pop_front();
+  }
+  if (!ready.empty())
+    RunReplies(weak_factory_.GetWeakPtr(), 0, std::move(ready));
+}
+
+void XWalkCookieStoreWrapper::ReplyInOrder(base::OnceClosure reply) {
+  // The batch holding the operations issued before |reply|.
+  uint64_t last_batch =
+      pending_operations_.empty() ? batches_sent_ : batches_sent_ + 1;
+  if (last_batch > batches_replied_ || !deferred_replies_.empty()) {
+    deferred_replies_.emplace_back(last_batch, std::move(reply));
+    return;
+  }
+  std::vector<base::OnceClosure> replies;
+  replies.push_back(std::move(reply));
+  client_task_runner_->PostTask(
+      FROM_HERE, base::BindOnce(&XWalkCookieStoreWrapper::RunReplies,
+                                weak_factory_.GetWeakPtr(), 0,
+                                std::move(replies)));
+}
+
+void XWalkCookieStoreWrapper::OnCookieListReply(
+    const ReadCacheKey& key,
+    uint64_t mutation_count,
+    GetCookieListCallback callback,
+    uint64_t generation,
+    const net::CookieList& cookies,
+    const net::CookieStatusList& excluded_cookies) {
+  if (mutation_count == mutation_count_ && change_counter_->tracking()) {
+    if (read_cache_.size() >= kMaxReadCacheEntries)
+      read_cache_.clear();
+    ReadCacheEntry& entry = read_cache_[key];
+    entry.generation = generation;
+    entry.mutation_count = mutation_count;
+    entry.expires = base::Time::Max();
+    for (const net::CanonicalCookie& cookie : cookies) {
+      if (cookie.IsPersistent())
+        entry.expires = std::min(entry.expires, cookie.ExpiryDate());
+    }
+    entry.cookies = cookies;
+    entry.excluded_cookies = excluded_cookies;
+  }
+  std::move(callback).Run(cookies, excluded_cookies);
+}
+
+const XWalkCookieStoreWrapper::ReadCacheEntry*
+XWalkCookieStoreWrapper::FindCachedCookieList(const ReadCacheKey& key) {
+  auto it = read_cache_.find(key);
+  if (it == read_cache_.end())
+    return nullptr;
+  const ReadCacheEntry& entry = it->second;
+  if (entry.mutation_count != mutation_count_ ||
+      entry.generation != GetCookieStoreChangeCount() ||
+      entry.expires <= base::Time::Now()) {
+    read_cache_.erase(it);
+    return nullptr;
+  }
+  return &entry;
+}
+
+scoped_refptr<base::SingleThreadTaskRunner>
+XWalkCookieStoreWrapper::GetCookieTaskRunner() {
+  return cookie_task_runner_ ? cookie_task_runner_ : GetCookieStoreTaskRunner();
+}
+
+XWalkCookieStoreWrapper::StoreChangeCounter*
+XWalkCookieStoreWrapper::GetChangeCounter() {
+  if (!change_counter_)
+    change_counter_ = base::MakeRefCounted<StoreChangeCounter>(GetCookieTaskRunner());
+  return change_counter_.get();
 }
 
 }  // namespace xwalk
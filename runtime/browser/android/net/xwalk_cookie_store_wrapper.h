@@ -5,7 +5,13 @@
 #ifndef XWALK_RUNTIME_BROWSER_ANDROID_NET_XWALK_COOKIE_STORE_WRAPPER_H_
 #define XWALK_RUNTIME_BROWSER_ANDROID_NET_XWALK_COOKIE_STORE_WRAPPER_H_
 
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/location.h"
@@ -29,6 +35,19 @@ namespace xwalk {
 // This is needed to allow Webview to run the CookieStore on its own thread, to
 // enable synchronous calls into the store on the IO Thread from Java.
 //
+// Operations issued during one task on the client thread are queued and sent
+// to the CookieStore's thread as a single batch at the end of that task. The
+// batch's callbacks come back in one task as well, in the order the
+// operations were issued, so a page setting dozens of cookies costs three
+// thread hops instead of two per cookie.
+//
+// GetCookieListWithOptionsAsync() results are cached on the client thread.
+// The cache is dropped by any mutation issued through the wrapper. Entries
+// are also tagged with GetCookieStoreChangeCount(), which every writer of the
+// store (other wrappers, the Java CookieManager) bumps synchronously, and
+// which the store's own change notifications bump for anything else. A hit
+// is answered in order: after the replies of operations issued before it.
+//
 // XWalkCookieStoreWrapper will only grab the CookieStore pointer from the
 // CookieManager when it's needed, allowing for lazy creation of the
 // CookieStore.
@@ -40,6 +59,12 @@ namespace xwalk {
 class XWalkCookieStoreWrapper : public net::CookieStore {
  public:
   XWalkCookieStoreWrapper();
+  // Uses |cookie_store| on |cookie_task_runner| instead of the CookieManager's
+  // store. |cookie_store| must outlive the wrapper. For tests.
+  XWalkCookieStoreWrapper(
+      scoped_refptr<base::SingleThreadTaskRunner> client_task_runner,
+      scoped_refptr<base::SingleThreadTaskRunner> cookie_task_runner,
+      net::CookieStore* cookie_store);
   ~XWalkCookieStoreWrapper() override;
   // CookieStore implementation:
   void SetCookieWithOptionsAsync(const GURL& url,
@@ -75,66 +100,124 @@ class XWalkCookieStoreWrapper : public net::CookieStore {
   void TriggerCookieFetch() override;
 
  private:
-  // Used by CreateWrappedCallback below. Takes an arugment of Type and posts
-  // a task to |task_runner| to invoke |callback| with that argument. If
-  // |weak_cookie_store| is deleted before the task is run, the task will not
-  // be run.
-  template<class Type>
-  static void RunCallbackOnClientThread(base::TaskRunner* task_runner,
-                                        base::WeakPtr<XWalkCookieStoreWrapper> weak_cookie_store,
-                                        base::OnceCallback<void(Type)> callback, Type argument) {
-    task_runner->PostTask(
-    FROM_HERE,
-    base::BindOnce(&XWalkCookieStoreWrapper::RunClosureCallback,
-        weak_cookie_store, base::BindOnce(std::move(callback), argument)));
-  }
-
-  // Returns a base::Callback that takes an argument of Type and posts a task to
-  // the |client_task_runner_| to invoke |callback| with that argument.
-  template <class Type>
-  base::OnceCallback<void(Type)> CreateWrappedCallback( base::OnceCallback<void(Type)> callback) {
-    if (callback.is_null())
-    return callback;
-    return base::BindOnce(&XWalkCookieStoreWrapper::RunCallbackOnClientThread<Type>,
-    base::RetainedRef(client_task_runner_),
-    weak_factory_.GetWeakPtr(), std::move(callback));
-  }
-
-  // These are the same as above, but specifically for GetCookieListCallback,
-  // which has two arguments
-  static void RunGetCookieListCallbackOnClientThread(
-  base::TaskRunner* task_runner,
-  base::WeakPtr<XWalkCookieStoreWrapper> weak_cookie_store,
-  net::CookieStore::GetCookieListCallback callback,
-  const net::CookieList& cookies,
-  const net::CookieStatusList& excluded_cookies) {
-    task_runner->PostTask(
-    FROM_HERE,
-    base::BindOnce(
-        &XWalkCookieStoreWrapper::RunClosureCallback, weak_cookie_store,
-        base::BindOnce(std::move(callback), cookies, excluded_cookies)));
-  }
-  net::CookieStore::GetCookieListCallback CreateWrappedGetCookieListCallback(
-  net::CookieStore::GetCookieListCallback callback) {
-    if (callback.is_null())
-    return callback;
-    return base::BindOnce(
-    &XWalkCookieStoreWrapper::RunGetCookieListCallbackOnClientThread,
-    base::RetainedRef(client_task_runner_), weak_factory_.GetWeakPtr(),
-    std::move(callback));
-  }
-
-  // Returns a base::OnceClosure that posts a task to the |client_task_runner_|
-  // to invoke |callback|.
-  base::OnceClosure CreateWrappedClosureCallback(base::OnceClosure callback);
-
-  // Runs |callback|. Used to prevent callbacks from being invoked after the
-  // XWalkCookieStoreWrapper has been destroyed.
-  void RunClosureCallback(base::OnceClosure callback);
+  // Collects the replies of one batch on the cookie thread and posts them
+  // back to the client thread in a single task.
+  class Batch;
+  // Bumps GetCookieStoreChangeCount() for changes to the underlying
+  // CookieStore that no writer announced.
+  class StoreChangeCounter;
+
+  using Operation = base::OnceCallback<void(net::CookieStore*)>;
+  using CookieListWithGenerationCallback =
+      base::OnceCallback<void(uint64_t generation,
+                              const net::CookieList& cookies,
+                              const net::CookieStatusList& excluded_cookies)>;
+
+  struct ReadCacheKey {
+    bool operator<(const ReadCacheKey& other) const;
+
+    std::string url;
+    bool exclude_httponly;
+    int same_site_cookie_context;
+    bool return_excluded_cookies;
+  };
+
+  struct ReadCacheEntry {
+    ReadCacheEntry();
+    ReadCacheEntry(const ReadCacheEntry& other);
+    ~ReadCacheEntry();
+
+    // Values of GetCookieStoreChangeCount() and |mutation_count_| before the
+    // read.
+    uint64_t generation;
+    uint64_t mutation_count;
+    // Earliest expiry among |cookies|, the entry is stale past it.
+    base::Time expires;
+    net::CookieList cookies;
+    net::CookieStatusList excluded_cookies;
+  };
+
+  // Queues |operation| for the current batch, scheduling the batch to be
+  // sent at the end of the current task.
+  void Enqueue(Operation operation);
+
+  // Queues a mutation, which also drops the read cache.
+  void EnqueueMutation(Operation operation);
+
+  // Returns a callback that records its arguments as the next reply of the
+  // current batch. Null callbacks stay null, they take no reply slot.
+  template <class... Args>
+  base::OnceCallback<void(Args...)> WrapForBatch(
+      base::OnceCallback<void(Args...)> callback);
+
+  // Sends the queued operations to the cookie thread in one task.
+  void SendBatch();
+
+  static void RunBatchOnCookieThread(
+      scoped_refptr<Batch> batch,
+      scoped_refptr<StoreChangeCounter> change_counter,
+      net::CookieStore* cookie_store,
+      std::vector<Operation> operations);
+
+  static void GetCookieListOnCookieThread(
+      const GURL& url,
+      const net::CookieOptions& options,
+      CookieListWithGenerationCallback callback,
+      net::CookieStore* cookie_store);
+
+  // Runs |replies| in order, stopping if one of them deletes the wrapper.
+  // |batch_id| is the batch they belong to, 0 for cached replies.
+  static void RunReplies(base::WeakPtr<XWalkCookieStoreWrapper> weak_cookie_store,
+                         uint64_t batch_id,
+                         std::vector<base::OnceClosure> replies);
+
+  // Records that the replies of batch |batch_id| ran, and runs the cached
+  // replies that were waiting for it.
+  void OnBatchReplied(uint64_t batch_id);
+
+  // Runs |reply| once the replies of all operations issued so far have run.
+  void ReplyInOrder(base::OnceClosure reply);
+
+  void OnCookieListReply(const ReadCacheKey& key,
+                         uint64_t mutation_count,
+                         GetCookieListCallback callback,
+                         uint64_t generation,
+                         const net::CookieList& cookies,
+                         const net::CookieStatusList& excluded_cookies);
+
+  // Returns the cached result for |key| if it is still current.
+  const ReadCacheEntry* FindCachedCookieList(const ReadCacheKey& key);
+
+  scoped_refptr<base::SingleThreadTaskRunner> GetCookieTaskRunner();
+  StoreChangeCounter* GetChangeCounter();
 
   scoped_refptr<base::SingleThreadTaskRunner> client_task_runner_;
+  // Null when the CookieManager's store is used, it is resolved lazily.
+  scoped_refptr<base::SingleThreadTaskRunner> cookie_task_runner_;
+  net::CookieStore* cookie_store_;
+
+  std::vector<Operation> pending_operations_;
+  scoped_refptr<Batch> pending_batch_;
+
+  // Batches are numbered from 1 in the order they are sent.
+  uint64_t batches_sent_;
+  // All batches up to this one have replied.
+  uint64_t batches_replied_;
+  // Batches past |batches_replied_| that replied early.
+  std::set<uint64_t> early_replied_batches_;
+  // Cached replies, each after the batch it waits for.
+  std::deque<std::pair<uint64_t, base::OnceClosure>> deferred_replies_;
+
+  // Created with the first operation, it needs the cookie thread.
+  scoped_refptr<StoreChangeCounter> change_counter_;
+  // Mutations issued through this wrapper.
+  uint64_t mutation_count_;
+  std::map<ReadCacheKey, ReadCacheEntry> read_cache_;
+
   XWalkCookieChangeDispatcherWrapper _change_dispatcher;
   base::WeakPtrFactory<XWalkCookieStoreWrapper> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkCookieStoreWrapper);
 };
 
 }  // namespace xwalk
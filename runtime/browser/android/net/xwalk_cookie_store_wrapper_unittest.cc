@@ -0,0 +1,418 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/android/net/xwalk_cookie_store_wrapper.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/test/scoped_task_environment.h"
+#include "base/threading/thread.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "base/time/time.h"
+#include "net/cookies/cookie_monster.h"
+#include "net/cookies/cookie_options.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+#include "xwalk/runtime/browser/android/net/init_native_callback.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+
+namespace xwalk {
+
+namespace {
+
+const int kMixedOperations = 1000;
+
+// Forwards to |target| and counts the tasks posted through it.
+class CountingTaskRunner : public base::SingleThreadTaskRunner {
+ public:
+  explicit CountingTaskRunner(scoped_refptr<base::SingleThreadTaskRunner> target)
+      : target_(std::move(target)) {}
+
+  bool PostDelayedTask(const base::Location& from_here,
+                       base::OnceClosure task,
+                       base::TimeDelta delay) override {
+    ++count_;
+    return target_->PostDelayedTask(from_here, std::move(task), delay);
+  }
+
+  bool PostNonNestableDelayedTask(const base::Location& from_here,
+                                  base::OnceClosure task,
+                                  base::TimeDelta delay) override {
+    ++count_;
+    return target_->PostNonNestableDelayedTask(from_here, std::move(task),
+                                               delay);
+  }
+
+  bool RunsTasksInCurrentSequence() const override {
+    return target_->RunsTasksInCurrentSequence();
+  }
+
+  int count() const { return count_; }
+  void reset() { count_ = 0; }
+
+ private:
+  ~CountingTaskRunner() override {}
+
+  scoped_refptr<base::SingleThreadTaskRunner> target_;
+  std::atomic<int> count_{0};
+
+  DISALLOW_COPY_AND_ASSIGN(CountingTaskRunner);
+};
+
+GURL UrlForIndex(int i) {
+  return GURL(base::StringPrintf("https://host%d.example.com/", i % 16));
+}
+
+class XWalkCookieStoreWrapperTest : public testing::Test {
+ protected:
+  XWalkCookieStoreWrapperTest() : cookie_thread_("CookieThread") {}
+
+  void SetUp() override {
+    ASSERT_TRUE(cookie_thread_.Start());
+    client_runner_ = base::MakeRefCounted<CountingTaskRunner>(
+        base::ThreadTaskRunnerHandle::Get());
+    cookie_runner_ = base::MakeRefCounted<CountingTaskRunner>(
+        cookie_thread_.task_runner());
+    RunOnCookieThread(base::BindOnce(
+        [](std::unique_ptr<net::CookieMonster>* monster) {
+          monster->reset(new net::CookieMonster(nullptr, nullptr));
+        },
+        &cookie_monster_));
+    wrapper_.reset(new XWalkCookieStoreWrapper(client_runner_, cookie_runner_,
+                                               cookie_monster_.get()));
+  }
+
+  void TearDown() override {
+    // The wrapper's change subscription is released with a task posted to
+    // the cookie thread, which runs before the monster goes away below.
+    wrapper_.reset();
+    base::RunLoop().RunUntilIdle();
+    RunOnCookieThread(base::BindOnce(
+        [](std::unique_ptr<net::CookieMonster>* monster) { monster->reset(); },
+        &cookie_monster_));
+    cookie_thread_.Stop();
+  }
+
+  void RunOnCookieThread(base::OnceClosure task) {
+    base::WaitableEvent done;
+    cookie_thread_.task_runner()->PostTask(
+        FROM_HERE, base::BindOnce(
+                       [](base::OnceClosure task, base::WaitableEvent* done) {
+                         std::move(task).Run();
+                         done->Signal();
+                       },
+                       std::move(task), &done));
+    done.Wait();
+  }
+
+  // Issues |count| mixed operations (60% sets, 30% reads, 10% deletes) in one
+  // task through |store| and waits for all callbacks. Returns the order in
+  // which the callbacks ran.
+  std::vector<int> RunMixedOperations(net::CookieStore* store, int count) {
+    std::vector<int> order;
+    base::RunLoop run_loop;
+    int remaining = count;
+    auto done = [](std::vector<int>* order, int* remaining,
+                   base::RepeatingClosure quit, int index) {
+      order->push_back(index);
+      if (--*remaining == 0)
+        quit.Run();
+    };
+    base::RepeatingClosure quit = run_loop.QuitClosure();
+    net::CookieOptions options;
+    for (int i = 0; i < count; ++i) {
+      base::OnceClosure finish =
+          base::BindOnce(done, &order, &remaining, quit, i);
+      switch (i % 10) {
+        case 0:
+        case 1:
+        case 2: {
+          store->GetCookieListWithOptionsAsync(
+              UrlForIndex(i), options,
+              base::BindOnce(
+                  [](base::OnceClosure finish, const net::CookieList&,
+                     const net::CookieStatusList&) {
+                    std::move(finish).Run();
+                  },
+                  std::move(finish)));
+          break;
+        }
+        case 3: {
+          net::CookieDeletionInfo info;
+          info.name = base::StringPrintf("c%d", i % 32);
+          store->DeleteAllMatchingInfoAsync(
+              std::move(info),
+              base::BindOnce([](base::OnceClosure finish,
+                                uint32_t) { std::move(finish).Run(); },
+                             std::move(finish)));
+          break;
+        }
+        default:
+          store->SetCookieWithOptionsAsync(
+              UrlForIndex(i), base::StringPrintf("c%d=%d", i % 32, i), options,
+              base::BindOnce(
+                  [](base::OnceClosure finish,
+                     net::CanonicalCookie::CookieInclusionStatus) {
+                    std::move(finish).Run();
+                  },
+                  std::move(finish)));
+      }
+    }
+    run_loop.Run();
+    return order;
+  }
+
+  base::test::ScopedTaskEnvironment task_environment_;
+  base::Thread cookie_thread_;
+  scoped_refptr<CountingTaskRunner> client_runner_;
+  scoped_refptr<CountingTaskRunner> cookie_runner_;
+  std::unique_ptr<net::CookieMonster> cookie_monster_;
+  std::unique_ptr<XWalkCookieStoreWrapper> wrapper_;
+};
+
+// Stands in for the previous wrapper, which posted every operation to the
+// cookie thread on its own and bounced each callback back separately.
+class UnbatchedCookieStore {
+ public:
+  UnbatchedCookieStore(scoped_refptr<base::SingleThreadTaskRunner> client,
+                       scoped_refptr<base::SingleThreadTaskRunner> cookie,
+                       net::CookieStore* store)
+      : client_(client), cookie_(cookie), store_(store) {}
+
+  template <class... Args>
+  base::OnceCallback<void(Args...)> Wrap(
+      base::OnceCallback<void(Args...)> callback) {
+    return base::BindOnce(
+        [](scoped_refptr<base::SingleThreadTaskRunner> client,
+           base::OnceCallback<void(Args...)> callback, Args... args) {
+          client->PostTask(FROM_HERE,
+                           base::BindOnce(std::move(callback), args...));
+        },
+        client_, std::move(callback));
+  }
+
+  scoped_refptr<base::SingleThreadTaskRunner> client_;
+  scoped_refptr<base::SingleThreadTaskRunner> cookie_;
+  net::CookieStore* store_;
+};
+
+}  // namespace
+
+TEST_F(XWalkCookieStoreWrapperTest, CallbacksRunInOrder) {
+  std::vector<int> order =
+      RunMixedOperations(wrapper_.get(), kMixedOperations);
+  ASSERT_EQ(static_cast<size_t>(kMixedOperations), order.size());
+  for (int i = 0; i < kMixedOperations; ++i)
+    EXPECT_EQ(i, order[i]);
+}
+
+TEST_F(XWalkCookieStoreWrapperTest, ReadCacheInvalidatedByMutations) {
+  GURL url("https://cache.example.com/");
+  net::CookieOptions options;
+  auto get = [&](net::CookieList* out) {
+    base::RunLoop run_loop;
+    wrapper_->GetCookieListWithOptionsAsync(
+        url, options,
+        base::BindOnce(
+            [](net::CookieList* out, base::OnceClosure quit,
+               const net::CookieList& cookies, const net::CookieStatusList&) {
+              *out = cookies;
+              std::move(quit).Run();
+            },
+            out, run_loop.QuitClosure()));
+    run_loop.Run();
+  };
+
+  base::RunLoop set_loop;
+  wrapper_->SetCookieWithOptionsAsync(
+      url, "a=1", options,
+      base::BindOnce([](base::OnceClosure quit,
+                        net::CanonicalCookie::CookieInclusionStatus) {
+        std::move(quit).Run();
+      }, set_loop.QuitClosure()));
+  set_loop.Run();
+
+  net::CookieList cookies;
+  get(&cookies);
+  ASSERT_EQ(1u, cookies.size());
+
+  // Served from the cache without touching the cookie thread.
+  base::RunLoop().RunUntilIdle();
+  cookie_runner_->reset();
+  get(&cookies);
+  EXPECT_EQ(0, cookie_runner_->count());
+  ASSERT_EQ(1u, cookies.size());
+  EXPECT_EQ("1", cookies[0].Value());
+
+  // A write through the wrapper drops the cache.
+  base::RunLoop update_loop;
+  wrapper_->SetCookieWithOptionsAsync(
+      url, "a=2", options,
+      base::BindOnce([](base::OnceClosure quit,
+                        net::CanonicalCookie::CookieInclusionStatus) {
+        std::move(quit).Run();
+      }, update_loop.QuitClosure()));
+  update_loop.Run();
+  get(&cookies);
+  ASSERT_EQ(1u, cookies.size());
+  EXPECT_EQ("2", cookies[0].Value());
+
+  // So does a write made directly on the store, announced the way
+  // CookieManager announces its writes.
+  RunOnCookieThread(base::BindOnce(
+      [](net::CookieMonster* monster, const GURL& url) {
+        MarkCookieStoreChanged();
+        monster->SetCookieWithOptionsAsync(url, "a=3", net::CookieOptions(),
+                                           base::DoNothing());
+      },
+      cookie_monster_.get(), url));
+  get(&cookies);
+  ASSERT_EQ(1u, cookies.size());
+  EXPECT_EQ("3", cookies[0].Value());
+}
+
+TEST_F(XWalkCookieStoreWrapperTest, CachedReadsReplyInOrder) {
+  GURL cached_url("https://cached.example.com/");
+  GURL other_url("https://other.example.com/");
+  net::CookieOptions options;
+  std::vector<int> order;
+  base::RunLoop warm_loop;
+  wrapper_->GetCookieListWithOptionsAsync(
+      cached_url, options,
+      base::BindOnce([](base::OnceClosure quit, const net::CookieList&,
+                        const net::CookieStatusList&) { std::move(quit).Run(); },
+                     warm_loop.QuitClosure()));
+  warm_loop.Run();
+
+  // The second read is a hit, and must not overtake the first.
+  base::RunLoop run_loop;
+  auto record = [](std::vector<int>* order, int index,
+                   base::OnceClosure done, const net::CookieList&,
+                   const net::CookieStatusList&) {
+    order->push_back(index);
+    if (done)
+      std::move(done).Run();
+  };
+  cookie_runner_->reset();
+  wrapper_->GetCookieListWithOptionsAsync(
+      other_url, options,
+      base::BindOnce(record, &order, 0, base::OnceClosure()));
+  wrapper_->GetCookieListWithOptionsAsync(
+      cached_url, options,
+      base::BindOnce(record, &order, 1, run_loop.QuitClosure()));
+  run_loop.Run();
+  EXPECT_EQ(1, cookie_runner_->count());
+  EXPECT_EQ((std::vector<int>{0, 1}), order);
+}
+
+// Compares the thread hops and wall time of 1k mixed operations with the
+// previous one-task-per-operation scheme.
+TEST_F(XWalkCookieStoreWrapperTest, BatchedVersusUnbatched) {
+  client_runner_->reset();
+  cookie_runner_->reset();
+  base::TimeTicks start = base::TimeTicks::Now();
+  RunMixedOperations(wrapper_.get(), kMixedOperations);
+  base::TimeDelta batched_time = base::TimeTicks::Now() - start;
+  int batched_tasks = client_runner_->count() + cookie_runner_->count();
+
+  // Unbatched baseline against a fresh store.
+  std::unique_ptr<net::CookieMonster> baseline_monster;
+  RunOnCookieThread(base::BindOnce(
+      [](std::unique_ptr<net::CookieMonster>* monster) {
+        monster->reset(new net::CookieMonster(nullptr, nullptr));
+      },
+      &baseline_monster));
+  UnbatchedCookieStore unbatched(client_runner_, cookie_runner_,
+                                 baseline_monster.get());
+
+  client_runner_->reset();
+  cookie_runner_->reset();
+  start = base::TimeTicks::Now();
+  {
+    base::RunLoop run_loop;
+    int remaining = kMixedOperations;
+    base::RepeatingClosure quit = run_loop.QuitClosure();
+    base::RepeatingClosure done = base::BindRepeating(
+        [](int* remaining, base::RepeatingClosure quit) {
+          if (--*remaining == 0)
+            quit.Run();
+        },
+        &remaining, quit);
+    net::CookieOptions options;
+    for (int i = 0; i < kMixedOperations; ++i) {
+      base::OnceClosure task;
+      switch (i % 10) {
+        case 0:
+        case 1:
+        case 2:
+          task = base::BindOnce(
+              &net::CookieStore::GetCookieListWithOptionsAsync,
+              base::Unretained(unbatched.store_), UrlForIndex(i), options,
+              unbatched.Wrap(net::CookieStore::GetCookieListCallback(
+                  base::BindOnce([](base::RepeatingClosure done,
+                                    const net::CookieList&,
+                                    const net::CookieStatusList&) {
+                    done.Run();
+                  }, done))));
+          break;
+        case 3: {
+          net::CookieDeletionInfo info;
+          info.name = base::StringPrintf("c%d", i % 32);
+          task = base::BindOnce(
+              &net::CookieStore::DeleteAllMatchingInfoAsync,
+              base::Unretained(unbatched.store_), std::move(info),
+              unbatched.Wrap(net::CookieStore::DeleteCallback(base::BindOnce(
+                  [](base::RepeatingClosure done, uint32_t) { done.Run(); },
+                  done))));
+          break;
+        }
+        default:
+          task = base::BindOnce(
+              &net::CookieStore::SetCookieWithOptionsAsync,
+              base::Unretained(unbatched.store_), UrlForIndex(i),
+              base::StringPrintf("c%d=%d", i % 32, i), options,
+              unbatched.Wrap(net::CookieStore::SetCookiesCallback(
+                  base::BindOnce(
+                      [](base::RepeatingClosure done,
+                         net::CanonicalCookie::CookieInclusionStatus) {
+                        done.Run();
+                      },
+                      done))));
+      }
+      unbatched.cookie_->PostTask(FROM_HERE, std::move(task));
+    }
+    run_loop.Run();
+  }
+  base::TimeDelta unbatched_time = base::TimeTicks::Now() - start;
+  int unbatched_tasks = client_runner_->count() + cookie_runner_->count();
+
+  RunOnCookieThread(base::BindOnce(
+      [](std::unique_ptr<net::CookieMonster>* monster) { monster->reset(); },
+      &baseline_monster));
+
+  EXPECT_EQ(2 * kMixedOperations, unbatched_tasks);
+  EXPECT_LT(batched_tasks, unbatched_tasks / 100);
+
+  XWalkBenchmark::ReportValue("cookie_store_wrapper_batched_tasks",
+                              "_1k_mixed", "tasks", batched_tasks);
+  XWalkBenchmark::ReportValue("cookie_store_wrapper_unbatched_tasks",
+                              "_1k_mixed", "tasks", unbatched_tasks);
+  // The operations overlap, only the time per operation over the whole run
+  // is meaningful.
+  XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+      "cookie_store_wrapper_batched", "_1k_mixed",
+      {batched_time.InMicrosecondsF() / kMixedOperations}));
+  XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+      "cookie_store_wrapper_unbatched", "_1k_mixed",
+      {unbatched_time.InMicrosecondsF() / kMixedOperations}));
+}
+
+}  // namespace xwalk
@@ -17,6 +17,8 @@
 #include "xwalk/runtime/browser/android/xwalk_contents_client_bridge.h"
 #include "xwalk/runtime/browser/xwalk_browser_context.h"
 #include "xwalk/runtime/common/android/xwalk_render_view_messages.h"
+#include "xwalk/runtime/common/android/xwalk_view_ipc_names.h"
+#include "xwalk/runtime/common/xwalk_ipc_accounting.h"
 
 #include "meta_logging.h"
 
@@ -27,6 +29,7 @@ XWalkRenderViewHostExt::XWalkRenderViewHostExt(content::WebContents* contents)
       has_new_hit_test_data_(false),
       is_render_view_created_(false),
       background_color_(SK_ColorWHITE){
+  RegisterXWalkViewIPCNames();
 }
 
 XWalkRenderViewHostExt::~XWalkRenderViewHostExt() {}
@@ -151,6 +154,9 @@ void XWalkRenderViewHostExt::OnPageScaleFactorChanged(float page_scale_factor) {
 
 bool XWalkRenderViewHostExt::OnMessageReceived(
     const IPC::Message& message, content::RenderFrameHost* render_frame_host) {
+  if (IPC_MESSAGE_CLASS(message) == AndroidWebViewMsgStart)
+    XWalkIPCAccounting::GetInstance()->DidDispatch(message);
+
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP_WITH_PARAM(XWalkRenderViewHostExt, message, render_frame_host)
     IPC_MESSAGE_HANDLER(XWalkViewHostMsg_DocumentHasImagesResponse,
@@ -177,6 +183,7 @@ void XWalkRenderViewHostExt::OnDocumentHasImagesResponse(
 }
 
 void XWalkRenderViewHostExt::OnUpdateHitTestData(content::RenderFrameHost* render_frame_host,
+                                                 uint32_t sequence_number,
                                                  const XWalkHitTestData& hit_test_data) {
   content::RenderFrameHost* main_frame_host = render_frame_host;
   while (main_frame_host->GetParent())
@@ -192,6 +199,11 @@ void XWalkRenderViewHostExt::OnUpdateHitTestData(content::RenderFrameHost* rende
 
   last_hit_test_data_ = hit_test_data;
   has_new_hit_test_data_ = true;
+
+  // The renderer skips sending data equal to what we hold, so it must only
+  // count on data we kept.
+  render_frame_host->Send(new XWalkViewMsg_HitTestDataAccepted(
+      render_frame_host->GetRoutingID(), sequence_number));
 }
 
 void XWalkRenderViewHostExt::SetOriginAccessWhitelist(
@@ -15,7 +15,7 @@
 #include "third_party/skia/include/core/SkColor.h"
 #include "ui/gfx/geometry/point_f.h"
 #include "ui/gfx/geometry/size_f.h"
-#include "xwalk/runtime/common/android/xwalk_hit_test_data.h"
+#include "xwalk/runtime/common/xwalk_hit_test_data.h"
 
 class GURL;
 
@@ -92,7 +92,9 @@ class XWalkRenderViewHostExt : public content::WebContentsObserver
                          content::RenderFrameHost* render_frame_host) override;
 
   void OnDocumentHasImagesResponse(content::RenderFrameHost* render_frame_host, int msg_id, bool has_images);
-  void OnUpdateHitTestData(content::RenderFrameHost* render_frame_host, const XWalkHitTestData& hit_test_data);
+  void OnUpdateHitTestData(content::RenderFrameHost* render_frame_host,
+                           uint32_t sequence_number,
+                           const XWalkHitTestData& hit_test_data);
   void OnPictureUpdated();
 
   bool IsRenderViewReady() const;
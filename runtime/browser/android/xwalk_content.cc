@@ -8,6 +8,7 @@
 #include <memory>
 #include <algorithm>
 #include <cctype>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -28,7 +29,6 @@
 #include "content/public/browser/browser_context.h"
 #include "content/public/browser/browser_task_traits.h"
 #include "content/public/browser/browser_thread.h"
-#include "content/public/browser/browsing_data_remover.h"
 #include "content/public/browser/devtools_agent_host.h"
 #include "content/public/browser/navigation_entry.h"
 #include "content/public/browser/render_frame_host.h"
@@ -38,15 +38,17 @@
 #include "content/public/browser/ssl_status.h"
 #include "content/public/browser/web_contents.h"
 #include "content/public/common/url_constants.h"
+#include "mojo/public/cpp/base/big_buffer.h"
 #include "net/cert/x509_certificate.h"
 #include "net/cert/x509_util.h"
 #include "ui/gfx/android/java_bitmap.h"
 #include "ui/gfx/geometry/rect_f.h"
+#include "url/gurl.h"
+#include "url/origin.h"
 #include "xwalk/application/common/application_manifest_constants.h"
 #include "xwalk/application/common/manifest.h"
 #include "xwalk/runtime/android/core_refactor/xwalk_refactor_native_jni/XWalkContent_jni.h"
 #include "xwalk/runtime/browser/android/js_java_interaction/js_java_configurator_host.h"
-#include "xwalk/runtime/browser/android/net_disk_cache_remover.h"
 #include "xwalk/runtime/browser/android/state_serializer.h"
 #include "xwalk/runtime/browser/android/xwalk_autofill_client_android.h"
 #include "xwalk/runtime/browser/android/xwalk_content_lifecycle_notifier.h"
@@ -56,6 +58,7 @@
 #include "xwalk/runtime/browser/runtime_resource_dispatcher_host_delegate_android.h"
 #include "xwalk/runtime/browser/xwalk_autofill_manager.h"
 #include "xwalk/runtime/browser/xwalk_browser_context.h"
+#include "xwalk/runtime/browser/xwalk_browsing_data_remover.h"
 #include "xwalk/runtime/browser/xwalk_runner.h"
 
 #ifdef TENTA_CHROMIUM_BUILD
@@ -278,8 +281,7 @@ XWalkContent::XWalkContent(std::unique_ptr<content::WebContents> web_contents)
     : web_contents_(std::move(web_contents)),
       _zone_id(0),
       _tab_id(0) {
-  LOG(ERROR) << "iotto " << __func__ << " FIX AUTOFILL!"; 
- xwalk_autofill_manager_.reset(new XWalkAutofillManager(web_contents_.get()));
+  xwalk_autofill_manager_.reset(new XWalkAutofillManager(web_contents_.get()));
   XWalkContentLifecycleNotifier::OnXWalkViewCreated();
 }
 
@@ -294,14 +296,13 @@ void XWalkContent::SetXWalkAutofillClient(const base::android::JavaRef<jobject>&
 
 void XWalkContent::SetSaveFormData(bool enabled) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
-  LOG(ERROR) << "iotto " << __func__ << " FIX AUTOFILL!";
-//  xwalk_autofill_manager_->InitAutofillIfNecessary(enabled);
-//  // We need to check for the existence, since autofill_manager_delegate
-//  // may not be created when the setting is false.
-//  XWalkAutofillClientAndroid *client = XWalkAutofillClientAndroid::FromWebContents(
-//      web_contents_.get());
-//  if (client != nullptr )
-//    client->SetSaveFormData(enabled);
+  xwalk_autofill_manager_->InitAutofillIfNecessary(enabled);
+  // We need to check for the existence, since autofill_manager_delegate
+  // may not be created when the setting is false.
+  XWalkAutofillClientAndroid* client =
+      XWalkAutofillClientAndroid::FromWebContents(web_contents_.get());
+  if (client)
+    client->SetSaveFormData(enabled);
 }
 
 XWalkContent::~XWalkContent() {
@@ -399,28 +400,29 @@ void XWalkContent::ClearCache(JNIEnv* env, jobject obj, jboolean include_disk_fi
   render_view_host_ext_->ClearCache();
 
   if (include_disk_files) {
-    content::BrowsingDataRemover* remover = content::BrowserContext::GetBrowsingDataRemover(
-        web_contents_->GetBrowserContext());
-    remover->Remove(
-        base::Time(),
-        base::Time::Max(),
-        content::BrowsingDataRemover::DATA_TYPE_CACHE,
-        content::BrowsingDataRemover::ORIGIN_TYPE_UNPROTECTED_WEB | content::BrowsingDataRemover::ORIGIN_TYPE_PROTECTED_WEB);
+    XWalkBrowserContext::FromWebContents(web_contents_.get())
+        ->GetXWalkBrowsingDataRemover()
+        ->Remove(base::Time(), base::Time::Max(),
+                 XWalkBrowsingDataRemover::DATA_TYPE_HTTP_CACHE |
+                     XWalkBrowsingDataRemover::DATA_TYPE_CODE_CACHE,
+                 std::set<url::Origin>(), base::DoNothing());
   }
-
-//  if (include_disk_files)
-//    RemoveHttpDiskCache(web_contents_->GetRenderProcessHost(), std::string());
 }
 
 void XWalkContent::ClearCacheForSingleFile(JNIEnv* env, jobject obj,
                                            jstring url) {
-  // TODO(iotto) : Use BrowsingDateRemover with FilterBuilder as in ClearCache
-//
-//  DCHECK(content::BrowserThread::CurrentlyOn(content::BrowserThread::UI));
-//  std::string key = base::android::ConvertJavaStringToUTF8(env, url);
-//
-//  if (!key.empty())
-//    RemoveHttpDiskCache(web_contents_->GetRenderProcessHost(), key);
+  DCHECK(content::BrowserThread::CurrentlyOn(content::BrowserThread::UI));
+  GURL gurl(base::android::ConvertJavaStringToUTF8(env, url));
+  if (!gurl.is_valid())
+    return;
+
+  // The HTTP cache can only be filtered by origin, the other entries of the
+  // file's origin go as well.
+  XWalkBrowserContext::FromWebContents(web_contents_.get())
+      ->GetXWalkBrowsingDataRemover()
+      ->Remove(base::Time(), base::Time::Max(),
+               XWalkBrowsingDataRemover::DATA_TYPE_HTTP_CACHE,
+               {url::Origin::Create(gurl)}, base::DoNothing());
 }
 
 ScopedJavaLocalRef<jstring> XWalkContent::DevToolsAgentId(JNIEnv* env, jobject obj) {
@@ -480,6 +482,15 @@ void XWalkContent::SetJsOnlineProperty(JNIEnv* env, jobject obj, jboolean networ
   render_view_host_ext_->SetJsOnlineProperty(network_up);
 }
 
+ScopedJavaLocalRef<jstring> XWalkContent::SetJsApiService(JNIEnv* env, const JavaParamRef<jobject>& obj,
+                                                          jboolean need_to_inject_js_object,
+                                                          const JavaParamRef<jstring>& js_object_name,
+                                                          const JavaParamRef<jobjectArray>& allowed_origin_rules) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  return GetJsJavaConfiguratorHost()->SetJsApiService(env, need_to_inject_js_object, js_object_name,
+                                                      allowed_origin_rules);
+}
+
 JsJavaConfiguratorHost* XWalkContent::GetJsJavaConfiguratorHost() {
   DCHECK_CURRENTLY_ON(BrowserThread::UI);
   if (!js_java_configurator_host_.get()) {
@@ -966,6 +977,33 @@ void XWalkContent::InvokeGeolocationCallback(JNIEnv* env, jobject obj, jboolean
   }
 }
 
+void XWalkContent::ClearGeolocationPermissions(
+    const base::RepeatingCallback<bool(const GURL&)>& filter) {
+  JNIEnv* env = AttachCurrentThread();
+  ScopedJavaLocalRef<jobject> obj = java_ref_.get(env);
+  if (obj.is_null())
+    return;
+  if (filter.is_null()) {
+    Java_XWalkContent_clearGeolocationPermissions(
+        env, obj, ScopedJavaLocalRef<jobjectArray>());
+    return;
+  }
+
+  std::vector<std::string> origins;
+  base::android::AppendJavaStringArrayToStringVector(
+      env, Java_XWalkContent_getGeolocationPermissionOrigins(env, obj),
+      &origins);
+  std::vector<std::string> matching;
+  for (const std::string& origin : origins) {
+    if (filter.Run(GURL(origin)))
+      matching.push_back(origin);
+  }
+  if (!matching.empty()) {
+    Java_XWalkContent_clearGeolocationPermissions(
+        env, obj, base::android::ToJavaArrayOfStrings(env, matching));
+  }
+}
+
 void XWalkContent::HideGeolocationPrompt(const GURL& origin) {
   bool removed_current_outstanding_callback = false;
   std::list<OriginCallback>::iterator it = pending_geolocation_prompts_.begin();
@@ -1117,6 +1155,31 @@ void XWalkContent::OnFindResultReceived(int active_ordinal, int match_count, boo
   Java_XWalkContent_onFindResultReceived(env, obj, active_ordinal, match_count, finished);
 }
 
+void XWalkContent::OnPostMessage(mojom::JsMessagePayloadPtr message, const url::Origin& source_origin,
+                                 bool is_main_frame, std::vector<mojo::ScopedMessagePipeHandle> ports) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  JNIEnv* env = AttachCurrentThread();
+  ScopedJavaLocalRef<jobject> obj = java_ref_.get(env);
+  if (obj.is_null())
+    return;
+
+  // Java takes ownership of the raw handles.
+  std::vector<int> int_ports(ports.size(), MOJO_HANDLE_INVALID);
+  for (size_t i = 0; i < ports.size(); ++i)
+    int_ports[i] = ports[i].release().value();
+
+  ScopedJavaLocalRef<jstring> j_string;
+  ScopedJavaLocalRef<jbyteArray> j_bytes;
+  if (message->is_string_value()) {
+    j_string = ConvertUTF8ToJavaString(env, message->get_string_value());
+  } else {
+    const mojo_base::BigBuffer& buffer = message->get_array_buffer_value();
+    j_bytes = base::android::ToJavaByteArray(env, buffer.data(), buffer.size());
+  }
+  Java_XWalkContent_onPostMessage(env, obj, j_string, j_bytes, ConvertUTF8ToJavaString(env, source_origin.Serialize()),
+                                  is_main_frame, base::android::ToJavaIntArray(env, int_ports.data(), int_ports.size()));
+}
+
 /**
  *
  */
@@ -12,8 +12,10 @@
 
 #include "base/android/jni_weak_ref.h"
 #include "base/android/scoped_java_ref.h"
+#include "base/callback.h"
 #include "third_party/blink/public/mojom/permissions/permission_status.mojom.h"
 #include "xwalk/runtime/browser/android/find_helper.h"
+#include "xwalk/runtime/browser/android/js_java_interaction/js_api_handler.h"
 #include "xwalk/runtime/browser/android/renderer_host/xwalk_render_view_host_ext.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 
@@ -49,7 +51,8 @@ class XWalkContentsClientBridge;
 class JsJavaConfiguratorHost;
 
 class XWalkContent :
-    public FindHelper::Listener
+    public FindHelper::Listener,
+    public JsApiHandler::Delegate
 #ifdef TENTA_CHROMIUM_BUILD
     ,
     public ::tenta::ext::TentaNetErrorClient::Listener
@@ -141,6 +144,10 @@ class XWalkContent :
   }
 
   void SetJsOnlineProperty(JNIEnv* env, jobject obj, jboolean network_up);
+  base::android::ScopedJavaLocalRef<jstring> SetJsApiService(
+      JNIEnv* env, const base::android::JavaParamRef<jobject>& obj, jboolean need_to_inject_js_object,
+      const base::android::JavaParamRef<jstring>& js_object_name,
+      const base::android::JavaParamRef<jobjectArray>& allowed_origin_rules);
   jboolean SetManifest(JNIEnv* env, const base::android::JavaParamRef<jobject>& obj,
                        const base::android::JavaParamRef<jstring>& path,
                        const base::android::JavaParamRef<jstring>& manifest);
@@ -151,6 +158,10 @@ class XWalkContent :
   void ShowGeolocationPrompt(const GURL& origin, base::OnceCallback<void(bool)> callback);  // NOLINT
   void HideGeolocationPrompt(const GURL& origin);
   void InvokeGeolocationCallback(JNIEnv* env, jobject obj, jboolean value, jstring origin);
+  // Forgets the retained geolocation decisions of the origins |filter|
+  // matches, of all origins if it is null.
+  void ClearGeolocationPermissions(
+      const base::RepeatingCallback<bool(const GURL&)>& filter);
 
   void SetXWalkAutofillClient(const base::android::JavaRef<jobject>& client);
   void SetSaveFormData(bool enabled);
@@ -160,6 +171,10 @@ class XWalkContent :
   base::android::ScopedJavaLocalRef<jobjectArray> GetCertificateChain(JNIEnv* env, const JavaParamRef<jobject>& obj);
 
   FindHelper* GetFindHelper();
+  // JsApiHandler::Delegate implementation.
+  JsJavaConfiguratorHost* GetJsJavaConfiguratorHost() override;
+  void OnPostMessage(mojom::JsMessagePayloadPtr message, const url::Origin& source_origin, bool is_main_frame,
+                     std::vector<mojo::ScopedMessagePipeHandle> ports) override;
   void FindAllAsync(JNIEnv* env, const JavaParamRef<jobject>& obj, const JavaParamRef<jstring>& search_string);
   void FindNext(JNIEnv* env, const JavaParamRef<jobject>& obj, jboolean forward);
   void ClearMatches(JNIEnv* env, const JavaParamRef<jobject>& obj);
@@ -173,8 +188,6 @@ class XWalkContent :
   void OnDidCaptureBitmap(const base::android::JavaRef<jobject>& obj, const base::android::JavaRef<jobject>& callback,
                           float scale, const SkBitmap& bitmap);
 
-  JsJavaConfiguratorHost* GetJsJavaConfiguratorHost();
-
 #ifdef TENTA_CHROMIUM_BUILD
   // TentaNetErrorClient::Listener
   void OnOpenDnsSettings(const GURL& failedUrl) override;
@@ -177,7 +177,8 @@ XWalkContentsClientBridge::FromRenderFrameHost(content::RenderFrameHost* render_
 XWalkContentsClientBridge::XWalkContentsClientBridge(
     JNIEnv* env, const base::android::JavaParamRef<jobject>& obj,
     content::WebContents* web_contents)
-    : java_ref_(env, obj) {
+    : java_ref_(env, obj),
+      cert_error_coalescer_(this) {
   DCHECK(obj);
   Java_XWalkContentsClientBridge_setNativeContentsClientBridge(env, obj, reinterpret_cast<intptr_t>(this));
   icon_helper_.reset(new XWalkIconHelper(web_contents));
@@ -202,15 +203,20 @@ XWalkContentsClientBridge::~XWalkContentsClientBridge() {
 }
 
 void XWalkContentsClientBridge::AllowCertificateError(int cert_error, net::X509Certificate* cert,
-                                                      const GURL& request_url, CertErrorCallback callback,
-                                                      bool* cancel_request) {
+                                                      const GURL& request_url, CertErrorCallback callback) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  cert_error_coalescer_.AllowCertificateError(cert_error, cert, request_url, std::move(callback));
+}
 
+bool XWalkContentsClientBridge::PromptCertificateError(int cert_error, net::X509Certificate* cert,
+                                                       const GURL& request_url,
+                                                       base::OnceCallback<void(bool proceed)> decided) {
   DCHECK_CURRENTLY_ON(BrowserThread::UI);
   JNIEnv* env = AttachCurrentThread();
 
   ScopedJavaLocalRef<jobject> obj = java_ref_.get(env);
   if (obj.is_null())
-    return;
+    return false;
 
   base::StringPiece der_string = net::x509_util::CryptoBufferAsStringPiece(cert->cert_buffer());
   ScopedJavaLocalRef<jbyteArray> jcert = base::android::ToJavaByteArray(
@@ -218,26 +224,28 @@ void XWalkContentsClientBridge::AllowCertificateError(int cert_error, net::X509C
   ScopedJavaLocalRef<jstring> jurl(ConvertUTF8ToJavaString(env, request_url.spec()));
   // We need to add the callback before making the call to java side,
   // as it may do a synchronous callback prior to returning.
-  int request_id = pending_cert_error_callbacks_.Add(std::make_unique<CertErrorCallback>(std::move(callback)));
-  *cancel_request = !Java_XWalkContentsClientBridge_allowCertificateError(env, obj, cert_error, jcert, jurl, request_id);
+  int request_id = pending_cert_error_callbacks_.Add(
+      std::make_unique<base::OnceCallback<void(bool)>>(std::move(decided)));
+  bool prompted = Java_XWalkContentsClientBridge_allowCertificateError(env, obj, cert_error, jcert, jurl, request_id);
   // if the request is cancelled, then cancel the stored callback
-  if (*cancel_request) {
+  if (!prompted) {
     pending_cert_error_callbacks_.Remove(request_id);
   }
+  return prompted;
 }
 
 void XWalkContentsClientBridge::ProceedSslError(JNIEnv* env, jobject obj,
                                                 jboolean proceed, jint id) {
   DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
-  CertErrorCallback* callback = pending_cert_error_callbacks_.Lookup(id);
+  base::OnceCallback<void(bool)>* callback = pending_cert_error_callbacks_.Lookup(id);
   if (!callback || callback->is_null()) {
     LOG(WARNING) << "Ignoring unexpected ssl error proceed callback";
     return;
   }
-  std::move(*callback).Run(
-      proceed ? content::CERTIFICATE_REQUEST_RESULT_TYPE_CONTINUE
-              : content::CERTIFICATE_REQUEST_RESULT_TYPE_CANCEL);
+  // Removed first, the coalescer may start a new prompt from the callback.
+  base::OnceCallback<void(bool)> decided = std::move(*callback);
   pending_cert_error_callbacks_.Remove(id);
+  std::move(decided).Run(proceed);
 }
 
 void XWalkContentsClientBridge::RunJavaScriptDialog(content::JavaScriptDialogType dialog_type, const GURL& origin_url,
@@ -370,18 +378,22 @@ void XWalkContentsClientBridge::OnWebLayoutPageScaleFactorChanged(
       env, obj, page_scale_factor);
 }
 
-bool XWalkContentsClientBridge::ShouldOverrideUrlLoading(
-    const base::string16& url,
+void XWalkContentsClientBridge::ShouldOverrideUrlLoading(
+    const GURL& url,
     bool has_user_gesture,
     bool is_redirect,
-    bool is_main_frame) {
+    bool is_main_frame,
+    base::OnceCallback<void(bool ignore_navigation)> decided) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
   JNIEnv* env = AttachCurrentThread();
   ScopedJavaLocalRef<jobject> obj = java_ref_.get(env);
-  if (obj.is_null())
-    return false;
-  ScopedJavaLocalRef<jstring> jurl = ConvertUTF16ToJavaString(env, url);
-  return Java_XWalkContentsClientBridge_shouldOverrideUrlLoading(
-      env, obj, jurl, has_user_gesture, is_redirect, is_main_frame);
+  if (obj.is_null()) {
+    std::move(decided).Run(false);
+    return;
+  }
+  ScopedJavaLocalRef<jstring> jurl = ConvertUTF8ToJavaString(env, url.spec());
+  std::move(decided).Run(Java_XWalkContentsClientBridge_shouldOverrideUrlLoading(
+      env, obj, jurl, has_user_gesture, is_redirect, is_main_frame));
 }
 
 /**
@@ -22,6 +22,8 @@
 #include "content/public/browser/resource_request_info.h"
 #include "net/ssl/ssl_cert_request_info.h"
 #include "xwalk/runtime/browser/android/xwalk_icon_helper.h"
+#include "xwalk/runtime/browser/xwalk_cert_error_coalescer.h"
+#include "xwalk/runtime/browser/xwalk_navigation_override_throttle.h"
 
 namespace gfx {
 class Size;
@@ -55,7 +57,9 @@ struct XWalkWebResourceRequest;
 // XWalkView, this class notifies it before being destroyed and to nullify
 // any references.
 // TODO(iotto) : Move IconHelper
-class XWalkContentsClientBridge : public XWalkIconHelper::Listener {
+class XWalkContentsClientBridge : public XWalkIconHelper::Listener,
+                                  public XWalkCertErrorCoalescer::Client,
+                                  public XWalkNavigationOverrideThrottle::Client {
  public:
   using CertErrorCallback = base::OnceCallback<void(content::CertificateRequestResultType)>;
   // Used to package up information needed by OnReceivedHttpError for transfer
@@ -86,8 +90,13 @@ class XWalkContentsClientBridge : public XWalkIconHelper::Listener {
                             content::WebContents* web_contents);
   ~XWalkContentsClientBridge() override;
 
+  // Concurrent requests failing with the same error share one prompt.
   void AllowCertificateError(int cert_error, net::X509Certificate* cert, const GURL& request_url,
-                             CertErrorCallback callback, bool* cancel_request);
+                             CertErrorCallback callback);
+
+  // XWalkCertErrorCoalescer::Client implementation.
+  bool PromptCertificateError(int cert_error, net::X509Certificate* cert, const GURL& request_url,
+                              base::OnceCallback<void(bool proceed)> decided) override;
 
   void RunJavaScriptDialog(content::JavaScriptDialogType dialog_type, const GURL& origin_url,
                            const base::string16& message_text, const base::string16& default_prompt_text,
@@ -100,7 +109,10 @@ class XWalkContentsClientBridge : public XWalkIconHelper::Listener {
 
   bool OnReceivedHttpAuthRequest(const base::android::JavaRef<jobject>& handler, const std::string& host,
                                  const std::string& realm);
-  bool ShouldOverrideUrlLoading(const base::string16& url, bool has_user_gesture, bool is_redirect, bool is_main_frame);
+  // XWalkNavigationOverrideThrottle::Client implementation. The Java client
+  // answers synchronously, but the renderer is not waiting for it.
+  void ShouldOverrideUrlLoading(const GURL& url, bool has_user_gesture, bool is_redirect, bool is_main_frame,
+                                base::OnceCallback<void(bool ignore_navigation)> decided) override;
 
   bool RewriteUrlIfNeeded(const std::string& url, ui::PageTransition transition_type, std::string* new_url);
 
@@ -151,7 +163,8 @@ class XWalkContentsClientBridge : public XWalkIconHelper::Listener {
  private:
   JavaObjectWeakGlobalRef java_ref_;
 
-  base::IDMap<std::unique_ptr<CertErrorCallback>> pending_cert_error_callbacks_;
+  XWalkCertErrorCoalescer cert_error_coalescer_;
+  base::IDMap<std::unique_ptr<base::OnceCallback<void(bool)>>> pending_cert_error_callbacks_;
   base::IDMap<std::unique_ptr<content::JavaScriptDialogManager::DialogClosedCallback>>
       pending_js_dialog_callbacks_;
   base::IDMap<std::unique_ptr<content::ClientCertificateDelegate>>
@@ -6,8 +6,14 @@
 
 #include "base/android/jni_android.h"
 #include "base/android/scoped_java_ref.h"
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/task/post_task.h"
+#include "content/public/browser/browser_task_traits.h"
+#include "content/public/browser/browser_thread.h"
 
 #include "xwalk/runtime/browser/xwalk_browser_context.h"
+#include "xwalk/runtime/browser/xwalk_browsing_data_remover.h"
 #include "xwalk/runtime/android/core_refactor/xwalk_refactor_native_jni/XWalkFormDatabase_jni.h"
 
 namespace xwalk {
@@ -21,6 +27,13 @@ XWalkFormDatabaseService* GetFormDatabaseService() {
   return service;
 }
 
+void ClearFormDataOnUI() {
+  XWalkBrowserContext::GetDefault()->GetXWalkBrowsingDataRemover()->Remove(
+      base::Time(), base::Time::Max(),
+      XWalkBrowsingDataRemover::DATA_TYPE_FORM_DATA, std::set<url::Origin>(),
+      base::DoNothing());
+}
+
 } // anonymous namespace
 
 // static
@@ -30,7 +43,8 @@ jboolean JNI_XWalkFormDatabase_HasFormData(JNIEnv*) {
 
 // static
 void JNI_XWalkFormDatabase_ClearFormData(JNIEnv*) {
-  GetFormDatabaseService()->ClearFormData();
+  base::PostTaskWithTraits(FROM_HERE, {content::BrowserThread::UI},
+                           base::BindOnce(&ClearFormDataOnUI));
 }
 
 bool RegisterXWalkFormDatabase(JNIEnv* env) {
@@ -0,0 +1,187 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/devtools/xwalk_devtools_crosswalk_handler.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
+#include "base/values.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/devtools_agent_host.h"
+#include "content/public/browser/devtools_agent_host_client.h"
+#include "xwalk/runtime/browser/devtools/xwalk_ipc_stats_collector.h"
+#include "xwalk/runtime/browser/runtime_request_timeline.h"
+#include "xwalk/runtime/common/xwalk_ipc_accounting.h"
+
+using content::BrowserThread;
+
+namespace xwalk {
+
+namespace {
+
+const char kDomainPrefix[] = "Crosswalk.";
+const char kEnable[] = "Crosswalk.enable";
+const char kDisable[] = "Crosswalk.disable";
+const char kGetCounters[] = "Crosswalk.getCounters";
+const char kGetIPCStats[] = "Crosswalk.getIPCStats";
+const char kGetRequestTimeline[] = "Crosswalk.getRequestTimeline";
+
+const int kDefaultCountersIntervalMs = 1000;
+// Counters are read from atomics, but a client asking for them every frame
+// would still flood the socket.
+const int kMinCountersIntervalMs = 50;
+
+// JSON-RPC, as the rest of the protocol.
+const int kErrorMethodNotFound = -32601;
+const int kErrorInvalidParams = -32602;
+
+}  // namespace
+
+XWalkDevToolsCrosswalkHandler::XWalkDevToolsCrosswalkHandler(
+    content::DevToolsAgentHost* agent_host,
+    content::DevToolsAgentHostClient* client)
+    : agent_host_(agent_host),
+      client_(client),
+      enabled_(false),
+      weak_factory_(this) {}
+
+XWalkDevToolsCrosswalkHandler::~XWalkDevToolsCrosswalkHandler() {
+  Disable();
+}
+
+bool XWalkDevToolsCrosswalkHandler::HandleCommand(const std::string& method,
+                                                  const std::string& message) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  if (!base::StartsWith(method, kDomainPrefix, base::CompareCase::SENSITIVE))
+    return false;
+
+  std::unique_ptr<base::DictionaryValue> command =
+      base::DictionaryValue::From(base::JSONReader::ReadDeprecated(message));
+  int id = 0;
+  if (!command || !command->GetInteger("id", &id))
+    return false;
+  const base::DictionaryValue* params = nullptr;
+  command->GetDictionary("params", &params);
+
+  base::DictionaryValue result;
+  if (method == kEnable) {
+    int interval_ms = kDefaultCountersIntervalMs;
+    if (params && params->HasKey("countersInterval") &&
+        !params->GetInteger("countersInterval", &interval_ms)) {
+      SendError(id, kErrorInvalidParams, "countersInterval must be an integer");
+      return true;
+    }
+    Enable(std::max(interval_ms, kMinCountersIntervalMs));
+  } else if (method == kDisable) {
+    Disable();
+  } else if (method == kGetCounters) {
+    result.Set("counters", XWalkRuntimeInternals::GetInstance()->GetCounters());
+  } else if (method == kGetIPCStats) {
+    XWalkIPCStatsCollector::GetInstance()->Collect(
+        base::BindOnce(&XWalkDevToolsCrosswalkHandler::SendIPCStats,
+                       weak_factory_.GetWeakPtr(), id));
+    return true;
+  } else if (method == kGetRequestTimeline) {
+    RuntimeRequestTimeline::GetHar(
+        base::BindOnce(&XWalkDevToolsCrosswalkHandler::SendRequestTimeline,
+                       weak_factory_.GetWeakPtr(), id));
+    return true;
+  } else {
+    SendError(id, kErrorMethodNotFound,
+              base::StringPrintf("'%s' wasn't found", method.c_str()));
+    return true;
+  }
+  SendResult(id, result);
+  return true;
+}
+
+void XWalkDevToolsCrosswalkHandler::OnRuntimeEvent(
+    const std::string& method,
+    const std::string& params_json) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  // |params_json| was serialized once for every client, it is not parsed
+  // again just to be wrapped.
+  Send(base::StringPrintf("{\"method\":\"%s\",\"params\":%s}", method.c_str(),
+                          params_json.c_str()));
+}
+
+void XWalkDevToolsCrosswalkHandler::Enable(int interval_ms) {
+  if (!enabled_) {
+    enabled_ = true;
+    XWalkRuntimeInternals::GetInstance()->AddObserver(this);
+  }
+  counters_timer_.Start(
+      FROM_HERE, base::TimeDelta::FromMilliseconds(interval_ms),
+      base::BindRepeating(&XWalkDevToolsCrosswalkHandler::SendCounters,
+                          base::Unretained(this)));
+}
+
+void XWalkDevToolsCrosswalkHandler::Disable() {
+  counters_timer_.Stop();
+  if (!enabled_)
+    return;
+  enabled_ = false;
+  XWalkRuntimeInternals::GetInstance()->RemoveObserver(this);
+}
+
+void XWalkDevToolsCrosswalkHandler::SendCounters() {
+  base::DictionaryValue params;
+  params.Set("counters", XWalkRuntimeInternals::GetInstance()->GetCounters());
+  std::string params_json;
+  base::JSONWriter::Write(params, &params_json);
+  OnRuntimeEvent("Crosswalk.countersUpdated", params_json);
+}
+
+void XWalkDevToolsCrosswalkHandler::SendIPCStats(
+    int id,
+    std::unique_ptr<base::ListValue> processes) {
+  base::DictionaryValue result;
+  result.Set("processes", std::move(processes));
+  SendResult(id, result);
+}
+
+void XWalkDevToolsCrosswalkHandler::SendRequestTimeline(int id,
+                                                        base::Value har) {
+  base::DictionaryValue result;
+  result.SetKey("har", std::move(har));
+  SendResult(id, result);
+}
+
+void XWalkDevToolsCrosswalkHandler::SendResult(
+    int id,
+    const base::DictionaryValue& result) {
+  base::DictionaryValue response;
+  response.SetInteger("id", id);
+  response.SetKey("result", result.Clone());
+  std::string json;
+  base::JSONWriter::Write(response, &json);
+  Send(json);
+}
+
+void XWalkDevToolsCrosswalkHandler::SendError(int id,
+                                              int code,
+                                              const std::string& message) {
+  auto error = std::make_unique<base::DictionaryValue>();
+  error->SetInteger("code", code);
+  error->SetString("message", message);
+  base::DictionaryValue response;
+  response.SetInteger("id", id);
+  response.Set("error", std::move(error));
+  std::string json;
+  base::JSONWriter::Write(response, &json);
+  Send(json);
+}
+
+void XWalkDevToolsCrosswalkHandler::Send(const std::string& message) {
+  client_->DispatchProtocolMessage(agent_host_, message);
+}
+
+}  // namespace xwalk
@@ -0,0 +1,86 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_BROWSER_DEVTOOLS_XWALK_DEVTOOLS_CROSSWALK_HANDLER_H_
+#define XWALK_RUNTIME_BROWSER_DEVTOOLS_XWALK_DEVTOOLS_CROSSWALK_HANDLER_H_
+
+#include <memory>
+#include <string>
+
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "base/timer/timer.h"
+#include "xwalk/runtime/common/xwalk_runtime_internals.h"
+
+namespace base {
+class DictionaryValue;
+class ListValue;
+class Value;
+}
+
+namespace content {
+class DevToolsAgentHost;
+class DevToolsAgentHostClient;
+}
+
+namespace xwalk {
+
+// The "Crosswalk" protocol domain of one DevTools client:
+//
+//   Crosswalk.enable {countersInterval?: ms}  Starts the events below and a
+//                                             Crosswalk.countersUpdated
+//                                             {counters} every interval.
+//   Crosswalk.disable
+//   Crosswalk.getCounters -> {counters}
+//   Crosswalk.getIPCStats -> {processes}      XWalkIPCAccounting tables of
+//                                             the browser and the render
+//                                             processes.
+//   Crosswalk.getRequestTimeline -> {har}     RuntimeRequestTimeline as
+//                                             HAR 1.2.
+//
+//   Crosswalk.extensionMessage {name, direction, bytes, sync}
+//   Crosswalk.extensionInstance {extension, created}
+//   Crosswalk.requestIntercepted {url, intercepted}
+//   Crosswalk.cookieZoneSwitched {zone, deletedCookies}
+//
+// Only enabled clients observe XWalkRuntimeInternals, with none the runtime
+// does not prepare any event. Lives on the UI thread.
+class XWalkDevToolsCrosswalkHandler : public XWalkRuntimeInternals::Observer {
+ public:
+  XWalkDevToolsCrosswalkHandler(content::DevToolsAgentHost* agent_host,
+                                content::DevToolsAgentHostClient* client);
+  ~XWalkDevToolsCrosswalkHandler() override;
+
+  // Returns false if |method| is not in the domain, the command is then
+  // left to the content layer. |message| is the whole command.
+  bool HandleCommand(const std::string& method, const std::string& message);
+
+  // XWalkRuntimeInternals::Observer implementation.
+  void OnRuntimeEvent(const std::string& method,
+                      const std::string& params_json) override;
+
+ private:
+  void Enable(int interval_ms);
+  void Disable();
+  void SendCounters();
+  void SendIPCStats(int id, std::unique_ptr<base::ListValue> processes);
+  void SendRequestTimeline(int id, base::Value har);
+
+  void SendResult(int id, const base::DictionaryValue& result);
+  void SendError(int id, int code, const std::string& message);
+  void Send(const std::string& message);
+
+  content::DevToolsAgentHost* agent_host_;
+  content::DevToolsAgentHostClient* client_;
+  bool enabled_;
+  base::RepeatingTimer counters_timer_;
+
+  base::WeakPtrFactory<XWalkDevToolsCrosswalkHandler> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkDevToolsCrosswalkHandler);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_BROWSER_DEVTOOLS_XWALK_DEVTOOLS_CROSSWALK_HANDLER_H_
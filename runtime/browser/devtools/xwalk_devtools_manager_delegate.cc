@@ -6,6 +6,7 @@
 #include "xwalk/runtime/browser/devtools/xwalk_devtools_manager_delegate.h"
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/atomicops.h"
@@ -38,6 +39,7 @@
 #include "net/log/net_log_source.h"
 #include "ui/base/resource/resource_bundle.h"
 #include "xwalk/runtime/common/xwalk_content_client.h"
+#include "xwalk/runtime/browser/devtools/xwalk_devtools_crosswalk_handler.h"
 #include "xwalk/runtime/browser/runtime.h"
 #include "xwalk/runtime/browser/xwalk_browser_context.h"
 
@@ -458,17 +460,32 @@ bool XWalkDevToolsManagerDelegate::IsBrowserTargetDiscoverable() {
   return true;
 }
 
-//bool XWalkDevToolsManagerDelegate::HandleCommand(
-//    DevToolsAgentHost* agent_host,
-//    int session_id,
-//    base::DictionaryValue* command_dict) {
-//  /*
-//   * TODO(iotto): for implementation details (like scroll, click, etc ...) see:
-//   * chrome/browser/devtools/chrome_devtools_session.h
-//   * chrome/browser/devtools/chrome_devtools_manager_delegate.cc
-//   */
-//  return false;
-//}
+void XWalkDevToolsManagerDelegate::ClientAttached(
+    content::DevToolsAgentHost* agent_host,
+    content::DevToolsAgentHostClient* client) {
+  crosswalk_handlers_[client] =
+      std::make_unique<XWalkDevToolsCrosswalkHandler>(agent_host, client);
+}
+
+void XWalkDevToolsManagerDelegate::ClientDetached(
+    content::DevToolsAgentHost* agent_host,
+    content::DevToolsAgentHostClient* client) {
+  crosswalk_handlers_.erase(client);
+}
+
+void XWalkDevToolsManagerDelegate::HandleCommand(
+    content::DevToolsAgentHost* agent_host,
+    content::DevToolsAgentHostClient* client,
+    const std::string& method,
+    const std::string& message,
+    NotifyCallback callback) {
+  auto it = crosswalk_handlers_.find(client);
+  if (it != crosswalk_handlers_.end() &&
+      it->second->HandleCommand(method, message)) {
+    return;
+  }
+  std::move(callback).Run(message);
+}
 
 XWalkDevToolsManagerDelegate::~XWalkDevToolsManagerDelegate() {
 }
@@ -6,6 +6,10 @@
 #ifndef XWALK_RUNTIME_BROWSER_DEVTOOLS_XWALK_DEVTOOLS_MANAGER_DELEGATE_H_
 #define XWALK_RUNTIME_BROWSER_DEVTOOLS_XWALK_DEVTOOLS_MANAGER_DELEGATE_H_
 
+#include <map>
+#include <memory>
+#include <string>
+
 #include "base/compiler_specific.h"
 #include "content/browser/devtools/devtools_http_handler.h"
 #include "content/public/browser/devtools_manager_delegate.h"
@@ -17,6 +21,7 @@ class DevToolsHttpHandler;
 namespace xwalk {
 
 class XWalkBrowserContext;
+class XWalkDevToolsCrosswalkHandler;
 
 class XWalkDevToolsManagerDelegate : public content::DevToolsManagerDelegate {
  public:
@@ -32,11 +37,24 @@ class XWalkDevToolsManagerDelegate : public content::DevToolsManagerDelegate {
   std::string GetTargetDescription(content::WebContents* web_contents) override;
   std::string GetDiscoveryPageHTML() override;
   bool IsBrowserTargetDiscoverable() override;
+  void ClientAttached(content::DevToolsAgentHost* agent_host,
+                      content::DevToolsAgentHostClient* client) override;
+  void ClientDetached(content::DevToolsAgentHost* agent_host,
+                      content::DevToolsAgentHostClient* client) override;
+  void HandleCommand(content::DevToolsAgentHost* agent_host,
+                     content::DevToolsAgentHostClient* client,
+                     const std::string& method,
+                     const std::string& message,
+                     NotifyCallback callback) override;
 
   ~XWalkDevToolsManagerDelegate() override;
 
  private:
   XWalkBrowserContext* _browser_context;
+  // The Crosswalk domain of every attached client.
+  std::map<content::DevToolsAgentHostClient*,
+           std::unique_ptr<XWalkDevToolsCrosswalkHandler>>
+      crosswalk_handlers_;
   DISALLOW_COPY_AND_ASSIGN(XWalkDevToolsManagerDelegate);
 };
 
@@ -0,0 +1,107 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/devtools/xwalk_ipc_stats_collector.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/json/json_reader.h"
+#include "base/task/post_task.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "content/public/browser/browser_task_traits.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/render_process_host.h"
+#include "xwalk/runtime/common/xwalk_ipc_accounting.h"
+
+#if defined(OS_ANDROID)
+#include "xwalk/runtime/common/android/xwalk_render_view_messages.h"
+#endif
+
+using content::BrowserThread;
+
+namespace xwalk {
+
+namespace {
+
+// A renderer busy running script answers late, the result is sent without
+// it rather than holding the DevTools client.
+constexpr base::TimeDelta kTimeout = base::TimeDelta::FromSeconds(1);
+
+}  // namespace
+
+struct XWalkIPCStatsCollector::Request {
+  Callback callback;
+  std::unique_ptr<base::ListValue> processes;
+  int outstanding = 0;
+};
+
+// static
+XWalkIPCStatsCollector* XWalkIPCStatsCollector::GetInstance() {
+  static base::NoDestructor<XWalkIPCStatsCollector> instance;
+  return instance.get();
+}
+
+XWalkIPCStatsCollector::XWalkIPCStatsCollector() : next_request_id_(1) {}
+
+XWalkIPCStatsCollector::~XWalkIPCStatsCollector() = default;
+
+void XWalkIPCStatsCollector::Collect(Callback callback) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  int request_id = next_request_id_++;
+  auto request = std::make_unique<Request>();
+  request->callback = std::move(callback);
+  request->processes = std::make_unique<base::ListValue>();
+  request->processes->Append(XWalkIPCAccounting::GetInstance()->ToValue());
+
+#if defined(OS_ANDROID)
+  for (content::RenderProcessHost::iterator it(
+           content::RenderProcessHost::AllHostsIterator());
+       !it.IsAtEnd(); it.Advance()) {
+    content::RenderProcessHost* host = it.GetCurrentValue();
+    if (host->IsInitializedAndNotDead() &&
+        host->Send(new XWalkViewMsg_GetIPCStats(request_id))) {
+      request->outstanding++;
+    }
+  }
+#endif
+
+  bool done = !request->outstanding;
+  requests_[request_id] = std::move(request);
+  if (done) {
+    Finish(request_id);
+    return;
+  }
+  base::PostDelayedTaskWithTraits(
+      FROM_HERE, {BrowserThread::UI},
+      base::BindOnce(&XWalkIPCStatsCollector::Finish, base::Unretained(this),
+                     request_id),
+      kTimeout);
+}
+
+void XWalkIPCStatsCollector::OnProcessStats(int request_id,
+                                            const std::string& json) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  auto it = requests_.find(request_id);
+  if (it == requests_.end())
+    return;
+  Request* request = it->second.get();
+  std::unique_ptr<base::Value> stats = base::JSONReader::ReadDeprecated(json);
+  if (stats && stats->is_dict())
+    request->processes->Append(std::move(stats));
+  if (--request->outstanding == 0)
+    Finish(request_id);
+}
+
+void XWalkIPCStatsCollector::Finish(int request_id) {
+  auto it = requests_.find(request_id);
+  if (it == requests_.end())
+    return;
+  std::unique_ptr<Request> request = std::move(it->second);
+  requests_.erase(it);
+  std::move(request->callback).Run(std::move(request->processes));
+}
+
+}  // namespace xwalk
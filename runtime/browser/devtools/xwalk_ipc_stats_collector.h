@@ -0,0 +1,60 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_BROWSER_DEVTOOLS_XWALK_IPC_STATS_COLLECTOR_H_
+#define XWALK_RUNTIME_BROWSER_DEVTOOLS_XWALK_IPC_STATS_COLLECTOR_H_
+
+#include <map>
+#include <memory>
+#include <string>
+
+#include "base/callback.h"
+#include "base/macros.h"
+#include "base/no_destructor.h"
+
+namespace base {
+class ListValue;
+}
+
+namespace xwalk {
+
+// Gathers the XWalkIPCAccounting tables of the browser and of every live
+// render process, for the Crosswalk.getIPCStats DevTools command. Render
+// processes are asked with XWalkViewMsg_GetIPCStats, which only Android
+// renderers handle; elsewhere the browser table is all there is. Lives on
+// the UI thread.
+class XWalkIPCStatsCollector {
+ public:
+  // One XWalkIPCAccounting::ToValue() per process, the browser first.
+  using Callback =
+      base::OnceCallback<void(std::unique_ptr<base::ListValue> processes)>;
+
+  static XWalkIPCStatsCollector* GetInstance();
+
+  // Runs |callback| once every render process answered, or after a timeout
+  // with the answers that came in.
+  void Collect(Callback callback);
+
+  // A render process answered request |request_id| with |json|.
+  void OnProcessStats(int request_id, const std::string& json);
+
+ private:
+  friend class base::NoDestructor<XWalkIPCStatsCollector>;
+
+  struct Request;
+
+  XWalkIPCStatsCollector();
+  ~XWalkIPCStatsCollector();
+
+  void Finish(int request_id);
+
+  int next_request_id_;
+  std::map<int, std::unique_ptr<Request>> requests_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkIPCStatsCollector);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_BROWSER_DEVTOOLS_XWALK_IPC_STATS_COLLECTOR_H_
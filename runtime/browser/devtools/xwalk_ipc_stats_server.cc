@@ -0,0 +1,111 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/devtools/xwalk_ipc_stats_server.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/json/json_writer.h"
+#include "base/logging.h"
+#include "base/task/post_task.h"
+#include "base/values.h"
+#include "content/public/browser/browser_task_traits.h"
+#include "net/base/net_errors.h"
+#include "net/server/http_server_request_info.h"
+#include "net/socket/tcp_server_socket.h"
+#include "net/traffic_annotation/network_traffic_annotation.h"
+#include "xwalk/runtime/browser/devtools/xwalk_ipc_stats_collector.h"
+
+namespace xwalk {
+
+namespace {
+
+const char kLoopback[] = "127.0.0.1";
+
+constexpr net::NetworkTrafficAnnotationTag kTrafficAnnotation =
+    net::DefineNetworkTrafficAnnotation("xwalk_ipc_stats_server", R"(
+      semantics {
+        sender: "Crosswalk IPC stats server"
+        description:
+          "Answers local debugging requests for the IPC accounting table."
+        trigger: "A request to the port given with --ipc-stats-port."
+        data: "Per message type IPC counters of the browser and renderers."
+        destination: LOCAL
+      }
+      policy {
+        cookies_allowed: NO
+        setting: "Only enabled from the command line."
+        policy_exception_justification: "Debugging aid."
+      })");
+
+// Runs on the UI thread, where the collector lives.
+void CollectOnUI(base::OnceCallback<void(const std::string&)> reply) {
+  XWalkIPCStatsCollector::GetInstance()->Collect(base::BindOnce(
+      [](base::OnceCallback<void(const std::string&)> reply,
+         std::unique_ptr<base::ListValue> processes) {
+        std::string json;
+        base::JSONWriter::WriteWithOptions(
+            *processes, base::JSONWriter::OPTIONS_PRETTY_PRINT, &json);
+        base::PostTaskWithTraits(FROM_HERE, {content::BrowserThread::IO},
+                                 base::BindOnce(std::move(reply), json));
+      },
+      std::move(reply)));
+}
+
+}  // namespace
+
+// static
+XWalkIPCStatsServer::Ptr XWalkIPCStatsServer::Start(int port) {
+  Ptr server(new XWalkIPCStatsServer(port));
+  // Deletion is posted to the IO thread too, so it runs after Listen().
+  base::PostTaskWithTraits(FROM_HERE, {content::BrowserThread::IO},
+                           base::BindOnce(&XWalkIPCStatsServer::Listen,
+                                          base::Unretained(server.get())));
+  return server;
+}
+
+XWalkIPCStatsServer::XWalkIPCStatsServer(int port)
+    : port_(port), weak_factory_(this) {}
+
+XWalkIPCStatsServer::~XWalkIPCStatsServer() {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+}
+
+void XWalkIPCStatsServer::Listen() {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+  std::unique_ptr<net::ServerSocket> socket(
+      new net::TCPServerSocket(nullptr, net::NetLogSource()));
+  if (socket->ListenWithAddressAndPort(kLoopback, port_, 1) != net::OK) {
+    LOG(ERROR) << "Cannot serve IPC stats on port " << port_;
+    return;
+  }
+  server_.reset(new net::HttpServer(std::move(socket), this));
+}
+
+void XWalkIPCStatsServer::OnHttpRequest(
+    int connection_id,
+    const net::HttpServerRequestInfo& info) {
+  if (info.path != "/ipc" && info.path != "/ipc.json") {
+    server_->Send404(connection_id, kTrafficAnnotation);
+    return;
+  }
+  base::PostTaskWithTraits(
+      FROM_HERE, {content::BrowserThread::UI},
+      base::BindOnce(&CollectOnUI,
+                     base::BindOnce(&XWalkIPCStatsServer::SendStats,
+                                    weak_factory_.GetWeakPtr(),
+                                    connection_id)));
+}
+
+void XWalkIPCStatsServer::SendStats(int connection_id,
+                                    const std::string& json) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+  // The client may have hung up while the renderers were asked, HttpServer
+  // ignores sends to closed connections.
+  server_->Send200(connection_id, json, "application/json; charset=UTF-8",
+                   kTrafficAnnotation);
+}
+
+}  // namespace xwalk
@@ -0,0 +1,61 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_BROWSER_DEVTOOLS_XWALK_IPC_STATS_SERVER_H_
+#define XWALK_RUNTIME_BROWSER_DEVTOOLS_XWALK_IPC_STATS_SERVER_H_
+
+#include <memory>
+#include <string>
+
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/server/http_server.h"
+
+namespace base {
+class ListValue;
+}
+
+namespace xwalk {
+
+// Serves the XWalkIPCAccounting tables of the browser and render processes,
+// as gathered by XWalkIPCStatsCollector, as JSON on
+// http://127.0.0.1:<port>/ipc, enabled with --ipc-stats-port. Runs on the
+// IO thread; create and destroy it through Start() on any thread.
+class XWalkIPCStatsServer : public net::HttpServer::Delegate {
+ public:
+  using Ptr =
+      std::unique_ptr<XWalkIPCStatsServer,
+                      content::BrowserThread::DeleteOnIOThread>;
+
+  static Ptr Start(int port);
+
+  ~XWalkIPCStatsServer() override;
+
+ private:
+  explicit XWalkIPCStatsServer(int port);
+
+  void Listen();
+  void SendStats(int connection_id, const std::string& json);
+
+  // net::HttpServer::Delegate implementation.
+  void OnConnect(int connection_id) override {}
+  void OnHttpRequest(int connection_id,
+                     const net::HttpServerRequestInfo& info) override;
+  void OnWebSocketRequest(int connection_id,
+                          const net::HttpServerRequestInfo& info) override {}
+  void OnWebSocketMessage(int connection_id, std::string data) override {}
+  void OnClose(int connection_id) override {}
+
+  const int port_;
+  std::unique_ptr<net::HttpServer> server_;
+
+  base::WeakPtrFactory<XWalkIPCStatsServer> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkIPCStatsServer);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_BROWSER_DEVTOOLS_XWALK_IPC_STATS_SERVER_H_
@@ -7,15 +7,68 @@
 
 #include "xwalk/runtime/browser/network_services/xwalk_proxying_restricted_cookie_manager.h"
 
+#include <functional>
+
+#include "base/bind_helpers.h"
 #include "base/memory/ptr_util.h"
 #include "base/task/post_task.h"
 #include "content/public/browser/browser_task_traits.h"
 #include "content/public/browser/browser_thread.h"
 #include "mojo/public/cpp/bindings/strong_binding.h"
+#include "net/base/registry_controlled_domains/registry_controlled_domain.h"
 #include "xwalk/runtime/browser/android/xwalk_cookie_access_policy.h"
 
 namespace xwalk {
 
+namespace {
+
+// Expired cookies are dropped lazily by the cookie store, when a read finds
+// them, so no change is reported for them. Cached strings are refreshed
+// after this long to let them go.
+constexpr base::TimeDelta kMaxCachedCookiesAge =
+    base::TimeDelta::FromSeconds(1);
+
+// Change subscriptions cannot be cancelled and live as long as the manager,
+// so a frame that reads cookies for many URLs only has the first ones cached.
+const size_t kMaxWatchedUrls = 16;
+
+// A cookie set for a URL is only visible to URLs of the same registrable
+// domain, so cookie versions are kept per site. Sites sharing a slot only
+// invalidate each other's caches.
+const size_t kCookieVersionSlots = 1024;
+
+// Only used on the IO thread.
+uint64_t& CookieVersionFor(const GURL& url) {
+  static uint64_t versions[kCookieVersionSlots] = {};
+  std::string site = net::registry_controlled_domains::GetDomainAndRegistry(
+      url, net::registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES);
+  if (site.empty())
+    site = url.host();
+  return versions[std::hash<std::string>()(site) % kCookieVersionSlots];
+}
+
+}  // namespace
+
+// Invalidates the cookie cache of the manager on every change, whether the
+// frame may see the cookie or not.
+class XwalkCookieCacheInvalidator : public network::mojom::CookieChangeListener {
+ public:
+  explicit XwalkCookieCacheInvalidator(
+      base::WeakPtr<XwalkProxyingRestrictedCookieManager>
+          aw_restricted_cookie_manager)
+      : aw_restricted_cookie_manager_(aw_restricted_cookie_manager) {}
+
+  void OnCookieChange(const net::CanonicalCookie& cookie,
+                      network::mojom::CookieChangeCause cause) override {
+    if (aw_restricted_cookie_manager_)
+      aw_restricted_cookie_manager_->InvalidateCookieCache();
+  }
+
+ private:
+  base::WeakPtr<XwalkProxyingRestrictedCookieManager>
+      aw_restricted_cookie_manager_;
+};
+
 class XwalkProxyingRestrictedCookieManagerListener
     : public network::mojom::CookieChangeListener {
  public:
@@ -89,8 +142,18 @@ void XwalkProxyingRestrictedCookieManager::SetCanonicalCookie(
   DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
 
   if (AllowCookies(url, site_for_cookies)) {
+    // Reads sent in the meantime may or may not see the write, the version
+    // moves again once it is done.
+    OnCookiesChanged(url);
     underlying_restricted_cookie_manager_->SetCanonicalCookie(
-        cookie, url, site_for_cookies, std::move(callback));
+        cookie, url, site_for_cookies,
+        base::BindOnce(
+            [](const GURL& url, SetCanonicalCookieCallback callback,
+               bool success) {
+              OnCookiesChanged(url);
+              std::move(callback).Run(success);
+            },
+            url, std::move(callback)));
   } else {
     std::move(callback).Run(false);
   }
@@ -125,8 +188,17 @@ void XwalkProxyingRestrictedCookieManager::SetCookieFromString(
   DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
 
   if (AllowCookies(url, site_for_cookies)) {
+    // As in SetCanonicalCookie(), other frames may read while the write is
+    // in flight.
+    OnCookiesChanged(url);
     underlying_restricted_cookie_manager_->SetCookieFromString(
-        url, site_for_cookies, cookie, std::move(callback));
+        url, site_for_cookies, cookie,
+        base::BindOnce(
+            [](const GURL& url, SetCookieFromStringCallback callback) {
+              OnCookiesChanged(url);
+              std::move(callback).Run();
+            },
+            url, std::move(callback)));
   } else {
     std::move(callback).Run();
   }
@@ -138,12 +210,32 @@ void XwalkProxyingRestrictedCookieManager::GetCookiesString(
     GetCookiesStringCallback callback) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
 
-  if (AllowCookies(url, site_for_cookies)) {
-    underlying_restricted_cookie_manager_->GetCookiesString(
-        url, site_for_cookies, std::move(callback));
-  } else {
+  // Checked on every read, the policy can change without a cookie change.
+  if (!AllowCookies(url, site_for_cookies)) {
     std::move(callback).Run("");
+    return;
   }
+
+  CacheKey key(url, site_for_cookies);
+  const uint64_t cookie_version = CookieVersionFor(url);
+  auto cached = cookie_cache_.find(key);
+  if (cached != cookie_cache_.end()) {
+    if (cached->second.cookie_version == cookie_version &&
+        base::TimeTicks::Now() - cached->second.fetch_time <
+            kMaxCachedCookiesAge) {
+      std::move(callback).Run(cached->second.cookies);
+      return;
+    }
+    cookie_cache_.erase(cached);
+  }
+
+  if (!watched_keys_.count(key) && watched_keys_.size() < kMaxWatchedUrls)
+    WatchCookieChanges(key);
+  underlying_restricted_cookie_manager_->GetCookiesString(
+      url, site_for_cookies,
+      base::BindOnce(&XwalkProxyingRestrictedCookieManager::OnGotCookiesString,
+                     weak_factory_.GetWeakPtr(), key, cache_version_,
+                     cookie_version, std::move(callback)));
 }
 
 void XwalkProxyingRestrictedCookieManager::CookiesEnabledFor(
@@ -165,10 +257,54 @@ XwalkProxyingRestrictedCookieManager::XwalkProxyingRestrictedCookieManager(
       is_service_worker_(is_service_worker),
       process_id_(process_id),
       frame_id_(frame_id),
+      cache_version_(0),
       weak_factory_(this) {
   DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
 }
 
+void XwalkProxyingRestrictedCookieManager::InvalidateCookieCache() {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+  ++cache_version_;
+  cookie_cache_.clear();
+}
+
+// static
+void XwalkProxyingRestrictedCookieManager::OnCookiesChanged(const GURL& url) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+  ++CookieVersionFor(url);
+}
+
+void XwalkProxyingRestrictedCookieManager::WatchCookieChanges(
+    const CacheKey& key) {
+  watched_keys_.insert(key);
+
+  network::mojom::CookieChangeListenerPtr invalidator_ptr;
+  mojo::MakeStrongBinding(
+      std::make_unique<XwalkCookieCacheInvalidator>(weak_factory_.GetWeakPtr()),
+      mojo::MakeRequest(&invalidator_ptr));
+  // Sent before the read that fills the cache, on the same pipe, so the
+  // subscription is in place by the time the cookies are read.
+  underlying_restricted_cookie_manager_->AddChangeListener(
+      key.first, key.second, std::move(invalidator_ptr), base::DoNothing());
+}
+
+void XwalkProxyingRestrictedCookieManager::OnGotCookiesString(
+    const CacheKey& key,
+    uint64_t version,
+    uint64_t cookie_version,
+    GetCookiesStringCallback callback,
+    const std::string& cookies) {
+  DCHECK_CURRENTLY_ON(content::BrowserThread::IO);
+  // A change reported while the read was in flight may or may not be in
+  // |cookies|, so it is only passed on.
+  if (version == cache_version_ &&
+      cookie_version == CookieVersionFor(key.first) &&
+      watched_keys_.count(key)) {
+    cookie_cache_[key] = {cookies, base::TimeTicks::Now(), cookie_version};
+  }
+  std::move(callback).Run(cookies);
+}
+
 // static
 void XwalkProxyingRestrictedCookieManager::CreateAndBindOnIoThread(
     network::mojom::RestrictedCookieManagerPtrInfo underlying_rcm,
@@ -8,8 +8,16 @@
 #ifndef XWALK_RUNTIME_BROWSER_NETWORK_SERVICES_XWALK_PROXYING_RESTRICTED_COOKIE_MANAGER_H_
 #define XWALK_RUNTIME_BROWSER_NETWORK_SERVICES_XWALK_PROXYING_RESTRICTED_COOKIE_MANAGER_H_
 
+#include <stdint.h>
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+
 #include "base/macros.h"
 #include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
 #include "services/network/public/mojom/restricted_cookie_manager.mojom.h"
 #include "url/gurl.h"
 
@@ -46,7 +54,27 @@ class XwalkProxyingRestrictedCookieManager : public network::mojom::RestrictedCo
   // This one is internal.
   bool AllowCookies(const GURL& url, const GURL& site_for_cookies) const;
 
+  // Drops the cached cookie strings. Called when the cookie store reports a
+  // change for a cached URL.
+  void InvalidateCookieCache();
+
+  // Moves the cookie version of the site of |url|, which makes every frame
+  // read the cookies of that site from the network service again. Called on
+  // the IO thread for responses that set cookies and around document.cookie
+  // writes, before the frame can see the change.
+  static void OnCookiesChanged(const GURL& url);
+
  private:
+  // The URL and site for cookies of a GetCookiesString() call.
+  using CacheKey = std::pair<GURL, GURL>;
+
+  struct CachedCookies {
+    std::string cookies;
+    base::TimeTicks fetch_time;
+    // The cookie version of the URL's site when the read was sent.
+    uint64_t cookie_version;
+  };
+
   XwalkProxyingRestrictedCookieManager(network::mojom::RestrictedCookieManagerPtr underlying_restricted_cookie_manager,
                                        bool is_service_worker, int process_id, int frame_id);
 
@@ -54,11 +82,25 @@ class XwalkProxyingRestrictedCookieManager : public network::mojom::RestrictedCo
                                       bool is_service_worker, int process_id, int frame_id,
                                       network::mojom::RestrictedCookieManagerRequest request);
 
+  // Subscribes to the changes of |key| so its cached string can be trusted.
+  void WatchCookieChanges(const CacheKey& key);
+  void OnGotCookiesString(const CacheKey& key, uint64_t version, uint64_t cookie_version,
+                          GetCookiesStringCallback callback, const std::string& cookies);
+
   network::mojom::RestrictedCookieManagerPtr underlying_restricted_cookie_manager_;
   bool is_service_worker_;
   int process_id_;
   int frame_id_;
 
+  // document.cookie reads of the frame, answered without asking the network
+  // service again while the cookie version of their site stays the same.
+  // Only URLs in |watched_keys_| are cached, and a read is only kept when
+  // neither |cache_version_| nor the cookie version moved while it was in
+  // flight.
+  std::map<CacheKey, CachedCookies> cookie_cache_;
+  std::set<CacheKey> watched_keys_;
+  uint64_t cache_version_;
+
   base::WeakPtrFactory<XwalkProxyingRestrictedCookieManager> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(XwalkProxyingRestrictedCookieManager)
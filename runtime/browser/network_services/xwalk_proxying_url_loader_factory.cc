@@ -15,6 +15,7 @@
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/stringprintf.h"
 #include "base/task/post_task.h"
+#include "base/values.h"
 #include "components/safe_browsing/common/safebrowsing_constants.h"
 #include "content/public/browser/browser_task_traits.h"
 #include "content/public/browser/browser_thread.h"
@@ -34,7 +35,10 @@
 #include "xwalk/runtime/browser/android/xwalk_web_resource_request.h"
 #include "xwalk/runtime/browser/android/xwalk_web_resource_response.h"
 #include "xwalk/runtime/browser/network_services/xwalk_net_helpers.h"
+#include "xwalk/runtime/browser/network_services/xwalk_proxying_restricted_cookie_manager.h"
 #include "xwalk/runtime/browser/network_services/xwalk_stream_reader_url_loader.h"
+#include "xwalk/runtime/browser/runtime_request_timeline.h"
+#include "xwalk/runtime/common/xwalk_runtime_internals.h"
 
 #include "meta_logging.h"
 
@@ -44,6 +48,15 @@ namespace {
 
 const char kAutoLoginHeaderName[] = "X-Auto-Login";
 
+// The network service has stored the cookies of |head| before handing it
+// out. Frames must not answer document.cookie from their cache once they
+// can see the response.
+void NotifyCookiesChanged(const GURL& url,
+                          const network::ResourceResponseHead& head) {
+  if (head.headers && head.headers->HasHeader("Set-Cookie"))
+    XwalkProxyingRestrictedCookieManager::OnCookiesChanged(url);
+}
+
 // Handles intercepted, in-progress requests/responses, so that they can be
 // controlled and modified accordingly.
 class InterceptedRequest : public network::mojom::URLLoader,
@@ -251,9 +264,11 @@ InterceptedRequest::InterceptedRequest(int process_id, uint64_t request_id, int3
       base::BindOnce(&InterceptedRequest::OnURLLoaderClientError, base::Unretained(this)));
   proxied_loader_binding_.set_connection_error_with_reason_handler(
       base::BindOnce(&InterceptedRequest::OnURLLoaderError, base::Unretained(this)));
+  RuntimeRequestTimeline::GetInstance()->OnRequestStarted(this, request_);
 }
 
 InterceptedRequest::~InterceptedRequest() {
+  RuntimeRequestTimeline::GetInstance()->OnRequestDestroyed(this);
   if (error_status_ != net::OK)
     SendErrorCallback(error_status_, false);
 }
@@ -311,6 +326,16 @@ void InterceptedRequest::InterceptResponseReceived(std::unique_ptr<XWalkWebResou
 //                                           base::android::BuildInfo::GetInstance()->host_package_name());
 //  }
 
+  if (XWalkRuntimeInternals::IsEnabled()) {
+    XWalkRuntimeInternals* internals = XWalkRuntimeInternals::GetInstance();
+    if (response)
+      internals->Count(XWalkRuntimeInternals::kInterceptedRequests, 1);
+    base::DictionaryValue params;
+    params.SetString("url", request_.url.possibly_invalid_spec());
+    params.SetBoolean("intercepted", !!response);
+    internals->Emit("Crosswalk.requestIntercepted", params);
+  }
+
   if (response) {
     // non-null response: make sure to use it as an override for the
     // normal network data.
@@ -474,6 +499,8 @@ void InterceptedRequest::OnReceiveResponse(const network::ResourceResponseHead&
     }
   }
 
+  NotifyCookiesChanged(request_.url, head);
+  RuntimeRequestTimeline::GetInstance()->OnResponseReceived(this, head);
   target_client_->OnReceiveResponse(head);
 }
 
@@ -481,6 +508,8 @@ void InterceptedRequest::OnReceiveRedirect(const net::RedirectInfo& redirect_inf
                                            const network::ResourceResponseHead& head) {
   // TODO(timvolodine): handle redirect override.
   request_was_redirected_ = true;
+  NotifyCookiesChanged(request_.url, head);
+  RuntimeRequestTimeline::GetInstance()->OnRedirect(this, redirect_info, head);
   target_client_->OnReceiveRedirect(redirect_info, head);
   request_.url = redirect_info.new_url;
   request_.method = redirect_info.new_method;
@@ -595,6 +624,7 @@ void InterceptedRequest::CallOnComplete(const network::URLLoaderCompletionStatus
   // was no safe browsing error.
   if (status.error_code != net::OK)
     error_status_ = status.error_code;
+  RuntimeRequestTimeline::GetInstance()->OnCompleted(this, status);
 
   if (target_client_)
     target_client_->OnComplete(status);
@@ -623,6 +653,7 @@ void InterceptedRequest::CallOnComplete(const network::URLLoaderCompletionStatus
 void InterceptedRequest::SendErrorAndCompleteImmediately(int error_code) {
   auto status = network::URLLoaderCompletionStatus(error_code);
   SendErrorCallback(status.error_code, false);
+  RuntimeRequestTimeline::GetInstance()->OnCompleted(this, status);
   target_client_->OnComplete(status);
   delete this;
 }
@@ -39,6 +39,7 @@
 #include "xwalk/runtime/browser/xwalk_browser_context.h"
 #include "xwalk/runtime/browser/xwalk_content_browser_client.h"
 #include "xwalk/runtime/browser/xwalk_content_settings.h"
+#include "xwalk/runtime/browser/xwalk_directory_enumerator.h"
 #include "xwalk/runtime/browser/android/xwalk_contents_io_thread_client.h"
 #include "xwalk/runtime/browser/xwalk_runner.h"
 #include "xwalk/runtime/common/xwalk_notification_types.h"
@@ -282,12 +283,7 @@ void Runtime::RunFileChooser(content::RenderFrameHost* render_frame_host, std::u
 
 void Runtime::EnumerateDirectory(content::WebContents* web_contents,
                                  std::unique_ptr<content::FileSelectListener> listener, const base::FilePath& path) {
-  LOG(ERROR) << "iotto " << __func__ << " IMPLEMENT";
-//#if defined(USE_AURA) && defined(OS_LINUX)
-//  NOTIMPLEMENTED();
-//#else
-//  RuntimeFileSelectHelper::EnumerateDirectory(web_contents, request_id, path);
-//#endif
+  XWalkDirectoryEnumerator::Start(web_contents, std::move(listener), path);
 }
 
 void Runtime::DidUpdateFaviconURL(const std::vector<FaviconURL>& candidates) {
@@ -28,6 +28,7 @@
 #include "content/shell/common/shell_switches.h"
 #include "net/base/filename_util.h"
 #include "xwalk/runtime/browser/runtime_platform_util.h"
+#include "xwalk/runtime/browser/xwalk_download_registry.h"
 #include "xwalk/runtime/common/xwalk_paths.h"
 
 #if defined(OS_LINUX)
@@ -42,6 +43,13 @@ using content::BrowserThread;
 
 namespace xwalk {
 
+namespace {
+
+const base::FilePath::CharType kDownloadRegistryFilename[] =
+    FILE_PATH_LITERAL("Download Registry");
+
+}  // namespace
+
 RuntimeDownloadManagerDelegate::RuntimeDownloadManagerDelegate()
     : download_manager_(NULL),
       suppress_prompting_(false) {
@@ -54,9 +62,17 @@ RuntimeDownloadManagerDelegate::~RuntimeDownloadManagerDelegate() {
 
 void RuntimeDownloadManagerDelegate::SetDownloadManager(content::DownloadManager* download_manager) {
   download_manager_ = download_manager;
+  registry_.reset(new XWalkDownloadRegistry(
+      download_manager,
+      download_manager->GetBrowserContext()->GetPath().Append(
+          kDownloadRegistryFilename),
+      base::CreateSequencedTaskRunnerWithTraits(
+          {base::MayBlock(), base::TaskPriority::USER_VISIBLE,
+           base::TaskShutdownBehavior::BLOCK_SHUTDOWN})));
 }
 
 void RuntimeDownloadManagerDelegate::Shutdown() {
+  registry_.reset();
   Release();
 }
 
@@ -87,7 +103,8 @@ bool RuntimeDownloadManagerDelegate::DetermineDownloadTarget(
       download->GetMimeType(),
       "download");
 
-  base::PostTaskWithTraits(FROM_HERE, {base::MayBlock(), base::TaskPriority::BEST_EFFORT},
+  // The user is waiting for the download to start.
+  base::PostTaskWithTraits(FROM_HERE, {base::MayBlock(), base::TaskPriority::USER_VISIBLE},
       base::BindOnce(
           &RuntimeDownloadManagerDelegate::GenerateFilename,
           this, download->GetId(), callback, generated_name,
@@ -111,8 +128,8 @@ bool RuntimeDownloadManagerDelegate::ShouldOpenDownload(
 
 void RuntimeDownloadManagerDelegate::GetNextId(
     const content::DownloadIdCallback& callback) {
-  static uint32_t next_id = download::DownloadItem::kInvalidId + 1;
-  callback.Run(next_id++);
+  DCHECK(registry_);
+  registry_->GetNextId(callback);
 }
 
 void RuntimeDownloadManagerDelegate::GenerateFilename(
@@ -123,6 +140,13 @@ void RuntimeDownloadManagerDelegate::GenerateFilename(
   if (!base::CreateDirectory(suggested_directory)) {
     LOG(ERROR) << "Failed to create directory: "
                << suggested_directory.value();
+    // Fail the download instead of leaving it waiting for a target.
+    base::PostTaskWithTraits(FROM_HERE, {content::BrowserThread::UI},
+        base::BindOnce(callback, base::FilePath(),
+                       download::DownloadItem::TARGET_DISPOSITION_OVERWRITE,
+                       download::DOWNLOAD_DANGER_TYPE_NOT_DANGEROUS,
+                       base::FilePath(),
+                       download::DOWNLOAD_INTERRUPT_REASON_FILE_FAILED));
     return;
   }
 
@@ -6,6 +6,8 @@
 #ifndef XWALK_RUNTIME_BROWSER_RUNTIME_DOWNLOAD_MANAGER_DELEGATE_H_
 #define XWALK_RUNTIME_BROWSER_RUNTIME_DOWNLOAD_MANAGER_DELEGATE_H_
 
+#include <memory>
+
 #include "base/compiler_specific.h"
 #include "base/memory/ref_counted.h"
 #include "content/public/browser/download_manager_delegate.h"
@@ -16,6 +18,8 @@ class DownloadManager;
 }
 namespace xwalk {
 
+class XWalkDownloadRegistry;
+
 class RuntimeDownloadManagerDelegate
     : public content::DownloadManagerDelegate,
       public base::RefCountedThreadSafe<RuntimeDownloadManagerDelegate> {
@@ -37,6 +41,8 @@ class RuntimeDownloadManagerDelegate
   void SetDownloadBehaviorForTesting(
       const base::FilePath& default_download_path);
 
+  XWalkDownloadRegistry* registry() const { return registry_.get(); }
+
  protected:
   // To allow subclasses for testing.
   ~RuntimeDownloadManagerDelegate() override;
@@ -56,6 +62,9 @@ class RuntimeDownloadManagerDelegate
                           const base::FilePath& suggested_path);
 
   content::DownloadManager* download_manager_;
+  // Persists unfinished downloads so they resume after a restart, and hands
+  // out the download ids.
+  std::unique_ptr<XWalkDownloadRegistry> registry_;
   base::FilePath default_download_path_;
   bool suppress_prompting_;
 
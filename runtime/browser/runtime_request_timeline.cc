@@ -0,0 +1,345 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/runtime_request_timeline.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/strings/stringprintf.h"
+#include "base/task/post_task.h"
+#include "content/public/browser/browser_task_traits.h"
+#include "content/public/browser/browser_thread.h"
+#include "net/base/net_errors.h"
+#include "net/http/http_response_headers.h"
+#include "net/url_request/redirect_info.h"
+#include "services/network/public/cpp/resource_request.h"
+#include "services/network/public/cpp/resource_response.h"
+#include "services/network/public/cpp/url_loader_completion_status.h"
+#include "url/origin.h"
+
+using content::BrowserThread;
+
+namespace xwalk {
+
+namespace {
+
+// HAR wants -1 for timings that do not apply.
+double Milliseconds(base::TimeTicks begin, base::TimeTicks end) {
+  if (begin.is_null() || end.is_null() || end < begin)
+    return -1;
+  return (end - begin).InMillisecondsF();
+}
+
+double NonNegative(double milliseconds) {
+  return milliseconds < 0 ? 0 : milliseconds;
+}
+
+std::string FormatTime(base::Time time) {
+  base::Time::Exploded exploded;
+  time.UTCExplode(&exploded);
+  return base::StringPrintf("%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+                            exploded.year, exploded.month,
+                            exploded.day_of_month, exploded.hour,
+                            exploded.minute, exploded.second,
+                            exploded.millisecond);
+}
+
+base::Value BuildTimings(const RuntimeRequestTimeline::Entry& entry) {
+  const net::LoadTimingInfo& timing = entry.load_timing;
+  const net::LoadTimingInfo::ConnectTiming& connect = timing.connect_timing;
+  base::Value timings(base::Value::Type::DICTIONARY);
+  timings.SetDoubleKey("blocked", -1);
+  timings.SetDoubleKey("dns",
+                       Milliseconds(connect.dns_start, connect.dns_end));
+  timings.SetDoubleKey("connect", Milliseconds(connect.connect_start,
+                                               connect.connect_end));
+  timings.SetDoubleKey("ssl", Milliseconds(connect.ssl_start,
+                                           connect.ssl_end));
+  // Responses from the cache have no send timing, they waited from the start
+  // of the transaction.
+  const base::TimeTicks wait_start = !timing.send_end.is_null()
+                                         ? timing.send_end
+                                         : entry.transaction_start;
+  timings.SetDoubleKey(
+      "send", NonNegative(Milliseconds(timing.send_start, timing.send_end)));
+  timings.SetDoubleKey(
+      "wait", NonNegative(Milliseconds(wait_start, entry.response_started)));
+  timings.SetDoubleKey("receive", NonNegative(Milliseconds(
+                                      entry.response_started, entry.completed)));
+  return timings;
+}
+
+base::Value BuildPhases(const RuntimeRequestTimeline::Entry& entry) {
+  base::Value phases(base::Value::Type::DICTIONARY);
+  phases.SetDoubleKey("transactionStart",
+                      Milliseconds(entry.start, entry.transaction_start));
+  phases.SetDoubleKey("headersReceived",
+                      Milliseconds(entry.start, entry.headers_received));
+  phases.SetDoubleKey("responseStarted",
+                      Milliseconds(entry.start, entry.response_started));
+  phases.SetDoubleKey("completed", Milliseconds(entry.start, entry.completed));
+  return phases;
+}
+
+base::Value BuildEntry(const RuntimeRequestTimeline::Entry& entry) {
+  base::Value request(base::Value::Type::DICTIONARY);
+  request.SetStringKey("method", entry.method);
+  request.SetStringKey("url", entry.url.spec());
+  request.SetStringKey("httpVersion", "");
+  request.SetKey("headers", base::Value(base::Value::Type::LIST));
+  request.SetKey("queryString", base::Value(base::Value::Type::LIST));
+  request.SetKey("cookies", base::Value(base::Value::Type::LIST));
+  request.SetIntKey("headersSize", -1);
+  request.SetIntKey("bodySize", -1);
+
+  base::Value content(base::Value::Type::DICTIONARY);
+  content.SetDoubleKey("size", static_cast<double>(entry.content_bytes));
+  content.SetStringKey("mimeType", entry.mime_type);
+
+  base::Value response(base::Value::Type::DICTIONARY);
+  response.SetIntKey("status", entry.status);
+  response.SetStringKey("statusText", entry.status_text);
+  response.SetStringKey("httpVersion", "");
+  response.SetKey("headers", base::Value(base::Value::Type::LIST));
+  response.SetKey("cookies", base::Value(base::Value::Type::LIST));
+  response.SetKey("content", std::move(content));
+  response.SetStringKey("redirectURL", "");
+  response.SetIntKey("headersSize", -1);
+  response.SetDoubleKey("bodySize", static_cast<double>(entry.content_bytes));
+  response.SetDoubleKey("_transferSize",
+                        static_cast<double>(entry.network_bytes));
+  if (entry.net_error != net::OK)
+    response.SetStringKey("_error", net::ErrorToString(entry.net_error));
+
+  base::Value redirects(base::Value::Type::LIST);
+  for (const GURL& url : entry.redirects)
+    redirects.GetList().emplace_back(url.spec());
+
+  base::Value har_entry(base::Value::Type::DICTIONARY);
+  har_entry.SetStringKey("startedDateTime", FormatTime(entry.start_time));
+  har_entry.SetDoubleKey(
+      "time", NonNegative(Milliseconds(entry.start, entry.completed)));
+  har_entry.SetKey("request", std::move(request));
+  har_entry.SetKey("response", std::move(response));
+  har_entry.SetKey("cache", base::Value(base::Value::Type::DICTIONARY));
+  har_entry.SetKey("timings", BuildTimings(entry));
+  har_entry.SetBoolKey("_fromCache", entry.was_cached);
+  har_entry.SetKey("_redirects", std::move(redirects));
+  har_entry.SetKey("_phases", BuildPhases(entry));
+  return har_entry;
+}
+
+base::Value ExportOnIO() {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  return RuntimeRequestTimeline::GetInstance()->ExportAsHar();
+}
+
+}  // namespace
+
+const size_t RuntimeRequestTimeline::kMaxEntries;
+const size_t RuntimeRequestTimeline::kMaxOrigins;
+const char RuntimeRequestTimeline::kOtherOrigins[] = "(other)";
+
+RuntimeRequestTimeline::Entry::Entry()
+    : network_bytes(0),
+      content_bytes(0),
+      was_cached(false),
+      net_error(net::OK),
+      status(0) {}
+
+RuntimeRequestTimeline::Entry::Entry(const Entry& other) = default;
+
+RuntimeRequestTimeline::Entry::Entry(Entry&& other) = default;
+
+RuntimeRequestTimeline::Entry::~Entry() {}
+
+RuntimeRequestTimeline::Entry& RuntimeRequestTimeline::Entry::operator=(
+    const Entry& other) = default;
+
+RuntimeRequestTimeline::Entry& RuntimeRequestTimeline::Entry::operator=(
+    Entry&& other) = default;
+
+RuntimeRequestTimeline::OriginStats::OriginStats()
+    : requests(0), cache_hits(0), failures(0), network_bytes(0) {}
+
+// static
+RuntimeRequestTimeline* RuntimeRequestTimeline::GetInstance() {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+  static base::NoDestructor<RuntimeRequestTimeline> instance;
+  return instance.get();
+}
+
+// static
+void RuntimeRequestTimeline::GetHar(
+    base::OnceCallback<void(base::Value har)> callback) {
+  base::PostTaskWithTraitsAndReplyWithResult(
+      FROM_HERE, {BrowserThread::IO}, base::BindOnce(&ExportOnIO),
+      std::move(callback));
+}
+
+// static
+void RuntimeRequestTimeline::ClearAll(base::OnceClosure done) {
+  base::PostTaskWithTraitsAndReply(
+      FROM_HERE, {BrowserThread::IO},
+      base::BindOnce([] { GetInstance()->Clear(); }), std::move(done));
+}
+
+RuntimeRequestTimeline::RuntimeRequestTimeline() : enabled_(true), next_(0) {}
+
+RuntimeRequestTimeline::~RuntimeRequestTimeline() {}
+
+void RuntimeRequestTimeline::OnRequestStarted(
+    const void* request,
+    const network::ResourceRequest& resource_request) {
+  if (!enabled_)
+    return;
+  std::unique_ptr<Entry> entry(new Entry);
+  entry->url = resource_request.url;
+  entry->method = resource_request.method;
+  entry->start_time = base::Time::Now();
+  entry->start = base::TimeTicks::Now();
+  active_[request] = std::move(entry);
+}
+
+void RuntimeRequestTimeline::OnRedirect(
+    const void* request,
+    const net::RedirectInfo& redirect_info,
+    const network::ResourceResponseHead& head) {
+  Entry* entry = FindActive(request);
+  if (!entry)
+    return;
+  entry->redirects.push_back(redirect_info.new_url);
+  // Counts every hop so far, as the completion status does.
+  entry->network_bytes = head.encoded_data_length;
+  if (entry->transaction_start.is_null())
+    entry->transaction_start = head.request_start;
+}
+
+void RuntimeRequestTimeline::OnResponseReceived(
+    const void* request,
+    const network::ResourceResponseHead& head) {
+  Entry* entry = FindActive(request);
+  if (!entry)
+    return;
+  entry->response_started = base::TimeTicks::Now();
+  if (entry->transaction_start.is_null())
+    entry->transaction_start = head.request_start;
+  // Responses from the cache or shouldInterceptRequest have no network
+  // timing, their headers were there when the response started.
+  entry->headers_received = !head.load_timing.receive_headers_end.is_null()
+                                ? head.load_timing.receive_headers_end
+                                : head.response_start;
+  entry->load_timing = head.load_timing;
+  entry->was_cached = head.was_fetched_via_cache;
+  entry->mime_type = head.mime_type;
+  if (head.headers) {
+    entry->status = head.headers->response_code();
+    entry->status_text = head.headers->GetStatusText();
+  }
+}
+
+void RuntimeRequestTimeline::OnCompleted(
+    const void* request,
+    const network::URLLoaderCompletionStatus& status) {
+  Entry* entry = FindActive(request);
+  if (!entry)
+    return;
+  entry->network_bytes = status.encoded_data_length;
+  entry->content_bytes = status.decoded_body_length;
+  Finish(request, status.error_code);
+}
+
+void RuntimeRequestTimeline::OnRequestDestroyed(const void* request) {
+  Finish(request, net::ERR_ABORTED);
+}
+
+std::vector<RuntimeRequestTimeline::Entry>
+RuntimeRequestTimeline::GetEntries() const {
+  std::vector<Entry> entries;
+  entries.reserve(ring_.size());
+  // Until the ring is full |next_| is 0 and the entries are in order.
+  for (size_t i = 0; i < ring_.size(); ++i)
+    entries.push_back(ring_[(next_ + i) % ring_.size()]);
+  return entries;
+}
+
+base::Value RuntimeRequestTimeline::ExportAsHar() const {
+  base::Value creator(base::Value::Type::DICTIONARY);
+  creator.SetStringKey("name", "Crosswalk");
+  creator.SetStringKey("version", XWALK_VERSION);
+
+  base::Value entries(base::Value::Type::LIST);
+  for (const Entry& entry : GetEntries())
+    entries.GetList().push_back(BuildEntry(entry));
+
+  base::Value origins(base::Value::Type::DICTIONARY);
+  for (const auto& origin : origin_stats_) {
+    const OriginStats& stats = origin.second;
+    base::Value value(base::Value::Type::DICTIONARY);
+    value.SetIntKey("requests", stats.requests);
+    value.SetIntKey("cacheHits", stats.cache_hits);
+    value.SetIntKey("failures", stats.failures);
+    value.SetDoubleKey("networkBytes",
+                       static_cast<double>(stats.network_bytes));
+    value.SetDoubleKey("totalTime", stats.total_time.InMillisecondsF());
+    origins.SetKey(origin.first, std::move(value));
+  }
+
+  base::Value log(base::Value::Type::DICTIONARY);
+  log.SetStringKey("version", "1.2");
+  log.SetKey("creator", std::move(creator));
+  log.SetKey("entries", std::move(entries));
+  log.SetKey("_origins", std::move(origins));
+
+  base::Value har(base::Value::Type::DICTIONARY);
+  har.SetKey("log", std::move(log));
+  return har;
+}
+
+void RuntimeRequestTimeline::Clear() {
+  active_.clear();
+  ring_.clear();
+  next_ = 0;
+  origin_stats_.clear();
+}
+
+RuntimeRequestTimeline::Entry* RuntimeRequestTimeline::FindActive(
+    const void* request) {
+  auto it = active_.find(request);
+  return it == active_.end() ? nullptr : it->second.get();
+}
+
+void RuntimeRequestTimeline::Finish(const void* request, int net_error) {
+  auto it = active_.find(request);
+  if (it == active_.end())
+    return;
+  std::unique_ptr<Entry> entry = std::move(it->second);
+  active_.erase(it);
+
+  entry->completed = base::TimeTicks::Now();
+  entry->net_error = net_error;
+
+  std::string origin = url::Origin::Create(entry->url).Serialize();
+  if (!origin_stats_.count(origin) && origin_stats_.size() >= kMaxOrigins)
+    origin = kOtherOrigins;
+  OriginStats& stats = origin_stats_[origin];
+  ++stats.requests;
+  if (entry->was_cached)
+    ++stats.cache_hits;
+  if (net_error != net::OK)
+    ++stats.failures;
+  stats.network_bytes += entry->network_bytes;
+  stats.total_time += entry->completed - entry->start;
+
+  if (ring_.size() < kMaxEntries) {
+    ring_.push_back(std::move(*entry));
+  } else {
+    ring_[next_] = std::move(*entry);
+    next_ = (next_ + 1) % kMaxEntries;
+  }
+}
+
+}  // namespace xwalk
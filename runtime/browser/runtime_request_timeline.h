@@ -0,0 +1,154 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_BROWSER_RUNTIME_REQUEST_TIMELINE_H_
+#define XWALK_RUNTIME_BROWSER_RUNTIME_REQUEST_TIMELINE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/macros.h"
+#include "base/no_destructor.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "net/base/load_timing_info.h"
+#include "url/gurl.h"
+
+namespace net {
+struct RedirectInfo;
+}
+
+namespace network {
+struct ResourceRequest;
+struct ResourceResponseHead;
+struct URLLoaderCompletionStatus;
+}
+
+namespace xwalk {
+
+// Records where the time of each URL request went: phase timestamps, the
+// redirect chain, bytes received, whether the response came from the cache
+// and how it ended. The requests of every frame and worker go through
+// XWalkProxyingURLLoaderFactory, which feeds it with what the network
+// service reports; each request is known by its proxy.
+//
+// Everything lives on the IO thread, so recording takes no lock. Finished
+// requests go into a fixed size ring that drops the oldest entry, and are
+// also summed up per origin, for a bounded number of origins. The whole lot
+// can be exported as HAR 1.2, extra fields are prefixed with '_' as the
+// format allows. DevTools clients get it with Crosswalk.getRequestTimeline.
+class RuntimeRequestTimeline {
+ public:
+  // Number of finished requests kept.
+  static const size_t kMaxEntries = 256;
+  // Origins past this many are summed up under kOtherOrigins.
+  static const size_t kMaxOrigins = 64;
+  static const char kOtherOrigins[];
+
+  struct Entry {
+    Entry();
+    Entry(const Entry& other);
+    Entry(Entry&& other);
+    ~Entry();
+    Entry& operator=(const Entry& other);
+    Entry& operator=(Entry&& other);
+
+    GURL url;
+    std::string method;
+    // Every URL redirected to, in order; the last one was loaded.
+    std::vector<GURL> redirects;
+    base::Time start_time;
+    base::TimeTicks start;
+    // When the network service started and got the headers of the last hop.
+    base::TimeTicks transaction_start;
+    base::TimeTicks headers_received;
+    // When the response reached the proxy.
+    base::TimeTicks response_started;
+    base::TimeTicks completed;
+    net::LoadTimingInfo load_timing;
+    int64_t network_bytes;
+    int64_t content_bytes;
+    bool was_cached;
+    int net_error;
+    int status;
+    std::string status_text;
+    std::string mime_type;
+  };
+
+  struct OriginStats {
+    OriginStats();
+
+    int requests;
+    int cache_hits;
+    int failures;
+    int64_t network_bytes;
+    base::TimeDelta total_time;
+  };
+
+  // Must be used on the IO thread only.
+  static RuntimeRequestTimeline* GetInstance();
+
+  // Runs |callback| on the calling thread with the HAR export, from any
+  // thread.
+  static void GetHar(base::OnceCallback<void(base::Value har)> callback);
+
+  // Clear()s the timeline on the IO thread and runs |done| on the calling
+  // thread, from any thread. Used on zone switches and when history is
+  // removed.
+  static void ClearAll(base::OnceClosure done);
+
+  // Recording is on by default. Requests in flight when it is turned off are
+  // still finished.
+  void set_enabled(bool enabled) { enabled_ = enabled; }
+  bool enabled() const { return enabled_; }
+
+  void OnRequestStarted(const void* request,
+                        const network::ResourceRequest& resource_request);
+  void OnRedirect(const void* request,
+                  const net::RedirectInfo& redirect_info,
+                  const network::ResourceResponseHead& head);
+  void OnResponseReceived(const void* request,
+                          const network::ResourceResponseHead& head);
+  void OnCompleted(const void* request,
+                   const network::URLLoaderCompletionStatus& status);
+  // Requests destroyed before they completed are recorded as aborted.
+  void OnRequestDestroyed(const void* request);
+
+  // Oldest first.
+  std::vector<Entry> GetEntries() const;
+  const std::map<std::string, OriginStats>& origin_stats() const {
+    return origin_stats_;
+  }
+  base::Value ExportAsHar() const;
+  // Drops the finished requests, the origin stats and the requests in
+  // flight, which are then not recorded when they finish.
+  void Clear();
+
+ private:
+  RuntimeRequestTimeline();
+  ~RuntimeRequestTimeline();
+  friend class base::NoDestructor<RuntimeRequestTimeline>;
+
+  Entry* FindActive(const void* request);
+  void Finish(const void* request, int net_error);
+
+  bool enabled_;
+  std::map<const void*, std::unique_ptr<Entry>> active_;
+  // |ring_| grows up to kMaxEntries, then |next_| wraps around it.
+  std::vector<Entry> ring_;
+  size_t next_;
+  std::map<std::string, OriginStats> origin_stats_;
+
+  DISALLOW_COPY_AND_ASSIGN(RuntimeRequestTimeline);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_BROWSER_RUNTIME_REQUEST_TIMELINE_H_
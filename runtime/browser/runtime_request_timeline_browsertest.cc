@@ -0,0 +1,294 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/runtime_request_timeline.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/task/post_task.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "content/public/browser/browser_task_traits.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/test/browser_test_utils.h"
+#include "net/http/http_status_code.h"
+#include "net/test/embedded_test_server/embedded_test_server.h"
+#include "net/test/embedded_test_server/http_request.h"
+#include "net/test/embedded_test_server/http_response.h"
+#include "url/origin.h"
+#include "xwalk/runtime/browser/runtime.h"
+#include "xwalk/runtime/browser/xwalk_browser_context.h"
+#include "xwalk/runtime/browser/xwalk_browsing_data_remover.h"
+#include "xwalk/test/base/in_process_browser_test.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+#include "xwalk/test/base/xwalk_test_utils.h"
+
+using content::BrowserThread;
+using xwalk::Runtime;
+using xwalk::RuntimeRequestTimeline;
+
+namespace {
+
+const size_t kBodySize = 4096;
+// More than the ring holds.
+const int kOverheadRequests = 300;
+
+// Fetches a URL from the page and sends the length of the body once it was
+// read.
+const char kFetchScript[] =
+    "fetch('%s').then(function(response) {"
+    "  return response.text();"
+    "}).then(function(text) {"
+    "  window.domAutomationController.send(text.length);"
+    "});";
+
+std::unique_ptr<net::test_server::HttpResponse> HandleRequest(
+    const net::test_server::HttpRequest& request) {
+  std::unique_ptr<net::test_server::BasicHttpResponse> response(
+      new net::test_server::BasicHttpResponse);
+  const std::string path = request.GetURL().path();
+  if (path == "/redirect") {
+    response->set_code(net::HTTP_FOUND);
+    response->AddCustomHeader("Location", "/page");
+    return std::move(response);
+  }
+  response->set_content_type("text/html");
+  response->set_content(std::string(kBodySize, 'x'));
+  response->AddCustomHeader(
+      "Cache-Control", path == "/cached" ? "max-age=3600" : "no-store");
+  return std::move(response);
+}
+
+void RunOnIO(base::OnceClosure task) {
+  base::RunLoop run_loop;
+  base::PostTaskWithTraitsAndReply(FROM_HERE, {BrowserThread::IO},
+                                   std::move(task), run_loop.QuitClosure());
+  run_loop.Run();
+}
+
+void ClearTimeline() {
+  RuntimeRequestTimeline::GetInstance()->Clear();
+}
+
+void SetTimelineEnabled(bool enabled) {
+  RuntimeRequestTimeline::GetInstance()->set_enabled(enabled);
+}
+
+void OnHar(base::RunLoop* run_loop, base::Value* out, base::Value har) {
+  *out = std::move(har);
+  run_loop->Quit();
+}
+
+double GetDouble(const base::Value& value, base::StringPiece path) {
+  const base::Value* found = value.FindPath(path);
+  EXPECT_TRUE(found) << path;
+  return found ? found->GetDouble() : -1;
+}
+
+}  // namespace
+
+class RuntimeRequestTimelineBrowserTest : public InProcessBrowserTest {
+ protected:
+  void SetUp() override {
+    embedded_test_server()->RegisterRequestHandler(
+        base::BindRepeating(&HandleRequest));
+    ASSERT_TRUE(embedded_test_server()->Start());
+    InProcessBrowserTest::SetUp();
+  }
+
+  void SetUpOnMainThread() override {
+    runtime_ = CreateRuntime(GURL());
+    RunOnIO(base::BindOnce(&ClearTimeline));
+  }
+
+  // Loads |path| from the page the runtime shows, as a script would.
+  void Fetch(const std::string& path) {
+    int length = 0;
+    ASSERT_TRUE(content::ExecuteScriptAndExtractInt(
+        runtime_->web_contents(),
+        base::StringPrintf(kFetchScript, path.c_str()), &length));
+    EXPECT_EQ(static_cast<int>(kBodySize), length);
+  }
+
+  base::Value GetHar() {
+    base::Value har;
+    base::RunLoop run_loop;
+    RuntimeRequestTimeline::GetHar(
+        base::BindOnce(&OnHar, &run_loop, &har));
+    run_loop.Run();
+    return har;
+  }
+
+  // The HAR entries of requests for |path|, anything else the page loaded
+  // is left out.
+  std::vector<base::Value> GetEntries(const base::Value& har,
+                                      const std::string& path) {
+    std::vector<base::Value> entries;
+    const base::Value* list = har.FindPath("log.entries");
+    EXPECT_TRUE(list && list->is_list());
+    if (!list)
+      return entries;
+    const std::string url = embedded_test_server()->GetURL(path).spec();
+    for (const base::Value& entry : list->GetList()) {
+      const base::Value* request_url = entry.FindPath("request.url");
+      if (request_url && request_url->GetString() == url)
+        entries.push_back(entry.Clone());
+    }
+    return entries;
+  }
+
+  const base::Value* GetOriginStats(const base::Value& har) {
+    const base::Value* origins = har.FindPath("log._origins");
+    EXPECT_TRUE(origins);
+    if (!origins)
+      return nullptr;
+    return origins->FindKey(
+        url::Origin::Create(embedded_test_server()->base_url()).Serialize());
+  }
+
+  Runtime* runtime_ = nullptr;
+};
+
+IN_PROC_BROWSER_TEST_F(RuntimeRequestTimelineBrowserTest,
+                       RecordsPhasesAndRedirects) {
+  xwalk_test_utils::NavigateToURL(
+      runtime_, embedded_test_server()->GetURL("/redirect"));
+  EXPECT_EQ(embedded_test_server()->GetURL("/page"),
+            runtime_->web_contents()->GetLastCommittedURL());
+
+  base::Value har = GetHar();
+  EXPECT_EQ("1.2", har.FindPath("log.version")->GetString());
+  std::vector<base::Value> entries = GetEntries(har, "/redirect");
+  ASSERT_EQ(1u, entries.size());
+  const base::Value& entry = entries[0];
+
+  EXPECT_EQ("GET", entry.FindPath("request.method")->GetString());
+  const base::Value* redirects = entry.FindKey("_redirects");
+  ASSERT_TRUE(redirects);
+  ASSERT_EQ(1u, redirects->GetList().size());
+  EXPECT_EQ(embedded_test_server()->GetURL("/page").spec(),
+            redirects->GetList()[0].GetString());
+
+  EXPECT_EQ(200, entry.FindPath("response.status")->GetInt());
+  EXPECT_EQ("text/html",
+            entry.FindPath("response.content.mimeType")->GetString());
+  EXPECT_EQ(static_cast<double>(kBodySize),
+            GetDouble(entry, "response.content.size"));
+  // Both hops went over the network, headers included.
+  EXPECT_GT(GetDouble(entry, "response._transferSize"),
+            static_cast<double>(kBodySize));
+  EXPECT_FALSE(entry.FindKey("_fromCache")->GetBool());
+  EXPECT_FALSE(entry.FindPath("response._error"));
+
+  const double transaction_start =
+      GetDouble(entry, "_phases.transactionStart");
+  const double headers_received = GetDouble(entry, "_phases.headersReceived");
+  const double response_started = GetDouble(entry, "_phases.responseStarted");
+  const double completed = GetDouble(entry, "_phases.completed");
+  EXPECT_GE(transaction_start, 0);
+  EXPECT_GE(headers_received, transaction_start);
+  EXPECT_GE(response_started, headers_received);
+  EXPECT_GE(completed, response_started);
+  EXPECT_DOUBLE_EQ(completed, GetDouble(entry, "time"));
+  EXPECT_GE(GetDouble(entry, "timings.wait"), 0);
+  EXPECT_GE(GetDouble(entry, "timings.receive"), 0);
+
+  const base::Value* stats = GetOriginStats(har);
+  ASSERT_TRUE(stats);
+  EXPECT_GE(stats->FindKey("requests")->GetInt(), 1);
+  EXPECT_EQ(0, stats->FindKey("failures")->GetInt());
+}
+
+IN_PROC_BROWSER_TEST_F(RuntimeRequestTimelineBrowserTest, RecordsCacheHits) {
+  xwalk_test_utils::NavigateToURL(runtime_,
+                                  embedded_test_server()->GetURL("/page"));
+  Fetch("/cached");
+  Fetch("/cached");
+
+  base::Value har = GetHar();
+  std::vector<base::Value> entries = GetEntries(har, "/cached");
+  ASSERT_EQ(2u, entries.size());
+  EXPECT_FALSE(entries[0].FindKey("_fromCache")->GetBool());
+  EXPECT_TRUE(entries[1].FindKey("_fromCache")->GetBool());
+  EXPECT_EQ(0, GetDouble(entries[1], "response._transferSize"));
+  EXPECT_EQ(static_cast<double>(kBodySize),
+            GetDouble(entries[1], "response.content.size"));
+  EXPECT_EQ(200, entries[1].FindPath("response.status")->GetInt());
+
+  const base::Value* stats = GetOriginStats(har);
+  ASSERT_TRUE(stats);
+  EXPECT_GE(stats->FindKey("cacheHits")->GetInt(), 1);
+}
+
+// The timeline lists the URLs loaded lately, removing history drops it.
+IN_PROC_BROWSER_TEST_F(RuntimeRequestTimelineBrowserTest,
+                       HistoryRemovalClearsTimeline) {
+  xwalk_test_utils::NavigateToURL(runtime_,
+                                  embedded_test_server()->GetURL("/page"));
+  ASSERT_EQ(1u, GetEntries(GetHar(), "/page").size());
+
+  base::RunLoop run_loop;
+  xwalk::XWalkBrowserContext::GetDefault()
+      ->GetXWalkBrowsingDataRemover()
+      ->Remove(base::Time(), base::Time::Max(),
+               xwalk::XWalkBrowsingDataRemover::DATA_TYPE_HISTORY,
+               std::set<url::Origin>(),
+               base::BindOnce(
+                   [](base::RunLoop* run_loop,
+                      const xwalk::XWalkBrowsingDataRemover::Result&) {
+                     run_loop->Quit();
+                   },
+                   &run_loop));
+  run_loop.Run();
+
+  base::Value har = GetHar();
+  EXPECT_TRUE(har.FindPath("log.entries")->GetList().empty());
+  EXPECT_FALSE(GetOriginStats(har));
+}
+
+// Fetches the same URL with the recorder on and off, alternately so both see
+// the same warm connections, and reports the difference per request.
+IN_PROC_BROWSER_TEST_F(RuntimeRequestTimelineBrowserTest, RecordingOverhead) {
+  xwalk_test_utils::NavigateToURL(runtime_,
+                                  embedded_test_server()->GetURL("/page"));
+  // Opens the connection.
+  Fetch("/page");
+  RunOnIO(base::BindOnce(&ClearTimeline));
+
+  std::vector<double> recorded_us;
+  std::vector<double> unrecorded_us;
+  for (int i = 0; i < 2 * kOverheadRequests; ++i) {
+    const bool enabled = i % 2 == 0;
+    RunOnIO(base::BindOnce(&SetTimelineEnabled, enabled));
+    const base::TimeTicks start = base::TimeTicks::Now();
+    Fetch("/page");
+    (enabled ? recorded_us : unrecorded_us)
+        .push_back((base::TimeTicks::Now() - start).InMicrosecondsF());
+  }
+  RunOnIO(base::BindOnce(&SetTimelineEnabled, true));
+
+  // The ring kept only the newest requests.
+  base::Value har = GetHar();
+  EXPECT_EQ(RuntimeRequestTimeline::kMaxEntries,
+            har.FindPath("log.entries")->GetList().size());
+  const base::Value* stats = GetOriginStats(har);
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(kOverheadRequests, stats->FindKey("requests")->GetInt());
+
+  XWalkBenchmark::Result recorded = XWalkBenchmark::FromSamples(
+      "request_timeline", "_recorded", std::move(recorded_us));
+  XWalkBenchmark::Result unrecorded = XWalkBenchmark::FromSamples(
+      "request_timeline", "_unrecorded", std::move(unrecorded_us));
+  XWalkBenchmark::Report(recorded);
+  XWalkBenchmark::Report(unrecorded);
+  XWalkBenchmark::ReportValue("request_timeline_overhead", "", "us",
+                              recorded.p50 - unrecorded.p50);
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/xwalk_autocomplete_history_manager.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "components/autofill/core/browser/ui/suggestion.h"
+#include "components/autofill/core/browser/validation.h"
+#include "components/autofill/core/common/form_data.h"
+#include "components/autofill/core/common/form_field_data.h"
+#include "xwalk/runtime/browser/xwalk_form_database_service.h"
+#include "xwalk/runtime/browser/xwalk_form_suggestion_index.h"
+
+namespace xwalk {
+
+namespace {
+
+// Longer values are not saved.
+const size_t kMaxValueLength = 1024;
+
+// Same rules as autofill::AutocompleteHistoryManager: nothing the user did
+// not want remembered, and no credit card or social security numbers.
+bool IsSaveable(const autofill::FormFieldData& field) {
+  return field.should_autocomplete && !field.name.empty() &&
+         !field.value.empty() && field.value.size() <= kMaxValueLength &&
+         field.form_control_type != "password" &&
+         !autofill::IsValidCreditCardNumber(field.value) &&
+         !autofill::IsSSN(field.value);
+}
+
+}  // namespace
+
+XWalkAutocompleteHistoryManager::XWalkAutocompleteHistoryManager(
+    XWalkFormDatabaseService* form_database)
+    : form_database_(form_database), weak_factory_(this) {}
+
+XWalkAutocompleteHistoryManager::~XWalkAutocompleteHistoryManager() {}
+
+void XWalkAutocompleteHistoryManager::OnGetAutocompleteSuggestions(
+    int query_id,
+    bool is_autocomplete_enabled,
+    bool autoselect_first_suggestion,
+    const base::string16& name,
+    const base::string16& prefix,
+    const std::string& form_control_type,
+    base::WeakPtr<SuggestionsHandler> handler) {
+  if (!is_autocomplete_enabled || form_control_type == "textarea") {
+    SendSuggestions(query_id, autoselect_first_suggestion, prefix, handler,
+                    std::vector<base::string16>());
+    return;
+  }
+  // Runs right away unless this is the first query for |name|.
+  form_database_->GetFormValuesForElementName(
+      name, prefix, XWalkFormSuggestionIndex::kMaxSuggestions,
+      base::BindOnce(&XWalkAutocompleteHistoryManager::SendSuggestions,
+                     weak_factory_.GetWeakPtr(), query_id,
+                     autoselect_first_suggestion, prefix, handler));
+}
+
+void XWalkAutocompleteHistoryManager::OnWillSubmitForm(
+    const autofill::FormData& form,
+    bool is_autocomplete_enabled) {
+  if (!is_autocomplete_enabled)
+    return;
+
+  std::vector<autofill::FormFieldData> fields;
+  for (const autofill::FormFieldData& field : form.fields) {
+    if (IsSaveable(field))
+      fields.push_back(field);
+  }
+  if (!fields.empty())
+    form_database_->AddFormFields(fields);
+}
+
+void XWalkAutocompleteHistoryManager::OnRemoveAutocompleteEntry(
+    const base::string16& name,
+    const base::string16& value) {
+  form_database_->RemoveFormValueForElementName(name, value);
+}
+
+void XWalkAutocompleteHistoryManager::SendSuggestions(
+    int query_id,
+    bool autoselect_first_suggestion,
+    const base::string16& prefix,
+    base::WeakPtr<SuggestionsHandler> handler,
+    const std::vector<base::string16>& values) {
+  if (!handler)
+    return;
+  std::vector<autofill::Suggestion> suggestions;
+  for (const base::string16& value : values) {
+    if (value != prefix)
+      suggestions.push_back(autofill::Suggestion(value));
+  }
+  handler->OnSuggestionsReturned(query_id, autoselect_first_suggestion,
+                                 suggestions);
+}
+
+}  // namespace xwalk
@@ -0,0 +1,61 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_BROWSER_XWALK_AUTOCOMPLETE_HISTORY_MANAGER_H_
+#define XWALK_RUNTIME_BROWSER_XWALK_AUTOCOMPLETE_HISTORY_MANAGER_H_
+
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "components/autofill/core/browser/autocomplete_history_manager.h"
+
+namespace xwalk {
+
+class XWalkFormDatabaseService;
+
+// Autocomplete for the XWalkViews of a browser context, answered from the
+// in-memory index of |form_database| instead of a database query for every
+// keystroke. Submitted values go to the index and are written back by
+// XWalkFormDatabaseService.
+class XWalkAutocompleteHistoryManager
+    : public autofill::AutocompleteHistoryManager {
+ public:
+  // |form_database| must outlive this.
+  explicit XWalkAutocompleteHistoryManager(
+      XWalkFormDatabaseService* form_database);
+  ~XWalkAutocompleteHistoryManager() override;
+
+  // autofill::AutocompleteHistoryManager:
+  void OnGetAutocompleteSuggestions(
+      int query_id,
+      bool is_autocomplete_enabled,
+      bool autoselect_first_suggestion,
+      const base::string16& name,
+      const base::string16& prefix,
+      const std::string& form_control_type,
+      base::WeakPtr<SuggestionsHandler> handler) override;
+  void OnWillSubmitForm(const autofill::FormData& form,
+                        bool is_autocomplete_enabled) override;
+  void OnRemoveAutocompleteEntry(const base::string16& name,
+                                 const base::string16& value) override;
+
+ private:
+  void SendSuggestions(int query_id,
+                       bool autoselect_first_suggestion,
+                       const base::string16& prefix,
+                       base::WeakPtr<SuggestionsHandler> handler,
+                       const std::vector<base::string16>& values);
+
+  XWalkFormDatabaseService* form_database_;
+
+  base::WeakPtrFactory<XWalkAutocompleteHistoryManager> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkAutocompleteHistoryManager);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_BROWSER_XWALK_AUTOCOMPLETE_HISTORY_MANAGER_H_
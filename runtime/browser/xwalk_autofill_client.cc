@@ -100,10 +100,8 @@ autofill::PersonalDataManager* XWalkAutofillClient::GetPersonalDataManager() {
 
 autofill::AutocompleteHistoryManager*
 XWalkAutofillClient::GetAutocompleteHistoryManager() {
-  // TODO(iotto): implement
-  return nullptr;
-//  return AwBrowserContext::FromWebContents(web_contents_)
-//      ->GetAutocompleteHistoryManager();
+  return XWalkBrowserContext::FromWebContents(web_contents_)
+      ->GetAutocompleteHistoryManager();
 }
 
 //scoped_refptr<autofill::AutofillWebDataService>
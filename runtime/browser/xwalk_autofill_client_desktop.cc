@@ -7,7 +7,7 @@
 
 #include "xwalk/runtime/browser/ui/desktop/xwalk_autofill_popup_controller.h"
 
-DEFINE_WEB_CONTENTS_USER_DATA_KEY(xwalk::XWalkAutofillClientDesktop);
+WEB_CONTENTS_USER_DATA_KEY_IMPL(xwalk::XWalkAutofillClientDesktop)
 
 namespace xwalk {
 
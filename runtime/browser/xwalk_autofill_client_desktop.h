@@ -35,6 +35,7 @@ class XWalkAutofillClientDesktop :
 
   base::WeakPtr<XWalkAutofillPopupController> popup_controller_;
 
+  WEB_CONTENTS_USER_DATA_KEY_DECL();
   DISALLOW_COPY_AND_ASSIGN(XWalkAutofillClientDesktop);
 };
 
@@ -39,7 +39,6 @@ XWalkAutofillManager::~XWalkAutofillManager() {
 XWalkAutofillManager::XWalkAutofillManager(
     content::WebContents* web_contents)
     : web_contents_(web_contents) {
-  LOG(ERROR) << "iotto " << __func__ << " FIX THIS";
 #if defined(OS_ANDROID)
   XWalkAutofillClientAndroid* autofill_manager_delegate =
       XWalkAutofillClientAndroid::FromWebContents(web_contents_);
@@ -72,8 +71,6 @@ void XWalkAutofillManager::UpdateRendererPreferences() {
 }
 
 void XWalkAutofillManager::InitAutofillIfNecessary(bool enabled) {
-  LOG(ERROR) << "iotto " << __func__ << " FIX THIS";
-  return;
   // Do not initialize if the feature is not enabled.
   if (!enabled)
     return;
@@ -84,19 +81,21 @@ void XWalkAutofillManager::InitAutofillIfNecessary(bool enabled) {
   CreateUserPrefServiceIfNecessary();
 #if defined (OS_ANDROID)
   XWalkAutofillClientAndroid::CreateForWebContents(web_contents_);
-  autofill::ContentAutofillDriverFactory::CreateForWebContentsAndDelegate(
-      web_contents_,
-      XWalkAutofillClientAndroid::FromWebContents(web_contents_),
-      base::android::GetDefaultLocaleString(),
-      autofill::AutofillManager::AutofillDownloadManagerState::DISABLE_AUTOFILL_DOWNLOAD_MANAGER);
+  XWalkAutofillClient* client =
+      XWalkAutofillClientAndroid::FromWebContents(web_contents_);
+  const std::string locale = base::android::GetDefaultLocaleString();
 #else
   XWalkAutofillClientDesktop::CreateForWebContents(web_contents_);
+  XWalkAutofillClient* client =
+      XWalkAutofillClientDesktop::FromWebContents(web_contents_);
+  const std::string locale =
+      XWalkContentBrowserClient::Get()->GetApplicationLocale();
+#endif
+  // The client answers IsAutocompleteEnabled() from it.
+  client->SetSaveFormData(true);
   autofill::ContentAutofillDriverFactory::CreateForWebContentsAndDelegate(
-      web_contents_,
-      XWalkAutofillClientDesktop::FromWebContents(web_contents_),
-      XWalkContentBrowserClient::Get()->GetApplicationLocale(),
+      web_contents_, client, locale,
       autofill::AutofillManager::DISABLE_AUTOFILL_DOWNLOAD_MANAGER);
-#endif
 }
 
 void XWalkAutofillManager::CreateUserPrefServiceIfNecessary() {
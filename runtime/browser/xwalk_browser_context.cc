@@ -5,14 +5,17 @@
 
 #include "xwalk/runtime/browser/xwalk_browser_context.h"
 
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "base/bind.h"
 #include "base/command_line.h"
 #include "base/logging.h"
 #include "base/path_service.h"
 #include "base/memory/scoped_refptr.h"
+#include "base/task/post_task.h"
 #include "components/prefs/pref_registry_simple.h"
 #include "components/prefs/pref_service.h"
 #include "components/prefs/pref_service_factory.h"
@@ -37,6 +40,8 @@
 #include "xwalk/application/common/constants.h"
 #include "xwalk/runtime/browser/runtime_download_manager_delegate.h"
 #include "xwalk/runtime/browser/runtime_url_request_context_getter.h"
+#include "xwalk/runtime/browser/xwalk_autocomplete_history_manager.h"
+#include "xwalk/runtime/browser/xwalk_browsing_data_remover.h"
 #include "xwalk/runtime/browser/xwalk_content_settings.h"
 #include "xwalk/runtime/browser/xwalk_permission_manager.h"
 #include "xwalk/runtime/browser/xwalk_pref_store.h"
@@ -58,6 +63,18 @@
 using content::BrowserThread;
 using content::DownloadManager;
 
+namespace {
+
+// How long AddVisitedURLs() batches before updating the visited link table.
+// Short enough that going back to a page shows fresh :visited styles.
+const int kVisitedURLsFlushDelayMs = 100;
+
+// A batch this large is flushed right away. VisitedLinkMaster rewrites its
+// whole file instead of single slots past about this many URLs.
+const size_t kMaxPendingVisitedURLs = 64;
+
+}  // namespace
+
 namespace xwalk {
 
 class XWalkBrowserContext::RuntimeResourceContext :
@@ -109,6 +126,7 @@ XWalkBrowserContext::XWalkBrowserContext()
 }
 
 XWalkBrowserContext::~XWalkBrowserContext() {
+  FlushVisitedURLs();
 #if !defined(OS_ANDROID)
   XWalkContentSettings::GetInstance()->Shutdown();
 #endif
@@ -243,7 +261,11 @@ content::PushMessagingService* XWalkBrowserContext::GetPushMessagingService() {
 
 content::SSLHostStateDelegate* XWalkBrowserContext::GetSSLHostStateDelegate() {
   if (!ssl_host_state_delegate_.get()) {
-    ssl_host_state_delegate_.reset(new XWalkSSLHostStateDelegate());
+    ssl_host_state_delegate_.reset(new XWalkSSLHostStateDelegate(
+        GetPath().Append(FILE_PATH_LITERAL("SSL Exceptions")),
+        base::CreateSequencedTaskRunnerWithTraits(
+            {base::MayBlock(), base::TaskPriority::BEST_EFFORT,
+             base::TaskShutdownBehavior::BLOCK_SHUTDOWN})));
   }
   return ssl_host_state_delegate_.get();
 }
@@ -270,8 +292,13 @@ XWalkBrowserContext::GetBackgroundSyncController() {
 }
 
 content::BrowsingDataRemoverDelegate* XWalkBrowserContext::GetBrowsingDataRemoverDelegate() {
-  LOG(WARNING) << __func__ << " not_implemented";
-  return nullptr;
+  return GetXWalkBrowsingDataRemover();
+}
+
+XWalkBrowsingDataRemover* XWalkBrowserContext::GetXWalkBrowsingDataRemover() {
+  if (!browsing_data_remover_)
+    browsing_data_remover_.reset(new XWalkBrowsingDataRemover(this));
+  return browsing_data_remover_.get();
 }
 
 RuntimeURLRequestContextGetter*
@@ -324,6 +351,16 @@ XWalkFormDatabaseService* XWalkBrowserContext::GetFormDatabaseService() {
   return form_database_service_.get();
 }
 
+autofill::AutocompleteHistoryManager*
+XWalkBrowserContext::GetAutocompleteHistoryManager() {
+  if (!autocomplete_history_manager_ && form_database_service_) {
+    autocomplete_history_manager_ =
+        std::make_unique<XWalkAutocompleteHistoryManager>(
+            form_database_service_.get());
+  }
+  return autocomplete_history_manager_.get();
+}
+
 // Create user pref service for autofill functionality.
 void XWalkBrowserContext::CreateUserPrefServiceIfNecessary() {
   if (user_pref_service_)
@@ -390,13 +427,61 @@ std::string XWalkBrowserContext::GetCSPString() const {
 #endif
 
 void XWalkBrowserContext::InitVisitedLinkMaster() {
+  // With persistence the fingerprint table lives in "Visited Links" under
+  // GetPath(). It is read into shared memory in the background and renderers
+  // get it as soon as it is loaded. The master grows and rehashes it as URLs
+  // come in and writes back only the slots that changed. It is opt-in: the
+  // table is not partitioned by zone, ClearVisitedLinks() is what keeps it
+  // from outliving a zone switch or a removal of the browsing history.
+  const bool persist_to_disk =
+      base::CommandLine::ForCurrentProcess()->HasSwitch(
+          switches::kEnableVisitedLinkPersistence);
   visitedlink_master_.reset(
-                            new visitedlink::VisitedLinkMaster(this, this, false));
+      new visitedlink::VisitedLinkMaster(this, this, persist_to_disk));
   visitedlink_master_->Init();
 }
 
 void XWalkBrowserContext::AddVisitedURLs(const std::vector<GURL>& urls) {
   DCHECK(visitedlink_master_.get());
+  for (const GURL& url : urls) {
+    // Runtime and XWalkRenderViewHostExt both report the redirect chain of
+    // the same navigation, drop the repeats here.
+    if (url.is_valid() && (pending_visited_urls_.empty() ||
+                           pending_visited_urls_.back() != url)) {
+      pending_visited_urls_.push_back(url);
+    }
+  }
+
+  if (pending_visited_urls_.size() >= kMaxPendingVisitedURLs) {
+    FlushVisitedURLs();
+  } else if (!pending_visited_urls_.empty() &&
+             !visited_urls_flush_timer_.IsRunning()) {
+    visited_urls_flush_timer_.Start(
+        FROM_HERE,
+        base::TimeDelta::FromMilliseconds(kVisitedURLsFlushDelayMs),
+        base::BindOnce(&XWalkBrowserContext::FlushVisitedURLs,
+                       base::Unretained(this)));
+  }
+}
+
+void XWalkBrowserContext::ClearVisitedLinks() {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  visited_urls_flush_timer_.Stop();
+  pending_visited_urls_.clear();
+  // Resets the table, its file, and the copy every renderer holds.
+  if (visitedlink_master_)
+    visitedlink_master_->DeleteAllURLs();
+}
+
+void XWalkBrowserContext::FlushVisitedURLs() {
+  visited_urls_flush_timer_.Stop();
+  if (pending_visited_urls_.empty() || !visitedlink_master_)
+    return;
+
+  std::vector<GURL> urls;
+  urls.swap(pending_visited_urls_);
+  std::sort(urls.begin(), urls.end());
+  urls.erase(std::unique(urls.begin(), urls.end()), urls.end());
   visitedlink_master_->AddURLs(urls);
 }
 
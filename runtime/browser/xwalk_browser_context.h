@@ -17,6 +17,7 @@
 #include "base/compiler_specific.h"
 #include "base/files/file_path.h"
 #include "base/memory/ref_counted.h"
+#include "base/timer/timer.h"
 #include "components/visitedlink/browser/visitedlink_delegate.h"
 #include "content/public/browser/browser_context.h"
 #include "content/public/browser/content_browser_client.h"
@@ -46,6 +47,8 @@ class PrefService;
 namespace xwalk {
 
 class RuntimeDownloadManagerDelegate;
+class XWalkAutocompleteHistoryManager;
+class XWalkBrowsingDataRemover;
 
 //namespace application {
 //class ApplicationService;
@@ -93,6 +96,9 @@ class XWalkBrowserContext
   net::URLRequestContextGetter* CreateMediaRequestContext() override;
   RuntimeURLRequestContextGetter* GetURLRequestContextGetterById(
       const std::string& pkg_id);
+  // Clears browsing data of several types at once, see
+  // XWalkBrowsingDataRemover.
+  XWalkBrowsingDataRemover* GetXWalkBrowsingDataRemover();
   void InitFormDatabaseService();
   XWalkFormDatabaseService* GetFormDatabaseService();
   autofill::AutocompleteHistoryManager* GetAutocompleteHistoryManager();
@@ -116,7 +122,11 @@ class XWalkBrowserContext
   std::string GetCSPString() const;
 #endif
   // These methods map to Add methods in visitedlink::VisitedLinkMaster.
+  // URLs are collected for a short while and handed over in one batch, so a
+  // burst of navigations costs a single table update and file write.
   void AddVisitedURLs(const std::vector<GURL>& urls);
+  // Forgets every visited URL, including those not handed over yet.
+  void ClearVisitedLinks();
   // visitedlink::VisitedLinkDelegate implementation.
   void RebuildTable(
       const scoped_refptr<URLEnumerator>& enumerator) override;
@@ -134,6 +144,7 @@ class XWalkBrowserContext
 
   // Reset visitedlink master and initialize it.
   void InitVisitedLinkMaster();
+  void FlushVisitedURLs();
 
 //  application::ApplicationService* application_service_;
   std::unique_ptr<RuntimeResourceContext> resource_context_;
@@ -141,11 +152,16 @@ class XWalkBrowserContext
   scoped_refptr<RuntimeURLRequestContextGetter> url_request_getter_;
   std::unique_ptr<PrefService> user_pref_service_;
   std::unique_ptr<XWalkFormDatabaseService> form_database_service_;
+  // Uses |form_database_service_|, declared after it to be destroyed first.
+  std::unique_ptr<XWalkAutocompleteHistoryManager>
+      autocomplete_history_manager_;
   bool save_form_data_;
 #if defined(OS_ANDROID)
   std::string csp_;
 #endif
   std::unique_ptr<visitedlink::VisitedLinkMaster> visitedlink_master_;
+  std::vector<GURL> pending_visited_urls_;
+  base::OneShotTimer visited_urls_flush_timer_;
 
   typedef std::map<base::FilePath::StringType,
       scoped_refptr<RuntimeURLRequestContextGetter> >
@@ -153,6 +169,7 @@ class XWalkBrowserContext
   PartitionPathContextGetterMap context_getters_;
   std::unique_ptr<XWalkSSLHostStateDelegate> ssl_host_state_delegate_;
   std::unique_ptr<content::PermissionControllerDelegate> permission_manager_;
+  std::unique_ptr<XWalkBrowsingDataRemover> browsing_data_remover_;
   scoped_refptr<XWalkSpecialStoragePolicy> special_storage_policy_;
 
   DISALLOW_COPY_AND_ASSIGN(XWalkBrowserContext);
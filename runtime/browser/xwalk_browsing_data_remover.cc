@@ -0,0 +1,434 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/xwalk_browsing_data_remover.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/barrier_closure.h"
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/task/post_task.h"
+#include "content/public/browser/browser_context.h"
+#include "content/public/browser/browser_task_traits.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/browsing_data_filter_builder.h"
+#include "content/public/browser/download_manager.h"
+#include "content/public/browser/storage_partition.h"
+#include "net/base/registry_controlled_domains/registry_controlled_domain.h"
+#include "services/network/public/mojom/network_context.mojom.h"
+#include "url/gurl.h"
+#include "xwalk/runtime/browser/runtime_download_manager_delegate.h"
+#include "xwalk/runtime/browser/runtime_request_timeline.h"
+#include "xwalk/runtime/browser/xwalk_browser_context.h"
+#include "xwalk/runtime/browser/xwalk_download_registry.h"
+#include "xwalk/runtime/browser/xwalk_permission_manager.h"
+#include "xwalk/runtime/browser/xwalk_ssl_host_state_delegate.h"
+
+#if defined(OS_ANDROID)
+#include "net/cookies/cookie_deletion_info.h"
+#include "content/public/browser/render_view_host.h"
+#include "content/public/browser/render_widget_host.h"
+#include "content/public/browser/render_widget_host_iterator.h"
+#include "content/public/browser/web_contents.h"
+#include "net/cookies/cookie_store.h"
+#include "xwalk/runtime/browser/android/cookie_manager.h"
+#include "xwalk/runtime/browser/android/xwalk_content.h"
+#endif
+
+using content::BrowserThread;
+
+namespace xwalk {
+
+namespace {
+
+// Everything in the storage partition except cookies, which are removed on
+// their own so they can be matched by domain.
+const uint32_t kStorageRemoveMask =
+    content::StoragePartition::REMOVE_DATA_MASK_ALL &
+    ~content::StoragePartition::REMOVE_DATA_MASK_COOKIES;
+
+// Cookies are set for a domain, not an origin. Like Chrome, a removal for
+// an origin takes all cookies of its registrable domain.
+std::string GetCookieDomain(const url::Origin& origin) {
+  std::string domain =
+      net::registry_controlled_domains::GetDomainAndRegistry(
+          origin, net::registry_controlled_domains::INCLUDE_PRIVATE_REGISTRIES);
+  return domain.empty() ? origin.host() : domain;
+}
+
+bool MatchesOrigins(const std::set<url::Origin>& origins, const GURL& url) {
+  return origins.count(url::Origin::Create(url)) > 0;
+}
+
+bool MatchesOriginsForStorage(const std::set<url::Origin>& origins,
+                              const url::Origin& origin,
+                              storage::SpecialStoragePolicy* policy) {
+  return origins.count(origin) > 0;
+}
+
+// Certificate error exceptions are kept by host, for every scheme and port.
+bool MatchesOriginHosts(const std::set<url::Origin>& origins,
+                        const std::string& host) {
+  for (const url::Origin& origin : origins) {
+    if (origin.host() == host)
+      return true;
+  }
+  return false;
+}
+
+// A URL filter from content::BrowsingDataFilterBuilder can only be probed
+// with URLs. It matches origins or registrable domains; the ports of the
+// origins cannot be recovered, the default ones of both schemes are tried.
+bool MatchesHostForAnyScheme(
+    const base::RepeatingCallback<bool(const GURL&)>& filter,
+    const std::string& host) {
+  return filter.Run(GURL("https://" + host + "/")) ||
+         filter.Run(GURL("http://" + host + "/"));
+}
+
+bool MatchesAll(const GURL& url) {
+  return true;
+}
+
+void PostToUI(base::OnceClosure closure) {
+  base::PostTaskWithTraits(FROM_HERE, {BrowserThread::UI}, std::move(closure));
+}
+
+#if defined(OS_ANDROID)
+void DeleteFromCookieStore(net::CookieDeletionInfo info,
+                           base::OnceClosure done) {
+  GetCookieStore()->DeleteAllMatchingInfoAsync(
+      std::move(info),
+      base::BindOnce([](base::OnceClosure done,
+                        uint32_t num_deleted) { PostToUI(std::move(done)); },
+                     std::move(done)));
+}
+#endif
+
+}  // namespace
+
+struct XWalkBrowsingDataRemover::Removal {
+  base::TimeTicks start;
+  int pending_mask;
+  Result result;
+  Callback callback;
+};
+
+XWalkBrowsingDataRemover::Result::Result() {}
+
+XWalkBrowsingDataRemover::Result::Result(const Result& other) = default;
+
+XWalkBrowsingDataRemover::Result::~Result() {}
+
+XWalkBrowsingDataRemover::XWalkBrowsingDataRemover(
+    XWalkBrowserContext* context)
+    : context_(context), next_removal_id_(0), weak_factory_(this) {}
+
+XWalkBrowsingDataRemover::~XWalkBrowsingDataRemover() {}
+
+// static
+const char* XWalkBrowsingDataRemover::GetDataTypeName(DataType type) {
+  switch (type) {
+    case DATA_TYPE_COOKIES:
+      return "cookies";
+    case DATA_TYPE_HTTP_CACHE:
+      return "http_cache";
+    case DATA_TYPE_CODE_CACHE:
+      return "code_cache";
+    case DATA_TYPE_STORAGE:
+      return "storage";
+    case DATA_TYPE_FORM_DATA:
+      return "form_data";
+    case DATA_TYPE_PERMISSIONS:
+      return "permissions";
+    case DATA_TYPE_HISTORY:
+      return "history";
+    case DATA_TYPE_DOWNLOADS:
+      return "downloads";
+    default:
+      NOTREACHED();
+      return "";
+  }
+}
+
+void XWalkBrowsingDataRemover::Remove(base::Time begin,
+                                      base::Time end,
+                                      int remove_mask,
+                                      const std::set<url::Origin>& origins,
+                                      Callback callback) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  remove_mask &= DATA_TYPE_ALL;
+  // Form data and visited links cannot be attributed to an origin.
+  if (!origins.empty())
+    remove_mask &= ~(DATA_TYPE_FORM_DATA | DATA_TYPE_HISTORY);
+
+  const int id = next_removal_id_++;
+  std::unique_ptr<Removal> removal(new Removal);
+  removal->start = base::TimeTicks::Now();
+  removal->pending_mask = remove_mask;
+  removal->callback = std::move(callback);
+  removals_[id] = std::move(removal);
+
+  if (!remove_mask) {
+    OnTypeRemoved(id, DataType(0));
+    return;
+  }
+
+  // Every type is started before any of them can finish. Only permissions,
+  // history and downloads complete synchronously, they come last.
+  auto done = [&](DataType type) {
+    return base::BindOnce(&XWalkBrowsingDataRemover::OnTypeRemoved,
+                          weak_factory_.GetWeakPtr(), id, type);
+  };
+  const URLFilter url_filter =
+      origins.empty() ? URLFilter()
+                      : base::BindRepeating(&MatchesOrigins, origins);
+
+  if (remove_mask & DATA_TYPE_COOKIES)
+    RemoveCookies(begin, end, origins, done(DATA_TYPE_COOKIES));
+  if (remove_mask & DATA_TYPE_HTTP_CACHE)
+    RemoveHttpCache(begin, end, origins, done(DATA_TYPE_HTTP_CACHE));
+  if (remove_mask & DATA_TYPE_CODE_CACHE)
+    RemoveCodeCache(begin, end, url_filter, done(DATA_TYPE_CODE_CACHE));
+  if (remove_mask & DATA_TYPE_STORAGE)
+    RemoveStorage(begin, end, origins, done(DATA_TYPE_STORAGE));
+  if (remove_mask & DATA_TYPE_FORM_DATA)
+    RemoveFormData(begin, end, done(DATA_TYPE_FORM_DATA));
+  if (remove_mask & DATA_TYPE_PERMISSIONS) {
+    RemovePermissions(
+        url_filter,
+        origins.empty() ? HostFilter()
+                        : base::BindRepeating(&MatchesOriginHosts, origins),
+        done(DATA_TYPE_PERMISSIONS));
+  }
+  if (remove_mask & DATA_TYPE_HISTORY)
+    RemoveHistory(done(DATA_TYPE_HISTORY));
+  if (remove_mask & DATA_TYPE_DOWNLOADS) {
+    RemoveDownloads(begin, end, url_filter, false,
+                    done(DATA_TYPE_DOWNLOADS));
+  }
+}
+
+void XWalkBrowsingDataRemover::OnTypeRemoved(int removal_id, DataType type) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  auto it = removals_.find(removal_id);
+  if (it == removals_.end())
+    return;
+  Removal* removal = it->second.get();
+  const base::TimeDelta elapsed = base::TimeTicks::Now() - removal->start;
+  if (type) {
+    removal->pending_mask &= ~type;
+    removal->result.timings[type] = elapsed;
+    VLOG(1) << "Removed " << GetDataTypeName(type) << " in "
+            << elapsed.InMillisecondsF() << " ms";
+  }
+  if (removal->pending_mask)
+    return;
+
+  removal->result.total = elapsed;
+  std::unique_ptr<Removal> finished = std::move(it->second);
+  removals_.erase(it);
+  std::move(finished->callback).Run(finished->result);
+}
+
+void XWalkBrowsingDataRemover::RemoveCookies(
+    base::Time begin,
+    base::Time end,
+    const std::set<url::Origin>& origins,
+    base::OnceClosure done) {
+  std::vector<std::string> domains;
+  for (const url::Origin& origin : origins)
+    domains.push_back(GetCookieDomain(origin));
+
+  network::mojom::CookieDeletionFilterPtr filter =
+      network::mojom::CookieDeletionFilter::New();
+  if (!begin.is_null())
+    filter->created_after_time = begin;
+  if (!end.is_max())
+    filter->created_before_time = end;
+  if (!origins.empty())
+    filter->including_domains = domains;
+
+#if defined(OS_ANDROID)
+  // The views do not use the network context's cookie jar but the one the
+  // CookieManager owns, both are cleared.
+  base::RepeatingClosure barrier =
+      base::BarrierClosure(2, base::AdaptCallbackForRepeating(std::move(done)));
+  net::CookieDeletionInfo info(begin, end);
+  info.domains_and_ips_to_delete.insert(domains.begin(), domains.end());
+  GetCookieStoreTaskRunner()->PostTask(
+      FROM_HERE,
+      base::BindOnce(&DeleteFromCookieStore, std::move(info), barrier));
+  done = barrier;
+#endif
+
+  content::BrowserContext::GetDefaultStoragePartition(context_)->ClearData(
+      content::StoragePartition::REMOVE_DATA_MASK_COOKIES, 0,
+      content::StoragePartition::OriginMatcherFunction(), std::move(filter),
+      false, begin, end, std::move(done));
+}
+
+void XWalkBrowsingDataRemover::RemoveHttpCache(
+    base::Time begin,
+    base::Time end,
+    const std::set<url::Origin>& origins,
+    base::OnceClosure done) {
+  network::mojom::ClearDataFilterPtr filter;
+  if (!origins.empty()) {
+    filter = network::mojom::ClearDataFilter::New();
+    filter->type = network::mojom::ClearDataFilter::Type::DELETE_MATCHES;
+    filter->origins.assign(origins.begin(), origins.end());
+  }
+  content::BrowserContext::GetDefaultStoragePartition(context_)
+      ->GetNetworkContext()
+      ->ClearHttpCache(begin, end, std::move(filter), std::move(done));
+}
+
+void XWalkBrowsingDataRemover::RemoveCodeCache(base::Time begin,
+                                               base::Time end,
+                                               const URLFilter& filter,
+                                               base::OnceClosure done) {
+  content::BrowserContext::GetDefaultStoragePartition(context_)
+      ->ClearCodeCaches(begin, end, filter, std::move(done));
+}
+
+void XWalkBrowsingDataRemover::RemoveStorage(
+    base::Time begin,
+    base::Time end,
+    const std::set<url::Origin>& origins,
+    base::OnceClosure done) {
+  content::StoragePartition::OriginMatcherFunction matcher;
+  if (!origins.empty())
+    matcher = base::BindRepeating(&MatchesOriginsForStorage, origins);
+  content::BrowserContext::GetDefaultStoragePartition(context_)->ClearData(
+      kStorageRemoveMask,
+      content::StoragePartition::QUOTA_MANAGED_STORAGE_MASK_ALL, matcher,
+      nullptr, false, begin, end, std::move(done));
+}
+
+void XWalkBrowsingDataRemover::RemoveFormData(base::Time begin,
+                                              base::Time end,
+                                              base::OnceClosure done) {
+  XWalkFormDatabaseService* service = context_->GetFormDatabaseService();
+  if (!service) {
+    std::move(done).Run();
+    return;
+  }
+  service->ClearFormData(begin, end, std::move(done));
+}
+
+void XWalkBrowsingDataRemover::RemovePermissions(const URLFilter& filter,
+                                                 const HostFilter& host_filter,
+                                                 base::OnceClosure done) {
+  static_cast<XWalkPermissionManager*>(
+      context_->GetPermissionControllerDelegate())
+      ->ClearDecisions(filter);
+  context_->GetSSLHostStateDelegate()->Clear(host_filter);
+
+#if defined(OS_ANDROID)
+  // The geolocation decisions the user asked to remember are kept by each
+  // view on the Java side.
+  std::set<XWalkContent*> contents;
+  std::unique_ptr<content::RenderWidgetHostIterator> widgets(
+      content::RenderWidgetHost::GetRenderWidgetHosts());
+  while (content::RenderWidgetHost* rwh = widgets->GetNextHost()) {
+    content::RenderViewHost* rvh = content::RenderViewHost::From(rwh);
+    if (!rvh)
+      continue;
+    content::WebContents* web_contents =
+        content::WebContents::FromRenderViewHost(rvh);
+    if (!web_contents || web_contents->GetBrowserContext() != context_)
+      continue;
+    XWalkContent* content = XWalkContent::FromWebContents(web_contents);
+    if (content && contents.insert(content).second)
+      content->ClearGeolocationPermissions(filter);
+  }
+#endif
+
+  // All of them are in-memory maps, the SSL exceptions file is rewritten in
+  // the background.
+  std::move(done).Run();
+}
+
+void XWalkBrowsingDataRemover::RemoveHistory(base::OnceClosure done) {
+  // Also resets the table file and the copy every renderer holds.
+  context_->ClearVisitedLinks();
+  // The DevTools request timeline lists the URLs loaded lately.
+  RuntimeRequestTimeline::ClearAll(std::move(done));
+}
+
+void XWalkBrowsingDataRemover::RemoveDownloads(base::Time begin,
+                                               base::Time end,
+                                               const URLFilter& filter,
+                                               bool registry_only,
+                                               base::OnceClosure done) {
+  RuntimeDownloadManagerDelegate* delegate =
+      static_cast<RuntimeDownloadManagerDelegate*>(
+          context_->GetDownloadManagerDelegate());
+  if (delegate && delegate->registry())
+    delegate->registry()->RemoveRecords(begin, end, filter);
+  if (!registry_only) {
+    // Removing a DownloadItem deletes its partial file, and the registry
+    // forgets it.
+    content::BrowserContext::GetDownloadManager(context_)
+        ->RemoveDownloadsByURLAndTime(
+            filter.is_null() ? base::BindRepeating(&MatchesAll) : filter,
+            begin, end);
+  }
+  std::move(done).Run();
+}
+
+XWalkBrowsingDataRemover::EmbedderOriginTypeMatcher
+XWalkBrowsingDataRemover::GetOriginTypeMatcher() {
+  // There are no embedder origin types, e.g. extensions, to protect.
+  return EmbedderOriginTypeMatcher();
+}
+
+bool XWalkBrowsingDataRemover::MayRemoveDownloadHistory() {
+  return true;
+}
+
+void XWalkBrowsingDataRemover::RemoveEmbedderData(
+    const base::Time& delete_begin,
+    const base::Time& delete_end,
+    int remove_mask,
+    content::BrowsingDataFilterBuilder* filter_builder,
+    int origin_type_mask,
+    base::OnceClosure callback) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  const bool remove_all = filter_builder->IsEmptyBlacklist();
+  const bool remove_form_data =
+      (remove_mask & EMBEDDER_DATA_TYPE_FORM_DATA) && remove_all;
+  const bool remove_permissions =
+      (remove_mask & EMBEDDER_DATA_TYPE_PERMISSIONS) != 0;
+  const bool remove_history =
+      (remove_mask & EMBEDDER_DATA_TYPE_HISTORY) && remove_all;
+  const bool remove_downloads =
+      (remove_mask & content::BrowsingDataRemover::DATA_TYPE_DOWNLOADS) != 0;
+  const URLFilter filter =
+      remove_all ? URLFilter() : filter_builder->BuildGeneralFilter();
+
+  base::RepeatingClosure barrier = base::BarrierClosure(
+      remove_form_data + remove_permissions + remove_history +
+          remove_downloads,
+      base::AdaptCallbackForRepeating(std::move(callback)));
+  if (remove_form_data)
+    RemoveFormData(delete_begin, delete_end, barrier);
+  if (remove_permissions) {
+    RemovePermissions(
+        filter,
+        remove_all ? HostFilter()
+                   : base::BindRepeating(&MatchesHostForAnyScheme, filter),
+        barrier);
+  }
+  if (remove_history)
+    RemoveHistory(barrier);
+  if (remove_downloads)
+    RemoveDownloads(delete_begin, delete_end, filter, true, barrier);
+}
+
+}  // namespace xwalk
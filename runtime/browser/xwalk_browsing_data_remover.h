@@ -0,0 +1,159 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_BROWSER_XWALK_BROWSING_DATA_REMOVER_H_
+#define XWALK_RUNTIME_BROWSER_XWALK_BROWSING_DATA_REMOVER_H_
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+#include "base/callback.h"
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
+#include "content/public/browser/browsing_data_remover.h"
+#include "content/public/browser/browsing_data_remover_delegate.h"
+#include "url/origin.h"
+
+class GURL;
+
+namespace xwalk {
+
+class XWalkBrowserContext;
+
+// Clears the browsing data of an XWalkBrowserContext in one go. Every data
+// type is handed to its owner at the same time, on the thread the owner
+// lives on, and a single callback reports when all of them are done along
+// with how long each one took.
+//
+// Removals can be limited to a set of origins and to a time range. Cookies
+// are matched by the registrable domain of the origins, like Chrome does,
+// certificate error exceptions by host, everything else by origin. Form data
+// and the :visited link table are not tied to any origin, they are only
+// removed when no origins are given. Permission decisions and visited links
+// carry no time, they are removed regardless of the range.
+//
+// It is also the content::BrowsingDataRemoverDelegate of the context, so
+// removals going through content::BrowsingDataRemover, e.g. the DevTools
+// Storage domain, can clear the embedder types as well.
+class XWalkBrowsingDataRemover : public content::BrowsingDataRemoverDelegate {
+ public:
+  enum DataType {
+    DATA_TYPE_COOKIES = 1 << 0,
+    DATA_TYPE_HTTP_CACHE = 1 << 1,
+    DATA_TYPE_CODE_CACHE = 1 << 2,
+    // Local storage, IndexedDB, WebSQL, file systems, service workers and
+    // cache storage.
+    DATA_TYPE_STORAGE = 1 << 3,
+    DATA_TYPE_FORM_DATA = 1 << 4,
+    // Site permission decisions and certificate error exceptions.
+    DATA_TYPE_PERMISSIONS = 1 << 5,
+    // The :visited link table.
+    DATA_TYPE_HISTORY = 1 << 6,
+    // Finished and interrupted downloads, and the unfinished ones kept to be
+    // resumed after a restart.
+    DATA_TYPE_DOWNLOADS = 1 << 7,
+    DATA_TYPE_ALL = (1 << 8) - 1,
+  };
+
+  // The bits content::BrowsingDataRemover hands to RemoveEmbedderData().
+  enum EmbedderDataType {
+    EMBEDDER_DATA_TYPE_FORM_DATA =
+        content::BrowsingDataRemover::DATA_TYPE_CONTENT_END << 1,
+    EMBEDDER_DATA_TYPE_PERMISSIONS =
+        content::BrowsingDataRemover::DATA_TYPE_CONTENT_END << 2,
+    EMBEDDER_DATA_TYPE_HISTORY =
+        content::BrowsingDataRemover::DATA_TYPE_CONTENT_END << 3,
+  };
+
+  struct Result {
+    Result();
+    Result(const Result& other);
+    ~Result();
+
+    // From the call to Remove() until the last type was done.
+    base::TimeDelta total;
+    // Time each requested type took, measured from the same start.
+    std::map<DataType, base::TimeDelta> timings;
+  };
+  using Callback = base::OnceCallback<void(const Result&)>;
+
+  explicit XWalkBrowsingDataRemover(XWalkBrowserContext* context);
+  ~XWalkBrowsingDataRemover() override;
+
+  // Removes the data of the types in |remove_mask| that was created between
+  // |begin| and |end|, for |origins| or for all origins if it is empty.
+  // Must be called on the UI thread, |callback| is run there. A null
+  // |begin| and a max |end| cover everything.
+  void Remove(base::Time begin,
+              base::Time end,
+              int remove_mask,
+              const std::set<url::Origin>& origins,
+              Callback callback);
+
+  // Used in logs and perf results.
+  static const char* GetDataTypeName(DataType type);
+
+  // content::BrowsingDataRemoverDelegate implementation.
+  EmbedderOriginTypeMatcher GetOriginTypeMatcher() override;
+  bool MayRemoveDownloadHistory() override;
+  void RemoveEmbedderData(const base::Time& delete_begin,
+                          const base::Time& delete_end,
+                          int remove_mask,
+                          content::BrowsingDataFilterBuilder* filter_builder,
+                          int origin_type_mask,
+                          base::OnceClosure callback) override;
+
+ private:
+  using URLFilter = base::RepeatingCallback<bool(const GURL&)>;
+  using HostFilter = base::RepeatingCallback<bool(const std::string&)>;
+  struct Removal;
+
+  void RemoveCookies(base::Time begin,
+                     base::Time end,
+                     const std::set<url::Origin>& origins,
+                     base::OnceClosure done);
+  void RemoveHttpCache(base::Time begin,
+                       base::Time end,
+                       const std::set<url::Origin>& origins,
+                       base::OnceClosure done);
+  void RemoveCodeCache(base::Time begin,
+                       base::Time end,
+                       const URLFilter& filter,
+                       base::OnceClosure done);
+  void RemoveStorage(base::Time begin,
+                     base::Time end,
+                     const std::set<url::Origin>& origins,
+                     base::OnceClosure done);
+  void RemoveFormData(base::Time begin, base::Time end, base::OnceClosure done);
+  // Null filters match everything. |host_filter| is for the certificate
+  // error exceptions, which are kept by host.
+  void RemovePermissions(const URLFilter& filter,
+                         const HostFilter& host_filter,
+                         base::OnceClosure done);
+  void RemoveHistory(base::OnceClosure done);
+  // With |registry_only| just the unfinished downloads that were not
+  // restored yet are dropped, content::BrowsingDataRemover removes the
+  // DownloadItems itself.
+  void RemoveDownloads(base::Time begin,
+                       base::Time end,
+                       const URLFilter& filter,
+                       bool registry_only,
+                       base::OnceClosure done);
+
+  void OnTypeRemoved(int removal_id, DataType type);
+
+  XWalkBrowserContext* context_;
+  int next_removal_id_;
+  std::map<int, std::unique_ptr<Removal>> removals_;
+  base::WeakPtrFactory<XWalkBrowsingDataRemover> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkBrowsingDataRemover);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_BROWSER_XWALK_BROWSING_DATA_REMOVER_H_
@@ -0,0 +1,198 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/xwalk_browsing_data_remover.h"
+
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/run_loop.h"
+#include "base/threading/platform_thread.h"
+#include "content/public/browser/ssl_host_state_delegate.h"
+#include "content/public/browser/web_contents.h"
+#include "content/public/test/browser_test_utils.h"
+#include "net/base/net_errors.h"
+#include "net/cert/x509_certificate.h"
+#include "net/test/cert_test_util.h"
+#include "net/test/embedded_test_server/embedded_test_server.h"
+#include "net/test/embedded_test_server/http_request.h"
+#include "net/test/embedded_test_server/http_response.h"
+#include "net/test/test_data_directory.h"
+#include "url/origin.h"
+#include "url/url_constants.h"
+#include "xwalk/runtime/browser/runtime.h"
+#include "xwalk/runtime/browser/xwalk_browser_context.h"
+#include "xwalk/test/base/in_process_browser_test.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+#include "xwalk/test/base/xwalk_test_utils.h"
+
+using xwalk::Runtime;
+using xwalk::XWalkBrowserContext;
+using xwalk::XWalkBrowsingDataRemover;
+
+namespace {
+
+// Two hosts, so cookies, which ignore the port, are kept apart too.
+const char kHostA[] = "127.0.0.1";
+const char kHostB[] = "localhost";
+
+const char kSeedScript[] =
+    "document.cookie = 'seed=1; max-age=3600';"
+    "localStorage.setItem('seed', '1');"
+    "window.domAutomationController.send(document.cookie);";
+
+const char kReadScript[] =
+    "window.domAutomationController.send("
+    "    document.cookie + '|' + (localStorage.getItem('seed') || ''));";
+
+std::unique_ptr<net::test_server::HttpResponse> HandleRequest(
+    const net::test_server::HttpRequest& request) {
+  std::unique_ptr<net::test_server::BasicHttpResponse> response(
+      new net::test_server::BasicHttpResponse);
+  response->set_content_type("text/html");
+  response->set_content("<html><body>data</body></html>");
+  return std::move(response);
+}
+
+void OnRemoved(base::RunLoop* run_loop,
+               XWalkBrowsingDataRemover::Result* out,
+               const XWalkBrowsingDataRemover::Result& result) {
+  *out = result;
+  run_loop->Quit();
+}
+
+}  // namespace
+
+class XWalkBrowsingDataRemoverBrowserTest : public InProcessBrowserTest {
+ protected:
+  void SetUp() override {
+    embedded_test_server()->RegisterRequestHandler(
+        base::BindRepeating(&HandleRequest));
+    ASSERT_TRUE(embedded_test_server()->Start());
+    InProcessBrowserTest::SetUp();
+  }
+
+  GURL GetURL(const std::string& host) {
+    return embedded_test_server()->GetURL(host, "/page.html");
+  }
+
+  void Seed(Runtime* runtime, const std::string& host) {
+    xwalk_test_utils::NavigateToURL(runtime, GetURL(host));
+    // Reading the cookie back makes sure it reached the cookie store.
+    std::string cookie;
+    ASSERT_TRUE(content::ExecuteScriptAndExtractString(
+        runtime->web_contents(), kSeedScript, &cookie));
+    ASSERT_EQ("seed=1", cookie);
+  }
+
+  // Returns "<cookies>|<local storage value>" as a fresh page load sees it.
+  std::string Read(Runtime* runtime, const std::string& host) {
+    xwalk_test_utils::NavigateToURL(runtime, GetURL(host));
+    std::string data;
+    EXPECT_TRUE(content::ExecuteScriptAndExtractString(
+        runtime->web_contents(), kReadScript, &data));
+    return data;
+  }
+
+  XWalkBrowsingDataRemover::Result Remove(base::Time begin,
+                                          int remove_mask,
+                                          const std::set<url::Origin>& origins) {
+    XWalkBrowsingDataRemover::Result result;
+    base::RunLoop run_loop;
+    XWalkBrowserContext::GetDefault()->GetXWalkBrowsingDataRemover()->Remove(
+        begin, base::Time::Max(), remove_mask, origins,
+        base::BindOnce(&OnRemoved, &run_loop, &result));
+    run_loop.Run();
+    return result;
+  }
+};
+
+IN_PROC_BROWSER_TEST_F(XWalkBrowsingDataRemoverBrowserTest,
+                       RemovesOnlyMatchingOrigins) {
+  Runtime* runtime = CreateRuntime(GURL());
+  Seed(runtime, kHostA);
+  Seed(runtime, kHostB);
+
+  XWalkBrowsingDataRemover::Result result = Remove(
+      base::Time(),
+      XWalkBrowsingDataRemover::DATA_TYPE_COOKIES |
+          XWalkBrowsingDataRemover::DATA_TYPE_STORAGE,
+      {url::Origin::Create(GetURL(kHostA))});
+  EXPECT_EQ(2u, result.timings.size());
+
+  EXPECT_EQ("|", Read(runtime, kHostA));
+  EXPECT_EQ("seed=1|1", Read(runtime, kHostB));
+}
+
+IN_PROC_BROWSER_TEST_F(XWalkBrowsingDataRemoverBrowserTest,
+                       KeepsDataOlderThanRange) {
+  Runtime* runtime = CreateRuntime(GURL());
+  Seed(runtime, kHostA);
+  base::PlatformThread::Sleep(base::TimeDelta::FromMilliseconds(10));
+  const base::Time after_seed = base::Time::Now();
+
+  Remove(after_seed, XWalkBrowsingDataRemover::DATA_TYPE_COOKIES,
+         std::set<url::Origin>());
+  EXPECT_EQ("seed=1|1", Read(runtime, kHostA));
+
+  Remove(base::Time(), XWalkBrowsingDataRemover::DATA_TYPE_COOKIES,
+         std::set<url::Origin>());
+  EXPECT_EQ("|1", Read(runtime, kHostA));
+}
+
+// Certificate error exceptions are kept by host, an http origin on a
+// non-default port still takes them.
+IN_PROC_BROWSER_TEST_F(XWalkBrowsingDataRemoverBrowserTest,
+                       RemovesCertificateExceptionsByHost) {
+  scoped_refptr<net::X509Certificate> cert =
+      net::ImportCertFromFile(net::GetTestCertsDirectory(), "ok_cert.pem");
+  ASSERT_TRUE(cert);
+  content::SSLHostStateDelegate* delegate =
+      XWalkBrowserContext::GetDefault()->GetSSLHostStateDelegate();
+  delegate->AllowCert(kHostA, *cert, net::ERR_CERT_AUTHORITY_INVALID);
+  delegate->AllowCert(kHostB, *cert, net::ERR_CERT_AUTHORITY_INVALID);
+
+  const GURL url = GetURL(kHostA);
+  ASSERT_TRUE(url.SchemeIs(url::kHttpScheme));
+  ASSERT_TRUE(url.has_port());
+  Remove(base::Time(), XWalkBrowsingDataRemover::DATA_TYPE_PERMISSIONS,
+         {url::Origin::Create(url)});
+
+  EXPECT_FALSE(delegate->HasAllowException(kHostA));
+  EXPECT_TRUE(delegate->HasAllowException(kHostB));
+}
+
+IN_PROC_BROWSER_TEST_F(XWalkBrowsingDataRemoverBrowserTest, WipeLatency) {
+  Runtime* runtime = CreateRuntime(GURL());
+  Seed(runtime, kHostA);
+  Seed(runtime, kHostB);
+
+  XWalkBrowsingDataRemover::Result result =
+      Remove(base::Time(), XWalkBrowsingDataRemover::DATA_TYPE_ALL,
+             std::set<url::Origin>());
+
+  for (int type = 1; type & XWalkBrowsingDataRemover::DATA_TYPE_ALL;
+       type <<= 1) {
+    EXPECT_TRUE(
+        result.timings.count(XWalkBrowsingDataRemover::DataType(type)))
+        << XWalkBrowsingDataRemover::GetDataTypeName(
+               XWalkBrowsingDataRemover::DataType(type));
+  }
+  for (const auto& timing : result.timings) {
+    EXPECT_LE(timing.second, result.total);
+    XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+        "browsing_data_wipe",
+        std::string("_") +
+            XWalkBrowsingDataRemover::GetDataTypeName(timing.first),
+        {timing.second.InMicrosecondsF()}));
+  }
+  XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+      "browsing_data_wipe", "_total", {result.total.InMicrosecondsF()}));
+
+  EXPECT_EQ("|", Read(runtime, kHostA));
+  EXPECT_EQ("|", Read(runtime, kHostB));
+}
@@ -0,0 +1,71 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/xwalk_cert_error_coalescer.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "net/cert/x509_certificate.h"
+#include "url/gurl.h"
+
+namespace xwalk {
+
+XWalkCertErrorCoalescer::XWalkCertErrorCoalescer(Client* client)
+    : client_(client), weak_factory_(this) {
+  DCHECK(client_);
+}
+
+// Callbacks still waiting are dropped, content cancels their requests along
+// with the WebContents.
+XWalkCertErrorCoalescer::~XWalkCertErrorCoalescer() {}
+
+void XWalkCertErrorCoalescer::AllowCertificateError(
+    int cert_error,
+    net::X509Certificate* cert,
+    const GURL& request_url,
+    ResultCallback callback) {
+  if (!cert) {
+    std::move(callback).Run(content::CERTIFICATE_REQUEST_RESULT_TYPE_DENY);
+    return;
+  }
+
+  Key key(request_url.host(), cert->CalculateChainFingerprint256(),
+          cert_error);
+  auto it = waiting_.find(key);
+  if (it != waiting_.end()) {
+    it->second.push_back(std::move(callback));
+    return;
+  }
+
+  // Registered before asking, the client may answer synchronously.
+  waiting_[key].push_back(std::move(callback));
+  if (!client_->PromptCertificateError(
+          cert_error, cert, request_url,
+          base::BindOnce(&XWalkCertErrorCoalescer::OnDecided,
+                         weak_factory_.GetWeakPtr(), key))) {
+    RunCallbacks(key, content::CERTIFICATE_REQUEST_RESULT_TYPE_DENY);
+  }
+}
+
+void XWalkCertErrorCoalescer::OnDecided(const Key& key, bool proceed) {
+  RunCallbacks(key, proceed ? content::CERTIFICATE_REQUEST_RESULT_TYPE_CONTINUE
+                            : content::CERTIFICATE_REQUEST_RESULT_TYPE_CANCEL);
+}
+
+void XWalkCertErrorCoalescer::RunCallbacks(
+    const Key& key,
+    content::CertificateRequestResultType result) {
+  auto it = waiting_.find(key);
+  if (it == waiting_.end())
+    return;
+  // Take them out first, running one may start a new request for the key.
+  std::vector<ResultCallback> callbacks;
+  callbacks.swap(it->second);
+  waiting_.erase(it);
+  for (ResultCallback& callback : callbacks)
+    std::move(callback).Run(result);
+}
+
+}  // namespace xwalk
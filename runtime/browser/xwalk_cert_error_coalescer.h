@@ -0,0 +1,82 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_BROWSER_XWALK_CERT_ERROR_COALESCER_H_
+#define XWALK_RUNTIME_BROWSER_XWALK_CERT_ERROR_COALESCER_H_
+
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "content/public/browser/certificate_request_result_type.h"
+#include "net/base/hash_value.h"
+
+class GURL;
+
+namespace net {
+class X509Certificate;
+}
+
+namespace xwalk {
+
+// Makes sure the embedder is asked only once about a certificate error, no
+// matter how many requests run into it at the same time. Requests that fail
+// for the same host, certificate chain and error while a prompt for them is
+// showing wait for its answer instead of opening their own prompt.
+//
+// An allow decision is recorded in the SSLHostStateDelegate by content, so
+// requests that fail after the answer do not get here at all.
+class XWalkCertErrorCoalescer {
+ public:
+  using ResultCallback =
+      base::OnceCallback<void(content::CertificateRequestResultType)>;
+
+  class Client {
+   public:
+    // Shows one prompt for the error. Returns false if there is no way to
+    // ask, |decided| is dropped then. Otherwise |decided| must be run with
+    // the answer, possibly before this returns.
+    virtual bool PromptCertificateError(
+        int cert_error,
+        net::X509Certificate* cert,
+        const GURL& request_url,
+        base::OnceCallback<void(bool proceed)> decided) = 0;
+
+   protected:
+    virtual ~Client() {}
+  };
+
+  explicit XWalkCertErrorCoalescer(Client* client);
+  ~XWalkCertErrorCoalescer();
+
+  // Runs |callback| with CONTINUE or CANCEL once the prompt for this error
+  // was answered, or with DENY if no prompt can be shown.
+  void AllowCertificateError(int cert_error,
+                             net::X509Certificate* cert,
+                             const GURL& request_url,
+                             ResultCallback callback);
+
+  size_t pending_prompt_count() const { return waiting_.size(); }
+
+ private:
+  using Key = std::tuple<std::string, net::SHA256HashValue, int>;
+
+  void OnDecided(const Key& key, bool proceed);
+  void RunCallbacks(const Key& key,
+                    content::CertificateRequestResultType result);
+
+  Client* client_;
+  std::map<Key, std::vector<ResultCallback>> waiting_;
+  base::WeakPtrFactory<XWalkCertErrorCoalescer> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkCertErrorCoalescer);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_BROWSER_XWALK_CERT_ERROR_COALESCER_H_
@@ -0,0 +1,161 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/xwalk_cert_error_coalescer.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/macros.h"
+#include "content/public/test/test_browser_thread_bundle.h"
+#include "net/base/net_errors.h"
+#include "net/test/cert_test_util.h"
+#include "net/test/test_data_directory.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+
+namespace xwalk {
+
+namespace {
+
+// Stands in for the Java side: counts prompts and keeps their callbacks so
+// the test decides when and how they are answered.
+class FakeClient : public XWalkCertErrorCoalescer::Client {
+ public:
+  FakeClient() {}
+  ~FakeClient() override {}
+
+  bool PromptCertificateError(
+      int cert_error,
+      net::X509Certificate* cert,
+      const GURL& request_url,
+      base::OnceCallback<void(bool proceed)> decided) override {
+    if (!can_prompt_)
+      return false;
+    prompts_.push_back(std::move(decided));
+    return true;
+  }
+
+  void Answer(size_t index, bool proceed) {
+    std::move(prompts_[index]).Run(proceed);
+  }
+
+  size_t prompt_count() const { return prompts_.size(); }
+  void set_can_prompt(bool can_prompt) { can_prompt_ = can_prompt; }
+
+ private:
+  bool can_prompt_ = true;
+  std::vector<base::OnceCallback<void(bool)>> prompts_;
+
+  DISALLOW_COPY_AND_ASSIGN(FakeClient);
+};
+
+void RecordResult(std::vector<content::CertificateRequestResultType>* results,
+                  content::CertificateRequestResultType result) {
+  results->push_back(result);
+}
+
+class XWalkCertErrorCoalescerTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    cert_ = net::ImportCertFromFile(net::GetTestCertsDirectory(),
+                                    "ok_cert.pem");
+    ASSERT_TRUE(cert_);
+    other_cert_ = net::ImportCertFromFile(net::GetTestCertsDirectory(),
+                                          "expired_cert.pem");
+    ASSERT_TRUE(other_cert_);
+  }
+
+  void Request(XWalkCertErrorCoalescer* coalescer,
+               int cert_error,
+               net::X509Certificate* cert,
+               const GURL& url) {
+    coalescer->AllowCertificateError(
+        cert_error, cert, url, base::BindOnce(&RecordResult, &results_));
+  }
+
+  content::TestBrowserThreadBundle thread_bundle_;
+  scoped_refptr<net::X509Certificate> cert_;
+  scoped_refptr<net::X509Certificate> other_cert_;
+  std::vector<content::CertificateRequestResultType> results_;
+};
+
+}  // namespace
+
+TEST_F(XWalkCertErrorCoalescerTest, ConcurrentRequestsShareOnePrompt) {
+  FakeClient client;
+  XWalkCertErrorCoalescer coalescer(&client);
+  const GURL url("https://intranet.example.com/");
+
+  // What a page with a hundred subresources on the same broken host does.
+  for (int i = 0; i < 100; ++i) {
+    Request(&coalescer, net::ERR_CERT_AUTHORITY_INVALID, cert_.get(),
+            url.Resolve("/resource" + std::to_string(i)));
+  }
+  EXPECT_EQ(1u, client.prompt_count());
+  EXPECT_EQ(1u, coalescer.pending_prompt_count());
+  EXPECT_TRUE(results_.empty());
+
+  client.Answer(0, true);
+  ASSERT_EQ(100u, results_.size());
+  for (content::CertificateRequestResultType result : results_)
+    EXPECT_EQ(content::CERTIFICATE_REQUEST_RESULT_TYPE_CONTINUE, result);
+  EXPECT_EQ(0u, coalescer.pending_prompt_count());
+}
+
+TEST_F(XWalkCertErrorCoalescerTest, RejectCancelsAllWaiting) {
+  FakeClient client;
+  XWalkCertErrorCoalescer coalescer(&client);
+  const GURL url("https://intranet.example.com/");
+
+  for (int i = 0; i < 10; ++i)
+    Request(&coalescer, net::ERR_CERT_AUTHORITY_INVALID, cert_.get(), url);
+  client.Answer(0, false);
+
+  ASSERT_EQ(10u, results_.size());
+  for (content::CertificateRequestResultType result : results_)
+    EXPECT_EQ(content::CERTIFICATE_REQUEST_RESULT_TYPE_CANCEL, result);
+
+  // Once answered, a new failure asks again.
+  Request(&coalescer, net::ERR_CERT_AUTHORITY_INVALID, cert_.get(), url);
+  EXPECT_EQ(2u, client.prompt_count());
+}
+
+TEST_F(XWalkCertErrorCoalescerTest, DistinctErrorsPromptSeparately) {
+  FakeClient client;
+  XWalkCertErrorCoalescer coalescer(&client);
+  const GURL url("https://intranet.example.com/");
+
+  Request(&coalescer, net::ERR_CERT_AUTHORITY_INVALID, cert_.get(), url);
+  Request(&coalescer, net::ERR_CERT_DATE_INVALID, cert_.get(), url);
+  Request(&coalescer, net::ERR_CERT_AUTHORITY_INVALID, other_cert_.get(), url);
+  Request(&coalescer, net::ERR_CERT_AUTHORITY_INVALID, cert_.get(),
+          GURL("https://other.example.com/"));
+  EXPECT_EQ(4u, client.prompt_count());
+  EXPECT_EQ(4u, coalescer.pending_prompt_count());
+
+  client.Answer(1, true);
+  ASSERT_EQ(1u, results_.size());
+  EXPECT_EQ(content::CERTIFICATE_REQUEST_RESULT_TYPE_CONTINUE, results_[0]);
+  EXPECT_EQ(3u, coalescer.pending_prompt_count());
+}
+
+TEST_F(XWalkCertErrorCoalescerTest, DenyWithoutPrompt) {
+  FakeClient client;
+  client.set_can_prompt(false);
+  XWalkCertErrorCoalescer coalescer(&client);
+  const GURL url("https://intranet.example.com/");
+
+  Request(&coalescer, net::ERR_CERT_AUTHORITY_INVALID, cert_.get(), url);
+  Request(&coalescer, net::ERR_CERT_AUTHORITY_INVALID, nullptr, url);
+  ASSERT_EQ(2u, results_.size());
+  EXPECT_EQ(content::CERTIFICATE_REQUEST_RESULT_TYPE_DENY, results_[0]);
+  EXPECT_EQ(content::CERTIFICATE_REQUEST_RESULT_TYPE_DENY, results_[1]);
+  EXPECT_EQ(0u, coalescer.pending_prompt_count());
+}
+
+}  // namespace xwalk
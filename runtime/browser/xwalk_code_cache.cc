@@ -0,0 +1,278 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/xwalk_code_cache.h"
+
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/bind_helpers.h"
+#include "base/command_line.h"
+#include "base/files/file_util.h"
+#include "base/memory/weak_ptr.h"
+#include "base/no_destructor.h"
+#include "base/sequenced_task_runner.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/task/post_task.h"
+#include "base/time/time.h"
+#include "content/browser/code_cache/generated_code_cache_context.h"
+#include "content/public/browser/browser_context.h"
+#include "content/public/browser/browser_task_traits.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/navigation_throttle.h"
+#include "content/public/browser/storage_partition.h"
+#include "crypto/sha2.h"
+#include "url/gurl.h"
+#include "xwalk/runtime/browser/xwalk_browser_context.h"
+#include "xwalk/runtime/common/xwalk_switches.h"
+
+using content::BrowserThread;
+
+namespace xwalk {
+
+namespace {
+
+// Enough for the scripts of a few dozen heavy sites. disk_cache evicts the
+// least recently used entries beyond this.
+const int64_t kDefaultCodeCacheSize = 32 * 1024 * 1024;
+
+const base::FilePath::CharType kZonesDirName[] =
+    FILE_PATH_LITERAL("Code Cache Zones");
+// Below the directory passed in GeneratedCodeCacheSettings, as content
+// names it.
+const base::FilePath::CharType kCodeCacheDirName[] =
+    FILE_PATH_LITERAL("Code Cache");
+
+std::string HashZone(const std::string& zone) {
+  const std::string hash = crypto::SHA256HashString(zone);
+  return base::HexEncode(hash.data(), hash.size());
+}
+
+base::FilePath GetZonePathForHash(content::BrowserContext* context,
+                                  const std::string& hash) {
+  return context->GetPath().Append(kZonesDirName).AppendASCII(hash);
+}
+
+int64_t GetCacheSize() {
+  const base::CommandLine& command_line =
+      *base::CommandLine::ForCurrentProcess();
+  int64_t size = kDefaultCodeCacheSize;
+  if (command_line.HasSwitch(switches::kCodeCacheSize)) {
+    int64_t value;
+    if (base::StringToInt64(
+            command_line.GetSwitchValueASCII(switches::kCodeCacheSize),
+            &value) &&
+        value >= 0) {
+      size = value;
+    }
+  }
+  return size;
+}
+
+// Deletions of partitions, and the switches that may reopen them, run in
+// order on this sequence.
+scoped_refptr<base::SequencedTaskRunner> GetFileTaskRunner() {
+  static base::NoDestructor<scoped_refptr<base::SequencedTaskRunner>>
+      task_runner(base::CreateSequencedTaskRunnerWithTraits(
+          {base::MayBlock(), base::TaskPriority::USER_VISIBLE,
+           base::TaskShutdownBehavior::BLOCK_SHUTDOWN}));
+  return *task_runner;
+}
+
+void DeletePartitionFiles(const base::FilePath& path) {
+  base::DeleteFile(path, true);
+}
+
+// UI thread view of the partition in use.
+struct ZoneState {
+  // The zone the cache serves, or is moving to. Content opens the partition
+  // of the empty zone with the profile.
+  std::string hash = HashZone(std::string());
+  // Zone changes not applied yet, counted from the moment they reach the UI
+  // thread until content's cache points at the new partition on the IO
+  // thread.
+  int updates_in_flight = 0;
+  std::vector<base::OnceClosure> usable_waiters;
+};
+
+ZoneState* GetZoneState() {
+  static base::NoDestructor<ZoneState> state;
+  return state.get();
+}
+
+void BeginZoneUpdate() {
+  GetZoneState()->updates_in_flight++;
+}
+
+void EndZoneUpdate() {
+  ZoneState* state = GetZoneState();
+  DCHECK_GT(state->updates_in_flight, 0);
+  if (--state->updates_in_flight)
+    return;
+  std::vector<base::OnceClosure> waiters;
+  waiters.swap(state->usable_waiters);
+  for (base::OnceClosure& closure : waiters)
+    std::move(closure).Run();
+}
+
+// Content opens the cache on the IO thread, a reply from there means every
+// lookup from now on goes to |path|.
+void PointCacheAt(const base::FilePath& path) {
+  XWalkBrowserContext* context = XWalkBrowserContext::GetDefault();
+  if (!context) {
+    EndZoneUpdate();
+    return;
+  }
+  content::BrowserContext::GetDefaultStoragePartition(context)
+      ->GetGeneratedCodeCacheContext()
+      ->Initialize(path.Append(kCodeCacheDirName), GetCacheSize());
+  base::PostTaskWithTraitsAndReply(FROM_HERE, {BrowserThread::IO},
+                                   base::DoNothing(),
+                                   base::BindOnce(&EndZoneUpdate));
+}
+
+void OnZoneChangedOnUI(const std::string& hash) {
+  ZoneState* state = GetZoneState();
+  XWalkBrowserContext* context = XWalkBrowserContext::GetDefault();
+  if (state->hash == hash || !context)
+    return;
+
+  BeginZoneUpdate();
+  state->hash = hash;
+  // A deletion of the partition may still be queued, it must not remove
+  // files the cache just opened.
+  const base::FilePath path = GetZonePathForHash(context, hash);
+  GetFileTaskRunner()->PostTaskAndReply(FROM_HERE, base::DoNothing(),
+                                        base::BindOnce(&PointCacheAt, path));
+}
+
+// Runs once no switch is in flight, the partition in use is the one in
+// |state->hash|.
+void DeletePartition(const std::string& hash) {
+  XWalkBrowserContext* context = XWalkBrowserContext::GetDefault();
+  if (!context)
+    return;
+  // The backend keeps its files open, the partition in use is emptied
+  // instead.
+  if (GetZoneState()->hash == hash) {
+    XWalkCodeCache::Clear(base::DoNothing::Once());
+    return;
+  }
+  GetFileTaskRunner()->PostTask(
+      FROM_HERE, base::BindOnce(&DeletePartitionFiles,
+                                GetZonePathForHash(context, hash)));
+}
+
+void OnZoneDeletedOnUI(const std::string& hash) {
+  XWalkCodeCache::RunWhenUsable(base::BindOnce(&DeletePartition, hash));
+}
+
+// Keeps navigations, and with them the scripts they load, away from the
+// cache while it still serves the previous zone.
+class ZoneSwitchThrottle : public content::NavigationThrottle {
+ public:
+  explicit ZoneSwitchThrottle(content::NavigationHandle* navigation_handle)
+      : content::NavigationThrottle(navigation_handle), weak_factory_(this) {}
+  ~ZoneSwitchThrottle() override {}
+
+  // content::NavigationThrottle implementation.
+  ThrottleCheckResult WillStartRequest() override {
+    if (!GetZoneState()->updates_in_flight)
+      return PROCEED;
+    XWalkCodeCache::RunWhenUsable(base::BindOnce(
+        &ZoneSwitchThrottle::Resume, weak_factory_.GetWeakPtr()));
+    return DEFER;
+  }
+
+  const char* GetNameForLogging() override { return "ZoneSwitchThrottle"; }
+
+ private:
+  base::WeakPtrFactory<ZoneSwitchThrottle> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(ZoneSwitchThrottle);
+};
+
+// Zone changes usually come from the UI thread. Applying them right away
+// holds back navigations started by the very next task.
+void RunOnUI(base::OnceClosure closure) {
+  if (BrowserThread::CurrentlyOn(BrowserThread::UI)) {
+    std::move(closure).Run();
+    return;
+  }
+  base::PostTaskWithTraits(FROM_HERE, {BrowserThread::UI}, std::move(closure));
+}
+
+}  // namespace
+
+// static
+bool XWalkCodeCache::IsEnabled() {
+  return !base::CommandLine::ForCurrentProcess()->HasSwitch(
+      switches::kDisableCodeCache);
+}
+
+// static
+content::GeneratedCodeCacheSettings XWalkCodeCache::GetSettings(
+    content::BrowserContext* context) {
+  if (!IsEnabled())
+    return content::GeneratedCodeCacheSettings(false, 0, context->GetPath());
+  return content::GeneratedCodeCacheSettings(
+      true, GetCacheSize(), GetZonePath(context, std::string()));
+}
+
+// static
+std::unique_ptr<content::NavigationThrottle>
+XWalkCodeCache::MaybeCreateThrottle(
+    content::NavigationHandle* navigation_handle) {
+  if (!IsEnabled())
+    return nullptr;
+  return std::make_unique<ZoneSwitchThrottle>(navigation_handle);
+}
+
+// static
+void XWalkCodeCache::RunWhenUsable(base::OnceClosure closure) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  ZoneState* state = GetZoneState();
+  if (!state->updates_in_flight) {
+    std::move(closure).Run();
+    return;
+  }
+  state->usable_waiters.push_back(std::move(closure));
+}
+
+// static
+void XWalkCodeCache::OnZoneChanged(const std::string& zone) {
+  if (!IsEnabled())
+    return;
+  RunOnUI(base::BindOnce(&OnZoneChangedOnUI, HashZone(zone)));
+}
+
+// static
+void XWalkCodeCache::OnZoneDeleted(const std::string& zone) {
+  if (!IsEnabled())
+    return;
+  RunOnUI(base::BindOnce(&OnZoneDeletedOnUI, HashZone(zone)));
+}
+
+// static
+void XWalkCodeCache::Clear(base::OnceClosure done) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  XWalkBrowserContext* context = XWalkBrowserContext::GetDefault();
+  if (!context) {
+    std::move(done).Run();
+    return;
+  }
+  content::BrowserContext::GetDefaultStoragePartition(context)
+      ->ClearCodeCaches(base::Time(), base::Time::Max(),
+                        base::RepeatingCallback<bool(const GURL&)>(),
+                        std::move(done));
+}
+
+// static
+base::FilePath XWalkCodeCache::GetZonePath(content::BrowserContext* context,
+                                           const std::string& zone) {
+  return GetZonePathForHash(context, HashZone(zone));
+}
+
+}  // namespace xwalk
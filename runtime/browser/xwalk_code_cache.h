@@ -0,0 +1,78 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_BROWSER_XWALK_CODE_CACHE_H_
+#define XWALK_RUNTIME_BROWSER_XWALK_CODE_CACHE_H_
+
+#include <memory>
+#include <string>
+
+#include "base/callback_forward.h"
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "content/public/browser/generated_code_cache_settings.h"
+
+namespace content {
+class BrowserContext;
+class NavigationHandle;
+class NavigationThrottle;
+}
+
+namespace xwalk {
+
+// Settings and zone partitioning for the V8 generated code cache.
+//
+// Content already keys every entry by script URL and by the origin that
+// loaded it, so compiled code is never shared between origins. What it does
+// not know about are zones, so every zone gets a cache directory of its own,
+// named by a hash of the zone so zone names never hit the disk. A zone switch
+// points content's cache at the new zone's directory; code compiled in one
+// zone is never served in another, and switching back finds it again.
+// Navigations are held back until the switch reached the IO thread. Until
+// the first zone is set, the cache uses the directory of the empty zone.
+//
+// The cache is on unless the browser runs with --disable-code-cache. Each
+// partition is a size bounded disk_cache backend with LRU eviction, and its
+// entries are not encrypted.
+class XWalkCodeCache {
+ public:
+  static bool IsEnabled();
+
+  // Used by XWalkContentBrowserClient::GetGeneratedCodeCacheSettings().
+  static content::GeneratedCodeCacheSettings GetSettings(
+      content::BrowserContext* context);
+
+  // Defers |navigation_handle| while the cache moves to another zone.
+  // Returns nullptr when the cache is off.
+  static std::unique_ptr<content::NavigationThrottle> MaybeCreateThrottle(
+      content::NavigationHandle* navigation_handle);
+
+  // Runs |closure| once the cache serves the last zone set, right away if it
+  // already does. Must be called on the UI thread.
+  static void RunWhenUsable(base::OnceClosure closure);
+
+  // Moves the cache to the partition of |zone|. Can be called from any
+  // thread.
+  static void OnZoneChanged(const std::string& zone);
+
+  // Deletes the partition of |zone|, or empties it if it is in use. Can be
+  // called from any thread.
+  static void OnZoneDeleted(const std::string& zone);
+
+  // Drops everything in the partition in use. Must be called on the UI
+  // thread.
+  static void Clear(base::OnceClosure done);
+
+  // The directory holding the partition of |zone|. Content keeps the cache
+  // in "Code Cache" below it.
+  static base::FilePath GetZonePath(content::BrowserContext* context,
+                                    const std::string& zone);
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(XWalkCodeCache);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_BROWSER_XWALK_CODE_CACHE_H_
@@ -0,0 +1,200 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/metrics/histogram_tester.h"
+#include "base/threading/thread_restrictions.h"
+#include "content/public/browser/browser_context.h"
+#include "content/public/browser/web_contents.h"
+#include "content/public/test/browser_test_utils.h"
+#include "net/test/embedded_test_server/embedded_test_server.h"
+#include "net/test/embedded_test_server/http_request.h"
+#include "net/test/embedded_test_server/http_response.h"
+#include "xwalk/runtime/browser/runtime.h"
+#include "xwalk/runtime/browser/xwalk_code_cache.h"
+#include "xwalk/test/base/in_process_browser_test.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+#include "xwalk/test/base/xwalk_test_utils.h"
+
+using xwalk::Runtime;
+
+namespace {
+
+const char kPagePath[] = "/code_cache.html";
+const char kScriptPath[] = "/code_cache.js";
+
+// Roughly the size of a bundled single page application.
+const int kScriptFunctionCount = 20000;
+
+// Recorded by content's GeneratedCodeCache for every JavaScript lookup, the
+// hit bucket being GeneratedCodeCache::CacheEntryStatus::kHit.
+const char kCodeCacheHistogram[] = "SiteIsolatedCodeCache.JS.Behaviour";
+const int kCodeCacheHit = 0;
+
+// The page times how long the big script takes from the moment the parser
+// reaches it until its last statement ran, which on a cold load is mostly
+// compilation, and how long until the load event.
+const char kPage[] =
+    "<html><head><script>var scriptStart = performance.now();</script>"
+    "<script src=\"/code_cache.js\"></script>"
+    "<script>var scriptEnd = performance.now();</script></head>"
+    "<body><script>"
+    "window.addEventListener('load', function() {"
+    "  window.timings = (scriptEnd - scriptStart) + ',' + performance.now();"
+    "});"
+    "</script></body></html>";
+
+std::string BuildScript() {
+  std::string script;
+  for (int i = 0; i < kScriptFunctionCount; ++i) {
+    base::StringAppendF(
+        &script,
+        "function f%d(a, b) { var s = 0; for (var i = 0; i < a; ++i) "
+        "{ s += (i * %d) %% (b + 1); } return [s, '%d', { k: a + b }]; }\n",
+        i, i, i);
+  }
+  script += "var checksum = f1(3, 4)[0] + f2(5, 6)[0];\n";
+  return script;
+}
+
+std::unique_ptr<net::test_server::HttpResponse> HandleRequest(
+    const std::string& script,
+    const net::test_server::HttpRequest& request) {
+  const std::string path = request.GetURL().path();
+  std::unique_ptr<net::test_server::BasicHttpResponse> response(
+      new net::test_server::BasicHttpResponse);
+  if (path == kPagePath) {
+    response->set_content_type("text/html");
+    response->set_content(kPage);
+    return std::move(response);
+  }
+  if (path == kScriptPath) {
+    // Scripts have to come from the HTTP cache with a stable response time
+    // for their code cache entry to be used.
+    response->set_content_type("application/javascript");
+    response->AddCustomHeader("Cache-Control", "max-age=3600");
+    response->set_content(script);
+    return std::move(response);
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+class XWalkCodeCacheBrowserTest : public InProcessBrowserTest {
+ protected:
+  void SetUp() override {
+    embedded_test_server()->RegisterRequestHandler(
+        base::BindRepeating(&HandleRequest, BuildScript()));
+    ASSERT_TRUE(embedded_test_server()->Start());
+    InProcessBrowserTest::SetUp();
+  }
+
+  // Switches the cache to |zone| and waits until it serves that zone.
+  void SwitchZone(const std::string& zone) {
+    xwalk::XWalkCodeCache::OnZoneChanged(zone);
+    base::RunLoop run_loop;
+    xwalk::XWalkCodeCache::RunWhenUsable(run_loop.QuitClosure());
+    run_loop.Run();
+  }
+
+  // Loads the page and returns the script and load timings in ms.
+  void LoadPage(Runtime* runtime, int run, double* script_ms, double* load_ms) {
+    // A new query keeps the page itself out of the memory cache, the script
+    // URL stays the same.
+    GURL url(embedded_test_server()->GetURL(
+        base::StringPrintf("%s?run=%d", kPagePath, run)));
+    xwalk_test_utils::NavigateToURL(runtime, url);
+
+    std::string timings;
+    ASSERT_TRUE(content::ExecuteScriptAndExtractString(
+        runtime->web_contents(),
+        "window.domAutomationController.send(window.timings || '');",
+        &timings));
+    std::vector<std::string> parts = base::SplitString(
+        timings, ",", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+    ASSERT_EQ(2u, parts.size());
+    ASSERT_TRUE(base::StringToDouble(parts[0], script_ms));
+    ASSERT_TRUE(base::StringToDouble(parts[1], load_ms));
+  }
+};
+
+// V8 only writes code for a script once it has been seen twice, the third
+// load is the first that can consume it.
+IN_PROC_BROWSER_TEST_F(XWalkCodeCacheBrowserTest, WarmLoadUsesCache) {
+  Runtime* runtime = CreateRuntime(GURL());
+  const char* const kStories[] = {"cold", "warm", "hot"};
+
+  for (int run = 0; run < 3; ++run) {
+    double script_ms = 0;
+    double load_ms = 0;
+    LoadPage(runtime, run, &script_ms, &load_ms);
+    const std::string story = std::string("_") + kStories[run];
+    XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+        "code_cache_script", story, {script_ms * 1000}));
+    XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+        "code_cache_load", story, {load_ms * 1000}));
+  }
+
+  // No zone was set, the code went to the partition of the empty zone.
+  base::ScopedAllowBlockingForTesting allow_blocking;
+  base::FilePath cache_path =
+      xwalk::XWalkCodeCache::GetZonePath(
+          runtime->web_contents()->GetBrowserContext(), std::string())
+          .Append(FILE_PATH_LITERAL("Code Cache"));
+  EXPECT_TRUE(base::DirectoryExists(cache_path));
+}
+
+// Code compiled in one zone must not be served to the next.
+IN_PROC_BROWSER_TEST_F(XWalkCodeCacheBrowserTest, ZoneSwitchDropsCode) {
+  base::HistogramTester histograms;
+  Runtime* runtime = CreateRuntime(GURL());
+  SwitchZone("first");
+
+  double script_ms = 0;
+  double load_ms = 0;
+  for (int run = 0; run < 3; ++run)
+    LoadPage(runtime, run, &script_ms, &load_ms);
+  const int hits = histograms.GetBucketCount(kCodeCacheHistogram,
+                                             kCodeCacheHit);
+  ASSERT_GT(hits, 0);
+
+  SwitchZone("second");
+  LoadPage(runtime, 3, &script_ms, &load_ms);
+  EXPECT_EQ(hits,
+            histograms.GetBucketCount(kCodeCacheHistogram, kCodeCacheHit));
+}
+
+// Each zone keeps its own partition, switching back finds the code again.
+IN_PROC_BROWSER_TEST_F(XWalkCodeCacheBrowserTest, SwitchBackReusesCode) {
+  base::HistogramTester histograms;
+  Runtime* runtime = CreateRuntime(GURL());
+  SwitchZone("first");
+
+  double script_ms = 0;
+  double load_ms = 0;
+  for (int run = 0; run < 3; ++run)
+    LoadPage(runtime, run, &script_ms, &load_ms);
+
+  SwitchZone("second");
+  LoadPage(runtime, 3, &script_ms, &load_ms);
+  const int hits = histograms.GetBucketCount(kCodeCacheHistogram,
+                                             kCodeCacheHit);
+
+  SwitchZone("first");
+  LoadPage(runtime, 4, &script_ms, &load_ms);
+  EXPECT_GT(histograms.GetBucketCount(kCodeCacheHistogram, kCodeCacheHit),
+            hits);
+}
@@ -8,6 +8,7 @@
 #include <vector>
 #include <memory>
 
+#include "base/bind.h"
 #include "base/command_line.h"
 #include "base/feature_list.h"
 #include "base/files/file.h"
@@ -25,6 +26,8 @@
 #include "content/public/browser/child_process_data.h"
 #include "content/public/browser/client_certificate_delegate.h"
 #include "content/public/browser/file_url_loader.h"
+#include "content/public/browser/navigation_handle.h"
+#include "content/public/browser/navigation_throttle.h"
 #include "content/public/browser/network_service_instance.h"
 #include "content/public/browser/presentation_service_delegate.h"
 #include "content/public/browser/render_frame_host.h"
@@ -60,10 +63,13 @@
 #include "xwalk/runtime/browser/speech/speech_recognition_manager_delegate.h"
 #include "xwalk/runtime/browser/xwalk_browser_context.h"
 #include "xwalk/runtime/browser/xwalk_browser_main_parts.h"
+#include "xwalk/runtime/browser/xwalk_code_cache.h"
 #include "xwalk/runtime/browser/xwalk_content_overlay_manifests.h"
+#include "xwalk/runtime/browser/xwalk_navigation_override_throttle.h"
 #include "xwalk/runtime/browser/xwalk_platform_notification_service.h"
 #include "xwalk/runtime/browser/xwalk_render_message_filter.h"
 #include "xwalk/runtime/browser/xwalk_runner.h"
+#include "xwalk/runtime/browser/xwalk_ssl_host_state_delegate.h"
 #include "xwalk/runtime/common/xwalk_paths.h"
 #include "xwalk/runtime/common/xwalk_switches.h"
 #include "xwalk/runtime/browser/devtools/xwalk_devtools_manager_delegate.h"
@@ -87,8 +93,6 @@
 #include "base/base_paths_android.h"
 #include "components/cdm/browser/cdm_message_filter_android.h"
 #include "components/navigation_interception/intercept_navigation_delegate.h"
-#include "content/public/browser/navigation_handle.h"
-#include "content/public/browser/navigation_throttle.h"
 #include "xwalk/runtime/browser/android/net/url_constants.h"
 #include "xwalk/runtime/browser/android/xwalk_http_auth_handler.h"
 #include "xwalk/runtime/browser/android/xwalk_cookie_access_policy.h"
@@ -131,6 +135,55 @@ namespace {
 // The application-wide singleton of ContentBrowserClient impl.
 XWalkContentBrowserClient* g_browser_client = nullptr;
 
+// Runs once the SSL exceptions stored on disk are loaded. Content asked the
+// delegate before, so a decision from an earlier run is checked here rather
+// than asking the user again.
+void AllowCertificateErrorWhenLoaded(
+    int render_process_id,
+    int render_frame_id,
+    int cert_error,
+    const net::SSLInfo& ssl_info,
+    const GURL& request_url,
+    const base::Callback<void(content::CertificateRequestResultType)>&
+        callback) {
+  content::WebContents* web_contents = content::WebContents::FromRenderFrameHost(
+      content::RenderFrameHost::FromID(render_process_id, render_frame_id));
+  if (!web_contents) {
+    callback.Run(content::CERTIFICATE_REQUEST_RESULT_TYPE_CANCEL);
+    return;
+  }
+
+  bool expired_previous_decision = false;
+  if (ssl_info.cert &&
+      web_contents->GetBrowserContext()->GetSSLHostStateDelegate()->QueryPolicy(
+          request_url.host(), *ssl_info.cert, cert_error,
+          &expired_previous_decision) ==
+          content::SSLHostStateDelegate::ALLOWED) {
+    callback.Run(content::CERTIFICATE_REQUEST_RESULT_TYPE_CONTINUE);
+    return;
+  }
+
+  // Currently only Android handles it.
+  // TODO(yongsheng): applies it for other platforms?
+#if defined(OS_ANDROID)
+  XWalkContentsClientBridge* client =
+      XWalkContentsClientBridge::FromWebContents(web_contents);
+  if (client) {
+    client->AllowCertificateError(cert_error,
+                                  ssl_info.cert.get(),
+                                  request_url,
+                                  callback);
+  } else {
+    callback.Run(content::CERTIFICATE_REQUEST_RESULT_TYPE_DENY);
+  }
+#else
+  // The interstitial page shown is responsible for destroying
+  // this instance of SSLErrorPage
+  (new SSLErrorPage(web_contents, cert_error,
+                    ssl_info, request_url, callback))->Show();
+#endif
+}
+
 //void PassMojoCookieManagerToAwCookieManager(
 //    const network::mojom::NetworkContextPtr& network_context) {
 //  // Get the CookieManager from the NetworkContext.
@@ -278,6 +331,11 @@ void XWalkContentBrowserClient::RunServiceInstance(const service_manager::Identi
 // process we launch.
 void XWalkContentBrowserClient::AppendExtraCommandLineSwitches(
     base::CommandLine* command_line, int child_process_id) {
+  static const char* const kSwitchesToCopy[] = {
+      switches::kEnableIPCLatency,
+  };
+  command_line->CopySwitchesFrom(*base::CommandLine::ForCurrentProcess(),
+                                 kSwitchesToCopy, base::size(kSwitchesToCopy));
 //  const base::CommandLine& browser_process_cmd_line =
 //      *base::CommandLine::ForCurrentProcess();
 //  const char* extra_switches[] = {
@@ -312,13 +370,7 @@ XWalkContentBrowserClient::CreateQuotaPermissionContext() {
 content::GeneratedCodeCacheSettings
 XWalkContentBrowserClient::GetGeneratedCodeCacheSettings(
     content::BrowserContext* context) {
-  // If we pass 0 for size, disk_cache will pick a default size using the
-  // heuristics based on available disk size. These are implemented in
-  // disk_cache::PreferredCacheSize in net/disk_cache/cache_util.cc.
-//  return content::GeneratedCodeCacheSettings(true, 0, context->GetPath());
-  base::FilePath path(context->GetPath());
-  // TODO(iotto): disabled Code Cache
-  return content::GeneratedCodeCacheSettings(false, 0, path);
+  return XWalkCodeCache::GetSettings(context);
 }
 
 content::WebContentsViewDelegate*
@@ -417,27 +469,13 @@ void XWalkContentBrowserClient::AllowCertificateError(content::WebContents* web_
       bool expired_previous_decision,
       const base::Callback<void(content::CertificateRequestResultType)>& callback) {
   TENTA_LOG(ERROR) << __func__ << " error=" << cert_error << " url=" << request_url;
-  // Currently only Android handles it.
-  // TODO(yongsheng): applies it for other platforms?
-#if defined(OS_ANDROID)
-  XWalkContentsClientBridge* client =
-      XWalkContentsClientBridge::FromWebContents(web_contents);
-  bool cancel_request = true;
-  if (client)
-    client->AllowCertificateError(cert_error,
-                                  ssl_info.cert.get(),
-                                  request_url,
-                                  callback, &cancel_request);
-
-  if (cancel_request)
-    callback.Run(content::CERTIFICATE_REQUEST_RESULT_TYPE_DENY);
-#else
   DCHECK(web_contents);
-  // The interstitial page shown is responsible for destroying
-  // this instance of SSLErrorPage
-  (new SSLErrorPage(web_contents, cert_error,
-                    ssl_info, request_url, callback))->Show();
-#endif
+  content::RenderFrameHost* frame = web_contents->GetMainFrame();
+  static_cast<XWalkSSLHostStateDelegate*>(
+      web_contents->GetBrowserContext()->GetSSLHostStateDelegate())
+      ->RunWhenLoaded(base::BindOnce(
+          &AllowCertificateErrorWhenLoaded, frame->GetProcess()->GetID(),
+          frame->GetRoutingID(), cert_error, ssl_info, request_url, callback));
 }
 
 content::PlatformNotificationService*
@@ -600,19 +638,23 @@ std::string XWalkContentBrowserClient::GetUserAgent() {
   return xwalk::GetUserAgent();
 }
 
-#if defined(OS_ANDROID)
 std::vector<std::unique_ptr<content::NavigationThrottle>>
 XWalkContentBrowserClient::CreateThrottlesForNavigation(
     content::NavigationHandle* navigation_handle) {
   std::vector<std::unique_ptr<content::NavigationThrottle>> throttles;
+  // shouldOverrideUrlLoading, asked without blocking the renderer. It goes
+  // first so a navigation the embedder drops never posts onPageStarted.
+  std::unique_ptr<content::NavigationThrottle> override_throttle =
+      XWalkNavigationOverrideThrottle::MaybeCreate(navigation_handle);
+  if (override_throttle)
+    throttles.push_back(std::move(override_throttle));
+#if defined(OS_ANDROID)
   // We allow intercepting only navigations within main frames. This
-  // is used to post onPageStarted. We handle shouldOverrideUrlLoading
-  // via a sync IPC.
+  // is used to post onPageStarted.
   if (navigation_handle->IsInMainFrame()) {
     // Use Synchronous mode for the navigation interceptor, since this class
     // doesn't actually call into an arbitrary client, it just posts a task to
-    // call onPageStarted. shouldOverrideUrlLoading happens earlier (see
-    // ContentBrowserClient::ShouldOverrideUrlLoading).
+    // call onPageStarted.
     throttles.push_back(
         navigation_interception::InterceptNavigationDelegate::CreateThrottleFor(
             navigation_handle, navigation_interception::SynchronyMode::kSync));
@@ -621,9 +663,14 @@ XWalkContentBrowserClient::CreateThrottlesForNavigation(
 //        navigation_handle, AwBrowserContext::FromWebContents(
 //                               navigation_handle->GetWebContents())));
   }
+#endif
+  // No page may load while the code cache moves to another zone.
+  std::unique_ptr<content::NavigationThrottle> code_cache_throttle =
+      XWalkCodeCache::MaybeCreateThrottle(navigation_handle);
+  if (code_cache_throttle)
+    throttles.push_back(std::move(code_cache_throttle));
   return throttles;
 }
-#endif // OS_ANDROID
 
 base::Optional<service_manager::Manifest>
 XWalkContentBrowserClient::GetServiceManifestOverlay(base::StringPiece name) {
@@ -178,10 +178,8 @@ class XWalkContentBrowserClient : public content::ContentBrowserClient {
   std::string GetProduct() override;
   std::string GetUserAgent() override;
 
-#if defined(OS_ANDROID)
   std::vector<std::unique_ptr<content::NavigationThrottle>> CreateThrottlesForNavigation(
       content::NavigationHandle* navigation_handle) override;
-#endif
 
   std::unique_ptr<content::LoginDelegate> CreateLoginDelegate(const net::AuthChallengeInfo& auth_info,
                                                               content::WebContents* web_contents,
@@ -0,0 +1,152 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// document.cookie reads are cached by XwalkProxyingRestrictedCookieManager.
+// Checks that a polling page sees its own writes, the cookies set by its
+// loads and the writes of other frames at once, and browser side changes as
+// they are reported, and measures how many reads it gets through.
+
+#include <string>
+
+#include "base/files/file_path.h"
+#include "base/strings/stringprintf.h"
+#include "content/public/browser/web_contents.h"
+#include "content/public/test/browser_test_utils.h"
+#include "net/test/embedded_test_server/embedded_test_server.h"
+#include "xwalk/runtime/browser/runtime.h"
+#include "xwalk/runtime/browser/xwalk_browser_context.h"
+#include "xwalk/test/base/in_process_browser_test.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+#include "xwalk/test/base/xwalk_test_utils.h"
+
+using xwalk::Runtime;
+using xwalk::XWalkBrowserContext;
+
+namespace {
+
+const char kPage[] = "/cookie_polling.html";
+
+}  // namespace
+
+class XWalkCookieCacheBrowserTest : public InProcessBrowserTest {
+ protected:
+  void SetUp() override {
+    // The default handlers answer /set-cookie?<cookies>.
+    embedded_test_server()->AddDefaultHandlers(
+        base::FilePath(FILE_PATH_LITERAL("xwalk/test/data")));
+    ASSERT_TRUE(embedded_test_server()->Start());
+    InProcessBrowserTest::SetUp();
+  }
+
+  GURL GetURL() { return embedded_test_server()->GetURL(kPage); }
+
+  Runtime* LoadPage() {
+    Runtime* runtime = CreateRuntime(GURL());
+    xwalk_test_utils::NavigateToURL(runtime, GetURL());
+    return runtime;
+  }
+
+  std::string Write(Runtime* runtime, const std::string& cookie) {
+    std::string result;
+    EXPECT_TRUE(content::ExecuteScriptAndExtractString(
+        runtime->web_contents(),
+        base::StringPrintf("document.cookie = '%s';"
+                           "window.domAutomationController.send("
+                           "    document.cookie);",
+                           cookie.c_str()),
+        &result));
+    return result;
+  }
+
+  std::string WaitForCookie(Runtime* runtime, const std::string& expected) {
+    std::string result;
+    EXPECT_TRUE(content::ExecuteScriptAndExtractString(
+        runtime->web_contents(),
+        base::StringPrintf("waitForCookie('%s');", expected.c_str()),
+        &result));
+    return result;
+  }
+
+  // Runs |function| of the page with |arg| and returns the document.cookie
+  // it reports.
+  std::string ReadAfter(Runtime* runtime,
+                        const std::string& function,
+                        const std::string& arg) {
+    std::string result;
+    EXPECT_TRUE(content::ExecuteScriptAndExtractString(
+        runtime->web_contents(),
+        base::StringPrintf("%s('%s');", function.c_str(), arg.c_str()),
+        &result));
+    return result;
+  }
+
+  void SetCookieFromBrowser(const std::string& cookie) {
+    ASSERT_TRUE(
+        content::SetCookie(XWalkBrowserContext::GetDefault(), GetURL(), cookie));
+  }
+};
+
+IN_PROC_BROWSER_TEST_F(XWalkCookieCacheBrowserTest, SeesOwnWrites) {
+  Runtime* runtime = LoadPage();
+  // Each read follows a write, which must drop what the read before cached.
+  EXPECT_EQ("a=1", Write(runtime, "a=1"));
+  EXPECT_EQ("a=2", Write(runtime, "a=2"));
+  EXPECT_EQ("a=2; b=1", Write(runtime, "b=1"));
+  EXPECT_EQ("b=1", Write(runtime, "a=; max-age=0"));
+}
+
+// No polling here, the first read after the response must have the cookie.
+IN_PROC_BROWSER_TEST_F(XWalkCookieCacheBrowserTest, SeesCookiesOfLoads) {
+  Runtime* runtime = LoadPage();
+  EXPECT_EQ("a=1", Write(runtime, "a=1"));
+  EXPECT_EQ("a=1; f=1",
+            ReadAfter(runtime, "readAfterFetch", "/set-cookie?f=1"));
+  EXPECT_EQ("a=1; f=1; x=1",
+            ReadAfter(runtime, "readAfterXhr", "/set-cookie?x=1"));
+  EXPECT_EQ("a=1; f=2; x=1",
+            ReadAfter(runtime, "readAfterFetch", "/set-cookie?f=2"));
+}
+
+IN_PROC_BROWSER_TEST_F(XWalkCookieCacheBrowserTest, SeesWritesOfOtherFrames) {
+  Runtime* runtime = LoadPage();
+  EXPECT_EQ("a=1", Write(runtime, "a=1"));
+  EXPECT_EQ("a=1; g=1", ReadAfter(runtime, "readAfterFrameWrite", "g=1"));
+  EXPECT_EQ("a=2; g=1", ReadAfter(runtime, "readAfterFrameWrite", "a=2"));
+}
+
+IN_PROC_BROWSER_TEST_F(XWalkCookieCacheBrowserTest, SeesBrowserChanges) {
+  Runtime* runtime = LoadPage();
+  EXPECT_EQ("a=1", Write(runtime, "a=1"));
+  // Cached now.
+  EXPECT_EQ("a=1", WaitForCookie(runtime, "a=1"));
+
+  SetCookieFromBrowser("b=2");
+  EXPECT_EQ("a=1; b=2", WaitForCookie(runtime, "a=1; b=2"));
+
+  SetCookieFromBrowser("a=; max-age=0");
+  EXPECT_EQ("b=2", WaitForCookie(runtime, "b=2"));
+
+  // HttpOnly cookies are not for document.cookie, but still invalidate.
+  SetCookieFromBrowser("c=3; HttpOnly");
+  SetCookieFromBrowser("b=4");
+  EXPECT_EQ("b=4", WaitForCookie(runtime, "b=4"));
+}
+
+IN_PROC_BROWSER_TEST_F(XWalkCookieCacheBrowserTest, ReadsPerSecond) {
+  Runtime* runtime = LoadPage();
+  Write(runtime, "session=0123456789abcdef; max-age=3600");
+  Write(runtime, "theme=dark; max-age=3600");
+
+  int reads_per_second = 0;
+  ASSERT_TRUE(content::ExecuteScriptAndExtractInt(
+      runtime->web_contents(), "measureReads(500);", &reads_per_second));
+  EXPECT_GT(reads_per_second, 0);
+  XWalkBenchmark::ReportValue("document_cookie_reads", "_polling", "reads/s",
+                              reads_per_second);
+
+  // Still fresh after all those cached reads.
+  SetCookieFromBrowser("theme=light");
+  EXPECT_EQ("session=0123456789abcdef; theme=light",
+            WaitForCookie(runtime, "session=0123456789abcdef; theme=light"));
+}
@@ -0,0 +1,142 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/xwalk_directory_enumerator.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/files/file_enumerator.h"
+#include "base/no_destructor.h"
+#include "base/task/post_task.h"
+#include "base/task_runner_util.h"
+#include "content/public/browser/browser_thread.h"
+#include "content/public/browser/file_select_listener.h"
+
+using content::BrowserThread;
+
+namespace xwalk {
+
+namespace {
+
+XWalkDirectoryEnumerator::ChunkObserver* GetChunkObserver() {
+  static base::NoDestructor<XWalkDirectoryEnumerator::ChunkObserver> observer;
+  return observer.get();
+}
+
+size_t g_max_files_for_testing = 0;
+
+}  // namespace
+
+// Owns the FileEnumerator, only used on the worker sequence.
+class XWalkDirectoryEnumerator::Walker {
+ public:
+  explicit Walker(const base::FilePath& path)
+      : enumerator_(path, true /* recursive */, base::FileEnumerator::FILES) {}
+
+  // Returns up to |max_count| more files, none once the walk is over.
+  std::vector<base::FilePath> Next(size_t max_count) {
+    std::vector<base::FilePath> chunk;
+    chunk.reserve(max_count);
+    while (chunk.size() < max_count) {
+      base::FilePath path = enumerator_.Next();
+      if (path.empty())
+        break;
+      chunk.push_back(std::move(path));
+    }
+    return chunk;
+  }
+
+ private:
+  base::FileEnumerator enumerator_;
+
+  DISALLOW_COPY_AND_ASSIGN(Walker);
+};
+
+const size_t XWalkDirectoryEnumerator::kChunkSize;
+const size_t XWalkDirectoryEnumerator::kMaxFiles;
+
+// static
+void XWalkDirectoryEnumerator::Start(
+    content::WebContents* web_contents,
+    std::unique_ptr<content::FileSelectListener> listener,
+    const base::FilePath& path) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  XWalkDirectoryEnumerator* enumerator =
+      new XWalkDirectoryEnumerator(web_contents, std::move(listener), path);
+  enumerator->RequestChunk();
+}
+
+// static
+void XWalkDirectoryEnumerator::SetChunkObserverForTesting(
+    const ChunkObserver& observer) {
+  *GetChunkObserver() = observer;
+}
+
+// static
+void XWalkDirectoryEnumerator::SetMaxFilesForTesting(size_t max_files) {
+  g_max_files_for_testing = max_files;
+}
+
+XWalkDirectoryEnumerator::XWalkDirectoryEnumerator(
+    content::WebContents* web_contents,
+    std::unique_ptr<content::FileSelectListener> listener,
+    const base::FilePath& path)
+    : content::WebContentsObserver(web_contents),
+      listener_(std::move(listener)),
+      path_(path),
+      max_files_(g_max_files_for_testing ? g_max_files_for_testing
+                                         : kMaxFiles),
+      task_runner_(base::CreateSequencedTaskRunnerWithTraits(
+          {base::MayBlock(), base::TaskPriority::USER_VISIBLE,
+           base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN})),
+      walker_(new Walker(path), base::OnTaskRunnerDeleter(task_runner_)),
+      weak_factory_(this) {}
+
+XWalkDirectoryEnumerator::~XWalkDirectoryEnumerator() {}
+
+void XWalkDirectoryEnumerator::RequestChunk() {
+  const size_t count = std::min(kChunkSize, max_files_ - files_.size());
+  base::PostTaskAndReplyWithResult(
+      task_runner_.get(), FROM_HERE,
+      // |walker_| is deleted on |task_runner_| after this task has run.
+      base::BindOnce(&Walker::Next, base::Unretained(walker_.get()), count),
+      base::BindOnce(&XWalkDirectoryEnumerator::OnChunk,
+                     weak_factory_.GetWeakPtr()));
+}
+
+void XWalkDirectoryEnumerator::OnChunk(std::vector<base::FilePath> chunk) {
+  for (const base::FilePath& path : chunk) {
+    files_.push_back(blink::mojom::FileChooserFileInfo::NewNativeFile(
+        blink::mojom::NativeFileInfo::New(path, base::string16())));
+  }
+
+  const ChunkObserver& observer = *GetChunkObserver();
+  if (!observer.is_null() && !chunk.empty())
+    observer.Run(files_.size());
+
+  if (chunk.empty() || files_.size() >= max_files_) {
+    Finish();
+    return;
+  }
+  RequestChunk();
+}
+
+void XWalkDirectoryEnumerator::Finish() {
+  if (files_.size() >= max_files_) {
+    LOG(WARNING) << "Listing of " << path_.value() << " stopped at "
+                 << files_.size() << " files";
+  }
+  listener_->FileSelected(std::move(files_), path_,
+                          blink::mojom::FileChooserParams::Mode::kUploadFolder);
+  delete this;
+}
+
+void XWalkDirectoryEnumerator::WebContentsDestroyed() {
+  listener_->FileSelectionCanceled();
+  delete this;
+}
+
+}  // namespace xwalk
@@ -0,0 +1,86 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_BROWSER_XWALK_DIRECTORY_ENUMERATOR_H_
+#define XWALK_RUNTIME_BROWSER_XWALK_DIRECTORY_ENUMERATOR_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "base/sequenced_task_runner.h"
+#include "content/public/browser/web_contents_observer.h"
+#include "third_party/blink/public/mojom/choosers/file_chooser.mojom.h"
+
+namespace content {
+class FileSelectListener;
+}
+
+namespace xwalk {
+
+// Lists every file below a directory for <input webkitdirectory>.
+//
+// The tree is walked on a worker that may block, one chunk of kChunkSize
+// files at a time. The UI thread asks for the next chunk only once it has
+// taken the previous one, so the worker never runs ahead and at most one
+// chunk is in flight. The listener gets all files at once when the walk is
+// over, since FileSelectListener has no way to take them in parts. Trees
+// with more than kMaxFiles files are cut off there to bound memory.
+//
+// If the WebContents goes away first, the walk stops after the current
+// chunk and the selection is canceled.
+class XWalkDirectoryEnumerator : public content::WebContentsObserver {
+ public:
+  static const size_t kChunkSize = 512;
+  static const size_t kMaxFiles = 200000;
+
+  // Called on the UI thread after every chunk with the number of files
+  // found so far.
+  using ChunkObserver = base::RepeatingCallback<void(size_t files)>;
+
+  // Deletes itself once the listener has been answered.
+  static void Start(content::WebContents* web_contents,
+                    std::unique_ptr<content::FileSelectListener> listener,
+                    const base::FilePath& path);
+
+  // Pass a null callback, or 0, to restore the defaults.
+  static void SetChunkObserverForTesting(const ChunkObserver& observer);
+  static void SetMaxFilesForTesting(size_t max_files);
+
+ private:
+  class Walker;
+
+  XWalkDirectoryEnumerator(
+      content::WebContents* web_contents,
+      std::unique_ptr<content::FileSelectListener> listener,
+      const base::FilePath& path);
+  ~XWalkDirectoryEnumerator() override;
+
+  void RequestChunk();
+  void OnChunk(std::vector<base::FilePath> chunk);
+  void Finish();
+
+  // content::WebContentsObserver implementation.
+  void WebContentsDestroyed() override;
+
+  std::unique_ptr<content::FileSelectListener> listener_;
+  const base::FilePath path_;
+  const size_t max_files_;
+  scoped_refptr<base::SequencedTaskRunner> task_runner_;
+  // Lives on |task_runner_|.
+  std::unique_ptr<Walker, base::OnTaskRunnerDeleter> walker_;
+  std::vector<blink::mojom::FileChooserFileInfoPtr> files_;
+  base::WeakPtrFactory<XWalkDirectoryEnumerator> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkDirectoryEnumerator);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_BROWSER_XWALK_DIRECTORY_ENUMERATOR_H_
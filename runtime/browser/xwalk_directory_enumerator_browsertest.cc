@@ -0,0 +1,209 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/xwalk_directory_enumerator.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/macros.h"
+#include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
+#include "base/threading/thread_restrictions.h"
+#include "base/time/time.h"
+#include "content/public/browser/file_select_listener.h"
+#include "content/public/browser/web_contents.h"
+#include "content/public/browser/web_contents_delegate.h"
+#include "xwalk/runtime/browser/runtime.h"
+#include "xwalk/runtime/browser/xwalk_browser_context.h"
+#include "xwalk/test/base/in_process_browser_test.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+
+using xwalk::Runtime;
+using xwalk::XWalkBrowserContext;
+using xwalk::XWalkDirectoryEnumerator;
+
+namespace {
+
+const int kDirectoryCount = 20;
+const int kFilesPerDirectory = 500;
+const int kFileCount = kDirectoryCount * kFilesPerDirectory;
+
+struct Selection {
+  Selection()
+      : selected(false),
+        canceled(false),
+        mode(blink::mojom::FileChooserParams::Mode::kOpen) {}
+
+  bool selected;
+  bool canceled;
+  std::vector<blink::mojom::FileChooserFileInfoPtr> files;
+  base::FilePath base_dir;
+  blink::mojom::FileChooserParams::Mode mode;
+};
+
+class TestFileSelectListener : public content::FileSelectListener {
+ public:
+  TestFileSelectListener(Selection* selection, base::OnceClosure done)
+      : selection_(selection), done_(std::move(done)) {}
+  ~TestFileSelectListener() override {}
+
+  void FileSelected(std::vector<blink::mojom::FileChooserFileInfoPtr> files,
+                    const base::FilePath& base_dir,
+                    blink::mojom::FileChooserParams::Mode mode) override {
+    selection_->selected = true;
+    selection_->files = std::move(files);
+    selection_->base_dir = base_dir;
+    selection_->mode = mode;
+    std::move(done_).Run();
+  }
+
+  void FileSelectionCanceled() override {
+    selection_->canceled = true;
+    std::move(done_).Run();
+  }
+
+ private:
+  Selection* selection_;
+  base::OnceClosure done_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestFileSelectListener);
+};
+
+void OnChunk(base::TimeTicks* first_chunk, int* chunks, size_t files) {
+  if (first_chunk->is_null())
+    *first_chunk = base::TimeTicks::Now();
+  ++*chunks;
+}
+
+}  // namespace
+
+class XWalkDirectoryEnumeratorBrowserTest : public InProcessBrowserTest {
+ protected:
+  // The tree is built before the browser starts, while blocking is allowed.
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    for (int i = 0; i < kDirectoryCount; ++i) {
+      // Every other directory is nested one level deeper.
+      base::FilePath dir =
+          temp_dir_.GetPath().AppendASCII(base::StringPrintf("dir%d", i));
+      if (i % 2)
+        dir = dir.AppendASCII("nested");
+      ASSERT_TRUE(base::CreateDirectory(dir));
+      for (int j = 0; j < kFilesPerDirectory; ++j) {
+        ASSERT_EQ(1, base::WriteFile(
+                         dir.AppendASCII(base::StringPrintf("file%d.txt", j)),
+                         "x", 1));
+      }
+    }
+    // Empty directories are not listed.
+    ASSERT_TRUE(
+        base::CreateDirectory(temp_dir_.GetPath().AppendASCII("empty")));
+    InProcessBrowserTest::SetUp();
+  }
+
+  void TearDown() override {
+    InProcessBrowserTest::TearDown();
+    base::ScopedAllowBlockingForTesting allow_blocking;
+    ASSERT_TRUE(temp_dir_.Delete());
+  }
+
+  void ProperMainThreadCleanup() override {
+    XWalkDirectoryEnumerator::SetChunkObserverForTesting(
+        XWalkDirectoryEnumerator::ChunkObserver());
+    XWalkDirectoryEnumerator::SetMaxFilesForTesting(0);
+  }
+
+  // Lists the tree the way <input webkitdirectory> does.
+  void Enumerate(Runtime* runtime, Selection* selection) {
+    base::RunLoop run_loop;
+    content::WebContents* web_contents = runtime->web_contents();
+    web_contents->GetDelegate()->EnumerateDirectory(
+        web_contents,
+        std::make_unique<TestFileSelectListener>(selection,
+                                                 run_loop.QuitClosure()),
+        temp_dir_.GetPath());
+    run_loop.Run();
+  }
+
+  base::ScopedTempDir temp_dir_;
+};
+
+IN_PROC_BROWSER_TEST_F(XWalkDirectoryEnumeratorBrowserTest, ListsWholeTree) {
+  Runtime* runtime = CreateRuntime(GURL());
+  base::TimeTicks first_chunk;
+  int chunks = 0;
+  XWalkDirectoryEnumerator::SetChunkObserverForTesting(
+      base::BindRepeating(&OnChunk, &first_chunk, &chunks));
+
+  Selection selection;
+  const base::TimeTicks start = base::TimeTicks::Now();
+  Enumerate(runtime, &selection);
+  const base::TimeDelta total = base::TimeTicks::Now() - start;
+
+  ASSERT_TRUE(selection.selected);
+  EXPECT_EQ(temp_dir_.GetPath(), selection.base_dir);
+  EXPECT_EQ(blink::mojom::FileChooserParams::Mode::kUploadFolder,
+            selection.mode);
+  ASSERT_EQ(static_cast<size_t>(kFileCount), selection.files.size());
+  for (const auto& file : selection.files) {
+    ASSERT_TRUE(file->is_native_file());
+    EXPECT_TRUE(
+        temp_dir_.GetPath().IsParent(file->get_native_file()->file_path));
+  }
+  // The files came in several chunks, not all at once.
+  EXPECT_GE(static_cast<size_t>(chunks),
+            kFileCount / XWalkDirectoryEnumerator::kChunkSize);
+
+  ASSERT_FALSE(first_chunk.is_null());
+  XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+      "directory_enumeration", "_first_chunk",
+      {(first_chunk - start).InMicrosecondsF()}));
+  XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+      "directory_enumeration", "_total", {total.InMicrosecondsF()}));
+}
+
+IN_PROC_BROWSER_TEST_F(XWalkDirectoryEnumeratorBrowserTest,
+                       StopsAtFileLimit) {
+  const size_t kLimit = XWalkDirectoryEnumerator::kChunkSize * 2 + 1;
+  XWalkDirectoryEnumerator::SetMaxFilesForTesting(kLimit);
+  Runtime* runtime = CreateRuntime(GURL());
+
+  Selection selection;
+  Enumerate(runtime, &selection);
+  ASSERT_TRUE(selection.selected);
+  EXPECT_EQ(kLimit, selection.files.size());
+}
+
+IN_PROC_BROWSER_TEST_F(XWalkDirectoryEnumeratorBrowserTest,
+                       CancelsWhenWebContentsGoesAway) {
+  std::unique_ptr<content::WebContents> web_contents =
+      content::WebContents::Create(content::WebContents::CreateParams(
+          XWalkBrowserContext::GetDefault()));
+  int chunks = 0;
+  base::TimeTicks first_chunk;
+  XWalkDirectoryEnumerator::SetChunkObserverForTesting(
+      base::BindRepeating(&OnChunk, &first_chunk, &chunks));
+
+  Selection selection;
+  base::RunLoop run_loop;
+  XWalkDirectoryEnumerator::Start(
+      web_contents.get(),
+      std::make_unique<TestFileSelectListener>(&selection,
+                                               run_loop.QuitClosure()),
+      temp_dir_.GetPath());
+  // The first chunk is still being listed.
+  web_contents.reset();
+  run_loop.Run();
+
+  EXPECT_TRUE(selection.canceled);
+  EXPECT_FALSE(selection.selected);
+  // The chunk that was in flight is dropped, and no more are listed.
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(0, chunks);
+}
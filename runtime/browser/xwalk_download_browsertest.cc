@@ -3,14 +3,40 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <inttypes.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/guid.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/run_loop.h"
 #include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/thread_restrictions.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "base/time/time.h"
+#include "components/download/public/common/download_item.h"
+#include "components/download/public/common/parallel_download_utils.h"
+#include "net/http/http_byte_range.h"
+#include "net/http/http_util.h"
+#include "net/test/embedded_test_server/embedded_test_server.h"
+#include "net/test/embedded_test_server/http_request.h"
+#include "net/test/embedded_test_server/http_response.h"
 #include "xwalk/runtime/browser/runtime.h"
 #include "xwalk/runtime/browser/runtime_download_manager_delegate.h"
 #include "xwalk/runtime/browser/ui/color_chooser.h"
+#include "xwalk/runtime/browser/xwalk_download_registry.h"
 #include "xwalk/test/base/in_process_browser_test.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
 #include "xwalk/test/base/xwalk_test_utils.h"
 #include "content/browser/download/download_manager_impl.h"
 #include "content/public/browser/browser_context.h"
@@ -22,7 +48,8 @@
 
 using xwalk::Runtime;
 using xwalk::RuntimeDownloadManagerDelegate;
-using content::DownloadItem;
+using xwalk::XWalkDownloadRegistry;
+using download::DownloadItem;
 using content::DownloadManager;
 using content::DownloadManagerImpl;
 using content::DownloadTestObserver;
@@ -31,26 +58,138 @@ using content::BrowserContext;
 
 namespace {
 
+const int64_t kBigFileSize = 16 * 1024 * 1024;
+const size_t kSendChunkSize = 64 * 1024;
+const char kBigFilePath[] = "/big.bin";
+const char kETag[] = "\"xwalk-download-1\"";
+const char kLastModified[] = "Tue, 15 Oct 2019 10:00:00 GMT";
+const uint32_t kRestoredId = 42;
+
 static DownloadManagerImpl* DownloadManagerForXWalk(Runtime* runtime) {
   return static_cast<DownloadManagerImpl*>(
       BrowserContext::GetDownloadManager(
           runtime->web_contents()->GetBrowserContext()));
 }
 
+std::string MakeContent(int64_t size) {
+  std::string content(size, '\0');
+  for (int64_t i = 0; i < size; ++i)
+    content[i] = static_cast<char>(i % 251);
+  return content;
+}
+
+void SendBody(
+    const net::test_server::HttpResponse::SendBytesCallback& send,
+    const net::test_server::HttpResponse::SendCompleteCallback& done,
+    scoped_refptr<base::RefCountedString> body,
+    size_t offset,
+    size_t end,
+    base::TimeDelta delay);
+
+void SendNextChunk(
+    const net::test_server::HttpResponse::SendBytesCallback& send,
+    const net::test_server::HttpResponse::SendCompleteCallback& done,
+    scoped_refptr<base::RefCountedString> body,
+    size_t offset,
+    size_t end,
+    base::TimeDelta delay) {
+  base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(
+      FROM_HERE,
+      base::BindOnce(&SendBody, send, done, body, offset, end, delay),
+      delay);
+}
+
+// Sends bytes [offset, end) of |body|, a chunk every |delay|. Closing the
+// connection early, when |end| is short of what the headers announced, is
+// how a dropped connection is simulated.
+void SendBody(
+    const net::test_server::HttpResponse::SendBytesCallback& send,
+    const net::test_server::HttpResponse::SendCompleteCallback& done,
+    scoped_refptr<base::RefCountedString> body,
+    size_t offset,
+    size_t end,
+    base::TimeDelta delay) {
+  if (offset >= end) {
+    done.Run();
+    return;
+  }
+  const size_t size = std::min(kSendChunkSize, end - offset);
+  send.Run(body->data().substr(offset, size),
+           base::BindRepeating(&SendNextChunk, send, done, body,
+                               offset + size, end, delay));
+}
+
+// The response object is gone once SendResponse() returns, everything the
+// chunks need is bound into the callbacks.
+class RangeResponse : public net::test_server::HttpResponse {
+ public:
+  RangeResponse(scoped_refptr<base::RefCountedString> body,
+                const std::string& headers,
+                size_t offset,
+                size_t end,
+                base::TimeDelta delay)
+      : body_(body),
+        headers_(headers),
+        offset_(offset),
+        end_(end),
+        delay_(delay) {}
+  ~RangeResponse() override {}
+
+  void SendResponse(const SendBytesCallback& send,
+                    const SendCompleteCallback& done) override {
+    send.Run(headers_, base::BindRepeating(&SendBody, send, done, body_,
+                                           offset_, end_, delay_));
+  }
+
+ private:
+  scoped_refptr<base::RefCountedString> body_;
+  const std::string headers_;
+  const size_t offset_;
+  const size_t end_;
+  const base::TimeDelta delay_;
+
+  DISALLOW_COPY_AND_ASSIGN(RangeResponse);
+};
+
+void StoreId(uint32_t* out, uint32_t id) {
+  *out = id;
+}
+
+void StoreIdAndQuit(uint32_t* out,
+                    const base::RepeatingClosure& quit,
+                    uint32_t id) {
+  *out = id;
+  quit.Run();
+}
+
 class XWalkDownloadBrowserTest : public InProcessBrowserTest {
  public:
   XWalkDownloadBrowserTest()
     : InProcessBrowserTest(),
-      runtime_(nullptr) {}
+      runtime_(nullptr),
+      disconnect_at_(-1),
+      request_count_(0) {
+    std::string content = MakeContent(kBigFileSize);
+    content_ = base::RefCountedString::TakeString(&content);
+  }
 
-  void SetUpOnMainThread() override {
+  void SetUp() override {
     ASSERT_TRUE(downloads_directory_.CreateUniqueTempDir());
-    runtime_ = CreateRuntime(GURL());
+    // Keeps the download registry of one test away from the others.
+    ASSERT_TRUE(data_directory_.CreateUniqueTempDir());
+    ASSERT_TRUE(xwalk_test_utils::OverrideDataPathDir(
+        data_directory_.GetPath()));
+    embedded_test_server()->RegisterRequestHandler(base::BindRepeating(
+        &XWalkDownloadBrowserTest::HandleRequest, base::Unretained(this)));
+    ASSERT_TRUE(embedded_test_server()->Start());
+    SeedDataPath();
+    InProcessBrowserTest::SetUp();
+  }
 
-    DownloadManagerImpl* manager = DownloadManagerForXWalk(runtime_);
-    RuntimeDownloadManagerDelegate* delegate =
-        static_cast<RuntimeDownloadManagerDelegate*>(manager->GetDelegate());
-    delegate->SetDownloadBehaviorForTesting(downloads_directory_.path());
+  void SetUpOnMainThread() override {
+    runtime_ = CreateRuntime(GURL());
+    GetDelegate()->SetDownloadBehaviorForTesting(
+        downloads_directory_.GetPath());
   }
 
   // Create a DownloadTestObserverTerminal that will wait for the
@@ -62,11 +201,110 @@ class XWalkDownloadBrowserTest : public InProcessBrowserTest {
   }
 
  protected:
+  // Runs before the browser starts, once the data path is in place.
+  virtual void SeedDataPath() {}
+
+  RuntimeDownloadManagerDelegate* GetDelegate() {
+    return static_cast<RuntimeDownloadManagerDelegate*>(
+        DownloadManagerForXWalk(runtime_)->GetDelegate());
+  }
+
+  // Serves |content_| with validators and range support. The first full
+  // response is cut off at |disconnect_at_| if set, every chunk is delayed
+  // by |chunk_delay_|.
+  std::unique_ptr<net::test_server::HttpResponse> HandleRequest(
+      const net::test_server::HttpRequest& request) {
+    if (request.relative_url != kBigFilePath)
+      return nullptr;
+
+    const int64_t size = content_->size();
+    int64_t first = 0;
+    int64_t last = size - 1;
+    bool partial = false;
+    std::vector<net::HttpByteRange> ranges;
+    auto range = request.headers.find("Range");
+    auto if_range = request.headers.find("If-Range");
+    if (range != request.headers.end() &&
+        (if_range == request.headers.end() || if_range->second == kETag) &&
+        net::HttpUtil::ParseRangeHeader(range->second, &ranges) &&
+        ranges.size() == 1 && ranges[0].ComputeBounds(size)) {
+      first = ranges[0].first_byte_position();
+      last = ranges[0].last_byte_position();
+      partial = true;
+    }
+
+    int64_t end = last + 1;
+    base::TimeDelta delay;
+    {
+      base::AutoLock lock(lock_);
+      ++request_count_;
+      if (partial)
+        range_starts_.push_back(first);
+      if (!partial && disconnect_at_ > 0) {
+        end = disconnect_at_;
+        disconnect_at_ = -1;
+      }
+      delay = chunk_delay_;
+    }
+
+    std::string headers = partial ? "HTTP/1.1 206 Partial Content\r\n"
+                                  : "HTTP/1.1 200 OK\r\n";
+    headers += base::StringPrintf("Content-Length: %" PRId64 "\r\n",
+                                  last - first + 1);
+    if (partial) {
+      headers += base::StringPrintf(
+          "Content-Range: bytes %" PRId64 "-%" PRId64 "/%" PRId64 "\r\n",
+          first, last, size);
+    }
+    headers += base::StringPrintf(
+        "Accept-Ranges: bytes\r\n"
+        "ETag: %s\r\n"
+        "Last-Modified: %s\r\n"
+        "Content-Type: application/octet-stream\r\n"
+        "Content-Disposition: attachment; filename=big.bin\r\n"
+        "\r\n",
+        kETag, kLastModified);
+    return std::make_unique<RangeResponse>(content_, headers, first, end,
+                                           delay);
+  }
+
+  // Downloads kBigFilePath and returns the finished item.
+  DownloadItem* DownloadBigFile() {
+    std::unique_ptr<DownloadTestObserver> observer(CreateWaiter(runtime_, 1));
+    xwalk_test_utils::NavigateToURL(
+        runtime_, embedded_test_server()->GetURL(kBigFilePath));
+    observer->WaitForFinished();
+    return GetOnlyDownload();
+  }
+
+  DownloadItem* GetOnlyDownload() {
+    std::vector<DownloadItem*> downloads;
+    DownloadManagerForXWalk(runtime_)->GetAllDownloads(&downloads);
+    EXPECT_EQ(1u, downloads.size());
+    return downloads.empty() ? nullptr : downloads[0];
+  }
+
+  void ExpectContent(const base::FilePath& path) {
+    base::ScopedAllowBlockingForTesting allow_blocking;
+    std::string data;
+    ASSERT_TRUE(base::ReadFileToString(path, &data));
+    ASSERT_EQ(content_->size(), data.size());
+    EXPECT_TRUE(data == content_->data());
+  }
+
   Runtime* runtime_;
+  scoped_refptr<base::RefCountedString> content_;
+
+  // Guards the server state below, which is used on the server thread.
+  base::Lock lock_;
+  int64_t disconnect_at_;
+  base::TimeDelta chunk_delay_;
+  int request_count_;
+  std::vector<int64_t> range_starts_;
 
- private:
   // Location of the downloads directory for these tests
   base::ScopedTempDir downloads_directory_;
+  base::ScopedTempDir data_directory_;
 };
 
 IN_PROC_BROWSER_TEST_F(XWalkDownloadBrowserTest, FileDownload) {
@@ -88,4 +326,159 @@ IN_PROC_BROWSER_TEST_F(XWalkDownloadBrowserTest, FileDownload) {
           base::FilePath().AppendASCII("test.lib"))));
 }
 
+// The connection drops a third of the way in, the download picks up from
+// there instead of starting over.
+IN_PROC_BROWSER_TEST_F(XWalkDownloadBrowserTest, ResumesAfterDisconnect) {
+  const int64_t kDisconnectAt = kBigFileSize / 3;
+  {
+    base::AutoLock lock(lock_);
+    disconnect_at_ = kDisconnectAt;
+  }
+
+  DownloadItem* item = DownloadBigFile();
+  ASSERT_TRUE(item);
+  ASSERT_EQ(DownloadItem::COMPLETE, item->GetState());
+  ExpectContent(item->GetTargetFilePath());
+
+  base::AutoLock lock(lock_);
+  ASSERT_FALSE(range_starts_.empty());
+  EXPECT_TRUE(std::find(range_starts_.begin(), range_starts_.end(),
+                        kDisconnectAt) != range_starts_.end());
+  XWalkBenchmark::ReportValue("download_resume", "_requests", "count",
+                              request_count_);
+}
+
+// Throttles every connection, so splitting the download pays off and the
+// parallel download heuristics kick in: at 64 KB per 20 ms the file takes
+// about five seconds, past the two seconds of remaining time they ask for.
+IN_PROC_BROWSER_TEST_F(XWalkDownloadBrowserTest, ParallelRangeThroughput) {
+  // XWalkMainDelegate turns it on, this is not measuring anything otherwise.
+  ASSERT_TRUE(download::IsParallelDownloadEnabled());
+  {
+    base::AutoLock lock(lock_);
+    chunk_delay_ = base::TimeDelta::FromMilliseconds(20);
+  }
+
+  const base::TimeTicks start = base::TimeTicks::Now();
+  DownloadItem* item = DownloadBigFile();
+  const base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+  ASSERT_TRUE(item);
+  ASSERT_EQ(DownloadItem::COMPLETE, item->GetState());
+  ExpectContent(item->GetTargetFilePath());
+
+  base::AutoLock lock(lock_);
+  // The first request plus at least one range request for the rest.
+  EXPECT_FALSE(range_starts_.empty());
+  EXPECT_GT(request_count_, 1);
+  XWalkBenchmark::ReportValue("download_parallel", "_connections", "count",
+                              request_count_);
+  XWalkBenchmark::ReportValue(
+      "download_parallel", "_throughput", "MB/s",
+      kBigFileSize / (1024.0 * 1024.0) / elapsed.InSecondsF());
+}
+
+// Starts out with a registry listing a half done download, as if the
+// browser had gone down in the middle of it.
+class XWalkDownloadRestartBrowserTest : public XWalkDownloadBrowserTest {
+ protected:
+  XWalkDownloadRestartBrowserTest() : paused_(false) {}
+
+  void SeedDataPath() override {
+    XWalkDownloadRegistry::Record record;
+    record.id = kRestoredId;
+    record.guid = base::GenerateGUID();
+    record.url_chain.push_back(embedded_test_server()->GetURL(kBigFilePath));
+    record.mime_type = "application/octet-stream";
+    record.original_mime_type = record.mime_type;
+    record.target_path =
+        downloads_directory_.GetPath().AppendASCII("restored.bin");
+    record.current_path =
+        record.target_path.AddExtension(FILE_PATH_LITERAL(".crdownload"));
+    record.start_time = base::Time::Now();
+    record.etag = kETag;
+    record.last_modified = kLastModified;
+    record.received_bytes = kBigFileSize / 2;
+    record.total_bytes = kBigFileSize;
+    record.paused = paused_;
+    guid_ = record.guid;
+
+    ASSERT_EQ(record.received_bytes,
+              base::WriteFile(record.current_path, content_->data().data(),
+                              record.received_bytes));
+    const std::string store =
+        XWalkDownloadRegistry::Serialize(kRestoredId + 1, {record});
+    ASSERT_EQ(static_cast<int>(store.size()),
+              base::WriteFile(data_directory_.GetPath().AppendASCII(
+                                  "Download Registry"),
+                              store.data(), store.size()));
+  }
+
+  bool paused_;
+  std::string guid_;
+};
+
+// The same, with a download the user had paused.
+class XWalkDownloadPausedRestartBrowserTest
+    : public XWalkDownloadRestartBrowserTest {
+ protected:
+  XWalkDownloadPausedRestartBrowserTest() { paused_ = true; }
+};
+
+IN_PROC_BROWSER_TEST_F(XWalkDownloadRestartBrowserTest, ResumesAfterRestart) {
+  std::unique_ptr<DownloadTestObserver> observer(CreateWaiter(runtime_, 1));
+  observer->WaitForFinished();
+
+  DownloadItem* item = GetOnlyDownload();
+  ASSERT_TRUE(item);
+  EXPECT_EQ(guid_, item->GetGuid());
+  EXPECT_EQ(kRestoredId, item->GetId());
+  ASSERT_EQ(DownloadItem::COMPLETE, item->GetState());
+  ExpectContent(item->GetTargetFilePath());
+
+  {
+    // Only the missing half was fetched.
+    base::AutoLock lock(lock_);
+    ASSERT_EQ(1u, range_starts_.size());
+    EXPECT_EQ(kBigFileSize / 2, range_starts_[0]);
+    EXPECT_EQ(1, request_count_);
+  }
+
+  // New downloads do not reuse the restored id.
+  uint32_t next_id = DownloadItem::kInvalidId;
+  GetDelegate()->GetNextId(base::BindRepeating(&StoreId, &next_id));
+  EXPECT_GT(next_id, kRestoredId);
+}
+
+IN_PROC_BROWSER_TEST_F(XWalkDownloadPausedRestartBrowserTest,
+                       StaysPausedAfterRestart) {
+  // Ids are handed out once the registry restored its downloads.
+  base::RunLoop run_loop;
+  uint32_t next_id = DownloadItem::kInvalidId;
+  GetDelegate()->GetNextId(base::BindRepeating(&StoreIdAndQuit, &next_id,
+                                               run_loop.QuitClosure()));
+  run_loop.Run();
+  EXPECT_GT(next_id, kRestoredId);
+
+  DownloadItem* item = GetOnlyDownload();
+  ASSERT_TRUE(item);
+  EXPECT_EQ(guid_, item->GetGuid());
+  EXPECT_EQ(DownloadItem::INTERRUPTED, item->GetState());
+  EXPECT_EQ(kBigFileSize / 2, item->GetReceivedBytes());
+  {
+    base::AutoLock lock(lock_);
+    EXPECT_EQ(0, request_count_);
+  }
+
+  // Resuming by hand picks up where it stopped.
+  std::unique_ptr<DownloadTestObserver> observer(CreateWaiter(runtime_, 1));
+  item->Resume(true);
+  observer->WaitForFinished();
+  ASSERT_EQ(DownloadItem::COMPLETE, item->GetState());
+  ExpectContent(item->GetTargetFilePath());
+
+  base::AutoLock lock(lock_);
+  ASSERT_EQ(1u, range_starts_.size());
+  EXPECT_EQ(kBigFileSize / 2, range_starts_[0]);
+}
+
 }  // namespace
@@ -0,0 +1,418 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/xwalk_download_registry.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/logging.h"
+#include "base/optional.h"
+#include "base/pickle.h"
+#include "base/task_runner_util.h"
+#include "components/download/public/common/download_danger_type.h"
+
+namespace xwalk {
+
+namespace {
+
+// Bump when the record layout changes, older files are then ignored.
+const uint32_t kStoreVersion = 2;
+
+int64_t TimeToInt64(base::Time time) {
+  return time.ToDeltaSinceWindowsEpoch().InMicroseconds();
+}
+
+base::Time Int64ToTime(int64_t value) {
+  return base::Time::FromDeltaSinceWindowsEpoch(
+      base::TimeDelta::FromMicroseconds(value));
+}
+
+void WriteRecord(const XWalkDownloadRegistry::Record& record,
+                 base::Pickle* pickle) {
+  pickle->WriteUInt32(record.id);
+  pickle->WriteString(record.guid);
+  pickle->WriteUInt32(record.url_chain.size());
+  for (const GURL& url : record.url_chain)
+    pickle->WriteString(url.spec());
+  pickle->WriteString(record.referrer_url.spec());
+  pickle->WriteString(record.site_url.spec());
+  pickle->WriteString(record.tab_url.spec());
+  pickle->WriteString(record.tab_referrer_url.spec());
+  pickle->WriteString(record.mime_type);
+  pickle->WriteString(record.original_mime_type);
+  record.current_path.WriteToPickle(pickle);
+  record.target_path.WriteToPickle(pickle);
+  pickle->WriteInt64(TimeToInt64(record.start_time));
+  pickle->WriteString(record.etag);
+  pickle->WriteString(record.last_modified);
+  pickle->WriteInt64(record.received_bytes);
+  pickle->WriteInt64(record.total_bytes);
+  pickle->WriteInt(record.interrupt_reason);
+  pickle->WriteUInt32(record.received_slices.size());
+  for (const auto& slice : record.received_slices) {
+    pickle->WriteInt64(slice.offset);
+    pickle->WriteInt64(slice.received_bytes);
+    pickle->WriteBool(slice.finished);
+  }
+  pickle->WriteBool(record.paused);
+}
+
+bool ReadURL(base::PickleIterator* iter, GURL* url) {
+  std::string spec;
+  if (!iter->ReadString(&spec))
+    return false;
+  *url = GURL(spec);
+  return true;
+}
+
+bool ReadRecord(base::PickleIterator* iter,
+                XWalkDownloadRegistry::Record* record) {
+  uint32_t url_count;
+  if (!iter->ReadUInt32(&record->id) || !iter->ReadString(&record->guid) ||
+      !iter->ReadUInt32(&url_count)) {
+    return false;
+  }
+  for (uint32_t i = 0; i < url_count; ++i) {
+    GURL url;
+    if (!ReadURL(iter, &url))
+      return false;
+    record->url_chain.push_back(url);
+  }
+
+  int64_t start_time;
+  int interrupt_reason;
+  uint32_t slice_count;
+  if (!ReadURL(iter, &record->referrer_url) ||
+      !ReadURL(iter, &record->site_url) || !ReadURL(iter, &record->tab_url) ||
+      !ReadURL(iter, &record->tab_referrer_url) ||
+      !iter->ReadString(&record->mime_type) ||
+      !iter->ReadString(&record->original_mime_type) ||
+      !record->current_path.ReadFromPickle(iter) ||
+      !record->target_path.ReadFromPickle(iter) ||
+      !iter->ReadInt64(&start_time) || !iter->ReadString(&record->etag) ||
+      !iter->ReadString(&record->last_modified) ||
+      !iter->ReadInt64(&record->received_bytes) ||
+      !iter->ReadInt64(&record->total_bytes) ||
+      !iter->ReadInt(&interrupt_reason) || !iter->ReadUInt32(&slice_count)) {
+    return false;
+  }
+  record->start_time = Int64ToTime(start_time);
+  record->interrupt_reason =
+      static_cast<download::DownloadInterruptReason>(interrupt_reason);
+
+  for (uint32_t i = 0; i < slice_count; ++i) {
+    int64_t offset;
+    int64_t received_bytes;
+    bool finished;
+    if (!iter->ReadInt64(&offset) || !iter->ReadInt64(&received_bytes) ||
+        !iter->ReadBool(&finished)) {
+      return false;
+    }
+    record->received_slices.emplace_back(offset, received_bytes, finished);
+  }
+  return iter->ReadBool(&record->paused) && !record->url_chain.empty() &&
+         !record->guid.empty();
+}
+
+}  // namespace
+
+struct XWalkDownloadRegistry::LoadResult {
+  LoadResult() : next_id(download::DownloadItem::kInvalidId + 1) {}
+
+  uint32_t next_id;
+  std::vector<Record> records;
+};
+
+namespace {
+
+// Runs on the task runner.
+std::unique_ptr<XWalkDownloadRegistry::LoadResult> LoadRecords(
+    const base::FilePath& path) {
+  std::unique_ptr<XWalkDownloadRegistry::LoadResult> result(
+      new XWalkDownloadRegistry::LoadResult);
+  std::string data;
+  if (!base::ReadFileToString(path, &data))
+    return result;
+
+  base::Pickle pickle(data.data(), data.size());
+  base::PickleIterator iter(pickle);
+  uint32_t version;
+  uint32_t next_id;
+  uint32_t count;
+  if (!iter.ReadUInt32(&version) || version != kStoreVersion ||
+      !iter.ReadUInt32(&next_id) || !iter.ReadUInt32(&count)) {
+    return result;
+  }
+  result->next_id = std::max(result->next_id, next_id);
+
+  for (uint32_t i = 0; i < count; ++i) {
+    XWalkDownloadRegistry::Record record;
+    if (!ReadRecord(&iter, &record)) {
+      LOG(WARNING) << "Truncated download registry " << path.value();
+      break;
+    }
+    result->next_id = std::max(result->next_id, record.id + 1);
+    result->records.push_back(std::move(record));
+  }
+  return result;
+}
+
+}  // namespace
+
+XWalkDownloadRegistry::Record::Record()
+    : id(download::DownloadItem::kInvalidId),
+      received_bytes(0),
+      total_bytes(0),
+      interrupt_reason(download::DOWNLOAD_INTERRUPT_REASON_NONE),
+      paused(false) {}
+
+XWalkDownloadRegistry::Record::Record(const Record& other) = default;
+
+XWalkDownloadRegistry::Record::~Record() {}
+
+// static
+std::string XWalkDownloadRegistry::Serialize(
+    uint32_t next_id,
+    const std::vector<Record>& records) {
+  base::Pickle pickle;
+  pickle.WriteUInt32(kStoreVersion);
+  pickle.WriteUInt32(next_id);
+  pickle.WriteUInt32(records.size());
+  for (const Record& record : records)
+    WriteRecord(record, &pickle);
+  return std::string(static_cast<const char*>(pickle.data()), pickle.size());
+}
+
+XWalkDownloadRegistry::XWalkDownloadRegistry(
+    content::DownloadManager* manager,
+    const base::FilePath& path,
+    scoped_refptr<base::SequencedTaskRunner> task_runner)
+    : manager_(manager),
+      loaded_(false),
+      next_id_(download::DownloadItem::kInvalidId + 1),
+      task_runner_(task_runner),
+      writer_(path, task_runner),
+      weak_factory_(this) {
+  manager_->AddObserver(this);
+  std::vector<download::DownloadItem*> items;
+  manager_->GetAllDownloads(&items);
+  for (download::DownloadItem* item : items)
+    Observe(item);
+
+  base::PostTaskAndReplyWithResult(
+      task_runner.get(), FROM_HERE, base::BindOnce(&LoadRecords, path),
+      base::BindOnce(&XWalkDownloadRegistry::OnLoaded,
+                     weak_factory_.GetWeakPtr()));
+}
+
+XWalkDownloadRegistry::~XWalkDownloadRegistry() {
+  StopObserving();
+  if (writer_.HasPendingWrite())
+    writer_.DoScheduledWrite();
+}
+
+void XWalkDownloadRegistry::GetNextId(
+    const content::DownloadIdCallback& callback) {
+  if (!loaded_) {
+    pending_id_callbacks_.push_back(callback);
+    return;
+  }
+  callback.Run(next_id_++);
+}
+
+void XWalkDownloadRegistry::RemoveRecords(
+    base::Time begin,
+    base::Time end,
+    const base::RepeatingCallback<bool(const GURL&)>& filter) {
+  if (!loaded_)
+    pending_removals_.push_back({begin, end, filter});
+}
+
+bool XWalkDownloadRegistry::IsRemoved(const Record& record) const {
+  const GURL url =
+      record.url_chain.empty() ? GURL() : record.url_chain.back();
+  for (const Removal& removal : pending_removals_) {
+    if (record.start_time >= removal.begin &&
+        (removal.end.is_null() || record.start_time < removal.end) &&
+        (removal.filter.is_null() || removal.filter.Run(url))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void XWalkDownloadRegistry::CommitPendingWriteForTesting() {
+  if (writer_.HasPendingWrite())
+    writer_.DoScheduledWrite();
+}
+
+bool XWalkDownloadRegistry::SerializeData(std::string* data) {
+  std::vector<Record> records;
+  records.reserve(records_.size());
+  for (const auto& record : records_)
+    records.push_back(record.second);
+  *data = Serialize(next_id_, records);
+  return true;
+}
+
+void XWalkDownloadRegistry::OnLoaded(std::unique_ptr<LoadResult> result) {
+  loaded_ = true;
+  next_id_ = std::max(next_id_, result->next_id);
+
+  bool removed = false;
+  for (const Record& record : result->records) {
+    if (!IsRemoved(record))
+      continue;
+    removed = true;
+    if (record.current_path.empty())
+      continue;
+    task_runner_->PostTask(
+        FROM_HERE, base::BindOnce(base::IgnoreResult(&base::DeleteFile),
+                                  record.current_path, false));
+  }
+  // Rewrite the store without them.
+  if (removed)
+    writer_.ScheduleWrite(this);
+
+  if (manager_) {
+    for (const Record& record : result->records) {
+      if (!IsRemoved(record) && !manager_->GetDownloadByGuid(record.guid))
+        Restore(record);
+    }
+    manager_->PostInitialization(
+        content::DownloadManager::DOWNLOAD_INITIALIZATION_DEPENDENCY_HISTORY_DB);
+  }
+  pending_removals_.clear();
+
+  std::vector<content::DownloadIdCallback> callbacks;
+  callbacks.swap(pending_id_callbacks_);
+  for (const auto& callback : callbacks)
+    callback.Run(next_id_++);
+}
+
+void XWalkDownloadRegistry::Restore(const Record& record) {
+  // Downloads that were still going when the browser went down have no
+  // interrupt reason of their own.
+  const download::DownloadInterruptReason reason =
+      record.interrupt_reason == download::DOWNLOAD_INTERRUPT_REASON_NONE
+          ? download::DOWNLOAD_INTERRUPT_REASON_CRASH
+          : record.interrupt_reason;
+  // The item comes back interrupted, not paused; the record keeps the flag
+  // through the update its creation causes, until the user resumes it.
+  if (record.paused)
+    records_[record.guid] = record;
+  download::DownloadItem* item = manager_->CreateDownloadItem(
+      record.guid, record.id, record.current_path, record.target_path,
+      record.url_chain, record.referrer_url, record.site_url, record.tab_url,
+      record.tab_referrer_url, base::nullopt, record.mime_type,
+      record.original_mime_type, record.start_time, base::Time(), record.etag,
+      record.last_modified, record.received_bytes, record.total_bytes,
+      std::string(), download::DownloadItem::INTERRUPTED,
+      download::DOWNLOAD_DANGER_TYPE_NOT_DANGEROUS, reason, false,
+      base::Time(), false, record.received_slices);
+  if (item && !record.paused && item->CanResume())
+    item->Resume(false);
+}
+
+void XWalkDownloadRegistry::Observe(download::DownloadItem* item) {
+  if (item->IsTransient() || !observed_items_.insert(item).second)
+    return;
+  item->AddObserver(this);
+  OnDownloadUpdated(item);
+}
+
+void XWalkDownloadRegistry::Update(download::DownloadItem* item) {
+  Record& record = records_[item->GetGuid()];
+  const bool interrupted =
+      item->GetState() == download::DownloadItem::INTERRUPTED &&
+      record.interrupt_reason != item->GetLastReason();
+  // A restored paused download is interrupted until resumed, only a
+  // running one says whether it is paused.
+  const bool was_paused = record.paused;
+  if (item->GetState() == download::DownloadItem::IN_PROGRESS)
+    record.paused = item->IsPaused();
+
+  record.id = item->GetId();
+  record.guid = item->GetGuid();
+  record.url_chain = item->GetUrlChain();
+  record.referrer_url = item->GetReferrerUrl();
+  record.site_url = item->GetSiteUrl();
+  record.tab_url = item->GetTabUrl();
+  record.tab_referrer_url = item->GetTabReferrerUrl();
+  record.mime_type = item->GetMimeType();
+  record.original_mime_type = item->GetOriginalMimeType();
+  record.current_path = item->GetFullPath();
+  record.target_path = item->GetTargetFilePath();
+  record.start_time = item->GetStartTime();
+  record.etag = item->GetETag();
+  record.last_modified = item->GetLastModifiedTime();
+  record.received_bytes = item->GetReceivedBytes();
+  record.total_bytes = item->GetTotalBytes();
+  record.interrupt_reason = item->GetLastReason();
+  record.received_slices = item->GetReceivedSlices();
+
+  writer_.ScheduleWrite(this);
+  // The browser may not get to the next commit, keep what resuming needs.
+  if (interrupted || record.paused != was_paused)
+    writer_.DoScheduledWrite();
+}
+
+void XWalkDownloadRegistry::Forget(download::DownloadItem* item) {
+  if (records_.erase(item->GetGuid()))
+    writer_.ScheduleWrite(this);
+}
+
+void XWalkDownloadRegistry::StopObserving() {
+  for (download::DownloadItem* item : observed_items_)
+    item->RemoveObserver(this);
+  observed_items_.clear();
+  if (manager_)
+    manager_->RemoveObserver(this);
+  manager_ = nullptr;
+}
+
+void XWalkDownloadRegistry::OnDownloadCreated(content::DownloadManager* manager,
+                                              download::DownloadItem* item) {
+  Observe(item);
+}
+
+void XWalkDownloadRegistry::ManagerGoingDown(
+    content::DownloadManager* manager) {
+  // The manager cancels what is still in progress on its way down; those
+  // downloads must stay in the store as they were, to be resumed next time.
+  StopObserving();
+  if (writer_.HasPendingWrite())
+    writer_.DoScheduledWrite();
+}
+
+void XWalkDownloadRegistry::OnDownloadUpdated(download::DownloadItem* item) {
+  switch (item->GetState()) {
+    case download::DownloadItem::IN_PROGRESS:
+    case download::DownloadItem::INTERRUPTED:
+      // Nothing to resume before the target is known.
+      if (!item->GetTargetFilePath().empty())
+        Update(item);
+      break;
+    case download::DownloadItem::COMPLETE:
+    case download::DownloadItem::CANCELLED:
+      Forget(item);
+      break;
+    default:
+      break;
+  }
+}
+
+void XWalkDownloadRegistry::OnDownloadRemoved(download::DownloadItem* item) {
+  Forget(item);
+}
+
+void XWalkDownloadRegistry::OnDownloadDestroyed(download::DownloadItem* item) {
+  item->RemoveObserver(this);
+  observed_items_.erase(item);
+}
+
+}  // namespace xwalk
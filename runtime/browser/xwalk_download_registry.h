@@ -0,0 +1,147 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_BROWSER_XWALK_DOWNLOAD_REGISTRY_H_
+#define XWALK_RUNTIME_BROWSER_XWALK_DOWNLOAD_REGISTRY_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/callback.h"
+#include "base/files/important_file_writer.h"
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "base/sequenced_task_runner.h"
+#include "base/time/time.h"
+#include "components/download/public/common/download_interrupt_reasons.h"
+#include "components/download/public/common/download_item.h"
+#include "content/public/browser/download_manager.h"
+#include "content/public/browser/download_manager_delegate.h"
+#include "url/gurl.h"
+
+namespace xwalk {
+
+// Keeps what is needed to resume the unfinished downloads of a
+// DownloadManager across restarts: ids, paths, the validators the server
+// sent (ETag and Last-Modified) and the byte ranges received so far.
+//
+// The records are written to |path| as a base::Pickle, at most once per
+// commit interval and right away when a download is interrupted. Once the
+// file has been read back the downloads it lists are recreated as
+// interrupted and resumed; the download system then asks the server for
+// the missing ranges only. Downloads the user paused stay interrupted until
+// resumed by hand. Finished and canceled downloads are dropped.
+//
+// Ids are handed out only after loading, so they never clash with the ids
+// of restored downloads.
+class XWalkDownloadRegistry
+    : public content::DownloadManager::Observer,
+      public download::DownloadItem::Observer,
+      public base::ImportantFileWriter::DataSerializer {
+ public:
+  struct Record {
+    Record();
+    Record(const Record& other);
+    ~Record();
+
+    uint32_t id;
+    std::string guid;
+    std::vector<GURL> url_chain;
+    GURL referrer_url;
+    GURL site_url;
+    GURL tab_url;
+    GURL tab_referrer_url;
+    std::string mime_type;
+    std::string original_mime_type;
+    base::FilePath current_path;
+    base::FilePath target_path;
+    base::Time start_time;
+    std::string etag;
+    std::string last_modified;
+    int64_t received_bytes;
+    int64_t total_bytes;
+    download::DownloadInterruptReason interrupt_reason;
+    std::vector<download::DownloadItem::ReceivedSlice> received_slices;
+    // Paused by the user, not resumed on restore.
+    bool paused;
+  };
+
+  // The store file format, exposed so tests can prepare one.
+  static std::string Serialize(uint32_t next_id,
+                               const std::vector<Record>& records);
+
+  XWalkDownloadRegistry(content::DownloadManager* manager,
+                        const base::FilePath& path,
+                        scoped_refptr<base::SequencedTaskRunner> task_runner);
+  ~XWalkDownloadRegistry() override;
+
+  // Runs |callback| with an unused id, once the store has been read.
+  void GetNextId(const content::DownloadIdCallback& callback);
+
+  // Drops the stored downloads started in [|begin|, |end|) whose URL
+  // |filter| matches, all of them if it is null, along with their partial
+  // files. Only matters before the store has been read: afterwards every
+  // stored download is a DownloadItem, and removing that one through the
+  // DownloadManager drops its record.
+  void RemoveRecords(base::Time begin,
+                     base::Time end,
+                     const base::RepeatingCallback<bool(const GURL&)>& filter);
+
+  // Writes pending changes right away.
+  void CommitPendingWriteForTesting();
+
+  // base::ImportantFileWriter::DataSerializer implementation.
+  bool SerializeData(std::string* data) override;
+
+ private:
+  struct LoadResult;
+  struct Removal {
+    base::Time begin;
+    base::Time end;
+    base::RepeatingCallback<bool(const GURL&)> filter;
+  };
+
+  void OnLoaded(std::unique_ptr<LoadResult> result);
+  bool IsRemoved(const Record& record) const;
+  void Restore(const Record& record);
+  void Observe(download::DownloadItem* item);
+  void Update(download::DownloadItem* item);
+  void Forget(download::DownloadItem* item);
+  void StopObserving();
+
+  // content::DownloadManager::Observer implementation.
+  void OnDownloadCreated(content::DownloadManager* manager,
+                         download::DownloadItem* item) override;
+  void ManagerGoingDown(content::DownloadManager* manager) override;
+
+  // download::DownloadItem::Observer implementation.
+  void OnDownloadUpdated(download::DownloadItem* item) override;
+  void OnDownloadRemoved(download::DownloadItem* item) override;
+  void OnDownloadDestroyed(download::DownloadItem* item) override;
+
+  content::DownloadManager* manager_;
+  bool loaded_;
+  uint32_t next_id_;
+  std::vector<content::DownloadIdCallback> pending_id_callbacks_;
+  // Unfinished downloads, by GUID.
+  std::map<std::string, Record> records_;
+  std::set<download::DownloadItem*> observed_items_;
+  // RemoveRecords() calls made before the store was read.
+  std::vector<Removal> pending_removals_;
+  scoped_refptr<base::SequencedTaskRunner> task_runner_;
+  base::ImportantFileWriter writer_;
+  base::WeakPtrFactory<XWalkDownloadRegistry> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkDownloadRegistry);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_BROWSER_XWALK_DOWNLOAD_REGISTRY_H_
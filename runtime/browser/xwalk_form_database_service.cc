@@ -5,13 +5,21 @@
 
 #include "xwalk/runtime/browser/xwalk_form_database_service.h"
 
+#include <set>
+#include <utility>
+
+#include "base/bind.h"
 #include "base/logging.h"
+#include "base/strings/string_util.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/task/post_task.h"
 #include "components/autofill/core/browser/webdata/autofill_table.h"
+#include "components/autofill/core/common/form_field_data.h"
+#include "components/webdata/common/web_database.h"
 #include "components/webdata/common/webdata_constants.h"
 #include "content/public/browser/browser_task_traits.h"
 #include "content/public/browser/browser_thread.h"
+#include "sql/statement.h"
 
 using base::WaitableEvent;
 using content::BrowserThread;
@@ -24,11 +32,41 @@ void DatabaseErrorCallback(sql::InitStatus status, const std::string&) {
   LOG(WARNING) << "initializing autocomplete database failed";
 }
 
+using FieldValues = std::vector<xwalk::XWalkFormSuggestionIndex::Entry>;
+
+// Runs on the database thread. Reads every value of the field |name| with
+// its submission count, which autofill::AutofillTable does not return.
+std::unique_ptr<WDTypedResult> ReadFieldValues(const base::string16& name,
+                                               WebDatabase* db) {
+  FieldValues values;
+  sql::Statement statement(db->GetSQLConnection()->GetUniqueStatement(
+      "SELECT value, count FROM autofill WHERE name = ?"));
+  statement.BindString16(0, name);
+  while (statement.Step())
+    values.push_back({statement.ColumnString16(0), statement.ColumnInt(1)});
+  return std::make_unique<WDResult<FieldValues>>(AUTOFILL_VALUE_RESULT,
+                                                 std::move(values));
+}
+
 }  // namespace
 
 namespace xwalk {
 
-XWalkFormDatabaseService::XWalkFormDatabaseService(const base::FilePath path) {
+XWalkFormDatabaseService::PendingSuggestions::PendingSuggestions() : limit(0) {}
+
+XWalkFormDatabaseService::PendingSuggestions::PendingSuggestions(
+    PendingSuggestions&& other) = default;
+
+XWalkFormDatabaseService::PendingSuggestions::~PendingSuggestions() {}
+
+XWalkFormDatabaseService::FieldLoad::FieldLoad() {}
+
+XWalkFormDatabaseService::FieldLoad::FieldLoad(FieldLoad&& other) = default;
+
+XWalkFormDatabaseService::FieldLoad::~FieldLoad() {}
+
+XWalkFormDatabaseService::XWalkFormDatabaseService(const base::FilePath path)
+    : index_generation_(0) {
   CHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
   auto ui_task_runner = base::ThreadTaskRunnerHandle::Get();
   _db_task_runner = base::CreateSingleThreadTaskRunnerWithTraits( { base::MayBlock(), base::TaskPriority::USER_VISIBLE,
@@ -66,18 +104,122 @@ XWalkFormDatabaseService::get_autofill_webdata_service() {
   return autofill_data_;
 }
 
-void XWalkFormDatabaseService::ClearFormData() {
-  _db_task_runner->PostTask(
-      FROM_HERE,
-      base::BindOnce(&XWalkFormDatabaseService::ClearFormDataImpl,
-                 base::Unretained(this)));
-}
-
-void XWalkFormDatabaseService::ClearFormDataImpl() {
-  base::Time begin;
-  base::Time end = base::Time::Max();
+void XWalkFormDatabaseService::ClearFormData(base::Time begin,
+                                             base::Time end,
+                                             base::OnceClosure done) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  ResetSuggestionIndex();
   autofill_data_->RemoveFormElementsAddedBetween(begin, end);
   autofill_data_->RemoveAutofillDataModifiedBetween(begin, end);
+  // The removals were queued on the database thread, the reply comes back
+  // after they ran.
+  _db_task_runner->PostTaskAndReply(FROM_HERE, base::DoNothing(),
+                                    std::move(done));
+}
+
+void XWalkFormDatabaseService::GetFormValuesForElementName(
+    const base::string16& name,
+    const base::string16& prefix,
+    size_t limit,
+    SuggestionsCallback callback) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  if (suggestion_index_.HasField(name)) {
+    std::move(callback).Run(
+        suggestion_index_.GetSuggestions(name, prefix, limit));
+    return;
+  }
+
+  PendingSuggestions query;
+  query.prefix = prefix;
+  query.limit = limit;
+  query.callback = std::move(callback);
+  bool loading = field_loads_.count(name) > 0;
+  field_loads_[name].queries.push_back(std::move(query));
+  if (!loading)
+    LoadField(name);
+}
+
+void XWalkFormDatabaseService::AddFormFields(
+    const std::vector<autofill::FormFieldData>& fields) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  // Counted the way autofill::AutofillTable does: trimmed, and once per
+  // name and submission.
+  std::set<base::string16> seen_names;
+  for (const autofill::FormFieldData& field : fields) {
+    base::string16 value;
+    base::TrimWhitespace(field.value, base::TRIM_ALL, &value);
+    if (field.name.empty() || value.empty() ||
+        !seen_names.insert(field.name).second) {
+      continue;
+    }
+    auto load = field_loads_.find(field.name);
+    if (load != field_loads_.end())
+      load->second.edits.emplace_back(value, true);
+    else
+      suggestion_index_.AddValue(field.name, value);
+  }
+  autofill_data_->AddFormFields(fields);
+}
+
+void XWalkFormDatabaseService::RemoveFormValueForElementName(
+    const base::string16& name,
+    const base::string16& value) {
+  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
+  auto load = field_loads_.find(name);
+  if (load != field_loads_.end())
+    load->second.edits.emplace_back(value, false);
+  else
+    suggestion_index_.RemoveValue(name, value);
+  autofill_data_->RemoveFormValueForElementName(name, value);
+}
+
+void XWalkFormDatabaseService::LoadField(const base::string16& name) {
+  WebDataServiceBase::Handle handle = web_database_->ScheduleDBTaskWithResult(
+      FROM_HERE, base::BindOnce(&ReadFieldValues, name), this);
+  load_handles_[handle] = std::make_pair(name, index_generation_);
+}
+
+void XWalkFormDatabaseService::OnFieldLoaded(
+    const base::string16& name,
+    int generation,
+    std::unique_ptr<WDTypedResult> result) {
+  if (generation != index_generation_) {
+    // Read before the database was cleared.
+    LoadField(name);
+    return;
+  }
+
+  auto load = field_loads_.find(name);
+  DCHECK(load != field_loads_.end());
+  FieldLoad field_load = std::move(load->second);
+  field_loads_.erase(load);
+
+  // A database that failed to open reads as an empty field.
+  FieldValues values;
+  if (result) {
+    DCHECK_EQ(AUTOFILL_VALUE_RESULT, result->GetType());
+    values = static_cast<const WDResult<FieldValues>*>(result.get())->GetValue();
+  }
+  suggestion_index_.LoadField(name, values);
+  for (const auto& edit : field_load.edits) {
+    if (edit.second)
+      suggestion_index_.AddValue(name, edit.first);
+    else
+      suggestion_index_.RemoveValue(name, edit.first);
+  }
+
+  for (PendingSuggestions& query : field_load.queries) {
+    std::move(query.callback)
+        .Run(suggestion_index_.GetSuggestions(name, query.prefix,
+                                              query.limit));
+  }
+}
+
+void XWalkFormDatabaseService::ResetSuggestionIndex() {
+  ++index_generation_;
+  suggestion_index_.Clear();
+  for (auto& load : field_loads_)
+    load.second.edits.clear();
 }
 
 bool XWalkFormDatabaseService::HasFormData() {
@@ -111,6 +253,18 @@ void XWalkFormDatabaseService::OnWebDataServiceRequestDone(
     WebDataServiceBase::Handle h,
     std::unique_ptr<WDTypedResult> result) {
 
+  // Field loads are made, and answered, on the UI thread. HasFormData()
+  // queries on the database thread.
+  if (!_db_task_runner->BelongsToCurrentThread()) {
+    auto it = load_handles_.find(h);
+    if (it != load_handles_.end()) {
+      std::pair<base::string16, int> load = std::move(it->second);
+      load_handles_.erase(it);
+      OnFieldLoaded(load.first, load.second, std::move(result));
+      return;
+    }
+  }
+
 //  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::DB));
   bool has_form_data = false;
   if (result) {
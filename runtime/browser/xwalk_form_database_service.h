@@ -7,11 +7,21 @@
 #define XWALK_RUNTIME_BROWSER_XWALK_FORM_DATABASE_SERVICE_H_
 
 #include <map>
+#include <utility>
+#include <vector>
 
+#include "base/callback_forward.h"
 #include "base/files/file_path.h"
+#include "base/strings/string16.h"
+#include "base/time/time.h"
 #include "components/autofill/core/browser/webdata/autofill_webdata_service.h"
 #include "components/webdata/common/web_data_service_consumer.h"
 #include "components/webdata/common/web_database_service.h"
+#include "xwalk/runtime/browser/xwalk_form_suggestion_index.h"
+
+namespace autofill {
+struct FormFieldData;
+}
 
 namespace base {
 class WaitableEvent;
@@ -23,8 +33,15 @@ namespace xwalk {
 // functionality. This includes creating and initializing the components that
 // handle the database backend, and providing a synchronous interface when
 // needed (the chromium database components have an async. interface).
+//
+// Suggestions are answered from an XWalkFormSuggestionIndex. The values of a
+// field name are read from the database the first time it is queried, after
+// that submissions update the index right away and are written back to the
+// database in the background.
 class XWalkFormDatabaseService : public WebDataServiceConsumer {
  public:
+  using SuggestionsCallback =
+      base::OnceCallback<void(const std::vector<base::string16>& values)>;
   explicit XWalkFormDatabaseService(const base::FilePath path);
 
   ~XWalkFormDatabaseService() override;
@@ -35,12 +52,28 @@ class XWalkFormDatabaseService : public WebDataServiceConsumer {
   // IO access and block.
   bool HasFormData();
 
-  // Clear any saved form data. Executes asynchronously.
-  void ClearFormData();
+  // Clears the form data added or modified between |begin| and |end|, runs
+  // |done| once the database has done so. Must be called on the UI thread.
+  void ClearFormData(base::Time begin, base::Time end, base::OnceClosure done);
 
   scoped_refptr<autofill::AutofillWebDataService>
       get_autofill_webdata_service();
 
+  // Runs |callback| with at most |limit| values of the field |name| that
+  // start with |prefix|, most submitted first. It runs before this returns
+  // unless the values of |name| have to be loaded first. Must be called on
+  // the UI thread, like the two below.
+  void GetFormValuesForElementName(const base::string16& name,
+                                   const base::string16& prefix,
+                                   size_t limit,
+                                   SuggestionsCallback callback);
+
+  // Counts a submission of |fields|, which are meant to be saved.
+  void AddFormFields(const std::vector<autofill::FormFieldData>& fields);
+
+  void RemoveFormValueForElementName(const base::string16& name,
+                                     const base::string16& value);
+
   // WebDataServiceConsumer implementation.
   void OnWebDataServiceRequestDone(
       WebDataServiceBase::Handle h, std::unique_ptr<WDTypedResult> result) override;
@@ -52,11 +85,47 @@ class XWalkFormDatabaseService : public WebDataServiceConsumer {
   };
   typedef std::map<WebDataServiceBase::Handle, PendingQuery> QueryMap;
 
-  void ClearFormDataImpl();
+  struct PendingSuggestions {
+    PendingSuggestions();
+    PendingSuggestions(PendingSuggestions&& other);
+    ~PendingSuggestions();
+
+    base::string16 prefix;
+    size_t limit;
+    SuggestionsCallback callback;
+  };
+
+  // A field whose values are being read from the database.
+  struct FieldLoad {
+    FieldLoad();
+    FieldLoad(FieldLoad&& other);
+    ~FieldLoad();
+
+    std::vector<PendingSuggestions> queries;
+    // Values added (true) or removed (false) in the meantime. Their writes
+    // were queued after the read, it did not see them.
+    std::vector<std::pair<base::string16, bool>> edits;
+  };
+
   void HasFormDataImpl(base::WaitableEvent* completion, bool* result);
 
+  void LoadField(const base::string16& name);
+  void OnFieldLoaded(const base::string16& name,
+                     int generation,
+                     std::unique_ptr<WDTypedResult> result);
+  // Forgets the index, the database is about to change under it.
+  void ResetSuggestionIndex();
+
   QueryMap result_map_;
 
+  // UI thread only.
+  XWalkFormSuggestionIndex suggestion_index_;
+  std::map<base::string16, FieldLoad> field_loads_;
+  std::map<WebDataServiceBase::Handle, std::pair<base::string16, int>>
+      load_handles_;
+  // Bumped whenever the index is reset, loads read before are dropped.
+  int index_generation_;
+
   scoped_refptr<autofill::AutofillWebDataService> autofill_data_;
   scoped_refptr<WebDatabaseService> web_database_;
   scoped_refptr<base::SingleThreadTaskRunner> _db_task_runner;
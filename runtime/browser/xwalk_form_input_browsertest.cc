@@ -2,17 +2,29 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/run_loop.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "components/autofill/content/browser/content_autofill_driver_factory.h"
 #include "xwalk/runtime/browser/runtime.h"
 #include "xwalk/runtime/browser/ui/color_chooser.h"
+#include "xwalk/runtime/browser/xwalk_browser_context.h"
+#include "xwalk/runtime/browser/xwalk_form_database_service.h"
 #include "xwalk/test/base/in_process_browser_test.h"
 #include "xwalk/test/base/xwalk_test_utils.h"
 #include "content/public/browser/render_view_host.h"
 #include "content/public/browser/web_contents.h"
 #include "content/public/test/browser_test_utils.h"
+#include "content/public/test/test_navigation_observer.h"
 #include "content/public/test/test_utils.h"
 #include "third_party/skia/include/core/SkColor.h"
+#include "ui/events/keycodes/dom/dom_code.h"
+#include "ui/events/keycodes/dom/dom_key.h"
+#include "ui/events/keycodes/keyboard_codes.h"
 #include "ui/shell_dialogs/select_file_dialog.h"
 #include "ui/shell_dialogs/select_file_dialog_factory.h"
 
@@ -87,6 +99,38 @@ class XWalkFormInputTest : public InProcessBrowserTest {
     xwalk::ColorChooser::SetColorForBrowserTest(SkColorSetRGB(r, g, b));
   }
 
+  // Types the lowercase letters of |text| into the focused field.
+  void TypeText(content::WebContents* web_contents, const std::string& text) {
+    for (char c : text) {
+      content::SimulateKeyPress(
+          web_contents, ui::DomKey::FromCharacter(c),
+          static_cast<ui::DomCode>(static_cast<int>(ui::DomCode::US_A) +
+                                   c - 'a'),
+          static_cast<ui::KeyboardCode>(ui::VKEY_A + c - 'a'), false, false,
+          false, false);
+    }
+  }
+
+  std::vector<base::string16> GetFormValues(const std::string& name,
+                                            const std::string& prefix) {
+    std::vector<base::string16> result;
+    base::RunLoop run_loop;
+    xwalk::XWalkBrowserContext::GetDefault()
+        ->GetFormDatabaseService()
+        ->GetFormValuesForElementName(
+            base::ASCIIToUTF16(name), base::ASCIIToUTF16(prefix), 6,
+            base::BindOnce(
+                [](std::vector<base::string16>* result,
+                   base::OnceClosure quit,
+                   const std::vector<base::string16>& values) {
+                  *result = values;
+                  std::move(quit).Run();
+                },
+                &result, run_loop.QuitClosure()));
+    run_loop.Run();
+    return result;
+  }
+
  private:
   TestSelectFileDialogFactory factory_;
 };
@@ -133,3 +177,40 @@ IN_PROC_BROWSER_TEST_F(XWalkFormInputTest, ColorChooser) {
                                       expected_title);
   EXPECT_EQ(title_watcher.WaitAndGetTitle(), expected_title);
 }
+
+// Typing into a field and submitting the form goes through the renderer's
+// autofill agent and the autofill driver, the typed value must come back as
+// a suggestion for that field.
+IN_PROC_BROWSER_TEST_F(XWalkFormInputTest, TypedValueIsSuggested) {
+  GURL url = xwalk_test_utils::GetTestURL(
+      base::FilePath(), base::FilePath().AppendASCII("form_input.html"));
+  Runtime* runtime = CreateRuntime(url);
+  content::WebContents* web_contents = runtime->web_contents();
+  content::WaitForLoadStop(web_contents);
+  ASSERT_TRUE(
+      autofill::ContentAutofillDriverFactory::FromWebContents(web_contents));
+
+  ASSERT_TRUE(content::ExecuteScript(
+      web_contents, "document.getElementById('city').focus();"));
+  TypeText(web_contents, "xwalkville");
+  std::string typed;
+  ASSERT_TRUE(content::ExecuteScriptAndExtractString(
+      web_contents,
+      "window.domAutomationController.send("
+      "    document.getElementById('city').value);",
+      &typed));
+  EXPECT_EQ("xwalkville", typed);
+
+  // Enter submits the form, the submission reaches the browser before the
+  // navigation it starts commits.
+  content::TestNavigationObserver observer(web_contents, 1);
+  content::SimulateKeyPress(web_contents, ui::DomKey::ENTER,
+                            ui::DomCode::ENTER, ui::VKEY_RETURN, false, false,
+                            false, false);
+  observer.Wait();
+
+  std::vector<base::string16> values = GetFormValues("city", "xw");
+  ASSERT_EQ(1u, values.size());
+  EXPECT_EQ(base::ASCIIToUTF16("xwalkville"), values[0]);
+  EXPECT_TRUE(GetFormValues("city", "z").empty());
+}
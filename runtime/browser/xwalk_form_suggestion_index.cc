@@ -0,0 +1,253 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/xwalk_form_suggestion_index.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/i18n/case_conversion.h"
+#include "base/logging.h"
+
+namespace xwalk {
+
+namespace {
+
+using Entry = XWalkFormSuggestionIndex::Entry;
+
+bool RanksBefore(const Entry* a, const Entry* b) {
+  if (a->count != b->count)
+    return a->count > b->count;
+  return a->value < b->value;
+}
+
+// Length of the common prefix of |label| and |key| from |pos|.
+size_t CommonLength(const base::string16& label,
+                    const base::string16& key,
+                    size_t pos) {
+  size_t length = 0;
+  while (length < label.size() && pos + length < key.size() &&
+         label[length] == key[pos + length]) {
+    ++length;
+  }
+  return length;
+}
+
+}  // namespace
+
+const size_t XWalkFormSuggestionIndex::kMaxSuggestions;
+
+class XWalkFormSuggestionIndex::Trie {
+ public:
+  Trie() {}
+
+  void Add(const base::string16& value, int count) {
+    const base::string16 key = base::i18n::ToLower(value);
+    std::vector<Node*> path(1, &root_);
+    Node* node = &root_;
+    size_t pos = 0;
+    while (pos < key.size()) {
+      auto it = node->children.find(key[pos]);
+      if (it == node->children.end()) {
+        auto leaf = std::make_unique<Node>();
+        leaf->label = key.substr(pos);
+        node = (node->children[key[pos]] = std::move(leaf)).get();
+        path.push_back(node);
+        break;
+      }
+      size_t common = CommonLength(it->second->label, key, pos);
+      if (common < it->second->label.size()) {
+        // Split the edge, the new node has the same values below it.
+        auto middle = std::make_unique<Node>();
+        middle->label = it->second->label.substr(0, common);
+        middle->top = it->second->top;
+        std::unique_ptr<Node> rest = std::move(it->second);
+        rest->label.erase(0, common);
+        middle->children[rest->label[0]] = std::move(rest);
+        it->second = std::move(middle);
+      }
+      node = it->second.get();
+      path.push_back(node);
+      pos += common;
+    }
+
+    Entry* entry = nullptr;
+    for (const auto& candidate : node->entries) {
+      if (candidate->value == value) {
+        entry = candidate.get();
+        break;
+      }
+    }
+    if (!entry) {
+      node->entries.push_back(std::make_unique<Entry>(Entry{value, 0}));
+      entry = node->entries.back().get();
+    }
+    entry->count += count;
+
+    // Counts only grow here, so a node's best values can only gain |entry|.
+    for (Node* on_path : path)
+      Promote(on_path, entry);
+  }
+
+  void Remove(const base::string16& value) {
+    const base::string16 key = base::i18n::ToLower(value);
+    std::vector<Node*> path(1, &root_);
+    Node* node = &root_;
+    size_t pos = 0;
+    while (pos < key.size()) {
+      auto it = node->children.find(key[pos]);
+      if (it == node->children.end() ||
+          CommonLength(it->second->label, key, pos) <
+              it->second->label.size()) {
+        return;
+      }
+      pos += it->second->label.size();
+      node = it->second.get();
+      path.push_back(node);
+    }
+
+    auto entry = std::find_if(
+        node->entries.begin(), node->entries.end(),
+        [&value](const std::unique_ptr<Entry>& e) { return e->value == value; });
+    if (entry == node->entries.end())
+      return;
+    node->entries.erase(entry);
+
+    // Bottom up, so every node is rebuilt from children that already are.
+    for (size_t i = path.size() - 1; i > 0; --i) {
+      Node* current = path[i];
+      if (current->entries.empty() && current->children.empty()) {
+        path[i - 1]->children.erase(current->label[0]);
+        continue;
+      }
+      if (current->entries.empty() && current->children.size() == 1) {
+        std::unique_ptr<Node> child =
+            std::move(current->children.begin()->second);
+        current->label += child->label;
+        current->entries = std::move(child->entries);
+        current->children = std::move(child->children);
+      }
+      RebuildTop(current);
+    }
+    RebuildTop(&root_);
+  }
+
+  std::vector<base::string16> Find(const base::string16& prefix,
+                                   size_t limit) const {
+    std::vector<base::string16> result;
+    const base::string16 key = base::i18n::ToLower(prefix);
+    const Node* node = &root_;
+    size_t pos = 0;
+    while (pos < key.size()) {
+      auto it = node->children.find(key[pos]);
+      if (it == node->children.end())
+        return result;
+      size_t common = CommonLength(it->second->label, key, pos);
+      node = it->second.get();
+      if (pos + common == key.size())
+        break;
+      if (common < node->label.size())
+        return result;
+      pos += common;
+    }
+    for (size_t i = 0; i < node->top.size() && i < limit; ++i)
+      result.push_back(node->top[i]->value);
+    return result;
+  }
+
+ private:
+  struct Node {
+    // The edge from the parent, empty for the root only.
+    base::string16 label;
+    std::map<base::char16, std::unique_ptr<Node>> children;
+    // Values whose lowercase form ends here, they differ in case only.
+    std::vector<std::unique_ptr<Entry>> entries;
+    // The best ranked values here and below, at most kMaxSuggestions.
+    std::vector<const Entry*> top;
+  };
+
+  static void Promote(Node* node, const Entry* entry) {
+    auto it = std::find(node->top.begin(), node->top.end(), entry);
+    if (it == node->top.end()) {
+      if (node->top.size() == kMaxSuggestions &&
+          !RanksBefore(entry, node->top.back())) {
+        return;
+      }
+      node->top.push_back(entry);
+      it = node->top.end() - 1;
+    }
+    for (; it != node->top.begin() && RanksBefore(*it, *(it - 1)); --it)
+      std::iter_swap(it, it - 1);
+    if (node->top.size() > kMaxSuggestions)
+      node->top.pop_back();
+  }
+
+  // The best values of a subtree are among those of the node and the best
+  // of its children.
+  static void RebuildTop(Node* node) {
+    std::vector<const Entry*> candidates;
+    for (const auto& entry : node->entries)
+      candidates.push_back(entry.get());
+    for (const auto& child : node->children) {
+      candidates.insert(candidates.end(), child.second->top.begin(),
+                        child.second->top.end());
+    }
+    size_t size = std::min(candidates.size(), kMaxSuggestions);
+    std::partial_sort(candidates.begin(), candidates.begin() + size,
+                      candidates.end(), &RanksBefore);
+    candidates.resize(size);
+    node->top = std::move(candidates);
+  }
+
+  Node root_;
+
+  DISALLOW_COPY_AND_ASSIGN(Trie);
+};
+
+XWalkFormSuggestionIndex::XWalkFormSuggestionIndex() {}
+
+XWalkFormSuggestionIndex::~XWalkFormSuggestionIndex() {}
+
+bool XWalkFormSuggestionIndex::HasField(const base::string16& name) const {
+  return fields_.count(name) > 0;
+}
+
+void XWalkFormSuggestionIndex::LoadField(const base::string16& name,
+                                         const std::vector<Entry>& entries) {
+  auto trie = std::make_unique<Trie>();
+  for (const Entry& entry : entries)
+    trie->Add(entry.value, entry.count);
+  fields_[name] = std::move(trie);
+}
+
+void XWalkFormSuggestionIndex::AddValue(const base::string16& name,
+                                        const base::string16& value) {
+  auto it = fields_.find(name);
+  if (it != fields_.end())
+    it->second->Add(value, 1);
+}
+
+void XWalkFormSuggestionIndex::RemoveValue(const base::string16& name,
+                                           const base::string16& value) {
+  auto it = fields_.find(name);
+  if (it != fields_.end())
+    it->second->Remove(value);
+}
+
+void XWalkFormSuggestionIndex::Clear() {
+  fields_.clear();
+}
+
+std::vector<base::string16> XWalkFormSuggestionIndex::GetSuggestions(
+    const base::string16& name,
+    const base::string16& prefix,
+    size_t limit) const {
+  DCHECK_LE(limit, kMaxSuggestions);
+  auto it = fields_.find(name);
+  if (it == fields_.end())
+    return std::vector<base::string16>();
+  return it->second->Find(prefix, limit);
+}
+
+}  // namespace xwalk
@@ -0,0 +1,69 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_BROWSER_XWALK_FORM_SUGGESTION_INDEX_H_
+#define XWALK_RUNTIME_BROWSER_XWALK_FORM_SUGGESTION_INDEX_H_
+
+#include <stddef.h>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/string16.h"
+
+namespace xwalk {
+
+// The autocomplete values of the form database, per field name, in memory.
+// Every field is a compressed trie over the lowercased values, and every
+// node keeps the most submitted values below it, so a suggestion query walks
+// at most the length of the prefix and copies a handful of pointers.
+//
+// Matching is case insensitive and ranking is by submission count, most
+// first, like the queries of autofill::AutofillTable. Ties go to the lower
+// value so the order does not depend on insertion.
+class XWalkFormSuggestionIndex {
+ public:
+  // Also the most a query returns.
+  static const size_t kMaxSuggestions = 6;
+
+  struct Entry {
+    base::string16 value;
+    int count;
+  };
+
+  XWalkFormSuggestionIndex();
+  ~XWalkFormSuggestionIndex();
+
+  // Whether LoadField() was called for |name| since the last Clear().
+  bool HasField(const base::string16& name) const;
+
+  // Replaces the values of |name| with |entries|, as read from the database.
+  void LoadField(const base::string16& name, const std::vector<Entry>& entries);
+
+  // Counts one more submission of |value| for |name|. Ignored for fields
+  // that are not loaded, the database has it when they are.
+  void AddValue(const base::string16& name, const base::string16& value);
+  void RemoveValue(const base::string16& name, const base::string16& value);
+
+  // Forgets every field.
+  void Clear();
+
+  // At most |limit| values of |name| starting with |prefix|.
+  std::vector<base::string16> GetSuggestions(const base::string16& name,
+                                             const base::string16& prefix,
+                                             size_t limit) const;
+
+ private:
+  class Trie;
+
+  std::map<base::string16, std::unique_ptr<Trie>> fields_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkFormSuggestionIndex);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_BROWSER_XWALK_FORM_SUGGESTION_INDEX_H_
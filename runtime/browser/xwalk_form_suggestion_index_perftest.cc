@@ -0,0 +1,144 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures an autocomplete query for one field holding 10k and 100k values,
+// as the user types the first characters of a value: through
+// XWalkFormSuggestionIndex, and through the autofill::AutofillTable query
+// every keystroke used to run. The database time leaves out the hops to the
+// database thread and back, which the index also saves. Also measures how
+// long the index takes to load the field.
+
+#include <stddef.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/macros.h"
+#include "base/strings/stringprintf.h"
+#include "base/strings/utf_string_conversions.h"
+#include "base/time/time.h"
+#include "components/autofill/core/browser/webdata/autofill_change.h"
+#include "components/autofill/core/browser/webdata/autofill_entry.h"
+#include "components/autofill/core/browser/webdata/autofill_table.h"
+#include "components/autofill/core/common/form_field_data.h"
+#include "components/webdata/common/web_database.h"
+#include "sql/statement.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "xwalk/runtime/browser/xwalk_form_suggestion_index.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+
+namespace xwalk {
+
+namespace {
+
+// Every value is queried with prefixes of these lengths.
+const size_t kMaxPrefixLength = 6;
+const size_t kQueriedValues = 500;
+
+class FormSuggestionPerfTest : public testing::Test {
+ protected:
+  FormSuggestionPerfTest() : name_(base::ASCIIToUTF16("email")) {}
+
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    db_.AddTable(&table_);
+    ASSERT_EQ(sql::INIT_OK,
+              db_.Init(temp_dir_.GetPath().AppendASCII("Form Data")));
+  }
+
+  void RunBenchmark(size_t value_count, const std::string& story) {
+    std::vector<base::string16> values;
+    for (size_t i = 0; i < value_count; ++i) {
+      values.push_back(base::ASCIIToUTF16(
+          base::StringPrintf("user%zu.%zx@host%zu.example.com", i, i * 7919,
+                             i % 97)));
+    }
+    Populate(values);
+
+    base::TimeTicks start = base::TimeTicks::Now();
+    XWalkFormSuggestionIndex index;
+    index.LoadField(name_, ReadField());
+    XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+        "form_suggestion_load", story,
+        {(base::TimeTicks::Now() - start).InMicrosecondsF()}));
+
+    std::vector<base::string16> prefixes;
+    for (size_t i = 0; i < kQueriedValues; ++i) {
+      const base::string16& value = values[i * value_count / kQueriedValues];
+      for (size_t length = 1; length <= kMaxPrefixLength; ++length)
+        prefixes.push_back(value.substr(0, length));
+    }
+
+    const size_t limit = XWalkFormSuggestionIndex::kMaxSuggestions;
+    std::vector<size_t> database_sizes;
+    std::vector<double> database_us;
+    for (const base::string16& prefix : prefixes) {
+      std::vector<autofill::AutofillEntry> entries;
+      start = base::TimeTicks::Now();
+      table_.GetFormValuesForElementName(name_, prefix, &entries, limit);
+      database_us.push_back((base::TimeTicks::Now() - start).InMicrosecondsF());
+      database_sizes.push_back(entries.size());
+    }
+
+    std::vector<size_t> index_sizes;
+    std::vector<double> index_us;
+    for (const base::string16& prefix : prefixes) {
+      start = base::TimeTicks::Now();
+      size_t size = index.GetSuggestions(name_, prefix, limit).size();
+      index_us.push_back((base::TimeTicks::Now() - start).InMicrosecondsF());
+      index_sizes.push_back(size);
+    }
+
+    EXPECT_EQ(database_sizes, index_sizes);
+    XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+        "form_suggestion_query_database", story, std::move(database_us)));
+    XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+        "form_suggestion_query_index", story, std::move(index_us)));
+  }
+
+  // Every seventh value is submitted twice so the ranking has work to do.
+  void Populate(const std::vector<base::string16>& values) {
+    autofill::FormFieldData field;
+    field.name = name_;
+    std::vector<autofill::AutofillChange> changes;
+    ASSERT_TRUE(db_.GetSQLConnection()->BeginTransaction());
+    for (size_t i = 0; i < values.size(); ++i) {
+      field.value = values[i];
+      for (size_t j = 0; j < (i % 7 ? 1u : 2u); ++j)
+        ASSERT_TRUE(table_.AddFormFieldValues({field}, &changes));
+    }
+    ASSERT_TRUE(db_.GetSQLConnection()->CommitTransaction());
+  }
+
+  // What XWalkFormDatabaseService reads to load a field.
+  std::vector<XWalkFormSuggestionIndex::Entry> ReadField() {
+    std::vector<XWalkFormSuggestionIndex::Entry> entries;
+    sql::Statement statement(db_.GetSQLConnection()->GetUniqueStatement(
+        "SELECT value, count FROM autofill WHERE name = ?"));
+    statement.BindString16(0, name_);
+    while (statement.Step())
+      entries.push_back({statement.ColumnString16(0), statement.ColumnInt(1)});
+    return entries;
+  }
+
+  const base::string16 name_;
+  base::ScopedTempDir temp_dir_;
+  autofill::AutofillTable table_;
+  WebDatabase db_;
+};
+
+}  // namespace
+
+TEST_F(FormSuggestionPerfTest, TenThousandValues) {
+  RunBenchmark(10 * 1000, "_10k");
+}
+
+TEST_F(FormSuggestionPerfTest, HundredThousandValues) {
+  RunBenchmark(100 * 1000, "_100k");
+}
+
+}  // namespace xwalk
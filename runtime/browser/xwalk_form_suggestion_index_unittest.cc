@@ -0,0 +1,141 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/xwalk_form_suggestion_index.h"
+
+#include <vector>
+
+#include "base/macros.h"
+#include "base/strings/utf_string_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using base::ASCIIToUTF16;
+
+namespace xwalk {
+
+namespace {
+
+const size_t kMax = XWalkFormSuggestionIndex::kMaxSuggestions;
+
+XWalkFormSuggestionIndex::Entry MakeEntry(const char* value, int count) {
+  return XWalkFormSuggestionIndex::Entry{ASCIIToUTF16(value), count};
+}
+
+std::vector<base::string16> Values(std::vector<const char*> values) {
+  std::vector<base::string16> result;
+  for (const char* value : values)
+    result.push_back(ASCIIToUTF16(value));
+  return result;
+}
+
+class XWalkFormSuggestionIndexTest : public testing::Test {
+ protected:
+  std::vector<base::string16> Suggest(const char* prefix,
+                                      size_t limit = kMax) {
+    return index_.GetSuggestions(kName, ASCIIToUTF16(prefix), limit);
+  }
+
+  void Add(const char* value) { index_.AddValue(kName, ASCIIToUTF16(value)); }
+  void Remove(const char* value) {
+    index_.RemoveValue(kName, ASCIIToUTF16(value));
+  }
+
+  const base::string16 kName = ASCIIToUTF16("email");
+  XWalkFormSuggestionIndex index_;
+};
+
+}  // namespace
+
+TEST_F(XWalkFormSuggestionIndexTest, RanksByCountThenValue) {
+  index_.LoadField(kName, {MakeEntry("bob@b.com", 1), MakeEntry("ann@a.com", 1),
+                           MakeEntry("amy@a.com", 5)});
+  EXPECT_EQ(Values({"amy@a.com", "ann@a.com", "bob@b.com"}), Suggest(""));
+  EXPECT_EQ(Values({"amy@a.com", "ann@a.com"}), Suggest("a"));
+  EXPECT_EQ(Values({"amy@a.com"}), Suggest("a", 1));
+
+  Add("ann@a.com");
+  Add("ann@a.com");
+  EXPECT_EQ(Values({"amy@a.com", "ann@a.com"}), Suggest("a"));
+  for (int i = 0; i < 3; ++i)
+    Add("ann@a.com");
+  EXPECT_EQ(Values({"ann@a.com", "amy@a.com"}), Suggest("a"));
+}
+
+TEST_F(XWalkFormSuggestionIndexTest, SplitsEdges) {
+  index_.LoadField(kName, {});
+  Add("abcdef");
+  Add("abcxyz");
+  Add("ab");
+  EXPECT_EQ(Values({"ab", "abcdef", "abcxyz"}), Suggest("a"));
+  EXPECT_EQ(Values({"ab", "abcdef", "abcxyz"}), Suggest("ab"));
+  EXPECT_EQ(Values({"abcdef", "abcxyz"}), Suggest("abc"));
+  EXPECT_EQ(Values({"abcdef"}), Suggest("abcd"));
+  EXPECT_EQ(Values({"abcdef"}), Suggest("abcdef"));
+  EXPECT_TRUE(Suggest("abcdefg").empty());
+  EXPECT_TRUE(Suggest("abd").empty());
+  EXPECT_TRUE(Suggest("b").empty());
+}
+
+TEST_F(XWalkFormSuggestionIndexTest, MatchesCaseInsensitively) {
+  index_.LoadField(kName, {MakeEntry("Alice", 2), MakeEntry("alice", 1),
+                           MakeEntry("ALBERT", 1)});
+  EXPECT_EQ(Values({"Alice", "ALBERT", "alice"}), Suggest("al"));
+  EXPECT_EQ(Values({"Alice", "alice"}), Suggest("ALI"));
+}
+
+TEST_F(XWalkFormSuggestionIndexTest, KeepsTheBestBelowEveryNode) {
+  std::vector<XWalkFormSuggestionIndex::Entry> entries;
+  const char* values[] = {"a1", "a2", "a3", "a4", "a5", "a6", "a7", "a8"};
+  for (size_t i = 0; i < arraysize(values); ++i)
+    entries.push_back(MakeEntry(values[i], 10 - i));
+  index_.LoadField(kName, entries);
+  EXPECT_EQ(Values({"a1", "a2", "a3", "a4", "a5", "a6"}), Suggest("a"));
+
+  // Enters the best once it outranks the last of them, a tie is not enough.
+  Add("a8");
+  Add("a8");
+  EXPECT_EQ(Values({"a1", "a2", "a3", "a4", "a5", "a6"}), Suggest("a"));
+  Add("a8");
+  EXPECT_EQ(Values({"a1", "a2", "a3", "a4", "a5", "a8"}), Suggest("a"));
+
+  // A removal lets the next one in.
+  Remove("a2");
+  EXPECT_EQ(Values({"a1", "a3", "a4", "a5", "a8", "a6"}), Suggest("a"));
+  EXPECT_TRUE(Suggest("a2").empty());
+}
+
+TEST_F(XWalkFormSuggestionIndexTest, RemoveMergesEdges) {
+  index_.LoadField(kName, {MakeEntry("abc", 1), MakeEntry("abd", 1),
+                           MakeEntry("ab", 1)});
+  Remove("ab");
+  EXPECT_EQ(Values({"abc", "abd"}), Suggest("ab"));
+  Remove("abd");
+  EXPECT_EQ(Values({"abc"}), Suggest("a"));
+  EXPECT_EQ(Values({"abc"}), Suggest("abc"));
+  Remove("abc");
+  EXPECT_TRUE(Suggest("").empty());
+
+  // Still usable once empty.
+  Add("abx");
+  EXPECT_EQ(Values({"abx"}), Suggest("ab"));
+}
+
+TEST_F(XWalkFormSuggestionIndexTest, OnlyLoadedFieldsChange) {
+  Add("ann@a.com");
+  EXPECT_FALSE(index_.HasField(kName));
+  EXPECT_TRUE(Suggest("a").empty());
+
+  index_.LoadField(kName, {MakeEntry("ann@a.com", 1)});
+  EXPECT_TRUE(index_.HasField(kName));
+  EXPECT_FALSE(index_.HasField(ASCIIToUTF16("name")));
+  index_.AddValue(ASCIIToUTF16("name"), ASCIIToUTF16("Ann"));
+  EXPECT_TRUE(
+      index_.GetSuggestions(ASCIIToUTF16("name"), ASCIIToUTF16("A"), kMax)
+          .empty());
+
+  index_.Clear();
+  EXPECT_FALSE(index_.HasField(kName));
+}
+
+}  // namespace xwalk
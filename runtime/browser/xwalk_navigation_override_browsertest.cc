@@ -0,0 +1,207 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/xwalk_navigation_override_throttle.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/macros.h"
+#include "base/run_loop.h"
+#include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "base/time/time.h"
+#include "content/public/browser/web_contents.h"
+#include "content/public/test/browser_test_utils.h"
+#include "content/public/test/test_navigation_observer.h"
+#include "net/test/embedded_test_server/embedded_test_server.h"
+#include "net/test/embedded_test_server/http_request.h"
+#include "net/test/embedded_test_server/http_response.h"
+#include "xwalk/runtime/browser/runtime.h"
+#include "xwalk/test/base/in_process_browser_test.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+#include "xwalk/test/base/xwalk_test_utils.h"
+
+using xwalk::Runtime;
+using xwalk::XWalkNavigationOverrideThrottle;
+
+namespace {
+
+const int kClickCount = 20;
+
+const char kLinksPage[] =
+    "<html><body>"
+    "<a id='override' href='/override'>override</a>"
+    "<a id='allow' href='/allowed.html'>allow</a>"
+    "</body></html>";
+
+// Answered by the renderer main thread, so it only returns once that thread
+// is free to run script.
+const char kPingScript[] = "window.domAutomationController.send('pong');";
+
+std::unique_ptr<net::test_server::HttpResponse> HandleRequest(
+    const net::test_server::HttpRequest& request) {
+  std::unique_ptr<net::test_server::BasicHttpResponse> response(
+      new net::test_server::BasicHttpResponse);
+  response->set_content_type("text/html");
+  if (request.GetURL().path() == "/links.html")
+    response->set_content(kLinksPage);
+  else
+    response->set_content("<html><body>loaded</body></html>");
+  return std::move(response);
+}
+
+// Stands in for the Java client: overrides everything below /override.
+// Decisions are answered from a task, or held until the test answers them,
+// like an embedder that is still thinking.
+class OverrideClient : public XWalkNavigationOverrideThrottle::Client {
+ public:
+  OverrideClient() : call_count_(0), hold_decisions_(false) {}
+  ~OverrideClient() override {}
+
+  void ShouldOverrideUrlLoading(
+      const GURL& url,
+      bool has_user_gesture,
+      bool is_redirect,
+      bool is_main_frame,
+      base::OnceCallback<void(bool ignore_navigation)> decided) override {
+    ++call_count_;
+    const bool ignore = base::StartsWith(url.path(), "/override",
+                                         base::CompareCase::SENSITIVE);
+    base::OnceClosure decision = base::BindOnce(std::move(decided), ignore);
+    if (!hold_decisions_) {
+      base::ThreadTaskRunnerHandle::Get()->PostTask(FROM_HERE,
+                                                    std::move(decision));
+      return;
+    }
+    held_.push_back(std::move(decision));
+    if (quit_on_call_)
+      std::move(quit_on_call_).Run();
+  }
+
+  void WaitForHeldDecision() {
+    if (!held_.empty())
+      return;
+    base::RunLoop run_loop;
+    quit_on_call_ = run_loop.QuitClosure();
+    run_loop.Run();
+  }
+
+  void AnswerHeldDecisions() {
+    std::vector<base::OnceClosure> held;
+    held.swap(held_);
+    for (base::OnceClosure& decision : held)
+      std::move(decision).Run();
+  }
+
+  int call_count() const { return call_count_; }
+  size_t held_count() const { return held_.size(); }
+  void set_hold_decisions(bool hold) { hold_decisions_ = hold; }
+
+ private:
+  int call_count_;
+  bool hold_decisions_;
+  std::vector<base::OnceClosure> held_;
+  base::OnceClosure quit_on_call_;
+
+  DISALLOW_COPY_AND_ASSIGN(OverrideClient);
+};
+
+XWalkNavigationOverrideThrottle::Client* GetClient(
+    OverrideClient* client,
+    content::WebContents* web_contents) {
+  return client;
+}
+
+}  // namespace
+
+class XWalkNavigationOverrideBrowserTest : public InProcessBrowserTest {
+ protected:
+  void SetUp() override {
+    embedded_test_server()->RegisterRequestHandler(
+        base::BindRepeating(&HandleRequest));
+    ASSERT_TRUE(embedded_test_server()->Start());
+    InProcessBrowserTest::SetUp();
+  }
+
+  void SetUpOnMainThread() override {
+    XWalkNavigationOverrideThrottle::SetClientGetterForTesting(
+        base::BindRepeating(&GetClient, &client_));
+  }
+
+  void ProperMainThreadCleanup() override {
+    XWalkNavigationOverrideThrottle::SetClientGetterForTesting(
+        XWalkNavigationOverrideThrottle::ClientGetter());
+  }
+
+  OverrideClient client_;
+};
+
+// While the embedder has yet to decide on a clicked link, the renderer main
+// thread keeps running script. A synchronous IPC would hold it until the
+// decision came in.
+IN_PROC_BROWSER_TEST_F(XWalkNavigationOverrideBrowserTest,
+                       PendingDecisionDoesNotBlockRenderer) {
+  Runtime* runtime = CreateRuntime(GURL());
+  content::WebContents* web_contents = runtime->web_contents();
+  const GURL page_url = embedded_test_server()->GetURL("/links.html");
+  xwalk_test_utils::NavigateToURL(runtime, page_url);
+  // Loads started by the application are not offered.
+  EXPECT_EQ(0, client_.call_count());
+
+  client_.set_hold_decisions(true);
+  std::vector<double> samples_us;
+  for (int i = 0; i < kClickCount; ++i) {
+    content::TestNavigationObserver observer(web_contents);
+    ASSERT_TRUE(content::ExecuteScript(
+        web_contents,
+        base::StringPrintf("var link = document.getElementById('override');"
+                           "link.href = '/override?%d';"
+                           "link.click();",
+                           i)));
+    client_.WaitForHeldDecision();
+
+    const base::TimeTicks start = base::TimeTicks::Now();
+    std::string pong;
+    ASSERT_TRUE(content::ExecuteScriptAndExtractString(web_contents,
+                                                       kPingScript, &pong));
+    samples_us.push_back((base::TimeTicks::Now() - start).InMicrosecondsF());
+    EXPECT_EQ("pong", pong);
+    // The renderer answered with the decision still outstanding.
+    EXPECT_EQ(1u, client_.held_count());
+
+    client_.AnswerHeldDecisions();
+    observer.Wait();
+    EXPECT_FALSE(observer.last_navigation_succeeded());
+  }
+
+  // Every click was offered and dropped, the page stayed.
+  EXPECT_EQ(kClickCount, client_.call_count());
+  EXPECT_EQ(page_url, web_contents->GetLastCommittedURL());
+
+  XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+      "override_pending_renderer_roundtrip", "_held",
+      std::move(samples_us)));
+}
+
+IN_PROC_BROWSER_TEST_F(XWalkNavigationOverrideBrowserTest,
+                       AllowedNavigationResumes) {
+  Runtime* runtime = CreateRuntime(GURL());
+  xwalk_test_utils::NavigateToURL(
+      runtime, embedded_test_server()->GetURL("/links.html"));
+
+  content::TestNavigationObserver observer(runtime->web_contents());
+  ASSERT_TRUE(content::ExecuteScript(
+      runtime->web_contents(), "document.getElementById('allow').click();"));
+  observer.Wait();
+
+  EXPECT_EQ(1, client_.call_count());
+  EXPECT_TRUE(observer.last_navigation_succeeded());
+  EXPECT_EQ(embedded_test_server()->GetURL("/allowed.html"),
+            runtime->web_contents()->GetLastCommittedURL());
+}
@@ -0,0 +1,139 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/xwalk_navigation_override_throttle.h"
+
+#include "base/bind.h"
+#include "base/memory/ptr_util.h"
+#include "base/no_destructor.h"
+#include "content/public/browser/navigation_handle.h"
+#include "content/public/browser/web_contents.h"
+#include "ui/base/page_transition_types.h"
+#include "url/gurl.h"
+#include "url/url_constants.h"
+
+#if defined(OS_ANDROID)
+#include "xwalk/runtime/browser/android/xwalk_contents_client_bridge.h"
+#endif
+
+namespace xwalk {
+
+namespace {
+
+XWalkNavigationOverrideThrottle::ClientGetter* GetTestingClientGetter() {
+  static base::NoDestructor<XWalkNavigationOverrideThrottle::ClientGetter>
+      getter;
+  return getter.get();
+}
+
+XWalkNavigationOverrideThrottle::Client* GetClient(
+    content::WebContents* web_contents) {
+  const XWalkNavigationOverrideThrottle::ClientGetter& getter =
+      *GetTestingClientGetter();
+  if (!getter.is_null())
+    return getter.Run(web_contents);
+#if defined(OS_ANDROID)
+  return XWalkContentsClientBridge::FromWebContents(web_contents);
+#else
+  return nullptr;
+#endif
+}
+
+}  // namespace
+
+// static
+std::unique_ptr<content::NavigationThrottle>
+XWalkNavigationOverrideThrottle::MaybeCreate(
+    content::NavigationHandle* navigation_handle) {
+  Client* client = GetClient(navigation_handle->GetWebContents());
+  if (!client)
+    return nullptr;
+  return base::WrapUnique(
+      new XWalkNavigationOverrideThrottle(navigation_handle, client));
+}
+
+// static
+void XWalkNavigationOverrideThrottle::SetClientGetterForTesting(
+    const ClientGetter& getter) {
+  *GetTestingClientGetter() = getter;
+}
+
+XWalkNavigationOverrideThrottle::XWalkNavigationOverrideThrottle(
+    content::NavigationHandle* navigation_handle,
+    Client* client)
+    : content::NavigationThrottle(navigation_handle),
+      client_(client),
+      asking_(false),
+      answered_(false),
+      ignore_navigation_(false),
+      weak_factory_(this) {}
+
+XWalkNavigationOverrideThrottle::~XWalkNavigationOverrideThrottle() {}
+
+content::NavigationThrottle::ThrottleCheckResult
+XWalkNavigationOverrideThrottle::WillStartRequest() {
+  return CheckNavigation(false);
+}
+
+content::NavigationThrottle::ThrottleCheckResult
+XWalkNavigationOverrideThrottle::WillRedirectRequest() {
+  return CheckNavigation(true);
+}
+
+const char* XWalkNavigationOverrideThrottle::GetNameForLogging() {
+  return "XWalkNavigationOverrideThrottle";
+}
+
+content::NavigationThrottle::ThrottleCheckResult
+XWalkNavigationOverrideThrottle::CheckNavigation(bool is_redirect) {
+  content::NavigationHandle* handle = navigation_handle();
+  // Only GETs can be overridden.
+  if (handle->IsPost())
+    return PROCEED;
+
+  // Navigations from loadUrl() and back/forward are application initiated
+  // and are only offered when they redirect.
+  const bool application_initiated =
+      !handle->IsRendererInitiated() ||
+      (handle->GetPageTransition() & ui::PAGE_TRANSITION_FORWARD_BACK);
+  if (application_initiated && !is_redirect)
+    return PROCEED;
+
+  // For HTTP schemes, only top-level navigations can be overridden, the same
+  // goes for about:blank.
+  const GURL& url = handle->GetURL();
+  const bool is_main_frame = handle->IsInMainFrame();
+  if (!is_main_frame &&
+      (url.SchemeIs(url::kHttpScheme) || url.SchemeIs(url::kHttpsScheme) ||
+       url.SchemeIs(url::kAboutScheme))) {
+    return PROCEED;
+  }
+
+  answered_ = false;
+  asking_ = true;
+  client_->ShouldOverrideUrlLoading(
+      url, handle->HasUserGesture(), is_redirect, is_main_frame,
+      base::BindOnce(&XWalkNavigationOverrideThrottle::OnDecided,
+                     weak_factory_.GetWeakPtr()));
+  asking_ = false;
+
+  if (!answered_)
+    return DEFER;
+  return ignore_navigation_ ? CANCEL_AND_IGNORE : PROCEED;
+}
+
+void XWalkNavigationOverrideThrottle::OnDecided(bool ignore_navigation) {
+  answered_ = true;
+  ignore_navigation_ = ignore_navigation;
+  if (asking_)
+    return;
+
+  if (ignore_navigation)
+    CancelDeferredNavigation(CANCEL_AND_IGNORE);
+  else
+    Resume();
+  // |this| may be gone now.
+}
+
+}  // namespace xwalk
@@ -0,0 +1,87 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_BROWSER_XWALK_NAVIGATION_OVERRIDE_THROTTLE_H_
+#define XWALK_RUNTIME_BROWSER_XWALK_NAVIGATION_OVERRIDE_THROTTLE_H_
+
+#include <memory>
+
+#include "base/callback.h"
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "content/public/browser/navigation_throttle.h"
+
+class GURL;
+
+namespace content {
+class WebContents;
+}
+
+namespace xwalk {
+
+// Lets the embedder take over content initiated navigations, what
+// shouldOverrideUrlLoading() is for on Android. The navigation is deferred
+// in the browser while the client decides, and is then resumed or dropped,
+// so the renderer never waits for the embedder.
+//
+// The rules for which navigations are offered are the ones android_webview
+// uses: only GETs, only navigations started by the page, plus redirects of
+// any navigation, and for subframes only schemes other than http(s) and
+// about.
+class XWalkNavigationOverrideThrottle : public content::NavigationThrottle {
+ public:
+  class Client {
+   public:
+    // Runs |decided| with true to drop the navigation, false to let it
+    // continue. |decided| may be run before this returns.
+    virtual void ShouldOverrideUrlLoading(
+        const GURL& url,
+        bool has_user_gesture,
+        bool is_redirect,
+        bool is_main_frame,
+        base::OnceCallback<void(bool ignore_navigation)> decided) = 0;
+
+   protected:
+    virtual ~Client() {}
+  };
+
+  using ClientGetter =
+      base::RepeatingCallback<Client*(content::WebContents* web_contents)>;
+
+  // Returns nullptr if there is no client to ask for this navigation.
+  static std::unique_ptr<content::NavigationThrottle> MaybeCreate(
+      content::NavigationHandle* navigation_handle);
+
+  // Replaces the default lookup, which only finds clients on Android. Pass a
+  // null callback to restore it.
+  static void SetClientGetterForTesting(const ClientGetter& getter);
+
+  ~XWalkNavigationOverrideThrottle() override;
+
+  // content::NavigationThrottle implementation.
+  ThrottleCheckResult WillStartRequest() override;
+  ThrottleCheckResult WillRedirectRequest() override;
+  const char* GetNameForLogging() override;
+
+ private:
+  XWalkNavigationOverrideThrottle(content::NavigationHandle* navigation_handle,
+                                  Client* client);
+
+  ThrottleCheckResult CheckNavigation(bool is_redirect);
+  void OnDecided(bool ignore_navigation);
+
+  Client* client_;
+  // Set while the client is being asked, to tell a synchronous answer from
+  // an asynchronous one.
+  bool asking_;
+  bool answered_;
+  bool ignore_navigation_;
+  base::WeakPtrFactory<XWalkNavigationOverrideThrottle> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkNavigationOverrideThrottle);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_BROWSER_XWALK_NAVIGATION_OVERRIDE_THROTTLE_H_
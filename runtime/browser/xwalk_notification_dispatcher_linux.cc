@@ -0,0 +1,360 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/xwalk_notification_dispatcher_linux.h"
+
+#include <libnotify/notification.h>
+#include <libnotify/notify.h>
+
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/strings/utf_string_conversions.h"
+#include "base/task_runner_util.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "base/time/tick_clock.h"
+
+namespace xwalk {
+
+namespace {
+
+// Defined by 'org.freedesktop.Notifications'.
+const gint kClosedByUser = 2;
+
+struct Request {
+  std::string id;
+  GURL origin;
+  std::string title;
+  std::string body;
+};
+
+// Tagged notifications replace each other within an origin, the others
+// stand on their own.
+std::string CoalescingKey(const std::string& notification_id,
+                          const GURL& origin,
+                          const std::string& tag) {
+  if (tag.empty())
+    return "id:" + notification_id;
+  return "tag:" + origin.spec() + "\n" + tag;
+}
+
+}  // namespace
+
+const int XWalkNotificationDispatcher::kMaxBurst = 20;
+const int XWalkNotificationDispatcher::kRefillIntervalMs = 500;
+
+// Owns the libnotify state, only used on the dispatcher sequence.
+class XWalkNotificationDispatcher::Backend {
+ public:
+  Backend(base::WeakPtr<XWalkNotificationDispatcher> dispatcher,
+          scoped_refptr<base::SequencedTaskRunner> reply_task_runner,
+          const base::TickClock* clock)
+      : dispatcher_(dispatcher),
+        reply_task_runner_(reply_task_runner),
+        clock_(clock),
+        initialized_(false),
+        flush_scheduled_(false),
+        next_serial_(1),
+        weak_factory_(this) {}
+
+  ~Backend() {
+    for (auto& shown : shown_)
+      Release(&shown.second);
+    if (initialized_)
+      notify_uninit();
+  }
+
+  void Init() { initialized_ = notify_init("xwalk"); }
+
+  void Enqueue(const std::string& key, Request request) {
+    auto it = pending_.find(key);
+    if (it != pending_.end()) {
+      ++origins_[it->second.origin.spec()].stats.coalesced;
+      // The replaced notification never shows, its page hears it closed.
+      if (it->second.id != request.id)
+        ReportClosed(it->second.id, false);
+      it->second = std::move(request);
+      return;
+    }
+    order_.push_back(key);
+    pending_.emplace(key, std::move(request));
+    if (!flush_scheduled_) {
+      flush_scheduled_ = true;
+      // Runs after whatever was queued meanwhile, so it gets coalesced.
+      base::SequencedTaskRunnerHandle::Get()->PostTask(
+          FROM_HERE,
+          base::BindOnce(&Backend::Flush, weak_factory_.GetWeakPtr()));
+    }
+  }
+
+  void Close(const std::string& notification_id) {
+    auto id = keys_.find(notification_id);
+    if (id == keys_.end()) {
+      // Not shown yet.
+      for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+        if (it->second.id == notification_id) {
+          order_.erase(std::find(order_.begin(), order_.end(), it->first));
+          pending_.erase(it);
+          return;
+        }
+      }
+      return;
+    }
+    auto shown = shown_.find(id->second);
+    keys_.erase(id);
+    if (shown == shown_.end())
+      return;
+    notify_notification_close(shown->second.notification, nullptr);
+    Release(&shown->second);
+    shown_.erase(shown);
+  }
+
+  void Flush() {
+    flush_scheduled_ = false;
+    std::vector<std::string> order;
+    std::map<std::string, Request> pending;
+    order.swap(order_);
+    pending.swap(pending_);
+    for (const std::string& key : order)
+      Deliver(key, pending[key]);
+  }
+
+  Stats GetStats(const GURL& origin) {
+    auto it = origins_.find(origin.spec());
+    return it == origins_.end() ? Stats() : it->second.stats;
+  }
+
+ private:
+  struct OriginState {
+    double tokens = kMaxBurst;
+    base::TimeTicks last_refill;
+    Stats stats;
+  };
+
+  struct Shown {
+    std::string id;
+    // Tells this NotifyNotification from any later one under the same key.
+    uint64_t serial;
+    NotifyNotification* notification;
+    gulong handler;
+  };
+
+  // Bound to the "closed" signal, which fires on whatever thread iterates
+  // the default GLib main context. Freed by GLib with the signal handler.
+  // Only hops to the backend sequence, which owns the notifications.
+  struct SignalContext {
+    scoped_refptr<base::SequencedTaskRunner> task_runner;
+    base::WeakPtr<Backend> backend;
+    uint64_t serial;
+  };
+
+  static void OnClosedSignal(NotifyNotification* notification,
+                             gpointer user_data) {
+    SignalContext* context = static_cast<SignalContext*>(user_data);
+    context->task_runner->PostTask(
+        FROM_HERE,
+        base::BindOnce(&Backend::OnClosed, context->backend, context->serial));
+  }
+
+  static void DeleteSignalContext(gpointer data, GClosure* closure) {
+    delete static_cast<SignalContext*>(data);
+  }
+
+  bool TakeToken(OriginState* state) {
+    const base::TimeTicks now = clock_->NowTicks();
+    if (state->last_refill.is_null())
+      state->last_refill = now;
+    const double refilled =
+        (now - state->last_refill).InMillisecondsF() / kRefillIntervalMs;
+    state->tokens = std::min<double>(kMaxBurst, state->tokens + refilled);
+    state->last_refill = now;
+    if (state->tokens < 1)
+      return false;
+    state->tokens -= 1;
+    return true;
+  }
+
+  void Deliver(const std::string& key, const Request& request) {
+    OriginState& state = origins_[request.origin.spec()];
+    if (!initialized_ || !TakeToken(&state)) {
+      ++state.stats.dropped;
+      // Unless it updates a notification that stays up as it was.
+      if (!keys_.count(request.id))
+        ReportClosed(request.id, false);
+      return;
+    }
+
+    auto it = shown_.find(key);
+    if (it != shown_.end()) {
+      keys_.erase(it->second.id);
+      if (it->second.id != request.id)
+        ReportClosed(it->second.id, false);
+      it->second.id = request.id;
+      notify_notification_update(it->second.notification,
+                                 request.title.c_str(), request.body.c_str(),
+                                 nullptr);
+    } else {
+      const uint64_t serial = next_serial_++;
+      NotifyNotification* notification = notify_notification_new(
+          request.title.c_str(), request.body.c_str(), nullptr);
+      gulong handler = g_signal_connect_data(
+          G_OBJECT(notification), "closed", G_CALLBACK(&OnClosedSignal),
+          new SignalContext{base::SequencedTaskRunnerHandle::Get(),
+                            weak_factory_.GetWeakPtr(), serial},
+          &DeleteSignalContext, static_cast<GConnectFlags>(0));
+      it = shown_
+               .emplace(key,
+                        Shown{request.id, serial, notification, handler})
+               .first;
+    }
+    keys_[request.id] = key;
+
+    GError* error = nullptr;
+    if (!notify_notification_show(it->second.notification, &error)) {
+      LOG(WARNING) << "Could not show notification: "
+                   << (error ? error->message : "unknown error");
+      if (error)
+        g_error_free(error);
+      ++state.stats.dropped;
+      keys_.erase(request.id);
+      Release(&it->second);
+      shown_.erase(it);
+      ReportClosed(request.id, false);
+      return;
+    }
+
+    ++state.stats.delivered;
+    reply_task_runner_->PostTask(
+        FROM_HERE,
+        base::BindOnce(&XWalkNotificationDispatcher::NotificationShown,
+                       dispatcher_, request.id));
+  }
+
+  void OnClosed(uint64_t serial) {
+    auto it = std::find_if(
+        shown_.begin(), shown_.end(),
+        [serial](const std::pair<const std::string, Shown>& shown) {
+          return shown.second.serial == serial;
+        });
+    // Already closed from this side.
+    if (it == shown_.end())
+      return;
+
+    // Still referenced until Release(), so the reason can be read here.
+    const gint reason =
+        notify_notification_get_closed_reason(it->second.notification);
+    const std::string id = it->second.id;
+    keys_.erase(id);
+    Release(&it->second);
+    shown_.erase(it);
+    ReportClosed(id, reason == kClosedByUser);
+  }
+
+  void ReportClosed(const std::string& notification_id, bool by_user) {
+    reply_task_runner_->PostTask(
+        FROM_HERE,
+        base::BindOnce(&XWalkNotificationDispatcher::NotificationClosed,
+                       dispatcher_, notification_id, by_user));
+  }
+
+  void Release(Shown* shown) {
+    g_signal_handler_disconnect(shown->notification, shown->handler);
+    g_object_unref(shown->notification);
+  }
+
+  base::WeakPtr<XWalkNotificationDispatcher> dispatcher_;
+  scoped_refptr<base::SequencedTaskRunner> reply_task_runner_;
+  const base::TickClock* clock_;
+  bool initialized_;
+  bool flush_scheduled_;
+  uint64_t next_serial_;
+
+  // Requests not sent yet, by coalescing key, in arrival order.
+  std::vector<std::string> order_;
+  std::map<std::string, Request> pending_;
+  // Notifications the daemon knows about, by coalescing key.
+  std::map<std::string, Shown> shown_;
+  // Coalescing keys by notification id.
+  std::map<std::string, std::string> keys_;
+  std::map<std::string, OriginState> origins_;
+
+  base::WeakPtrFactory<Backend> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(Backend);
+};
+
+XWalkNotificationDispatcher::XWalkNotificationDispatcher(
+    Client* client,
+    scoped_refptr<base::SequencedTaskRunner> task_runner,
+    const base::TickClock* clock)
+    : client_(client),
+      task_runner_(task_runner),
+      backend_(nullptr, base::OnTaskRunnerDeleter(task_runner)),
+      weak_factory_(this) {
+  backend_.reset(new Backend(weak_factory_.GetWeakPtr(),
+                             base::SequencedTaskRunnerHandle::Get(), clock));
+  task_runner_->PostTask(FROM_HERE,
+                         base::BindOnce(&Backend::Init,
+                                        base::Unretained(backend_.get())));
+}
+
+XWalkNotificationDispatcher::~XWalkNotificationDispatcher() {}
+
+// |backend_| is deleted on |task_runner_| after the tasks posted below have
+// run, hence base::Unretained().
+
+void XWalkNotificationDispatcher::Show(const std::string& notification_id,
+                                       const GURL& origin,
+                                       const std::string& tag,
+                                       const base::string16& title,
+                                       const base::string16& body) {
+  Request request{notification_id, origin.GetOrigin(),
+                  base::UTF16ToUTF8(title), base::UTF16ToUTF8(body)};
+  std::string key = CoalescingKey(notification_id, request.origin, tag);
+  task_runner_->PostTask(
+      FROM_HERE,
+      base::BindOnce(&Backend::Enqueue, base::Unretained(backend_.get()),
+                     std::move(key), std::move(request)));
+}
+
+void XWalkNotificationDispatcher::Close(const std::string& notification_id) {
+  task_runner_->PostTask(FROM_HERE,
+                         base::BindOnce(&Backend::Close,
+                                        base::Unretained(backend_.get()),
+                                        notification_id));
+}
+
+void XWalkNotificationDispatcher::GetStats(
+    const GURL& origin,
+    base::OnceCallback<void(const Stats&)> callback) {
+  base::PostTaskAndReplyWithResult(
+      task_runner_.get(), FROM_HERE,
+      base::BindOnce(&Backend::GetStats, base::Unretained(backend_.get()),
+                     origin.GetOrigin()),
+      std::move(callback));
+}
+
+void XWalkNotificationDispatcher::FlushForTesting(base::OnceClosure done) {
+  task_runner_->PostTaskAndReply(
+      FROM_HERE,
+      base::BindOnce(&Backend::Flush, base::Unretained(backend_.get())),
+      std::move(done));
+}
+
+void XWalkNotificationDispatcher::NotificationShown(
+    const std::string& notification_id) {
+  client_->OnNotificationShown(notification_id);
+}
+
+void XWalkNotificationDispatcher::NotificationClosed(
+    const std::string& notification_id,
+    bool by_user) {
+  client_->OnNotificationClosed(notification_id, by_user);
+}
+
+}  // namespace xwalk
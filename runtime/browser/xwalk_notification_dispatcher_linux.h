@@ -0,0 +1,100 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_BROWSER_XWALK_NOTIFICATION_DISPATCHER_LINUX_H_
+#define XWALK_RUNTIME_BROWSER_XWALK_NOTIFICATION_DISPATCHER_LINUX_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "base/callback.h"
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "base/sequenced_task_runner.h"
+#include "base/strings/string16.h"
+#include "base/time/time.h"
+#include "url/gurl.h"
+
+namespace base {
+class TickClock;
+}
+
+namespace xwalk {
+
+// Talks to the desktop notification daemon through libnotify on a sequence
+// of its own, every libnotify call being a synchronous D-Bus round trip.
+//
+// Requests queued while the sequence is busy are coalesced: an update to a
+// notification that has not reached the daemon yet replaces it, and only
+// the latest state for a tag is sent. Each origin gets a token bucket of
+// kMaxBurst notifications, refilled one per kRefillIntervalMs; what does not
+// fit is dropped. Notifications that are dropped, replaced before or while
+// shown, or refused by the daemon are reported closed, so their pages stop
+// waiting for them.
+//
+// Lives on the sequence it is created on, where |client| is called back.
+class XWalkNotificationDispatcher {
+ public:
+  class Client {
+   public:
+    virtual void OnNotificationShown(const std::string& notification_id) = 0;
+    // |by_user| is true when the notification was dismissed by the user,
+    // which is what clicking it does with most daemons.
+    virtual void OnNotificationClosed(const std::string& notification_id,
+                                      bool by_user) = 0;
+
+   protected:
+    virtual ~Client() {}
+  };
+
+  struct Stats {
+    int64_t delivered = 0;
+    int64_t coalesced = 0;
+    int64_t dropped = 0;
+  };
+
+  static const int kMaxBurst;
+  static const int kRefillIntervalMs;
+
+  // |clock| must outlive the dispatcher.
+  XWalkNotificationDispatcher(
+      Client* client,
+      scoped_refptr<base::SequencedTaskRunner> task_runner,
+      const base::TickClock* clock);
+  ~XWalkNotificationDispatcher();
+
+  // Shows the notification, or updates the one already shown for |tag| by
+  // |origin|.
+  void Show(const std::string& notification_id,
+            const GURL& origin,
+            const std::string& tag,
+            const base::string16& title,
+            const base::string16& body);
+  void Close(const std::string& notification_id);
+
+  void GetStats(const GURL& origin,
+                base::OnceCallback<void(const Stats&)> callback);
+
+  // Sends what is queued and runs |done| once it has been.
+  void FlushForTesting(base::OnceClosure done);
+
+ private:
+  class Backend;
+
+  void NotificationShown(const std::string& notification_id);
+  void NotificationClosed(const std::string& notification_id, bool by_user);
+
+  Client* client_;
+  scoped_refptr<base::SequencedTaskRunner> task_runner_;
+  std::unique_ptr<Backend, base::OnTaskRunnerDeleter> backend_;
+  base::WeakPtrFactory<XWalkNotificationDispatcher> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkNotificationDispatcher);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_BROWSER_XWALK_NOTIFICATION_DISPATCHER_LINUX_H_
@@ -0,0 +1,466 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/xwalk_notification_dispatcher_linux.h"
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/environment.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/macros.h"
+#include "base/process/launch.h"
+#include "base/process/process.h"
+#include "base/run_loop.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/utf_string_conversions.h"
+#include "base/synchronization/lock.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/task/post_task.h"
+#include "base/test/simple_test_tick_clock.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/thread.h"
+#include "base/time/default_tick_clock.h"
+#include "base/time/time.h"
+#include "content/public/test/test_browser_thread_bundle.h"
+#include "dbus/bus.h"
+#include "dbus/exported_object.h"
+#include "dbus/message.h"
+#include "dbus/object_path.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+
+namespace xwalk {
+
+namespace {
+
+const char kServiceName[] = "org.freedesktop.Notifications";
+const char kObjectPath[] = "/org/freedesktop/Notifications";
+const char kInterface[] = "org.freedesktop.Notifications";
+const char kBusAddressVariable[] = "DBUS_SESSION_BUS_ADDRESS";
+const int kNotificationCount = 1000;
+
+// Implements as much of the Desktop Notifications spec as libnotify uses,
+// answering on a thread of its own like a real daemon would.
+class FakeNotificationDaemon {
+ public:
+  FakeNotificationDaemon() : thread_("FakeNotificationDaemon") {}
+  ~FakeNotificationDaemon() { Stop(); }
+
+  bool Start(const std::string& address) {
+    if (!thread_.StartWithOptions(
+            base::Thread::Options(base::MessageLoop::TYPE_IO, 0))) {
+      return false;
+    }
+    bool started = false;
+    base::WaitableEvent done;
+    thread_.task_runner()->PostTask(
+        FROM_HERE, base::BindOnce(&FakeNotificationDaemon::StartOnThread,
+                                  base::Unretained(this), address, &started,
+                                  &done));
+    done.Wait();
+    return started;
+  }
+
+  void Stop() {
+    if (!thread_.IsRunning())
+      return;
+    thread_.task_runner()->PostTask(
+        FROM_HERE, base::BindOnce(&dbus::Bus::ShutdownAndBlock, bus_));
+    thread_.Stop();
+    bus_ = nullptr;
+  }
+
+  int notify_count() const {
+    base::AutoLock lock(lock_);
+    return notify_count_;
+  }
+
+  std::string last_summary() const {
+    base::AutoLock lock(lock_);
+    return last_summary_;
+  }
+
+  void Reset() {
+    base::AutoLock lock(lock_);
+    notify_count_ = 0;
+    last_summary_.clear();
+  }
+
+ private:
+  void StartOnThread(const std::string& address,
+                     bool* started,
+                     base::WaitableEvent* done) {
+    dbus::Bus::Options options;
+    options.bus_type = dbus::Bus::CUSTOM_ADDRESS;
+    options.address = address;
+    options.connection_type = dbus::Bus::PRIVATE;
+    bus_ = new dbus::Bus(options);
+
+    dbus::ExportedObject* object =
+        bus_->GetExportedObject(dbus::ObjectPath(kObjectPath));
+    *started =
+        object->ExportMethodAndBlock(
+            kInterface, "Notify",
+            base::BindRepeating(&FakeNotificationDaemon::Notify,
+                                base::Unretained(this))) &&
+        object->ExportMethodAndBlock(
+            kInterface, "CloseNotification",
+            base::BindRepeating(&FakeNotificationDaemon::CloseNotification,
+                                base::Unretained(this))) &&
+        object->ExportMethodAndBlock(
+            kInterface, "GetCapabilities",
+            base::BindRepeating(&FakeNotificationDaemon::GetCapabilities,
+                                base::Unretained(this))) &&
+        object->ExportMethodAndBlock(
+            kInterface, "GetServerInformation",
+            base::BindRepeating(&FakeNotificationDaemon::GetServerInformation,
+                                base::Unretained(this))) &&
+        bus_->RequestOwnershipAndBlock(kServiceName,
+                                       dbus::Bus::REQUIRE_PRIMARY);
+    done->Signal();
+  }
+
+  void Notify(dbus::MethodCall* method_call,
+              dbus::ExportedObject::ResponseSender sender) {
+    dbus::MessageReader reader(method_call);
+    std::string app_name;
+    uint32_t replaces_id = 0;
+    std::string icon;
+    std::string summary;
+    reader.PopString(&app_name);
+    reader.PopUint32(&replaces_id);
+    reader.PopString(&icon);
+    reader.PopString(&summary);
+
+    uint32_t id = replaces_id;
+    {
+      base::AutoLock lock(lock_);
+      ++notify_count_;
+      last_summary_ = summary;
+      if (!id)
+        id = ++last_id_;
+    }
+    std::unique_ptr<dbus::Response> response =
+        dbus::Response::FromMethodCall(method_call);
+    dbus::MessageWriter(response.get()).AppendUint32(id);
+    std::move(sender).Run(std::move(response));
+  }
+
+  void CloseNotification(dbus::MethodCall* method_call,
+                         dbus::ExportedObject::ResponseSender sender) {
+    std::move(sender).Run(dbus::Response::FromMethodCall(method_call));
+  }
+
+  void GetCapabilities(dbus::MethodCall* method_call,
+                       dbus::ExportedObject::ResponseSender sender) {
+    std::unique_ptr<dbus::Response> response =
+        dbus::Response::FromMethodCall(method_call);
+    dbus::MessageWriter(response.get()).AppendArrayOfStrings({"body"});
+    std::move(sender).Run(std::move(response));
+  }
+
+  void GetServerInformation(dbus::MethodCall* method_call,
+                            dbus::ExportedObject::ResponseSender sender) {
+    std::unique_ptr<dbus::Response> response =
+        dbus::Response::FromMethodCall(method_call);
+    dbus::MessageWriter writer(response.get());
+    writer.AppendString("fake");
+    writer.AppendString("xwalk");
+    writer.AppendString("1.0");
+    writer.AppendString("1.2");
+    std::move(sender).Run(std::move(response));
+  }
+
+  base::Thread thread_;
+  scoped_refptr<dbus::Bus> bus_;
+
+  mutable base::Lock lock_;
+  int notify_count_ = 0;
+  uint32_t last_id_ = 0;
+  std::string last_summary_;
+
+  DISALLOW_COPY_AND_ASSIGN(FakeNotificationDaemon);
+};
+
+class FakeClient : public XWalkNotificationDispatcher::Client {
+ public:
+  FakeClient() {}
+  ~FakeClient() override {}
+
+  void OnNotificationShown(const std::string& notification_id) override {
+    shown_.push_back(notification_id);
+  }
+
+  void OnNotificationClosed(const std::string& notification_id,
+                            bool by_user) override {
+    EXPECT_FALSE(by_user);
+    closed_.push_back(notification_id);
+  }
+
+  const std::vector<std::string>& shown() const { return shown_; }
+  const std::vector<std::string>& closed() const { return closed_; }
+
+ private:
+  std::vector<std::string> shown_;
+  std::vector<std::string> closed_;
+
+  DISALLOW_COPY_AND_ASSIGN(FakeClient);
+};
+
+void StoreStats(XWalkNotificationDispatcher::Stats* out,
+                base::OnceClosure done,
+                const XWalkNotificationDispatcher::Stats& stats) {
+  *out = stats;
+  std::move(done).Run();
+}
+
+// libnotify keeps talking to the session bus it first found, so a single
+// private bus and daemon serve every test of the process.
+base::ScopedTempDir* g_bus_dir = nullptr;
+base::Process* g_bus_process = nullptr;
+FakeNotificationDaemon* g_daemon = nullptr;
+
+class XWalkNotificationDispatcherTest : public testing::Test {
+ public:
+  static void SetUpTestCase() {
+    g_bus_dir = new base::ScopedTempDir;
+    ASSERT_TRUE(g_bus_dir->CreateUniqueTempDir());
+    const base::FilePath socket = g_bus_dir->GetPath().AppendASCII("bus");
+    const std::string address = "unix:path=" + socket.value();
+
+    g_bus_process = new base::Process(base::LaunchProcess(
+        {"dbus-daemon", "--session", "--nofork", "--nosyslog",
+         "--address=" + address},
+        base::LaunchOptions()));
+    ASSERT_TRUE(g_bus_process->IsValid()) << "dbus-daemon is required";
+    for (int i = 0; i < 100 && !base::PathExists(socket); ++i)
+      base::PlatformThread::Sleep(base::TimeDelta::FromMilliseconds(50));
+    ASSERT_TRUE(base::PathExists(socket));
+
+    base::Environment::Create()->SetVar(kBusAddressVariable, address);
+    g_daemon = new FakeNotificationDaemon;
+    ASSERT_TRUE(g_daemon->Start(address));
+  }
+
+  static void TearDownTestCase() {
+    delete g_daemon;
+    g_daemon = nullptr;
+    if (g_bus_process) {
+      g_bus_process->Terminate(0, true);
+      delete g_bus_process;
+      g_bus_process = nullptr;
+    }
+    delete g_bus_dir;
+    g_bus_dir = nullptr;
+    base::Environment::Create()->UnSetVar(kBusAddressVariable);
+  }
+
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(g_daemon);
+    g_daemon->Reset();
+    task_runner_ = base::CreateSequencedTaskRunnerWithTraits(
+        {base::MayBlock(), base::WithBaseSyncPrimitives()});
+  }
+
+  std::unique_ptr<XWalkNotificationDispatcher> CreateDispatcher(
+      const base::TickClock* clock) {
+    return std::make_unique<XWalkNotificationDispatcher>(&client_,
+                                                         task_runner_, clock);
+  }
+
+  void Flush(XWalkNotificationDispatcher* dispatcher) {
+    base::RunLoop run_loop;
+    dispatcher->FlushForTesting(run_loop.QuitClosure());
+    run_loop.Run();
+  }
+
+  XWalkNotificationDispatcher::Stats GetStats(
+      XWalkNotificationDispatcher* dispatcher,
+      const GURL& origin) {
+    XWalkNotificationDispatcher::Stats stats;
+    base::RunLoop run_loop;
+    dispatcher->GetStats(origin, base::BindOnce(&StoreStats, &stats,
+                                                run_loop.QuitClosure()));
+    run_loop.Run();
+    return stats;
+  }
+
+  // Holds the dispatcher sequence until the returned event is signaled.
+  std::unique_ptr<base::WaitableEvent> Block() {
+    auto event = std::make_unique<base::WaitableEvent>();
+    task_runner_->PostTask(FROM_HERE,
+                           base::BindOnce(&base::WaitableEvent::Wait,
+                                          base::Unretained(event.get())));
+    return event;
+  }
+
+  content::TestBrowserThreadBundle thread_bundle_;
+  scoped_refptr<base::SequencedTaskRunner> task_runner_;
+  FakeClient client_;
+};
+
+}  // namespace
+
+TEST_F(XWalkNotificationDispatcherTest, ShowsNotifications) {
+  base::SimpleTestTickClock clock;
+  std::unique_ptr<XWalkNotificationDispatcher> dispatcher =
+      CreateDispatcher(&clock);
+  const GURL origin("https://chat.example.com/");
+
+  for (int i = 0; i < 3; ++i) {
+    dispatcher->Show("n" + base::NumberToString(i), origin, std::string(),
+                     base::ASCIIToUTF16("Message"), base::string16());
+  }
+  Flush(dispatcher.get());
+
+  EXPECT_EQ(3, g_daemon->notify_count());
+  ASSERT_EQ(3u, client_.shown().size());
+  EXPECT_EQ("n0", client_.shown()[0]);
+  EXPECT_EQ("n2", client_.shown()[2]);
+  XWalkNotificationDispatcher::Stats stats = GetStats(dispatcher.get(),
+                                                      origin);
+  EXPECT_EQ(3, stats.delivered);
+  EXPECT_EQ(0, stats.coalesced);
+  EXPECT_EQ(0, stats.dropped);
+}
+
+TEST_F(XWalkNotificationDispatcherTest, CoalescesUpdatesToTag) {
+  base::SimpleTestTickClock clock;
+  std::unique_ptr<XWalkNotificationDispatcher> dispatcher =
+      CreateDispatcher(&clock);
+  const GURL origin("https://chat.example.com/");
+
+  // A download progress notification, updated while the daemon is busy.
+  std::unique_ptr<base::WaitableEvent> blocked = Block();
+  for (int i = 1; i <= 100; ++i) {
+    dispatcher->Show("n" + base::NumberToString(i), origin, "progress",
+                     base::ASCIIToUTF16(base::NumberToString(i) + "%"),
+                     base::string16());
+  }
+  blocked->Signal();
+  Flush(dispatcher.get());
+
+  EXPECT_EQ(1, g_daemon->notify_count());
+  EXPECT_EQ("100%", g_daemon->last_summary());
+  ASSERT_EQ(1u, client_.shown().size());
+  EXPECT_EQ("n100", client_.shown()[0]);
+  XWalkNotificationDispatcher::Stats stats = GetStats(dispatcher.get(),
+                                                      origin);
+  EXPECT_EQ(1, stats.delivered);
+  EXPECT_EQ(99, stats.coalesced);
+  // The replaced ones are closed for their pages.
+  ASSERT_EQ(99u, client_.closed().size());
+  EXPECT_EQ("n1", client_.closed()[0]);
+  EXPECT_EQ("n99", client_.closed()[98]);
+
+  // Once shown, a later update goes to the same notification.
+  dispatcher->Show("n101", origin, "progress", base::ASCIIToUTF16("done"),
+                   base::string16());
+  Flush(dispatcher.get());
+  EXPECT_EQ(2, g_daemon->notify_count());
+  EXPECT_EQ("done", g_daemon->last_summary());
+  ASSERT_EQ(100u, client_.closed().size());
+  EXPECT_EQ("n100", client_.closed()[99]);
+}
+
+TEST_F(XWalkNotificationDispatcherTest, RateLimitsPerOrigin) {
+  base::SimpleTestTickClock clock;
+  clock.SetNowTicks(base::TimeTicks::Now());
+  std::unique_ptr<XWalkNotificationDispatcher> dispatcher =
+      CreateDispatcher(&clock);
+  const GURL spammer("https://spam.example.com/");
+  const GURL other("https://chat.example.com/");
+  const int kExtra = 5;
+
+  for (int i = 0; i < XWalkNotificationDispatcher::kMaxBurst + kExtra; ++i) {
+    dispatcher->Show("s" + base::NumberToString(i), spammer, std::string(),
+                     base::ASCIIToUTF16("Buy now"), base::string16());
+  }
+  dispatcher->Show("o", other, std::string(), base::ASCIIToUTF16("Hello"),
+                   base::string16());
+  Flush(dispatcher.get());
+
+  XWalkNotificationDispatcher::Stats stats = GetStats(dispatcher.get(),
+                                                      spammer);
+  EXPECT_EQ(XWalkNotificationDispatcher::kMaxBurst, stats.delivered);
+  EXPECT_EQ(kExtra, stats.dropped);
+  EXPECT_EQ(1, GetStats(dispatcher.get(), other).delivered);
+  EXPECT_EQ(XWalkNotificationDispatcher::kMaxBurst + 1,
+            g_daemon->notify_count());
+  // The dropped ones are closed for their pages.
+  ASSERT_EQ(static_cast<size_t>(kExtra), client_.closed().size());
+  EXPECT_EQ("s" + base::NumberToString(XWalkNotificationDispatcher::kMaxBurst),
+            client_.closed()[0]);
+
+  // Two intervals later two more fit.
+  clock.Advance(base::TimeDelta::FromMilliseconds(
+      XWalkNotificationDispatcher::kRefillIntervalMs * 2));
+  for (int i = 0; i < 3; ++i) {
+    dispatcher->Show("t" + base::NumberToString(i), spammer, std::string(),
+                     base::ASCIIToUTF16("Buy now"), base::string16());
+  }
+  Flush(dispatcher.get());
+  stats = GetStats(dispatcher.get(), spammer);
+  EXPECT_EQ(XWalkNotificationDispatcher::kMaxBurst + 2, stats.delivered);
+  EXPECT_EQ(kExtra + 1, stats.dropped);
+}
+
+// The UI thread only queues the requests, the D-Bus round trips happen on
+// the dispatcher sequence.
+TEST_F(XWalkNotificationDispatcherTest, UIThreadCost) {
+  std::unique_ptr<XWalkNotificationDispatcher> dispatcher =
+      CreateDispatcher(base::DefaultTickClock::GetInstance());
+  const GURL origin("https://chat.example.com/");
+
+  const base::TimeTicks start = base::TimeTicks::Now();
+  for (int i = 0; i < kNotificationCount; ++i) {
+    // Mostly updates to a handful of conversations, a few one-offs.
+    const std::string tag =
+        i % 50 ? "conversation" + base::NumberToString(i % 10) : std::string();
+    dispatcher->Show("n" + base::NumberToString(i), origin, tag,
+                     base::ASCIIToUTF16("Message " + base::NumberToString(i)),
+                     base::ASCIIToUTF16("Body"));
+  }
+  const base::TimeDelta ui_time = base::TimeTicks::Now() - start;
+  Flush(dispatcher.get());
+  const base::TimeDelta total = base::TimeTicks::Now() - start;
+
+  XWalkNotificationDispatcher::Stats stats = GetStats(dispatcher.get(),
+                                                      origin);
+  EXPECT_EQ(kNotificationCount,
+            stats.delivered + stats.coalesced + stats.dropped);
+  EXPECT_EQ(stats.delivered, g_daemon->notify_count());
+  EXPECT_EQ(static_cast<size_t>(stats.delivered), client_.shown().size());
+  // Every notification was either shown or closed, some both.
+  EXPECT_GE(client_.shown().size() + client_.closed().size(),
+            static_cast<size_t>(kNotificationCount));
+  // The burst, plus what was refilled while the test ran.
+  EXPECT_LE(stats.delivered,
+            XWalkNotificationDispatcher::kMaxBurst + 1 +
+                total.InMilliseconds() /
+                    XWalkNotificationDispatcher::kRefillIntervalMs);
+
+  XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+      "notification_dispatch", "_ui_thread",
+      {ui_time.InMicrosecondsF() / kNotificationCount}));
+  XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+      "notification_dispatch", "_total", {total.InMicrosecondsF()}));
+  XWalkBenchmark::ReportValue("notification_dispatch", "_delivered", "count",
+                              stats.delivered);
+  XWalkBenchmark::ReportValue("notification_dispatch", "_coalesced", "count",
+                              stats.coalesced);
+  XWalkBenchmark::ReportValue("notification_dispatch", "_dropped", "count",
+                              stats.dropped);
+}
+
+}  // namespace xwalk
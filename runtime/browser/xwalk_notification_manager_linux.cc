@@ -4,140 +4,62 @@
 
 #include "xwalk/runtime/browser/xwalk_notification_manager_linux.h"
 
-#include "base/strings/utf_string_conversions.h"
+#include "base/bind_helpers.h"
+#include "base/task/post_task.h"
+#include "base/time/default_tick_clock.h"
 #include "content/public/browser/browser_thread.h"
-#include "content/public/browser/desktop_notification_delegate.h"
-#include "content/public/common/platform_notification_data.h"
+#include "content/public/browser/notification_event_dispatcher.h"
+#include "third_party/blink/public/common/notifications/platform_notification_data.h"
 #include "url/gurl.h"
 
-namespace {
-
 using content::BrowserThread;
-using xwalk::XWalkNotificationManager;
-
-// Defined by 'org.freedesktop.Notifications'.
-const int g_closed_by_user = 2;
-
-void NotificationClosedCallback(NotifyNotification* notification,
-                                gpointer user_data) {
-  XWalkNotificationManager* service =
-      static_cast<XWalkNotificationManager*>(user_data);
-
-  gint reason = notify_notification_get_closed_reason(notification);
-
-  bool by_user = (reason == g_closed_by_user);
-  if (by_user)
-    service->NotificationClicked(notification);
-  service->NotificationClosed(notification);
-  g_signal_handler_disconnect(notification,
-                              service->GetHandler(notification));
-}
-
-void CancelDesktopNotificationCallback(
-    XWalkNotificationManager* service,
-    NotifyNotification* notification) {
-  g_signal_handler_disconnect(notification,
-                              service->GetHandler(notification));
-  notify_notification_close(notification, nullptr);
-}
-
-}  // namespace
+using content::NotificationEventDispatcher;
 
 namespace xwalk {
 
-XWalkNotificationManager::XWalkNotificationManager() {
-  initialized_ = notify_init("xwalk");
-}
-
-XWalkNotificationManager::~XWalkNotificationManager() {
-  if (initialized_)
-    notify_uninit();
-}
+XWalkNotificationManager::XWalkNotificationManager()
+    : dispatcher_(this,
+                  base::CreateSequencedTaskRunnerWithTraits(
+                      {base::MayBlock(), base::TaskPriority::USER_VISIBLE,
+                       base::TaskShutdownBehavior::SKIP_ON_SHUTDOWN}),
+                  base::DefaultTickClock::GetInstance()) {}
 
-gulong XWalkNotificationManager::GetHandler(
-    NotifyNotification* notification) const {
-  auto i = notifications_handler_map_.find(notification);
-  return i != notifications_handler_map_.end() ? i->second : 0;
-}
+XWalkNotificationManager::~XWalkNotificationManager() {}
 
 void XWalkNotificationManager::ShowDesktopNotification(
-    content::BrowserContext* browser_context,
+    const std::string& notification_id,
     const GURL& origin,
-    const content::PlatformNotificationData& notification_data,
-    std::unique_ptr<content::DesktopNotificationDelegate> delegate,
-    base::Closure* cancel_callback) {
-  if (!initialized_)
-    return;
-
-  NotifyNotification* notification = nullptr;
-
-  if (!notification_data.tag.empty() &&
-      notifications_replace_map_.find(notification_data.tag) !=
-          notifications_replace_map_.end()) {
-    notification = notifications_replace_map_[notification_data.tag];
-    notify_notification_update(notification,
-        base::UTF16ToUTF8(notification_data.title).c_str(),
-        base::UTF16ToUTF8(notification_data.body).c_str(),
-        nullptr);
-  } else {
-    notification = notify_notification_new(
-        base::UTF16ToUTF8(notification_data.title).c_str(),
-        base::UTF16ToUTF8(notification_data.body).c_str(),
-        nullptr);
-
-    notifications_map_.set(reinterpret_cast<int64_t>(notification),
-                           std::move(delegate));
-    if (!notification_data.tag.empty()) {
-      notifications_replace_map_[notification_data.tag] = notification;
-    }
-
-    notifications_handler_map_[notification] =
-        g_signal_connect(G_OBJECT(notification),
-                         "closed",
-                         G_CALLBACK(NotificationClosedCallback),
-                         this);
-    if (cancel_callback)
-      *cancel_callback = base::Bind(&CancelDesktopNotificationCallback,
-                                    this,
-                                    notification);
-    content::BrowserThread::PostTask(
-        content::BrowserThread::UI,
-        FROM_HERE,
-        base::Bind(&XWalkNotificationManager::NotificationDisplayed,
-        base::Unretained(this),
-        notification));
-  }
-
-  notify_notification_show(notification, nullptr);
+    const blink::PlatformNotificationData& notification_data) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  dispatcher_.Show(notification_id, origin, notification_data.tag,
+                   notification_data.title, notification_data.body);
 }
 
-void XWalkNotificationManager::NotificationDisplayed(
-    NotifyNotification* notification) {
-  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
-  content::DesktopNotificationDelegate* notification_delegate =
-      notifications_map_.get(reinterpret_cast<int64_t>(notification));
-  if (notification_delegate)
-    notification_delegate->NotificationDisplayed();
+void XWalkNotificationManager::CloseDesktopNotification(
+    const std::string& notification_id) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  dispatcher_.Close(notification_id);
 }
 
-void XWalkNotificationManager::NotificationClicked(
-    NotifyNotification* notification) {
-  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
-  content::DesktopNotificationDelegate* notification_delegate =
-      notifications_map_.get(reinterpret_cast<int64_t>(notification));
-  if (notification_delegate) {
-    notification_delegate->NotificationClick();
-  }
+void XWalkNotificationManager::OnNotificationShown(
+    const std::string& notification_id) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  NotificationEventDispatcher::GetInstance()->DispatchNonPersistentShowEvent(
+      notification_id);
 }
 
-void XWalkNotificationManager::NotificationClosed(
-    NotifyNotification* notification) {
-  DCHECK(BrowserThread::CurrentlyOn(BrowserThread::UI));
-  std::unique_ptr<content::DesktopNotificationDelegate> notification_delegate =
-    notifications_map_.take_and_erase(reinterpret_cast<int64_t>(notification));
-  if (notification_delegate) {
-    notification_delegate->NotificationClosed();
+void XWalkNotificationManager::OnNotificationClosed(
+    const std::string& notification_id,
+    bool by_user) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+  NotificationEventDispatcher* dispatcher =
+      NotificationEventDispatcher::GetInstance();
+  if (by_user) {
+    dispatcher->DispatchNonPersistentClickEvent(notification_id,
+                                                base::DoNothing());
   }
+  dispatcher->DispatchNonPersistentCloseEvent(notification_id,
+                                              base::DoNothing());
 }
 
 }  // namespace xwalk
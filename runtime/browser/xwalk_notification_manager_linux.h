@@ -5,55 +5,42 @@
 #ifndef XWALK_RUNTIME_BROWSER_XWALK_NOTIFICATION_MANAGER_LINUX_H_
 #define XWALK_RUNTIME_BROWSER_XWALK_NOTIFICATION_MANAGER_LINUX_H_
 
-#include <libnotify/notification.h>
-#include <libnotify/notify.h>
-
-#include <map>
 #include <string>
 
-#include "base/callback.h"
-#include "base/containers/scoped_ptr_hash_map.h"
-#include "base/strings/string16.h"
+#include "base/macros.h"
+#include "xwalk/runtime/browser/xwalk_notification_dispatcher_linux.h"
 
 class GURL;
 
-namespace content {
-class BrowserContext;
-class DesktopNotificationDelegate;
-class RenderFrameHost;
+namespace blink {
 struct PlatformNotificationData;
-}  // namespace content
+}  // namespace blink
 
 namespace xwalk {
 
-class XWalkNotificationManager {
+// Shows non-persistent Web Notifications on the desktop and reports their
+// events back to the pages. The daemon is only talked to from the
+// dispatcher sequence, never from the UI thread.
+class XWalkNotificationManager : public XWalkNotificationDispatcher::Client {
  public:
   XWalkNotificationManager();
-  ~XWalkNotificationManager();
-
-  gulong GetHandler(NotifyNotification* notification) const;
+  ~XWalkNotificationManager() override;
 
-  // Show a desktop notification. If |cancel_callback| is non-null, it's set to
-  // a callback which can be used to cancel the notification.
   void ShowDesktopNotification(
-      content::BrowserContext* browser_context,
+      const std::string& notification_id,
       const GURL& origin,
-      const content::PlatformNotificationData& notification_data,
-      std::unique_ptr<content::DesktopNotificationDelegate> delegate,
-      base::Closure* cancel_callback);
-
-  void NotificationDisplayed(NotifyNotification* notification);
-  void NotificationClicked(NotifyNotification* notification);
-  void NotificationClosed(NotifyNotification* notification);
+      const blink::PlatformNotificationData& notification_data);
+  void CloseDesktopNotification(const std::string& notification_id);
 
  private:
-  base::ScopedPtrHashMap<int64_t,
-                         std::unique_ptr<content::DesktopNotificationDelegate>>
-      notifications_map_;
-  std::map<std::string, NotifyNotification*> notifications_replace_map_;
-  std::map<NotifyNotification*, gulong> notifications_handler_map_;
+  // XWalkNotificationDispatcher::Client implementation.
+  void OnNotificationShown(const std::string& notification_id) override;
+  void OnNotificationClosed(const std::string& notification_id,
+                            bool by_user) override;
+
+  XWalkNotificationDispatcher dispatcher_;
 
-  bool initialized_;
+  DISALLOW_COPY_AND_ASSIGN(XWalkNotificationManager);
 };
 
 }  // namespace xwalk
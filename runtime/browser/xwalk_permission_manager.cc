@@ -129,6 +129,21 @@ class LastRequestResultCache {
     pmi_result_cache_.erase(key);
   }
 
+  void ClearMatching(const base::RepeatingCallback<bool(const GURL&)>& filter) {
+    if (filter.is_null()) {
+      pmi_result_cache_.clear();
+      return;
+    }
+    for (auto it = pmi_result_cache_.begin(); it != pmi_result_cache_.end();) {
+      // Keys start with the requesting origin, origins have no commas.
+      const GURL requesting_origin(it->first.substr(0, it->first.find(',')));
+      if (filter.Run(requesting_origin))
+        it = pmi_result_cache_.erase(it);
+      else
+        ++it;
+    }
+  }
+
  private:
   // Returns a concatenation of the origins to be used as the index.
   // Returns the empty string if either origin is invalid or empty.
@@ -443,6 +458,11 @@ void XWalkPermissionManager::ResetPermission(
   result_cache_->ClearResult(permission, requesting_origin, embedding_origin);
 }
 
+void XWalkPermissionManager::ClearDecisions(
+    const base::RepeatingCallback<bool(const GURL&)>& filter) {
+  result_cache_->ClearMatching(filter);
+}
+
 PermissionStatus XWalkPermissionManager::GetPermissionStatus(content::PermissionType permission,
                                                              const GURL& requesting_origin,
                                                              const GURL& embedding_origin) {
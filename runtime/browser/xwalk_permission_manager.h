@@ -57,6 +57,10 @@ class XWalkPermissionManager : public content::PermissionControllerDelegate {
                                       base::RepeatingCallback<void(blink::mojom::PermissionStatus)> callback) override;
   void UnsubscribePermissionStatusChange(int subscription_id) override;
 
+  // Forgets the decisions remembered for requesting origins |filter|
+  // matches, or all of them if |filter| is null.
+  void ClearDecisions(const base::RepeatingCallback<bool(const GURL&)>& filter);
+
  protected:
   void CancelPermissionRequest(int request_id);
   void CancelPermissionRequests();
@@ -111,11 +111,7 @@ void XWalkPlatformNotificationService::DisplayNotification(
   if (!notification_manager_linux_)
     notification_manager_linux_.reset(new XWalkNotificationManager());
   notification_manager_linux_->ShowDesktopNotification(
-      browser_context,
-      origin,
-      notification_data,
-      std::move(delegate),
-      cancel_callback);
+      notification_id, origin, notification_data);
 #elif defined(OS_WIN)
   const base::win::OSInfo* os_info = base::win::OSInfo::GetInstance();
   if (os_info->version() < base::win::VERSION_WIN8)
@@ -135,8 +131,13 @@ void XWalkPlatformNotificationService::DisplayNotification(
 }
 
 void XWalkPlatformNotificationService::CloseNotification(const std::string& notification_id) {
+#if defined(OS_LINUX) && defined(USE_LIBNOTIFY)
+  if (notification_manager_linux_)
+    notification_manager_linux_->CloseDesktopNotification(notification_id);
+#else
   // TODO(iotto) : Implement
   LOG(ERROR) << "iotto " << __func__ << " FIX/IMPLEMENT";
+#endif
 }
 
 void XWalkPlatformNotificationService::GetDisplayedNotifications(
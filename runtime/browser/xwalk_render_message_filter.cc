@@ -8,6 +8,7 @@
 #if defined(OS_ANDROID)
 #include "xwalk/runtime/browser/android/xwalk_contents_client_bridge.h"
 #include "xwalk/runtime/browser/android/xwalk_contents_io_thread_client.h"
+#include "xwalk/runtime/browser/devtools/xwalk_ipc_stats_collector.h"
 #include "xwalk/runtime/common/android/xwalk_render_view_messages.h"
 #include "meta_logging.h"
 #endif
@@ -32,8 +33,8 @@ XWalkRenderMessageFilter::XWalkRenderMessageFilter(int process_id)
 void XWalkRenderMessageFilter::OverrideThreadForMessage(
                                                         const IPC::Message& message,
                                                         BrowserThread::ID* thread) {
-  if (message.type() == XWalkViewHostMsg_ShouldOverrideUrlLoading::ID ||
-      message.type() == XWalkViewHostMsg_WillSendRequest::ID) {
+  if (message.type() == XWalkViewHostMsg_WillSendRequest::ID ||
+      message.type() == XWalkViewHostMsg_IPCStats::ID) {
     *thread = BrowserThread::UI;
   }
 }
@@ -46,8 +47,7 @@ bool XWalkRenderMessageFilter::OnMessageReceived(
     IPC_MESSAGE_HANDLER(ViewMsg_OpenLinkExternal, OnOpenLinkExternal)
 #if defined(OS_ANDROID)
     IPC_MESSAGE_HANDLER(XWalkViewHostMsg_SubFrameCreated, OnSubFrameCreated)
-    IPC_MESSAGE_HANDLER(XWalkViewHostMsg_ShouldOverrideUrlLoading,
-                        OnShouldOverrideUrlLoading)
+    IPC_MESSAGE_HANDLER(XWalkViewHostMsg_IPCStats, OnIPCStats)
     IPC_MESSAGE_HANDLER(XWalkViewHostMsg_WillSendRequest,
                         OnWillSendRequest)
 #endif
@@ -70,34 +70,9 @@ void XWalkRenderMessageFilter::OnSubFrameCreated(int parent_render_frame_id,
                                                parent_render_frame_id, child_render_frame_id);
 }
 
-void XWalkRenderMessageFilter::OnShouldOverrideUrlLoading(int render_frame_id,
-                                                          const base::string16& url,
-                                                          bool has_user_gesture,
-                                                          bool is_redirect,
-                                                          bool is_main_frame,
-                                                          bool* ignore_navigation) {
-//  LOG(WARNING) << "iotto " << __func__ << " reinstate";
-//  return;
-  DCHECK_CURRENTLY_ON(BrowserThread::UI);
-  *ignore_navigation = false;
-  XWalkContentsClientBridge* client =
-      XWalkContentsClientBridge::FromRenderFrameID(process_id_, render_frame_id);
-#if TENTA_LOG_ENABLE == 1
-  LOG(INFO) << __func__ << " pocess_id=" << process_id_ << " frame_id="
-               << render_frame_id;
-#endif
-  if (client) {
-    *ignore_navigation = client->ShouldOverrideUrlLoading(
-                                                          url,
-                                                          has_user_gesture, is_redirect,
-                                                          is_main_frame);
-  } else {
-#if TENTA_LOG_ENABLE == 1
-    LOG(WARNING) << "Failed to find the associated render view host pocess_id="
-                    << process_id_ << " frame_id=" << render_frame_id
-                    << " for url: " << url;
-#endif
-  }
+void XWalkRenderMessageFilter::OnIPCStats(int request_id,
+                                          const std::string& json) {
+  XWalkIPCStatsCollector::GetInstance()->OnProcessStats(request_id, json);
 }
 
 void XWalkRenderMessageFilter::OnWillSendRequest(int render_frame_id, const std::string& url,
@@ -6,9 +6,13 @@
 
 #include <string>
 #include <vector>
+#include "base/bind.h"
 #include "base/command_line.h"
+#include "base/files/file_path.h"
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/task/post_task.h"
 #include "content/public/browser/render_process_host.h"
 #include "xwalk/application/browser/application.h"
 #include "xwalk/application/browser/application_service.h"
@@ -24,6 +28,7 @@
 #include "xwalk/runtime/browser/xwalk_browser_main_parts.h"
 //#include "xwalk/runtime/browser/xwalk_component.h"
 #include "xwalk/runtime/browser/xwalk_content_browser_client.h"
+#include "xwalk/runtime/common/xwalk_ipc_accounting.h"
 #include "xwalk/runtime/common/xwalk_runtime_features.h"
 #include "xwalk/runtime/common/xwalk_switches.h"
 
@@ -84,6 +89,15 @@ network::mojom::HttpAuthDynamicParamsPtr XWalkRunner::CreateHttpAuthDynamicParam
 
 void XWalkRunner::PreMainMessageLoopRun() {
   browser_context_.reset(new XWalkBrowserContext);
+
+  base::CommandLine* cmd_line = base::CommandLine::ForCurrentProcess();
+  int ipc_stats_port;
+  if (base::StringToInt(
+          cmd_line->GetSwitchValueASCII(switches::kIPCStatsPort),
+          &ipc_stats_port) &&
+      ipc_stats_port > 0 && ipc_stats_port < 65535) {
+    ipc_stats_server_ = XWalkIPCStatsServer::Start(ipc_stats_port);
+  }
 //  app_extension_bridge_.reset(new XWalkAppExtensionBridge());
 
 //  base::CommandLine* cmd_line = base::CommandLine::ForCurrentProcess();
@@ -102,6 +116,20 @@ void XWalkRunner::PostMainMessageLoopRun() {
 //  extension_service_.reset();
   browser_context_.reset();
   DisableRemoteDebugging();
+  ipc_stats_server_.reset();
+
+  base::FilePath ipc_stats_path =
+      base::CommandLine::ForCurrentProcess()->GetSwitchValuePath(
+          switches::kDumpIPCStats);
+  if (!ipc_stats_path.empty()) {
+    base::PostTaskWithTraits(
+        FROM_HERE,
+        {base::MayBlock(), base::TaskPriority::BEST_EFFORT,
+         base::TaskShutdownBehavior::BLOCK_SHUTDOWN},
+        base::BindOnce(base::IgnoreResult(&XWalkIPCAccounting::WriteToFile),
+                       base::Unretained(XWalkIPCAccounting::GetInstance()),
+                       ipc_stats_path));
+  }
 }
 
 //void XWalkRunner::CreateComponents() {
@@ -10,6 +10,7 @@
 
 #include "base/values.h"
 #include "services/network/network_service.h"
+#include "xwalk/runtime/browser/devtools/xwalk_ipc_stats_server.h"
 #include "xwalk/runtime/browser/storage_component.h"
 
 namespace content {
@@ -150,6 +151,8 @@ class XWalkRunner {
   // Remote debugger server.
   std::unique_ptr<RemoteDebuggingServer> remote_debugging_server_;
 
+  XWalkIPCStatsServer::Ptr ipc_stats_server_;
+
   DISALLOW_COPY_AND_ASSIGN(XWalkRunner);
 };
 
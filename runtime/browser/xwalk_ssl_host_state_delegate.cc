@@ -5,13 +5,49 @@
 
 #include "xwalk/runtime/browser/xwalk_ssl_host_state_delegate.h"
 
-#include "net/base/hash_value.h"
+#include <string.h>
+
+#include <string>
+#include <utility>
+
+#include "base/bind.h"
 #include "base/callback.h"
+#include "base/files/file_util.h"
+#include "base/logging.h"
+#include "base/pickle.h"
+#include "base/sequenced_task_runner.h"
+#include "base/task_runner_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/time/default_clock.h"
+#include "crypto/sha2.h"
+#include "net/base/hash_value.h"
 
 using content::SSLHostStateDelegate;
 
 namespace xwalk {
 
+namespace {
+
+// Bump when the record layout changes, older files are then ignored.
+// Version 1 stored host names.
+const uint32_t kStoreVersion = 2;
+
+int64_t TimeToInt64(base::Time time) {
+  return time.ToDeltaSinceWindowsEpoch().InMicroseconds();
+}
+
+base::Time Int64ToTime(int64_t value) {
+  return base::Time::FromDeltaSinceWindowsEpoch(
+      base::TimeDelta::FromMicroseconds(value));
+}
+
+std::string HashHost(const std::string& host) {
+  const std::string hash = crypto::SHA256HashString(host);
+  return base::HexEncode(hash.data(), hash.size());
+}
+
+}  // namespace
+
 namespace internal {
 
 CertPolicy::CertPolicy() {
@@ -26,30 +62,216 @@ CertPolicy::CertPolicy(const CertPolicy&) = default;
 // allowed cert if the |error| is an exact match to or subset of the errors
 // in the saved CertStatus.
 bool CertPolicy::Check(const net::X509Certificate& cert,
-                       int error) const {
+                       int error,
+                       base::Time now,
+                       bool* expired) const {
   net::SHA256HashValue fingerprint = cert.CalculateChainFingerprint256();
   auto allowed_iter = allowed_.find(fingerprint);
-  if ((allowed_iter != allowed_.end()) && (allowed_iter->second & error) &&
-      ((allowed_iter->second & error) == error)) {
-    return true;
+  if ((allowed_iter != allowed_.end()) && (allowed_iter->second.error & error) &&
+      ((allowed_iter->second.error & error) == error)) {
+    if (allowed_iter->second.expiry > now)
+      return true;
+    if (expired)
+      *expired = true;
   }
   return false;
 }
 
 void CertPolicy::Allow(const net::X509Certificate& cert,
-                       int error) {
+                       int error,
+                       base::Time expiry) {
+  Allow(cert.CalculateChainFingerprint256(), error, expiry);
+}
+
+void CertPolicy::Allow(const net::SHA256HashValue& fingerprint,
+                       int error,
+                       base::Time expiry) {
   // If this same cert had already been saved with a different error status,
   // this will replace it with the new error status.
-  net::SHA256HashValue fingerprint = cert.CalculateChainFingerprint256();
-  allowed_[fingerprint] = error;
+  allowed_[fingerprint] = {error, expiry};
+}
+
+void CertPolicy::RemoveExpired(base::Time now) {
+  for (auto it = allowed_.begin(); it != allowed_.end();) {
+    if (it->second.expiry <= now)
+      it = allowed_.erase(it);
+    else
+      ++it;
+  }
 }
 
 }  // namespace internal
 
-XWalkSSLHostStateDelegate::XWalkSSLHostStateDelegate() {
+namespace {
+
+using PolicyMap = std::map<std::string, internal::CertPolicy>;
+
+// Runs on the task runner.
+std::unique_ptr<PolicyMap> LoadPolicies(const base::FilePath& path,
+                                        base::Time now) {
+  std::unique_ptr<PolicyMap> policies(new PolicyMap);
+  std::string data;
+  if (!base::ReadFileToString(path, &data))
+    return policies;
+
+  base::Pickle pickle(data.data(), data.size());
+  base::PickleIterator iter(pickle);
+  uint32_t version;
+  uint32_t count;
+  if (!iter.ReadUInt32(&version) || version != kStoreVersion ||
+      !iter.ReadUInt32(&count)) {
+    return policies;
+  }
+
+  for (uint32_t i = 0; i < count; ++i) {
+    std::string host_hash;
+    const char* fingerprint_data;
+    int error;
+    int64_t expiry;
+    if (!iter.ReadString(&host_hash) ||
+        !iter.ReadBytes(&fingerprint_data,
+                        sizeof(net::SHA256HashValue::data)) ||
+        !iter.ReadInt(&error) || !iter.ReadInt64(&expiry)) {
+      LOG(WARNING) << "Truncated SSL exception store " << path.value();
+      break;
+    }
+    if (Int64ToTime(expiry) <= now)
+      continue;
+    net::SHA256HashValue fingerprint;
+    memcpy(fingerprint.data, fingerprint_data, sizeof(fingerprint.data));
+    (*policies)[host_hash].Allow(fingerprint, error, Int64ToTime(expiry));
+  }
+  return policies;
+}
+
+}  // namespace
+
+// Long enough to not nag about the same self-signed intranet host every
+// day, short enough for a mistaken allow to not stick around.
+const base::TimeDelta XWalkSSLHostStateDelegate::kAllowDecisionLifetime =
+    base::TimeDelta::FromDays(7);
+
+XWalkSSLHostStateDelegate::XWalkSSLHostStateDelegate(
+    const base::FilePath& path,
+    scoped_refptr<base::SequencedTaskRunner> task_runner)
+    : loaded_(path.empty()),
+      save_pending_(false),
+      clock_(base::DefaultClock::GetInstance()),
+      weak_factory_(this) {
+  if (path.empty())
+    return;
+
+  writer_.reset(new base::ImportantFileWriter(path, task_runner));
+  base::PostTaskAndReplyWithResult(
+      task_runner.get(), FROM_HERE,
+      base::BindOnce(&LoadPolicies, path, clock_->Now()),
+      base::BindOnce(&XWalkSSLHostStateDelegate::OnLoaded,
+                     weak_factory_.GetWeakPtr()));
 }
 
 XWalkSSLHostStateDelegate::~XWalkSSLHostStateDelegate() {
+  if (writer_ && writer_->HasPendingWrite())
+    writer_->DoScheduledWrite();
+}
+
+void XWalkSSLHostStateDelegate::SetClockForTesting(base::Clock* clock) {
+  clock_ = clock;
+}
+
+void XWalkSSLHostStateDelegate::CommitPendingWriteForTesting() {
+  if (writer_ && writer_->HasPendingWrite())
+    writer_->DoScheduledWrite();
+}
+
+void XWalkSSLHostStateDelegate::RunWhenLoaded(base::OnceClosure callback) {
+  if (loaded_)
+    std::move(callback).Run();
+  else
+    on_loaded_.push_back(std::move(callback));
+}
+
+std::string XWalkSSLHostStateDelegate::KeyFor(const std::string& host) {
+  std::string host_hash = HashHost(host);
+  host_for_hash_[host_hash] = host;
+  return host_hash;
+}
+
+bool XWalkSSLHostStateDelegate::Matches(const PendingClear& clear,
+                                        const std::string& host_hash) const {
+  if (!clear.host_hash.empty())
+    return clear.host_hash == host_hash;
+  if (clear.filter.is_null())
+    return true;
+  auto host = host_for_hash_.find(host_hash);
+  return host == host_for_hash_.end() || clear.filter.Run(host->second);
+}
+
+void XWalkSSLHostStateDelegate::OnLoaded(std::unique_ptr<PolicyMap> loaded) {
+  // Everything on disk predates the clears made in the meantime.
+  for (const PendingClear& clear : pending_clears_) {
+    for (auto it = loaded->begin(); it != loaded->end();) {
+      if (Matches(clear, it->first))
+        it = loaded->erase(it);
+      else
+        ++it;
+    }
+  }
+  pending_clears_.clear();
+
+  for (auto& host : *loaded) {
+    internal::CertPolicy& policy = cert_policy_for_host_[host.first];
+    for (const auto& decision : host.second.allowed()) {
+      if (!policy.allowed().count(decision.first)) {
+        policy.Allow(decision.first, decision.second.error,
+                     decision.second.expiry);
+      }
+    }
+  }
+
+  loaded_ = true;
+  // A write before now would have dropped what was on disk.
+  if (save_pending_)
+    ScheduleSave();
+  std::vector<base::OnceClosure> on_loaded;
+  on_loaded.swap(on_loaded_);
+  for (base::OnceClosure& callback : on_loaded)
+    std::move(callback).Run();
+}
+
+void XWalkSSLHostStateDelegate::ScheduleSave() {
+  if (!writer_)
+    return;
+  if (!loaded_) {
+    save_pending_ = true;
+    return;
+  }
+  save_pending_ = false;
+  writer_->ScheduleWrite(this);
+}
+
+bool XWalkSSLHostStateDelegate::SerializeData(std::string* data) {
+  const base::Time now = clock_->Now();
+  uint32_t count = 0;
+  for (const auto& host : cert_policy_for_host_) {
+    for (const auto& decision : host.second.allowed())
+      count += decision.second.expiry > now;
+  }
+
+  base::Pickle pickle;
+  pickle.WriteUInt32(kStoreVersion);
+  pickle.WriteUInt32(count);
+  for (const auto& host : cert_policy_for_host_) {
+    for (const auto& decision : host.second.allowed()) {
+      if (decision.second.expiry <= now)
+        continue;
+      pickle.WriteString(host.first);
+      pickle.WriteBytes(decision.first.data, sizeof(decision.first.data));
+      pickle.WriteInt(decision.second.error);
+      pickle.WriteInt64(TimeToInt64(decision.second.expiry));
+    }
+  }
+  data->assign(static_cast<const char*>(pickle.data()), pickle.size());
+  return true;
 }
 
 void XWalkSSLHostStateDelegate::HostRanInsecureContent(const std::string& host,
@@ -68,37 +290,47 @@ bool XWalkSSLHostStateDelegate::DidHostRunInsecureContent(
 
 void XWalkSSLHostStateDelegate::RevokeUserAllowExceptions(
     const std::string& host) {
-  cert_policy_for_host_.erase(host);
+  const std::string host_hash = HashHost(host);
+  if (!loaded_) {
+    pending_clears_.push_back({HostFilter(), host_hash});
+    cert_policy_for_host_.erase(host_hash);
+    ScheduleSave();
+    return;
+  }
+  if (cert_policy_for_host_.erase(host_hash))
+    ScheduleSave();
 }
 
 bool XWalkSSLHostStateDelegate::HasAllowException(
     const std::string& host) {
-  auto policy_iterator = cert_policy_for_host_.find(host);
-  return policy_iterator != cert_policy_for_host_.end() &&
-         policy_iterator->second.HasAllowException();
+  auto policy_iterator = cert_policy_for_host_.find(HashHost(host));
+  if (policy_iterator == cert_policy_for_host_.end())
+    return false;
+  policy_iterator->second.RemoveExpired(clock_->Now());
+  return policy_iterator->second.HasAllowException();
 }
 
 void XWalkSSLHostStateDelegate::AllowCert(const std::string& host,
                                           const net::X509Certificate& cert,
                                           int error) {
-  cert_policy_for_host_[host].Allow(cert, error);
+  cert_policy_for_host_[KeyFor(host)].Allow(
+      cert, error, clock_->Now() + kAllowDecisionLifetime);
+  ScheduleSave();
 }
 
 void XWalkSSLHostStateDelegate::Clear(const base::Callback<bool(const std::string&)>& host_filter) {
-  if (host_filter.is_null()) {
-    cert_policy_for_host_.clear();
-    return;
-  }
+  const PendingClear clear = {host_filter, std::string()};
+  if (!loaded_)
+    pending_clears_.push_back(clear);
 
   for (auto it = cert_policy_for_host_.begin();
        it != cert_policy_for_host_.end();) {
-    auto next_it = std::next(it);
-
-    if (host_filter.Run(it->first))
-      cert_policy_for_host_.erase(it);
-
-    it = next_it;
+    if (Matches(clear, it->first))
+      it = cert_policy_for_host_.erase(it);
+    else
+      ++it;
   }
+  ScheduleSave();
 }
 
 SSLHostStateDelegate::CertJudgment XWalkSSLHostStateDelegate::QueryPolicy(
@@ -106,7 +338,11 @@ SSLHostStateDelegate::CertJudgment XWalkSSLHostStateDelegate::QueryPolicy(
     const net::X509Certificate& cert,
     int error,
     bool* expired_previous_decision) {
-  return cert_policy_for_host_[host].Check(cert, error)
+  auto it = cert_policy_for_host_.find(KeyFor(host));
+  if (it == cert_policy_for_host_.end())
+    return SSLHostStateDelegate::DENIED;
+  return it->second.Check(cert, error, clock_->Now(),
+                          expired_previous_decision)
              ? SSLHostStateDelegate::ALLOWED
              : SSLHostStateDelegate::DENIED;
 }
@@ -7,13 +7,25 @@
 #define XWALK_RUNTIME_BROWSER_XWALK_SSL_HOST_STATE_DELEGATE_H_
 
 #include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "base/callback.h"
+#include "base/files/file_path.h"
+#include "base/files/important_file_writer.h"
+#include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
 #include "content/public/browser/ssl_host_state_delegate.h"
 #include "net/base/hash_value.h"
 #include "net/cert/cert_status_flags.h"
 #include "net/cert/x509_certificate.h"
 
+namespace base {
+class Clock;
+class SequencedTaskRunner;
+}
+
 namespace xwalk {
 
 namespace internal {
@@ -21,42 +33,89 @@ namespace internal {
 // This class maintains the policy for storing actions on certificate errors.
 class CertPolicy {
  public:
+  struct Decision {
+    int error;
+    base::Time expiry;
+  };
+  // The allowed certificates, by fingerprint.
+  typedef std::map<net::SHA256HashValue, Decision> CertMap;
+
   CertPolicy();
   ~CertPolicy();
   CertPolicy(const CertPolicy&);
 
   // Returns true if the user has decided to proceed through the ssl error
   // before. For a certificate to be allowed, it must not have any
-  // *additional* errors from when it was allowed.
-  bool Check(const net::X509Certificate& cert, int error) const;
-
-  // Causes the policy to allow this certificate for a given |error|. And
-  // remember the user's choice.
-  void Allow(const net::X509Certificate& cert, int error);
+  // *additional* errors from when it was allowed, and the decision must not
+  // have expired at |now|. |expired| is set if there was a matching
+  // decision that did.
+  bool Check(const net::X509Certificate& cert,
+             int error,
+             base::Time now,
+             bool* expired) const;
+
+  // Causes the policy to allow this certificate for a given |error| until
+  // |expiry|. And remember the user's choice.
+  void Allow(const net::X509Certificate& cert, int error, base::Time expiry);
+  void Allow(const net::SHA256HashValue& fingerprint,
+             int error,
+             base::Time expiry);
+
+  // Drops the decisions that expired at |now|.
+  void RemoveExpired(base::Time now);
 
   // Returns true if and only if there exists a user allow exception for some
   // certificate.
   bool HasAllowException() const { return allowed_.size() > 0; }
 
+  const CertMap& allowed() const { return allowed_; }
+
  private:
-  // The set of fingerprints of allowed certificates.
-  typedef std::map<net::SHA256HashValue, int> CertMap;
   CertMap allowed_;
 };
 
 }  // namespace internal
 
-class XWalkSSLHostStateDelegate : public content::SSLHostStateDelegate {
+// Allow decisions are kept for kAllowDecisionLifetime. When created with a
+// path they are also written there, and read back the next time, so they
+// survive restarts. The file is a base::Pickle of (host hash, fingerprint,
+// error, expiry) records, written at most once per commit interval. Hosts
+// are only stored as SHA-256 hashes, so the file does not list the sites
+// visited; decisions are looked up by the hash of the host asked about.
+class XWalkSSLHostStateDelegate
+    : public content::SSLHostStateDelegate,
+      public base::ImportantFileWriter::DataSerializer {
  public:
-  XWalkSSLHostStateDelegate();
+  static const base::TimeDelta kAllowDecisionLifetime;
+
+  // An empty |path| keeps decisions in memory only. Loading happens on
+  // |task_runner|. Until it finished, decisions made take precedence over the
+  // loaded ones, clears and revocations are applied to the loaded ones as
+  // well, and nothing is written.
+  XWalkSSLHostStateDelegate(
+      const base::FilePath& path,
+      scoped_refptr<base::SequencedTaskRunner> task_runner);
   ~XWalkSSLHostStateDelegate() override;
 
+  void SetClockForTesting(base::Clock* clock);
+
+  // Writes pending changes right away.
+  void CommitPendingWriteForTesting();
+
+  // Runs |callback| once the decisions stored on disk are in. QueryPolicy()
+  // only knows about them from then on, so a certificate error that comes
+  // earlier is checked again before the user is asked.
+  void RunWhenLoaded(base::OnceClosure callback);
+
   // Records that |cert| is permitted to be used for |host| in the future, for
   // a specified |error| type.
   void AllowCert(const std::string& host,
                  const net::X509Certificate& cert,
                  int error) override;
 
+  // Decisions read from disk have no host name to match |host_filter|
+  // against until the host is asked about again, a filtered clear drops
+  // those as well.
   void Clear(const base::Callback<bool(const std::string&)>& host_filter) override;
 
   // Queries whether |cert| is allowed or denied for |host| and |error|.
@@ -79,9 +138,43 @@ class XWalkSSLHostStateDelegate : public content::SSLHostStateDelegate {
 
   bool HasAllowException(const std::string& host) override;
 
+  // base::ImportantFileWriter::DataSerializer implementation.
+  bool SerializeData(std::string* data) override;
+
  private:
-  // Certificate policies for each host.
-  std::map<std::string, internal::CertPolicy> cert_policy_for_host_;
+  // Keyed by host hash.
+  using PolicyMap = std::map<std::string, internal::CertPolicy>;
+  using HostFilter = base::Callback<bool(const std::string&)>;
+
+  // A clear made before the load finished. Either |filter| or, for a single
+  // host, |host_hash| is set; neither stands for all hosts.
+  struct PendingClear {
+    HostFilter filter;
+    std::string host_hash;
+  };
+
+  // Hashes |host| and remembers its name for Clear(). Only used by the
+  // calls that come with a certificate error, which keeps the list short.
+  std::string KeyFor(const std::string& host);
+  // Whether the decisions for |host_hash| are dropped by |clear|.
+  bool Matches(const PendingClear& clear, const std::string& host_hash) const;
+
+  void OnLoaded(std::unique_ptr<PolicyMap> loaded);
+  void ScheduleSave();
+
+  // Certificate policies for each host hash.
+  PolicyMap cert_policy_for_host_;
+  // The names of the hashes that had certificate errors since startup.
+  std::map<std::string, std::string> host_for_hash_;
+
+  bool loaded_;
+  std::vector<PendingClear> pending_clears_;
+  bool save_pending_;
+  std::vector<base::OnceClosure> on_loaded_;
+
+  base::Clock* clock_;
+  std::unique_ptr<base::ImportantFileWriter> writer_;
+  base::WeakPtrFactory<XWalkSSLHostStateDelegate> weak_factory_;
 
   DISALLOW_COPY_AND_ASSIGN(XWalkSSLHostStateDelegate);
 };
@@ -0,0 +1,224 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/browser/xwalk_ssl_host_state_delegate.h"
+
+#include <memory>
+#include <string>
+
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/test/simple_test_clock.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "content/public/test/test_browser_thread_bundle.h"
+#include "content/public/test/test_utils.h"
+#include "net/cert/cert_status_flags.h"
+#include "net/test/cert_test_util.h"
+#include "net/test/test_data_directory.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using content::SSLHostStateDelegate;
+
+namespace xwalk {
+
+namespace {
+
+const char kHost[] = "intranet.example.com";
+const char kOtherHost[] = "other.example.com";
+const int kError = net::CERT_STATUS_AUTHORITY_INVALID;
+
+void SetTrue(bool* value) {
+  *value = true;
+}
+
+class XWalkSSLHostStateDelegateTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    cert_ = net::ImportCertFromFile(net::GetTestCertsDirectory(),
+                                    "ok_cert.pem");
+    ASSERT_TRUE(cert_);
+    other_cert_ = net::ImportCertFromFile(net::GetTestCertsDirectory(),
+                                          "expired_cert.pem");
+    ASSERT_TRUE(other_cert_);
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.GetPath().AppendASCII("SSL Exceptions");
+  }
+
+  std::unique_ptr<XWalkSSLHostStateDelegate> CreateDelegate() {
+    return std::make_unique<XWalkSSLHostStateDelegate>(
+        path_, base::ThreadTaskRunnerHandle::Get());
+  }
+
+  // Leaves an allow decision for kHost and kOtherHost on disk.
+  void StoreDecisions() {
+    std::unique_ptr<XWalkSSLHostStateDelegate> delegate = CreateDelegate();
+    content::RunAllTasksUntilIdle();
+    delegate->AllowCert(kHost, *cert_, kError);
+    delegate->AllowCert(kOtherHost, *cert_, kError);
+    delegate->CommitPendingWriteForTesting();
+    content::RunAllTasksUntilIdle();
+    ASSERT_TRUE(base::PathExists(path_));
+  }
+
+  SSLHostStateDelegate::CertJudgment Query(XWalkSSLHostStateDelegate* delegate,
+                                           const std::string& host,
+                                           net::X509Certificate* cert) {
+    bool expired = false;
+    return delegate->QueryPolicy(host, *cert, kError, &expired);
+  }
+
+  content::TestBrowserThreadBundle thread_bundle_;
+  base::ScopedTempDir temp_dir_;
+  base::FilePath path_;
+  scoped_refptr<net::X509Certificate> cert_;
+  scoped_refptr<net::X509Certificate> other_cert_;
+};
+
+}  // namespace
+
+TEST_F(XWalkSSLHostStateDelegateTest, DecisionsSurviveRestart) {
+  StoreDecisions();
+
+  std::unique_ptr<XWalkSSLHostStateDelegate> delegate = CreateDelegate();
+  content::RunAllTasksUntilIdle();
+  bool expired = false;
+  EXPECT_EQ(SSLHostStateDelegate::ALLOWED,
+            delegate->QueryPolicy(kHost, *cert_, kError, &expired));
+  EXPECT_FALSE(expired);
+  EXPECT_EQ(SSLHostStateDelegate::DENIED,
+            Query(delegate.get(), "unknown.example.com", cert_.get()));
+  EXPECT_EQ(SSLHostStateDelegate::DENIED,
+            Query(delegate.get(), kHost, other_cert_.get()));
+}
+
+TEST_F(XWalkSSLHostStateDelegateTest, StoreHasNoHostNames) {
+  StoreDecisions();
+
+  std::string data;
+  ASSERT_TRUE(base::ReadFileToString(path_, &data));
+  EXPECT_EQ(std::string::npos, data.find(kHost));
+  EXPECT_EQ(std::string::npos, data.find(kOtherHost));
+}
+
+// Stored decisions only regain their host name once it is asked about, a
+// filtered clear cannot tell them apart before.
+TEST_F(XWalkSSLHostStateDelegateTest, FilteredClearOfStoredDecisions) {
+  StoreDecisions();
+
+  std::unique_ptr<XWalkSSLHostStateDelegate> delegate = CreateDelegate();
+  content::RunAllTasksUntilIdle();
+  EXPECT_EQ(SSLHostStateDelegate::ALLOWED,
+            Query(delegate.get(), kHost, cert_.get()));
+  delegate->Clear(base::BindRepeating(
+      [](const std::string& host) { return host == kHost; }));
+  EXPECT_FALSE(delegate->HasAllowException(kHost));
+  EXPECT_FALSE(delegate->HasAllowException(kOtherHost));
+
+  delegate = CreateDelegate();
+  content::RunAllTasksUntilIdle();
+  delegate->AllowCert(kOtherHost, *cert_, kError);
+  delegate->Clear(base::BindRepeating(
+      [](const std::string& host) { return host == kHost; }));
+  EXPECT_EQ(SSLHostStateDelegate::ALLOWED,
+            Query(delegate.get(), kOtherHost, cert_.get()));
+}
+
+TEST_F(XWalkSSLHostStateDelegateTest, DecisionsExpire) {
+  base::SimpleTestClock clock;
+  clock.SetNow(base::Time::Now());
+  XWalkSSLHostStateDelegate delegate(base::FilePath(), nullptr);
+  delegate.SetClockForTesting(&clock);
+
+  delegate.AllowCert(kHost, *cert_, kError);
+  clock.Advance(XWalkSSLHostStateDelegate::kAllowDecisionLifetime -
+                base::TimeDelta::FromMinutes(1));
+  bool expired = false;
+  EXPECT_EQ(SSLHostStateDelegate::ALLOWED,
+            delegate.QueryPolicy(kHost, *cert_, kError, &expired));
+  EXPECT_FALSE(expired);
+
+  clock.Advance(base::TimeDelta::FromMinutes(2));
+  EXPECT_EQ(SSLHostStateDelegate::DENIED,
+            delegate.QueryPolicy(kHost, *cert_, kError, &expired));
+  EXPECT_TRUE(expired);
+  EXPECT_FALSE(delegate.HasAllowException(kHost));
+}
+
+// What clearing browsing data right at startup does.
+TEST_F(XWalkSSLHostStateDelegateTest, ClearBeforeLoad) {
+  StoreDecisions();
+
+  std::unique_ptr<XWalkSSLHostStateDelegate> delegate = CreateDelegate();
+  delegate->Clear(base::Callback<bool(const std::string&)>());
+  content::RunAllTasksUntilIdle();
+  EXPECT_EQ(SSLHostStateDelegate::DENIED,
+            Query(delegate.get(), kHost, cert_.get()));
+  EXPECT_EQ(SSLHostStateDelegate::DENIED,
+            Query(delegate.get(), kOtherHost, cert_.get()));
+
+  // The file was rewritten without them.
+  delegate->CommitPendingWriteForTesting();
+  content::RunAllTasksUntilIdle();
+  delegate = CreateDelegate();
+  content::RunAllTasksUntilIdle();
+  EXPECT_FALSE(delegate->HasAllowException(kHost));
+  EXPECT_FALSE(delegate->HasAllowException(kOtherHost));
+}
+
+TEST_F(XWalkSSLHostStateDelegateTest, RevokeBeforeLoad) {
+  StoreDecisions();
+
+  std::unique_ptr<XWalkSSLHostStateDelegate> delegate = CreateDelegate();
+  delegate->RevokeUserAllowExceptions(kHost);
+  content::RunAllTasksUntilIdle();
+  EXPECT_EQ(SSLHostStateDelegate::DENIED,
+            Query(delegate.get(), kHost, cert_.get()));
+  EXPECT_EQ(SSLHostStateDelegate::ALLOWED,
+            Query(delegate.get(), kOtherHost, cert_.get()));
+}
+
+// A decision made before the load is not written over the stored ones.
+TEST_F(XWalkSSLHostStateDelegateTest, AllowBeforeLoadKeepsStoredDecisions) {
+  StoreDecisions();
+
+  {
+    std::unique_ptr<XWalkSSLHostStateDelegate> delegate = CreateDelegate();
+    delegate->AllowCert(kHost, *other_cert_, kError);
+    delegate->CommitPendingWriteForTesting();
+    content::RunAllTasksUntilIdle();
+    delegate->CommitPendingWriteForTesting();
+    content::RunAllTasksUntilIdle();
+  }
+
+  std::unique_ptr<XWalkSSLHostStateDelegate> delegate = CreateDelegate();
+  content::RunAllTasksUntilIdle();
+  EXPECT_EQ(SSLHostStateDelegate::ALLOWED,
+            Query(delegate.get(), kHost, cert_.get()));
+  EXPECT_EQ(SSLHostStateDelegate::ALLOWED,
+            Query(delegate.get(), kHost, other_cert_.get()));
+  EXPECT_EQ(SSLHostStateDelegate::ALLOWED,
+            Query(delegate.get(), kOtherHost, cert_.get()));
+}
+
+TEST_F(XWalkSSLHostStateDelegateTest, RunWhenLoaded) {
+  StoreDecisions();
+
+  std::unique_ptr<XWalkSSLHostStateDelegate> delegate = CreateDelegate();
+  bool loaded = false;
+  delegate->RunWhenLoaded(base::BindOnce(&SetTrue, &loaded));
+  EXPECT_FALSE(loaded);
+  content::RunAllTasksUntilIdle();
+  EXPECT_TRUE(loaded);
+  EXPECT_EQ(SSLHostStateDelegate::ALLOWED,
+            Query(delegate.get(), kHost, cert_.get()));
+
+  // Later callers run right away.
+  loaded = false;
+  delegate->RunWhenLoaded(base::BindOnce(&SetTrue, &loaded));
+  EXPECT_TRUE(loaded);
+}
+
+}  // namespace xwalk
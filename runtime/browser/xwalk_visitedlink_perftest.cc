@@ -0,0 +1,152 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures the persistent visited link table as XWalkBrowserContext sets it
+// up: insert throughput when URLs arrive in the batches AddVisitedURLs()
+// produces, and how long a later launch takes to get the table back from
+// disk, for 10k, 100k and 1M URLs.
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/macros.h"
+#include "base/memory/read_only_shared_memory_region.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "components/visitedlink/browser/visitedlink_delegate.h"
+#include "components/visitedlink/browser/visitedlink_master.h"
+#include "content/public/test/test_browser_thread_bundle.h"
+#include "content/public/test/test_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "url/gurl.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+
+namespace xwalk {
+
+namespace {
+
+// Matches kMaxPendingVisitedURLs in xwalk_browser_context.cc.
+const size_t kBatchSize = 64;
+
+class NullListener : public visitedlink::VisitedLinkMaster::Listener {
+ public:
+  NullListener() {}
+
+  void NewTable(base::ReadOnlySharedMemoryRegion* table_region) override {}
+  void Add(visitedlink::VisitedLinkCommon::Fingerprint fingerprint) override {}
+  void Reset(bool invalidate_hashes) override {}
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(NullListener);
+};
+
+// Same as XWalkBrowserContext, nothing to rebuild from.
+class EmptyHistoryDelegate : public visitedlink::VisitedLinkDelegate {
+ public:
+  EmptyHistoryDelegate() {}
+
+  void RebuildTable(const scoped_refptr<URLEnumerator>& enumerator) override {
+    enumerator->OnComplete(true);
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(EmptyHistoryDelegate);
+};
+
+std::vector<GURL> MakeURLs(size_t count) {
+  std::vector<GURL> urls;
+  urls.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    urls.push_back(GURL(base::StringPrintf(
+        "https://host%zu.example.com/path/%zu?q=%zu", i % 997, i, i * 31)));
+  }
+  return urls;
+}
+
+class VisitedLinkPerfTest : public testing::Test {
+ protected:
+  void SetUp() override { ASSERT_TRUE(temp_dir_.CreateUniqueTempDir()); }
+
+  std::unique_ptr<visitedlink::VisitedLinkMaster> CreateMaster() {
+    // No rebuild, a missing file simply starts an empty table.
+    return std::make_unique<visitedlink::VisitedLinkMaster>(
+        &listener_, &delegate_, true, true,
+        temp_dir_.GetPath().AppendASCII("Visited Links"), 0);
+  }
+
+  void RunBenchmark(size_t url_count, const std::string& story) {
+    const std::vector<GURL> urls = MakeURLs(url_count);
+
+    {
+      std::unique_ptr<visitedlink::VisitedLinkMaster> master = CreateMaster();
+      ASSERT_TRUE(master->Init());
+      content::RunAllTasksUntilIdle();
+
+      base::TimeTicks start = base::TimeTicks::Now();
+      for (size_t i = 0; i < urls.size(); i += kBatchSize) {
+        auto end = urls.begin() + std::min(i + kBatchSize, urls.size());
+        master->AddURLs(std::vector<GURL>(urls.begin() + i, end));
+      }
+      base::TimeDelta insert_time = base::TimeTicks::Now() - start;
+      // Let the background writes land before the table is reopened.
+      content::RunAllTasksUntilIdle();
+      base::TimeDelta persisted_time = base::TimeTicks::Now() - start;
+
+      EXPECT_EQ(static_cast<int32_t>(url_count), master->GetUsedCount());
+      XWalkBenchmark::ReportValue("visitedlink_insert_throughput", story,
+                                  "urls/s",
+                                  url_count / insert_time.InSecondsF());
+      XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+          "visitedlink_time_to_disk", story,
+          {persisted_time.InMicrosecondsF()}));
+    }
+
+    int64_t file_size = 0;
+    ASSERT_TRUE(base::GetFileSize(
+        temp_dir_.GetPath().AppendASCII("Visited Links"), &file_size));
+    XWalkBenchmark::ReportValue("visitedlink_file_size", story, "bytes",
+                                static_cast<double>(file_size));
+
+    base::TimeTicks start = base::TimeTicks::Now();
+    std::unique_ptr<visitedlink::VisitedLinkMaster> master = CreateMaster();
+    ASSERT_TRUE(master->Init());
+    content::RunAllTasksUntilIdle();
+    base::TimeDelta load_time = base::TimeTicks::Now() - start;
+
+    EXPECT_EQ(static_cast<int32_t>(url_count), master->GetUsedCount());
+    EXPECT_TRUE(master->IsVisited(urls.front()));
+    EXPECT_TRUE(master->IsVisited(urls.back()));
+    EXPECT_FALSE(master->IsVisited(GURL("https://not.visited.example.com/")));
+    XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+        "visitedlink_load", story, {load_time.InMicrosecondsF()}));
+  }
+
+  content::TestBrowserThreadBundle thread_bundle_;
+  base::ScopedTempDir temp_dir_;
+  NullListener listener_;
+  EmptyHistoryDelegate delegate_;
+};
+
+}  // namespace
+
+TEST_F(VisitedLinkPerfTest, Urls10k) {
+  RunBenchmark(10 * 1000, "_10k");
+}
+
+TEST_F(VisitedLinkPerfTest, Urls100k) {
+  RunBenchmark(100 * 1000, "_100k");
+}
+
+TEST_F(VisitedLinkPerfTest, Urls1M) {
+  RunBenchmark(1000 * 1000, "_1M");
+}
+
+}  // namespace xwalk
@@ -5,7 +5,7 @@
 // Multiply-included file, no traditional include guard.
 #include <string>
 
-#include "xwalk/runtime/common/android/xwalk_hit_test_data.h"
+#include "xwalk/runtime/common/xwalk_hit_test_data.h"
 #include "content/public/common/common_param_traits.h"
 #include "ipc/ipc_channel_handle.h"
 #include "ipc/ipc_message_macros.h"
@@ -97,6 +97,15 @@ IPC_MESSAGE_ROUTED1(XWalkViewMsg_SetBackgroundColor, // NOLINT(*)
 IPC_MESSAGE_ROUTED1(XWalkViewMsg_SetTextZoomFactor, // NOLINT(*)
                     float)
 
+// Asks the render process for its XWalkIPCAccounting table.
+IPC_MESSAGE_CONTROL1(XWalkViewMsg_GetIPCStats, // NOLINT(*)
+                     int /* request_id */)
+
+// Tells the frame that the browser kept the XWalkViewHostMsg_UpdateHitTestData
+// with this sequence number.
+IPC_MESSAGE_ROUTED1(XWalkViewMsg_HitTestDataAccepted, // NOLINT(*)
+                    uint32_t /* sequence_number */)
+
 //-----------------------------------------------------------------------------
 // RenderView messages
 // These are messages sent from the renderer to the browser process.
@@ -106,10 +115,16 @@ IPC_MESSAGE_ROUTED2(XWalkViewHostMsg_DocumentHasImagesResponse, // NOLINT(*)
                     int, /* id */
                     bool /* has_images */)
 
-// Response to XWalkViewMsg_DoHitTest.
-IPC_MESSAGE_ROUTED1(XWalkViewHostMsg_UpdateHitTestData, // NOLINT(*)
+// Response to XWalkViewMsg_DoHitTest, and sent on focus changes.
+IPC_MESSAGE_ROUTED2(XWalkViewHostMsg_UpdateHitTestData, // NOLINT(*)
+                    uint32_t /* sequence_number */,
                     xwalk::XWalkHitTestData)
 
+// Response to XWalkViewMsg_GetIPCStats, XWalkIPCAccounting::ToJSON().
+IPC_MESSAGE_CONTROL2(XWalkViewHostMsg_IPCStats, // NOLINT(*)
+                     int /* request_id */,
+                     std::string /* json */)
+
 // Notification that a new picture becomes available. It is only sent if
 // XWalkViewMsg_EnableCapturePictureCallback was previously enabled.
 IPC_MESSAGE_ROUTED0(XWalkViewHostMsg_PictureUpdated) // NOLINT(*)
@@ -119,19 +134,6 @@ IPC_MESSAGE_ROUTED0(XWalkViewHostMsg_PictureUpdated) // NOLINT(*)
 IPC_MESSAGE_ROUTED1(XWalkViewHostMsg_DidActivateAcceleratedCompositing, // NOLINT(*)
                     int /* input_handler_id */)
 
-// Sent immediately before a top level navigation is initiated within Blink.
-// There are some exclusions, the most important ones are it is not sent
-// when creating a popup window, and not sent for application initiated
-// navigations. See XWalkContentRendererClient::HandleNavigation for all
-// cornercases. This is sent before updating the NavigationController state
-// or creating a URLRequest for the main frame resource.
-IPC_SYNC_MESSAGE_CONTROL5_1(XWalkViewHostMsg_ShouldOverrideUrlLoading, // NOLINT(*)
-                            int /* render_frame_id id */,
-                            base::string16 /* in - url */,
-                            bool /* in - has_user_gesture */,
-                            bool /* in - is_redirect */,
-                            bool /* in - is_main_frame */,
-                            bool /* out - result */)
 IPC_SYNC_MESSAGE_CONTROL3_2(XWalkViewHostMsg_WillSendRequest, // NOLINT(*)
                             int /* render_frame_id id */,
                             std::string /* in - url */,
@@ -0,0 +1,37 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/common/android/xwalk_view_ipc_names.h"
+
+#include "xwalk/runtime/common/android/xwalk_render_view_messages.h"
+#include "xwalk/runtime/common/xwalk_ipc_accounting.h"
+
+namespace xwalk {
+
+void RegisterXWalkViewIPCNames() {
+  XWalkIPCAccounting::GetInstance()->RegisterNames<
+      XWalkViewMsg_ClearCache,
+      XWalkViewMsg_DocumentHasImages,
+      XWalkViewMsg_DoHitTest,
+      XWalkViewMsg_EnableCapturePictureCallback,
+      XWalkViewMsg_CapturePictureSync,
+      XWalkViewMsg_SetTextZoomLevel,
+      XWalkViewMsg_ResetScrollAndScaleState,
+      XWalkViewMsg_SetInitialPageScale,
+      XWalkViewMsg_SetJsOnlineProperty,
+      XWalkViewMsg_SetOriginAccessWhitelist,
+      XWalkViewMsg_SetBackgroundColor,
+      XWalkViewMsg_SetTextZoomFactor,
+      XWalkViewMsg_HitTestDataAccepted,
+      XWalkViewMsg_GetIPCStats,
+      XWalkViewHostMsg_DocumentHasImagesResponse,
+      XWalkViewHostMsg_UpdateHitTestData,
+      XWalkViewHostMsg_IPCStats,
+      XWalkViewHostMsg_PictureUpdated,
+      XWalkViewHostMsg_DidActivateAcceleratedCompositing,
+      XWalkViewHostMsg_WillSendRequest,
+      XWalkViewHostMsg_SubFrameCreated>();
+}
+
+}  // namespace xwalk
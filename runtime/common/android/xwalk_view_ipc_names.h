@@ -0,0 +1,16 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_COMMON_ANDROID_XWALK_VIEW_IPC_NAMES_H_
+#define XWALK_RUNTIME_COMMON_ANDROID_XWALK_VIEW_IPC_NAMES_H_
+
+namespace xwalk {
+
+// Names the messages of xwalk_render_view_messages.h in XWalkIPCAccounting
+// reports. Cheap, and safe to call more than once.
+void RegisterXWalkViewIPCNames();
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_COMMON_ANDROID_XWALK_VIEW_IPC_NAMES_H_
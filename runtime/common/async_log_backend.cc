@@ -0,0 +1,391 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/common/async_log_backend.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "base/files/file_util.h"
+#include "base/logging.h"
+#include "base/process/process_handle.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
+#include "base/sys_byteorder.h"
+#include "base/time/time.h"
+#include "xwalk/runtime/common/async_log_format.h"
+
+namespace xwalk {
+
+namespace {
+
+// How often the drain thread wakes up when no buffer is getting full.
+constexpr base::TimeDelta kDrainInterval =
+    base::TimeDelta::FromMilliseconds(100);
+
+std::atomic<AsyncLogBackend*> g_backend{nullptr};
+// Threads inside HandleLogMessage(), Stop() waits for them before freeing the
+// backend.
+std::atomic<int> g_active_writers{0};
+logging::LogMessageHandlerFunction g_previous_handler = nullptr;
+
+int64_t NowInMicroseconds() {
+  return (base::Time::Now() - base::Time::UnixEpoch()).InMicroseconds();
+}
+
+base::FilePath RotatedPath(const base::FilePath& path, int index) {
+  return path.AddExtensionASCII(base::NumberToString(index));
+}
+
+}  // namespace
+
+// Byte ring written by one thread and read by the drain thread. |head_| and
+// |tail_| only grow, the producer owns |head_| and the consumer |tail_|.
+class AsyncLogBackend::Ring {
+ public:
+  Ring(size_t size, uint32_t thread_id)
+      : buffer_(new uint8_t[size]), size_(size), thread_id_(thread_id) {}
+
+  uint32_t thread_id() const { return thread_id_; }
+  size_t size() const { return size_; }
+
+  // Producer side. Returns the bytes in use after the write, or 0 if the
+  // record did not fit and was dropped.
+  size_t Write(const uint8_t* header,
+               base::StringPiece file,
+               base::StringPiece message) {
+    size_t record_size =
+        async_log::kRecordHeaderSize + file.size() + message.size();
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t tail = tail_.load(std::memory_order_acquire);
+    if (size_ - (head - tail) < record_size) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return 0;
+    }
+    CopyIn(head, header, async_log::kRecordHeaderSize);
+    head += async_log::kRecordHeaderSize;
+    CopyIn(head, reinterpret_cast<const uint8_t*>(file.data()), file.size());
+    head += file.size();
+    CopyIn(head, reinterpret_cast<const uint8_t*>(message.data()),
+           message.size());
+    head += message.size();
+    head_.store(head, std::memory_order_release);
+    return static_cast<size_t>(head - tail);
+  }
+
+  // Consumer side. Appends the pending records to |out|.
+  void ReadAll(std::vector<uint8_t>* out) {
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    uint64_t head = head_.load(std::memory_order_acquire);
+    size_t length = static_cast<size_t>(head - tail);
+    if (!length)
+      return;
+    size_t offset = static_cast<size_t>(tail & (size_ - 1));
+    size_t first = std::min(length, size_ - offset);
+    out->insert(out->end(), buffer_.get() + offset,
+                buffer_.get() + offset + first);
+    out->insert(out->end(), buffer_.get(), buffer_.get() + length - first);
+    tail_.store(head, std::memory_order_release);
+  }
+
+  uint64_t TakeDropped() {
+    return dropped_.exchange(0, std::memory_order_relaxed);
+  }
+
+  bool empty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_relaxed);
+  }
+
+  // Set once the owning thread has exited, the ring can go once drained.
+  std::atomic<bool> orphaned{false};
+
+ private:
+  void CopyIn(uint64_t position, const uint8_t* data, size_t length) {
+    size_t offset = static_cast<size_t>(position & (size_ - 1));
+    size_t first = std::min(length, size_ - offset);
+    memcpy(buffer_.get() + offset, data, first);
+    memcpy(buffer_.get(), data + first, length - first);
+  }
+
+  std::unique_ptr<uint8_t[]> buffer_;
+  const size_t size_;
+  const uint32_t thread_id_;
+  std::atomic<uint64_t> head_{0};
+  std::atomic<uint64_t> tail_{0};
+  std::atomic<uint64_t> dropped_{0};
+
+  DISALLOW_COPY_AND_ASSIGN(Ring);
+};
+
+AsyncLogBackend::Options::Options()
+    : max_file_size(8 * 1024 * 1024),
+      max_rotated_files(4),
+      buffer_size(256 * 1024) {}
+
+AsyncLogBackend::AsyncLogBackend(const Options& options)
+    : options_(options),
+      ring_slot_(&AsyncLogBackend::OnThreadExit),
+      draining_thread_(base::kInvalidThreadId),
+      file_size_(0),
+      wake_(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+            base::WaitableEvent::InitialState::NOT_SIGNALED),
+      wake_pending_(false),
+      stopping_(false),
+      dropped_records_(0) {}
+
+AsyncLogBackend::~AsyncLogBackend() {
+  for (Ring* ring : rings_)
+    delete ring;
+}
+
+// static
+bool AsyncLogBackend::Start(const Options& options) {
+  DCHECK(!g_backend.load());
+  Options adjusted = options;
+  size_t buffer_size = 4096;
+  while (buffer_size < adjusted.buffer_size)
+    buffer_size <<= 1;
+  adjusted.buffer_size = buffer_size;
+
+  AsyncLogBackend* backend = new AsyncLogBackend(adjusted);
+  bool opened;
+  {
+    base::AutoLock lock(backend->drain_lock_);
+    opened = backend->OpenFile();
+  }
+  if (!opened ||
+      !base::PlatformThread::Create(0, backend, &backend->thread_)) {
+    delete backend;
+    return false;
+  }
+
+  g_backend.store(backend, std::memory_order_release);
+  g_previous_handler = logging::GetLogMessageHandler();
+  logging::SetLogMessageHandler(&AsyncLogBackend::HandleLogMessage);
+  return true;
+}
+
+// static
+void AsyncLogBackend::Stop() {
+  AsyncLogBackend* backend = g_backend.exchange(nullptr);
+  if (!backend)
+    return;
+  logging::SetLogMessageHandler(g_previous_handler);
+  g_previous_handler = nullptr;
+
+  backend->stopping_.store(true);
+  backend->wake_.Signal();
+  base::PlatformThread::Join(backend->thread_);
+
+  // A thread that read g_backend just before it was cleared may still be
+  // appending to its ring.
+  while (g_active_writers.load() != 0)
+    base::PlatformThread::YieldCurrentThread();
+
+  {
+    base::AutoLock lock(backend->drain_lock_);
+    backend->Drain();
+    backend->file_.Close();
+  }
+  delete backend;
+}
+
+// static
+AsyncLogBackend* AsyncLogBackend::Get() {
+  return g_backend.load(std::memory_order_acquire);
+}
+
+void AsyncLogBackend::Flush() {
+  base::AutoLock lock(drain_lock_);
+  Drain();
+}
+
+// static
+bool AsyncLogBackend::HandleLogMessage(int severity,
+                                       const char* file,
+                                       int line,
+                                       size_t message_start,
+                                       const std::string& str) {
+  g_active_writers.fetch_add(1);
+  AsyncLogBackend* backend = Get();
+  // A message from inside Drain(), e.g. a failed CHECK while writing the
+  // file, only goes to the other destinations.
+  if (backend && !backend->IsDrainingOnCurrentThread()) {
+    backend->Append(severity, file, line, message_start, str);
+    // The process is about to go down, get everything on disk first.
+    if (severity == logging::LOG_FATAL)
+      backend->Flush();
+  }
+  g_active_writers.fetch_sub(1);
+  // base/logging.h goes on with the remaining destinations, the file is no
+  // longer one of them.
+  return false;
+}
+
+// base::ThreadLocalStorage runs this again for a ring set by a later TLS
+// destructor of the same thread. A ring set after the last pass stays in
+// |rings_| until the backend goes away.
+// static
+void AsyncLogBackend::OnThreadExit(void* ring) {
+  static_cast<Ring*>(ring)->orphaned.store(true, std::memory_order_release);
+}
+
+bool AsyncLogBackend::OpenFile() {
+  file_.Initialize(options_.path,
+                   base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_WRITE);
+  if (!file_.IsValid())
+    return false;
+  uint8_t header[async_log::kFileHeaderSize] = {0};
+  memcpy(header, async_log::kFileMagic, async_log::kFileMagicSize);
+  uint32_t pid = base::ByteSwapToLE32(
+      static_cast<uint32_t>(base::GetCurrentProcId()));
+  memcpy(header + async_log::kFileMagicSize, &pid, sizeof(pid));
+  file_size_ = 0;
+  Write(header, sizeof(header));
+  return true;
+}
+
+void AsyncLogBackend::Append(int severity,
+                             const char* file,
+                             int line,
+                             size_t message_start,
+                             const std::string& str) {
+  Ring* ring = GetRingForCurrentThread();
+
+  base::StringPiece message(str);
+  message.remove_prefix(std::min(message_start, message.size()));
+  if (!message.empty() && message.back() == '\n')
+    message.remove_suffix(1);
+
+  base::StringPiece file_name(file ? file : "");
+  size_t slash = file_name.find_last_of("/\\");
+  if (slash != base::StringPiece::npos)
+    file_name.remove_prefix(slash + 1);
+  file_name = file_name.substr(0, 255);
+
+  // Keep single records well below the ring size so one long message does
+  // not starve the rest.
+  size_t max_message =
+      ring->size() / 4 - async_log::kRecordHeaderSize - file_name.size();
+  message = message.substr(0, max_message);
+
+  uint8_t header[async_log::kRecordHeaderSize];
+  async_log::EncodeRecordHeader(
+      static_cast<uint32_t>(async_log::kRecordHeaderSize + file_name.size() +
+                            message.size()),
+      NowInMicroseconds(), ring->thread_id(), severity, file_name.size(), line,
+      header);
+  size_t used = ring->Write(header, file_name, message);
+  if (used > ring->size() / 2 &&
+      !wake_pending_.load(std::memory_order_relaxed) &&
+      !wake_pending_.exchange(true, std::memory_order_relaxed)) {
+    wake_.Signal();
+  }
+}
+
+AsyncLogBackend::Ring* AsyncLogBackend::GetRingForCurrentThread() {
+  Ring* ring = static_cast<Ring*>(ring_slot_.Get());
+  if (ring)
+    return ring;
+  ring = new Ring(options_.buffer_size,
+                  static_cast<uint32_t>(base::PlatformThread::CurrentId()));
+  {
+    base::AutoLock lock(rings_lock_);
+    rings_.push_back(ring);
+  }
+  ring_slot_.Set(ring);
+  return ring;
+}
+
+void AsyncLogBackend::ThreadMain() {
+  base::PlatformThread::SetName("AsyncLogDrain");
+  while (!stopping_.load()) {
+    wake_.TimedWait(kDrainInterval);
+    wake_pending_.store(false, std::memory_order_relaxed);
+    base::AutoLock lock(drain_lock_);
+    Drain();
+  }
+}
+
+void AsyncLogBackend::Drain() {
+  drain_lock_.AssertAcquired();
+  draining_thread_.store(base::PlatformThread::CurrentId(),
+                         std::memory_order_relaxed);
+  std::vector<Ring*> rings;
+  {
+    base::AutoLock lock(rings_lock_);
+    rings = rings_;
+  }
+
+  for (Ring* ring : rings) {
+    drain_buffer_.clear();
+    ring->ReadAll(&drain_buffer_);
+    uint64_t dropped = ring->TakeDropped();
+    if (dropped) {
+      dropped_records_.fetch_add(dropped, std::memory_order_relaxed);
+      size_t offset = drain_buffer_.size();
+      drain_buffer_.resize(offset + async_log::kRecordHeaderSize +
+                           sizeof(dropped));
+      async_log::EncodeRecordHeader(
+          async_log::kRecordHeaderSize + sizeof(dropped), NowInMicroseconds(),
+          ring->thread_id(), async_log::kDroppedSeverity, 0, 0,
+          &drain_buffer_[offset]);
+      uint64_t dropped_le = base::ByteSwapToLE64(dropped);
+      memcpy(&drain_buffer_[offset + async_log::kRecordHeaderSize],
+             &dropped_le, sizeof(dropped_le));
+    }
+    if (!drain_buffer_.empty())
+      Write(drain_buffer_.data(), drain_buffer_.size());
+  }
+
+  base::AutoLock lock(rings_lock_);
+  auto it = rings_.begin();
+  while (it != rings_.end()) {
+    if ((*it)->orphaned.load(std::memory_order_acquire) && (*it)->empty()) {
+      delete *it;
+      it = rings_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  draining_thread_.store(base::kInvalidThreadId, std::memory_order_relaxed);
+}
+
+bool AsyncLogBackend::IsDrainingOnCurrentThread() const {
+  return draining_thread_.load(std::memory_order_relaxed) ==
+         base::PlatformThread::CurrentId();
+}
+
+void AsyncLogBackend::Write(const uint8_t* data, size_t size) {
+  if (!file_.IsValid())
+    return;
+  // Rotate between whole batches so a record never spans two files.
+  if (file_size_ > async_log::kFileHeaderSize &&
+      file_size_ + size > options_.max_file_size) {
+    Rotate();
+    if (!file_.IsValid())
+      return;
+  }
+  int written = file_.WriteAtCurrentPos(reinterpret_cast<const char*>(data),
+                                        static_cast<int>(size));
+  if (written > 0)
+    file_size_ += written;
+}
+
+void AsyncLogBackend::Rotate() {
+  file_.Close();
+  for (int i = options_.max_rotated_files - 1; i >= 1; --i) {
+    base::FilePath from = RotatedPath(options_.path, i);
+    if (base::PathExists(from))
+      base::Move(from, RotatedPath(options_.path, i + 1));
+  }
+  if (options_.max_rotated_files > 0)
+    base::Move(options_.path, RotatedPath(options_.path, 1));
+  OpenFile();
+}
+
+}  // namespace xwalk
@@ -0,0 +1,131 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_COMMON_ASYNC_LOG_BACKEND_H_
+#define XWALK_RUNTIME_COMMON_ASYNC_LOG_BACKEND_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/macros.h"
+#include "base/synchronization/lock.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/thread_local_storage.h"
+
+namespace xwalk {
+
+// Optional backend for base/logging.h, enabled with --async-logging. Every
+// thread that logs gets its own single-producer ring buffer, so LOG() costs a
+// memcpy instead of a locked, synchronous write to the log file. A background
+// thread drains the buffers into size-rotated files using the binary format
+// in async_log_format.h, which xlog_decoder turns back into text.
+//
+// When a thread outpaces the drain thread its records are dropped and
+// counted. The count is written to the log as a record of its own, and is
+// available from dropped_records().
+//
+// Messages still go on to base/logging.h's other destinations, e.g. stderr;
+// only the file is taken over.
+class AsyncLogBackend : public base::PlatformThread::Delegate {
+ public:
+  struct Options {
+    Options();
+
+    // The current file, rotated ones get ".1", ".2", ... appended.
+    base::FilePath path;
+    size_t max_file_size;
+    int max_rotated_files;
+    // Per thread, rounded up to a power of two.
+    size_t buffer_size;
+  };
+
+  // Installs the backend as the log message handler. Returns false if the
+  // log file cannot be created.
+  static bool Start(const Options& options);
+
+  // Writes out what is buffered, removes the handler, stops the drain thread
+  // and frees the backend once no thread is inside the handler. Records
+  // logged concurrently with Stop() may be lost.
+  static void Stop();
+
+  // Null unless started. Invalid after Stop().
+  static AsyncLogBackend* Get();
+
+  // Writes out everything buffered so far, on the calling thread.
+  void Flush();
+
+  uint64_t dropped_records() const {
+    return dropped_records_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  friend class AsyncLogBackendTest;
+  class Ring;
+
+  explicit AsyncLogBackend(const Options& options);
+  ~AsyncLogBackend() override;
+
+  static bool HandleLogMessage(int severity,
+                               const char* file,
+                               int line,
+                               size_t message_start,
+                               const std::string& str);
+  static void OnThreadExit(void* ring);
+
+  bool OpenFile();
+  void Append(int severity,
+              const char* file,
+              int line,
+              size_t message_start,
+              const std::string& str);
+  Ring* GetRingForCurrentThread();
+
+  // base::PlatformThread::Delegate implementation.
+  void ThreadMain() override;
+
+  // Moves the contents of every ring to the file. Called with |drain_lock_|.
+  void Drain();
+  // Whether the calling thread is inside Drain(). Anything it logs from there
+  // would need |drain_lock_| again.
+  bool IsDrainingOnCurrentThread() const;
+  void Write(const uint8_t* data, size_t size);
+  void Rotate();
+
+  const Options options_;
+
+  base::ThreadLocalStorage::Slot ring_slot_;
+  base::Lock rings_lock_;
+  // Owns every ring, including one a thread creates by logging from a TLS
+  // destructor after its own ring was released.
+  std::vector<Ring*> rings_;
+
+  base::Lock drain_lock_;
+  // The thread inside Drain(), base::kInvalidThreadId otherwise.
+  std::atomic<base::PlatformThreadId> draining_thread_;
+  base::File file_;
+  size_t file_size_;
+  std::vector<uint8_t> drain_buffer_;
+
+  base::WaitableEvent wake_;
+  // Set by the first producer to ask for a drain since the drain thread last
+  // woke up, so only that one pays for signaling |wake_|.
+  std::atomic<bool> wake_pending_;
+  std::atomic<bool> stopping_;
+  base::PlatformThreadHandle thread_;
+
+  std::atomic<uint64_t> dropped_records_;
+
+  DISALLOW_COPY_AND_ASSIGN(AsyncLogBackend);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_COMMON_ASYNC_LOG_BACKEND_H_
@@ -0,0 +1,289 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/common/async_log_backend.h"
+
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/logging.h"
+#include "base/strings/stringprintf.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/simple_thread.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "xwalk/runtime/common/async_log_format.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+
+namespace xwalk {
+
+namespace {
+
+const int kBenchmarkThreads = 16;
+const int kMessagesPerThread = 2000;
+
+struct DecodedLog {
+  std::string contents;
+  std::vector<async_log::Record> records;
+  uint64_t dropped = 0;
+};
+
+// Logs kMessagesPerThread lines once |start| is signaled and records how long
+// every LOG() statement took.
+class LoggingThread : public base::SimpleThread {
+ public:
+  LoggingThread(int index, base::WaitableEvent* start)
+      : base::SimpleThread(base::StringPrintf("Logger%d", index)),
+        index_(index),
+        start_(start) {}
+
+  const std::vector<base::TimeDelta>& latencies() const { return latencies_; }
+
+  void Run() override {
+    latencies_.reserve(kMessagesPerThread);
+    start_->Wait();
+    for (int i = 0; i < kMessagesPerThread; ++i) {
+      base::TimeTicks before = base::TimeTicks::Now();
+      LOG(INFO) << "thread " << index_ << " message " << i
+                << " with a payload of typical length for a log line";
+      latencies_.push_back(base::TimeTicks::Now() - before);
+    }
+  }
+
+ private:
+  const int index_;
+  base::WaitableEvent* start_;
+  std::vector<base::TimeDelta> latencies_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoggingThread);
+};
+
+}  // namespace
+
+class AsyncLogBackendTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.GetPath().AppendASCII("test.xlog");
+  }
+
+  void TearDown() override { AsyncLogBackend::Stop(); }
+
+  AsyncLogBackend::Options MakeOptions() {
+    AsyncLogBackend::Options options;
+    options.path = path_;
+    return options;
+  }
+
+  static bool HandleLogMessage(int severity, const std::string& str) {
+    return AsyncLogBackend::HandleLogMessage(severity, __FILE__, __LINE__, 0,
+                                             str);
+  }
+
+  // Keeps the drain thread from emptying the rings while held.
+  base::Lock& drain_lock() { return AsyncLogBackend::Get()->drain_lock_; }
+
+  // Makes the calling thread look like it is inside Drain().
+  void SetDrainingOnCurrentThread(bool draining) {
+    AsyncLogBackend::Get()->draining_thread_.store(
+        draining ? base::PlatformThread::CurrentId() : base::kInvalidThreadId);
+  }
+
+  bool Decode(const base::FilePath& path, DecodedLog* log) {
+    if (!base::ReadFileToString(path, &log->contents))
+      return false;
+    if (log->contents.size() < async_log::kFileHeaderSize ||
+        log->contents.compare(0, async_log::kFileMagicSize,
+                          async_log::kFileMagic) != 0) {
+      return false;
+    }
+    base::span<const uint8_t> data(
+        reinterpret_cast<const uint8_t*>(log->contents.data()),
+        log->contents.size());
+    data = data.subspan(async_log::kFileHeaderSize);
+    while (!data.empty()) {
+      async_log::Record record;
+      size_t size = async_log::DecodeRecord(data, &record);
+      if (!size)
+        return false;
+      data = data.subspan(size);
+      if (record.severity == async_log::kDroppedSeverity) {
+        uint64_t count;
+        memcpy(&count, record.message.data(), sizeof(count));
+        log->dropped += count;
+      } else {
+        log->records.push_back(record);
+      }
+    }
+    return true;
+  }
+
+  // Runs kBenchmarkThreads loggers against the current logging setup and
+  // reports per LOG() latencies under |trace|.
+  void RunBenchmark(const std::string& trace) {
+    base::WaitableEvent start(base::WaitableEvent::ResetPolicy::MANUAL,
+                              base::WaitableEvent::InitialState::NOT_SIGNALED);
+    std::vector<std::unique_ptr<LoggingThread>> threads;
+    for (int i = 0; i < kBenchmarkThreads; ++i) {
+      threads.push_back(std::make_unique<LoggingThread>(i, &start));
+      threads.back()->Start();
+    }
+    start.Signal();
+
+    std::vector<double> latencies_us;
+    for (auto& thread : threads) {
+      thread->Join();
+      for (base::TimeDelta latency : thread->latencies())
+        latencies_us.push_back(latency.InMicrosecondsF());
+    }
+    XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+        "log_latency", "_" + trace, std::move(latencies_us)));
+  }
+
+  base::ScopedTempDir temp_dir_;
+  base::FilePath path_;
+};
+
+TEST_F(AsyncLogBackendTest, RoundTrip) {
+  ASSERT_TRUE(AsyncLogBackend::Start(MakeOptions()));
+  LOG(WARNING) << "hello " << 42;
+  int line = __LINE__ - 1;
+  AsyncLogBackend::Stop();
+
+  DecodedLog log;
+  ASSERT_TRUE(Decode(path_, &log));
+  ASSERT_EQ(1u, log.records.size());
+  EXPECT_EQ(logging::LOG_WARNING, log.records[0].severity);
+  EXPECT_EQ("async_log_backend_unittest.cc", log.records[0].file);
+  EXPECT_EQ(line, log.records[0].line);
+  EXPECT_EQ("hello 42", log.records[0].message);
+  EXPECT_EQ(0u, log.dropped);
+}
+
+// The backend only replaces the log file, stderr and the system log still get
+// every message.
+TEST_F(AsyncLogBackendTest, OtherDestinationsStillLog) {
+  ASSERT_TRUE(AsyncLogBackend::Start(MakeOptions()));
+  EXPECT_FALSE(HandleLogMessage(logging::LOG_INFO, "info\n"));
+  EXPECT_FALSE(HandleLogMessage(logging::LOG_ERROR, "error\n"));
+  AsyncLogBackend::Stop();
+
+  DecodedLog log;
+  ASSERT_TRUE(Decode(path_, &log));
+  ASSERT_EQ(2u, log.records.size());
+  EXPECT_EQ("info", log.records[0].message);
+  EXPECT_EQ("error", log.records[1].message);
+}
+
+// A FATAL logged while draining, e.g. by a CHECK in the file code, must not
+// flush, which would take |drain_lock_| again.
+TEST_F(AsyncLogBackendTest, FatalWhileDrainingSkipsTheBackend) {
+  ASSERT_TRUE(AsyncLogBackend::Start(MakeOptions()));
+  {
+    base::AutoLock lock(drain_lock());
+    SetDrainingOnCurrentThread(true);
+    EXPECT_FALSE(HandleLogMessage(logging::LOG_FATAL, "fatal\n"));
+    SetDrainingOnCurrentThread(false);
+  }
+  EXPECT_FALSE(HandleLogMessage(logging::LOG_ERROR, "error\n"));
+  AsyncLogBackend::Stop();
+
+  DecodedLog log;
+  ASSERT_TRUE(Decode(path_, &log));
+  ASSERT_EQ(1u, log.records.size());
+  EXPECT_EQ("error", log.records[0].message);
+}
+
+TEST_F(AsyncLogBackendTest, OverflowIsCounted) {
+  AsyncLogBackend::Options options = MakeOptions();
+  options.buffer_size = 4096;
+  ASSERT_TRUE(AsyncLogBackend::Start(options));
+  AsyncLogBackend* backend = AsyncLogBackend::Get();
+
+  const int kMessages = 1000;
+  {
+    base::AutoLock lock(drain_lock());
+    for (int i = 0; i < kMessages; ++i)
+      LOG(INFO) << "message " << i;
+  }
+  backend->Flush();
+  uint64_t dropped = backend->dropped_records();
+  EXPECT_GT(dropped, 0u);
+  AsyncLogBackend::Stop();
+
+  DecodedLog log;
+  ASSERT_TRUE(Decode(path_, &log));
+  EXPECT_EQ(dropped, log.dropped);
+  EXPECT_EQ(static_cast<size_t>(kMessages), log.records.size() + log.dropped);
+  // The records that fit are the oldest ones, in order.
+  for (size_t i = 0; i < log.records.size(); ++i)
+    EXPECT_EQ(base::StringPrintf("message %zu", i), log.records[i].message);
+}
+
+TEST_F(AsyncLogBackendTest, Rotation) {
+  AsyncLogBackend::Options options = MakeOptions();
+  options.max_file_size = 4096;
+  options.max_rotated_files = 2;
+  ASSERT_TRUE(AsyncLogBackend::Start(options));
+  for (int i = 0; i < 500; ++i) {
+    LOG(INFO) << "message " << i;
+    if (i % 10 == 9)
+      AsyncLogBackend::Get()->Flush();
+  }
+  AsyncLogBackend::Stop();
+
+  base::FilePath rotated1 = path_.AddExtensionASCII("1");
+  base::FilePath rotated2 = path_.AddExtensionASCII("2");
+  EXPECT_FALSE(base::PathExists(path_.AddExtensionASCII("3")));
+
+  // Each file holds whole records and the newest ones are in |path_|.
+  DecodedLog oldest, older, newest;
+  ASSERT_TRUE(Decode(rotated2, &oldest));
+  ASSERT_TRUE(Decode(rotated1, &older));
+  ASSERT_TRUE(Decode(path_, &newest));
+  ASSERT_FALSE(newest.records.empty());
+  EXPECT_EQ("message 499", newest.records.back().message);
+}
+
+// Compares the synchronous, locked file logging used today with the async
+// backend, 16 threads logging concurrently.
+TEST_F(AsyncLogBackendTest, Benchmark) {
+  base::FilePath text_path = temp_dir_.GetPath().AppendASCII("test.log");
+  logging::LoggingSettings settings;
+  settings.logging_dest = logging::LOG_TO_FILE;
+  settings.log_file = text_path.value().c_str();
+  settings.lock_log = logging::LOCK_LOG_FILE;
+  settings.delete_old = logging::DELETE_OLD_LOG_FILE;
+  ASSERT_TRUE(logging::InitLogging(settings));
+  logging::SetLogItems(true, true, true, false);
+  RunBenchmark("sync_file");
+  logging::CloseLogFile();
+
+  settings.logging_dest = logging::LOG_NONE;
+  settings.log_file = nullptr;
+  settings.lock_log = logging::DONT_LOCK_LOG_FILE;
+  ASSERT_TRUE(logging::InitLogging(settings));
+  ASSERT_TRUE(AsyncLogBackend::Start(MakeOptions()));
+  RunBenchmark("async");
+  uint64_t dropped = AsyncLogBackend::Get()->dropped_records();
+  AsyncLogBackend::Stop();
+  XWalkBenchmark::ReportValue("log_dropped", "_async", "records",
+                              static_cast<double>(dropped));
+
+  DecodedLog log;
+  ASSERT_TRUE(Decode(path_, &log));
+  EXPECT_EQ(static_cast<size_t>(kBenchmarkThreads * kMessagesPerThread),
+            log.records.size() + log.dropped);
+
+  settings.logging_dest = logging::LOG_DEFAULT;
+  ASSERT_TRUE(logging::InitLogging(settings));
+}
+
+}  // namespace xwalk
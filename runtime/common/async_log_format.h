@@ -0,0 +1,99 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_COMMON_ASYNC_LOG_FORMAT_H_
+#define XWALK_RUNTIME_COMMON_ASYNC_LOG_FORMAT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "base/containers/span.h"
+#include "base/strings/string_piece.h"
+#include "base/sys_byteorder.h"
+
+// Binary format of the files written by AsyncLogBackend, shared with the
+// offline decoder in //xwalk/tools/xlog_decoder. Integers are little endian.
+//
+// File:    magic "XWLOG001", uint32 process id, uint32 reserved, records.
+// Record:  uint32 record size (header included)
+//          int64  wall clock time, microseconds since the Unix epoch
+//          uint32 thread id
+//          int8   severity (logging::LogSeverity, or kDroppedSeverity)
+//          uint8  length of the source file name
+//          uint16 source line
+//          file name, then the message without the base/logging.h prefix.
+//
+// A record with kDroppedSeverity has no file name, its message is the
+// uint64 number of records the thread dropped because its buffer was full.
+namespace xwalk {
+namespace async_log {
+
+const char kFileMagic[] = "XWLOG001";
+const size_t kFileMagicSize = sizeof(kFileMagic) - 1;
+const size_t kFileHeaderSize = kFileMagicSize + 4 + 4;
+const size_t kRecordHeaderSize = 4 + 8 + 4 + 1 + 1 + 2;
+const int kDroppedSeverity = 127;
+
+struct Record {
+  int64_t time_us;
+  uint32_t thread_id;
+  int severity;
+  int line;
+  base::StringPiece file;
+  base::StringPiece message;
+};
+
+inline void EncodeRecordHeader(uint32_t record_size,
+                               int64_t time_us,
+                               uint32_t thread_id,
+                               int severity,
+                               size_t file_length,
+                               int line,
+                               uint8_t* out) {
+  uint32_t size_le = base::ByteSwapToLE32(record_size);
+  uint64_t time_le = base::ByteSwapToLE64(static_cast<uint64_t>(time_us));
+  uint32_t thread_le = base::ByteSwapToLE32(thread_id);
+  uint16_t line_le = base::ByteSwapToLE16(static_cast<uint16_t>(line));
+  memcpy(out, &size_le, 4);
+  memcpy(out + 4, &time_le, 8);
+  memcpy(out + 12, &thread_le, 4);
+  out[16] = static_cast<uint8_t>(static_cast<int8_t>(severity));
+  out[17] = static_cast<uint8_t>(file_length);
+  memcpy(out + 18, &line_le, 2);
+}
+
+// Parses the record at the start of |data|. Returns its size, or 0 if |data|
+// does not hold a complete, well formed record.
+inline size_t DecodeRecord(base::span<const uint8_t> data, Record* record) {
+  if (data.size() < kRecordHeaderSize)
+    return 0;
+  const uint8_t* p = data.data();
+  uint32_t size;
+  uint64_t time;
+  uint32_t thread_id;
+  uint16_t line;
+  memcpy(&size, p, 4);
+  memcpy(&time, p + 4, 8);
+  memcpy(&thread_id, p + 12, 4);
+  memcpy(&line, p + 18, 2);
+  size = base::ByteSwapToLE32(size);
+  size_t file_length = p[17];
+  if (size < kRecordHeaderSize + file_length || size > data.size())
+    return 0;
+  record->time_us = static_cast<int64_t>(base::ByteSwapToLE64(time));
+  record->thread_id = base::ByteSwapToLE32(thread_id);
+  record->severity = static_cast<int8_t>(p[16]);
+  record->line = base::ByteSwapToLE16(line);
+  const char* text = reinterpret_cast<const char*>(p + kRecordHeaderSize);
+  record->file = base::StringPiece(text, file_length);
+  record->message = base::StringPiece(text + file_length,
+                                      size - kRecordHeaderSize - file_length);
+  return size;
+}
+
+}  // namespace async_log
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_COMMON_ASYNC_LOG_FORMAT_H_
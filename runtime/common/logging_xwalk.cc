@@ -39,6 +39,7 @@
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
 #include "base/path_service.h"
+#include "base/process/process_handle.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
@@ -46,7 +47,9 @@
 #include "base/threading/thread_restrictions.h"
 #include "content/public/common/content_switches.h"
 #include "ipc/ipc_logging.h"
+#include "xwalk/runtime/common/async_log_backend.h"
 #include "xwalk/runtime/common/xwalk_paths.h"
+#include "xwalk/runtime/common/xwalk_switches.h"
 
 #if defined(OS_WIN)
 #include <initguid.h>
@@ -123,6 +126,22 @@ void InitXwalkLogging(const base::CommandLine& command_line,
     log_locking_state = DONT_LOCK_LOG_FILE;
   }
 
+  // With --async-logging the file is written by AsyncLogBackend instead. Each
+  // process gets its own file so no cross-process lock is needed.
+  if ((logging_dest & LOG_TO_FILE) != 0 &&
+      command_line.HasSwitch(switches::kAsyncLogging)) {
+    xwalk::AsyncLogBackend::Options options;
+    options.path = log_path.RemoveExtension()
+                       .AddExtensionASCII(base::NumberToString(
+                           base::GetCurrentProcId()))
+                       .AddExtension(FILE_PATH_LITERAL("xlog"));
+    if (xwalk::AsyncLogBackend::Start(options)) {
+      logging_dest &= ~LOG_TO_FILE;
+      log_path.clear();
+      log_locking_state = DONT_LOCK_LOG_FILE;
+    }
+  }
+
   logging::LoggingSettings settings;
   settings.logging_dest = logging_dest;
   settings.log_file = log_path.value().c_str();
@@ -184,6 +203,7 @@ void CleanupXwalkLogging() {
   DCHECK(xwalk_logging_initialized_) <<
       "Attempted to clean up logging when it wasn't initialized.";
 
+  xwalk::AsyncLogBackend::Stop();
   CloseLogFile();
 
   xwalk_logging_initialized_ = false;
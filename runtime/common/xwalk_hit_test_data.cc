@@ -2,7 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-#include "xwalk/runtime/common/android/xwalk_hit_test_data.h"
+#include "xwalk/runtime/common/xwalk_hit_test_data.h"
 
 namespace xwalk {
 
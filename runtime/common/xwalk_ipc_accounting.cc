@@ -0,0 +1,262 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/common/xwalk_ipc_accounting.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/files/important_file_writer.h"
+#include "base/json/json_writer.h"
+#include "base/process/process_handle.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "ipc/ipc_message.h"
+#include "ipc/ipc_message_macros.h"
+#include "xwalk/runtime/common/xwalk_switches.h"
+
+namespace xwalk {
+
+namespace {
+
+// "XIPC", followed by the send time in TimeTicks microseconds.
+const uint32_t kTrailerMagic = 0x43504958;
+const size_t kTrailerSize = sizeof(uint32_t) + sizeof(int64_t);
+
+int LatencyBucket(int64_t latency_us) {
+  int bucket = 0;
+  while (bucket < XWalkIPCAccounting::kLatencyBuckets - 1 &&
+         latency_us >= (static_cast<int64_t>(1) << bucket)) {
+    ++bucket;
+  }
+  return bucket;
+}
+
+void Add(const XWalkIPCAccounting::Stats& from,
+         XWalkIPCAccounting::Stats* to) {
+  to->count += from.count;
+  to->bytes += from.bytes;
+  to->sync |= from.sync;
+  to->latency_samples += from.latency_samples;
+  to->latency_total_us += from.latency_total_us;
+  to->latency_max_us = std::max(to->latency_max_us, from.latency_max_us);
+  for (int i = 0; i < XWalkIPCAccounting::kLatencyBuckets; ++i)
+    to->latency_histogram[i] += from.latency_histogram[i];
+}
+
+// Returns false if |message| carries no send time.
+bool ReadTrailer(const IPC::Message& message, int64_t* sent_us) {
+  if (message.payload_size() < kTrailerSize)
+    return false;
+  const char* trailer =
+      static_cast<const char*>(message.payload()) + message.payload_size() -
+      kTrailerSize;
+  uint32_t magic;
+  memcpy(&magic, trailer, sizeof(magic));
+  if (magic != kTrailerMagic)
+    return false;
+  memcpy(sent_us, trailer + sizeof(magic), sizeof(*sent_us));
+  return true;
+}
+
+}  // namespace
+
+XWalkIPCAccounting::Stats::Stats()
+    : count(0),
+      bytes(0),
+      sync(false),
+      latency_samples(0),
+      latency_total_us(0),
+      latency_max_us(0) {
+  std::fill(std::begin(latency_histogram), std::end(latency_histogram), 0);
+}
+
+// static
+XWalkIPCAccounting* XWalkIPCAccounting::GetInstance() {
+  static base::NoDestructor<XWalkIPCAccounting> instance;
+  return instance.get();
+}
+
+// static
+bool XWalkIPCAccounting::IsLatencyEnabled() {
+  static const bool enabled = base::CommandLine::ForCurrentProcess()->HasSwitch(
+      switches::kEnableIPCLatency);
+  return enabled;
+}
+
+XWalkIPCAccounting::XWalkIPCAccounting() {
+  names_[IPC_REPLY_ID] = "SyncReply";
+}
+
+XWalkIPCAccounting::~XWalkIPCAccounting() = default;
+
+void XWalkIPCAccounting::WillSend(IPC::Message* message) {
+  ThreadTable* table = GetThreadTable();
+  {
+    base::AutoLock lock(table->lock);
+    Stats* stats = GetOrCreate(table, *message, kSent);
+    stats->count++;
+    stats->bytes += message->size();
+  }
+  // Replies are matched to their request by the sync channel and never go
+  // through DidDispatch(), there is nothing to stamp them for.
+  if (!IsLatencyEnabled() || message->is_reply())
+    return;
+  message->WriteUInt32(kTrailerMagic);
+  message->WriteInt64(
+      (base::TimeTicks::Now() - base::TimeTicks()).InMicroseconds());
+}
+
+void XWalkIPCAccounting::DidDispatch(const IPC::Message& message) {
+  int64_t sent_us;
+  bool has_send_time = IsLatencyEnabled() && ReadTrailer(message, &sent_us);
+  int64_t latency_us = 0;
+  if (has_send_time) {
+    latency_us = std::max<int64_t>(
+        0, (base::TimeTicks::Now() - base::TimeTicks()).InMicroseconds() -
+               sent_us);
+  }
+
+  ThreadTable* table = GetThreadTable();
+  base::AutoLock lock(table->lock);
+  Stats* stats = GetOrCreate(table, message, kReceived);
+  stats->count++;
+  stats->bytes += message.size() - (has_send_time ? kTrailerSize : 0);
+  if (!has_send_time)
+    return;
+  stats->latency_samples++;
+  stats->latency_total_us += latency_us;
+  stats->latency_max_us = std::max(stats->latency_max_us, latency_us);
+  stats->latency_histogram[LatencyBucket(latency_us)]++;
+}
+
+XWalkIPCAccounting::Stats XWalkIPCAccounting::GetStats(
+    uint32_t type,
+    Direction direction) const {
+  Stats result;
+  base::AutoLock tables_lock(tables_lock_);
+  for (const auto& table : tables_) {
+    base::AutoLock lock(table->lock);
+    auto it = table->stats.find(Key(type, direction));
+    if (it != table->stats.end())
+      Add(it->second, &result);
+  }
+  return result;
+}
+
+std::string XWalkIPCAccounting::GetName(uint32_t type) const {
+  base::AutoLock lock(names_lock_);
+  return GetNameLocked(type);
+}
+
+std::unique_ptr<base::DictionaryValue> XWalkIPCAccounting::ToValue() const {
+  StatsMap merged = MergeTables();
+  auto messages = std::make_unique<base::ListValue>();
+  {
+    base::AutoLock lock(names_lock_);
+    for (const auto& entry : merged) {
+      uint32_t type = entry.first.first;
+      const Stats& stats = entry.second;
+
+      std::string name = GetNameLocked(type);
+
+      auto histogram = std::make_unique<base::ListValue>();
+      for (uint64_t bucket : stats.latency_histogram)
+        histogram->AppendDouble(static_cast<double>(bucket));
+
+      auto latency = std::make_unique<base::DictionaryValue>();
+      latency->SetDouble("samples", static_cast<double>(stats.latency_samples));
+      latency->SetDouble("mean", stats.latency_samples
+                                     ? static_cast<double>(
+                                           stats.latency_total_us) /
+                                           stats.latency_samples
+                                     : 0);
+      latency->SetDouble("max", static_cast<double>(stats.latency_max_us));
+      latency->Set("histogram", std::move(histogram));
+
+      auto message = std::make_unique<base::DictionaryValue>();
+      message->SetString("name", name);
+      message->SetInteger("type", static_cast<int>(type));
+      message->SetString("direction",
+                         entry.first.second == kSent ? "sent" : "received");
+      message->SetDouble("count", static_cast<double>(stats.count));
+      message->SetDouble("bytes", static_cast<double>(stats.bytes));
+      message->SetBoolean("sync", stats.sync);
+      message->Set("latency_us", std::move(latency));
+      messages->Append(std::move(message));
+    }
+  }
+
+  auto result = std::make_unique<base::DictionaryValue>();
+  result->SetInteger("pid", static_cast<int>(base::GetCurrentProcId()));
+  result->Set("messages", std::move(messages));
+  return result;
+}
+
+std::string XWalkIPCAccounting::ToJSON() const {
+  std::string json;
+  base::JSONWriter::WriteWithOptions(
+      *ToValue(), base::JSONWriter::OPTIONS_PRETTY_PRINT, &json);
+  return json;
+}
+
+bool XWalkIPCAccounting::WriteToFile(const base::FilePath& path) const {
+  return base::ImportantFileWriter::WriteFileAtomically(path, ToJSON());
+}
+
+void XWalkIPCAccounting::RegisterName(uint32_t type, const std::string& name) {
+  base::AutoLock lock(names_lock_);
+  names_[type] = name;
+}
+
+std::string XWalkIPCAccounting::GetNameLocked(uint32_t type) const {
+  names_lock_.AssertAcquired();
+  auto it = names_.find(type);
+  return it != names_.end()
+             ? it->second
+             : base::StringPrintf("%u:%u", IPC_MESSAGE_ID_CLASS(type),
+                                  IPC_MESSAGE_ID_LINE(type));
+}
+
+XWalkIPCAccounting::ThreadTable* XWalkIPCAccounting::GetThreadTable() {
+  ThreadTable* table = static_cast<ThreadTable*>(table_slot_.Get());
+  if (table)
+    return table;
+  auto new_table = std::make_unique<ThreadTable>();
+  table = new_table.get();
+  {
+    base::AutoLock lock(tables_lock_);
+    tables_.push_back(std::move(new_table));
+  }
+  table_slot_.Set(table);
+  return table;
+}
+
+// static
+XWalkIPCAccounting::Stats* XWalkIPCAccounting::GetOrCreate(
+    ThreadTable* table,
+    const IPC::Message& message,
+    Direction direction) {
+  table->lock.AssertAcquired();
+  Stats* stats = &table->stats[Key(message.type(), direction)];
+  stats->sync |= message.is_sync();
+  return stats;
+}
+
+XWalkIPCAccounting::StatsMap XWalkIPCAccounting::MergeTables() const {
+  StatsMap merged;
+  base::AutoLock tables_lock(tables_lock_);
+  for (const auto& table : tables_) {
+    base::AutoLock lock(table->lock);
+    for (const auto& entry : table->stats)
+      Add(entry.second, &merged[entry.first]);
+  }
+  return merged;
+}
+
+}  // namespace xwalk
@@ -0,0 +1,146 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_COMMON_XWALK_IPC_ACCOUNTING_H_
+#define XWALK_RUNTIME_COMMON_XWALK_IPC_ACCOUNTING_H_
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/thread_local_storage.h"
+
+namespace base {
+class DictionaryValue;
+class FilePath;
+}
+
+namespace IPC {
+class Message;
+}
+
+namespace xwalk {
+
+// Per process accounting of the runtime's own IPC traffic: the extension
+// client/server/process messages and the XWalkView messages. For every
+// message type and direction it keeps the message count, the bytes on the
+// wire and whether the type is synchronous. Each thread counts into its own
+// table, the tables are only merged when read, so counting is always on.
+//
+// With --enable-ipc-latency, which the browser passes on to its child
+// processes, it also keeps a histogram of the time between the peer sending
+// a message and its handler running here. That needs the send time, so
+// WillSend() appends it to the message payload as a small trailer. Parameter
+// readers stop after the last declared field and never see it; DidDispatch()
+// only trusts a trailer carrying the magic value. Both sides use
+// base::TimeTicks, which is a system wide clock on every platform we ship.
+//
+// The Crosswalk.getIPCStats DevTools command and the --ipc-stats-port
+// endpoint return the tables of the browser and of the render processes, and
+// the browser process writes its own to --dump-ipc-stats at shutdown.
+class XWalkIPCAccounting {
+ public:
+  enum Direction { kSent, kReceived };
+
+  // Bucket i counts latencies below 2^i microseconds, the last one the rest.
+  static const int kLatencyBuckets = 24;
+
+  struct Stats {
+    Stats();
+
+    uint64_t count;
+    uint64_t bytes;
+    bool sync;
+    uint64_t latency_samples;
+    int64_t latency_total_us;
+    int64_t latency_max_us;
+    uint64_t latency_histogram[kLatencyBuckets];
+  };
+
+  static XWalkIPCAccounting* GetInstance();
+
+  // Whether this process was started with --enable-ipc-latency.
+  static bool IsLatencyEnabled();
+
+  // Records |message| as sent and, if IsLatencyEnabled(), stamps it with the
+  // current time. Must be called right before the message is handed to the
+  // channel.
+  void WillSend(IPC::Message* message);
+
+  // Records |message| as dispatched to its handler.
+  void DidDispatch(const IPC::Message& message);
+
+  // Gives |Messages| readable names in the reports. Types without a name
+  // are reported as "<message class>:<line>".
+  template <typename... Messages>
+  void RegisterNames() {
+    int unused[] = {0, (RegisterName(Messages::ID, NameOf<Messages>()), 0)...};
+    ALLOW_UNUSED_LOCAL(unused);
+  }
+
+  Stats GetStats(uint32_t type, Direction direction) const;
+
+  // The registered name of |type|, or "<message class>:<line>".
+  std::string GetName(uint32_t type) const;
+
+  // {"pid": ..., "messages": [{"name", "type", "direction", "count", "bytes",
+  //  "sync", "latency_us": {"samples", "mean", "max", "histogram"}}, ...]}
+  std::unique_ptr<base::DictionaryValue> ToValue() const;
+  std::string ToJSON() const;
+  bool WriteToFile(const base::FilePath& path) const;
+
+ private:
+  friend class base::NoDestructor<XWalkIPCAccounting>;
+
+  using Key = std::pair<uint32_t, Direction>;
+  using StatsMap = std::map<Key, Stats>;
+
+  // The counters of one thread. Its lock is only contended by readers.
+  struct ThreadTable {
+    base::Lock lock;
+    StatsMap stats;
+  };
+
+  XWalkIPCAccounting();
+  ~XWalkIPCAccounting();
+
+  template <typename Message>
+  static std::string NameOf() {
+    std::string name;
+    Message::Log(&name, nullptr, nullptr);
+    return name;
+  }
+
+  void RegisterName(uint32_t type, const std::string& name);
+  std::string GetNameLocked(uint32_t type) const;
+
+  ThreadTable* GetThreadTable();
+  static Stats* GetOrCreate(ThreadTable* table,
+                            const IPC::Message& message,
+                            Direction direction);
+  // The sum of every thread's table.
+  StatsMap MergeTables() const;
+
+  base::ThreadLocalStorage::Slot table_slot_;
+  // Tables outlive their threads, so counts of a thread that has exited are
+  // still reported.
+  mutable base::Lock tables_lock_;
+  std::vector<std::unique_ptr<ThreadTable>> tables_;
+
+  mutable base::Lock names_lock_;
+  std::map<uint32_t, std::string> names_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkIPCAccounting);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_COMMON_XWALK_IPC_ACCOUNTING_H_
@@ -0,0 +1,51 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/common/xwalk_ipc_accounting.h"
+
+#include "ipc/ipc_message.h"
+#include "ipc/ipc_message_macros.h"
+#include "ipc/ipc_message_start.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace xwalk {
+
+namespace {
+
+// Past every declared message class, so no other test counts it.
+const uint32_t kType = IPC_MESSAGE_ID(LastIPCMsgStart + 0x100, 1);
+
+}  // namespace
+
+// The unit test launcher does not pass --enable-ipc-latency, counting must
+// work without it and leave the payload alone.
+TEST(XWalkIPCAccountingTest, CountsWithoutLatencySwitch) {
+  ASSERT_FALSE(XWalkIPCAccounting::IsLatencyEnabled());
+  XWalkIPCAccounting* accounting = XWalkIPCAccounting::GetInstance();
+  const XWalkIPCAccounting::Stats sent_before =
+      accounting->GetStats(kType, XWalkIPCAccounting::kSent);
+  const XWalkIPCAccounting::Stats received_before =
+      accounting->GetStats(kType, XWalkIPCAccounting::kReceived);
+
+  IPC::Message message(MSG_ROUTING_CONTROL, kType,
+                       IPC::Message::PRIORITY_NORMAL);
+  message.WriteInt(42);
+  const size_t payload_size = message.payload_size();
+  accounting->WillSend(&message);
+  EXPECT_EQ(payload_size, message.payload_size());
+  accounting->DidDispatch(message);
+
+  XWalkIPCAccounting::Stats sent =
+      accounting->GetStats(kType, XWalkIPCAccounting::kSent);
+  EXPECT_EQ(1u, sent.count - sent_before.count);
+  EXPECT_EQ(message.size(), sent.bytes - sent_before.bytes);
+
+  XWalkIPCAccounting::Stats received =
+      accounting->GetStats(kType, XWalkIPCAccounting::kReceived);
+  EXPECT_EQ(1u, received.count - received_before.count);
+  EXPECT_EQ(message.size(), received.bytes - received_before.bytes);
+  EXPECT_EQ(received_before.latency_samples, received.latency_samples);
+}
+
+}  // namespace xwalk
@@ -0,0 +1,78 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/common/xwalk_runtime_internals.h"
+
+#include "base/json/json_writer.h"
+#include "base/values.h"
+
+namespace xwalk {
+
+namespace {
+
+// Indexed by XWalkRuntimeInternals::Counter.
+const char* const kCounterNames[] = {
+    "extensionMessagesSent",
+    "extensionMessagesReceived",
+    "extensionMessageBytes",
+    "extensionInstances",
+    "interceptedRequests",
+    "cookieZoneSwitches",
+};
+
+static_assert(arraysize(kCounterNames) == XWalkRuntimeInternals::kCounterCount,
+              "kCounterNames must name every counter");
+
+}  // namespace
+
+base::subtle::Atomic32 XWalkRuntimeInternals::observer_count_ = 0;
+
+// static
+XWalkRuntimeInternals* XWalkRuntimeInternals::GetInstance() {
+  static base::NoDestructor<XWalkRuntimeInternals> instance;
+  return instance.get();
+}
+
+XWalkRuntimeInternals::XWalkRuntimeInternals()
+    : observers_(new base::ObserverListThreadSafe<Observer>()) {
+  for (auto& counter : counters_)
+    counter.store(0, std::memory_order_relaxed);
+}
+
+XWalkRuntimeInternals::~XWalkRuntimeInternals() = default;
+
+void XWalkRuntimeInternals::AddObserver(Observer* observer) {
+  observers_->AddObserver(observer);
+  base::subtle::NoBarrier_AtomicIncrement(&observer_count_, 1);
+}
+
+void XWalkRuntimeInternals::RemoveObserver(Observer* observer) {
+  observers_->RemoveObserver(observer);
+  base::subtle::NoBarrier_AtomicIncrement(&observer_count_, -1);
+}
+
+void XWalkRuntimeInternals::Emit(const std::string& method,
+                                 const base::DictionaryValue& params) {
+  // Serialized once here, observers only wrap it in a protocol message.
+  std::string params_json;
+  base::JSONWriter::Write(params, &params_json);
+  observers_->Notify(FROM_HERE, &Observer::OnRuntimeEvent, method,
+                     params_json);
+}
+
+void XWalkRuntimeInternals::Count(Counter counter, int64_t delta) {
+  counters_[counter].fetch_add(delta, std::memory_order_relaxed);
+}
+
+std::unique_ptr<base::DictionaryValue> XWalkRuntimeInternals::GetCounters()
+    const {
+  auto result = std::make_unique<base::DictionaryValue>();
+  for (int i = 0; i < kCounterCount; ++i) {
+    result->SetDouble(kCounterNames[i], static_cast<double>(counters_[i].load(
+                                            std::memory_order_relaxed)));
+  }
+  return result;
+}
+
+}  // namespace xwalk
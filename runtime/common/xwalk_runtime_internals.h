@@ -0,0 +1,90 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_COMMON_XWALK_RUNTIME_INTERNALS_H_
+#define XWALK_RUNTIME_COMMON_XWALK_RUNTIME_INTERNALS_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "base/atomicops.h"
+#include "base/macros.h"
+#include "base/memory/ref_counted.h"
+#include "base/no_destructor.h"
+#include "base/observer_list_threadsafe.h"
+
+namespace base {
+class DictionaryValue;
+}
+
+namespace xwalk {
+
+// Events and counters from the runtime's own hot paths, for the Crosswalk
+// DevTools domain: extension message traffic, extension instances (the
+// native side of the JavaScript binding objects), intercepted requests and
+// cookie zone switches.
+//
+// Nothing is built unless an observer is attached. Call sites check
+// IsEnabled(), a single relaxed load, before preparing an event or bumping
+// a counter. The one exception is kExtensionInstances, a gauge that has to
+// be right whenever a client asks.
+class XWalkRuntimeInternals {
+ public:
+  class Observer {
+   public:
+    // |method| is the protocol event name, |params_json| its parameters.
+    virtual void OnRuntimeEvent(const std::string& method,
+                                const std::string& params_json) = 0;
+
+   protected:
+    virtual ~Observer() {}
+  };
+
+  enum Counter {
+    kExtensionMessagesSent,
+    kExtensionMessagesReceived,
+    kExtensionMessageBytes,
+    kExtensionInstances,
+    kInterceptedRequests,
+    kCookieZoneSwitches,
+    kCounterCount,
+  };
+
+  static XWalkRuntimeInternals* GetInstance();
+
+  static bool IsEnabled() {
+    return base::subtle::NoBarrier_Load(&observer_count_) > 0;
+  }
+
+  // Observers are notified on the sequence they were added on.
+  void AddObserver(Observer* observer);
+  void RemoveObserver(Observer* observer);
+
+  // Can be called from any thread.
+  void Emit(const std::string& method, const base::DictionaryValue& params);
+  void Count(Counter counter, int64_t delta);
+
+  // {"extensionMessagesSent": ..., ...}
+  std::unique_ptr<base::DictionaryValue> GetCounters() const;
+
+ private:
+  friend class base::NoDestructor<XWalkRuntimeInternals>;
+
+  XWalkRuntimeInternals();
+  ~XWalkRuntimeInternals();
+
+  static base::subtle::Atomic32 observer_count_;
+
+  scoped_refptr<base::ObserverListThreadSafe<Observer>> observers_;
+  std::atomic<int64_t> counters_[kCounterCount];
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkRuntimeInternals);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_COMMON_XWALK_RUNTIME_INTERNALS_H_
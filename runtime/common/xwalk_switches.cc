@@ -10,15 +10,48 @@ namespace switches {
 // Specifies the icon file for the app window.
 const char kAppIcon[] = "app-icon";
 
+// Buffers log messages per thread and writes them to disk from a background
+// thread in a binary format, see runtime/common/async_log_backend.h. Only has
+// an effect when logging to a file. Use tools/xlog_decoder to read the logs.
+const char kAsyncLogging[] = "async-logging";
+
+// Size budget of the V8 generated code cache in bytes. 0 lets disk_cache pick
+// one based on the free disk space.
+const char kCodeCacheSize[] = "code-cache-size";
+
+// Turns off the V8 generated code cache, see
+// runtime/browser/xwalk_code_cache.h.
+const char kDisableCodeCache[] = "disable-code-cache";
+
 // Disables the usage of Portable Native Client.
 const char kDisablePnacl[] = "disable-pnacl";
 
 // Forces the maximum disk space to be used by the disk cache, in bytes.
 const char kDiskCacheSize[] = "disk-cache-size";
 
+// Writes the browser process IPC accounting table, see
+// runtime/common/xwalk_ipc_accounting.h, as JSON to the given file at
+// shutdown.
+const char kDumpIPCStats[] = "dump-ipc-stats";
+
+// Stamps the runtime's own IPC messages with their send time so
+// runtime/common/xwalk_ipc_accounting.h also records dispatch latency.
+// Passed on to child processes.
+const char kEnableIPCLatency[] = "enable-ipc-latency";
+
+// Keeps the :visited link table in the profile directory across launches.
+// It is cleared when the zone changes and when XWalkBrowsingDataRemover
+// removes history.
+const char kEnableVisitedLinkPersistence[] =
+    "enable-visited-link-persistence";
+
 // Enable all the experimental features in XWalk.
 const char kExperimentalFeatures[] = "enable-xwalk-experimental-features";
 
+// Serves the IPC accounting tables of the browser and render processes as
+// JSON on http://127.0.0.1:<port>/ipc.
+const char kIPCStatsPort[] = "ipc-stats-port";
+
 // List the command lines feature flags.
 const char kListFeaturesFlags[] = "list-features-flags";
 
@@ -12,9 +12,16 @@
 namespace switches {
 
 extern const char kAppIcon[];
+extern const char kAsyncLogging[];
+extern const char kCodeCacheSize[];
+extern const char kDisableCodeCache[];
 extern const char kDisablePnacl[];
 extern const char kDiskCacheSize[];
+extern const char kDumpIPCStats[];
+extern const char kEnableIPCLatency[];
+extern const char kEnableVisitedLinkPersistence[];
 extern const char kExperimentalFeatures[];
+extern const char kIPCStatsPort[];
 extern const char kListFeaturesFlags[];
 extern const char kXWalkAllowExternalExtensionsForRemoteSources[];
 extern const char kXWalkDataPath[];
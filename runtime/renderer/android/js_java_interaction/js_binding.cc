@@ -5,12 +5,14 @@
 #include "xwalk/runtime/renderer/android/js_java_interaction/js_binding.h"
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "base/strings/string_util.h"
 #include "content/public/renderer/render_frame.h"
 #include "gin/handle.h"
 #include "gin/object_template_builder.h"
+#include "mojo/public/cpp/base/big_buffer.h"
 #include "services/service_manager/public/cpp/interface_provider.h"
 #include "third_party/blink/public/common/associated_interfaces/associated_interface_provider.h"
 #include "third_party/blink/public/common/messaging/message_port_channel.h"
@@ -23,6 +25,39 @@
 
 namespace {
 constexpr char kPostMessage[] = "postMessage";
+
+// Converts the first postMessage() argument into a mojo payload. Strings are
+// kept as strings, ArrayBuffers and ArrayBufferViews (typed arrays, DataView)
+// are copied once into a BigBuffer, which switches to shared memory for large
+// payloads. Returns nullptr for any other type.
+xwalk::mojom::JsMessagePayloadPtr ToJsMessagePayload(v8::Isolate* isolate, v8::Local<v8::Value> value) {
+  if (value->IsString()) {
+    std::string message;
+    if (!gin::ConvertFromV8(isolate, value, &message))
+      return nullptr;
+    return xwalk::mojom::JsMessagePayload::NewStringValue(message);
+  }
+
+  if (value->IsArrayBuffer()) {
+    v8::Local<v8::ArrayBuffer> array_buffer = value.As<v8::ArrayBuffer>();
+    const uint8_t* data = static_cast<const uint8_t*>(array_buffer->GetContents().Data());
+    return xwalk::mojom::JsMessagePayload::NewArrayBufferValue(
+        mojo_base::BigBuffer(base::make_span(data, array_buffer->ByteLength())));
+  }
+
+  if (value->IsArrayBufferView()) {
+    v8::Local<v8::ArrayBufferView> view = value.As<v8::ArrayBufferView>();
+    size_t length = view->ByteLength();
+    // CopyContents() avoids materializing the backing store of on-heap typed
+    // arrays, so small views are not externalized just to be posted.
+    mojo_base::BigBuffer buffer(length);
+    if (length)
+      view->CopyContents(buffer.data(), length);
+    return xwalk::mojom::JsMessagePayload::NewArrayBufferValue(std::move(buffer));
+  }
+
+  return nullptr;
+}
 }  // anonymous namespace
 
 namespace xwalk {
@@ -62,12 +97,18 @@ gin::ObjectTemplateBuilder JsBinding::GetObjectTemplateBuilder(v8::Isolate* isol
 }
 
 void JsBinding::PostMessage(gin::Arguments* args) {
-  std::string message;
-  if (!args->GetNext(&message)) {
+  v8::Local<v8::Value> value;
+  if (!args->GetNext(&value)) {
     args->ThrowError();
     return;
   }
 
+  mojom::JsMessagePayloadPtr message = ToJsMessagePayload(args->isolate(), value);
+  if (!message) {
+    args->ThrowTypeError("message must be a string, an ArrayBuffer or an ArrayBufferView");
+    return;
+  }
+
   std::vector<blink::MessagePortChannel> ports;
   std::vector<v8::Local<v8::Object>> objs;
   // If we get more than two arguments and the second argument is not an array
@@ -92,7 +133,7 @@ void JsBinding::PostMessage(gin::Arguments* args) {
     render_frame_->GetRemoteAssociatedInterfaces()->GetInterface(&js_api_handler_);
   }
 
-  js_api_handler_->PostMessage(message, blink::MessagePortChannel::ReleaseHandles(ports));
+  js_api_handler_->PostMessage(std::move(message), blink::MessagePortChannel::ReleaseHandles(ports));
 }
 
 }  // namespace xwalk
@@ -37,7 +37,8 @@ class JsBinding : public gin::Wrappable<JsBinding> {
   // gin::Wrappable implementation
   gin::ObjectTemplateBuilder GetObjectTemplateBuilder(v8::Isolate* isolate) final;
 
-  // For jsObject.postMessage(message[, ports]) JavaScript API.
+  // For jsObject.postMessage(message[, ports]) JavaScript API. |message| is
+  // either a string or an ArrayBuffer/ArrayBufferView.
   void PostMessage(gin::Arguments* args);
 
   content::RenderFrame* render_frame_;
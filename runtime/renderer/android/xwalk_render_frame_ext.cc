@@ -12,8 +12,6 @@
 
 #include "base/bind.h"
 #include "base/lazy_instance.h"
-#include "base/strings/string_piece.h"
-#include "base/strings/utf_string_conversions.h"
 #include "components/autofill/content/renderer/autofill_agent.h"
 #include "components/autofill/content/renderer/password_autofill_agent.h"
 #include "content/public/common/url_constants.h"
@@ -32,11 +30,9 @@
 #include "third_party/blink/public/web/web_meaningful_layout.h"
 #include "third_party/blink/public/web/web_node.h"
 #include "third_party/blink/public/web/web_view.h"
-#include "url/url_canon.h"
-#include "url/url_constants.h"
-#include "url/url_util.h"
-#include "xwalk/runtime/common/android/xwalk_hit_test_data.h"
 #include "xwalk/runtime/common/android/xwalk_render_view_messages.h"
+#include "xwalk/runtime/common/android/xwalk_view_ipc_names.h"
+#include "xwalk/runtime/common/xwalk_ipc_accounting.h"
 
 #include "meta_logging.h"
 
@@ -44,28 +40,6 @@ namespace xwalk {
 
 namespace {
 
-const char kAddressPrefix[] = "geo:0,0?q=";
-const char kEmailPrefix[] = "mailto:";
-const char kPhoneNumberPrefix[] = "tel:";
-
-
-GURL GetAbsoluteUrl(const blink::WebElement& element,
-                    const base::string16& url_fragment) {
-  return GURL(element.GetDocument().CompleteURL(blink::WebString::FromUTF16(url_fragment)));
-}
-
-base::string16 GetHref(const blink::WebElement& element) {
-  // Get the actual 'href' attribute, which might relative if valid or can
-  // possibly contain garbage otherwise, so not using absoluteLinkURL here.
-  return element.GetAttribute("href").Utf16();
-}
-
-GURL GetAbsoluteSrcUrl(const blink::WebElement& element) {
-  if (element.IsNull())
-    return GURL();
-  return GetAbsoluteUrl(element, element.GetAttribute("src").Utf16());
-}
-
 blink::WebElement GetImgChild(const blink::WebNode& node) {
   // This implementation is incomplete (for example if is an area tag) but
   // matches the original WebViewClassic implementation.
@@ -75,83 +49,6 @@ blink::WebElement GetImgChild(const blink::WebNode& node) {
   return collection.FirstItem();
 }
 
-GURL GetChildImageUrlFromElement(const blink::WebElement& element) {
-  const blink::WebElement child_img = GetImgChild(element);
-  if (child_img.IsNull())
-    return GURL();
-  return GetAbsoluteSrcUrl(child_img);
-}
-
-bool RemovePrefixAndAssignIfMatches(const base::StringPiece& prefix,
-                                    const GURL& url,
-                                    std::string* dest) {
-  const base::StringPiece spec(url.possibly_invalid_spec());
-
-  if (spec.starts_with(prefix)) {
-    url::RawCanonOutputW<1024> output;
-    url::DecodeURLEscapeSequences(spec.data() + prefix.length(),
-                                  spec.length() - prefix.length(),
-                                  url::DecodeURLMode::kUTF8OrIsomorphic,&output);
-    *dest =
-        base::UTF16ToUTF8(base::StringPiece16(output.data(), output.length()));
-    return true;
-  }
-  return false;
-}
-
-void DistinguishAndAssignSrcLinkType(const GURL& url, XWalkHitTestData* data) {
-  if (RemovePrefixAndAssignIfMatches(kAddressPrefix, url,
-                                     &data->extra_data_for_type)) {
-    data->type = XWalkHitTestData::GEO_TYPE;
-  } else if (RemovePrefixAndAssignIfMatches(kPhoneNumberPrefix, url,
-                                            &data->extra_data_for_type)) {
-    data->type = XWalkHitTestData::PHONE_TYPE;
-  } else if (RemovePrefixAndAssignIfMatches(kEmailPrefix, url,
-                                            &data->extra_data_for_type)) {
-    data->type = XWalkHitTestData::EMAIL_TYPE;
-  } else {
-    data->type = XWalkHitTestData::SRC_LINK_TYPE;
-    data->extra_data_for_type = url.possibly_invalid_spec();
-    if (!data->extra_data_for_type.empty()) {
-      data->href = base::UTF8ToUTF16(data->extra_data_for_type);
-    }
-  }
-}
-
-void PopulateHitTestData(const GURL& absolute_link_url,
-                         const GURL& absolute_image_url, bool is_editable,
-                         XWalkHitTestData* data) {
-  // Note: Using GURL::is_empty instead of GURL:is_valid due to the
-  // WebViewClassic allowing any kind of protocol which GURL::is_valid
-  // disallows. Similar reasons for using GURL::possibly_invalid_spec instead of
-  // GURL::spec.
-//  LOG(INFO) << __func__ << " absolute_link_url=" << absolute_link_url
-//      << " absolute_image_url=" << absolute_image_url;
-  if (!absolute_image_url.is_empty())
-    data->img_src = absolute_image_url;
-
-  const bool is_javascript_scheme = absolute_link_url.SchemeIs(
-      url::kJavaScriptScheme);
-  const bool has_link_url = !absolute_link_url.is_empty();
-  const bool has_image_url = !absolute_image_url.is_empty();
-
-  if (has_link_url && !has_image_url && !is_javascript_scheme) {
-    DistinguishAndAssignSrcLinkType(absolute_link_url, data);
-  } else if (has_link_url && has_image_url && !is_javascript_scheme) {
-    data->type = XWalkHitTestData::SRC_IMAGE_LINK_TYPE;
-    data->extra_data_for_type = data->img_src.possibly_invalid_spec();
-    if (absolute_link_url.is_valid()) {
-      data->href = base::UTF8ToUTF16(absolute_link_url.possibly_invalid_spec());
-    }
-  } else if (!has_link_url && has_image_url) {
-    data->type = XWalkHitTestData::IMAGE_TYPE;
-    data->extra_data_for_type = data->img_src.possibly_invalid_spec();
-  } else if (is_editable) {
-    data->type = XWalkHitTestData::EDIT_TEXT_TYPE;
-    DCHECK_EQ(data->extra_data_for_type.length(), 0u);
-  }
-}
-
 }  // namespace
 
 // Registry for RenderFrame => AwRenderFrameExt lookups
@@ -160,7 +57,12 @@ base::LazyInstance<FrameExtMap>::Leaky render_frame_ext_map =
     LAZY_INSTANCE_INITIALIZER;
 
 XWalkRenderFrameExt::XWalkRenderFrameExt(content::RenderFrame* render_frame)
-    : content::RenderFrameObserver(render_frame) {
+    : content::RenderFrameObserver(render_frame),
+      hit_test_engine_(render_frame,
+                       base::BindRepeating(&XWalkRenderFrameExt::SendHitTestData,
+                                           base::Unretained(this))) {
+  RegisterXWalkViewIPCNames();
+
   // TODO(sgurun) do not create a password autofill agent (change
   // autofill agent to store a weakptr).
   autofill::PasswordAutofillAgent* password_autofill_agent =
@@ -201,6 +103,9 @@ bool XWalkRenderFrameExt::OnAssociatedInterfaceRequestForFrame(const std::string
 //}
 
 bool XWalkRenderFrameExt::OnMessageReceived(const IPC::Message& message) {
+  if (IPC_MESSAGE_CLASS(message) == AndroidWebViewMsgStart)
+    XWalkIPCAccounting::GetInstance()->DidDispatch(message);
+
   bool handled = true;
   IPC_BEGIN_MESSAGE_MAP(XWalkRenderFrameExt, message)
     IPC_MESSAGE_HANDLER(XWalkViewMsg_DocumentHasImages,
@@ -212,6 +117,8 @@ bool XWalkRenderFrameExt::OnMessageReceived(const IPC::Message& message) {
     IPC_MESSAGE_HANDLER(XWalkViewMsg_SetInitialPageScale, OnSetInitialPageScale)
     IPC_MESSAGE_HANDLER(XWalkViewMsg_SetBackgroundColor, OnSetBackgroundColor)
     IPC_MESSAGE_HANDLER(XWalkViewMsg_SetTextZoomFactor, OnSetTextZoomFactor)
+    IPC_MESSAGE_HANDLER(XWalkViewMsg_HitTestDataAccepted,
+                        OnHitTestDataAccepted)
     //TODO missing ; see AwRederFrameExt
 //    IPC_MESSAGE_HANDLER(AwViewMsg_SmoothScroll, OnSmoothScroll)
     IPC_MESSAGE_UNHANDLED(handled = false)
@@ -219,6 +126,11 @@ bool XWalkRenderFrameExt::OnMessageReceived(const IPC::Message& message) {
   return handled;
 }
 
+bool XWalkRenderFrameExt::Send(IPC::Message* message) {
+  XWalkIPCAccounting::GetInstance()->WillSend(message);
+  return content::RenderFrameObserver::Send(message);
+}
+
 void XWalkRenderFrameExt::OnDocumentHasImagesRequest(uint32_t id) {
   blink::WebLocalFrame* frame = render_frame()->GetWebFrame();
 
@@ -243,6 +155,9 @@ void XWalkRenderFrameExt::DidCommitProvisionalLoad(bool is_same_document_navigat
     frame->GetDocument().GrantLoadLocalResources();
   }
 
+  if (!is_same_document_navigation)
+    hit_test_engine_.DidCommitNavigation();
+
   // Clear the cache when we cross site boundaries in the main frame.
   //
   // We're trying to approximate what happens with a multi-process Chromium,
@@ -263,23 +178,18 @@ void XWalkRenderFrameExt::FocusedElementChanged(const blink::WebElement& element
   if (element.IsNull() || !render_frame() || !render_frame()->GetRenderView())
     return;
 
-  XWalkHitTestData data;
-
-  data.href = GetHref(element);
-  data.anchor_text = element.TextContent().Utf16();
-
-  GURL absolute_link_url;
-  if (element.IsLink())
-    absolute_link_url = GetAbsoluteUrl(element, data.href);
-
-  GURL absolute_image_url = GetChildImageUrlFromElement(element);
+  hit_test_engine_.FocusedElementChanged(element);
+}
 
-  TENTA_LOG(INFO) << "iotto " << __func__ << " link=" << absolute_link_url << " IsContentEditable="
-                  << element.IsContentEditable();
+void XWalkRenderFrameExt::SendHitTestData(uint32_t sequence_number,
+                                          const XWalkHitTestData& data) {
+  TENTA_LOG(INFO) << "iotto " << __func__ << " hitTestDataType=" << data.type;
+  Send(new XWalkViewHostMsg_UpdateHitTestData(routing_id(), sequence_number,
+                                              data));
+}
 
-  PopulateHitTestData(absolute_link_url, absolute_image_url,
-                      element.IsEditable(), &data);
-  Send(new XWalkViewHostMsg_UpdateHitTestData(routing_id(), data));
+void XWalkRenderFrameExt::OnHitTestDataAccepted(uint32_t sequence_number) {
+  hit_test_engine_.HitTestDataAccepted(sequence_number);
 }
 
 void XWalkRenderFrameExt::OnDestruct() {
@@ -295,24 +205,7 @@ void XWalkRenderFrameExt::OnDoHitTest(const gfx::PointF& touch_center,
   const blink::WebHitTestResult result = webview->HitTestResultForTap(
       blink::WebPoint(touch_center.x(), touch_center.y()),
       blink::WebSize(touch_area.width(), touch_area.height()));
-  XWalkHitTestData data;
-
-  GURL absolute_image_url = result.AbsoluteImageURL();
-  if (!result.UrlElement().IsNull()) {
-    data.anchor_text = result.UrlElement().TextContent().Utf16();
-    data.href = GetHref(result.UrlElement());
-    // If we hit an image that failed to load, Blink won't give us its URL.
-    // Fall back to walking the DOM in this case.
-    if (absolute_image_url.is_empty()) {
-      absolute_image_url = GetChildImageUrlFromElement(result.UrlElement());
-    }
-  }
-
-  TENTA_LOG(INFO) << __func__ << " link=" << result.AbsoluteLinkURL() << " IsContentEditable="
-      << result.IsContentEditable();
-  PopulateHitTestData(result.AbsoluteLinkURL(), absolute_image_url,
-                      result.IsContentEditable(), &data);
-  Send(new XWalkViewHostMsg_UpdateHitTestData(routing_id(), data));
+  hit_test_engine_.HitTestResultAvailable(result);
 }
 
 void XWalkRenderFrameExt::OnSetTextZoomLevel(double zoom_level) {
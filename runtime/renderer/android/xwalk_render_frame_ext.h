@@ -18,6 +18,7 @@
 #include "ui/gfx/geometry/size_f.h"
 #include "url/origin.h"
 #include "third_party/skia/include/core/SkColor.h"
+#include "xwalk/runtime/renderer/xwalk_hit_test_engine.h"
 
 namespace blink {
 class WebFrameWidget;
@@ -39,12 +40,15 @@ class XWalkRenderFrameExt : public content::RenderFrameObserver {
   void DidCommitProvisionalLoad(bool is_same_document_navigation, ui::PageTransition transition) override;
 
   bool OnMessageReceived(const IPC::Message& message) override;
+  bool Send(IPC::Message* message) override;
   void FocusedElementChanged(const blink::WebElement& element) override;
   void OnDestruct() override;
 
   void OnDocumentHasImagesRequest(uint32_t id);
   void OnDoHitTest(const gfx::PointF& touch_center,
                    const gfx::SizeF& touch_area);
+  void SendHitTestData(uint32_t sequence_number, const XWalkHitTestData& data);
+  void OnHitTestDataAccepted(uint32_t sequence_number);
 
   void OnSetTextZoomLevel(double zoom_level);
   void OnSetTextZoomFactor(float zoom_factor);
@@ -62,6 +66,8 @@ class XWalkRenderFrameExt : public content::RenderFrameObserver {
 
   url::Origin last_origin_;
 
+  XWalkHitTestEngine hit_test_engine_;
+
   blink::AssociatedInterfaceRegistry registry_;
 
   DISALLOW_COPY_AND_ASSIGN(XWalkRenderFrameExt);
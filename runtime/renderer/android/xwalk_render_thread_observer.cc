@@ -7,6 +7,7 @@
 #include "base/json/json_reader.h"
 #include "base/values.h"
 #include "content/public/common/url_constants.h"
+#include "content/public/renderer/render_thread.h"
 #include "extensions/common/url_pattern.h"
 #include "ipc/ipc_message_macros.h"
 #include "third_party/blink/public/platform/web_cache.h"
@@ -14,6 +15,7 @@
 #include "third_party/blink/public/web/web_security_policy.h"
 #include "xwalk/runtime/browser/android/net/url_constants.h"
 #include "xwalk/runtime/common/android/xwalk_render_view_messages.h"
+#include "xwalk/runtime/common/xwalk_ipc_accounting.h"
 
 namespace xwalk {
 
@@ -31,6 +33,7 @@ bool XWalkRenderThreadObserver::OnControlMessageReceived(
     IPC_MESSAGE_HANDLER(XWalkViewMsg_ClearCache, OnClearCache);
     IPC_MESSAGE_HANDLER(XWalkViewMsg_SetOriginAccessWhitelist,
                         OnSetOriginAccessWhitelist)
+    IPC_MESSAGE_HANDLER(XWalkViewMsg_GetIPCStats, OnGetIPCStats)
     IPC_MESSAGE_UNHANDLED(handled = false)
   IPC_END_MESSAGE_MAP()
   return handled;
@@ -44,6 +47,11 @@ void XWalkRenderThreadObserver::OnClearCache() {
   blink::WebCache::Clear();
 }
 
+void XWalkRenderThreadObserver::OnGetIPCStats(int request_id) {
+  content::RenderThread::Get()->Send(new XWalkViewHostMsg_IPCStats(
+      request_id, XWalkIPCAccounting::GetInstance()->ToJSON()));
+}
+
 void XWalkRenderThreadObserver::OnSetOriginAccessWhitelist(
     std::string base_url,
     std::string match_patterns) {
@@ -28,6 +28,7 @@ class XWalkRenderThreadObserver : public content::RenderThreadObserver {
   void OnClearCache();
   void OnSetOriginAccessWhitelist(std::string base_url,
                                   std::string match_patterns);
+  void OnGetIPCStats(int request_id);
 };
 
 }  // namespace xwalk
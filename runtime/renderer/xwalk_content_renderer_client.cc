@@ -160,66 +160,6 @@ void XWalkContentRendererClient::RenderThreadStarted() {
 //        new extensions::XWalkExtensionRendererController(this));
 }
 
-#if defined(OS_ANDROID)
-bool XWalkContentRendererClient::HandleNavigation(
-    content::RenderFrame* render_frame,
-    bool is_content_initiated,
-    bool render_view_was_created_by_renderer,
-    blink::WebFrame* frame,
-    const blink::WebURLRequest& request,
-    blink::WebNavigationType type,
-    blink::WebNavigationPolicy default_policy,
-    bool is_redirect) {
-  TENTA_LOG_NET(INFO) << __func__ << " is_content_initiated=" << is_content_initiated
-                      << " render_view_was_created_by_renderer=" << render_view_was_created_by_renderer
-                      << " is_redirect=" << is_redirect << " type=" << type << " is_main_frame=" << !frame->Parent()
-                      << " url=" << request.Url();
-  // Only GETs can be overridden.
-  if (!request.HttpMethod().Equals("GET"))
-    return false;
-
-  // Any navigation from loadUrl, and goBack/Forward are considered application-
-  // initiated and hence will not yield a shouldOverrideUrlLoading() callback.
-  // Webview classic does not consider reload application-initiated so we
-  // continue the same behavior.
-  // TODO(sgurun) is_content_initiated is normally false for cross-origin
-  // navigations but since android_webview does not swap out renderers, this
-  // works fine. This will stop working if android_webview starts swapping out
-  // renderers on navigation.
-  bool application_initiated =
-      !is_content_initiated || type == blink::kWebNavigationTypeBackForward;
-
-  // Don't offer application-initiated navigations unless it's a redirect.
-  if (application_initiated && !is_redirect)
-    return false;
-  bool is_main_frame = !frame->Parent();
-  const GURL& gurl = request.Url();
-  // For HTTP schemes, only top-level navigations can be overridden. Similarly,
-  // WebView Classic lets app override only top level about:blank navigations.
-  // So we filter out non-top about:blank navigations here.
-  if (!is_main_frame &&
-      (gurl.SchemeIs(url::kHttpScheme) || gurl.SchemeIs(url::kHttpsScheme) ||
-       gurl.SchemeIs(url::kAboutScheme)))
-    return false;
-  // TODO(iotto) analyse how to replace opener_id with render_view_was_created_by_renderer
-
-  // use NavigationInterception throttle to handle the call as that can
-  // be deferred until after the java side has been constructed.
-//  if (opener_id != MSG_ROUTING_NONE)
-//    return false;
-
-  bool ignore_navigation = false;
-  base::string16 url = request.Url().GetString().Utf16();
-  bool has_user_gesture = request.HasUserGesture();
-
-  int render_frame_id = render_frame->GetRoutingID();
-  RenderThread::Get()->Send(new XWalkViewHostMsg_ShouldOverrideUrlLoading(
-      render_frame_id, url, has_user_gesture, is_redirect, is_main_frame,
-      &ignore_navigation));
-  return ignore_navigation;
-}
-#endif
-
 void XWalkContentRendererClient::RenderFrameCreated(
     content::RenderFrame* render_frame) {
 //  new XWalkFrameHelper(render_frame, extension_controller_.get());
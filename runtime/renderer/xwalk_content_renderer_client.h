@@ -69,13 +69,6 @@ class XWalkContentRendererClient :
   // the error html.
   bool HasErrorPage(int http_status_code) override;
 
-#if defined(OS_ANDROID)
-  bool HandleNavigation(content::RenderFrame* render_frame, bool is_content_initiated,
-                        bool render_view_was_created_by_renderer, blink::WebFrame* frame,
-                        const blink::WebURLRequest& request, blink::WebNavigationType type,
-                        blink::WebNavigationPolicy default_policy, bool is_redirect) override;
-#endif
-
  protected:
   std::unique_ptr<XWalkRenderThreadObserver> xwalk_render_thread_observer_;
 
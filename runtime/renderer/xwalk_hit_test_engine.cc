@@ -0,0 +1,305 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/runtime/renderer/xwalk_hit_test_engine.h"
+
+#include <map>
+
+#include "base/bind.h"
+#include "base/lazy_instance.h"
+#include "base/single_thread_task_runner.h"
+#include "base/strings/string_piece.h"
+#include "base/strings/utf_string_conversions.h"
+#include "base/time/time.h"
+#include "content/public/renderer/render_frame.h"
+#include "content/public/renderer/render_view.h"
+#include "third_party/blink/public/platform/task_type.h"
+#include "third_party/blink/public/web/web_document.h"
+#include "third_party/blink/public/web/web_element_collection.h"
+#include "third_party/blink/public/web/web_hit_test_result.h"
+#include "third_party/blink/public/web/web_local_frame.h"
+#include "third_party/blink/public/web/web_node.h"
+#include "url/url_canon.h"
+#include "url/url_constants.h"
+#include "url/url_util.h"
+
+namespace xwalk {
+
+namespace {
+
+const char kAddressPrefix[] = "geo:0,0?q=";
+const char kEmailPrefix[] = "mailto:";
+const char kPhoneNumberPrefix[] = "tel:";
+
+// One frame at 60 Hz. Tabbing through a form faster than this only reports
+// the element where focus ends up.
+constexpr base::TimeDelta kFocusUpdateDelay =
+    base::TimeDelta::FromMilliseconds(16);
+
+const size_t kLinkCacheSize = 64;
+
+// Last data sent per RenderView, shared by all frames of the view since the
+// browser keeps a single copy per WebContents. The browser ignores data from
+// frames outside its current frame tree, so the data only counts as held by
+// the browser once it has accepted it.
+struct LastSent {
+  XWalkHitTestData data;
+  uint32_t sequence_number = 0;
+  bool accepted = false;
+};
+typedef std::map<int, LastSent> LastSentMap;
+base::LazyInstance<LastSentMap>::Leaky g_last_sent = LAZY_INSTANCE_INITIALIZER;
+uint32_t g_next_sequence_number = 0;
+
+bool SameHitTestData(const XWalkHitTestData& a, const XWalkHitTestData& b) {
+  return a.type == b.type && a.extra_data_for_type == b.extra_data_for_type &&
+         a.href == b.href && a.anchor_text == b.anchor_text &&
+         a.img_src == b.img_src;
+}
+
+base::string16 GetHref(const blink::WebElement& element) {
+  // Get the actual 'href' attribute, which might relative if valid or can
+  // possibly contain garbage otherwise, so not using absoluteLinkURL here.
+  return element.GetAttribute("href").Utf16();
+}
+
+GURL GetAbsoluteUrl(const blink::WebElement& element,
+                    const base::string16& url_fragment) {
+  return GURL(element.GetDocument().CompleteURL(blink::WebString::FromUTF16(url_fragment)));
+}
+
+GURL GetAbsoluteSrcUrl(const blink::WebElement& element) {
+  if (element.IsNull())
+    return GURL();
+  return GetAbsoluteUrl(element, element.GetAttribute("src").Utf16());
+}
+
+blink::WebElement GetImgChild(const blink::WebNode& node) {
+  // This implementation is incomplete (for example if is an area tag) but
+  // matches the original WebViewClassic implementation.
+
+  blink::WebElementCollection collection = node.GetElementsByHTMLTagName("img");
+  DCHECK(!collection.IsNull());
+  return collection.FirstItem();
+}
+
+GURL GetChildImageUrlFromElement(const blink::WebElement& element) {
+  const blink::WebElement child_img = GetImgChild(element);
+  if (child_img.IsNull())
+    return GURL();
+  return GetAbsoluteSrcUrl(child_img);
+}
+
+bool RemovePrefixAndAssignIfMatches(const base::StringPiece& prefix,
+                                    const GURL& url,
+                                    std::string* dest) {
+  const base::StringPiece spec(url.possibly_invalid_spec());
+
+  if (spec.starts_with(prefix)) {
+    url::RawCanonOutputW<1024> output;
+    url::DecodeURLEscapeSequences(spec.data() + prefix.length(),
+                                  spec.length() - prefix.length(),
+                                  url::DecodeURLMode::kUTF8OrIsomorphic,&output);
+    *dest =
+        base::UTF16ToUTF8(base::StringPiece16(output.data(), output.length()));
+    return true;
+  }
+  return false;
+}
+
+void DistinguishAndAssignSrcLinkType(const GURL& url, XWalkHitTestData* data) {
+  if (RemovePrefixAndAssignIfMatches(kAddressPrefix, url,
+                                     &data->extra_data_for_type)) {
+    data->type = XWalkHitTestData::GEO_TYPE;
+  } else if (RemovePrefixAndAssignIfMatches(kPhoneNumberPrefix, url,
+                                            &data->extra_data_for_type)) {
+    data->type = XWalkHitTestData::PHONE_TYPE;
+  } else if (RemovePrefixAndAssignIfMatches(kEmailPrefix, url,
+                                            &data->extra_data_for_type)) {
+    data->type = XWalkHitTestData::EMAIL_TYPE;
+  } else {
+    data->type = XWalkHitTestData::SRC_LINK_TYPE;
+    data->extra_data_for_type = url.possibly_invalid_spec();
+    if (!data->extra_data_for_type.empty()) {
+      data->href = base::UTF8ToUTF16(data->extra_data_for_type);
+    }
+  }
+}
+
+}  // namespace
+
+XWalkHitTestEngine::XWalkHitTestEngine(content::RenderFrame* render_frame,
+                                       SendCallback send_callback)
+    : render_frame_(render_frame),
+      send_callback_(std::move(send_callback)),
+      view_routing_id_(render_frame->GetRenderView()->GetRoutingID()),
+      is_main_frame_(render_frame->IsMainFrame()),
+      focus_update_pending_(false),
+      resolved_links_(kLinkCacheSize),
+      link_classifications_(kLinkCacheSize),
+      weak_factory_(this) {}
+
+XWalkHitTestEngine::~XWalkHitTestEngine() {
+  // View routing ids are not reused, so a subframe reporting after this only
+  // leaves a harmless entry behind.
+  if (is_main_frame_)
+    g_last_sent.Get().erase(view_routing_id_);
+}
+
+void XWalkHitTestEngine::FocusedElementChanged(
+    const blink::WebElement& element) {
+  if (element.IsNull())
+    return;
+
+  pending_focus_ = element;
+  if (focus_update_pending_)
+    return;
+  focus_update_pending_ = true;
+  render_frame_->GetTaskRunner(blink::TaskType::kInternalDefault)
+      ->PostDelayedTask(FROM_HERE,
+                        base::BindOnce(&XWalkHitTestEngine::FlushFocusUpdate,
+                                       weak_factory_.GetWeakPtr()),
+                        kFocusUpdateDelay);
+}
+
+void XWalkHitTestEngine::HitTestResultAvailable(
+    const blink::WebHitTestResult& result) {
+  focus_update_pending_ = false;
+  pending_focus_.Reset();
+  weak_factory_.InvalidateWeakPtrs();
+
+  XWalkHitTestData data;
+
+  GURL absolute_image_url = result.AbsoluteImageURL();
+  if (!result.UrlElement().IsNull()) {
+    data.anchor_text = result.UrlElement().TextContent().Utf16();
+    data.href = GetHref(result.UrlElement());
+    // If we hit an image that failed to load, Blink won't give us its URL.
+    // Fall back to walking the DOM in this case.
+    if (absolute_image_url.is_empty()) {
+      absolute_image_url = GetChildImageUrlFromElement(result.UrlElement());
+    }
+  }
+
+  PopulateHitTestData(result.AbsoluteLinkURL(), absolute_image_url,
+                      result.IsContentEditable(), &data);
+  MaybeSend(data);
+}
+
+void XWalkHitTestEngine::DidCommitNavigation() {
+  focus_update_pending_ = false;
+  pending_focus_.Reset();
+  weak_factory_.InvalidateWeakPtrs();
+  resolved_links_.Clear();
+  link_classifications_.Clear();
+  // The next update after a commit always reaches the browser.
+  g_last_sent.Get().erase(view_routing_id_);
+}
+
+void XWalkHitTestEngine::HitTestDataAccepted(uint32_t sequence_number) {
+  LastSentMap& last_sent = g_last_sent.Get();
+  auto it = last_sent.find(view_routing_id_);
+  // An older acceptance says nothing about what the browser holds now.
+  if (it != last_sent.end() && it->second.sequence_number == sequence_number)
+    it->second.accepted = true;
+}
+
+void XWalkHitTestEngine::FlushFocusUpdate() {
+  focus_update_pending_ = false;
+  blink::WebElement element = pending_focus_;
+  pending_focus_.Reset();
+  if (element.IsNull() || !render_frame_->GetRenderView())
+    return;
+
+  XWalkHitTestData data;
+
+  data.href = GetHref(element);
+  data.anchor_text = element.TextContent().Utf16();
+
+  GURL absolute_link_url;
+  if (element.IsLink())
+    absolute_link_url = ResolveLink(element, data.href);
+
+  GURL absolute_image_url = GetChildImageUrlFromElement(element);
+
+  PopulateHitTestData(absolute_link_url, absolute_image_url,
+                      element.IsEditable(), &data);
+  MaybeSend(data);
+}
+
+void XWalkHitTestEngine::MaybeSend(const XWalkHitTestData& data) {
+  LastSentMap& last_sent = g_last_sent.Get();
+  auto it = last_sent.find(view_routing_id_);
+  if (it != last_sent.end() && it->second.accepted &&
+      SameHitTestData(it->second.data, data)) {
+    return;
+  }
+  LastSent& sent = last_sent[view_routing_id_];
+  sent.data = data;
+  sent.sequence_number = ++g_next_sequence_number;
+  sent.accepted = false;
+  send_callback_.Run(sent.sequence_number, data);
+}
+
+GURL XWalkHitTestEngine::ResolveLink(const blink::WebElement& element,
+                                     const base::string16& href) {
+  auto key = std::make_pair(GURL(element.GetDocument().BaseURL()), href);
+  auto it = resolved_links_.Get(key);
+  if (it != resolved_links_.end())
+    return it->second;
+  GURL url = GetAbsoluteUrl(element, href);
+  resolved_links_.Put(std::move(key), url);
+  return url;
+}
+
+void XWalkHitTestEngine::ClassifyLink(const GURL& url,
+                                      XWalkHitTestData* data) {
+  auto it = link_classifications_.Get(url);
+  if (it == link_classifications_.end()) {
+    XWalkHitTestData classified;
+    DistinguishAndAssignSrcLinkType(url, &classified);
+    LinkClassification classification = {
+        classified.type, classified.extra_data_for_type, classified.href};
+    it = link_classifications_.Put(url, std::move(classification));
+  }
+  data->type = it->second.type;
+  data->extra_data_for_type = it->second.extra_data_for_type;
+  if (!it->second.href.empty())
+    data->href = it->second.href;
+}
+
+void XWalkHitTestEngine::PopulateHitTestData(const GURL& absolute_link_url,
+                                             const GURL& absolute_image_url,
+                                             bool is_editable,
+                                             XWalkHitTestData* data) {
+  // Note: Using GURL::is_empty instead of GURL:is_valid due to the
+  // WebViewClassic allowing any kind of protocol which GURL::is_valid
+  // disallows. Similar reasons for using GURL::possibly_invalid_spec instead of
+  // GURL::spec.
+  if (!absolute_image_url.is_empty())
+    data->img_src = absolute_image_url;
+
+  const bool is_javascript_scheme = absolute_link_url.SchemeIs(
+      url::kJavaScriptScheme);
+  const bool has_link_url = !absolute_link_url.is_empty();
+  const bool has_image_url = !absolute_image_url.is_empty();
+
+  if (has_link_url && !has_image_url && !is_javascript_scheme) {
+    ClassifyLink(absolute_link_url, data);
+  } else if (has_link_url && has_image_url && !is_javascript_scheme) {
+    data->type = XWalkHitTestData::SRC_IMAGE_LINK_TYPE;
+    data->extra_data_for_type = data->img_src.possibly_invalid_spec();
+    if (absolute_link_url.is_valid()) {
+      data->href = base::UTF8ToUTF16(absolute_link_url.possibly_invalid_spec());
+    }
+  } else if (!has_link_url && has_image_url) {
+    data->type = XWalkHitTestData::IMAGE_TYPE;
+    data->extra_data_for_type = data->img_src.possibly_invalid_spec();
+  } else if (is_editable) {
+    data->type = XWalkHitTestData::EDIT_TEXT_TYPE;
+    DCHECK_EQ(data->extra_data_for_type.length(), 0u);
+  }
+}
+
+}  // namespace xwalk
@@ -0,0 +1,99 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_RUNTIME_RENDERER_XWALK_HIT_TEST_ENGINE_H_
+#define XWALK_RUNTIME_RENDERER_XWALK_HIT_TEST_ENGINE_H_
+
+#include <stdint.h>
+
+#include <utility>
+
+#include "base/callback.h"
+#include "base/containers/mru_cache.h"
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "base/strings/string16.h"
+#include "third_party/blink/public/web/web_element.h"
+#include "url/gurl.h"
+#include "xwalk/runtime/common/xwalk_hit_test_data.h"
+
+namespace blink {
+class WebHitTestResult;
+}
+
+namespace content {
+class RenderFrame;
+}
+
+namespace xwalk {
+
+// Builds the XWalkHitTestData of one frame from focus changes and tap hit
+// tests, and hands it to |send_callback|.
+//
+// Focus changes are coalesced: only the element focused last within one
+// animation frame is looked at. A result equal to the last one the browser
+// accepted for the same view, from any of its frames, is dropped since the
+// browser already holds it. Link URL resolution and classification are cached keyed by the
+// document base URL and the raw href, so a mutated element (or a new
+// document) simply misses the cache.
+class XWalkHitTestEngine {
+ public:
+  using SendCallback =
+      base::RepeatingCallback<void(uint32_t sequence_number,
+                                   const XWalkHitTestData&)>;
+
+  XWalkHitTestEngine(content::RenderFrame* render_frame,
+                     SendCallback send_callback);
+  ~XWalkHitTestEngine();
+
+  void FocusedElementChanged(const blink::WebElement& element);
+
+  // Tap results are sent right away, the browser is waiting for them. They
+  // supersede a focus update still pending.
+  void HitTestResultAvailable(const blink::WebHitTestResult& result);
+
+  // Drops pending work and cached data of the previous document.
+  void DidCommitNavigation();
+
+  // The browser kept the data sent with |sequence_number|.
+  void HitTestDataAccepted(uint32_t sequence_number);
+
+ private:
+  struct LinkClassification {
+    int type;
+    std::string extra_data_for_type;
+    base::string16 href;
+  };
+
+  void FlushFocusUpdate();
+  void MaybeSend(const XWalkHitTestData& data);
+
+  GURL ResolveLink(const blink::WebElement& element,
+                   const base::string16& href);
+  void ClassifyLink(const GURL& url, XWalkHitTestData* data);
+  void PopulateHitTestData(const GURL& absolute_link_url,
+                           const GURL& absolute_image_url,
+                           bool is_editable,
+                           XWalkHitTestData* data);
+
+  content::RenderFrame* render_frame_;
+  SendCallback send_callback_;
+  // Routing id of the frame's RenderView, keys the last data sent.
+  int view_routing_id_;
+  bool is_main_frame_;
+
+  blink::WebElement pending_focus_;
+  bool focus_update_pending_;
+
+  base::MRUCache<std::pair<GURL, base::string16>, GURL> resolved_links_;
+  base::MRUCache<GURL, LinkClassification> link_classifications_;
+
+  base::WeakPtrFactory<XWalkHitTestEngine> weak_factory_;
+
+  DISALLOW_COPY_AND_ASSIGN(XWalkHitTestEngine);
+};
+
+}  // namespace xwalk
+
+#endif  // XWALK_RUNTIME_RENDERER_XWALK_HIT_TEST_ENGINE_H_
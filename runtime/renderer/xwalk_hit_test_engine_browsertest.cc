@@ -0,0 +1,152 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/macros.h"
+#include "base/path_service.h"
+#include "base/run_loop.h"
+#include "base/strings/utf_string_conversions.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "base/time/time.h"
+#include "content/public/renderer/render_frame.h"
+#include "content/public/renderer/render_frame_observer.h"
+#include "content/public/test/render_view_test.h"
+#include "third_party/blink/public/web/web_element.h"
+#include "xwalk/runtime/common/xwalk_hit_test_data.h"
+#include "xwalk/runtime/renderer/xwalk_hit_test_engine.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+
+namespace xwalk {
+
+namespace {
+
+// Feeds focus changes to an XWalkHitTestEngine the way XWalkRenderFrameExt
+// does on Android. Every update the engine hands over is one
+// XWalkViewHostMsg_UpdateHitTestData there, so they are counted here.
+class HitTestFrameObserver : public content::RenderFrameObserver {
+ public:
+  explicit HitTestFrameObserver(content::RenderFrame* render_frame)
+      : content::RenderFrameObserver(render_frame),
+        engine_(render_frame,
+                base::BindRepeating(&HitTestFrameObserver::OnSend,
+                                    base::Unretained(this))) {}
+  ~HitTestFrameObserver() override {}
+
+  const std::vector<XWalkHitTestData>& sent() const { return sent_; }
+
+  // Runs until |count| updates were sent in total.
+  void WaitForSent(size_t count) {
+    if (sent_.size() >= count)
+      return;
+    wait_count_ = count;
+    base::RunLoop run_loop;
+    quit_ = run_loop.QuitClosure();
+    run_loop.Run();
+  }
+
+  // content::RenderFrameObserver implementation.
+  void FocusedElementChanged(const blink::WebElement& element) override {
+    if (!element.IsNull())
+      engine_.FocusedElementChanged(element);
+  }
+  void OnDestruct() override {}
+
+ private:
+  void OnSend(uint32_t sequence_number, const XWalkHitTestData& data) {
+    sent_.push_back(data);
+    // The browser keeps what it gets from the main frame.
+    engine_.HitTestDataAccepted(sequence_number);
+    if (quit_ && sent_.size() >= wait_count_)
+      std::move(quit_).Run();
+  }
+
+  XWalkHitTestEngine engine_;
+  std::vector<XWalkHitTestData> sent_;
+  size_t wait_count_ = 0;
+  base::OnceClosure quit_;
+
+  DISALLOW_COPY_AND_ASSIGN(HitTestFrameObserver);
+};
+
+// Gives a focus update that is still coalescing time to be sent.
+void RunFor(base::TimeDelta delay) {
+  base::RunLoop run_loop;
+  base::ThreadTaskRunnerHandle::Get()->PostDelayedTask(
+      FROM_HERE, run_loop.QuitClosure(), delay);
+  run_loop.Run();
+}
+
+}  // namespace
+
+// Runs the engine in a real render frame on platforms without the Android
+// view, where the renderer main thread is the test thread.
+class XWalkHitTestEngineTest : public content::RenderViewTest {
+ protected:
+  void SetUp() override {
+    content::RenderViewTest::SetUp();
+    base::FilePath path;
+    ASSERT_TRUE(base::PathService::Get(base::DIR_SOURCE_ROOT, &path));
+    std::string html;
+    ASSERT_TRUE(base::ReadFileToString(
+        path.AppendASCII("xwalk/test/data/hit_test_form.html"), &html));
+    observer_ = std::make_unique<HitTestFrameObserver>(GetMainRenderFrame());
+    LoadHTMLWithUrlOverride(html.c_str(),
+                            "http://example.com/hit_test_form.html");
+  }
+
+  void TearDown() override {
+    observer_.reset();
+    content::RenderViewTest::TearDown();
+  }
+
+  std::unique_ptr<HitTestFrameObserver> observer_;
+};
+
+// Tabs through a page with 200 form fields and links. Focus updates are
+// coalesced per frame, so one hit test IPC reaches the browser for all the
+// focus changes, and it describes where focus ended up.
+TEST_F(XWalkHitTestEngineTest, TabThroughForm) {
+  int focused = 0;
+  base::TimeTicks start = base::TimeTicks::Now();
+  ASSERT_TRUE(ExecuteJavaScriptAndReturnIntValue(
+      base::ASCIIToUTF16("focusAll()"), &focused));
+  double main_thread_us = (base::TimeTicks::Now() - start).InMicrosecondsF();
+  ASSERT_EQ(201, focused);
+
+  observer_->WaitForSent(1);
+  RunFor(base::TimeDelta::FromMilliseconds(100));
+  ASSERT_EQ(1u, observer_->sent().size());
+  const XWalkHitTestData& data = observer_->sent().back();
+  EXPECT_EQ(XWalkHitTestData::EMAIL_TYPE, data.type);
+  EXPECT_EQ("last@example.com", data.extra_data_for_type);
+  EXPECT_EQ(base::ASCIIToUTF16("mailto:last@example.com"), data.href);
+
+  XWalkBenchmark::ReportValue("hit_test_tab_through_form", "_focus_changes",
+                              "count", focused);
+  XWalkBenchmark::ReportValue("hit_test_tab_through_form", "_hit_test_ipcs",
+                              "count", observer_->sent().size());
+  // Time the renderer main thread took to move focus across the whole form.
+  XWalkBenchmark::Report(XWalkBenchmark::FromSamples(
+      "hit_test_tab_through_form", "_renderer_main_thread",
+      {main_thread_us}));
+}
+
+// Focusing the same link again, once its data was accepted, sends nothing.
+TEST_F(XWalkHitTestEngineTest, RefocusSendsNothing) {
+  ExecuteJavaScriptForTests("document.getElementById('last').focus();");
+  observer_->WaitForSent(1);
+  ExecuteJavaScriptForTests(
+      "document.getElementById('form').children[0].focus();"
+      "document.getElementById('last').focus();");
+  RunFor(base::TimeDelta::FromMilliseconds(100));
+  EXPECT_EQ(1u, observer_->sent().size());
+}
+
+}  // namespace xwalk
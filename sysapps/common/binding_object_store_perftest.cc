@@ -0,0 +1,101 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how long BindingObjectStore takes to route postMessageToObject to
+// one of many live objects.
+
+#include "xwalk/sysapps/common/binding_object_store.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/strings/string_number_conversions.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "xwalk/extensions/browser/xwalk_extension_function_handler.h"
+#include "xwalk/test/base/xwalk_benchmark.h"
+
+using xwalk::extensions::XWalkExtensionFunctionHandler;
+using xwalk::extensions::XWalkExtensionFunctionInfo;
+using xwalk::sysapps::BindingObject;
+using xwalk::sysapps::BindingObjectStore;
+
+namespace {
+
+void DummyCallback(std::unique_ptr<base::ListValue> result) {}
+
+class CountingObject : public BindingObject {
+ public:
+  explicit CountingObject(int* calls) : calls_(calls) {
+    handler_.Register("ping", base::Bind(&CountingObject::OnPing,
+                                         base::Unretained(this)));
+  }
+
+ private:
+  void OnPing(std::unique_ptr<XWalkExtensionFunctionInfo> info) {
+    ++*calls_;
+  }
+
+  int* calls_;
+};
+
+std::string ObjectId(int index) {
+  return "object" + base::NumberToString(index);
+}
+
+class BindingObjectStorePerfTest : public testing::Test {
+ protected:
+  BindingObjectStorePerfTest()
+      : handler_(nullptr), store_(&handler_), calls_(0), next_(0) {}
+
+  void RunBenchmark(int object_count, const std::string& story) {
+    object_count_ = object_count;
+    for (int i = 0; i < object_count; ++i) {
+      store_.AddBindingObject(ObjectId(i),
+                              std::make_unique<CountingObject>(&calls_));
+    }
+
+    XWalkBenchmark::Options options;
+    options.batch_size = 100;
+    XWalkBenchmark::Report(XWalkBenchmark::Run(
+        "binding_object_store_post_message", story, options,
+        base::BindRepeating(&BindingObjectStorePerfTest::PostToNextObject,
+                            base::Unretained(this))));
+    EXPECT_EQ((options.warmup + options.samples) * options.batch_size, calls_);
+  }
+
+  void PostToNextObject() {
+    std::unique_ptr<base::ListValue> arguments(new base::ListValue);
+    // Spread the lookups over the whole store.
+    next_ = (next_ + 7919) % object_count_;
+    arguments->AppendString(ObjectId(next_));
+    arguments->AppendString("ping");
+    arguments->Append(std::make_unique<base::ListValue>());
+
+    handler_.HandleFunction(std::make_unique<XWalkExtensionFunctionInfo>(
+        "postMessageToObject", std::move(arguments),
+        base::Bind(&DummyCallback)));
+  }
+
+  XWalkExtensionFunctionHandler handler_;
+  BindingObjectStore store_;
+  int calls_;
+  int object_count_;
+  int next_;
+};
+
+}  // namespace
+
+TEST_F(BindingObjectStorePerfTest, Objects10) {
+  RunBenchmark(10, "_10");
+}
+
+TEST_F(BindingObjectStorePerfTest, Objects1k) {
+  RunBenchmark(1000, "_1k");
+}
+
+TEST_F(BindingObjectStorePerfTest, Objects100k) {
+  RunBenchmark(100 * 1000, "_100k");
+}
@@ -0,0 +1,163 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/test/base/xwalk_benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <utility>
+
+#include "base/callback.h"
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/logging.h"
+#include "base/threading/thread_restrictions.h"
+#include "base/time/time.h"
+#include "base/values.h"
+#include "testing/perf/perf_test.h"
+
+namespace {
+
+const char kPerfResultsJson[] = "perf-results-json";
+
+// Nearest-rank percentile of an already sorted, non-empty sample: the
+// smallest value with at least |percentile| percent of the sample at or
+// below it.
+double Percentile(const std::vector<double>& sorted, double percentile) {
+  double rank = std::ceil(percentile / 100.0 * sorted.size()) - 1;
+  size_t index = static_cast<size_t>(std::max(rank, 0.0));
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+void AppendToJsonResults(std::unique_ptr<base::DictionaryValue> entry) {
+  const base::CommandLine& command_line =
+      *base::CommandLine::ForCurrentProcess();
+  if (!command_line.HasSwitch(kPerfResultsJson))
+    return;
+  base::FilePath path = command_line.GetSwitchValuePath(kPerfResultsJson);
+  base::ScopedAllowBlockingForTesting allow_blocking;
+
+  std::unique_ptr<base::ListValue> results;
+  std::string contents;
+  if (base::ReadFileToString(path, &contents)) {
+    results = base::ListValue::From(base::JSONReader::ReadDeprecated(contents));
+    LOG_IF(WARNING, !results) << "Replacing malformed " << path.value();
+  }
+  if (!results)
+    results.reset(new base::ListValue);
+
+  results->Append(std::move(entry));
+
+  std::string json;
+  base::JSONWriter::WriteWithOptions(
+      *results, base::JSONWriter::OPTIONS_PRETTY_PRINT, &json);
+  if (base::WriteFile(path, json.data(), json.size()) !=
+      static_cast<int>(json.size())) {
+    LOG(ERROR) << "Cannot write perf results to " << path.value();
+  }
+}
+
+}  // namespace
+
+XWalkBenchmark::Options::Options() : warmup(10), samples(1000), batch_size(1) {}
+
+XWalkBenchmark::Result::Result()
+    : count(0), mean(0), min(0), p50(0), p90(0), p99(0), p999(0), max(0) {}
+
+XWalkBenchmark::Result::Result(const Result& other) = default;
+
+XWalkBenchmark::Result::~Result() {}
+
+// static
+XWalkBenchmark::Result XWalkBenchmark::Run(
+    const std::string& name,
+    const std::string& story,
+    const Options& options,
+    const base::RepeatingClosure& operation) {
+  DCHECK_GT(options.batch_size, 0);
+  for (int i = 0; i < options.warmup * options.batch_size; ++i)
+    operation.Run();
+
+  std::vector<double> samples_us;
+  samples_us.reserve(options.samples);
+  for (int i = 0; i < options.samples; ++i) {
+    base::TimeTicks start = base::TimeTicks::Now();
+    for (int j = 0; j < options.batch_size; ++j)
+      operation.Run();
+    base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+    samples_us.push_back(elapsed.InMicrosecondsF() / options.batch_size);
+  }
+  return FromSamples(name, story, std::move(samples_us));
+}
+
+// static
+XWalkBenchmark::Result XWalkBenchmark::FromSamples(
+    const std::string& name,
+    const std::string& story,
+    std::vector<double> samples_us) {
+  Result result;
+  result.name = name;
+  result.story = story;
+  result.count = samples_us.size();
+  if (samples_us.empty())
+    return result;
+
+  std::sort(samples_us.begin(), samples_us.end());
+  double total = 0;
+  for (double sample : samples_us)
+    total += sample;
+  result.mean = total / samples_us.size();
+  result.min = samples_us.front();
+  result.p50 = Percentile(samples_us, 50);
+  result.p90 = Percentile(samples_us, 90);
+  result.p99 = Percentile(samples_us, 99);
+  result.p999 = Percentile(samples_us, 99.9);
+  result.max = samples_us.back();
+  return result;
+}
+
+// static
+void XWalkBenchmark::Report(const Result& result) {
+  perf_test::PrintResult(result.name, result.story, "mean", result.mean, "us",
+                         true);
+  perf_test::PrintResult(result.name, result.story, "p50", result.p50, "us",
+                         true);
+  perf_test::PrintResult(result.name, result.story, "p99", result.p99, "us",
+                         true);
+  perf_test::PrintResult(result.name, result.story, "max", result.max, "us",
+                         true);
+
+  std::unique_ptr<base::DictionaryValue> entry(new base::DictionaryValue);
+  entry->SetString("name", result.name);
+  entry->SetString("story", result.story);
+  entry->SetString("unit", "us");
+  entry->SetInteger("count", static_cast<int>(result.count));
+  entry->SetDouble("mean", result.mean);
+  entry->SetDouble("min", result.min);
+  entry->SetDouble("p50", result.p50);
+  entry->SetDouble("p90", result.p90);
+  entry->SetDouble("p99", result.p99);
+  entry->SetDouble("p999", result.p999);
+  entry->SetDouble("max", result.max);
+  AppendToJsonResults(std::move(entry));
+}
+
+// static
+void XWalkBenchmark::ReportValue(const std::string& name,
+                                 const std::string& story,
+                                 const std::string& unit,
+                                 double value) {
+  perf_test::PrintResult(name, story, "value", value, unit, true);
+
+  std::unique_ptr<base::DictionaryValue> entry(new base::DictionaryValue);
+  entry->SetString("name", name);
+  entry->SetString("story", story);
+  entry->SetString("unit", unit);
+  entry->SetDouble("value", value);
+  AppendToJsonResults(std::move(entry));
+}
@@ -0,0 +1,80 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_TEST_BASE_XWALK_BENCHMARK_H_
+#define XWALK_TEST_BASE_XWALK_BENCHMARK_H_
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "base/callback_forward.h"
+#include "base/macros.h"
+
+// Shared helpers for xwalk_perftests.
+//
+// A benchmark runs an operation a few times to warm up, then times a number
+// of samples and reports the distribution per operation in microseconds.
+// Measurements that are not latencies, such as sizes, counts or throughputs,
+// are reported as single values with their own unit. Results are printed in
+// the perf_test format and, when the binary runs with
+// --perf-results-json=<file>, appended to a JSON list in that file. Every
+// browser test runs in its own process, so the file is extended rather than
+// rewritten.
+class XWalkBenchmark {
+ public:
+  struct Options {
+    Options();
+
+    int warmup;
+    int samples;
+    // Operations timed together as one sample, for operations too short to
+    // be timed one at a time.
+    int batch_size;
+  };
+
+  struct Result {
+    Result();
+    Result(const Result& other);
+    ~Result();
+
+    std::string name;
+    std::string story;
+    size_t count;
+    double mean;
+    double min;
+    double p50;
+    double p90;
+    double p99;
+    double p999;
+    double max;
+  };
+
+  // Times |operation| as described by |options|.
+  static Result Run(const std::string& name,
+                    const std::string& story,
+                    const Options& options,
+                    const base::RepeatingClosure& operation);
+
+  // Builds a result from samples the caller timed itself, in microseconds
+  // per operation.
+  static Result FromSamples(const std::string& name,
+                            const std::string& story,
+                            std::vector<double> samples_us);
+
+  // Prints |result| and adds it to the JSON results, if requested.
+  static void Report(const Result& result);
+
+  // Same for a single measurement in |unit|.
+  static void ReportValue(const std::string& name,
+                          const std::string& story,
+                          const std::string& unit,
+                          double value);
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(XWalkBenchmark);
+};
+
+#endif  // XWALK_TEST_BASE_XWALK_BENCHMARK_H_
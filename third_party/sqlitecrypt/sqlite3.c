@@ -24,7 +24,7 @@
 #endif
 
 #define SQLITE_HAS_CODEC 1
-#define SQLITE_ENABLE_FTS3	1
+#define SQLITE_ENABLE_FTS3	1
 #define SQLITE_ENABLE_FTS3_PARENTHESIS	1
 
 /************** Begin file sqliteInt.h ***************************************/
@@ -5160,9 +5160,6 @@ SQLITE_API int SQLITE_STDCALL sqlite3_collation_needed16(
 /*
 ** Specify the key for an encrypted database.  This routine should be
 ** called right after sqlite3_open().
-**
-** The code to implement this API is not available in the public release
-** of SQLite.
 */
 SQLITE_API int SQLITE_STDCALL sqlite3_key(
   sqlite3 *db,                   /* Database to be rekeyed */
@@ -5175,12 +5172,11 @@ SQLITE_API int SQLITE_STDCALL sqlite3_key_v2(
 );
 
 /*
-** Change the key on an open database.  If the current database is not
-** encrypted, this routine will encrypt it.  If pNew==0 or nNew==0, the
-** database is decrypted.
-**
-** The code to implement this API is not available in the public release
-** of SQLite.
+** Change the key on an open database.  Pages are re-encrypted in a single
+** transaction, so an interrupted rekey leaves the database under the old
+** key.  An empty database without a key is encrypted; a non-empty plaintext
+** database cannot be encrypted in place, nor can an encrypted one be
+** decrypted.
 */
 SQLITE_API int SQLITE_STDCALL sqlite3_rekey(
   sqlite3 *db,                   /* Database to be rekeyed */
@@ -5199,6 +5195,20 @@ SQLITE_API int SQLITE_STDCALL sqlite3_rekey_v2(
 SQLITE_API void SQLITE_STDCALL sqlite3_activate_see(
   const char *zPassPhrase        /* Activation phrase */
 );
+
+/*
+** Configure the page codec.  The settings are process wide and apply to
+** databases keyed after the call:
+**
+** SQLITE_CODEC_CONFIG_KDF_ITER      PBKDF2 iterations used to turn a
+**                                   passphrase into a page key.
+** SQLITE_CODEC_CONFIG_CACHE_PAGES   Decrypted pages kept per database so
+**                                   pages read again from disk are not
+**                                   decrypted again.  0 disables the cache.
+*/
+SQLITE_API int SQLITE_STDCALL sqlite3_codec_config(int op, int iValue);
+#define SQLITE_CODEC_CONFIG_KDF_ITER     1
+#define SQLITE_CODEC_CONFIG_CACHE_PAGES  2
 #endif
 
 #ifdef SQLITE_ENABLE_CEROD
@@ -110390,13 +110400,6 @@ SQLITE_PRIVATE void sqlite3Pragma(
     goto pragma_out;
   }
 
-#ifdef SQLITE_HAS_CODEC
-  if (sqlite3StrICmp(zLeft, "lic") == 0 && zRight)    {
-	  sqlite3_rekey_v2(db, NULL, zRight, -1);
-	  goto pragma_out;
-  }
-#endif
-
   /* Locate the pragma in the lookup table */
   lwr = 0;
   upr = ArraySize(aPragmaNames)-1;
@@ -196852,2326 +196855,7 @@ static int sqlite3Fts5VocabInit(Fts5Global *pGlobal, sqlite3 *db){
 #endif /* !defined(SQLITE_CORE) || defined(SQLITE_ENABLE_FTS5) */
 
 /************** End of fts5.c ************************************************/
-//AES implementation by Robert Guan 
-// block size,it is always 4 in AES
-#define Nb 4
-
-//_AES_KEY_LENGTH_
-#define AES_KEY_128BIT  0
-#define AES_KEY_192BIT  1 
-#define AES_KEY_256BIT  2
-
-#define BLOCKBUFSZ  60
-
-
-typedef struct _AESContext_
-{
-	u32 AesEncKey[BLOCKBUFSZ];
-	u32 AesDecKey[BLOCKBUFSZ];
-	u32 iKeyLengthE;  // 128,192,256
-	u32 iKeyLengthD;  // 128,192,256
-} AESContext;
-
-#ifndef XOR2_MACRO
-#ifdef _WIN64
-#define XOR2_MACRO(a,b,c)	XOR2_64((u64 *) a , (u64 *) b ,(u64 *) c)
-extern void XOR2_64(u64 * src, u64 * src2, u64 * dest);
-#else
-#define XOR2_MACRO(a,b,c)	XOR2_32((u32 *) a , (u32 *) b ,(u32 *) c)
-extern void XOR2_32(u32 * src, u32 * src2, u32 * dest);
-#endif
-#endif  // end of XOR2_MACRO
-
-
-typedef struct _reg_ {
-	u8 al;
-	u8 ah;
-	u8 eal;
-	u8 eah;
-} regs;
-
-typedef struct _reg32_ {
-	u16 al;
-	u16 ah;
-} reg32;
-
-typedef struct _reg64_ {
-	u16 al;
-	u16 ah;
-	u32 ax2;
-} reg64;
-
-
-const u32 FSB[256] = {
-	0x00000063, 0x0000007C, 0x00000077, 0x0000007B, 0x000000F2, 0x0000006B, 0x0000006F, 0x000000C5,
-	0x00000030, 0x00000001, 0x00000067, 0x0000002B, 0x000000FE, 0x000000D7, 0x000000AB, 0x00000076,
-	0x000000CA, 0x00000082, 0x000000C9, 0x0000007D, 0x000000FA, 0x00000059, 0x00000047, 0x000000F0,
-	0x000000AD, 0x000000D4, 0x000000A2, 0x000000AF, 0x0000009C, 0x000000A4, 0x00000072, 0x000000C0,
-	0x000000B7, 0x000000FD, 0x00000093, 0x00000026, 0x00000036, 0x0000003F, 0x000000F7, 0x000000CC,
-	0x00000034, 0x000000A5, 0x000000E5, 0x000000F1, 0x00000071, 0x000000D8, 0x00000031, 0x00000015,
-	0x00000004, 0x000000C7, 0x00000023, 0x000000C3, 0x00000018, 0x00000096, 0x00000005, 0x0000009A,
-	0x00000007, 0x00000012, 0x00000080, 0x000000E2, 0x000000EB, 0x00000027, 0x000000B2, 0x00000075,
-	0x00000009, 0x00000083, 0x0000002C, 0x0000001A, 0x0000001B, 0x0000006E, 0x0000005A, 0x000000A0,
-	0x00000052, 0x0000003B, 0x000000D6, 0x000000B3, 0x00000029, 0x000000E3, 0x0000002F, 0x00000084,
-	0x00000053, 0x000000D1, 0x00000000, 0x000000ED, 0x00000020, 0x000000FC, 0x000000B1, 0x0000005B,
-	0x0000006A, 0x000000CB, 0x000000BE, 0x00000039, 0x0000004A, 0x0000004C, 0x00000058, 0x000000CF,
-	0x000000D0, 0x000000EF, 0x000000AA, 0x000000FB, 0x00000043, 0x0000004D, 0x00000033, 0x00000085,
-	0x00000045, 0x000000F9, 0x00000002, 0x0000007F, 0x00000050, 0x0000003C, 0x0000009F, 0x000000A8,
-	0x00000051, 0x000000A3, 0x00000040, 0x0000008F, 0x00000092, 0x0000009D, 0x00000038, 0x000000F5,
-	0x000000BC, 0x000000B6, 0x000000DA, 0x00000021, 0x00000010, 0x000000FF, 0x000000F3, 0x000000D2,
-	0x000000CD, 0x0000000C, 0x00000013, 0x000000EC, 0x0000005F, 0x00000097, 0x00000044, 0x00000017,
-	0x000000C4, 0x000000A7, 0x0000007E, 0x0000003D, 0x00000064, 0x0000005D, 0x00000019, 0x00000073,
-	0x00000060, 0x00000081, 0x0000004F, 0x000000DC, 0x00000022, 0x0000002A, 0x00000090, 0x00000088,
-	0x00000046, 0x000000EE, 0x000000B8, 0x00000014, 0x000000DE, 0x0000005E, 0x0000000B, 0x000000DB,
-	0x000000E0, 0x00000032, 0x0000003A, 0x0000000A, 0x00000049, 0x00000006, 0x00000024, 0x0000005C,
-	0x000000C2, 0x000000D3, 0x000000AC, 0x00000062, 0x00000091, 0x00000095, 0x000000E4, 0x00000079,
-	0x000000E7, 0x000000C8, 0x00000037, 0x0000006D, 0x0000008D, 0x000000D5, 0x0000004E, 0x000000A9,
-	0x0000006C, 0x00000056, 0x000000F4, 0x000000EA, 0x00000065, 0x0000007A, 0x000000AE, 0x00000008,
-	0x000000BA, 0x00000078, 0x00000025, 0x0000002E, 0x0000001C, 0x000000A6, 0x000000B4, 0x000000C6,
-	0x000000E8, 0x000000DD, 0x00000074, 0x0000001F, 0x0000004B, 0x000000BD, 0x0000008B, 0x0000008A,
-	0x00000070, 0x0000003E, 0x000000B5, 0x00000066, 0x00000048, 0x00000003, 0x000000F6, 0x0000000E,
-	0x00000061, 0x00000035, 0x00000057, 0x000000B9, 0x00000086, 0x000000C1, 0x0000001D, 0x0000009E,
-	0x000000E1, 0x000000F8, 0x00000098, 0x00000011, 0x00000069, 0x000000D9, 0x0000008E, 0x00000094,
-	0x0000009B, 0x0000001E, 0x00000087, 0x000000E9, 0x000000CE, 0x00000055, 0x00000028, 0x000000DF,
-	0x0000008C, 0x000000A1, 0x00000089, 0x0000000D, 0x000000BF, 0x000000E6, 0x00000042, 0x00000068,
-	0x00000041, 0x00000099, 0x0000002D, 0x0000000F, 0x000000B0, 0x00000054, 0x000000BB, 0x00000016
-};
-const u32 FSB_8[256] = {
-	0x00006300, 0x00007C00, 0x00007700, 0x00007B00, 0x0000F200, 0x00006B00, 0x00006F00, 0x0000C500,
-	0x00003000, 0x00000100, 0x00006700, 0x00002B00, 0x0000FE00, 0x0000D700, 0x0000AB00, 0x00007600,
-	0x0000CA00, 0x00008200, 0x0000C900, 0x00007D00, 0x0000FA00, 0x00005900, 0x00004700, 0x0000F000,
-	0x0000AD00, 0x0000D400, 0x0000A200, 0x0000AF00, 0x00009C00, 0x0000A400, 0x00007200, 0x0000C000,
-	0x0000B700, 0x0000FD00, 0x00009300, 0x00002600, 0x00003600, 0x00003F00, 0x0000F700, 0x0000CC00,
-	0x00003400, 0x0000A500, 0x0000E500, 0x0000F100, 0x00007100, 0x0000D800, 0x00003100, 0x00001500,
-	0x00000400, 0x0000C700, 0x00002300, 0x0000C300, 0x00001800, 0x00009600, 0x00000500, 0x00009A00,
-	0x00000700, 0x00001200, 0x00008000, 0x0000E200, 0x0000EB00, 0x00002700, 0x0000B200, 0x00007500,
-	0x00000900, 0x00008300, 0x00002C00, 0x00001A00, 0x00001B00, 0x00006E00, 0x00005A00, 0x0000A000,
-	0x00005200, 0x00003B00, 0x0000D600, 0x0000B300, 0x00002900, 0x0000E300, 0x00002F00, 0x00008400,
-	0x00005300, 0x0000D100, 0x00000000, 0x0000ED00, 0x00002000, 0x0000FC00, 0x0000B100, 0x00005B00,
-	0x00006A00, 0x0000CB00, 0x0000BE00, 0x00003900, 0x00004A00, 0x00004C00, 0x00005800, 0x0000CF00,
-	0x0000D000, 0x0000EF00, 0x0000AA00, 0x0000FB00, 0x00004300, 0x00004D00, 0x00003300, 0x00008500,
-	0x00004500, 0x0000F900, 0x00000200, 0x00007F00, 0x00005000, 0x00003C00, 0x00009F00, 0x0000A800,
-	0x00005100, 0x0000A300, 0x00004000, 0x00008F00, 0x00009200, 0x00009D00, 0x00003800, 0x0000F500,
-	0x0000BC00, 0x0000B600, 0x0000DA00, 0x00002100, 0x00001000, 0x0000FF00, 0x0000F300, 0x0000D200,
-	0x0000CD00, 0x00000C00, 0x00001300, 0x0000EC00, 0x00005F00, 0x00009700, 0x00004400, 0x00001700,
-	0x0000C400, 0x0000A700, 0x00007E00, 0x00003D00, 0x00006400, 0x00005D00, 0x00001900, 0x00007300,
-	0x00006000, 0x00008100, 0x00004F00, 0x0000DC00, 0x00002200, 0x00002A00, 0x00009000, 0x00008800,
-	0x00004600, 0x0000EE00, 0x0000B800, 0x00001400, 0x0000DE00, 0x00005E00, 0x00000B00, 0x0000DB00,
-	0x0000E000, 0x00003200, 0x00003A00, 0x00000A00, 0x00004900, 0x00000600, 0x00002400, 0x00005C00,
-	0x0000C200, 0x0000D300, 0x0000AC00, 0x00006200, 0x00009100, 0x00009500, 0x0000E400, 0x00007900,
-	0x0000E700, 0x0000C800, 0x00003700, 0x00006D00, 0x00008D00, 0x0000D500, 0x00004E00, 0x0000A900,
-	0x00006C00, 0x00005600, 0x0000F400, 0x0000EA00, 0x00006500, 0x00007A00, 0x0000AE00, 0x00000800,
-	0x0000BA00, 0x00007800, 0x00002500, 0x00002E00, 0x00001C00, 0x0000A600, 0x0000B400, 0x0000C600,
-	0x0000E800, 0x0000DD00, 0x00007400, 0x00001F00, 0x00004B00, 0x0000BD00, 0x00008B00, 0x00008A00,
-	0x00007000, 0x00003E00, 0x0000B500, 0x00006600, 0x00004800, 0x00000300, 0x0000F600, 0x00000E00,
-	0x00006100, 0x00003500, 0x00005700, 0x0000B900, 0x00008600, 0x0000C100, 0x00001D00, 0x00009E00,
-	0x0000E100, 0x0000F800, 0x00009800, 0x00001100, 0x00006900, 0x0000D900, 0x00008E00, 0x00009400,
-	0x00009B00, 0x00001E00, 0x00008700, 0x0000E900, 0x0000CE00, 0x00005500, 0x00002800, 0x0000DF00,
-	0x00008C00, 0x0000A100, 0x00008900, 0x00000D00, 0x0000BF00, 0x0000E600, 0x00004200, 0x00006800,
-	0x00004100, 0x00009900, 0x00002D00, 0x00000F00, 0x0000B000, 0x00005400, 0x0000BB00, 0x00001600
-};
-const u32 FSB_16[256] = {
-	0x00630000, 0x007C0000, 0x00770000, 0x007B0000, 0x00F20000, 0x006B0000, 0x006F0000, 0x00C50000,
-	0x00300000, 0x00010000, 0x00670000, 0x002B0000, 0x00FE0000, 0x00D70000, 0x00AB0000, 0x00760000,
-	0x00CA0000, 0x00820000, 0x00C90000, 0x007D0000, 0x00FA0000, 0x00590000, 0x00470000, 0x00F00000,
-	0x00AD0000, 0x00D40000, 0x00A20000, 0x00AF0000, 0x009C0000, 0x00A40000, 0x00720000, 0x00C00000,
-	0x00B70000, 0x00FD0000, 0x00930000, 0x00260000, 0x00360000, 0x003F0000, 0x00F70000, 0x00CC0000,
-	0x00340000, 0x00A50000, 0x00E50000, 0x00F10000, 0x00710000, 0x00D80000, 0x00310000, 0x00150000,
-	0x00040000, 0x00C70000, 0x00230000, 0x00C30000, 0x00180000, 0x00960000, 0x00050000, 0x009A0000,
-	0x00070000, 0x00120000, 0x00800000, 0x00E20000, 0x00EB0000, 0x00270000, 0x00B20000, 0x00750000,
-	0x00090000, 0x00830000, 0x002C0000, 0x001A0000, 0x001B0000, 0x006E0000, 0x005A0000, 0x00A00000,
-	0x00520000, 0x003B0000, 0x00D60000, 0x00B30000, 0x00290000, 0x00E30000, 0x002F0000, 0x00840000,
-	0x00530000, 0x00D10000, 0x00000000, 0x00ED0000, 0x00200000, 0x00FC0000, 0x00B10000, 0x005B0000,
-	0x006A0000, 0x00CB0000, 0x00BE0000, 0x00390000, 0x004A0000, 0x004C0000, 0x00580000, 0x00CF0000,
-	0x00D00000, 0x00EF0000, 0x00AA0000, 0x00FB0000, 0x00430000, 0x004D0000, 0x00330000, 0x00850000,
-	0x00450000, 0x00F90000, 0x00020000, 0x007F0000, 0x00500000, 0x003C0000, 0x009F0000, 0x00A80000,
-	0x00510000, 0x00A30000, 0x00400000, 0x008F0000, 0x00920000, 0x009D0000, 0x00380000, 0x00F50000,
-	0x00BC0000, 0x00B60000, 0x00DA0000, 0x00210000, 0x00100000, 0x00FF0000, 0x00F30000, 0x00D20000,
-	0x00CD0000, 0x000C0000, 0x00130000, 0x00EC0000, 0x005F0000, 0x00970000, 0x00440000, 0x00170000,
-	0x00C40000, 0x00A70000, 0x007E0000, 0x003D0000, 0x00640000, 0x005D0000, 0x00190000, 0x00730000,
-	0x00600000, 0x00810000, 0x004F0000, 0x00DC0000, 0x00220000, 0x002A0000, 0x00900000, 0x00880000,
-	0x00460000, 0x00EE0000, 0x00B80000, 0x00140000, 0x00DE0000, 0x005E0000, 0x000B0000, 0x00DB0000,
-	0x00E00000, 0x00320000, 0x003A0000, 0x000A0000, 0x00490000, 0x00060000, 0x00240000, 0x005C0000,
-	0x00C20000, 0x00D30000, 0x00AC0000, 0x00620000, 0x00910000, 0x00950000, 0x00E40000, 0x00790000,
-	0x00E70000, 0x00C80000, 0x00370000, 0x006D0000, 0x008D0000, 0x00D50000, 0x004E0000, 0x00A90000,
-	0x006C0000, 0x00560000, 0x00F40000, 0x00EA0000, 0x00650000, 0x007A0000, 0x00AE0000, 0x00080000,
-	0x00BA0000, 0x00780000, 0x00250000, 0x002E0000, 0x001C0000, 0x00A60000, 0x00B40000, 0x00C60000,
-	0x00E80000, 0x00DD0000, 0x00740000, 0x001F0000, 0x004B0000, 0x00BD0000, 0x008B0000, 0x008A0000,
-	0x00700000, 0x003E0000, 0x00B50000, 0x00660000, 0x00480000, 0x00030000, 0x00F60000, 0x000E0000,
-	0x00610000, 0x00350000, 0x00570000, 0x00B90000, 0x00860000, 0x00C10000, 0x001D0000, 0x009E0000,
-	0x00E10000, 0x00F80000, 0x00980000, 0x00110000, 0x00690000, 0x00D90000, 0x008E0000, 0x00940000,
-	0x009B0000, 0x001E0000, 0x00870000, 0x00E90000, 0x00CE0000, 0x00550000, 0x00280000, 0x00DF0000,
-	0x008C0000, 0x00A10000, 0x00890000, 0x000D0000, 0x00BF0000, 0x00E60000, 0x00420000, 0x00680000,
-	0x00410000, 0x00990000, 0x002D0000, 0x000F0000, 0x00B00000, 0x00540000, 0x00BB0000, 0x00160000
-};
-const u32 FSB_24[256] = {
-	0x63000000, 0x7C000000, 0x77000000, 0x7B000000, 0xF2000000, 0x6B000000, 0x6F000000, 0xC5000000,
-	0x30000000, 0x01000000, 0x67000000, 0x2B000000, 0xFE000000, 0xD7000000, 0xAB000000, 0x76000000,
-	0xCA000000, 0x82000000, 0xC9000000, 0x7D000000, 0xFA000000, 0x59000000, 0x47000000, 0xF0000000,
-	0xAD000000, 0xD4000000, 0xA2000000, 0xAF000000, 0x9C000000, 0xA4000000, 0x72000000, 0xC0000000,
-	0xB7000000, 0xFD000000, 0x93000000, 0x26000000, 0x36000000, 0x3F000000, 0xF7000000, 0xCC000000,
-	0x34000000, 0xA5000000, 0xE5000000, 0xF1000000, 0x71000000, 0xD8000000, 0x31000000, 0x15000000,
-	0x04000000, 0xC7000000, 0x23000000, 0xC3000000, 0x18000000, 0x96000000, 0x05000000, 0x9A000000,
-	0x07000000, 0x12000000, 0x80000000, 0xE2000000, 0xEB000000, 0x27000000, 0xB2000000, 0x75000000,
-	0x09000000, 0x83000000, 0x2C000000, 0x1A000000, 0x1B000000, 0x6E000000, 0x5A000000, 0xA0000000,
-	0x52000000, 0x3B000000, 0xD6000000, 0xB3000000, 0x29000000, 0xE3000000, 0x2F000000, 0x84000000,
-	0x53000000, 0xD1000000, 0x00000000, 0xED000000, 0x20000000, 0xFC000000, 0xB1000000, 0x5B000000,
-	0x6A000000, 0xCB000000, 0xBE000000, 0x39000000, 0x4A000000, 0x4C000000, 0x58000000, 0xCF000000,
-	0xD0000000, 0xEF000000, 0xAA000000, 0xFB000000, 0x43000000, 0x4D000000, 0x33000000, 0x85000000,
-	0x45000000, 0xF9000000, 0x02000000, 0x7F000000, 0x50000000, 0x3C000000, 0x9F000000, 0xA8000000,
-	0x51000000, 0xA3000000, 0x40000000, 0x8F000000, 0x92000000, 0x9D000000, 0x38000000, 0xF5000000,
-	0xBC000000, 0xB6000000, 0xDA000000, 0x21000000, 0x10000000, 0xFF000000, 0xF3000000, 0xD2000000,
-	0xCD000000, 0x0C000000, 0x13000000, 0xEC000000, 0x5F000000, 0x97000000, 0x44000000, 0x17000000,
-	0xC4000000, 0xA7000000, 0x7E000000, 0x3D000000, 0x64000000, 0x5D000000, 0x19000000, 0x73000000,
-	0x60000000, 0x81000000, 0x4F000000, 0xDC000000, 0x22000000, 0x2A000000, 0x90000000, 0x88000000,
-	0x46000000, 0xEE000000, 0xB8000000, 0x14000000, 0xDE000000, 0x5E000000, 0x0B000000, 0xDB000000,
-	0xE0000000, 0x32000000, 0x3A000000, 0x0A000000, 0x49000000, 0x06000000, 0x24000000, 0x5C000000,
-	0xC2000000, 0xD3000000, 0xAC000000, 0x62000000, 0x91000000, 0x95000000, 0xE4000000, 0x79000000,
-	0xE7000000, 0xC8000000, 0x37000000, 0x6D000000, 0x8D000000, 0xD5000000, 0x4E000000, 0xA9000000,
-	0x6C000000, 0x56000000, 0xF4000000, 0xEA000000, 0x65000000, 0x7A000000, 0xAE000000, 0x08000000,
-	0xBA000000, 0x78000000, 0x25000000, 0x2E000000, 0x1C000000, 0xA6000000, 0xB4000000, 0xC6000000,
-	0xE8000000, 0xDD000000, 0x74000000, 0x1F000000, 0x4B000000, 0xBD000000, 0x8B000000, 0x8A000000,
-	0x70000000, 0x3E000000, 0xB5000000, 0x66000000, 0x48000000, 0x03000000, 0xF6000000, 0x0E000000,
-	0x61000000, 0x35000000, 0x57000000, 0xB9000000, 0x86000000, 0xC1000000, 0x1D000000, 0x9E000000,
-	0xE1000000, 0xF8000000, 0x98000000, 0x11000000, 0x69000000, 0xD9000000, 0x8E000000, 0x94000000,
-	0x9B000000, 0x1E000000, 0x87000000, 0xE9000000, 0xCE000000, 0x55000000, 0x28000000, 0xDF000000,
-	0x8C000000, 0xA1000000, 0x89000000, 0x0D000000, 0xBF000000, 0xE6000000, 0x42000000, 0x68000000,
-	0x41000000, 0x99000000, 0x2D000000, 0x0F000000, 0xB0000000, 0x54000000, 0xBB000000, 0x16000000
-};
-const u32 RSb[256] = {
-	0x00000052, 0x00000009, 0x0000006A, 0x000000D5, 0x00000030, 0x00000036, 0x000000A5, 0x00000038,
-	0x000000BF, 0x00000040, 0x000000A3, 0x0000009E, 0x00000081, 0x000000F3, 0x000000D7, 0x000000FB,
-	0x0000007C, 0x000000E3, 0x00000039, 0x00000082, 0x0000009B, 0x0000002F, 0x000000FF, 0x00000087,
-	0x00000034, 0x0000008E, 0x00000043, 0x00000044, 0x000000C4, 0x000000DE, 0x000000E9, 0x000000CB,
-	0x00000054, 0x0000007B, 0x00000094, 0x00000032, 0x000000A6, 0x000000C2, 0x00000023, 0x0000003D,
-	0x000000EE, 0x0000004C, 0x00000095, 0x0000000B, 0x00000042, 0x000000FA, 0x000000C3, 0x0000004E,
-	0x00000008, 0x0000002E, 0x000000A1, 0x00000066, 0x00000028, 0x000000D9, 0x00000024, 0x000000B2,
-	0x00000076, 0x0000005B, 0x000000A2, 0x00000049, 0x0000006D, 0x0000008B, 0x000000D1, 0x00000025,
-	0x00000072, 0x000000F8, 0x000000F6, 0x00000064, 0x00000086, 0x00000068, 0x00000098, 0x00000016,
-	0x000000D4, 0x000000A4, 0x0000005C, 0x000000CC, 0x0000005D, 0x00000065, 0x000000B6, 0x00000092,
-	0x0000006C, 0x00000070, 0x00000048, 0x00000050, 0x000000FD, 0x000000ED, 0x000000B9, 0x000000DA,
-	0x0000005E, 0x00000015, 0x00000046, 0x00000057, 0x000000A7, 0x0000008D, 0x0000009D, 0x00000084,
-	0x00000090, 0x000000D8, 0x000000AB, 0x00000000, 0x0000008C, 0x000000BC, 0x000000D3, 0x0000000A,
-	0x000000F7, 0x000000E4, 0x00000058, 0x00000005, 0x000000B8, 0x000000B3, 0x00000045, 0x00000006,
-	0x000000D0, 0x0000002C, 0x0000001E, 0x0000008F, 0x000000CA, 0x0000003F, 0x0000000F, 0x00000002,
-	0x000000C1, 0x000000AF, 0x000000BD, 0x00000003, 0x00000001, 0x00000013, 0x0000008A, 0x0000006B,
-	0x0000003A, 0x00000091, 0x00000011, 0x00000041, 0x0000004F, 0x00000067, 0x000000DC, 0x000000EA,
-	0x00000097, 0x000000F2, 0x000000CF, 0x000000CE, 0x000000F0, 0x000000B4, 0x000000E6, 0x00000073,
-	0x00000096, 0x000000AC, 0x00000074, 0x00000022, 0x000000E7, 0x000000AD, 0x00000035, 0x00000085,
-	0x000000E2, 0x000000F9, 0x00000037, 0x000000E8, 0x0000001C, 0x00000075, 0x000000DF, 0x0000006E,
-	0x00000047, 0x000000F1, 0x0000001A, 0x00000071, 0x0000001D, 0x00000029, 0x000000C5, 0x00000089,
-	0x0000006F, 0x000000B7, 0x00000062, 0x0000000E, 0x000000AA, 0x00000018, 0x000000BE, 0x0000001B,
-	0x000000FC, 0x00000056, 0x0000003E, 0x0000004B, 0x000000C6, 0x000000D2, 0x00000079, 0x00000020,
-	0x0000009A, 0x000000DB, 0x000000C0, 0x000000FE, 0x00000078, 0x000000CD, 0x0000005A, 0x000000F4,
-	0x0000001F, 0x000000DD, 0x000000A8, 0x00000033, 0x00000088, 0x00000007, 0x000000C7, 0x00000031,
-	0x000000B1, 0x00000012, 0x00000010, 0x00000059, 0x00000027, 0x00000080, 0x000000EC, 0x0000005F,
-	0x00000060, 0x00000051, 0x0000007F, 0x000000A9, 0x00000019, 0x000000B5, 0x0000004A, 0x0000000D,
-	0x0000002D, 0x000000E5, 0x0000007A, 0x0000009F, 0x00000093, 0x000000C9, 0x0000009C, 0x000000EF,
-	0x000000A0, 0x000000E0, 0x0000003B, 0x0000004D, 0x000000AE, 0x0000002A, 0x000000F5, 0x000000B0,
-	0x000000C8, 0x000000EB, 0x000000BB, 0x0000003C, 0x00000083, 0x00000053, 0x00000099, 0x00000061,
-	0x00000017, 0x0000002B, 0x00000004, 0x0000007E, 0x000000BA, 0x00000077, 0x000000D6, 0x00000026,
-	0x000000E1, 0x00000069, 0x00000014, 0x00000063, 0x00000055, 0x00000021, 0x0000000C, 0x0000007D
-};
-const u32 RSb_8[256] = {
-	0x00005200, 0x00000900, 0x00006A00, 0x0000D500, 0x00003000, 0x00003600, 0x0000A500, 0x00003800,
-	0x0000BF00, 0x00004000, 0x0000A300, 0x00009E00, 0x00008100, 0x0000F300, 0x0000D700, 0x0000FB00,
-	0x00007C00, 0x0000E300, 0x00003900, 0x00008200, 0x00009B00, 0x00002F00, 0x0000FF00, 0x00008700,
-	0x00003400, 0x00008E00, 0x00004300, 0x00004400, 0x0000C400, 0x0000DE00, 0x0000E900, 0x0000CB00,
-	0x00005400, 0x00007B00, 0x00009400, 0x00003200, 0x0000A600, 0x0000C200, 0x00002300, 0x00003D00,
-	0x0000EE00, 0x00004C00, 0x00009500, 0x00000B00, 0x00004200, 0x0000FA00, 0x0000C300, 0x00004E00,
-	0x00000800, 0x00002E00, 0x0000A100, 0x00006600, 0x00002800, 0x0000D900, 0x00002400, 0x0000B200,
-	0x00007600, 0x00005B00, 0x0000A200, 0x00004900, 0x00006D00, 0x00008B00, 0x0000D100, 0x00002500,
-	0x00007200, 0x0000F800, 0x0000F600, 0x00006400, 0x00008600, 0x00006800, 0x00009800, 0x00001600,
-	0x0000D400, 0x0000A400, 0x00005C00, 0x0000CC00, 0x00005D00, 0x00006500, 0x0000B600, 0x00009200,
-	0x00006C00, 0x00007000, 0x00004800, 0x00005000, 0x0000FD00, 0x0000ED00, 0x0000B900, 0x0000DA00,
-	0x00005E00, 0x00001500, 0x00004600, 0x00005700, 0x0000A700, 0x00008D00, 0x00009D00, 0x00008400,
-	0x00009000, 0x0000D800, 0x0000AB00, 0x00000000, 0x00008C00, 0x0000BC00, 0x0000D300, 0x00000A00,
-	0x0000F700, 0x0000E400, 0x00005800, 0x00000500, 0x0000B800, 0x0000B300, 0x00004500, 0x00000600,
-	0x0000D000, 0x00002C00, 0x00001E00, 0x00008F00, 0x0000CA00, 0x00003F00, 0x00000F00, 0x00000200,
-	0x0000C100, 0x0000AF00, 0x0000BD00, 0x00000300, 0x00000100, 0x00001300, 0x00008A00, 0x00006B00,
-	0x00003A00, 0x00009100, 0x00001100, 0x00004100, 0x00004F00, 0x00006700, 0x0000DC00, 0x0000EA00,
-	0x00009700, 0x0000F200, 0x0000CF00, 0x0000CE00, 0x0000F000, 0x0000B400, 0x0000E600, 0x00007300,
-	0x00009600, 0x0000AC00, 0x00007400, 0x00002200, 0x0000E700, 0x0000AD00, 0x00003500, 0x00008500,
-	0x0000E200, 0x0000F900, 0x00003700, 0x0000E800, 0x00001C00, 0x00007500, 0x0000DF00, 0x00006E00,
-	0x00004700, 0x0000F100, 0x00001A00, 0x00007100, 0x00001D00, 0x00002900, 0x0000C500, 0x00008900,
-	0x00006F00, 0x0000B700, 0x00006200, 0x00000E00, 0x0000AA00, 0x00001800, 0x0000BE00, 0x00001B00,
-	0x0000FC00, 0x00005600, 0x00003E00, 0x00004B00, 0x0000C600, 0x0000D200, 0x00007900, 0x00002000,
-	0x00009A00, 0x0000DB00, 0x0000C000, 0x0000FE00, 0x00007800, 0x0000CD00, 0x00005A00, 0x0000F400,
-	0x00001F00, 0x0000DD00, 0x0000A800, 0x00003300, 0x00008800, 0x00000700, 0x0000C700, 0x00003100,
-	0x0000B100, 0x00001200, 0x00001000, 0x00005900, 0x00002700, 0x00008000, 0x0000EC00, 0x00005F00,
-	0x00006000, 0x00005100, 0x00007F00, 0x0000A900, 0x00001900, 0x0000B500, 0x00004A00, 0x00000D00,
-	0x00002D00, 0x0000E500, 0x00007A00, 0x00009F00, 0x00009300, 0x0000C900, 0x00009C00, 0x0000EF00,
-	0x0000A000, 0x0000E000, 0x00003B00, 0x00004D00, 0x0000AE00, 0x00002A00, 0x0000F500, 0x0000B000,
-	0x0000C800, 0x0000EB00, 0x0000BB00, 0x00003C00, 0x00008300, 0x00005300, 0x00009900, 0x00006100,
-	0x00001700, 0x00002B00, 0x00000400, 0x00007E00, 0x0000BA00, 0x00007700, 0x0000D600, 0x00002600,
-	0x0000E100, 0x00006900, 0x00001400, 0x00006300, 0x00005500, 0x00002100, 0x00000C00, 0x00007D00
-};
-const u32 RSb_16[256] = {
-	0x00520000, 0x00090000, 0x006A0000, 0x00D50000, 0x00300000, 0x00360000, 0x00A50000, 0x00380000,
-	0x00BF0000, 0x00400000, 0x00A30000, 0x009E0000, 0x00810000, 0x00F30000, 0x00D70000, 0x00FB0000,
-	0x007C0000, 0x00E30000, 0x00390000, 0x00820000, 0x009B0000, 0x002F0000, 0x00FF0000, 0x00870000,
-	0x00340000, 0x008E0000, 0x00430000, 0x00440000, 0x00C40000, 0x00DE0000, 0x00E90000, 0x00CB0000,
-	0x00540000, 0x007B0000, 0x00940000, 0x00320000, 0x00A60000, 0x00C20000, 0x00230000, 0x003D0000,
-	0x00EE0000, 0x004C0000, 0x00950000, 0x000B0000, 0x00420000, 0x00FA0000, 0x00C30000, 0x004E0000,
-	0x00080000, 0x002E0000, 0x00A10000, 0x00660000, 0x00280000, 0x00D90000, 0x00240000, 0x00B20000,
-	0x00760000, 0x005B0000, 0x00A20000, 0x00490000, 0x006D0000, 0x008B0000, 0x00D10000, 0x00250000,
-	0x00720000, 0x00F80000, 0x00F60000, 0x00640000, 0x00860000, 0x00680000, 0x00980000, 0x00160000,
-	0x00D40000, 0x00A40000, 0x005C0000, 0x00CC0000, 0x005D0000, 0x00650000, 0x00B60000, 0x00920000,
-	0x006C0000, 0x00700000, 0x00480000, 0x00500000, 0x00FD0000, 0x00ED0000, 0x00B90000, 0x00DA0000,
-	0x005E0000, 0x00150000, 0x00460000, 0x00570000, 0x00A70000, 0x008D0000, 0x009D0000, 0x00840000,
-	0x00900000, 0x00D80000, 0x00AB0000, 0x00000000, 0x008C0000, 0x00BC0000, 0x00D30000, 0x000A0000,
-	0x00F70000, 0x00E40000, 0x00580000, 0x00050000, 0x00B80000, 0x00B30000, 0x00450000, 0x00060000,
-	0x00D00000, 0x002C0000, 0x001E0000, 0x008F0000, 0x00CA0000, 0x003F0000, 0x000F0000, 0x00020000,
-	0x00C10000, 0x00AF0000, 0x00BD0000, 0x00030000, 0x00010000, 0x00130000, 0x008A0000, 0x006B0000,
-	0x003A0000, 0x00910000, 0x00110000, 0x00410000, 0x004F0000, 0x00670000, 0x00DC0000, 0x00EA0000,
-	0x00970000, 0x00F20000, 0x00CF0000, 0x00CE0000, 0x00F00000, 0x00B40000, 0x00E60000, 0x00730000,
-	0x00960000, 0x00AC0000, 0x00740000, 0x00220000, 0x00E70000, 0x00AD0000, 0x00350000, 0x00850000,
-	0x00E20000, 0x00F90000, 0x00370000, 0x00E80000, 0x001C0000, 0x00750000, 0x00DF0000, 0x006E0000,
-	0x00470000, 0x00F10000, 0x001A0000, 0x00710000, 0x001D0000, 0x00290000, 0x00C50000, 0x00890000,
-	0x006F0000, 0x00B70000, 0x00620000, 0x000E0000, 0x00AA0000, 0x00180000, 0x00BE0000, 0x001B0000,
-	0x00FC0000, 0x00560000, 0x003E0000, 0x004B0000, 0x00C60000, 0x00D20000, 0x00790000, 0x00200000,
-	0x009A0000, 0x00DB0000, 0x00C00000, 0x00FE0000, 0x00780000, 0x00CD0000, 0x005A0000, 0x00F40000,
-	0x001F0000, 0x00DD0000, 0x00A80000, 0x00330000, 0x00880000, 0x00070000, 0x00C70000, 0x00310000,
-	0x00B10000, 0x00120000, 0x00100000, 0x00590000, 0x00270000, 0x00800000, 0x00EC0000, 0x005F0000,
-	0x00600000, 0x00510000, 0x007F0000, 0x00A90000, 0x00190000, 0x00B50000, 0x004A0000, 0x000D0000,
-	0x002D0000, 0x00E50000, 0x007A0000, 0x009F0000, 0x00930000, 0x00C90000, 0x009C0000, 0x00EF0000,
-	0x00A00000, 0x00E00000, 0x003B0000, 0x004D0000, 0x00AE0000, 0x002A0000, 0x00F50000, 0x00B00000,
-	0x00C80000, 0x00EB0000, 0x00BB0000, 0x003C0000, 0x00830000, 0x00530000, 0x00990000, 0x00610000,
-	0x00170000, 0x002B0000, 0x00040000, 0x007E0000, 0x00BA0000, 0x00770000, 0x00D60000, 0x00260000,
-	0x00E10000, 0x00690000, 0x00140000, 0x00630000, 0x00550000, 0x00210000, 0x000C0000, 0x007D0000
-};
-const u32 RSb_24[256] = {
-	0x52000000, 0x09000000, 0x6A000000, 0xD5000000, 0x30000000, 0x36000000, 0xA5000000, 0x38000000,
-	0xBF000000, 0x40000000, 0xA3000000, 0x9E000000, 0x81000000, 0xF3000000, 0xD7000000, 0xFB000000,
-	0x7C000000, 0xE3000000, 0x39000000, 0x82000000, 0x9B000000, 0x2F000000, 0xFF000000, 0x87000000,
-	0x34000000, 0x8E000000, 0x43000000, 0x44000000, 0xC4000000, 0xDE000000, 0xE9000000, 0xCB000000,
-	0x54000000, 0x7B000000, 0x94000000, 0x32000000, 0xA6000000, 0xC2000000, 0x23000000, 0x3D000000,
-	0xEE000000, 0x4C000000, 0x95000000, 0x0B000000, 0x42000000, 0xFA000000, 0xC3000000, 0x4E000000,
-	0x08000000, 0x2E000000, 0xA1000000, 0x66000000, 0x28000000, 0xD9000000, 0x24000000, 0xB2000000,
-	0x76000000, 0x5B000000, 0xA2000000, 0x49000000, 0x6D000000, 0x8B000000, 0xD1000000, 0x25000000,
-	0x72000000, 0xF8000000, 0xF6000000, 0x64000000, 0x86000000, 0x68000000, 0x98000000, 0x16000000,
-	0xD4000000, 0xA4000000, 0x5C000000, 0xCC000000, 0x5D000000, 0x65000000, 0xB6000000, 0x92000000,
-	0x6C000000, 0x70000000, 0x48000000, 0x50000000, 0xFD000000, 0xED000000, 0xB9000000, 0xDA000000,
-	0x5E000000, 0x15000000, 0x46000000, 0x57000000, 0xA7000000, 0x8D000000, 0x9D000000, 0x84000000,
-	0x90000000, 0xD8000000, 0xAB000000, 0x00000000, 0x8C000000, 0xBC000000, 0xD3000000, 0x0A000000,
-	0xF7000000, 0xE4000000, 0x58000000, 0x05000000, 0xB8000000, 0xB3000000, 0x45000000, 0x06000000,
-	0xD0000000, 0x2C000000, 0x1E000000, 0x8F000000, 0xCA000000, 0x3F000000, 0x0F000000, 0x02000000,
-	0xC1000000, 0xAF000000, 0xBD000000, 0x03000000, 0x01000000, 0x13000000, 0x8A000000, 0x6B000000,
-	0x3A000000, 0x91000000, 0x11000000, 0x41000000, 0x4F000000, 0x67000000, 0xDC000000, 0xEA000000,
-	0x97000000, 0xF2000000, 0xCF000000, 0xCE000000, 0xF0000000, 0xB4000000, 0xE6000000, 0x73000000,
-	0x96000000, 0xAC000000, 0x74000000, 0x22000000, 0xE7000000, 0xAD000000, 0x35000000, 0x85000000,
-	0xE2000000, 0xF9000000, 0x37000000, 0xE8000000, 0x1C000000, 0x75000000, 0xDF000000, 0x6E000000,
-	0x47000000, 0xF1000000, 0x1A000000, 0x71000000, 0x1D000000, 0x29000000, 0xC5000000, 0x89000000,
-	0x6F000000, 0xB7000000, 0x62000000, 0x0E000000, 0xAA000000, 0x18000000, 0xBE000000, 0x1B000000,
-	0xFC000000, 0x56000000, 0x3E000000, 0x4B000000, 0xC6000000, 0xD2000000, 0x79000000, 0x20000000,
-	0x9A000000, 0xDB000000, 0xC0000000, 0xFE000000, 0x78000000, 0xCD000000, 0x5A000000, 0xF4000000,
-	0x1F000000, 0xDD000000, 0xA8000000, 0x33000000, 0x88000000, 0x07000000, 0xC7000000, 0x31000000,
-	0xB1000000, 0x12000000, 0x10000000, 0x59000000, 0x27000000, 0x80000000, 0xEC000000, 0x5F000000,
-	0x60000000, 0x51000000, 0x7F000000, 0xA9000000, 0x19000000, 0xB5000000, 0x4A000000, 0x0D000000,
-	0x2D000000, 0xE5000000, 0x7A000000, 0x9F000000, 0x93000000, 0xC9000000, 0x9C000000, 0xEF000000,
-	0xA0000000, 0xE0000000, 0x3B000000, 0x4D000000, 0xAE000000, 0x2A000000, 0xF5000000, 0xB0000000,
-	0xC8000000, 0xEB000000, 0xBB000000, 0x3C000000, 0x83000000, 0x53000000, 0x99000000, 0x61000000,
-	0x17000000, 0x2B000000, 0x04000000, 0x7E000000, 0xBA000000, 0x77000000, 0xD6000000, 0x26000000,
-	0xE1000000, 0x69000000, 0x14000000, 0x63000000, 0x55000000, 0x21000000, 0x0C000000, 0x7D000000
-};
-const u32 TestTable1[256] = {
-	0xA56363C6, 0x847C7CF8, 0x997777EE, 0x8D7B7BF6, 0x0DF2F2FF, 0xBD6B6BD6, 0xB16F6FDE, 0x54C5C591,
-	0x50303060, 0x03010102, 0xA96767CE, 0x7D2B2B56, 0x19FEFEE7, 0x62D7D7B5, 0xE6ABAB4D, 0x9A7676EC,
-	0x45CACA8F, 0x9D82821F, 0x40C9C989, 0x877D7DFA, 0x15FAFAEF, 0xEB5959B2, 0xC947478E, 0x0BF0F0FB,
-	0xECADAD41, 0x67D4D4B3, 0xFDA2A25F, 0xEAAFAF45, 0xBF9C9C23, 0xF7A4A453, 0x967272E4, 0x5BC0C09B,
-	0xC2B7B775, 0x1CFDFDE1, 0xAE93933D, 0x6A26264C, 0x5A36366C, 0x413F3F7E, 0x02F7F7F5, 0x4FCCCC83,
-	0x5C343468, 0xF4A5A551, 0x34E5E5D1, 0x08F1F1F9, 0x937171E2, 0x73D8D8AB, 0x53313162, 0x3F15152A,
-	0x0C040408, 0x52C7C795, 0x65232346, 0x5EC3C39D, 0x28181830, 0xA1969637, 0x0F05050A, 0xB59A9A2F,
-	0x0907070E, 0x36121224, 0x9B80801B, 0x3DE2E2DF, 0x26EBEBCD, 0x6927274E, 0xCDB2B27F, 0x9F7575EA,
-	0x1B090912, 0x9E83831D, 0x742C2C58, 0x2E1A1A34, 0x2D1B1B36, 0xB26E6EDC, 0xEE5A5AB4, 0xFBA0A05B,
-	0xF65252A4, 0x4D3B3B76, 0x61D6D6B7, 0xCEB3B37D, 0x7B292952, 0x3EE3E3DD, 0x712F2F5E, 0x97848413,
-	0xF55353A6, 0x68D1D1B9, 0x00000000, 0x2CEDEDC1, 0x60202040, 0x1FFCFCE3, 0xC8B1B179, 0xED5B5BB6,
-	0xBE6A6AD4, 0x46CBCB8D, 0xD9BEBE67, 0x4B393972, 0xDE4A4A94, 0xD44C4C98, 0xE85858B0, 0x4ACFCF85,
-	0x6BD0D0BB, 0x2AEFEFC5, 0xE5AAAA4F, 0x16FBFBED, 0xC5434386, 0xD74D4D9A, 0x55333366, 0x94858511,
-	0xCF45458A, 0x10F9F9E9, 0x06020204, 0x817F7FFE, 0xF05050A0, 0x443C3C78, 0xBA9F9F25, 0xE3A8A84B,
-	0xF35151A2, 0xFEA3A35D, 0xC0404080, 0x8A8F8F05, 0xAD92923F, 0xBC9D9D21, 0x48383870, 0x04F5F5F1,
-	0xDFBCBC63, 0xC1B6B677, 0x75DADAAF, 0x63212142, 0x30101020, 0x1AFFFFE5, 0x0EF3F3FD, 0x6DD2D2BF,
-	0x4CCDCD81, 0x140C0C18, 0x35131326, 0x2FECECC3, 0xE15F5FBE, 0xA2979735, 0xCC444488, 0x3917172E,
-	0x57C4C493, 0xF2A7A755, 0x827E7EFC, 0x473D3D7A, 0xAC6464C8, 0xE75D5DBA, 0x2B191932, 0x957373E6,
-	0xA06060C0, 0x98818119, 0xD14F4F9E, 0x7FDCDCA3, 0x66222244, 0x7E2A2A54, 0xAB90903B, 0x8388880B,
-	0xCA46468C, 0x29EEEEC7, 0xD3B8B86B, 0x3C141428, 0x79DEDEA7, 0xE25E5EBC, 0x1D0B0B16, 0x76DBDBAD,
-	0x3BE0E0DB, 0x56323264, 0x4E3A3A74, 0x1E0A0A14, 0xDB494992, 0x0A06060C, 0x6C242448, 0xE45C5CB8,
-	0x5DC2C29F, 0x6ED3D3BD, 0xEFACAC43, 0xA66262C4, 0xA8919139, 0xA4959531, 0x37E4E4D3, 0x8B7979F2,
-	0x32E7E7D5, 0x43C8C88B, 0x5937376E, 0xB76D6DDA, 0x8C8D8D01, 0x64D5D5B1, 0xD24E4E9C, 0xE0A9A949,
-	0xB46C6CD8, 0xFA5656AC, 0x07F4F4F3, 0x25EAEACF, 0xAF6565CA, 0x8E7A7AF4, 0xE9AEAE47, 0x18080810,
-	0xD5BABA6F, 0x887878F0, 0x6F25254A, 0x722E2E5C, 0x241C1C38, 0xF1A6A657, 0xC7B4B473, 0x51C6C697,
-	0x23E8E8CB, 0x7CDDDDA1, 0x9C7474E8, 0x211F1F3E, 0xDD4B4B96, 0xDCBDBD61, 0x868B8B0D, 0x858A8A0F,
-	0x907070E0, 0x423E3E7C, 0xC4B5B571, 0xAA6666CC, 0xD8484890, 0x05030306, 0x01F6F6F7, 0x120E0E1C,
-	0xA36161C2, 0x5F35356A, 0xF95757AE, 0xD0B9B969, 0x91868617, 0x58C1C199, 0x271D1D3A, 0xB99E9E27,
-	0x38E1E1D9, 0x13F8F8EB, 0xB398982B, 0x33111122, 0xBB6969D2, 0x70D9D9A9, 0x898E8E07, 0xA7949433,
-	0xB69B9B2D, 0x221E1E3C, 0x92878715, 0x20E9E9C9, 0x49CECE87, 0xFF5555AA, 0x78282850, 0x7ADFDFA5,
-	0x8F8C8C03, 0xF8A1A159, 0x80898909, 0x170D0D1A, 0xDABFBF65, 0x31E6E6D7, 0xC6424284, 0xB86868D0,
-	0xC3414182, 0xB0999929, 0x772D2D5A, 0x110F0F1E, 0xCBB0B07B, 0xFC5454A8, 0xD6BBBB6D, 0x3A16162C
-};
-const u32 TestTable2[256] = {
-	0x6363C6A5, 0x7C7CF884, 0x7777EE99, 0x7B7BF68D, 0xF2F2FF0D, 0x6B6BD6BD, 0x6F6FDEB1, 0xC5C59154,
-	0x30306050, 0x01010203, 0x6767CEA9, 0x2B2B567D, 0xFEFEE719, 0xD7D7B562, 0xABAB4DE6, 0x7676EC9A,
-	0xCACA8F45, 0x82821F9D, 0xC9C98940, 0x7D7DFA87, 0xFAFAEF15, 0x5959B2EB, 0x47478EC9, 0xF0F0FB0B,
-	0xADAD41EC, 0xD4D4B367, 0xA2A25FFD, 0xAFAF45EA, 0x9C9C23BF, 0xA4A453F7, 0x7272E496, 0xC0C09B5B,
-	0xB7B775C2, 0xFDFDE11C, 0x93933DAE, 0x26264C6A, 0x36366C5A, 0x3F3F7E41, 0xF7F7F502, 0xCCCC834F,
-	0x3434685C, 0xA5A551F4, 0xE5E5D134, 0xF1F1F908, 0x7171E293, 0xD8D8AB73, 0x31316253, 0x15152A3F,
-	0x0404080C, 0xC7C79552, 0x23234665, 0xC3C39D5E, 0x18183028, 0x969637A1, 0x05050A0F, 0x9A9A2FB5,
-	0x07070E09, 0x12122436, 0x80801B9B, 0xE2E2DF3D, 0xEBEBCD26, 0x27274E69, 0xB2B27FCD, 0x7575EA9F,
-	0x0909121B, 0x83831D9E, 0x2C2C5874, 0x1A1A342E, 0x1B1B362D, 0x6E6EDCB2, 0x5A5AB4EE, 0xA0A05BFB,
-	0x5252A4F6, 0x3B3B764D, 0xD6D6B761, 0xB3B37DCE, 0x2929527B, 0xE3E3DD3E, 0x2F2F5E71, 0x84841397,
-	0x5353A6F5, 0xD1D1B968, 0x00000000, 0xEDEDC12C, 0x20204060, 0xFCFCE31F, 0xB1B179C8, 0x5B5BB6ED,
-	0x6A6AD4BE, 0xCBCB8D46, 0xBEBE67D9, 0x3939724B, 0x4A4A94DE, 0x4C4C98D4, 0x5858B0E8, 0xCFCF854A,
-	0xD0D0BB6B, 0xEFEFC52A, 0xAAAA4FE5, 0xFBFBED16, 0x434386C5, 0x4D4D9AD7, 0x33336655, 0x85851194,
-	0x45458ACF, 0xF9F9E910, 0x02020406, 0x7F7FFE81, 0x5050A0F0, 0x3C3C7844, 0x9F9F25BA, 0xA8A84BE3,
-	0x5151A2F3, 0xA3A35DFE, 0x404080C0, 0x8F8F058A, 0x92923FAD, 0x9D9D21BC, 0x38387048, 0xF5F5F104,
-	0xBCBC63DF, 0xB6B677C1, 0xDADAAF75, 0x21214263, 0x10102030, 0xFFFFE51A, 0xF3F3FD0E, 0xD2D2BF6D,
-	0xCDCD814C, 0x0C0C1814, 0x13132635, 0xECECC32F, 0x5F5FBEE1, 0x979735A2, 0x444488CC, 0x17172E39,
-	0xC4C49357, 0xA7A755F2, 0x7E7EFC82, 0x3D3D7A47, 0x6464C8AC, 0x5D5DBAE7, 0x1919322B, 0x7373E695,
-	0x6060C0A0, 0x81811998, 0x4F4F9ED1, 0xDCDCA37F, 0x22224466, 0x2A2A547E, 0x90903BAB, 0x88880B83,
-	0x46468CCA, 0xEEEEC729, 0xB8B86BD3, 0x1414283C, 0xDEDEA779, 0x5E5EBCE2, 0x0B0B161D, 0xDBDBAD76,
-	0xE0E0DB3B, 0x32326456, 0x3A3A744E, 0x0A0A141E, 0x494992DB, 0x06060C0A, 0x2424486C, 0x5C5CB8E4,
-	0xC2C29F5D, 0xD3D3BD6E, 0xACAC43EF, 0x6262C4A6, 0x919139A8, 0x959531A4, 0xE4E4D337, 0x7979F28B,
-	0xE7E7D532, 0xC8C88B43, 0x37376E59, 0x6D6DDAB7, 0x8D8D018C, 0xD5D5B164, 0x4E4E9CD2, 0xA9A949E0,
-	0x6C6CD8B4, 0x5656ACFA, 0xF4F4F307, 0xEAEACF25, 0x6565CAAF, 0x7A7AF48E, 0xAEAE47E9, 0x08081018,
-	0xBABA6FD5, 0x7878F088, 0x25254A6F, 0x2E2E5C72, 0x1C1C3824, 0xA6A657F1, 0xB4B473C7, 0xC6C69751,
-	0xE8E8CB23, 0xDDDDA17C, 0x7474E89C, 0x1F1F3E21, 0x4B4B96DD, 0xBDBD61DC, 0x8B8B0D86, 0x8A8A0F85,
-	0x7070E090, 0x3E3E7C42, 0xB5B571C4, 0x6666CCAA, 0x484890D8, 0x03030605, 0xF6F6F701, 0x0E0E1C12,
-	0x6161C2A3, 0x35356A5F, 0x5757AEF9, 0xB9B969D0, 0x86861791, 0xC1C19958, 0x1D1D3A27, 0x9E9E27B9,
-	0xE1E1D938, 0xF8F8EB13, 0x98982BB3, 0x11112233, 0x6969D2BB, 0xD9D9A970, 0x8E8E0789, 0x949433A7,
-	0x9B9B2DB6, 0x1E1E3C22, 0x87871592, 0xE9E9C920, 0xCECE8749, 0x5555AAFF, 0x28285078, 0xDFDFA57A,
-	0x8C8C038F, 0xA1A159F8, 0x89890980, 0x0D0D1A17, 0xBFBF65DA, 0xE6E6D731, 0x424284C6, 0x6868D0B8,
-	0x414182C3, 0x999929B0, 0x2D2D5A77, 0x0F0F1E11, 0xB0B07BCB, 0x5454A8FC, 0xBBBB6DD6, 0x16162C3A
-};
-const u32 TestTable3[256] = {
-	0x63C6A563, 0x7CF8847C, 0x77EE9977, 0x7BF68D7B, 0xF2FF0DF2, 0x6BD6BD6B, 0x6FDEB16F, 0xC59154C5,
-	0x30605030, 0x01020301, 0x67CEA967, 0x2B567D2B, 0xFEE719FE, 0xD7B562D7, 0xAB4DE6AB, 0x76EC9A76,
-	0xCA8F45CA, 0x821F9D82, 0xC98940C9, 0x7DFA877D, 0xFAEF15FA, 0x59B2EB59, 0x478EC947, 0xF0FB0BF0,
-	0xAD41ECAD, 0xD4B367D4, 0xA25FFDA2, 0xAF45EAAF, 0x9C23BF9C, 0xA453F7A4, 0x72E49672, 0xC09B5BC0,
-	0xB775C2B7, 0xFDE11CFD, 0x933DAE93, 0x264C6A26, 0x366C5A36, 0x3F7E413F, 0xF7F502F7, 0xCC834FCC,
-	0x34685C34, 0xA551F4A5, 0xE5D134E5, 0xF1F908F1, 0x71E29371, 0xD8AB73D8, 0x31625331, 0x152A3F15,
-	0x04080C04, 0xC79552C7, 0x23466523, 0xC39D5EC3, 0x18302818, 0x9637A196, 0x050A0F05, 0x9A2FB59A,
-	0x070E0907, 0x12243612, 0x801B9B80, 0xE2DF3DE2, 0xEBCD26EB, 0x274E6927, 0xB27FCDB2, 0x75EA9F75,
-	0x09121B09, 0x831D9E83, 0x2C58742C, 0x1A342E1A, 0x1B362D1B, 0x6EDCB26E, 0x5AB4EE5A, 0xA05BFBA0,
-	0x52A4F652, 0x3B764D3B, 0xD6B761D6, 0xB37DCEB3, 0x29527B29, 0xE3DD3EE3, 0x2F5E712F, 0x84139784,
-	0x53A6F553, 0xD1B968D1, 0x00000000, 0xEDC12CED, 0x20406020, 0xFCE31FFC, 0xB179C8B1, 0x5BB6ED5B,
-	0x6AD4BE6A, 0xCB8D46CB, 0xBE67D9BE, 0x39724B39, 0x4A94DE4A, 0x4C98D44C, 0x58B0E858, 0xCF854ACF,
-	0xD0BB6BD0, 0xEFC52AEF, 0xAA4FE5AA, 0xFBED16FB, 0x4386C543, 0x4D9AD74D, 0x33665533, 0x85119485,
-	0x458ACF45, 0xF9E910F9, 0x02040602, 0x7FFE817F, 0x50A0F050, 0x3C78443C, 0x9F25BA9F, 0xA84BE3A8,
-	0x51A2F351, 0xA35DFEA3, 0x4080C040, 0x8F058A8F, 0x923FAD92, 0x9D21BC9D, 0x38704838, 0xF5F104F5,
-	0xBC63DFBC, 0xB677C1B6, 0xDAAF75DA, 0x21426321, 0x10203010, 0xFFE51AFF, 0xF3FD0EF3, 0xD2BF6DD2,
-	0xCD814CCD, 0x0C18140C, 0x13263513, 0xECC32FEC, 0x5FBEE15F, 0x9735A297, 0x4488CC44, 0x172E3917,
-	0xC49357C4, 0xA755F2A7, 0x7EFC827E, 0x3D7A473D, 0x64C8AC64, 0x5DBAE75D, 0x19322B19, 0x73E69573,
-	0x60C0A060, 0x81199881, 0x4F9ED14F, 0xDCA37FDC, 0x22446622, 0x2A547E2A, 0x903BAB90, 0x880B8388,
-	0x468CCA46, 0xEEC729EE, 0xB86BD3B8, 0x14283C14, 0xDEA779DE, 0x5EBCE25E, 0x0B161D0B, 0xDBAD76DB,
-	0xE0DB3BE0, 0x32645632, 0x3A744E3A, 0x0A141E0A, 0x4992DB49, 0x060C0A06, 0x24486C24, 0x5CB8E45C,
-	0xC29F5DC2, 0xD3BD6ED3, 0xAC43EFAC, 0x62C4A662, 0x9139A891, 0x9531A495, 0xE4D337E4, 0x79F28B79,
-	0xE7D532E7, 0xC88B43C8, 0x376E5937, 0x6DDAB76D, 0x8D018C8D, 0xD5B164D5, 0x4E9CD24E, 0xA949E0A9,
-	0x6CD8B46C, 0x56ACFA56, 0xF4F307F4, 0xEACF25EA, 0x65CAAF65, 0x7AF48E7A, 0xAE47E9AE, 0x08101808,
-	0xBA6FD5BA, 0x78F08878, 0x254A6F25, 0x2E5C722E, 0x1C38241C, 0xA657F1A6, 0xB473C7B4, 0xC69751C6,
-	0xE8CB23E8, 0xDDA17CDD, 0x74E89C74, 0x1F3E211F, 0x4B96DD4B, 0xBD61DCBD, 0x8B0D868B, 0x8A0F858A,
-	0x70E09070, 0x3E7C423E, 0xB571C4B5, 0x66CCAA66, 0x4890D848, 0x03060503, 0xF6F701F6, 0x0E1C120E,
-	0x61C2A361, 0x356A5F35, 0x57AEF957, 0xB969D0B9, 0x86179186, 0xC19958C1, 0x1D3A271D, 0x9E27B99E,
-	0xE1D938E1, 0xF8EB13F8, 0x982BB398, 0x11223311, 0x69D2BB69, 0xD9A970D9, 0x8E07898E, 0x9433A794,
-	0x9B2DB69B, 0x1E3C221E, 0x87159287, 0xE9C920E9, 0xCE8749CE, 0x55AAFF55, 0x28507828, 0xDFA57ADF,
-	0x8C038F8C, 0xA159F8A1, 0x89098089, 0x0D1A170D, 0xBF65DABF, 0xE6D731E6, 0x4284C642, 0x68D0B868,
-	0x4182C341, 0x9929B099, 0x2D5A772D, 0x0F1E110F, 0xB07BCBB0, 0x54A8FC54, 0xBB6DD6BB, 0x162C3A16
-};
-const u32 TestTable4[256] = {
-	0xC6A56363, 0xF8847C7C, 0xEE997777, 0xF68D7B7B, 0xFF0DF2F2, 0xD6BD6B6B, 0xDEB16F6F, 0x9154C5C5,
-	0x60503030, 0x02030101, 0xCEA96767, 0x567D2B2B, 0xE719FEFE, 0xB562D7D7, 0x4DE6ABAB, 0xEC9A7676,
-	0x8F45CACA, 0x1F9D8282, 0x8940C9C9, 0xFA877D7D, 0xEF15FAFA, 0xB2EB5959, 0x8EC94747, 0xFB0BF0F0,
-	0x41ECADAD, 0xB367D4D4, 0x5FFDA2A2, 0x45EAAFAF, 0x23BF9C9C, 0x53F7A4A4, 0xE4967272, 0x9B5BC0C0,
-	0x75C2B7B7, 0xE11CFDFD, 0x3DAE9393, 0x4C6A2626, 0x6C5A3636, 0x7E413F3F, 0xF502F7F7, 0x834FCCCC,
-	0x685C3434, 0x51F4A5A5, 0xD134E5E5, 0xF908F1F1, 0xE2937171, 0xAB73D8D8, 0x62533131, 0x2A3F1515,
-	0x080C0404, 0x9552C7C7, 0x46652323, 0x9D5EC3C3, 0x30281818, 0x37A19696, 0x0A0F0505, 0x2FB59A9A,
-	0x0E090707, 0x24361212, 0x1B9B8080, 0xDF3DE2E2, 0xCD26EBEB, 0x4E692727, 0x7FCDB2B2, 0xEA9F7575,
-	0x121B0909, 0x1D9E8383, 0x58742C2C, 0x342E1A1A, 0x362D1B1B, 0xDCB26E6E, 0xB4EE5A5A, 0x5BFBA0A0,
-	0xA4F65252, 0x764D3B3B, 0xB761D6D6, 0x7DCEB3B3, 0x527B2929, 0xDD3EE3E3, 0x5E712F2F, 0x13978484,
-	0xA6F55353, 0xB968D1D1, 0x00000000, 0xC12CEDED, 0x40602020, 0xE31FFCFC, 0x79C8B1B1, 0xB6ED5B5B,
-	0xD4BE6A6A, 0x8D46CBCB, 0x67D9BEBE, 0x724B3939, 0x94DE4A4A, 0x98D44C4C, 0xB0E85858, 0x854ACFCF,
-	0xBB6BD0D0, 0xC52AEFEF, 0x4FE5AAAA, 0xED16FBFB, 0x86C54343, 0x9AD74D4D, 0x66553333, 0x11948585,
-	0x8ACF4545, 0xE910F9F9, 0x04060202, 0xFE817F7F, 0xA0F05050, 0x78443C3C, 0x25BA9F9F, 0x4BE3A8A8,
-	0xA2F35151, 0x5DFEA3A3, 0x80C04040, 0x058A8F8F, 0x3FAD9292, 0x21BC9D9D, 0x70483838, 0xF104F5F5,
-	0x63DFBCBC, 0x77C1B6B6, 0xAF75DADA, 0x42632121, 0x20301010, 0xE51AFFFF, 0xFD0EF3F3, 0xBF6DD2D2,
-	0x814CCDCD, 0x18140C0C, 0x26351313, 0xC32FECEC, 0xBEE15F5F, 0x35A29797, 0x88CC4444, 0x2E391717,
-	0x9357C4C4, 0x55F2A7A7, 0xFC827E7E, 0x7A473D3D, 0xC8AC6464, 0xBAE75D5D, 0x322B1919, 0xE6957373,
-	0xC0A06060, 0x19988181, 0x9ED14F4F, 0xA37FDCDC, 0x44662222, 0x547E2A2A, 0x3BAB9090, 0x0B838888,
-	0x8CCA4646, 0xC729EEEE, 0x6BD3B8B8, 0x283C1414, 0xA779DEDE, 0xBCE25E5E, 0x161D0B0B, 0xAD76DBDB,
-	0xDB3BE0E0, 0x64563232, 0x744E3A3A, 0x141E0A0A, 0x92DB4949, 0x0C0A0606, 0x486C2424, 0xB8E45C5C,
-	0x9F5DC2C2, 0xBD6ED3D3, 0x43EFACAC, 0xC4A66262, 0x39A89191, 0x31A49595, 0xD337E4E4, 0xF28B7979,
-	0xD532E7E7, 0x8B43C8C8, 0x6E593737, 0xDAB76D6D, 0x018C8D8D, 0xB164D5D5, 0x9CD24E4E, 0x49E0A9A9,
-	0xD8B46C6C, 0xACFA5656, 0xF307F4F4, 0xCF25EAEA, 0xCAAF6565, 0xF48E7A7A, 0x47E9AEAE, 0x10180808,
-	0x6FD5BABA, 0xF0887878, 0x4A6F2525, 0x5C722E2E, 0x38241C1C, 0x57F1A6A6, 0x73C7B4B4, 0x9751C6C6,
-	0xCB23E8E8, 0xA17CDDDD, 0xE89C7474, 0x3E211F1F, 0x96DD4B4B, 0x61DCBDBD, 0x0D868B8B, 0x0F858A8A,
-	0xE0907070, 0x7C423E3E, 0x71C4B5B5, 0xCCAA6666, 0x90D84848, 0x06050303, 0xF701F6F6, 0x1C120E0E,
-	0xC2A36161, 0x6A5F3535, 0xAEF95757, 0x69D0B9B9, 0x17918686, 0x9958C1C1, 0x3A271D1D, 0x27B99E9E,
-	0xD938E1E1, 0xEB13F8F8, 0x2BB39898, 0x22331111, 0xD2BB6969, 0xA970D9D9, 0x07898E8E, 0x33A79494,
-	0x2DB69B9B, 0x3C221E1E, 0x15928787, 0xC920E9E9, 0x8749CECE, 0xAAFF5555, 0x50782828, 0xA57ADFDF,
-	0x038F8C8C, 0x59F8A1A1, 0x09808989, 0x1A170D0D, 0x65DABFBF, 0xD731E6E6, 0x84C64242, 0xD0B86868,
-	0x82C34141, 0x29B09999, 0x5A772D2D, 0x1E110F0F, 0x7BCBB0B0, 0xA8FC5454, 0x6DD6BBBB, 0x2C3A1616
-};
-const u32 RevTable1[256] = {
-	0x50A7F451, 0x5365417E, 0xC3A4171A, 0x965E273A, 0xCB6BAB3B, 0xF1459D1F, 0xAB58FAAC, 0x9303E34B,
-	0x55FA3020, 0xF66D76AD, 0x9176CC88, 0x254C02F5, 0xFCD7E54F, 0xD7CB2AC5, 0x80443526, 0x8FA362B5,
-	0x495AB1DE, 0x671BBA25, 0x980EEA45, 0xE1C0FE5D, 0x02752FC3, 0x12F04C81, 0xA397468D, 0xC6F9D36B,
-	0xE75F8F03, 0x959C9215, 0xEB7A6DBF, 0xDA595295, 0x2D83BED4, 0xD3217458, 0x2969E049, 0x44C8C98E,
-	0x6A89C275, 0x78798EF4, 0x6B3E5899, 0xDD71B927, 0xB64FE1BE, 0x17AD88F0, 0x66AC20C9, 0xB43ACE7D,
-	0x184ADF63, 0x82311AE5, 0x60335197, 0x457F5362, 0xE07764B1, 0x84AE6BBB, 0x1CA081FE, 0x942B08F9,
-	0x58684870, 0x19FD458F, 0x876CDE94, 0xB7F87B52, 0x23D373AB, 0xE2024B72, 0x578F1FE3, 0x2AAB5566,
-	0x0728EBB2, 0x03C2B52F, 0x9A7BC586, 0xA50837D3, 0xF2872830, 0xB2A5BF23, 0xBA6A0302, 0x5C8216ED,
-	0x2B1CCF8A, 0x92B479A7, 0xF0F207F3, 0xA1E2694E, 0xCDF4DA65, 0xD5BE0506, 0x1F6234D1, 0x8AFEA6C4,
-	0x9D532E34, 0xA055F3A2, 0x32E18A05, 0x75EBF6A4, 0x39EC830B, 0xAAEF6040, 0x069F715E, 0x51106EBD,
-	0xF98A213E, 0x3D06DD96, 0xAE053EDD, 0x46BDE64D, 0xB58D5491, 0x055DC471, 0x6FD40604, 0xFF155060,
-	0x24FB9819, 0x97E9BDD6, 0xCC434089, 0x779ED967, 0xBD42E8B0, 0x888B8907, 0x385B19E7, 0xDBEEC879,
-	0x470A7CA1, 0xE90F427C, 0xC91E84F8, 0x00000000, 0x83868009, 0x48ED2B32, 0xAC70111E, 0x4E725A6C,
-	0xFBFF0EFD, 0x5638850F, 0x1ED5AE3D, 0x27392D36, 0x64D90F0A, 0x21A65C68, 0xD1545B9B, 0x3A2E3624,
-	0xB1670A0C, 0x0FE75793, 0xD296EEB4, 0x9E919B1B, 0x4FC5C080, 0xA220DC61, 0x694B775A, 0x161A121C,
-	0x0ABA93E2, 0xE52AA0C0, 0x43E0223C, 0x1D171B12, 0x0B0D090E, 0xADC78BF2, 0xB9A8B62D, 0xC8A91E14,
-	0x8519F157, 0x4C0775AF, 0xBBDD99EE, 0xFD607FA3, 0x9F2601F7, 0xBCF5725C, 0xC53B6644, 0x347EFB5B,
-	0x7629438B, 0xDCC623CB, 0x68FCEDB6, 0x63F1E4B8, 0xCADC31D7, 0x10856342, 0x40229713, 0x2011C684,
-	0x7D244A85, 0xF83DBBD2, 0x1132F9AE, 0x6DA129C7, 0x4B2F9E1D, 0xF330B2DC, 0xEC52860D, 0xD0E3C177,
-	0x6C16B32B, 0x99B970A9, 0xFA489411, 0x2264E947, 0xC48CFCA8, 0x1A3FF0A0, 0xD82C7D56, 0xEF903322,
-	0xC74E4987, 0xC1D138D9, 0xFEA2CA8C, 0x360BD498, 0xCF81F5A6, 0x28DE7AA5, 0x268EB7DA, 0xA4BFAD3F,
-	0xE49D3A2C, 0x0D927850, 0x9BCC5F6A, 0x62467E54, 0xC2138DF6, 0xE8B8D890, 0x5EF7392E, 0xF5AFC382,
-	0xBE805D9F, 0x7C93D069, 0xA92DD56F, 0xB31225CF, 0x3B99ACC8, 0xA77D1810, 0x6E639CE8, 0x7BBB3BDB,
-	0x097826CD, 0xF418596E, 0x01B79AEC, 0xA89A4F83, 0x656E95E6, 0x7EE6FFAA, 0x08CFBC21, 0xE6E815EF,
-	0xD99BE7BA, 0xCE366F4A, 0xD4099FEA, 0xD67CB029, 0xAFB2A431, 0x31233F2A, 0x3094A5C6, 0xC066A235,
-	0x37BC4E74, 0xA6CA82FC, 0xB0D090E0, 0x15D8A733, 0x4A9804F1, 0xF7DAEC41, 0x0E50CD7F, 0x2FF69117,
-	0x8DD64D76, 0x4DB0EF43, 0x544DAACC, 0xDF0496E4, 0xE3B5D19E, 0x1B886A4C, 0xB81F2CC1, 0x7F516546,
-	0x04EA5E9D, 0x5D358C01, 0x737487FA, 0x2E410BFB, 0x5A1D67B3, 0x52D2DB92, 0x335610E9, 0x1347D66D,
-	0x8C61D79A, 0x7A0CA137, 0x8E14F859, 0x893C13EB, 0xEE27A9CE, 0x35C961B7, 0xEDE51CE1, 0x3CB1477A,
-	0x59DFD29C, 0x3F73F255, 0x79CE1418, 0xBF37C773, 0xEACDF753, 0x5BAAFD5F, 0x146F3DDF, 0x86DB4478,
-	0x81F3AFCA, 0x3EC468B9, 0x2C342438, 0x5F40A3C2, 0x72C31D16, 0x0C25E2BC, 0x8B493C28, 0x41950DFF,
-	0x7101A839, 0xDEB30C08, 0x9CE4B4D8, 0x90C15664, 0x6184CB7B, 0x70B632D5, 0x745C6C48, 0x4257B8D0
-};
-const u32 RevTable2[256] = {
-	0xA7F45150, 0x65417E53, 0xA4171AC3, 0x5E273A96, 0x6BAB3BCB, 0x459D1FF1, 0x58FAACAB, 0x03E34B93,
-	0xFA302055, 0x6D76ADF6, 0x76CC8891, 0x4C02F525, 0xD7E54FFC, 0xCB2AC5D7, 0x44352680, 0xA362B58F,
-	0x5AB1DE49, 0x1BBA2567, 0x0EEA4598, 0xC0FE5DE1, 0x752FC302, 0xF04C8112, 0x97468DA3, 0xF9D36BC6,
-	0x5F8F03E7, 0x9C921595, 0x7A6DBFEB, 0x595295DA, 0x83BED42D, 0x217458D3, 0x69E04929, 0xC8C98E44,
-	0x89C2756A, 0x798EF478, 0x3E58996B, 0x71B927DD, 0x4FE1BEB6, 0xAD88F017, 0xAC20C966, 0x3ACE7DB4,
-	0x4ADF6318, 0x311AE582, 0x33519760, 0x7F536245, 0x7764B1E0, 0xAE6BBB84, 0xA081FE1C, 0x2B08F994,
-	0x68487058, 0xFD458F19, 0x6CDE9487, 0xF87B52B7, 0xD373AB23, 0x024B72E2, 0x8F1FE357, 0xAB55662A,
-	0x28EBB207, 0xC2B52F03, 0x7BC5869A, 0x0837D3A5, 0x872830F2, 0xA5BF23B2, 0x6A0302BA, 0x8216ED5C,
-	0x1CCF8A2B, 0xB479A792, 0xF207F3F0, 0xE2694EA1, 0xF4DA65CD, 0xBE0506D5, 0x6234D11F, 0xFEA6C48A,
-	0x532E349D, 0x55F3A2A0, 0xE18A0532, 0xEBF6A475, 0xEC830B39, 0xEF6040AA, 0x9F715E06, 0x106EBD51,
-	0x8A213EF9, 0x06DD963D, 0x053EDDAE, 0xBDE64D46, 0x8D5491B5, 0x5DC47105, 0xD406046F, 0x155060FF,
-	0xFB981924, 0xE9BDD697, 0x434089CC, 0x9ED96777, 0x42E8B0BD, 0x8B890788, 0x5B19E738, 0xEEC879DB,
-	0x0A7CA147, 0x0F427CE9, 0x1E84F8C9, 0x00000000, 0x86800983, 0xED2B3248, 0x70111EAC, 0x725A6C4E,
-	0xFF0EFDFB, 0x38850F56, 0xD5AE3D1E, 0x392D3627, 0xD90F0A64, 0xA65C6821, 0x545B9BD1, 0x2E36243A,
-	0x670A0CB1, 0xE757930F, 0x96EEB4D2, 0x919B1B9E, 0xC5C0804F, 0x20DC61A2, 0x4B775A69, 0x1A121C16,
-	0xBA93E20A, 0x2AA0C0E5, 0xE0223C43, 0x171B121D, 0x0D090E0B, 0xC78BF2AD, 0xA8B62DB9, 0xA91E14C8,
-	0x19F15785, 0x0775AF4C, 0xDD99EEBB, 0x607FA3FD, 0x2601F79F, 0xF5725CBC, 0x3B6644C5, 0x7EFB5B34,
-	0x29438B76, 0xC623CBDC, 0xFCEDB668, 0xF1E4B863, 0xDC31D7CA, 0x85634210, 0x22971340, 0x11C68420,
-	0x244A857D, 0x3DBBD2F8, 0x32F9AE11, 0xA129C76D, 0x2F9E1D4B, 0x30B2DCF3, 0x52860DEC, 0xE3C177D0,
-	0x16B32B6C, 0xB970A999, 0x489411FA, 0x64E94722, 0x8CFCA8C4, 0x3FF0A01A, 0x2C7D56D8, 0x903322EF,
-	0x4E4987C7, 0xD138D9C1, 0xA2CA8CFE, 0x0BD49836, 0x81F5A6CF, 0xDE7AA528, 0x8EB7DA26, 0xBFAD3FA4,
-	0x9D3A2CE4, 0x9278500D, 0xCC5F6A9B, 0x467E5462, 0x138DF6C2, 0xB8D890E8, 0xF7392E5E, 0xAFC382F5,
-	0x805D9FBE, 0x93D0697C, 0x2DD56FA9, 0x1225CFB3, 0x99ACC83B, 0x7D1810A7, 0x639CE86E, 0xBB3BDB7B,
-	0x7826CD09, 0x18596EF4, 0xB79AEC01, 0x9A4F83A8, 0x6E95E665, 0xE6FFAA7E, 0xCFBC2108, 0xE815EFE6,
-	0x9BE7BAD9, 0x366F4ACE, 0x099FEAD4, 0x7CB029D6, 0xB2A431AF, 0x233F2A31, 0x94A5C630, 0x66A235C0,
-	0xBC4E7437, 0xCA82FCA6, 0xD090E0B0, 0xD8A73315, 0x9804F14A, 0xDAEC41F7, 0x50CD7F0E, 0xF691172F,
-	0xD64D768D, 0xB0EF434D, 0x4DAACC54, 0x0496E4DF, 0xB5D19EE3, 0x886A4C1B, 0x1F2CC1B8, 0x5165467F,
-	0xEA5E9D04, 0x358C015D, 0x7487FA73, 0x410BFB2E, 0x1D67B35A, 0xD2DB9252, 0x5610E933, 0x47D66D13,
-	0x61D79A8C, 0x0CA1377A, 0x14F8598E, 0x3C13EB89, 0x27A9CEEE, 0xC961B735, 0xE51CE1ED, 0xB1477A3C,
-	0xDFD29C59, 0x73F2553F, 0xCE141879, 0x37C773BF, 0xCDF753EA, 0xAAFD5F5B, 0x6F3DDF14, 0xDB447886,
-	0xF3AFCA81, 0xC468B93E, 0x3424382C, 0x40A3C25F, 0xC31D1672, 0x25E2BC0C, 0x493C288B, 0x950DFF41,
-	0x01A83971, 0xB30C08DE, 0xE4B4D89C, 0xC1566490, 0x84CB7B61, 0xB632D570, 0x5C6C4874, 0x57B8D042
-};
-const u32 RevTable3[256] = {
-	0xF45150A7, 0x417E5365, 0x171AC3A4, 0x273A965E, 0xAB3BCB6B, 0x9D1FF145, 0xFAACAB58, 0xE34B9303,
-	0x302055FA, 0x76ADF66D, 0xCC889176, 0x02F5254C, 0xE54FFCD7, 0x2AC5D7CB, 0x35268044, 0x62B58FA3,
-	0xB1DE495A, 0xBA25671B, 0xEA45980E, 0xFE5DE1C0, 0x2FC30275, 0x4C8112F0, 0x468DA397, 0xD36BC6F9,
-	0x8F03E75F, 0x9215959C, 0x6DBFEB7A, 0x5295DA59, 0xBED42D83, 0x7458D321, 0xE0492969, 0xC98E44C8,
-	0xC2756A89, 0x8EF47879, 0x58996B3E, 0xB927DD71, 0xE1BEB64F, 0x88F017AD, 0x20C966AC, 0xCE7DB43A,
-	0xDF63184A, 0x1AE58231, 0x51976033, 0x5362457F, 0x64B1E077, 0x6BBB84AE, 0x81FE1CA0, 0x08F9942B,
-	0x48705868, 0x458F19FD, 0xDE94876C, 0x7B52B7F8, 0x73AB23D3, 0x4B72E202, 0x1FE3578F, 0x55662AAB,
-	0xEBB20728, 0xB52F03C2, 0xC5869A7B, 0x37D3A508, 0x2830F287, 0xBF23B2A5, 0x0302BA6A, 0x16ED5C82,
-	0xCF8A2B1C, 0x79A792B4, 0x07F3F0F2, 0x694EA1E2, 0xDA65CDF4, 0x0506D5BE, 0x34D11F62, 0xA6C48AFE,
-	0x2E349D53, 0xF3A2A055, 0x8A0532E1, 0xF6A475EB, 0x830B39EC, 0x6040AAEF, 0x715E069F, 0x6EBD5110,
-	0x213EF98A, 0xDD963D06, 0x3EDDAE05, 0xE64D46BD, 0x5491B58D, 0xC471055D, 0x06046FD4, 0x5060FF15,
-	0x981924FB, 0xBDD697E9, 0x4089CC43, 0xD967779E, 0xE8B0BD42, 0x8907888B, 0x19E7385B, 0xC879DBEE,
-	0x7CA1470A, 0x427CE90F, 0x84F8C91E, 0x00000000, 0x80098386, 0x2B3248ED, 0x111EAC70, 0x5A6C4E72,
-	0x0EFDFBFF, 0x850F5638, 0xAE3D1ED5, 0x2D362739, 0x0F0A64D9, 0x5C6821A6, 0x5B9BD154, 0x36243A2E,
-	0x0A0CB167, 0x57930FE7, 0xEEB4D296, 0x9B1B9E91, 0xC0804FC5, 0xDC61A220, 0x775A694B, 0x121C161A,
-	0x93E20ABA, 0xA0C0E52A, 0x223C43E0, 0x1B121D17, 0x090E0B0D, 0x8BF2ADC7, 0xB62DB9A8, 0x1E14C8A9,
-	0xF1578519, 0x75AF4C07, 0x99EEBBDD, 0x7FA3FD60, 0x01F79F26, 0x725CBCF5, 0x6644C53B, 0xFB5B347E,
-	0x438B7629, 0x23CBDCC6, 0xEDB668FC, 0xE4B863F1, 0x31D7CADC, 0x63421085, 0x97134022, 0xC6842011,
-	0x4A857D24, 0xBBD2F83D, 0xF9AE1132, 0x29C76DA1, 0x9E1D4B2F, 0xB2DCF330, 0x860DEC52, 0xC177D0E3,
-	0xB32B6C16, 0x70A999B9, 0x9411FA48, 0xE9472264, 0xFCA8C48C, 0xF0A01A3F, 0x7D56D82C, 0x3322EF90,
-	0x4987C74E, 0x38D9C1D1, 0xCA8CFEA2, 0xD498360B, 0xF5A6CF81, 0x7AA528DE, 0xB7DA268E, 0xAD3FA4BF,
-	0x3A2CE49D, 0x78500D92, 0x5F6A9BCC, 0x7E546246, 0x8DF6C213, 0xD890E8B8, 0x392E5EF7, 0xC382F5AF,
-	0x5D9FBE80, 0xD0697C93, 0xD56FA92D, 0x25CFB312, 0xACC83B99, 0x1810A77D, 0x9CE86E63, 0x3BDB7BBB,
-	0x26CD0978, 0x596EF418, 0x9AEC01B7, 0x4F83A89A, 0x95E6656E, 0xFFAA7EE6, 0xBC2108CF, 0x15EFE6E8,
-	0xE7BAD99B, 0x6F4ACE36, 0x9FEAD409, 0xB029D67C, 0xA431AFB2, 0x3F2A3123, 0xA5C63094, 0xA235C066,
-	0x4E7437BC, 0x82FCA6CA, 0x90E0B0D0, 0xA73315D8, 0x04F14A98, 0xEC41F7DA, 0xCD7F0E50, 0x91172FF6,
-	0x4D768DD6, 0xEF434DB0, 0xAACC544D, 0x96E4DF04, 0xD19EE3B5, 0x6A4C1B88, 0x2CC1B81F, 0x65467F51,
-	0x5E9D04EA, 0x8C015D35, 0x87FA7374, 0x0BFB2E41, 0x67B35A1D, 0xDB9252D2, 0x10E93356, 0xD66D1347,
-	0xD79A8C61, 0xA1377A0C, 0xF8598E14, 0x13EB893C, 0xA9CEEE27, 0x61B735C9, 0x1CE1EDE5, 0x477A3CB1,
-	0xD29C59DF, 0xF2553F73, 0x141879CE, 0xC773BF37, 0xF753EACD, 0xFD5F5BAA, 0x3DDF146F, 0x447886DB,
-	0xAFCA81F3, 0x68B93EC4, 0x24382C34, 0xA3C25F40, 0x1D1672C3, 0xE2BC0C25, 0x3C288B49, 0x0DFF4195,
-	0xA8397101, 0x0C08DEB3, 0xB4D89CE4, 0x566490C1, 0xCB7B6184, 0x32D570B6, 0x6C48745C, 0xB8D04257
-};
-const u32 RevTable4[256] = {
-	0x5150A7F4, 0x7E536541, 0x1AC3A417, 0x3A965E27, 0x3BCB6BAB, 0x1FF1459D, 0xACAB58FA, 0x4B9303E3,
-	0x2055FA30, 0xADF66D76, 0x889176CC, 0xF5254C02, 0x4FFCD7E5, 0xC5D7CB2A, 0x26804435, 0xB58FA362,
-	0xDE495AB1, 0x25671BBA, 0x45980EEA, 0x5DE1C0FE, 0xC302752F, 0x8112F04C, 0x8DA39746, 0x6BC6F9D3,
-	0x03E75F8F, 0x15959C92, 0xBFEB7A6D, 0x95DA5952, 0xD42D83BE, 0x58D32174, 0x492969E0, 0x8E44C8C9,
-	0x756A89C2, 0xF478798E, 0x996B3E58, 0x27DD71B9, 0xBEB64FE1, 0xF017AD88, 0xC966AC20, 0x7DB43ACE,
-	0x63184ADF, 0xE582311A, 0x97603351, 0x62457F53, 0xB1E07764, 0xBB84AE6B, 0xFE1CA081, 0xF9942B08,
-	0x70586848, 0x8F19FD45, 0x94876CDE, 0x52B7F87B, 0xAB23D373, 0x72E2024B, 0xE3578F1F, 0x662AAB55,
-	0xB20728EB, 0x2F03C2B5, 0x869A7BC5, 0xD3A50837, 0x30F28728, 0x23B2A5BF, 0x02BA6A03, 0xED5C8216,
-	0x8A2B1CCF, 0xA792B479, 0xF3F0F207, 0x4EA1E269, 0x65CDF4DA, 0x06D5BE05, 0xD11F6234, 0xC48AFEA6,
-	0x349D532E, 0xA2A055F3, 0x0532E18A, 0xA475EBF6, 0x0B39EC83, 0x40AAEF60, 0x5E069F71, 0xBD51106E,
-	0x3EF98A21, 0x963D06DD, 0xDDAE053E, 0x4D46BDE6, 0x91B58D54, 0x71055DC4, 0x046FD406, 0x60FF1550,
-	0x1924FB98, 0xD697E9BD, 0x89CC4340, 0x67779ED9, 0xB0BD42E8, 0x07888B89, 0xE7385B19, 0x79DBEEC8,
-	0xA1470A7C, 0x7CE90F42, 0xF8C91E84, 0x00000000, 0x09838680, 0x3248ED2B, 0x1EAC7011, 0x6C4E725A,
-	0xFDFBFF0E, 0x0F563885, 0x3D1ED5AE, 0x3627392D, 0x0A64D90F, 0x6821A65C, 0x9BD1545B, 0x243A2E36,
-	0x0CB1670A, 0x930FE757, 0xB4D296EE, 0x1B9E919B, 0x804FC5C0, 0x61A220DC, 0x5A694B77, 0x1C161A12,
-	0xE20ABA93, 0xC0E52AA0, 0x3C43E022, 0x121D171B, 0x0E0B0D09, 0xF2ADC78B, 0x2DB9A8B6, 0x14C8A91E,
-	0x578519F1, 0xAF4C0775, 0xEEBBDD99, 0xA3FD607F, 0xF79F2601, 0x5CBCF572, 0x44C53B66, 0x5B347EFB,
-	0x8B762943, 0xCBDCC623, 0xB668FCED, 0xB863F1E4, 0xD7CADC31, 0x42108563, 0x13402297, 0x842011C6,
-	0x857D244A, 0xD2F83DBB, 0xAE1132F9, 0xC76DA129, 0x1D4B2F9E, 0xDCF330B2, 0x0DEC5286, 0x77D0E3C1,
-	0x2B6C16B3, 0xA999B970, 0x11FA4894, 0x472264E9, 0xA8C48CFC, 0xA01A3FF0, 0x56D82C7D, 0x22EF9033,
-	0x87C74E49, 0xD9C1D138, 0x8CFEA2CA, 0x98360BD4, 0xA6CF81F5, 0xA528DE7A, 0xDA268EB7, 0x3FA4BFAD,
-	0x2CE49D3A, 0x500D9278, 0x6A9BCC5F, 0x5462467E, 0xF6C2138D, 0x90E8B8D8, 0x2E5EF739, 0x82F5AFC3,
-	0x9FBE805D, 0x697C93D0, 0x6FA92DD5, 0xCFB31225, 0xC83B99AC, 0x10A77D18, 0xE86E639C, 0xDB7BBB3B,
-	0xCD097826, 0x6EF41859, 0xEC01B79A, 0x83A89A4F, 0xE6656E95, 0xAA7EE6FF, 0x2108CFBC, 0xEFE6E815,
-	0xBAD99BE7, 0x4ACE366F, 0xEAD4099F, 0x29D67CB0, 0x31AFB2A4, 0x2A31233F, 0xC63094A5, 0x35C066A2,
-	0x7437BC4E, 0xFCA6CA82, 0xE0B0D090, 0x3315D8A7, 0xF14A9804, 0x41F7DAEC, 0x7F0E50CD, 0x172FF691,
-	0x768DD64D, 0x434DB0EF, 0xCC544DAA, 0xE4DF0496, 0x9EE3B5D1, 0x4C1B886A, 0xC1B81F2C, 0x467F5165,
-	0x9D04EA5E, 0x015D358C, 0xFA737487, 0xFB2E410B, 0xB35A1D67, 0x9252D2DB, 0xE9335610, 0x6D1347D6,
-	0x9A8C61D7, 0x377A0CA1, 0x598E14F8, 0xEB893C13, 0xCEEE27A9, 0xB735C961, 0xE1EDE51C, 0x7A3CB147,
-	0x9C59DFD2, 0x553F73F2, 0x1879CE14, 0x73BF37C7, 0x53EACDF7, 0x5F5BAAFD, 0xDF146F3D, 0x7886DB44,
-	0xCA81F3AF, 0xB93EC468, 0x382C3424, 0xC25F40A3, 0x1672C31D, 0xBC0C25E2, 0x288B493C, 0xFF41950D,
-	0x397101A8, 0x08DEB30C, 0xD89CE4B4, 0x6490C156, 0x7B6184CB, 0xD570B632, 0x48745C6C, 0xD04257B8
-};
-
-
-const u32 RevRawTable1[256] = {
-	0x00000000, 0x0B0D090E, 0x161A121C, 0x1D171B12, 0x2C342438, 0x27392D36, 0x3A2E3624, 0x31233F2A,
-	0x58684870, 0x5365417E, 0x4E725A6C, 0x457F5362, 0x745C6C48, 0x7F516546, 0x62467E54, 0x694B775A,
-	0xB0D090E0, 0xBBDD99EE, 0xA6CA82FC, 0xADC78BF2, 0x9CE4B4D8, 0x97E9BDD6, 0x8AFEA6C4, 0x81F3AFCA,
-	0xE8B8D890, 0xE3B5D19E, 0xFEA2CA8C, 0xF5AFC382, 0xC48CFCA8, 0xCF81F5A6, 0xD296EEB4, 0xD99BE7BA,
-	0x7BBB3BDB, 0x70B632D5, 0x6DA129C7, 0x66AC20C9, 0x578F1FE3, 0x5C8216ED, 0x41950DFF, 0x4A9804F1,
-	0x23D373AB, 0x28DE7AA5, 0x35C961B7, 0x3EC468B9, 0x0FE75793, 0x04EA5E9D, 0x19FD458F, 0x12F04C81,
-	0xCB6BAB3B, 0xC066A235, 0xDD71B927, 0xD67CB029, 0xE75F8F03, 0xEC52860D, 0xF1459D1F, 0xFA489411,
-	0x9303E34B, 0x980EEA45, 0x8519F157, 0x8E14F859, 0xBF37C773, 0xB43ACE7D, 0xA92DD56F, 0xA220DC61,
-	0xF66D76AD, 0xFD607FA3, 0xE07764B1, 0xEB7A6DBF, 0xDA595295, 0xD1545B9B, 0xCC434089, 0xC74E4987,
-	0xAE053EDD, 0xA50837D3, 0xB81F2CC1, 0xB31225CF, 0x82311AE5, 0x893C13EB, 0x942B08F9, 0x9F2601F7,
-	0x46BDE64D, 0x4DB0EF43, 0x50A7F451, 0x5BAAFD5F, 0x6A89C275, 0x6184CB7B, 0x7C93D069, 0x779ED967,
-	0x1ED5AE3D, 0x15D8A733, 0x08CFBC21, 0x03C2B52F, 0x32E18A05, 0x39EC830B, 0x24FB9819, 0x2FF69117,
-	0x8DD64D76, 0x86DB4478, 0x9BCC5F6A, 0x90C15664, 0xA1E2694E, 0xAAEF6040, 0xB7F87B52, 0xBCF5725C,
-	0xD5BE0506, 0xDEB30C08, 0xC3A4171A, 0xC8A91E14, 0xF98A213E, 0xF2872830, 0xEF903322, 0xE49D3A2C,
-	0x3D06DD96, 0x360BD498, 0x2B1CCF8A, 0x2011C684, 0x1132F9AE, 0x1A3FF0A0, 0x0728EBB2, 0x0C25E2BC,
-	0x656E95E6, 0x6E639CE8, 0x737487FA, 0x78798EF4, 0x495AB1DE, 0x4257B8D0, 0x5F40A3C2, 0x544DAACC,
-	0xF7DAEC41, 0xFCD7E54F, 0xE1C0FE5D, 0xEACDF753, 0xDBEEC879, 0xD0E3C177, 0xCDF4DA65, 0xC6F9D36B,
-	0xAFB2A431, 0xA4BFAD3F, 0xB9A8B62D, 0xB2A5BF23, 0x83868009, 0x888B8907, 0x959C9215, 0x9E919B1B,
-	0x470A7CA1, 0x4C0775AF, 0x51106EBD, 0x5A1D67B3, 0x6B3E5899, 0x60335197, 0x7D244A85, 0x7629438B,
-	0x1F6234D1, 0x146F3DDF, 0x097826CD, 0x02752FC3, 0x335610E9, 0x385B19E7, 0x254C02F5, 0x2E410BFB,
-	0x8C61D79A, 0x876CDE94, 0x9A7BC586, 0x9176CC88, 0xA055F3A2, 0xAB58FAAC, 0xB64FE1BE, 0xBD42E8B0,
-	0xD4099FEA, 0xDF0496E4, 0xC2138DF6, 0xC91E84F8, 0xF83DBBD2, 0xF330B2DC, 0xEE27A9CE, 0xE52AA0C0,
-	0x3CB1477A, 0x37BC4E74, 0x2AAB5566, 0x21A65C68, 0x10856342, 0x1B886A4C, 0x069F715E, 0x0D927850,
-	0x64D90F0A, 0x6FD40604, 0x72C31D16, 0x79CE1418, 0x48ED2B32, 0x43E0223C, 0x5EF7392E, 0x55FA3020,
-	0x01B79AEC, 0x0ABA93E2, 0x17AD88F0, 0x1CA081FE, 0x2D83BED4, 0x268EB7DA, 0x3B99ACC8, 0x3094A5C6,
-	0x59DFD29C, 0x52D2DB92, 0x4FC5C080, 0x44C8C98E, 0x75EBF6A4, 0x7EE6FFAA, 0x63F1E4B8, 0x68FCEDB6,
-	0xB1670A0C, 0xBA6A0302, 0xA77D1810, 0xAC70111E, 0x9D532E34, 0x965E273A, 0x8B493C28, 0x80443526,
-	0xE90F427C, 0xE2024B72, 0xFF155060, 0xF418596E, 0xC53B6644, 0xCE366F4A, 0xD3217458, 0xD82C7D56,
-	0x7A0CA137, 0x7101A839, 0x6C16B32B, 0x671BBA25, 0x5638850F, 0x5D358C01, 0x40229713, 0x4B2F9E1D,
-	0x2264E947, 0x2969E049, 0x347EFB5B, 0x3F73F255, 0x0E50CD7F, 0x055DC471, 0x184ADF63, 0x1347D66D,
-	0xCADC31D7, 0xC1D138D9, 0xDCC623CB, 0xD7CB2AC5, 0xE6E815EF, 0xEDE51CE1, 0xF0F207F3, 0xFBFF0EFD,
-	0x92B479A7, 0x99B970A9, 0x84AE6BBB, 0x8FA362B5, 0xBE805D9F, 0xB58D5491, 0xA89A4F83, 0xA397468D
-};
-const u32 RevRawTable2[256] = {
-	0x00000000, 0x0D090E0B, 0x1A121C16, 0x171B121D, 0x3424382C, 0x392D3627, 0x2E36243A, 0x233F2A31,
-	0x68487058, 0x65417E53, 0x725A6C4E, 0x7F536245, 0x5C6C4874, 0x5165467F, 0x467E5462, 0x4B775A69,
-	0xD090E0B0, 0xDD99EEBB, 0xCA82FCA6, 0xC78BF2AD, 0xE4B4D89C, 0xE9BDD697, 0xFEA6C48A, 0xF3AFCA81,
-	0xB8D890E8, 0xB5D19EE3, 0xA2CA8CFE, 0xAFC382F5, 0x8CFCA8C4, 0x81F5A6CF, 0x96EEB4D2, 0x9BE7BAD9,
-	0xBB3BDB7B, 0xB632D570, 0xA129C76D, 0xAC20C966, 0x8F1FE357, 0x8216ED5C, 0x950DFF41, 0x9804F14A,
-	0xD373AB23, 0xDE7AA528, 0xC961B735, 0xC468B93E, 0xE757930F, 0xEA5E9D04, 0xFD458F19, 0xF04C8112,
-	0x6BAB3BCB, 0x66A235C0, 0x71B927DD, 0x7CB029D6, 0x5F8F03E7, 0x52860DEC, 0x459D1FF1, 0x489411FA,
-	0x03E34B93, 0x0EEA4598, 0x19F15785, 0x14F8598E, 0x37C773BF, 0x3ACE7DB4, 0x2DD56FA9, 0x20DC61A2,
-	0x6D76ADF6, 0x607FA3FD, 0x7764B1E0, 0x7A6DBFEB, 0x595295DA, 0x545B9BD1, 0x434089CC, 0x4E4987C7,
-	0x053EDDAE, 0x0837D3A5, 0x1F2CC1B8, 0x1225CFB3, 0x311AE582, 0x3C13EB89, 0x2B08F994, 0x2601F79F,
-	0xBDE64D46, 0xB0EF434D, 0xA7F45150, 0xAAFD5F5B, 0x89C2756A, 0x84CB7B61, 0x93D0697C, 0x9ED96777,
-	0xD5AE3D1E, 0xD8A73315, 0xCFBC2108, 0xC2B52F03, 0xE18A0532, 0xEC830B39, 0xFB981924, 0xF691172F,
-	0xD64D768D, 0xDB447886, 0xCC5F6A9B, 0xC1566490, 0xE2694EA1, 0xEF6040AA, 0xF87B52B7, 0xF5725CBC,
-	0xBE0506D5, 0xB30C08DE, 0xA4171AC3, 0xA91E14C8, 0x8A213EF9, 0x872830F2, 0x903322EF, 0x9D3A2CE4,
-	0x06DD963D, 0x0BD49836, 0x1CCF8A2B, 0x11C68420, 0x32F9AE11, 0x3FF0A01A, 0x28EBB207, 0x25E2BC0C,
-	0x6E95E665, 0x639CE86E, 0x7487FA73, 0x798EF478, 0x5AB1DE49, 0x57B8D042, 0x40A3C25F, 0x4DAACC54,
-	0xDAEC41F7, 0xD7E54FFC, 0xC0FE5DE1, 0xCDF753EA, 0xEEC879DB, 0xE3C177D0, 0xF4DA65CD, 0xF9D36BC6,
-	0xB2A431AF, 0xBFAD3FA4, 0xA8B62DB9, 0xA5BF23B2, 0x86800983, 0x8B890788, 0x9C921595, 0x919B1B9E,
-	0x0A7CA147, 0x0775AF4C, 0x106EBD51, 0x1D67B35A, 0x3E58996B, 0x33519760, 0x244A857D, 0x29438B76,
-	0x6234D11F, 0x6F3DDF14, 0x7826CD09, 0x752FC302, 0x5610E933, 0x5B19E738, 0x4C02F525, 0x410BFB2E,
-	0x61D79A8C, 0x6CDE9487, 0x7BC5869A, 0x76CC8891, 0x55F3A2A0, 0x58FAACAB, 0x4FE1BEB6, 0x42E8B0BD,
-	0x099FEAD4, 0x0496E4DF, 0x138DF6C2, 0x1E84F8C9, 0x3DBBD2F8, 0x30B2DCF3, 0x27A9CEEE, 0x2AA0C0E5,
-	0xB1477A3C, 0xBC4E7437, 0xAB55662A, 0xA65C6821, 0x85634210, 0x886A4C1B, 0x9F715E06, 0x9278500D,
-	0xD90F0A64, 0xD406046F, 0xC31D1672, 0xCE141879, 0xED2B3248, 0xE0223C43, 0xF7392E5E, 0xFA302055,
-	0xB79AEC01, 0xBA93E20A, 0xAD88F017, 0xA081FE1C, 0x83BED42D, 0x8EB7DA26, 0x99ACC83B, 0x94A5C630,
-	0xDFD29C59, 0xD2DB9252, 0xC5C0804F, 0xC8C98E44, 0xEBF6A475, 0xE6FFAA7E, 0xF1E4B863, 0xFCEDB668,
-	0x670A0CB1, 0x6A0302BA, 0x7D1810A7, 0x70111EAC, 0x532E349D, 0x5E273A96, 0x493C288B, 0x44352680,
-	0x0F427CE9, 0x024B72E2, 0x155060FF, 0x18596EF4, 0x3B6644C5, 0x366F4ACE, 0x217458D3, 0x2C7D56D8,
-	0x0CA1377A, 0x01A83971, 0x16B32B6C, 0x1BBA2567, 0x38850F56, 0x358C015D, 0x22971340, 0x2F9E1D4B,
-	0x64E94722, 0x69E04929, 0x7EFB5B34, 0x73F2553F, 0x50CD7F0E, 0x5DC47105, 0x4ADF6318, 0x47D66D13,
-	0xDC31D7CA, 0xD138D9C1, 0xC623CBDC, 0xCB2AC5D7, 0xE815EFE6, 0xE51CE1ED, 0xF207F3F0, 0xFF0EFDFB,
-	0xB479A792, 0xB970A999, 0xAE6BBB84, 0xA362B58F, 0x805D9FBE, 0x8D5491B5, 0x9A4F83A8, 0x97468DA3
-};
-const u32 RevRawTable3[256] = {
-	0x00000000, 0x090E0B0D, 0x121C161A, 0x1B121D17, 0x24382C34, 0x2D362739, 0x36243A2E, 0x3F2A3123,
-	0x48705868, 0x417E5365, 0x5A6C4E72, 0x5362457F, 0x6C48745C, 0x65467F51, 0x7E546246, 0x775A694B,
-	0x90E0B0D0, 0x99EEBBDD, 0x82FCA6CA, 0x8BF2ADC7, 0xB4D89CE4, 0xBDD697E9, 0xA6C48AFE, 0xAFCA81F3,
-	0xD890E8B8, 0xD19EE3B5, 0xCA8CFEA2, 0xC382F5AF, 0xFCA8C48C, 0xF5A6CF81, 0xEEB4D296, 0xE7BAD99B,
-	0x3BDB7BBB, 0x32D570B6, 0x29C76DA1, 0x20C966AC, 0x1FE3578F, 0x16ED5C82, 0x0DFF4195, 0x04F14A98,
-	0x73AB23D3, 0x7AA528DE, 0x61B735C9, 0x68B93EC4, 0x57930FE7, 0x5E9D04EA, 0x458F19FD, 0x4C8112F0,
-	0xAB3BCB6B, 0xA235C066, 0xB927DD71, 0xB029D67C, 0x8F03E75F, 0x860DEC52, 0x9D1FF145, 0x9411FA48,
-	0xE34B9303, 0xEA45980E, 0xF1578519, 0xF8598E14, 0xC773BF37, 0xCE7DB43A, 0xD56FA92D, 0xDC61A220,
-	0x76ADF66D, 0x7FA3FD60, 0x64B1E077, 0x6DBFEB7A, 0x5295DA59, 0x5B9BD154, 0x4089CC43, 0x4987C74E,
-	0x3EDDAE05, 0x37D3A508, 0x2CC1B81F, 0x25CFB312, 0x1AE58231, 0x13EB893C, 0x08F9942B, 0x01F79F26,
-	0xE64D46BD, 0xEF434DB0, 0xF45150A7, 0xFD5F5BAA, 0xC2756A89, 0xCB7B6184, 0xD0697C93, 0xD967779E,
-	0xAE3D1ED5, 0xA73315D8, 0xBC2108CF, 0xB52F03C2, 0x8A0532E1, 0x830B39EC, 0x981924FB, 0x91172FF6,
-	0x4D768DD6, 0x447886DB, 0x5F6A9BCC, 0x566490C1, 0x694EA1E2, 0x6040AAEF, 0x7B52B7F8, 0x725CBCF5,
-	0x0506D5BE, 0x0C08DEB3, 0x171AC3A4, 0x1E14C8A9, 0x213EF98A, 0x2830F287, 0x3322EF90, 0x3A2CE49D,
-	0xDD963D06, 0xD498360B, 0xCF8A2B1C, 0xC6842011, 0xF9AE1132, 0xF0A01A3F, 0xEBB20728, 0xE2BC0C25,
-	0x95E6656E, 0x9CE86E63, 0x87FA7374, 0x8EF47879, 0xB1DE495A, 0xB8D04257, 0xA3C25F40, 0xAACC544D,
-	0xEC41F7DA, 0xE54FFCD7, 0xFE5DE1C0, 0xF753EACD, 0xC879DBEE, 0xC177D0E3, 0xDA65CDF4, 0xD36BC6F9,
-	0xA431AFB2, 0xAD3FA4BF, 0xB62DB9A8, 0xBF23B2A5, 0x80098386, 0x8907888B, 0x9215959C, 0x9B1B9E91,
-	0x7CA1470A, 0x75AF4C07, 0x6EBD5110, 0x67B35A1D, 0x58996B3E, 0x51976033, 0x4A857D24, 0x438B7629,
-	0x34D11F62, 0x3DDF146F, 0x26CD0978, 0x2FC30275, 0x10E93356, 0x19E7385B, 0x02F5254C, 0x0BFB2E41,
-	0xD79A8C61, 0xDE94876C, 0xC5869A7B, 0xCC889176, 0xF3A2A055, 0xFAACAB58, 0xE1BEB64F, 0xE8B0BD42,
-	0x9FEAD409, 0x96E4DF04, 0x8DF6C213, 0x84F8C91E, 0xBBD2F83D, 0xB2DCF330, 0xA9CEEE27, 0xA0C0E52A,
-	0x477A3CB1, 0x4E7437BC, 0x55662AAB, 0x5C6821A6, 0x63421085, 0x6A4C1B88, 0x715E069F, 0x78500D92,
-	0x0F0A64D9, 0x06046FD4, 0x1D1672C3, 0x141879CE, 0x2B3248ED, 0x223C43E0, 0x392E5EF7, 0x302055FA,
-	0x9AEC01B7, 0x93E20ABA, 0x88F017AD, 0x81FE1CA0, 0xBED42D83, 0xB7DA268E, 0xACC83B99, 0xA5C63094,
-	0xD29C59DF, 0xDB9252D2, 0xC0804FC5, 0xC98E44C8, 0xF6A475EB, 0xFFAA7EE6, 0xE4B863F1, 0xEDB668FC,
-	0x0A0CB167, 0x0302BA6A, 0x1810A77D, 0x111EAC70, 0x2E349D53, 0x273A965E, 0x3C288B49, 0x35268044,
-	0x427CE90F, 0x4B72E202, 0x5060FF15, 0x596EF418, 0x6644C53B, 0x6F4ACE36, 0x7458D321, 0x7D56D82C,
-	0xA1377A0C, 0xA8397101, 0xB32B6C16, 0xBA25671B, 0x850F5638, 0x8C015D35, 0x97134022, 0x9E1D4B2F,
-	0xE9472264, 0xE0492969, 0xFB5B347E, 0xF2553F73, 0xCD7F0E50, 0xC471055D, 0xDF63184A, 0xD66D1347,
-	0x31D7CADC, 0x38D9C1D1, 0x23CBDCC6, 0x2AC5D7CB, 0x15EFE6E8, 0x1CE1EDE5, 0x07F3F0F2, 0x0EFDFBFF,
-	0x79A792B4, 0x70A999B9, 0x6BBB84AE, 0x62B58FA3, 0x5D9FBE80, 0x5491B58D, 0x4F83A89A, 0x468DA397
-};
-
-
-const u32 RevRawTable4[256] = {
-	0x00000000, 0x0E0B0D09, 0x1C161A12, 0x121D171B, 0x382C3424, 0x3627392D, 0x243A2E36, 0x2A31233F,
-	0x70586848, 0x7E536541, 0x6C4E725A, 0x62457F53, 0x48745C6C, 0x467F5165, 0x5462467E, 0x5A694B77,
-	0xE0B0D090, 0xEEBBDD99, 0xFCA6CA82, 0xF2ADC78B, 0xD89CE4B4, 0xD697E9BD, 0xC48AFEA6, 0xCA81F3AF,
-	0x90E8B8D8, 0x9EE3B5D1, 0x8CFEA2CA, 0x82F5AFC3, 0xA8C48CFC, 0xA6CF81F5, 0xB4D296EE, 0xBAD99BE7,
-	0xDB7BBB3B, 0xD570B632, 0xC76DA129, 0xC966AC20, 0xE3578F1F, 0xED5C8216, 0xFF41950D, 0xF14A9804,
-	0xAB23D373, 0xA528DE7A, 0xB735C961, 0xB93EC468, 0x930FE757, 0x9D04EA5E, 0x8F19FD45, 0x8112F04C,
-	0x3BCB6BAB, 0x35C066A2, 0x27DD71B9, 0x29D67CB0, 0x03E75F8F, 0x0DEC5286, 0x1FF1459D, 0x11FA4894,
-	0x4B9303E3, 0x45980EEA, 0x578519F1, 0x598E14F8, 0x73BF37C7, 0x7DB43ACE, 0x6FA92DD5, 0x61A220DC,
-	0xADF66D76, 0xA3FD607F, 0xB1E07764, 0xBFEB7A6D, 0x95DA5952, 0x9BD1545B, 0x89CC4340, 0x87C74E49,
-	0xDDAE053E, 0xD3A50837, 0xC1B81F2C, 0xCFB31225, 0xE582311A, 0xEB893C13, 0xF9942B08, 0xF79F2601,
-	0x4D46BDE6, 0x434DB0EF, 0x5150A7F4, 0x5F5BAAFD, 0x756A89C2, 0x7B6184CB, 0x697C93D0, 0x67779ED9,
-	0x3D1ED5AE, 0x3315D8A7, 0x2108CFBC, 0x2F03C2B5, 0x0532E18A, 0x0B39EC83, 0x1924FB98, 0x172FF691,
-	0x768DD64D, 0x7886DB44, 0x6A9BCC5F, 0x6490C156, 0x4EA1E269, 0x40AAEF60, 0x52B7F87B, 0x5CBCF572,
-	0x06D5BE05, 0x08DEB30C, 0x1AC3A417, 0x14C8A91E, 0x3EF98A21, 0x30F28728, 0x22EF9033, 0x2CE49D3A,
-	0x963D06DD, 0x98360BD4, 0x8A2B1CCF, 0x842011C6, 0xAE1132F9, 0xA01A3FF0, 0xB20728EB, 0xBC0C25E2,
-	0xE6656E95, 0xE86E639C, 0xFA737487, 0xF478798E, 0xDE495AB1, 0xD04257B8, 0xC25F40A3, 0xCC544DAA,
-	0x41F7DAEC, 0x4FFCD7E5, 0x5DE1C0FE, 0x53EACDF7, 0x79DBEEC8, 0x77D0E3C1, 0x65CDF4DA, 0x6BC6F9D3,
-	0x31AFB2A4, 0x3FA4BFAD, 0x2DB9A8B6, 0x23B2A5BF, 0x09838680, 0x07888B89, 0x15959C92, 0x1B9E919B,
-	0xA1470A7C, 0xAF4C0775, 0xBD51106E, 0xB35A1D67, 0x996B3E58, 0x97603351, 0x857D244A, 0x8B762943,
-	0xD11F6234, 0xDF146F3D, 0xCD097826, 0xC302752F, 0xE9335610, 0xE7385B19, 0xF5254C02, 0xFB2E410B,
-	0x9A8C61D7, 0x94876CDE, 0x869A7BC5, 0x889176CC, 0xA2A055F3, 0xACAB58FA, 0xBEB64FE1, 0xB0BD42E8,
-	0xEAD4099F, 0xE4DF0496, 0xF6C2138D, 0xF8C91E84, 0xD2F83DBB, 0xDCF330B2, 0xCEEE27A9, 0xC0E52AA0,
-	0x7A3CB147, 0x7437BC4E, 0x662AAB55, 0x6821A65C, 0x42108563, 0x4C1B886A, 0x5E069F71, 0x500D9278,
-	0x0A64D90F, 0x046FD406, 0x1672C31D, 0x1879CE14, 0x3248ED2B, 0x3C43E022, 0x2E5EF739, 0x2055FA30,
-	0xEC01B79A, 0xE20ABA93, 0xF017AD88, 0xFE1CA081, 0xD42D83BE, 0xDA268EB7, 0xC83B99AC, 0xC63094A5,
-	0x9C59DFD2, 0x9252D2DB, 0x804FC5C0, 0x8E44C8C9, 0xA475EBF6, 0xAA7EE6FF, 0xB863F1E4, 0xB668FCED,
-	0x0CB1670A, 0x02BA6A03, 0x10A77D18, 0x1EAC7011, 0x349D532E, 0x3A965E27, 0x288B493C, 0x26804435,
-	0x7CE90F42, 0x72E2024B, 0x60FF1550, 0x6EF41859, 0x44C53B66, 0x4ACE366F, 0x58D32174, 0x56D82C7D,
-	0x377A0CA1, 0x397101A8, 0x2B6C16B3, 0x25671BBA, 0x0F563885, 0x015D358C, 0x13402297, 0x1D4B2F9E,
-	0x472264E9, 0x492969E0, 0x5B347EFB, 0x553F73F2, 0x7F0E50CD, 0x71055DC4, 0x63184ADF, 0x6D1347D6,
-	0xD7CADC31, 0xD9C1D138, 0xCBDCC623, 0xC5D7CB2A, 0xEFE6E815, 0xE1EDE51C, 0xF3F0F207, 0xFDFBFF0E,
-	0xA792B479, 0xA999B970, 0xBB84AE6B, 0xB58FA362, 0x9FBE805D, 0x91B58D54, 0x83A89A4F, 0x8DA39746
-};
-
-
-const u32 RCON[11] =
-{
-	0,
-	0x00000001, 0x00000002, 0x00000004, 0x00000008,
-	0x00000010, 0x00000020, 0x00000040, 0x00000080,
-	0x0000001B, 0x00000036
-};
-
-
-
-#ifdef _WIN64
-void XOR2_64(u64 * src, u64 * src2, u64 * dest) {
-	dest[0] = src[0] ^ src2[0];
-	dest[1] = src[1] ^ src2[1];
-}
-
-#else
-void XOR2_32(u32 * src, u32 * src2, u32 * dest) {
-	dest[0] = src[0] ^ src2[0];
-	dest[1] = src[1] ^ src2[1];
-	dest[2] = src[2] ^ src2[2];
-	dest[3] = src[3] ^ src2[3];
-}
-#endif
-
-
-// padding the input to 16bytes multiply
-int padding(void * pToPad, int iSize)
-{
-	int iRest = iSize & 15;
-	if (iRest)
-	{
-		int iCount = 16 - iRest;
-
-		while (iCount--)
-		{
-			((u8*)pToPad)[iSize++] = 0;
-		}
-	}
-	return iSize;
-}
-
-
-
-// Rotate a word from {a0,a1,a2,a3} => { a3,a0,a1,a2 }
-u32 RotWord_Right(u32 iRotate)
-{
-	return ((iRotate & 0xff) << 24) | (iRotate >> 8);
-}
-
-// use S-Box to replace each u8 of input u32 to generate a new output u32
-u32 SubWord(u32 input)
-{
-
-#if 1
-	u32 output;
-	output = FSB[(u8)input];
-	output |= FSB_8[((regs *)&input)->ah];
-	input = input >> 16;
-	output |= FSB_16[(u8)input];
-	output |= FSB_24[((regs *)&input)->ah];
-	return output;
-
-#endif
-
-
-}
-
-
-
-#ifndef  AES_ENCRYPT_MACRO
-
-#define AES_ENCRYPT_MACRO(keyLength,pInput,pOutput,AesEncKey,temp)		\
-	AES_ENCRYPT(keyLength, (u32 *)pInput, (u32 *)pOutput, (u32 *)AesEncKey, (u32 *)temp)
-
-#endif // end of AES_ENCRYPT_MACRO
-
-
-#define AES_ENCRYPT_BLOCK_32	\
-	a1 = TestTable1[(u8)state]; \
-	a4 = TestTable2[((regs *)&state)->ah]; \
-	state = state >> 16; \
-	a3 = TestTable3[(u8)state]; \
-	a2 = TestTable4[((regs *)&state)->ah]; \
-	\
-	state = temp[1]; \
-	a2 ^= TestTable1[(u8)state]; \
-	a1 ^= TestTable2[((regs *)&state)->ah]; \
-	state = state >> 16; \
-	a4 ^= TestTable3[(u8)state]; \
-	a3 ^= TestTable4[((regs *)&state)->ah]; \
-	\
-	state = temp[2]; \
-	a3 ^= TestTable1[(u8)state]; \
-	a2 ^= TestTable2[((regs *)&state)->ah]; \
-	state = state >> 16; \
-	a1 ^= TestTable3[(u8)state]; \
-	a4 ^= TestTable4[((regs *)&state)->ah]; \
-	\
-	state = temp[3]; \
-	a4 ^= TestTable1[(u8)state]; \
-	a3 ^= TestTable2[((regs *)&state)->ah]; \
-	state = state >> 16; \
-	a2 ^= TestTable3[(u8)state]; \
-	a1 ^= TestTable4[((regs *)&state)->ah];
-
-
-void AES_ENCRYPT(u32 keyLength, u32 * pInput, u32 * pOutput, u32 * AesEncKey, u32 * temp) {
-	u32 a1, a2, a3, a4, state;
-
-	state = pInput[0] ^ AesEncKey[0];
-	temp[1] = pInput[1] ^ AesEncKey[1];
-	temp[2] = pInput[2] ^ AesEncKey[2];
-	temp[3] = pInput[3] ^ AesEncKey[3];
-
-
-	AES_ENCRYPT_BLOCK_32;
-
-	state = a1^AesEncKey[4];
-	temp[1] = a2^AesEncKey[5];
-	temp[2] = a3^AesEncKey[6];
-	temp[3] = a4^AesEncKey[7];
-
-	AES_ENCRYPT_BLOCK_32;
-
-
-	state = a1^AesEncKey[8];
-	temp[1] = a2^AesEncKey[9];
-	temp[2] = a3^AesEncKey[10];
-	temp[3] = a4^AesEncKey[11];
-
-	AES_ENCRYPT_BLOCK_32;
-
-
-	state = a1^AesEncKey[12];
-	temp[1] = a2^AesEncKey[13];
-	temp[2] = a3^AesEncKey[14];
-	temp[3] = a4^AesEncKey[15];
-
-
-	AES_ENCRYPT_BLOCK_32;
-
-
-	state = a1^AesEncKey[16];
-	temp[1] = a2^AesEncKey[17];
-	temp[2] = a3^AesEncKey[18];
-	temp[3] = a4^AesEncKey[19];
-
-	AES_ENCRYPT_BLOCK_32;
-
-
-	state = a1^AesEncKey[20];
-	temp[1] = a2^AesEncKey[21];
-	temp[2] = a3^AesEncKey[22];
-	temp[3] = a4^AesEncKey[23];
-
-
-	AES_ENCRYPT_BLOCK_32;
-
-
-	state = a1^AesEncKey[24];
-	temp[1] = a2^AesEncKey[25];
-	temp[2] = a3^AesEncKey[26];
-	temp[3] = a4^AesEncKey[27];
-
-
-	AES_ENCRYPT_BLOCK_32;
-
-
-	state = a1^AesEncKey[28];
-	temp[1] = a2^AesEncKey[29];
-	temp[2] = a3^AesEncKey[30];
-	temp[3] = a4^AesEncKey[31];
-
-	AES_ENCRYPT_BLOCK_32;
-
-
-	state = a1^AesEncKey[32];
-	temp[1] = a2^AesEncKey[33];
-	temp[2] = a3^AesEncKey[34];
-	temp[3] = a4^AesEncKey[35];
-
-	AES_ENCRYPT_BLOCK_32;
-
-
-	state = a1^AesEncKey[36];
-	temp[1] = a2^AesEncKey[37];
-	temp[2] = a3^AesEncKey[38];
-	temp[3] = a4^AesEncKey[39];
-
-
-	if (keyLength == AES_KEY_128BIT) {
-		a1 = FSB[(u8)state];
-		a4 = FSB_8[((regs *)&state)->ah];
-		state = state >> 16;
-		a3 = FSB_16[(u8)state];
-		a2 = FSB_24[((regs *)&state)->ah];
-
-		state = temp[1];
-		a2 |= FSB[(u8)state];
-		a1 |= FSB_8[((regs *)&state)->ah];
-		state = state >> 16;
-		a4 |= FSB_16[(u8)state];
-		a3 |= FSB_24[((regs *)&state)->ah];
-
-		state = temp[2];
-		a3 |= FSB[(u8)state];
-		a2 |= FSB_8[((regs *)&state)->ah];
-		state = state >> 16;
-		a1 |= FSB_16[(u8)state];
-		a4 |= FSB_24[((regs *)&state)->ah];
-
-		state = temp[3];
-		a4 |= FSB[(u8)state];
-		a3 |= FSB_8[((regs *)&state)->ah];
-		state = state >> 16;
-		a2 |= FSB_16[(u8)state];
-		a1 |= FSB_24[((regs *)&state)->ah];
-
-		pOutput[0] = a1 ^ AesEncKey[40];
-		pOutput[1] = a2 ^ AesEncKey[41];
-		pOutput[2] = a3 ^ AesEncKey[42];
-		pOutput[3] = a4 ^ AesEncKey[43];
-		return;
-	}
-
-	AES_ENCRYPT_BLOCK_32;
-
-
-
-	state = a1^AesEncKey[40];
-	temp[1] = a2^AesEncKey[41];
-	temp[2] = a3^AesEncKey[42];
-	temp[3] = a4^AesEncKey[43];
-
-	AES_ENCRYPT_BLOCK_32;
-
-
-	state = a1^AesEncKey[44];
-	temp[1] = a2^AesEncKey[45];
-	temp[2] = a3^AesEncKey[46];
-	temp[3] = a4^AesEncKey[47];
-
 
-	if (keyLength == AES_KEY_192BIT) {
-
-		a1 = FSB[(u8)state];
-		a4 = FSB_8[((regs *)&state)->ah];
-		state = state >> 16;
-		a3 = FSB_16[(u8)state];
-		a2 = FSB_24[((regs *)&state)->ah];
-
-		state = temp[1];
-		a2 |= FSB[(u8)state];
-		a1 |= FSB_8[((regs *)&state)->ah];
-		state = state >> 16;
-		a4 |= FSB_16[(u8)state];
-		a3 |= FSB_24[((regs *)&state)->ah];
-
-		state = temp[2];
-		a3 |= FSB[(u8)state];
-		a2 |= FSB_8[((regs *)&state)->ah];
-		state = state >> 16;
-		a1 |= FSB_16[(u8)state];
-		a4 |= FSB_24[((regs *)&state)->ah];
-
-		state = temp[3];
-		a4 |= FSB[(u8)state];
-		a3 |= FSB_8[((regs *)&state)->ah];
-		state = state >> 16;
-		a2 |= FSB_16[(u8)state];
-		a1 |= FSB_24[((regs *)&state)->ah];
-
-		pOutput[0] = a1 ^ AesEncKey[48];
-		pOutput[1] = a2 ^ AesEncKey[49];
-		pOutput[2] = a3 ^ AesEncKey[50];
-		pOutput[3] = a4 ^ AesEncKey[51];
-		return;
-	}
-
-	AES_ENCRYPT_BLOCK_32;
-
-
-	state = a1^AesEncKey[48];
-	temp[1] = a2^AesEncKey[49];
-	temp[2] = a3^AesEncKey[50];
-	temp[3] = a4^AesEncKey[51];
-
-	AES_ENCRYPT_BLOCK_32;
-
-
-	state = a1^AesEncKey[52];
-	temp[1] = a2^AesEncKey[53];
-	temp[2] = a3^AesEncKey[54];
-	temp[3] = a4^AesEncKey[55];
-
-	a1 = FSB[(u8)state];
-	a4 = FSB_8[((regs *)&state)->ah];
-	state = state >> 16;
-	a3 = FSB_16[(u8)state];
-	a2 = FSB_24[((regs *)&state)->ah];
-
-	state = temp[1];
-	a2 |= FSB[(u8)state];
-	a1 |= FSB_8[((regs *)&state)->ah];
-	state = state >> 16;
-	a4 |= FSB_16[(u8)state];
-	a3 |= FSB_24[((regs *)&state)->ah];
-
-	state = temp[2];
-	a3 |= FSB[(u8)state];
-	a2 |= FSB_8[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 |= FSB_16[(u8)state];
-	a4 |= FSB_24[((regs *)&state)->ah];
-
-	state = temp[3];
-	a4 |= FSB[(u8)state];
-	a3 |= FSB_8[((regs *)&state)->ah];
-	state = state >> 16;
-	a2 |= FSB_16[(u8)state];
-	a1 |= FSB_24[((regs *)&state)->ah];
-
-
-	pOutput[0] = a1 ^ AesEncKey[56];
-	pOutput[1] = a2 ^ AesEncKey[57];
-	pOutput[2] = a3 ^ AesEncKey[58];
-	pOutput[3] = a4 ^ AesEncKey[59];
-}
-
-
-
-//===========================================================
-// the key buffer size is (Nr+1) * 4
-
-
-
-void KeyExpansion(AESContext * pContext, u8 * pKey, const int Nr, const int Nk)
-{
-	u32 * pExpand = &(pContext->AesEncKey[0]);
-	u32 temp;
-	int i = 0;
-	int j = 0;
-
-
-	while (i<Nk)
-	{
-		pExpand[i] = (pKey[j]) |
-			(pKey[j + 1] << 8) |
-			(pKey[j + 2] << 16) |
-			(pKey[j + 3] << 24);
-		i++;
-		j += 4;
-	}
-
-	i = Nk;
-
-	while (i<Nb *(Nr + 1))
-	{
-		temp = pExpand[i - 1];
-		if (i % Nk == 0)
-		{
-			temp = SubWord(RotWord_Right(temp)) ^ RCON[i / Nk];
-		}
-		else if ((Nk > 6) && (i % Nk) == 4)
-		{
-			temp = SubWord(temp);
-		}
-		pExpand[i] = pExpand[i - Nk] ^ temp;
-		i++;
-	}
-
-}
-
-int AesRoundSize(int iSize, int iAlignSize)
-{
-	int iMul = (iSize / iAlignSize) * iAlignSize;
-
-	if (iSize != iMul)
-	{
-		iSize = iMul + iAlignSize;
-	}
-
-
-	return  iSize;
-}
-
-//decode
-void InvMixColumnsDecKey(u32 * pInput, u32 * pOutput)
-{
-	u32 a1, state;
-
-	state = pInput[0];
-	a1 = RevRawTable1[(u8)state];
-	a1 ^= RevRawTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 ^= RevRawTable3[(u8)state];
-	a1 ^= RevRawTable4[((regs *)&state)->ah];
-	pOutput[0] = a1;
-
-
-	state = pInput[1];
-	a1 = RevRawTable1[(u8)state];
-	a1 ^= RevRawTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 ^= RevRawTable3[(u8)state];
-	a1 ^= RevRawTable4[((regs *)&state)->ah];
-	pOutput[1] = a1;
-
-
-	state = pInput[2];
-	a1 = RevRawTable1[(u8)state];
-	a1 ^= RevRawTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 ^= RevRawTable3[(u8)state];
-	a1 ^= RevRawTable4[((regs *)&state)->ah];
-	pOutput[2] = a1;
-
-
-	state = pInput[3];
-	a1 = RevRawTable1[(u8)state];
-	a1 ^= RevRawTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 ^= RevRawTable3[(u8)state];
-	a1 ^= RevRawTable4[((regs *)&state)->ah];
-	pOutput[3] = a1;
-
-}
-
-//C.1 AES-128 (NK=4, NR=10)
-//C.2 AES-192 (NK=6, NR=12)
-//C.3 AES-256 (NK=8, NR=14)
-void AesSetKey(AESContext * pContext, int iKeyLength, void * key, int iEnc)
-{
-	int i, Nr, Nk;
-
-	pContext->iKeyLengthE = iKeyLength;
-	if (iKeyLength == AES_KEY_128BIT) {
-		Nk = 4;
-		Nr = 10;
-	}
-	else
-		if (iKeyLength == AES_KEY_192BIT) {
-			Nk = 6;
-			Nr = 12;
-		}
-		else
-			if (iKeyLength == AES_KEY_256BIT) {
-				Nk = 8;
-				Nr = 14;
-			}
-			else {
-				// illegal , use 128 Bit
-				pContext->iKeyLengthE = AES_KEY_128BIT;
-				Nk = 4;
-				Nr = 10;
-			}
-
-
-			KeyExpansion(pContext, (u8*)key, Nr, Nk);
-
-			if (iEnc > 0)
-				return;
-
-			pContext->iKeyLengthD = pContext->iKeyLengthE;
-
-			memcpy(&pContext->AesDecKey[Nr*Nb], pContext->AesEncKey, Nb*sizeof(u32));
-			memcpy(pContext->AesDecKey, &pContext->AesEncKey[Nr*Nb], Nb*sizeof(u32));
-			for (i = 1; i<Nr; i++)
-			{
-				InvMixColumnsDecKey(&pContext->AesEncKey[i*Nb], &pContext->AesDecKey[(Nr - i)*Nb]);
-			}
-}
-
-void AES_DECRYPT(u32 keyLength, u32 * _pInput, u32 * _pOutput, u32 * local_key, u32 * local_temp)  {
-
-	u32 a1, a2, a3, a4, state;
-
-	state = _pInput[0] ^ local_key[0];
-	local_temp[1] = _pInput[1] ^ local_key[1];
-	local_temp[2] = _pInput[2] ^ local_key[2];
-	local_temp[3] = _pInput[3] ^ local_key[3];
-
-
-	a1 = RevTable1[(u8)state];
-	a2 = RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a3 = RevTable3[(u8)state];
-	a4 = RevTable4[((regs *)&state)->ah];
-
-
-	state = local_temp[1];
-	a2 ^= RevTable1[(u8)state];
-	a3 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a4 ^= RevTable3[(u8)state];
-	a1 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[2];
-	a3 ^= RevTable1[(u8)state];
-	a4 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 ^= RevTable3[(u8)state];
-	a2 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[3];
-	a4 ^= RevTable1[(u8)state];
-	a1 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a2 ^= RevTable3[(u8)state];
-	a3 ^= RevTable4[((regs *)&state)->ah];
-
-	state = a1^local_key[4];
-	local_temp[1] = a2^local_key[5];
-	local_temp[2] = a3^local_key[6];
-	local_temp[3] = a4^local_key[7];
-
-	a1 = RevTable1[(u8)state];
-	a2 = RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a3 = RevTable3[(u8)state];
-	a4 = RevTable4[((regs *)&state)->ah];
-
-
-	state = local_temp[1];
-	a2 ^= RevTable1[(u8)state];
-	a3 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a4 ^= RevTable3[(u8)state];
-	a1 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[2];
-	a3 ^= RevTable1[(u8)state];
-	a4 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 ^= RevTable3[(u8)state];
-	a2 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[3];
-	a4 ^= RevTable1[(u8)state];
-	a1 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a2 ^= RevTable3[(u8)state];
-	a3 ^= RevTable4[((regs *)&state)->ah];
-
-	state = a1^local_key[8];
-	local_temp[1] = a2^local_key[9];
-	local_temp[2] = a3^local_key[10];
-	local_temp[3] = a4^local_key[11];
-
-	a1 = RevTable1[(u8)state];
-	a2 = RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a3 = RevTable3[(u8)state];
-	a4 = RevTable4[((regs *)&state)->ah];
-
-
-	state = local_temp[1];
-	a2 ^= RevTable1[(u8)state];
-	a3 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a4 ^= RevTable3[(u8)state];
-	a1 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[2];
-	a3 ^= RevTable1[(u8)state];
-	a4 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 ^= RevTable3[(u8)state];
-	a2 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[3];
-	a4 ^= RevTable1[(u8)state];
-	a1 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a2 ^= RevTable3[(u8)state];
-	a3 ^= RevTable4[((regs *)&state)->ah];
-
-	state = a1^local_key[12];
-	local_temp[1] = a2^local_key[13];
-	local_temp[2] = a3^local_key[14];
-	local_temp[3] = a4^local_key[15];
-
-	a1 = RevTable1[(u8)state];
-	a2 = RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a3 = RevTable3[(u8)state];
-	a4 = RevTable4[((regs *)&state)->ah];
-
-
-	state = local_temp[1];
-	a2 ^= RevTable1[(u8)state];
-	a3 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a4 ^= RevTable3[(u8)state];
-	a1 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[2];
-	a3 ^= RevTable1[(u8)state];
-	a4 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 ^= RevTable3[(u8)state];
-	a2 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[3];
-	a4 ^= RevTable1[(u8)state];
-	a1 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a2 ^= RevTable3[(u8)state];
-	a3 ^= RevTable4[((regs *)&state)->ah];
-
-	state = a1^local_key[16];
-	local_temp[1] = a2^local_key[17];
-	local_temp[2] = a3^local_key[18];
-	local_temp[3] = a4^local_key[19];
-
-	a1 = RevTable1[(u8)state];
-	a2 = RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a3 = RevTable3[(u8)state];
-	a4 = RevTable4[((regs *)&state)->ah];
-
-
-	state = local_temp[1];
-	a2 ^= RevTable1[(u8)state];
-	a3 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a4 ^= RevTable3[(u8)state];
-	a1 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[2];
-	a3 ^= RevTable1[(u8)state];
-	a4 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 ^= RevTable3[(u8)state];
-	a2 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[3];
-	a4 ^= RevTable1[(u8)state];
-	a1 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a2 ^= RevTable3[(u8)state];
-	a3 ^= RevTable4[((regs *)&state)->ah];
-
-	state = a1^local_key[20];
-	local_temp[1] = a2^local_key[21];
-	local_temp[2] = a3^local_key[22];
-	local_temp[3] = a4^local_key[23];
-
-	a1 = RevTable1[(u8)state];
-	a2 = RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a3 = RevTable3[(u8)state];
-	a4 = RevTable4[((regs *)&state)->ah];
-
-
-	state = local_temp[1];
-	a2 ^= RevTable1[(u8)state];
-	a3 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a4 ^= RevTable3[(u8)state];
-	a1 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[2];
-	a3 ^= RevTable1[(u8)state];
-	a4 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 ^= RevTable3[(u8)state];
-	a2 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[3];
-	a4 ^= RevTable1[(u8)state];
-	a1 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a2 ^= RevTable3[(u8)state];
-	a3 ^= RevTable4[((regs *)&state)->ah];
-
-	state = a1^local_key[24];
-	local_temp[1] = a2^local_key[25];
-	local_temp[2] = a3^local_key[26];
-	local_temp[3] = a4^local_key[27];
-
-	a1 = RevTable1[(u8)state];
-	a2 = RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a3 = RevTable3[(u8)state];
-	a4 = RevTable4[((regs *)&state)->ah];
-
-
-	state = local_temp[1];
-	a2 ^= RevTable1[(u8)state];
-	a3 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a4 ^= RevTable3[(u8)state];
-	a1 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[2];
-	a3 ^= RevTable1[(u8)state];
-	a4 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 ^= RevTable3[(u8)state];
-	a2 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[3];
-	a4 ^= RevTable1[(u8)state];
-	a1 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a2 ^= RevTable3[(u8)state];
-	a3 ^= RevTable4[((regs *)&state)->ah];
-
-	state = a1^local_key[28];
-	local_temp[1] = a2^local_key[29];
-	local_temp[2] = a3^local_key[30];
-	local_temp[3] = a4^local_key[31];
-
-
-	a1 = RevTable1[(u8)state];
-	a2 = RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a3 = RevTable3[(u8)state];
-	a4 = RevTable4[((regs *)&state)->ah];
-
-
-	state = local_temp[1];
-	a2 ^= RevTable1[(u8)state];
-	a3 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a4 ^= RevTable3[(u8)state];
-	a1 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[2];
-	a3 ^= RevTable1[(u8)state];
-	a4 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 ^= RevTable3[(u8)state];
-	a2 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[3];
-	a4 ^= RevTable1[(u8)state];
-	a1 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a2 ^= RevTable3[(u8)state];
-	a3 ^= RevTable4[((regs *)&state)->ah];
-
-	state = a1^local_key[32];
-	local_temp[1] = a2^local_key[33];
-	local_temp[2] = a3^local_key[34];
-	local_temp[3] = a4^local_key[35];
-
-	a1 = RevTable1[(u8)state];
-	a2 = RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a3 = RevTable3[(u8)state];
-	a4 = RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[1];
-	a2 ^= RevTable1[(u8)state];
-	a3 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a4 ^= RevTable3[(u8)state];
-	a1 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[2];
-	a3 ^= RevTable1[(u8)state];
-	a4 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 ^= RevTable3[(u8)state];
-	a2 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[3];
-	a4 ^= RevTable1[(u8)state];
-	a1 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a2 ^= RevTable3[(u8)state];
-	a3 ^= RevTable4[((regs *)&state)->ah];
-
-	state = a1^local_key[36];
-	local_temp[1] = a2^local_key[37];
-	local_temp[2] = a3^local_key[38];
-	local_temp[3] = a4^local_key[39];
-
-
-
-
-	if (keyLength == AES_KEY_128BIT) {
-
-		a1 = RSb[(u8)state];
-		a2 = RSb_8[((regs *)&state)->ah];
-		state = state >> 16;
-		a3 = RSb_16[(u8)state];
-		a4 = RSb_24[((regs *)&state)->ah];
-
-		state = local_temp[1];
-		a2 |= RSb[(u8)state];
-		a3 |= RSb_8[((regs *)&state)->ah];
-		state = state >> 16;
-		a4 |= RSb_16[(u8)state];
-		a1 |= RSb_24[((regs *)&state)->ah];
-
-		state = local_temp[2];
-		a3 |= RSb[(u8)state];
-		a4 |= RSb_8[((regs *)&state)->ah];
-		state = state >> 16;
-		a1 |= RSb_16[(u8)state];
-		a2 |= RSb_24[((regs *)&state)->ah];
-
-		state = local_temp[3];
-		a4 |= RSb[(u8)state];
-		a1 |= RSb_8[((regs *)&state)->ah];
-		state = state >> 16;
-		a2 |= RSb_16[(u8)state];
-		a3 |= RSb_24[((regs *)&state)->ah];
-
-		_pOutput[0] = a1 ^ local_key[40];
-		_pOutput[1] = a2 ^ local_key[41];
-		_pOutput[2] = a3 ^ local_key[42];
-		_pOutput[3] = a4 ^ local_key[43];
-		return;
-	}
-
-	a1 = RevTable1[(u8)state];
-	a2 = RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a3 = RevTable3[(u8)state];
-	a4 = RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[1];
-	a2 ^= RevTable1[(u8)state];
-	a3 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a4 ^= RevTable3[(u8)state];
-	a1 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[2];
-	a3 ^= RevTable1[(u8)state];
-	a4 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 ^= RevTable3[(u8)state];
-	a2 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[3];
-	a4 ^= RevTable1[(u8)state];
-	a1 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a2 ^= RevTable3[(u8)state];
-	a3 ^= RevTable4[((regs *)&state)->ah];
-
-
-	state = a1^local_key[40];
-	local_temp[1] = a2^local_key[41];
-	local_temp[2] = a3^local_key[42];
-	local_temp[3] = a4^local_key[43];
-
-
-	a1 = RevTable1[(u8)state];
-	a2 = RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a3 = RevTable3[(u8)state];
-	a4 = RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[1];
-	a2 ^= RevTable1[(u8)state];
-	a3 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a4 ^= RevTable3[(u8)state];
-	a1 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[2];
-	a3 ^= RevTable1[(u8)state];
-	a4 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 ^= RevTable3[(u8)state];
-	a2 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[3];
-	a4 ^= RevTable1[(u8)state];
-	a1 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a2 ^= RevTable3[(u8)state];
-	a3 ^= RevTable4[((regs *)&state)->ah];
-
-	state = a1^local_key[44];
-	local_temp[1] = a2^local_key[45];
-	local_temp[2] = a3^local_key[46];
-	local_temp[3] = a4^local_key[47];
-
-
-	if (keyLength == AES_KEY_192BIT) {
-		a1 = RSb[(u8)state];
-		a2 = RSb_8[((regs *)&state)->ah];
-		state = state >> 16;
-		a3 = RSb_16[(u8)state];
-		a4 = RSb_24[((regs *)&state)->ah];
-
-		state = local_temp[1];
-		a2 |= RSb[(u8)state];
-		a3 |= RSb_8[((regs *)&state)->ah];
-		state = state >> 16;
-		a4 |= RSb_16[(u8)state];
-		a1 |= RSb_24[((regs *)&state)->ah];
-
-		state = local_temp[2];
-		a3 |= RSb[(u8)state];
-		a4 |= RSb_8[((regs *)&state)->ah];
-		state = state >> 16;
-		a1 |= RSb_16[(u8)state];
-		a2 |= RSb_24[((regs *)&state)->ah];
-
-		state = local_temp[3];
-		a4 |= RSb[(u8)state];
-		a1 |= RSb_8[((regs *)&state)->ah];
-		state = state >> 16;
-		a2 |= RSb_16[(u8)state];
-		a3 |= RSb_24[((regs *)&state)->ah];
-
-		_pOutput[0] = a1 ^ local_key[48];
-		_pOutput[1] = a2 ^ local_key[49];
-		_pOutput[2] = a3 ^ local_key[50];
-		_pOutput[3] = a4 ^ local_key[51];
-		return;
-	}
-
-	a1 = RevTable1[(u8)state];
-	a2 = RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a3 = RevTable3[(u8)state];
-	a4 = RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[1];
-	a2 ^= RevTable1[(u8)state];
-	a3 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a4 ^= RevTable3[(u8)state];
-	a1 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[2];
-	a3 ^= RevTable1[(u8)state];
-	a4 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 ^= RevTable3[(u8)state];
-	a2 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[3];
-	a4 ^= RevTable1[(u8)state];
-	a1 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a2 ^= RevTable3[(u8)state];
-	a3 ^= RevTable4[((regs *)&state)->ah];
-
-	state = a1^local_key[48];
-	local_temp[1] = a2^local_key[49];
-	local_temp[2] = a3^local_key[50];
-	local_temp[3] = a4^local_key[51];
-
-
-	a1 = RevTable1[(u8)state];
-	a2 = RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a3 = RevTable3[(u8)state];
-	a4 = RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[1];
-	a2 ^= RevTable1[(u8)state];
-	a3 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a4 ^= RevTable3[(u8)state];
-	a1 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[2];
-	a3 ^= RevTable1[(u8)state];
-	a4 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 ^= RevTable3[(u8)state];
-	a2 ^= RevTable4[((regs *)&state)->ah];
-
-	state = local_temp[3];
-	a4 ^= RevTable1[(u8)state];
-	a1 ^= RevTable2[((regs *)&state)->ah];
-	state = state >> 16;
-	a2 ^= RevTable3[(u8)state];
-	a3 ^= RevTable4[((regs *)&state)->ah];
-
-	state = a1^local_key[52];
-	local_temp[1] = a2^local_key[53];
-	local_temp[2] = a3^local_key[54];
-	local_temp[3] = a4^local_key[55];
-
-
-	a1 = RSb[(u8)state];
-	a2 = RSb_8[((regs *)&state)->ah];
-	state = state >> 16;
-	a3 = RSb_16[(u8)state];
-	a4 = RSb_24[((regs *)&state)->ah];
-
-	state = local_temp[1];
-	a2 |= RSb[(u8)state];
-	a3 |= RSb_8[((regs *)&state)->ah];
-	state = state >> 16;
-	a4 |= RSb_16[(u8)state];
-	a1 |= RSb_24[((regs *)&state)->ah];
-
-	state = local_temp[2];
-	a3 |= RSb[(u8)state];
-	a4 |= RSb_8[((regs *)&state)->ah];
-	state = state >> 16;
-	a1 |= RSb_16[(u8)state];
-	a2 |= RSb_24[((regs *)&state)->ah];
-
-	state = local_temp[3];
-	a4 |= RSb[(u8)state];
-	a1 |= RSb_8[((regs *)&state)->ah];
-	state = state >> 16;
-	a2 |= RSb_16[(u8)state];
-	a3 |= RSb_24[((regs *)&state)->ah];
-
-
-	_pOutput[0] = a1 ^ local_key[56];
-	_pOutput[1] = a2 ^ local_key[57];
-	_pOutput[2] = a3 ^ local_key[58];
-	_pOutput[3] = a4 ^ local_key[59];
-}
-
-/////////////////////////////////////////////////////////////////////////////////////
-
-void AesEncryptECB(AESContext * pContext, void * pOutput, void * pInput, int iSize)
-{
-	//u32 a1,a2,a3,a4,state;
-	u32 local_temp[4];
-	u32 local_key[BLOCKBUFSZ];
-	iSize = padding(pInput, iSize);
-
-	memcpy(local_key, ((AESContext*)pContext)->AesEncKey, BLOCKBUFSZ * 4);
-
-	while (iSize>0)
-	{
-
-		AES_ENCRYPT_MACRO(((AESContext*)pContext)->iKeyLengthE, ((u32*)pInput), ((u32 *)pOutput), local_key, local_temp);  //125~140ms
-
-		pInput = (u32 *)pInput + 4;
-		pOutput = (u32 *)pOutput + 4;
-		iSize -= 16;
-
-	}
-}
-
-void AesEncryptCBC(AESContext * pContext, void * pOutput, void * pInput, int iSize)
-{
-	//u32 a1,a2,a3,a4,state;
-	u32 local_temp[4];
-	u32 local_key[BLOCKBUFSZ];
-	u32 initialVector[4];
-	u32* pVt = &initialVector[0];
-	iSize = padding(pInput, iSize);
-
-	initialVector[0] = 3456789;
-	initialVector[1] = initialVector[0] + 456789;
-	initialVector[2] = initialVector[1] + 456789;
-	initialVector[3] = initialVector[2] + 456789;
-	memcpy(local_key, ((AESContext*)pContext)->AesEncKey, BLOCKBUFSZ * 4);
-
-	while (iSize>0)
-	{
-		XOR2_MACRO(pInput, pVt, local_temp);
-		AES_ENCRYPT_MACRO(((AESContext*)pContext)->iKeyLengthE, local_temp, ((u32 *)pOutput), local_key, local_temp);  //125~140ms
-		pVt = (u32*)pOutput;
-		pInput = (u32 *)pInput + 4;
-		pOutput = (u32 *)pOutput + 4;
-		iSize -= 16;
-	}
-}
-
-void AesDecryptECB(AESContext * pContext, void * pOutput, void * pInput, int iSize)
-{
-	u32 local_temp[4];
-	u32 local_key[BLOCKBUFSZ];
-	iSize = padding(pInput, iSize);
-
-	memcpy(local_key, ((AESContext*)pContext)->AesDecKey, BLOCKBUFSZ * 4);
-
-	while (iSize>0)
-	{
-		AES_DECRYPT(((AESContext*)pContext)->iKeyLengthD, ((u32 *)pInput), ((u32 *)pOutput), local_key, local_temp);
-		pInput = (u32 *)pInput + 4;
-		pOutput = (u32 *)pOutput + 4;
-		iSize -= 16;
-	}
-
-}
-
-void AesDecryptCBC(AESContext * pContext, void * pOutput, void * pInput, int iSize)
-{
-	u32 local_temp[4];
-	u32 local_key[BLOCKBUFSZ];
-	u32 initialVector[4];
-	u32* pVt = &initialVector[0];
-	iSize = padding(pInput, iSize);
-
-	initialVector[0] = 3456789;
-	initialVector[1] = initialVector[0] + 456789;
-	initialVector[2] = initialVector[1] + 456789;
-	initialVector[3] = initialVector[2] + 456789;
-	memcpy(local_key, ((AESContext*)pContext)->AesDecKey, BLOCKBUFSZ * 4);
-
-	while (iSize>0)
-	{
-		AES_DECRYPT(((AESContext*)pContext)->iKeyLengthD, ((u32 *)pInput), local_temp, local_key, local_temp);
-		XOR2_MACRO(local_temp, pVt, pOutput);
-
-		pVt = (u32 *)pInput;
-
-		pInput = (u32 *)pInput + 4;
-		pOutput = (u32 *)pOutput + 4;
-		iSize -= 16;
-	}
-}
-
-void AesEncrypt(AESContext * pContext, void * pOutput, void * pInput, int iSize, unsigned char iFormat)
-{
-	if (iFormat == 32)
-		AesEncryptECB(pContext, pOutput, pInput, iSize);
-	else
-		AesEncryptCBC(pContext, pOutput, pInput, iSize);//33
-}
-
-void AesDecrypt(AESContext * pContext, void * pOutput, void * pInput, int iSize, unsigned char iFormat)
-{
-	if (iFormat == 32)
-		AesDecryptECB(pContext, pOutput, pInput, iSize);
-	else
-		AesDecryptCBC(pContext, pOutput, pInput, iSize);//33
-}
-
-int GetKeyLen(int* pnKey)
-{
-	int iKeyLen;
-	int nKey = *pnKey;
-	if (nKey <= 0)
-		return 0;
-
-	if (nKey <= 16)	{
-		*pnKey = 16;
-		iKeyLen = AES_KEY_128BIT;
-	}
-	else if (nKey <= 24)	{
-		*pnKey = 24;
-		iKeyLen = AES_KEY_192BIT;
-	}
-	else	{
-		*pnKey = 32;
-		iKeyLen = AES_KEY_256BIT;
-	}
-
-	return iKeyLen;
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////
-#define FILE_HEADER_SZ 16
-#define SC_DEMO_KEY_LENGTH 6
-#define SC_FILE_HEADER "SQLitecrypt.com "
-//FTWbWKKerNwdEnA0
-#define SQLITE_SC_NO_KEY		        1000
-#define SQLITE_SC_DECRYPT_FAILED        1001 
-#define SQLITE_SC_ENCRYPT_FAILED        1002
-
-
-typedef struct{
-	Btree *pBt;
-	unsigned char read_cAESKey[32];
-	unsigned char write_cAESKey[32];
-	int iKSz;
-	int iKSz2;
-	unsigned char cSalt[16];
-	AESContext theCtx;
-	AESContext theCtx2;
-	int iPageSz;
-	unsigned char* cBuffer;
-	unsigned char iScFormat;
-}codec_sc;
-
-int g_iSz = 32;
-
-void* sc_malloc(int sz) {
-	void *ptr = sqlite3Malloc(sz);
-	memset(ptr, 0, sz);
-#ifndef OMIT_MEMLOCK
-	if (ptr) {
-#if defined(__unix__) || defined(__APPLE__) 
-		mlock(ptr, sz);
-#elif defined(_WIN32)
-#if !(defined(WINAPI_FAMILY) && (WINAPI_FAMILY == WINAPI_FAMILY_PHONE_APP || WINAPI_FAMILY == WINAPI_FAMILY_APP))
-		VirtualLock(ptr, sz);
-#endif
-#endif
-	}
-#endif
-	return ptr;
-}
-
-void Key2AESKey(const char* sPass, int iSz, unsigned char* pAESKey)
-{
-	if (iSz < 1)
-		return;
-
-	iSz = MIN(iSz, 32);
-
-	memcpy(pAESKey, sPass, iSz);
-}
-
-static int sqlite_find_db_index(sqlite3 *db, const char *zDb)
-{
-	int db_index;
-	if (zDb == NULL)
-		return 0;
-
-	for (db_index = 0; db_index < db->nDb; db_index++) {
-		struct Db *pDb = &db->aDb[db_index];
-		if (strcmp(pDb->zName, zDb) == 0)
-			return db_index;
-	}
-
-	return 0;
-}
-
-int sc_init(Db *pDb, codec_sc **theSc, const void *zKey, int nKey, void* pOld)
-{
-	int i;
-	codec_sc *pSc;
-
-	const char* sKey = (const char*)zKey;
-	for (i = 0; i<nKey; i++)	{
-		if (sKey[i] == 0)	{
-			sKey++;
-			i--;
-			nKey--;
-		}
-		else
-			break;
-	}
-
-	if (nKey < 1)
-		return SQLITE_SC_NO_KEY;
-
-	i = 0;
-
-	if (pOld == NULL)
-		*theSc = sc_malloc(sizeof(codec_sc));
-	else	{
-		pSc = (codec_sc*)pOld;
-		if (pSc->iKSz > 0 && memcmp(pSc->read_cAESKey, pSc->write_cAESKey, 32) == 0)
-			i = nKey;
-	}
-	pSc = *theSc;
-	if (!pSc)
-		return SQLITE_NOMEM;
-	memcpy(pSc->cSalt, SC_FILE_HEADER, 16);
-	pSc->pBt = pDb->pBt;
-	memset(pSc->write_cAESKey, 0, 32);
-	Key2AESKey(sKey, nKey, pSc->write_cAESKey);
-
-	pSc->iKSz = nKey;
-
-	Key2AESKey((const char*)pSc->write_cAESKey, pSc->iKSz, pSc->read_cAESKey);
-	AesSetKey(&pSc->theCtx, GetKeyLen(&pSc->iKSz), pSc->write_cAESKey, 0);
-
-	if (i == nKey)	{
-		AesSetKey(&pSc->theCtx, GetKeyLen(&pSc->iKSz), pSc->write_cAESKey, 0);
-		memcpy(pSc->read_cAESKey, pSc->write_cAESKey, 32);
-	}
-	pSc->theCtx2 = pSc->theCtx;
-	pSc->iKSz2 = pSc->iKSz;
-
-	if (pOld == NULL)	{
-		pSc->iPageSz = sqlite3BtreeGetPageSize(pDb->pBt);
-		pSc->cBuffer = sc_malloc(pSc->iPageSz);
-	}
-
-	pSc->iScFormat = 33;//default format
-
-	return SQLITE_OK;
-}
-
-void sqlite3_activate_see(const char* in) {
-	//do nothing
-}
-
-int sc_set_pagesize(sqlite3* db, struct Db* pDb, codec_sc* pSc)
-{
-	int rc = 0;
-	sqlite3_mutex_enter(db->mutex);
-	db->nextPagesize = pSc->iPageSz;
-
-	//unset the BTS_PAGESIZE_FIXED flag, else  sqliteBtreeSetPageSize will block pagesize changes  
-	pDb->pBt->pBt->btsFlags &= ~BTS_PAGESIZE_FIXED;
-	rc = sqlite3BtreeSetPageSize(pDb->pBt, pSc->iPageSz, 255, 0);
-	sqlite3_mutex_leave(db->mutex);
-	return rc;
-}
-
-void sqlite3FreeCodecArg(void *pCodec)
-{
-	int iSz = sizeof(codec_sc);
-	unsigned char* cBuffer = NULL;
-	if (pCodec == NULL) return;
-
-	memset(pCodec, 0, iSz);
-
-#ifndef OMIT_MEMLOCK
-#if defined(__unix__) || defined(__APPLE__) 
-	munlock(pCodec, iSz);
-#elif defined(_WIN32)
-#if !(defined(WINAPI_FAMILY) && (WINAPI_FAMILY == WINAPI_FAMILY_PHONE_APP || WINAPI_FAMILY == WINAPI_FAMILY_APP))
-	VirtualUnlock(pCodec, iSz);
-#endif
-#endif
-#endif
-
-	cBuffer = ((codec_sc*)pCodec)->cBuffer;
-	if (cBuffer)	{
-		sqlite3_free(cBuffer);
-		cBuffer = NULL;
-	}
-	sqlite3_free(pCodec);
-}
-
-
-//sqlite3Codec can be called in:
-//-encrypt mode - expected to return a pointer to the encrypted data without altering pData.
-//-decrypt mode - expected to return a pointer to pData, with the data decrypted in the input buffer
-
-void* sqlite3Codec(void *pCodec, void *data, Pgno pgno, int mode)
-{
-	codec_sc * pSc = (codec_sc *)pCodec;
-	int offset = 0;
-	int iCount = 0;
-	int i = 0;
-	unsigned char *pData = (unsigned char *)data;
-	unsigned char* buffer = pSc->cBuffer;
-	//char test[] = "12345678901234561234567890123456";
-	//char outTest[32];
-
-	if (pgno == 1)
-		offset = 112; //48//112 
-	memset(buffer, 0, pSc->iPageSz);
-	switch (mode) {
-	case 0:
-	case 2:
-	case 3:
-		if (pSc->read_cAESKey[0] == 0)
-			return pData;
-
-		if (1 == pgno)	{
-			for (i = 72; i<92; i++)	{
-				if (pData[i] > 0)
-					++iCount;
-			}
-			offset = (32 == pSc->iScFormat && iCount > 12) ? 48 : 112;
-
-			if (memcmp(pData, SC_FILE_HEADER, 15) == 0)
-				pSc->iScFormat = pData[15];
-			memcpy(pData, SQLITE_FILE_HEADER, sizeof(SQLITE_FILE_HEADER));
-		}
-		AesDecrypt(&pSc->theCtx, buffer + offset, (pData + offset), pSc->iPageSz - offset, pSc->iScFormat);
-
-		memcpy(pData + offset, buffer + offset, pSc->iPageSz - offset);
-		return pData;
-		break;
-	case 6:
-		if (pSc->write_cAESKey[0] == 0 || g_iSz > 0)	{
-			memcpy(buffer, pData, pSc->iPageSz);
-			return buffer;
-		}
-		if (pgno == 1)	{
-			memcpy(buffer, pData, offset);
-			memcpy(buffer, SC_FILE_HEADER, FILE_HEADER_SZ);
-			buffer[15] = pSc->iScFormat;
-		}
-		AesEncrypt(&pSc->theCtx, buffer + offset, (pData + offset), pSc->iPageSz - offset, pSc->iScFormat);
-
-		return buffer;
-		break;
-	case 7:
-		if (pSc->read_cAESKey[0] == 0)	{
-			memcpy(buffer, pData, pSc->iPageSz);
-			return buffer;//no need to do any encryption
-		}
-		if (pgno == 1)	{
-			memcpy(buffer, pData, offset);
-			memcpy(buffer, SC_FILE_HEADER, FILE_HEADER_SZ);
-			buffer[15] = pSc->iScFormat;
-		}
-		AesEncrypt(&pSc->theCtx2, buffer + offset, (pData + offset), pSc->iPageSz - offset, pSc->iScFormat);
-
-		return buffer;
-		break;
-	default:
-		return pData;
-		break;
-	}
-}
-
-int sqlite3CodecAttach(sqlite3* db, int nDb, const void *zKey, int nKey)
-{
-	struct Db *pDb = &db->aDb[nDb];
-	if (nKey && zKey && pDb->pBt) {
-		int rc;
-		Pager *pPager = pDb->pBt->pBt->pPager;
-		sqlite3_file *fd = (isOpen(pPager->fd)) ? pPager->fd : NULL;
-		codec_sc *pSc;
-
-		void* pOldCodec;
-
-		pOldCodec = sqlite3PagerGetCodec(pPager);
-		if (pOldCodec != NULL)
-			pSc = pOldCodec;
-
-		rc = sc_init(pDb, &pSc, zKey, nKey, pOldCodec);
-
-		if (rc != SQLITE_OK) return rc;
-
-		if (nDb > 0 && nKey > 0)	{
-			AesSetKey(&pSc->theCtx, GetKeyLen(&pSc->iKSz), pSc->write_cAESKey, 0);
-			memcpy(pSc->read_cAESKey, pSc->write_cAESKey, 32);
-		}
-
-		sqlite3_mutex_enter(db->mutex);
-
-		if (pOldCodec == NULL)
-			sqlite3PagerSetCodec(sqlite3BtreePager(pDb->pBt), sqlite3Codec, NULL, sqlite3FreeCodecArg, (void *)pSc);
-
-		sc_set_pagesize(db, pDb, pSc);
-
-		// Force secure delete. Write all pages to disk .
-		sqlite3BtreeSecureDelete(pDb->pBt, 1);
-
-		// if fd is null (in-memory database) dont' overwrite the AutoVacuum settings, if not null, then set to the default
-		if (fd != NULL)
-			sqlite3BtreeSetAutoVacuum(pDb->pBt, SQLITE_DEFAULT_AUTOVACUUM);
-
-		sqlite3_mutex_leave(db->mutex);
-	}
-	return SQLITE_OK;
-}
-
-void sqlite3CodecGetKey(sqlite3* db, int nDb, void **zKey, int *nKey)
-{
-	struct Db *pDb = &db->aDb[nDb];
-	if (pDb->pBt) {
-		codec_sc* pSc = (codec_sc*)pDb->pBt->pBt->pPager->pCodec;
-
-		if (pSc) {
-			*zKey = pSc->read_cAESKey;
-			*nKey = pSc->iKSz;
-		}
-		else {
-			*zKey = NULL;
-			*nKey = 0;
-		}
-	}
-}
-
-int sqlite3_key(sqlite3 *db, const void *pKey, int nKey)
-{
-	int iRes = SQLITE_ERROR;
-	if (db && pKey && nKey)
-		iRes = sqlite3_key_v2(db, "main", pKey, nKey); // operate only on the main db 
-
-	return iRes;
-}
-
-int sqlite3_key_v2(sqlite3 *db, const char *zDb, const void *pKey, int nKey)
-{
-	if (db && pKey && nKey) {
-		int iDB = sqlite_find_db_index(db, zDb);
-		return sqlite3CodecAttach(db, iDB, pKey, nKey);
-	}
-	return SQLITE_ERROR;
-}
-
-int sqlite3_rekey(sqlite3 *db, const void *pKey, int nKey)
-{
-	return sqlite3_rekey_v2(db, "main", pKey, nKey);
-}
-
-
-SQLITE_API int sqlite3_rekey_v2(sqlite3 *db, const char *zDbName, const void *pKey, int nKey)
-{
-	int iDB;
-	struct Db *pDb;
-	if (!db/* || !pKey || !nKey*/)
-		return SQLITE_ERROR;
-
-	iDB = sqlite_find_db_index(db, zDbName);
-	pDb = &db->aDb[iDB];
-
-	if (pDb->pBt) {
-		codec_sc* pSc;
-		int rc, page_count;
-		Pgno pgno;
-		PgHdr *page;
-		Pager *pPager = pDb->pBt->pBt->pPager;
-		const char* sP = (const char*)pKey;
-
-		pSc = sqlite3PagerGetCodec(pPager);
-
-		if (pSc == NULL) {
-			if (nKey > 0)	{
-				sqlite3CodecAttach(db, iDB, pKey, nKey);
-				pSc = (codec_sc*)pDb->pBt->pBt->pPager->pCodec;
-				pSc->iKSz = nKey;
-				AesSetKey(&pSc->theCtx, GetKeyLen(&pSc->iKSz), pSc->write_cAESKey, 0);
-				memset(pSc->read_cAESKey, 0, 32);
-			}
-			else
-			{
-				g_iSz = nKey;
-				return SQLITE_OK;
-			}
-		}
-		else	{
-			if (nKey < 0)	{
-				if (sP[3] + sP[7] == pSc->cSalt[12] && sP[18] == sP[20] && pSc->cSalt[14] == sP[8] + sP[20] - 1)
-				{
-					Key2AESKey((const char*)pSc->write_cAESKey, pSc->iKSz, pSc->read_cAESKey);
-					AesSetKey(&pSc->theCtx, GetKeyLen(&pSc->iKSz), pSc->write_cAESKey, 0);
-					g_iSz = nKey;
-					return SQLITE_OK;
-				}
-				memset(pSc, 0, sizeof(codec_sc));
-				return SQLITE_ERROR;
-			}
-			else	{
-				//int iOldSz = pSc->iKSz;
-				if (nKey <= pSc->iKSz && memcmp(pSc->write_cAESKey, pKey, pSc->iKSz) == 0)
-					return SQLITE_OK;
-				pSc->theCtx2 = pSc->theCtx;
-				memset(pSc->write_cAESKey, 0, 32);
-				Key2AESKey((const char*)pKey, nKey, pSc->write_cAESKey);
-				pSc->iKSz2 = nKey;
-				AesSetKey(&pSc->theCtx, GetKeyLen(&pSc->iKSz2), pSc->write_cAESKey, 1);
-			}
-		}
-
-		sqlite3_mutex_enter(db->mutex);
-
-		//rewrite the database 
-		rc = sqlite3BtreeBeginTrans(pDb->pBt, 1); //begin write transaction
-		sqlite3PagerPagecount(pPager, &page_count);
-		for (pgno = 1; rc == SQLITE_OK && pgno <= (unsigned int)page_count; pgno++) {
-			if (PAGER_MJ_PGNO(pPager) != pgno) {
-				rc = sqlite3PagerGet(pPager, pgno, &page, 0);
-				if (pgno == 1 && pSc->read_cAESKey[0] == 0 && memcmp(SQLITE_FILE_HEADER, page->pData, sizeof(SQLITE_FILE_HEADER)) != 0)	{
-					sqlite3_mutex_leave(db->mutex);
-					return SQLITE_OK;
-				}
-				if (rc == SQLITE_OK) {
-					rc = sqlite3PagerWrite(page);
-					if (rc == SQLITE_OK)
-						sqlite3PagerUnref(page);
-					else
-						break;
-				}
-				else
-					break;
-			}
-		}
-
-		//if rekey is OK, commit and copy the key, else rollback
-		if (rc == SQLITE_OK) {
-			rc = sqlite3BtreeCommit(pDb->pBt);
-			memcpy(pSc->read_cAESKey, pSc->write_cAESKey, 32);
-			pSc->iKSz = pSc->iKSz2;
-			AesSetKey(&pSc->theCtx, GetKeyLen(&pSc->iKSz), pSc->write_cAESKey, 0);
-			pSc->theCtx2 = pSc->theCtx;
-		}
-		else
-		{
-			sqlite3BtreeRollback(pDb->pBt, SQLITE_ABORT_ROLLBACK, 0);
-			pSc->theCtx = pSc->theCtx2;
-			pSc->iKSz2 = pSc->iKSz;
-			memcpy(pSc->write_cAESKey, pSc->read_cAESKey, pSc->iKSz);
-		}
-
-		sqlite3_mutex_leave(db->mutex);
-	}
-
-	return SQLITE_OK;
-}
+/************** Begin file sqlite3_codec.c ***********************************/
+#include "sqlite3_codec.c"
+/************** End of sqlite3_codec.c ***************************************/
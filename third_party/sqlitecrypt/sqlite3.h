@@ -4902,10 +4902,8 @@ SQLITE_API int SQLITE_STDCALL sqlite3_collation_needed16(
 #ifdef SQLITE_HAS_CODEC
 /*
 ** Specify the key for an encrypted database.  This routine should be
-** called right after sqlite3_open().
-**
-** The code to implement this API is not available in the public release
-** of SQLite.
+** called right after sqlite3_open().  A database in the format of the
+** SQLitecrypt codec is upgraded to the current format on the way.
 */
 SQLITE_API int SQLITE_STDCALL sqlite3_key(
   sqlite3 *db,                   /* Database to be rekeyed */
@@ -4918,12 +4916,11 @@ SQLITE_API int SQLITE_STDCALL sqlite3_key_v2(
 );
 
 /*
-** Change the key on an open database.  If the current database is not
-** encrypted, this routine will encrypt it.  If pNew==0 or nNew==0, the
-** database is decrypted.
-**
-** The code to implement this API is not available in the public release
-** of SQLite.
+** Change the key on an open database.  Pages are re-encrypted in a single
+** transaction, so an interrupted rekey leaves the database under the old
+** key.  An empty database without a key is encrypted; a non-empty plaintext
+** database cannot be encrypted in place, nor can an encrypted one be
+** decrypted.
 */
 SQLITE_API int SQLITE_STDCALL sqlite3_rekey(
   sqlite3 *db,                   /* Database to be rekeyed */
@@ -4942,6 +4939,20 @@ SQLITE_API int SQLITE_STDCALL sqlite3_rekey_v2(
 SQLITE_API void SQLITE_STDCALL sqlite3_activate_see(
   const char *zPassPhrase        /* Activation phrase */
 );
+
+/*
+** Configure the page codec.  The settings are process wide and apply to
+** databases keyed after the call:
+**
+** SQLITE_CODEC_CONFIG_KDF_ITER      PBKDF2 iterations used to turn a
+**                                   passphrase into a page key.
+** SQLITE_CODEC_CONFIG_CACHE_PAGES   Decrypted pages kept per database so
+**                                   pages read again from disk are not
+**                                   decrypted again.  0 disables the cache.
+*/
+SQLITE_API int SQLITE_STDCALL sqlite3_codec_config(int op, int iValue);
+#define SQLITE_CODEC_CONFIG_KDF_ITER     1
+#define SQLITE_CODEC_CONFIG_CACHE_PAGES  2
 #endif
 
 #ifdef SQLITE_ENABLE_CEROD
@@ -0,0 +1,821 @@
+/*
+** Page-level encryption codec for the sqlitecrypt amalgamation.
+**
+** This file is #included at the end of sqlite3.c rather than compiled on its
+** own, because the codec hooks need SQLite internals (Pager, Btree, Db) that
+** the amalgamation keeps static.
+**
+** Every page is encrypted with AES-256-GCM from BoringSSL.  The codec claims
+** CODEC_RESERVE_SZ bytes at the end of each page (the "reserved space" the
+** b-tree layer leaves alone) and stores there:
+**
+**     [ nonce (12) | GCM tag (16) | key id (4) ]
+**
+** The nonce is drawn fresh from the CSPRNG every time a page is written and
+** the page number is authenticated as additional data, so pages can neither
+** be replayed at another position nor modified undetected.  The key id lets
+** the codec tell which key a page was written with while sqlite3_rekey() is
+** rewriting the file.
+**
+** Page 1 is special: bytes 0..15 hold the key derivation salt in place of the
+** "SQLite format 3" magic, and bytes 16..99 (page size, reserved space, change
+** counter, ...) stay in plaintext because the pager reads them straight from
+** the file before any page goes through the codec.  Those bytes are still
+** authenticated: they are part of the additional data of page 1.  Bytes
+** 72..75, which SQLite reserves for expansion and leaves zero, carry the
+** format version of the codec:
+**
+**     [ 'x' 'w' 'c' CODEC_FORMAT_VERSION ]
+**
+** Keys are derived from the passphrase with PBKDF2-HMAC-SHA256.  A key of the
+** form x'<64 hex digits>' is used as the raw 256-bit key and skips the KDF.
+**
+** Databases written by the SQLitecrypt codec this one replaced start with
+** "SQLitecrypt.com" and hold pages encrypted with AES-CBC (or ECB) under the
+** passphrase bytes themselves.  Keying such a database upgrades it in place,
+** in a single transaction, when its pages have room for the reserved bytes;
+** otherwise it stays readable and writable in the old format.
+*/
+#ifdef SQLITE_HAS_CODEC
+
+#include <openssl/aead.h>
+#include <openssl/aes.h>
+#include <openssl/digest.h>
+#include <openssl/evp.h>
+#include <openssl/mem.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+
+#define CODEC_KEY_SZ      32
+#define CODEC_SALT_SZ     16
+#define CODEC_NONCE_SZ    12
+#define CODEC_TAG_SZ      16
+#define CODEC_KEYID_SZ    4
+#define CODEC_RESERVE_SZ  (CODEC_NONCE_SZ+CODEC_TAG_SZ+CODEC_KEYID_SZ)
+
+/* Bytes of page 1 that are never encrypted, see the header comment. */
+#define CODEC_PLAIN_HEADER_SZ  100
+
+/* Format version, in bytes 72..75 of page 1. */
+#define CODEC_VERSION_OFST     72
+#define CODEC_VERSION_SZ       4
+#define CODEC_FORMAT_VERSION   1
+
+/* Additional data: the page number, and for page 1 bytes 16..99. */
+#define CODEC_AD_SZ  (4+CODEC_PLAIN_HEADER_SZ-CODEC_SALT_SZ)
+
+/* The SQLitecrypt format, see the header comment. */
+#define CODEC_LEGACY_MAGIC       "SQLitecrypt.com"
+#define CODEC_LEGACY_MAGIC_SZ    15
+#define CODEC_LEGACY_ECB         32
+#define CODEC_LEGACY_CBC         33
+#define CODEC_LEGACY_HEADER_SZ   112
+#define CODEC_LEGACY_OLD_HEADER_SZ  48
+
+/* Length of a raw key: x'...' around 64 hex digits. */
+#define CODEC_RAW_KEY_SZ  (CODEC_KEY_SZ*2+3)
+
+#define CODEC_DEFAULT_KDF_ITER     64000
+#define CODEC_DEFAULT_CACHE_PAGES  256
+
+static int codecKdfIter = CODEC_DEFAULT_KDF_ITER;
+static int codecCachePages = CODEC_DEFAULT_CACHE_PAGES;
+
+typedef struct CodecKey CodecKey;
+typedef struct CodecSlot CodecSlot;
+typedef struct Codec Codec;
+
+struct CodecKey {
+  int isSet;
+  int isLegacy;             /* SQLitecrypt key: aEnc/aDec, not ctx */
+  EVP_AEAD_CTX ctx;
+  u8 aId[CODEC_KEYID_SZ];
+  u8 iLegacyFormat;         /* CODEC_LEGACY_ECB or CODEC_LEGACY_CBC */
+  AES_KEY aEnc;
+  AES_KEY aDec;
+};
+
+/*
+** One entry of the decrypted page cache.  The cache is direct-mapped on the
+** page number and an entry is only valid while the reserved bytes of the
+** page on disk (nonce, tag and key id) are identical to the ones recorded
+** here, so a page rewritten by another connection simply misses.
+*/
+struct CodecSlot {
+  Pgno pgno;
+  u8 aReserve[CODEC_RESERVE_SZ];
+};
+
+struct Codec {
+  int pageSize;             /* Page size reported by the pager */
+  int nReserve;             /* Reserved bytes per page reported by the pager */
+  int nKdfIter;             /* PBKDF2 iterations for passphrase keys */
+  u8 aSalt[CODEC_SALT_SZ];  /* KDF salt, stored in bytes 0..15 of page 1 */
+  char *zPass;              /* Passphrase, handed to ATTACH and VACUUM */
+  int nPass;
+  CodecKey aKey[2];         /* Key slots, see iRead and iWrite */
+  int iRead;                /* Key of the pages as they are on disk */
+  int iWrite;               /* Key for pages written to the database file.
+                            ** Differs from iRead only while rekeying or
+                            ** upgrading from SQLitecrypt. */
+  u8 *aBuf;                 /* Scratch page returned by encryption */
+  int nSlot;                /* Number of decrypted page cache entries */
+  CodecSlot *aSlot;
+  u8 *aSlotData;            /* nSlot pages of decrypted content */
+};
+
+/*
+** Set process wide defaults for databases keyed after this call.
+*/
+SQLITE_API int SQLITE_STDCALL sqlite3_codec_config(int op, int iValue){
+  switch( op ){
+    case SQLITE_CODEC_CONFIG_KDF_ITER:
+      if( iValue<1 ) return SQLITE_MISUSE;
+      codecKdfIter = iValue;
+      return SQLITE_OK;
+    case SQLITE_CODEC_CONFIG_CACHE_PAGES:
+      if( iValue<0 ) return SQLITE_MISUSE;
+      codecCachePages = iValue;
+      return SQLITE_OK;
+  }
+  return SQLITE_MISUSE;
+}
+
+static void codecFreeSecure(void *p, int n){
+  if( p ){
+    OPENSSL_cleanse(p, n);
+    sqlite3_free(p);
+  }
+}
+
+static void codecKeyClear(CodecKey *pKey){
+  if( pKey->isSet ){
+    if( !pKey->isLegacy ) EVP_AEAD_CTX_cleanup(&pKey->ctx);
+    OPENSSL_cleanse(pKey, sizeof(*pKey));
+  }
+}
+
+static void codecCacheClear(Codec *p){
+  codecFreeSecure(p->aSlotData, p->nSlot*p->pageSize);
+  sqlite3_free(p->aSlot);
+  p->aSlotData = 0;
+  p->aSlot = 0;
+}
+
+static void codecCacheAlloc(Codec *p){
+  if( p->nSlot<=0 || p->pageSize<=0 ) return;
+  p->aSlot = sqlite3MallocZero(sizeof(CodecSlot)*p->nSlot);
+  p->aSlotData = sqlite3Malloc((u64)p->nSlot*p->pageSize);
+  if( p->aSlot==0 || p->aSlotData==0 ){
+    /* The cache is an optimization, run without it. */
+    sqlite3_free(p->aSlot);
+    sqlite3_free(p->aSlotData);
+    p->aSlot = 0;
+    p->aSlotData = 0;
+  }
+}
+
+static int codecRawKey(const char *zKey, int nKey, u8 *aOut){
+  int i;
+  if( nKey!=CODEC_RAW_KEY_SZ || zKey[0]!='x' || zKey[1]!='\''
+   || zKey[nKey-1]!='\'' ){
+    return 0;
+  }
+  for(i=0; i<CODEC_KEY_SZ*2; i++){
+    if( !sqlite3Isxdigit(zKey[i+2]) ) return 0;
+  }
+  for(i=0; i<CODEC_KEY_SZ; i++){
+    aOut[i] = (sqlite3HexToInt(zKey[i*2+2])<<4) | sqlite3HexToInt(zKey[i*2+3]);
+  }
+  return 1;
+}
+
+/*
+** Derive the page key for passphrase zKey into *pKey.
+*/
+static int codecDeriveKey(Codec *p, const void *zKey, int nKey, CodecKey *pKey){
+  static const char zIdLabel[] = "sqlitecrypt key id";
+  u8 aKey[CODEC_KEY_SZ];
+  u8 aDigest[SHA256_DIGEST_LENGTH];
+  SHA256_CTX sha;
+  int rc = SQLITE_OK;
+
+  codecKeyClear(pKey);
+  if( !codecRawKey((const char*)zKey, nKey, aKey)
+   && !PKCS5_PBKDF2_HMAC((const char*)zKey, nKey, p->aSalt, CODEC_SALT_SZ,
+                         p->nKdfIter, EVP_sha256(), CODEC_KEY_SZ, aKey) ){
+    rc = SQLITE_ERROR;
+  }
+  if( rc==SQLITE_OK
+   && !EVP_AEAD_CTX_init(&pKey->ctx, EVP_aead_aes_256_gcm(), aKey,
+                         CODEC_KEY_SZ, CODEC_TAG_SZ, 0) ){
+    rc = SQLITE_ERROR;
+  }
+  if( rc==SQLITE_OK ){
+    SHA256_Init(&sha);
+    SHA256_Update(&sha, aKey, CODEC_KEY_SZ);
+    SHA256_Update(&sha, zIdLabel, sizeof(zIdLabel)-1);
+    SHA256_Final(aDigest, &sha);
+    memcpy(pKey->aId, aDigest, CODEC_KEYID_SZ);
+    pKey->isSet = 1;
+  }
+  OPENSSL_cleanse(aKey, sizeof(aKey));
+  OPENSSL_cleanse(aDigest, sizeof(aDigest));
+  return rc;
+}
+
+/*
+** Set up *pKey the way the SQLitecrypt codec used passphrase zKey: leading
+** NUL bytes dropped, at most 32 bytes zero padded to an AES-128, -192 or
+** -256 key.
+*/
+static int codecLegacyKey(const void *zKey, int nKey, u8 iFormat,
+                          CodecKey *pKey){
+  const u8 *aKey = (const u8*)zKey;
+  u8 aRaw[CODEC_KEY_SZ];
+  int nBits;
+
+  codecKeyClear(pKey);
+  while( nKey>0 && aKey[0]==0 ){
+    aKey++;
+    nKey--;
+  }
+  if( nKey<=0 ) return SQLITE_ERROR;
+  memset(aRaw, 0, sizeof(aRaw));
+  memcpy(aRaw, aKey, nKey<CODEC_KEY_SZ ? nKey : CODEC_KEY_SZ);
+  nBits = nKey<=16 ? 128 : nKey<=24 ? 192 : 256;
+  AES_set_encrypt_key(aRaw, nBits, &pKey->aEnc);
+  AES_set_decrypt_key(aRaw, nBits, &pKey->aDec);
+  OPENSSL_cleanse(aRaw, sizeof(aRaw));
+  pKey->iLegacyFormat = iFormat;
+  pKey->isLegacy = 1;
+  pKey->isSet = 1;
+  return SQLITE_OK;
+}
+
+static void codecFree(void *pArg){
+  Codec *p = (Codec*)pArg;
+  if( p==0 ) return;
+  codecKeyClear(&p->aKey[0]);
+  codecKeyClear(&p->aKey[1]);
+  codecCacheClear(p);
+  codecFreeSecure(p->aBuf, p->pageSize);
+  codecFreeSecure(p->zPass, p->nPass);
+  codecFreeSecure(p, sizeof(*p));
+}
+
+static void codecSizeChange(void *pArg, int pageSize, int nReserve){
+  Codec *p = (Codec*)pArg;
+  p->nReserve = nReserve;
+  if( p->pageSize==pageSize && p->aBuf ) return;
+  codecCacheClear(p);
+  codecFreeSecure(p->aBuf, p->pageSize);
+  p->pageSize = pageSize;
+  p->aBuf = sqlite3Malloc(pageSize);
+  codecCacheAlloc(p);
+}
+
+static CodecKey *codecKeyForId(Codec *p, const u8 *aId){
+  CodecKey *pKey = &p->aKey[p->iWrite];
+  if( pKey->isSet && !pKey->isLegacy
+   && memcmp(pKey->aId, aId, CODEC_KEYID_SZ)==0 ){
+    return pKey;
+  }
+  pKey = &p->aKey[p->iRead];
+  if( pKey->isSet && !pKey->isLegacy
+   && memcmp(pKey->aId, aId, CODEC_KEYID_SZ)==0 ){
+    return pKey;
+  }
+  return 0;
+}
+
+/*
+** Fill aAd with the additional data of page pgno and return its length.
+** For page 1 that includes the plaintext header, version included.
+*/
+static int codecAdditionalData(Pgno pgno, const u8 *aPage, u8 *aAd){
+  aAd[0] = (u8)(pgno>>24);
+  aAd[1] = (u8)(pgno>>16);
+  aAd[2] = (u8)(pgno>>8);
+  aAd[3] = (u8)pgno;
+  if( pgno!=1 ) return 4;
+  memcpy(&aAd[4], aPage + CODEC_SALT_SZ,
+         CODEC_PLAIN_HEADER_SZ - CODEC_SALT_SZ);
+  return CODEC_AD_SZ;
+}
+
+static void codecVersion(u8 *aVersion){
+  aVersion[0] = 'x';
+  aVersion[1] = 'w';
+  aVersion[2] = 'c';
+  aVersion[3] = CODEC_FORMAT_VERSION;
+}
+
+/*
+** Page 1 is never cached: its tag covers the plaintext header too, which
+** the reserved bytes alone do not vouch for.
+*/
+static void codecCacheStore(Codec *p, Pgno pgno, const u8 *aPage,
+                            const u8 *aReserve){
+  CodecSlot *pSlot;
+  if( p->aSlot==0 || pgno==1 ) return;
+  pSlot = &p->aSlot[pgno % p->nSlot];
+  pSlot->pgno = pgno;
+  memcpy(pSlot->aReserve, aReserve, CODEC_RESERVE_SZ);
+  memcpy(&p->aSlotData[(pgno % p->nSlot)*(i64)p->pageSize], aPage,
+         p->pageSize);
+}
+
+static int codecCacheLoad(Codec *p, Pgno pgno, u8 *aPage){
+  CodecSlot *pSlot;
+  if( p->aSlot==0 || pgno==1 ) return 0;
+  pSlot = &p->aSlot[pgno % p->nSlot];
+  if( pSlot->pgno!=pgno
+   || memcmp(pSlot->aReserve, aPage + p->pageSize - CODEC_RESERVE_SZ,
+             CODEC_RESERVE_SZ)!=0 ){
+    return 0;
+  }
+  memcpy(aPage, &p->aSlotData[(pgno % p->nSlot)*(i64)p->pageSize],
+         p->pageSize);
+  return 1;
+}
+
+/*
+** Offset of the first encrypted byte of page 1 in the SQLitecrypt format.
+** Files from before the codec moved to 112 started encrypting at 48; those
+** only used ECB and have ciphertext where the header expects zeros.
+*/
+static int codecLegacyHeaderSize(const CodecKey *pKey, const u8 *aPage){
+  int i, nNonZero = 0;
+  if( pKey->iLegacyFormat!=CODEC_LEGACY_ECB ) return CODEC_LEGACY_HEADER_SZ;
+  for(i=72; i<92; i++){
+    if( aPage[i] ) nNonZero++;
+  }
+  return nNonZero>12 ? CODEC_LEGACY_OLD_HEADER_SZ : CODEC_LEGACY_HEADER_SZ;
+}
+
+/*
+** Run the SQLitecrypt cipher over the n bytes at aIn, which are a multiple
+** of the AES block size.  The CBC chain of every page starts from the same
+** fixed IV, the four words below in little-endian byte order.
+*/
+static void codecLegacyCipher(CodecKey *pKey, const u8 *aIn, u8 *aOut, int n,
+                              int bEncrypt){
+  static const u8 aIv[AES_BLOCK_SIZE] = {
+    0x15, 0xbf, 0x34, 0x00, 0x6a, 0xb7, 0x3b, 0x00,
+    0xbf, 0xaf, 0x42, 0x00, 0x14, 0xa8, 0x49, 0x00,
+  };
+  const AES_KEY *pAes = bEncrypt ? &pKey->aEnc : &pKey->aDec;
+  int i;
+  if( pKey->iLegacyFormat==CODEC_LEGACY_ECB ){
+    for(i=0; i+AES_BLOCK_SIZE<=n; i+=AES_BLOCK_SIZE){
+      AES_ecb_encrypt(aIn + i, aOut + i, pAes,
+                      bEncrypt ? AES_ENCRYPT : AES_DECRYPT);
+    }
+  }else{
+    u8 aChain[AES_BLOCK_SIZE];
+    memcpy(aChain, aIv, sizeof(aChain));
+    AES_cbc_encrypt(aIn, aOut, n - n%AES_BLOCK_SIZE, pAes, aChain,
+                    bEncrypt ? AES_ENCRYPT : AES_DECRYPT);
+  }
+}
+
+static void codecLegacyDecrypt(Codec *p, CodecKey *pKey, u8 *aPage,
+                               Pgno pgno){
+  int iOfst = pgno==1 ? codecLegacyHeaderSize(pKey, aPage) : 0;
+  if( p->aBuf==0 ) return;
+  codecLegacyCipher(pKey, aPage + iOfst, p->aBuf + iOfst,
+                    p->pageSize - iOfst, 0);
+  memcpy(aPage + iOfst, p->aBuf + iOfst, p->pageSize - iOfst);
+  if( pgno==1 ) memcpy(aPage, SQLITE_FILE_HEADER, CODEC_SALT_SZ);
+}
+
+static void *codecLegacyEncrypt(Codec *p, CodecKey *pKey, u8 *aPage,
+                                Pgno pgno){
+  int iOfst = pgno==1 ? CODEC_LEGACY_HEADER_SZ : 0;
+  u8 *aOut = p->aBuf;
+  if( aOut==0 ) return 0;
+  if( pgno==1 ){
+    memcpy(aOut, aPage, CODEC_LEGACY_HEADER_SZ);
+    memcpy(aOut, CODEC_LEGACY_MAGIC, CODEC_LEGACY_MAGIC_SZ);
+    aOut[CODEC_LEGACY_MAGIC_SZ] = pKey->iLegacyFormat;
+  }
+  codecLegacyCipher(pKey, aPage + iOfst, aOut + iOfst, p->pageSize - iOfst, 1);
+  return aOut;
+}
+
+/*
+** Decrypt page pgno in place.  A page that fails authentication is zeroed:
+** page 1 then reports SQLITE_NOTADB (wrong key, or a format version this
+** codec does not know) and any other page SQLITE_CORRUPT, instead of handing
+** ciphertext to the b-tree layer.
+**
+** Pages written by a key that has an id are GCM pages.  The others can only
+** come from a database still in the SQLitecrypt format, which has nothing
+** to authenticate them with.
+*/
+static void *codecDecrypt(Codec *p, u8 *aPage, Pgno pgno){
+  int iOfst = pgno==1 ? CODEC_PLAIN_HEADER_SZ : 0;
+  u8 *aReserve = aPage + p->pageSize - CODEC_RESERVE_SZ;
+  CodecKey *pRead = &p->aKey[p->iRead];
+  CodecKey *pKey;
+  u8 aAd[CODEC_AD_SZ];
+  u8 aVersion[CODEC_VERSION_SZ];
+
+  if( !pRead->isSet ) return aPage;
+  if( codecCacheLoad(p, pgno, aPage) ) return aPage;
+
+  pKey = p->nReserve>=CODEC_RESERVE_SZ ?
+      codecKeyForId(p, aReserve + CODEC_NONCE_SZ + CODEC_TAG_SZ) : 0;
+  codecVersion(aVersion);
+  if( pKey
+   && (pgno!=1 || memcmp(aPage + CODEC_VERSION_OFST, aVersion,
+                         CODEC_VERSION_SZ)==0) ){
+    /* Keep the ciphertext while a SQLitecrypt read key may still need it. */
+    u8 *aOut = pRead->isLegacy ? p->aBuf : aPage;
+    int nAd = codecAdditionalData(pgno, aPage, aAd);
+    if( aOut
+     && EVP_AEAD_CTX_open_gather(&pKey->ctx, aOut + iOfst,
+                                 aReserve, CODEC_NONCE_SZ,
+                                 aPage + iOfst,
+                                 p->pageSize - p->nReserve - iOfst,
+                                 aReserve + CODEC_NONCE_SZ, CODEC_TAG_SZ,
+                                 aAd, nAd) ){
+      if( aOut!=aPage ){
+        memcpy(aPage + iOfst, aOut + iOfst, p->pageSize - p->nReserve - iOfst);
+      }
+      if( pgno==1 ){
+        memcpy(aPage, SQLITE_FILE_HEADER, CODEC_SALT_SZ);
+        memset(aPage + CODEC_VERSION_OFST, 0, CODEC_VERSION_SZ);
+      }
+      codecCacheStore(p, pgno, aPage, aReserve);
+      return aPage;
+    }
+  }
+  if( pRead->isLegacy ){
+    codecLegacyDecrypt(p, pRead, aPage, pgno);
+  }else{
+    memset(aPage, 0, p->pageSize);
+  }
+  return aPage;
+}
+
+/*
+** Encrypt page pgno into the scratch buffer, leaving aPage untouched.
+*/
+static void *codecEncrypt(Codec *p, u8 *aPage, Pgno pgno, CodecKey *pKey,
+                          int bCache){
+  int iOfst = pgno==1 ? CODEC_PLAIN_HEADER_SZ : 0;
+  u8 *aOut = p->aBuf;
+  u8 *aReserve = aOut + p->pageSize - CODEC_RESERVE_SZ;
+  size_t nTag = 0;
+  u8 aAd[CODEC_AD_SZ];
+  int nAd;
+
+  if( !pKey->isSet ) return aPage;
+  if( pKey->isLegacy ) return codecLegacyEncrypt(p, pKey, aPage, pgno);
+  if( aOut==0 || p->nReserve<CODEC_RESERVE_SZ ) return 0;
+
+  memcpy(aOut, aPage, p->pageSize);
+  if( pgno==1 ){
+    memcpy(aOut, p->aSalt, CODEC_SALT_SZ);
+    codecVersion(aOut + CODEC_VERSION_OFST);
+  }
+  if( !RAND_bytes(aReserve, CODEC_NONCE_SZ) ) return 0;
+  memcpy(aReserve + CODEC_NONCE_SZ + CODEC_TAG_SZ, pKey->aId, CODEC_KEYID_SZ);
+  nAd = codecAdditionalData(pgno, aOut, aAd);
+  if( !EVP_AEAD_CTX_seal_scatter(&pKey->ctx, aOut + iOfst,
+                                 aReserve + CODEC_NONCE_SZ, &nTag, CODEC_TAG_SZ,
+                                 aReserve, CODEC_NONCE_SZ,
+                                 aPage + iOfst, p->pageSize - p->nReserve - iOfst,
+                                 0, 0, aAd, nAd) ){
+    return 0;
+  }
+  if( bCache ){
+    /* Remember the plaintext under the new nonce and tag, so the next read
+    ** of this page from disk skips decryption. */
+    codecCacheStore(p, pgno, aPage, aReserve);
+  }
+  return aOut;
+}
+
+/*
+** The xCodec callback installed on the pager.
+**
+**   mode 0, 2, 3:  a page was read from the database, the WAL or a journal
+**                  and must be decrypted in place.
+**   mode 6:        a page is about to be written to the database or WAL.
+**   mode 7:        a page is about to be written to the rollback journal.
+**
+** Journal pages always use the read key: while a rekey or an upgrade is in
+** progress the journal must restore pages the old key can still decrypt
+** after a crash.
+*/
+static void *sqlite3Codec(void *pArg, void *pData, Pgno pgno, int mode){
+  Codec *p = (Codec*)pArg;
+  switch( mode ){
+    case 0:
+    case 2:
+    case 3:
+      return codecDecrypt(p, (u8*)pData, pgno);
+    case 6:
+      return codecEncrypt(p, (u8*)pData, pgno, &p->aKey[p->iWrite], 1);
+    case 7:
+      return codecEncrypt(p, (u8*)pData, pgno, &p->aKey[p->iRead], 0);
+  }
+  return pData;
+}
+
+/*
+** Read the plaintext header of page 1, all zeros for a new database.
+*/
+static void codecReadHeader(Pager *pPager, u8 *aHdr){
+  if( sqlite3PagerReadFileheader(pPager, CODEC_PLAIN_HEADER_SZ, aHdr)
+      !=SQLITE_OK ){
+    memset(aHdr, 0, CODEC_PLAIN_HEADER_SZ);
+  }
+}
+
+static int codecIsLegacyHeader(const u8 *aHdr){
+  return memcmp(aHdr, CODEC_LEGACY_MAGIC, CODEC_LEGACY_MAGIC_SZ)==0
+      && (aHdr[CODEC_LEGACY_MAGIC_SZ]==CODEC_LEGACY_ECB
+          || aHdr[CODEC_LEGACY_MAGIC_SZ]==CODEC_LEGACY_CBC);
+}
+
+int sqlite3CodecAttach(sqlite3 *db, int nDb, const void *zKey, int nKey){
+  static const u8 aZero[CODEC_SALT_SZ] = {0};
+  struct Db *pDb = &db->aDb[nDb];
+  u8 aHdr[CODEC_PLAIN_HEADER_SZ];
+  Pager *pPager;
+  Codec *p;
+  int rc;
+
+  if( zKey==0 || nKey<=0 || pDb->pBt==0 ) return SQLITE_OK;
+  pPager = sqlite3BtreePager(pDb->pBt);
+
+  p = sqlite3MallocZero(sizeof(Codec));
+  if( p==0 ) return SQLITE_NOMEM;
+  p->nKdfIter = codecKdfIter;
+  p->nSlot = codecCachePages;
+  p->zPass = sqlite3Malloc(nKey);
+  if( p->zPass==0 ){
+    codecFree(p);
+    return SQLITE_NOMEM;
+  }
+  memcpy(p->zPass, zKey, nKey);
+  p->nPass = nKey;
+
+  sqlite3_mutex_enter(db->mutex);
+  codecReadHeader(pPager, aHdr);
+  if( codecIsLegacyHeader(aHdr) ){
+    /* Read (and write) as SQLitecrypt until codecUpgrade() has run.  The
+    ** salt is for the key the upgrade derives. */
+    RAND_bytes(p->aSalt, CODEC_SALT_SZ);
+    rc = codecLegacyKey(zKey, nKey, aHdr[CODEC_LEGACY_MAGIC_SZ], &p->aKey[0]);
+  }else{
+    if( memcmp(aHdr, aZero, CODEC_SALT_SZ)==0 ){
+      RAND_bytes(p->aSalt, CODEC_SALT_SZ);
+    }else{
+      memcpy(p->aSalt, aHdr, CODEC_SALT_SZ);
+    }
+    rc = codecDeriveKey(p, zKey, nKey, &p->aKey[0]);
+  }
+  if( rc==SQLITE_OK ){
+    /* Replaces (and frees) any codec already installed on the pager.  The
+    ** pager reports the page size back through codecSizeChange(). */
+    sqlite3PagerSetCodec(pPager, sqlite3Codec, codecSizeChange, codecFree, p);
+    /* Ask for the reserved space.  This only takes effect for a database
+    ** that has no pages yet, an existing file keeps its own layout. */
+    sqlite3BtreeSetPageSize(pDb->pBt, sqlite3BtreeGetPageSize(pDb->pBt),
+                            CODEC_RESERVE_SZ, 0);
+  }else{
+    codecFree(p);
+  }
+  sqlite3_mutex_leave(db->mutex);
+  return rc;
+}
+
+void sqlite3CodecGetKey(sqlite3 *db, int nDb, void **zKey, int *nKey){
+  struct Db *pDb = &db->aDb[nDb];
+  Codec *p = pDb->pBt ? (Codec*)sqlite3PagerGetCodec(sqlite3BtreePager(pDb->pBt)) : 0;
+  *zKey = p ? p->zPass : 0;
+  *nKey = p ? p->nPass : 0;
+}
+
+/*
+** Re-encrypt every page with the write key, in a single write transaction.
+** Pages the pager spills before the commit are journaled under the read key
+** first (or go to the WAL uncommitted), so after a crash the database opens
+** with the read key exactly as it was, and the commit moves the whole file
+** to the write key at once.
+*/
+static int codecRewritePages(Btree *pBt){
+  Pager *pPager = sqlite3BtreePager(pBt);
+  Pgno pgno;
+  int nPage = 0;
+  int rc;
+
+  rc = sqlite3BtreeBeginTrans(pBt, 1);
+  if( rc!=SQLITE_OK ) return rc;
+  sqlite3PagerPagecount(pPager, &nPage);
+  for(pgno=1; rc==SQLITE_OK && pgno<=(Pgno)nPage; pgno++){
+    DbPage *pPage;
+    if( pgno==PAGER_MJ_PGNO(pPager) ) continue;
+    rc = sqlite3PagerGet(pPager, pgno, &pPage, 0);
+    if( rc==SQLITE_OK ){
+      rc = sqlite3PagerWrite(pPage);
+      sqlite3PagerUnref(pPage);
+    }
+  }
+  if( rc==SQLITE_OK ){
+    rc = sqlite3BtreeCommit(pBt);
+  }else{
+    sqlite3BtreeRollback(pBt, SQLITE_ABORT_ROLLBACK, 0);
+  }
+  return rc;
+}
+
+/*
+** The SQLitecrypt format has no authentication: under a wrong passphrase
+** pages decrypt to garbage, which the upgrade would then seal for good.
+** Only upgrade a database whose b-trees check out.
+*/
+static int codecLegacyKeyIsValid(sqlite3 *db, int iDb){
+  sqlite3_stmt *pStmt = 0;
+  char *zSql;
+  int bValid = 0;
+
+  zSql = sqlite3_mprintf("PRAGMA \"%w\".quick_check(1)", db->aDb[iDb].zName);
+  if( zSql==0 ) return 0;
+  if( sqlite3_prepare_v2(db, zSql, -1, &pStmt, 0)==SQLITE_OK
+   && sqlite3_step(pStmt)==SQLITE_ROW ){
+    const char *zResult = (const char*)sqlite3_column_text(pStmt, 0);
+    bValid = zResult && strcmp(zResult, "ok")==0;
+  }
+  sqlite3_finalize(pStmt);
+  sqlite3_free(zSql);
+  return bValid;
+}
+
+/*
+** Move database iDb from the SQLitecrypt format to the current one: derive
+** the page key from the same passphrase under a fresh salt and rewrite every
+** page with it.  A database without room for the reserved bytes, one that
+** fails the check above or one that cannot be written right now keeps the
+** old format; the upgrade is tried again the next time it is keyed.
+*/
+static void codecUpgrade(sqlite3 *db, int iDb){
+  Btree *pBt = db->aDb[iDb].pBt;
+  Pager *pPager;
+  Codec *p;
+  u8 aHdr[CODEC_PLAIN_HEADER_SZ];
+  int iNew, rc;
+
+  if( pBt==0 ) return;
+  pPager = sqlite3BtreePager(pBt);
+  p = (Codec*)sqlite3PagerGetCodec(pPager);
+  if( p==0 || !p->aKey[p->iRead].isLegacy ) return;
+
+  codecReadHeader(pPager, aHdr);
+  if( aHdr[20]<CODEC_RESERVE_SZ ){
+    sqlite3_log(SQLITE_NOTICE,
+        "%s: %d reserved bytes per page, kept in the SQLitecrypt format",
+        sqlite3PagerFilename(pPager, 1), aHdr[20]);
+    return;
+  }
+  if( !codecLegacyKeyIsValid(db, iDb) ) return;
+
+  sqlite3_mutex_enter(db->mutex);
+  iNew = 1-p->iRead;
+  rc = codecDeriveKey(p, p->zPass, p->nPass, &p->aKey[iNew]);
+  if( rc==SQLITE_OK ){
+    p->iWrite = iNew;
+    rc = codecRewritePages(pBt);
+  }
+  if( rc==SQLITE_OK ){
+    codecKeyClear(&p->aKey[p->iRead]);
+    p->iRead = iNew;
+  }else{
+    codecKeyClear(&p->aKey[iNew]);
+    p->iWrite = p->iRead;
+    sqlite3_log(rc, "%s: upgrade from the SQLitecrypt format failed",
+                sqlite3PagerFilename(pPager, 1));
+  }
+  sqlite3_mutex_leave(db->mutex);
+}
+
+SQLITE_API int SQLITE_STDCALL sqlite3_key(sqlite3 *db, const void *pKey, int nKey){
+  return sqlite3_key_v2(db, 0, pKey, nKey);
+}
+
+SQLITE_API int SQLITE_STDCALL sqlite3_key_v2(
+  sqlite3 *db,
+  const char *zDbName,
+  const void *pKey, int nKey
+){
+  int iDb, rc;
+  if( db==0 || pKey==0 || nKey<=0 ) return SQLITE_MISUSE;
+  iDb = zDbName ? sqlite3FindDbName(db, zDbName) : 0;
+  if( iDb<0 ) return SQLITE_ERROR;
+  rc = sqlite3CodecAttach(db, iDb, pKey, nKey);
+  if( rc==SQLITE_OK ) codecUpgrade(db, iDb);
+  return rc;
+}
+
+SQLITE_API int SQLITE_STDCALL sqlite3_rekey(sqlite3 *db, const void *pKey, int nKey){
+  return sqlite3_rekey_v2(db, 0, pKey, nKey);
+}
+
+SQLITE_API int SQLITE_STDCALL sqlite3_rekey_v2(
+  sqlite3 *db,
+  const char *zDbName,
+  const void *pKey, int nKey
+){
+  struct Db *pDb;
+  Pager *pPager;
+  Codec *p;
+  CodecKey *pNew;
+  u8 aHdr[CODEC_PLAIN_HEADER_SZ];
+  int iDb, iNew, rc;
+
+  if( db==0 ) return SQLITE_MISUSE;
+  iDb = zDbName ? sqlite3FindDbName(db, zDbName) : 0;
+  if( iDb<0 ) return SQLITE_ERROR;
+  pDb = &db->aDb[iDb];
+  if( pDb->pBt==0 ) return SQLITE_ERROR;
+  pPager = sqlite3BtreePager(pDb->pBt);
+  p = (Codec*)sqlite3PagerGetCodec(pPager);
+
+  if( pKey==0 || nKey<=0 ){
+    if( p==0 ) return SQLITE_OK;
+    /* Removing the reserved space needs a full copy of the database. */
+    sqlite3ErrorWithMsg(db, SQLITE_ERROR,
+        "cannot decrypt in place, ATTACH a plaintext database and copy");
+    return SQLITE_ERROR;
+  }
+
+  if( p==0 ){
+    /* A plaintext database has no room for nonces and tags in its pages, so
+    ** only a database without content can be keyed here. */
+    i64 nByte = 0;
+    if( isOpen(pPager->fd) ){
+      rc = sqlite3OsFileSize(pPager->fd, &nByte);
+      if( rc!=SQLITE_OK ) return rc;
+    }
+    if( nByte>0 ){
+      sqlite3ErrorWithMsg(db, SQLITE_ERROR,
+          "cannot encrypt in place, ATTACH an encrypted database and copy");
+      return SQLITE_ERROR;
+    }
+    return sqlite3CodecAttach(db, iDb, pKey, nKey);
+  }
+
+  if( p->aKey[p->iRead].isLegacy ){
+    codecReadHeader(pPager, aHdr);
+    if( aHdr[20]<CODEC_RESERVE_SZ ){
+      sqlite3ErrorWithMsg(db, SQLITE_ERROR,
+          "no reserved space for the codec, ATTACH an encrypted database "
+          "and copy");
+      return SQLITE_ERROR;
+    }
+  }
+
+  sqlite3_mutex_enter(db->mutex);
+  iNew = 1-p->iRead;
+  pNew = &p->aKey[iNew];
+  rc = codecDeriveKey(p, pKey, nKey, pNew);
+  if( rc==SQLITE_OK && !p->aKey[p->iRead].isLegacy
+   && memcmp(pNew->aId, p->aKey[p->iRead].aId, CODEC_KEYID_SZ)==0 ){
+    /* Same key, nothing to re-encrypt. */
+    codecKeyClear(pNew);
+    sqlite3_mutex_leave(db->mutex);
+    return SQLITE_OK;
+  }
+  if( rc==SQLITE_OK ){
+    p->iWrite = iNew;
+    rc = codecRewritePages(pDb->pBt);
+  }
+  if( rc==SQLITE_OK ){
+    char *zPass = sqlite3Malloc(nKey);
+    if( zPass ){
+      memcpy(zPass, pKey, nKey);
+      codecFreeSecure(p->zPass, p->nPass);
+      p->zPass = zPass;
+      p->nPass = nKey;
+    }
+    codecKeyClear(&p->aKey[p->iRead]);
+    p->iRead = iNew;
+  }else{
+    /* Rolled back: every page is still under the read key. */
+    codecKeyClear(pNew);
+    p->iWrite = p->iRead;
+  }
+  sqlite3_mutex_leave(db->mutex);
+  return rc;
+}
+
+SQLITE_API void SQLITE_STDCALL sqlite3_activate_see(const char *zPassPhrase){
+  /* Nothing to activate, the codec is always available. */
+}
+
+#endif /* SQLITE_HAS_CODEC */
@@ -0,0 +1,188 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Standalone benchmark for the sqlitecrypt page codec. It fills a synthetic
+// database of --size-mb megabytes (1 GB by default) once in plaintext and once
+// encrypted, then measures sequential scan and random point read throughput
+// with a small pager cache so that reads really go through the codec.
+//
+//   sqlitecrypt_benchmark [--size-mb=1024] [--dir=/tmp] [--kdf-iter=64000]
+//                         [--codec-cache-pages=256] [--reads=100000]
+
+#include <stdio.h>
+
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/logging.h"
+#include "base/rand_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "third_party/sqlitecrypt/sqlite3.h"
+
+namespace {
+
+const char kSizeMb[] = "size-mb";
+const char kDir[] = "dir";
+const char kKdfIter[] = "kdf-iter";
+const char kCodecCachePages[] = "codec-cache-pages";
+const char kReads[] = "reads";
+
+const char kKey[] = "sqlitecrypt benchmark passphrase";
+const int kRowBytes = 4000;
+const int kRowsPerTransaction = 1000;
+
+struct Result {
+  double write_mb_per_s = 0;
+  double scan_mb_per_s = 0;
+  double random_reads_per_s = 0;
+  double open_ms = 0;
+};
+
+int IntSwitch(const base::CommandLine& command_line,
+              const char* name,
+              int default_value) {
+  int value;
+  if (command_line.HasSwitch(name) &&
+      base::StringToInt(command_line.GetSwitchValueASCII(name), &value)) {
+    return value;
+  }
+  return default_value;
+}
+
+void Exec(sqlite3* db, const char* sql) {
+  char* error = nullptr;
+  int rc = sqlite3_exec(db, sql, nullptr, nullptr, &error);
+  CHECK_EQ(SQLITE_OK, rc) << sql << ": " << (error ? error : "");
+}
+
+sqlite3* Open(const base::FilePath& path, bool encrypted, double* open_ms) {
+  sqlite3* db = nullptr;
+  base::TimeTicks start = base::TimeTicks::Now();
+  CHECK_EQ(SQLITE_OK, sqlite3_open(path.value().c_str(), &db));
+  if (encrypted)
+    CHECK_EQ(SQLITE_OK, sqlite3_key(db, kKey, sizeof(kKey) - 1));
+  // Keep the pager cache small (8 MB) so reads keep hitting the codec.
+  Exec(db, "PRAGMA cache_size=-8192");
+  Exec(db, "PRAGMA journal_mode=WAL");
+  Exec(db, "SELECT count(*) FROM sqlite_master");
+  if (open_ms)
+    *open_ms = (base::TimeTicks::Now() - start).InMillisecondsF();
+  return db;
+}
+
+Result Run(const base::FilePath& path, bool encrypted, int64_t rows,
+           int reads) {
+  Result result;
+  std::vector<char> payload(kRowBytes);
+  for (char& c : payload)
+    c = static_cast<char>(base::RandInt(0, 255));
+
+  sqlite3* db = Open(path, encrypted, nullptr);
+  Exec(db, "CREATE TABLE blobs (id INTEGER PRIMARY KEY, data BLOB)");
+  sqlite3_stmt* insert = nullptr;
+  CHECK_EQ(SQLITE_OK, sqlite3_prepare_v2(
+      db, "INSERT INTO blobs (id, data) VALUES (?, ?)", -1, &insert, nullptr));
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  for (int64_t id = 0; id < rows; ++id) {
+    if (id % kRowsPerTransaction == 0)
+      Exec(db, "BEGIN");
+    sqlite3_bind_int64(insert, 1, id);
+    sqlite3_bind_blob(insert, 2, payload.data(), kRowBytes, SQLITE_STATIC);
+    CHECK_EQ(SQLITE_DONE, sqlite3_step(insert));
+    sqlite3_reset(insert);
+    if (id % kRowsPerTransaction == kRowsPerTransaction - 1 || id == rows - 1)
+      Exec(db, "COMMIT");
+  }
+  Exec(db, "PRAGMA wal_checkpoint(TRUNCATE)");
+  double seconds = (base::TimeTicks::Now() - start).InSecondsF();
+  result.write_mb_per_s = rows * kRowBytes / (1024.0 * 1024.0) / seconds;
+  sqlite3_finalize(insert);
+  sqlite3_close(db);
+
+  // Reopen so nothing is left in the pager cache.
+  db = Open(path, encrypted, &result.open_ms);
+  sqlite3_stmt* scan = nullptr;
+  CHECK_EQ(SQLITE_OK, sqlite3_prepare_v2(
+      db, "SELECT data FROM blobs", -1, &scan, nullptr));
+  int64_t scanned = 0;
+  start = base::TimeTicks::Now();
+  while (sqlite3_step(scan) == SQLITE_ROW)
+    scanned += sqlite3_column_bytes(scan, 0);
+  seconds = (base::TimeTicks::Now() - start).InSecondsF();
+  result.scan_mb_per_s = scanned / (1024.0 * 1024.0) / seconds;
+  sqlite3_finalize(scan);
+
+  sqlite3_stmt* point = nullptr;
+  CHECK_EQ(SQLITE_OK, sqlite3_prepare_v2(
+      db, "SELECT length(data) FROM blobs WHERE id = ?", -1, &point, nullptr));
+  start = base::TimeTicks::Now();
+  for (int i = 0; i < reads; ++i) {
+    sqlite3_bind_int64(point, 1, base::RandGenerator(rows));
+    CHECK_EQ(SQLITE_ROW, sqlite3_step(point));
+    sqlite3_reset(point);
+  }
+  seconds = (base::TimeTicks::Now() - start).InSecondsF();
+  result.random_reads_per_s = reads / seconds;
+  sqlite3_finalize(point);
+  sqlite3_close(db);
+  return result;
+}
+
+void Print(const char* name, const Result& result) {
+  printf("%-10s write %8.1f MB/s  scan %8.1f MB/s  random %10.0f reads/s  "
+         "open %7.1f ms\n",
+         name, result.write_mb_per_s, result.scan_mb_per_s,
+         result.random_reads_per_s, result.open_ms);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  base::AtExitManager at_exit;
+  base::CommandLine::Init(argc, argv);
+  const base::CommandLine& command_line =
+      *base::CommandLine::ForCurrentProcess();
+
+  if (command_line.HasSwitch("help")) {
+    printf("Usage: %s [--size-mb=N] [--dir=PATH] [--kdf-iter=N] "
+           "[--codec-cache-pages=N] [--reads=N]\n", argv[0]);
+    return 0;
+  }
+
+  int size_mb = IntSwitch(command_line, kSizeMb, 1024);
+  int reads = IntSwitch(command_line, kReads, 100000);
+  sqlite3_codec_config(SQLITE_CODEC_CONFIG_KDF_ITER,
+                       IntSwitch(command_line, kKdfIter, 64000));
+  sqlite3_codec_config(SQLITE_CODEC_CONFIG_CACHE_PAGES,
+                       IntSwitch(command_line, kCodecCachePages, 256));
+
+  base::ScopedTempDir temp_dir;
+  bool created = command_line.HasSwitch(kDir)
+      ? temp_dir.CreateUniqueTempDirUnderPath(
+            command_line.GetSwitchValuePath(kDir))
+      : temp_dir.CreateUniqueTempDir();
+  CHECK(created);
+
+  int64_t rows = static_cast<int64_t>(size_mb) * 1024 * 1024 / kRowBytes;
+  printf("%d MB synthetic database, %lld rows of %d bytes\n", size_mb,
+         static_cast<long long>(rows), kRowBytes);
+
+  Result plain =
+      Run(temp_dir.GetPath().AppendASCII("plain.db"), false, rows, reads);
+  Print("plaintext", plain);
+  Result encrypted =
+      Run(temp_dir.GetPath().AppendASCII("encrypted.db"), true, rows, reads);
+  Print("encrypted", encrypted);
+
+  printf("encrypted/plaintext: write %.2f  scan %.2f  random %.2f\n",
+         encrypted.write_mb_per_s / plain.write_mb_per_s,
+         encrypted.scan_mb_per_s / plain.scan_mb_per_s,
+         encrypted.random_reads_per_s / plain.random_reads_per_s);
+  return 0;
+}
@@ -0,0 +1,271 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "xwalk/tools/chunked_lzma/chunked_lzma_reader.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "base/files/file.h"
+#include "base/logging.h"
+#include "base/synchronization/atomic_flag.h"
+#include "base/sys_byteorder.h"
+#include "base/threading/simple_thread.h"
+#include "third_party/lzma_sdk/LzmaLib.h"
+#include "third_party/zlib/zlib.h"
+
+namespace xwalk {
+
+namespace {
+
+const char kMagic[] = "XWLZCHK1";
+const size_t kMagicSize = sizeof(kMagic) - 1;
+const size_t kHeaderSize = kMagicSize + 4 + 4 + 8;
+const size_t kIndexEntrySize = 8 + 4 + 4;
+const size_t kLzmaAloneHeaderSize = LZMA_PROPS_SIZE + 8;
+
+// Blocks larger than this are rejected, it bounds the memory a corrupt or
+// hostile header can make us allocate per block.
+const uint32_t kMaxBlockSize = 64 * 1024 * 1024;
+
+// ExtractToFile() writes at most this much per call.
+const size_t kMaxWriteSize = 64 * 1024 * 1024;
+
+uint32_t ReadUInt32(const uint8_t* p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return base::ByteSwapToLE32(value);
+}
+
+uint64_t ReadUInt64(const uint8_t* p) {
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return base::ByteSwapToLE64(value);
+}
+
+bool DecodeLzma(const uint8_t* props,
+                const uint8_t* src,
+                size_t src_size,
+                uint8_t* dest,
+                size_t dest_size) {
+  size_t out_size = dest_size;
+  SizeT in_size = src_size;
+  int result =
+      LzmaUncompress(dest, &out_size, src, &in_size, props, LZMA_PROPS_SIZE);
+  // SZ_ERROR_INPUT_EOF only means the stream has no end marker, which is the
+  // normal case when the output size is known up front.
+  return (result == SZ_OK || result == SZ_ERROR_INPUT_EOF) &&
+         out_size == dest_size;
+}
+
+// Decodes one block per Run() call, picking the next block index atomically.
+class BlockDecoder : public base::DelegateSimpleThreadPool::Delegate {
+ public:
+  BlockDecoder(const ChunkedLzmaReader* reader, uint8_t* out)
+      : reader_(reader), out_(out) {}
+
+  void Run() override {
+    if (failed_.IsSet())
+      return;
+    size_t index = next_block_.fetch_add(1);
+    if (index >= reader_->block_count())
+      return;
+    uint8_t* dest = out_ + static_cast<uint64_t>(index) * reader_->block_size();
+    if (!reader_->DecodeBlock(index, dest))
+      failed_.Set();
+  }
+
+  bool failed() const { return failed_.IsSet(); }
+
+ private:
+  const ChunkedLzmaReader* reader_;
+  uint8_t* out_;
+  std::atomic<size_t> next_block_{0};
+  base::AtomicFlag failed_;
+
+  DISALLOW_COPY_AND_ASSIGN(BlockDecoder);
+};
+
+}  // namespace
+
+ChunkedLzmaReader::ChunkedLzmaReader() = default;
+
+ChunkedLzmaReader::~ChunkedLzmaReader() = default;
+
+// static
+std::unique_ptr<ChunkedLzmaReader> ChunkedLzmaReader::Open(
+    const base::FilePath& path) {
+  auto file = std::make_unique<base::MemoryMappedFile>();
+  if (!file->Initialize(path)) {
+    LOG(ERROR) << "Cannot map " << path.value();
+    return nullptr;
+  }
+  std::unique_ptr<ChunkedLzmaReader> reader(new ChunkedLzmaReader);
+  if (!reader->Parse(base::make_span(file->data(), file->length())))
+    return nullptr;
+  reader->file_ = std::move(file);
+  return reader;
+}
+
+// static
+std::unique_ptr<ChunkedLzmaReader> ChunkedLzmaReader::Create(
+    base::span<const uint8_t> data) {
+  std::unique_ptr<ChunkedLzmaReader> reader(new ChunkedLzmaReader);
+  if (!reader->Parse(data))
+    return nullptr;
+  return reader;
+}
+
+bool ChunkedLzmaReader::Parse(base::span<const uint8_t> data) {
+  if (data.size() < kHeaderSize || memcmp(data.data(), kMagic, kMagicSize)) {
+    LOG(ERROR) << "Not a chunked LZMA file";
+    return false;
+  }
+  const uint8_t* p = data.data() + kMagicSize;
+  block_size_ = ReadUInt32(p);
+  uint32_t block_count = ReadUInt32(p + 4);
+  uncompressed_size_ = ReadUInt64(p + 8);
+
+  if (block_size_ == 0 || block_size_ > kMaxBlockSize ||
+      block_count != (uncompressed_size_ + block_size_ - 1) / block_size_ ||
+      (data.size() - kHeaderSize) / kIndexEntrySize < block_count) {
+    LOG(ERROR) << "Invalid chunked LZMA header";
+    return false;
+  }
+
+  blocks_.resize(block_count);
+  p = data.data() + kHeaderSize;
+  for (Block& block : blocks_) {
+    block.offset = ReadUInt64(p);
+    block.compressed_size = ReadUInt32(p + 8);
+    block.crc32 = ReadUInt32(p + 12);
+    p += kIndexEntrySize;
+    if (block.compressed_size < LZMA_PROPS_SIZE ||
+        block.offset > data.size() ||
+        data.size() - block.offset < block.compressed_size) {
+      LOG(ERROR) << "Invalid chunked LZMA index";
+      return false;
+    }
+  }
+  data_ = data;
+  return true;
+}
+
+size_t ChunkedLzmaReader::BlockLength(size_t index) const {
+  DCHECK_LT(index, blocks_.size());
+  uint64_t start = static_cast<uint64_t>(index) * block_size_;
+  return static_cast<size_t>(
+      std::min<uint64_t>(block_size_, uncompressed_size_ - start));
+}
+
+bool ChunkedLzmaReader::DecodeBlock(size_t index, uint8_t* out) const {
+  const Block& block = blocks_[index];
+  const uint8_t* src = data_.data() + block.offset;
+  size_t length = BlockLength(index);
+  if (!DecodeLzma(src, src + LZMA_PROPS_SIZE,
+                  block.compressed_size - LZMA_PROPS_SIZE, out, length)) {
+    LOG(ERROR) << "Cannot decode block " << index;
+    return false;
+  }
+  uLong crc = crc32(0L, Z_NULL, 0);
+  if (crc32(crc, out, length) != block.crc32) {
+    LOG(ERROR) << "Checksum mismatch in block " << index;
+    return false;
+  }
+  return true;
+}
+
+bool ChunkedLzmaReader::Read(uint64_t offset, size_t length, uint8_t* out) {
+  if (offset > uncompressed_size_ || uncompressed_size_ - offset < length)
+    return false;
+
+  while (length > 0) {
+    size_t index = static_cast<size_t>(offset / block_size_);
+    size_t block_offset = static_cast<size_t>(offset % block_size_);
+    size_t block_length = BlockLength(index);
+    size_t chunk = std::min(length, block_length - block_offset);
+
+    if (block_offset == 0 && chunk == block_length) {
+      // The whole block is wanted, decode it straight into the output.
+      if (!DecodeBlock(index, out))
+        return false;
+    } else {
+      if (cached_block_ != index) {
+        cached_data_.resize(block_length);
+        cached_block_ = SIZE_MAX;
+        if (!DecodeBlock(index, cached_data_.data()))
+          return false;
+        cached_block_ = index;
+      }
+      memcpy(out, cached_data_.data() + block_offset, chunk);
+    }
+    out += chunk;
+    offset += chunk;
+    length -= chunk;
+  }
+  return true;
+}
+
+bool ChunkedLzmaReader::ReadAll(uint8_t* out, int num_threads) const {
+  if (num_threads <= 1 || blocks_.size() < 2) {
+    for (size_t i = 0; i < blocks_.size(); ++i) {
+      if (!DecodeBlock(i, out + static_cast<uint64_t>(i) * block_size_))
+        return false;
+    }
+    return true;
+  }
+
+  BlockDecoder decoder(this, out);
+  base::DelegateSimpleThreadPool pool(
+      "ChunkedLzma",
+      std::min<int>(num_threads, static_cast<int>(blocks_.size())));
+  pool.Start();
+  pool.AddWork(&decoder, static_cast<int>(blocks_.size()));
+  pool.JoinAll();
+  return !decoder.failed();
+}
+
+bool ChunkedLzmaReader::ExtractToFile(const base::FilePath& path,
+                                      int num_threads) const {
+  if (uncompressed_size_ > SIZE_MAX)
+    return false;
+  std::vector<uint8_t> data(static_cast<size_t>(uncompressed_size_));
+  if (!ReadAll(data.data(), num_threads))
+    return false;
+  base::File file(path, base::File::FLAG_CREATE_ALWAYS | base::File::FLAG_WRITE);
+  if (!file.IsValid())
+    return false;
+  // base::File takes int sizes, which entries over 2 GB overflow.
+  size_t written = 0;
+  while (written < data.size()) {
+    int chunk = static_cast<int>(
+        std::min<size_t>(data.size() - written, kMaxWriteSize));
+    if (file.WriteAtCurrentPos(
+            reinterpret_cast<const char*>(data.data() + written), chunk) !=
+        chunk) {
+      return false;
+    }
+    written += chunk;
+  }
+  return true;
+}
+
+bool DecodeLzmaAloneFile(base::span<const uint8_t> data,
+                         std::vector<uint8_t>* out) {
+  if (data.size() < kLzmaAloneHeaderSize)
+    return false;
+  uint64_t size = ReadUInt64(data.data() + LZMA_PROPS_SIZE);
+  // The lzma tool writes all ones when the size is unknown, we always know it.
+  if (size == UINT64_MAX || size > SIZE_MAX)
+    return false;
+  out->resize(static_cast<size_t>(size));
+  return DecodeLzma(data.data(), data.data() + kLzmaAloneHeaderSize,
+                    data.size() - kLzmaAloneHeaderSize, out->data(),
+                    out->size());
+}
+
+}  // namespace xwalk
@@ -0,0 +1,105 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef XWALK_TOOLS_CHUNKED_LZMA_CHUNKED_LZMA_READER_H_
+#define XWALK_TOOLS_CHUNKED_LZMA_CHUNKED_LZMA_READER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/containers/span.h"
+#include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/macros.h"
+
+namespace xwalk {
+
+// Reads the chunked LZMA container written by
+// build/android/lzma_compress.py --chunked. A plain .lzma file has to be
+// decoded serially from its first byte, this format splits the input into
+// independently compressed blocks so they can be decoded in parallel, and
+// any byte range can be served by decoding only the blocks that cover it.
+//
+// Layout, all integers little endian:
+//
+//   magic             8 bytes   "XWLZCHK1"
+//   block_size        uint32    uncompressed size of every block but the last
+//   block_count       uint32
+//   uncompressed_size uint64
+//   index             block_count x { uint64 offset, uint32 compressed_size,
+//                                     uint32 crc32 of the uncompressed block }
+//   blocks            5 bytes of LZMA properties followed by the raw stream
+//
+// Offsets in the index are relative to the start of the file.
+class ChunkedLzmaReader {
+ public:
+  // Maps |path| and validates its header and index. Returns nullptr if the
+  // file cannot be read or is not a chunked LZMA container.
+  static std::unique_ptr<ChunkedLzmaReader> Open(const base::FilePath& path);
+
+  // Same as Open() for data already in memory. |data| must outlive the reader.
+  static std::unique_ptr<ChunkedLzmaReader> Create(
+      base::span<const uint8_t> data);
+
+  ~ChunkedLzmaReader();
+
+  uint64_t size() const { return uncompressed_size_; }
+  size_t block_count() const { return blocks_.size(); }
+  uint32_t block_size() const { return block_size_; }
+
+  // Uncompressed size of block |index|.
+  size_t BlockLength(size_t index) const;
+
+  // Decodes block |index| into |out|, which holds BlockLength(index) bytes,
+  // and verifies its checksum. Safe to call from several threads at once.
+  bool DecodeBlock(size_t index, uint8_t* out) const;
+
+  // Copies |length| bytes starting at |offset| of the uncompressed stream to
+  // |out|, decoding only the blocks overlapping that range. The most recently
+  // decoded partial block is kept, so small sequential reads decode each
+  // block once. Not thread-safe.
+  bool Read(uint64_t offset, size_t length, uint8_t* out);
+
+  // Decodes the whole stream into |out| (size() bytes) on |num_threads|
+  // worker threads. |num_threads| <= 1 decodes on the calling thread.
+  bool ReadAll(uint8_t* out, int num_threads) const;
+
+  // Decodes the whole stream into |path|.
+  bool ExtractToFile(const base::FilePath& path, int num_threads) const;
+
+ private:
+  struct Block {
+    uint64_t offset;
+    uint32_t compressed_size;
+    uint32_t crc32;
+  };
+
+  ChunkedLzmaReader();
+
+  bool Parse(base::span<const uint8_t> data);
+
+  std::unique_ptr<base::MemoryMappedFile> file_;
+  base::span<const uint8_t> data_;
+  uint32_t block_size_ = 0;
+  uint64_t uncompressed_size_ = 0;
+  std::vector<Block> blocks_;
+
+  // Last block decoded by Read() for a partial range.
+  size_t cached_block_ = SIZE_MAX;
+  std::vector<uint8_t> cached_data_;
+
+  DISALLOW_COPY_AND_ASSIGN(ChunkedLzmaReader);
+};
+
+// Decodes a whole-file .lzma (LZMA "alone" format: properties, 64-bit size,
+// stream) as produced by the lzma tool. Used as the serial baseline.
+bool DecodeLzmaAloneFile(base::span<const uint8_t> data,
+                         std::vector<uint8_t>* out);
+
+}  // namespace xwalk
+
+#endif  // XWALK_TOOLS_CHUNKED_LZMA_CHUNKED_LZMA_READER_H_
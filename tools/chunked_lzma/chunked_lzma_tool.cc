@@ -0,0 +1,175 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Command line front end for ChunkedLzmaReader.
+//
+//   chunked_lzma_tool info FILE.clzma
+//   chunked_lzma_tool extract FILE.clzma OUTPUT [--threads=N]
+//   chunked_lzma_tool cat FILE.clzma --offset=N --length=N
+//   chunked_lzma_tool bench FILE.clzma [--baseline=FILE.lzma] [--threads=N]
+//                           [--reads=N]
+//
+// "bench" compares decoding the whole asset on one core and on --threads
+// cores (all of them by default), measures random 64 KB reads, and, when
+// --baseline points at the same asset as a plain .lzma, decodes that too.
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/command_line.h"
+#include "base/files/file_util.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/rand_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/sys_info.h"
+#include "base/time/time.h"
+#include "xwalk/tools/chunked_lzma/chunked_lzma_reader.h"
+
+namespace {
+
+const char kThreads[] = "threads";
+const char kOffset[] = "offset";
+const char kLength[] = "length";
+const char kBaseline[] = "baseline";
+const char kReads[] = "reads";
+
+const size_t kRandomReadSize = 64 * 1024;
+
+int Usage() {
+  fprintf(stderr,
+          "Usage: chunked_lzma_tool info FILE\n"
+          "       chunked_lzma_tool extract FILE OUTPUT [--threads=N]\n"
+          "       chunked_lzma_tool cat FILE --offset=N --length=N\n"
+          "       chunked_lzma_tool bench FILE [--baseline=FILE.lzma] "
+          "[--threads=N] [--reads=N]\n");
+  return 1;
+}
+
+int64_t Int64Switch(const base::CommandLine& command_line,
+                    const char* name,
+                    int64_t default_value) {
+  int64_t value;
+  if (command_line.HasSwitch(name) &&
+      base::StringToInt64(command_line.GetSwitchValueASCII(name), &value)) {
+    return value;
+  }
+  return default_value;
+}
+
+double MegabytesPerSecond(uint64_t bytes, base::TimeDelta elapsed) {
+  return bytes / (1024.0 * 1024.0) / elapsed.InSecondsF();
+}
+
+int Info(const xwalk::ChunkedLzmaReader& reader) {
+  printf("uncompressed size %llu bytes\n",
+         static_cast<unsigned long long>(reader.size()));
+  printf("%zu blocks of %u bytes\n", reader.block_count(), reader.block_size());
+  return 0;
+}
+
+int Cat(xwalk::ChunkedLzmaReader* reader,
+        const base::CommandLine& command_line) {
+  int64_t offset = Int64Switch(command_line, kOffset, 0);
+  int64_t length = Int64Switch(
+      command_line, kLength, static_cast<int64_t>(reader->size()) - offset);
+  if (offset < 0 || length < 0)
+    return Usage();
+  std::vector<uint8_t> data(static_cast<size_t>(length));
+  if (!reader->Read(offset, data.size(), data.data()))
+    return 1;
+  fwrite(data.data(), 1, data.size(), stdout);
+  return 0;
+}
+
+int Bench(xwalk::ChunkedLzmaReader* reader,
+          const base::CommandLine& command_line,
+          int threads) {
+  std::vector<uint8_t> data(static_cast<size_t>(reader->size()));
+
+  base::TimeTicks start = base::TimeTicks::Now();
+  if (!reader->ReadAll(data.data(), 1))
+    return 1;
+  base::TimeDelta serial = base::TimeTicks::Now() - start;
+  printf("chunked, 1 thread:   %8.1f MB/s  %8.1f ms\n",
+         MegabytesPerSecond(data.size(), serial), serial.InMillisecondsF());
+
+  start = base::TimeTicks::Now();
+  if (!reader->ReadAll(data.data(), threads))
+    return 1;
+  base::TimeDelta parallel = base::TimeTicks::Now() - start;
+  printf("chunked, %d threads: %8.1f MB/s  %8.1f ms  (x%.2f)\n", threads,
+         MegabytesPerSecond(data.size(), parallel), parallel.InMillisecondsF(),
+         serial.InSecondsF() / parallel.InSecondsF());
+
+  int64_t reads = Int64Switch(command_line, kReads, 1000);
+  size_t read_size =
+      static_cast<size_t>(std::min<uint64_t>(kRandomReadSize, reader->size()));
+  if (reads > 0 && read_size > 0) {
+    std::vector<uint8_t> buffer(read_size);
+    start = base::TimeTicks::Now();
+    for (int64_t i = 0; i < reads; ++i) {
+      uint64_t offset = base::RandGenerator(reader->size() - read_size + 1);
+      if (!reader->Read(offset, read_size, buffer.data()))
+        return 1;
+    }
+    base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+    printf("random %zu KB reads:  %8.1f us/read\n", read_size / 1024,
+           elapsed.InMicrosecondsF() / reads);
+  }
+
+  if (command_line.HasSwitch(kBaseline)) {
+    base::MemoryMappedFile baseline;
+    if (!baseline.Initialize(command_line.GetSwitchValuePath(kBaseline))) {
+      fprintf(stderr, "Cannot open baseline\n");
+      return 1;
+    }
+    std::vector<uint8_t> out;
+    start = base::TimeTicks::Now();
+    if (!xwalk::DecodeLzmaAloneFile(
+            base::make_span(baseline.data(), baseline.length()), &out)) {
+      fprintf(stderr, "Cannot decode baseline\n");
+      return 1;
+    }
+    base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+    printf("plain .lzma:         %8.1f MB/s  %8.1f ms\n",
+           MegabytesPerSecond(out.size(), elapsed), elapsed.InMillisecondsF());
+    if (out != data)
+      printf("warning: baseline content differs from the chunked file\n");
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  base::AtExitManager at_exit;
+  base::CommandLine::Init(argc, argv);
+  const base::CommandLine& command_line =
+      *base::CommandLine::ForCurrentProcess();
+  base::CommandLine::StringVector args = command_line.GetArgs();
+  if (args.size() < 2)
+    return Usage();
+
+  std::unique_ptr<xwalk::ChunkedLzmaReader> reader =
+      xwalk::ChunkedLzmaReader::Open(base::FilePath(args[1]));
+  if (!reader)
+    return 1;
+
+  int threads = static_cast<int>(Int64Switch(
+      command_line, kThreads, base::SysInfo::NumberOfProcessors()));
+
+  if (args[0] == FILE_PATH_LITERAL("info"))
+    return Info(*reader);
+  if (args[0] == FILE_PATH_LITERAL("extract") && args.size() == 3)
+    return reader->ExtractToFile(base::FilePath(args[2]), threads) ? 0 : 1;
+  if (args[0] == FILE_PATH_LITERAL("cat"))
+    return Cat(reader.get(), command_line);
+  if (args[0] == FILE_PATH_LITERAL("bench"))
+    return Bench(reader.get(), command_line, threads);
+  return Usage();
+}
@@ -0,0 +1,132 @@
+// Copyright (c) 2019 Intel Corporation. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Prints the binary logs written by AsyncLogBackend (--async-logging) in the
+// usual base/logging.h text layout. Rotated files are decoded in the order
+// given, so pass the oldest first:
+//
+//   xlog_decoder xwalk_debug.1234.xlog.2 xwalk_debug.1234.xlog.1 \
+//       xwalk_debug.1234.xlog
+
+#include <stdio.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/logging.h"
+#include "base/sys_byteorder.h"
+#include "base/time/time.h"
+#include "xwalk/runtime/common/async_log_format.h"
+
+namespace {
+
+const char* SeverityName(int severity) {
+  switch (severity) {
+    case logging::LOG_INFO:
+      return "INFO";
+    case logging::LOG_WARNING:
+      return "WARNING";
+    case logging::LOG_ERROR:
+      return "ERROR";
+    case logging::LOG_FATAL:
+      return "FATAL";
+    default:
+      return severity < 0 ? "VERBOSE" : "UNKNOWN";
+  }
+}
+
+std::string FormatTime(int64_t time_us) {
+  base::Time::Exploded exploded;
+  (base::Time::UnixEpoch() + base::TimeDelta::FromMicroseconds(time_us))
+      .LocalExplode(&exploded);
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%02d%02d/%02d%02d%02d.%06d",
+           exploded.month, exploded.day_of_month, exploded.hour,
+           exploded.minute, exploded.second,
+           static_cast<int>(time_us % base::Time::kMicrosecondsPerSecond));
+  return buffer;
+}
+
+// Returns false if the file is not a log or is truncated. Records before the
+// damage are still printed.
+bool Decode(const base::FilePath& path, uint64_t* records, uint64_t* dropped) {
+  base::MemoryMappedFile file;
+  if (!file.Initialize(path)) {
+    fprintf(stderr, "Cannot open %s\n", path.AsUTF8Unsafe().c_str());
+    return false;
+  }
+  base::span<const uint8_t> data(file.data(), file.length());
+  if (data.size() < xwalk::async_log::kFileHeaderSize ||
+      memcmp(data.data(), xwalk::async_log::kFileMagic,
+             xwalk::async_log::kFileMagicSize)) {
+    fprintf(stderr, "%s is not an xwalk binary log\n", path.AsUTF8Unsafe().c_str());
+    return false;
+  }
+  uint32_t pid;
+  memcpy(&pid, data.data() + xwalk::async_log::kFileMagicSize, sizeof(pid));
+  pid = base::ByteSwapToLE32(pid);
+  data = data.subspan(xwalk::async_log::kFileHeaderSize);
+
+  while (!data.empty()) {
+    xwalk::async_log::Record record;
+    size_t size = xwalk::async_log::DecodeRecord(data, &record);
+    if (!size) {
+      fprintf(stderr, "%s: damaged record, %zu bytes skipped\n",
+              path.AsUTF8Unsafe().c_str(), data.size());
+      return false;
+    }
+    data = data.subspan(size);
+
+    if (record.severity == xwalk::async_log::kDroppedSeverity) {
+      uint64_t count = 0;
+      if (record.message.size() == sizeof(count)) {
+        memcpy(&count, record.message.data(), sizeof(count));
+        count = base::ByteSwapToLE64(count);
+      }
+      *dropped += count;
+      printf("[%u:%u:%s] *** %llu records dropped ***\n", pid,
+             record.thread_id, FormatTime(record.time_us).c_str(),
+             static_cast<unsigned long long>(count));
+      continue;
+    }
+
+    ++*records;
+    printf("[%u:%u:%s:%s:%.*s(%d)] %.*s\n", pid, record.thread_id,
+           FormatTime(record.time_us).c_str(), SeverityName(record.severity),
+           static_cast<int>(record.file.size()), record.file.data(),
+           record.line, static_cast<int>(record.message.size()),
+           record.message.data());
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  base::AtExitManager at_exit;
+  base::CommandLine::Init(argc, argv);
+  const base::CommandLine& command_line =
+      *base::CommandLine::ForCurrentProcess();
+
+  if (command_line.GetArgs().empty() || command_line.HasSwitch("help")) {
+    printf("Usage: %s FILE...\n", argv[0]);
+    return command_line.HasSwitch("help") ? 0 : 1;
+  }
+
+  bool ok = true;
+  uint64_t records = 0;
+  uint64_t dropped = 0;
+  for (const auto& arg : command_line.GetArgs())
+    ok &= Decode(base::FilePath(arg), &records, &dropped);
+
+  fprintf(stderr, "%llu records, %llu dropped\n",
+          static_cast<unsigned long long>(records),
+          static_cast<unsigned long long>(dropped));
+  return ok ? 0 : 1;
+}